@@ -455,6 +455,7 @@ int runApplication(int argc, char * *argv)
     QCoreApplication::setApplicationName(APP_NAME);
     QCoreApplication::setOrganizationName(ORG_NAME);
     QSettings::setDefaultFormat(XmlConfig::XmlSettingsFormat);
+    XmlConfig::setCacheDirectory(Utils::GetStoragePath() + "settings");
 
     // initialize the plugin manager
     ExtensionSystem::PluginManager pluginManager;
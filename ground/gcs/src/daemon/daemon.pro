@@ -0,0 +1,86 @@
+#
+# Headless GCS daemon: telemetry, logging, stream service and relay
+# for one or more links, without QtWidgets/QtQuick and without the plugin system.
+#
+# The object, telemetry and logging core sources are compiled in directly.
+# QtQml is still needed by the generated UAVObject classes (type registration only).
+#
+
+include(../../gcs.pri)
+
+TEMPLATE = app
+TARGET = $${GCS_APP_TARGET}d
+DESTDIR = $$GCS_APP_PATH
+
+CONFIG += console
+CONFIG -= app_bundle
+
+QT = core network serialport qml
+
+# Sources are linked statically into the daemon
+DEFINES += UAVOBJECTS_LIBRARY UAVTALK_LIBRARY QTCREATOR_UTILS_STATIC_LIB
+
+PLUGINS_DIR = $$GCS_SOURCE_TREE/src/plugins
+
+INCLUDEPATH += \
+    $$PLUGINS_DIR \
+    $$PLUGINS_DIR/uavobjects \
+    $$PLUGINS_DIR/uavtalk
+
+HEADERS += \
+    gcsdaemon.h \
+    telemetrylink.h \
+    streamserver.h \
+    $$PLUGINS_DIR/uavobjects/uavobject.h \
+    $$PLUGINS_DIR/uavobjects/uavmetaobject.h \
+    $$PLUGINS_DIR/uavobjects/uavdataobject.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectfield.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectmanager.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectupdatebus.h \
+    $$PLUGINS_DIR/uavobjects/uavobjecthistory.h \
+    $$PLUGINS_DIR/uavtalk/uavtalk.h \
+    $$PLUGINS_DIR/uavtalk/telemetry.h \
+    $$PLUGINS_DIR/uavtalk/telemetrymonitor.h \
+    $$GCS_SOURCE_TREE/src/libs/utils/logfile.h
+
+SOURCES += \
+    main.cpp \
+    gcsdaemon.cpp \
+    telemetrylink.cpp \
+    streamserver.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavmetaobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavdataobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectfield.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectmanager.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectupdatebus.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjecthistory.cpp \
+    $$PLUGINS_DIR/uavtalk/uavtalk.cpp \
+    $$PLUGINS_DIR/uavtalk/telemetry.cpp \
+    $$PLUGINS_DIR/uavtalk/telemetrymonitor.cpp \
+    $$GCS_SOURCE_TREE/src/libs/utils/logfile.cpp \
+    $$GCS_SOURCE_TREE/src/libs/utils/crc.cpp
+
+OTHER_FILES += gcsd.conf
+
+# Generate the UAVObject classes in the daemon build directory
+UAVOBJ_XML_DIR = $${ROOT_DIR}/shared/uavobjectdefinition
+UAVOBJ_ROOT_DIR = $${ROOT_DIR}
+
+win32 {
+    UAVOBJGENERATOR = ../../../uavobjgenerator/uavobjgenerator.exe
+} else {
+    UAVOBJGENERATOR = ../../../uavobjgenerator/uavobjgenerator
+}
+
+include($$PLUGINS_DIR/uavobjects/uavobjectlist.pri)
+include($$PLUGINS_DIR/uavobjects/uavobjgenerator.pri)
+
+INCLUDEPATH += $$OUT_PWD
+
+!win32:!macx {
+    target.path = /bin
+    INSTALLS += target
+    QMAKE_RPATHDIR = $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH))
+    include(../rpath.pri)
+}
@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ *
+ * @file       gcsdaemon.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSDaemon GCS Daemon
+ * @{
+ * @brief Headless GCS: telemetry, logging, relay and stream service per link
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "gcsdaemon.h"
+#include "streamserver.h"
+
+#include <QThread>
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QDateTime>
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <time.h>
+#include <unistd.h>
+#endif
+
+GcsDaemon::GcsDaemon(QObject *parent) : QObject(parent),
+    m_statsInterval(10),
+    m_streamEnabled(false),
+    m_streamPort(7891),
+    m_streamServer(0),
+    m_statsTimer(0),
+    m_lastCpuNs(0),
+    m_lastReportMs(0)
+{}
+
+GcsDaemon::~GcsDaemon()
+{
+    stop();
+}
+
+/**
+ * Reads the INI configuration, see gcsd.conf for the keys
+ */
+bool GcsDaemon::loadConfig(const QString &fileName, QString *errorString)
+{
+    if (!QFileInfo(fileName).isReadable()) {
+        *errorString = tr("Couldn't read configuration %1").arg(fileName);
+        return false;
+    }
+
+    QSettings settings(fileName, QSettings::IniFormat);
+
+    m_statsInterval = settings.value("statsInterval", 10).toInt();
+
+    settings.beginGroup("stream");
+    m_streamEnabled = settings.value("enabled", false).toBool();
+    m_streamPort    = settings.value("port", 7891).toUInt();
+    settings.endGroup();
+
+    int size = settings.beginReadArray("links");
+    for (int i = 0; i < size; ++i) {
+        settings.setArrayIndex(i);
+
+        LinkConfig config;
+        config.name        = settings.value("name", QString("link%1").arg(i)).toString();
+        config.type        = settings.value("type", "serial").toString();
+        config.device      = settings.value("device").toString();
+        config.baudRate    = settings.value("baudrate", 57600).toInt();
+        config.host        = settings.value("host", "localhost").toString();
+        config.port        = settings.value("port", 9000).toUInt();
+        config.telemetry   = settings.value("telemetry", true).toBool();
+        config.logDir      = settings.value("logDir").toString();
+        config.compressLog = settings.value("compressLog", true).toBool();
+        config.relayPort   = settings.value("relayPort", 0).toUInt();
+
+        if (config.type != "serial" && config.type != "tcp") {
+            *errorString = tr("Link %1: unknown type %2").arg(config.name).arg(config.type);
+            return false;
+        }
+        if (config.type == "serial" && config.device.isEmpty()) {
+            *errorString = tr("Link %1: no serial device").arg(config.name);
+            return false;
+        }
+        m_linkConfigs.append(config);
+    }
+    settings.endArray();
+
+    if (m_linkConfigs.isEmpty()) {
+        *errorString = tr("No links configured in %1").arg(fileName);
+        return false;
+    }
+    return true;
+}
+
+bool GcsDaemon::start(QString *errorString)
+{
+    if (m_streamEnabled) {
+        m_streamServer = new StreamServer(this);
+        if (!m_streamServer->listen(m_streamPort, errorString)) {
+            return false;
+        }
+        qDebug() << "GcsDaemon - stream service on port" << m_streamPort;
+    }
+
+    // Links are started one after the other so that the memory of each can be measured
+    foreach(const LinkConfig &config, m_linkConfigs) {
+        QThread *thread     = new QThread(this);
+        TelemetryLink *link = new TelemetryLink(config, m_streamServer);
+
+        link->moveToThread(thread);
+        connect(thread, &QThread::finished, link, &QObject::deleteLater);
+        connect(link, &TelemetryLink::statsReport, this, &GcsDaemon::printStats);
+        if (m_streamServer) {
+            connect(link, &TelemetryLink::streamData, m_streamServer, &StreamServer::broadcast);
+        }
+        thread->setObjectName(config.name);
+        thread->start();
+        QMetaObject::invokeMethod(link, "start", Qt::BlockingQueuedConnection);
+
+        m_links.append(link);
+        m_threads.append(thread);
+    }
+    qDebug() << "GcsDaemon -" << m_links.size() << "links started, memory" << residentMemoryKb() << "kB";
+
+    if (m_statsInterval > 0) {
+        m_lastCpuNs    = 0;
+        m_lastReportMs = QDateTime::currentMSecsSinceEpoch();
+        m_statsTimer   = new QTimer(this);
+        connect(m_statsTimer, &QTimer::timeout, this, &GcsDaemon::reportStats);
+        m_statsTimer->start(m_statsInterval * 1000);
+    }
+    return true;
+}
+
+void GcsDaemon::stop()
+{
+    if (m_statsTimer) {
+        m_statsTimer->stop();
+    }
+
+    for (int i = 0; i < m_links.size(); ++i) {
+        // Close the devices and flush the logs before the threads go away
+        QMetaObject::invokeMethod(m_links[i], "stop", Qt::BlockingQueuedConnection);
+        m_threads[i]->quit();
+        m_threads[i]->wait();
+    }
+    m_links.clear();
+    qDeleteAll(m_threads);
+    m_threads.clear();
+}
+
+void GcsDaemon::reportStats()
+{
+    quint64 cpuNs = 0;
+    qint64 nowMs  = QDateTime::currentMSecsSinceEpoch();
+
+#ifdef Q_OS_UNIX
+    struct timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0) {
+        cpuNs = (quint64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+#endif
+    if (m_lastCpuNs != 0 && nowMs > m_lastReportMs) {
+        qDebug() << "GcsDaemon - process cpu" << QString::number((cpuNs - m_lastCpuNs) / 1e4 / (nowMs - m_lastReportMs), 'f', 1) + "%"
+                 << "memory" << residentMemoryKb() << "kB";
+    }
+    m_lastCpuNs    = cpuNs;
+    m_lastReportMs = nowMs;
+
+    foreach(TelemetryLink * link, m_links) {
+        // Sampled in the link thread for its own cpu time
+        QMetaObject::invokeMethod(link, "reportStats", Qt::QueuedConnection);
+    }
+}
+
+void GcsDaemon::printStats(const QString &report)
+{
+    qDebug() << "GcsDaemon -" << qPrintable(report);
+}
+
+qint64 GcsDaemon::residentMemoryKb()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+        }
+    }
+#endif
+    return 0;
+}
+
+quint64 GcsDaemon::threadCpuTimeNs()
+{
+#ifdef Q_OS_UNIX
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return (quint64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ *
+ * @file       gcsdaemon.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSDaemon GCS Daemon
+ * @{
+ * @brief Headless GCS: telemetry, logging, relay and stream service per link
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef GCSDAEMON_H
+#define GCSDAEMON_H
+
+#include "telemetrylink.h"
+
+#include <QObject>
+#include <QList>
+
+class QThread;
+class QTimer;
+class StreamServer;
+
+class GcsDaemon : public QObject {
+    Q_OBJECT
+
+public:
+    GcsDaemon(QObject *parent = 0);
+    ~GcsDaemon();
+
+    bool loadConfig(const QString &fileName, QString *errorString);
+    bool start(QString *errorString);
+
+    // Resident set size of the process, 0 where unknown
+    static qint64 residentMemoryKb();
+    // CPU time used by the calling thread
+    static quint64 threadCpuTimeNs();
+
+public slots:
+    void stop();
+
+private slots:
+    void reportStats();
+    void printStats(const QString &report);
+
+private:
+    QList<LinkConfig> m_linkConfigs;
+    int m_statsInterval;
+    bool m_streamEnabled;
+    quint16 m_streamPort;
+
+    StreamServer *m_streamServer;
+    QList<TelemetryLink *> m_links;
+    QList<QThread *> m_threads;
+    QTimer *m_statsTimer;
+    quint64 m_lastCpuNs;
+    qint64 m_lastReportMs;
+};
+
+#endif // GCSDAEMON_H
@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSDaemon GCS Daemon
+ * @{
+ * @brief Headless GCS daemon entry point
+ *
+ * Usage: librepilot-gcsd [-c config]
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "gcsdaemon.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <signal.h>
+#include <unistd.h>
+
+static int signalPipe[2];
+
+static void signalHandler(int)
+{
+    char c = 1;
+
+    // Only async signal safe calls here, the notifier quits the event loop
+    if (::write(signalPipe[1], &c, sizeof(c)) < 0) {}
+}
+
+static void setupSignalHandlers()
+{
+    if (::pipe(signalPipe) != 0) {
+        qWarning() << "Couldn't create signal pipe";
+        return;
+    }
+
+    QSocketNotifier *notifier = new QSocketNotifier(signalPipe[0], QSocketNotifier::Read, qApp);
+    QObject::connect(notifier, &QSocketNotifier::activated, qApp, &QCoreApplication::quit);
+
+    struct sigaction action;
+    action.sa_handler = signalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags   = SA_RESTART;
+    sigaction(SIGINT, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+}
+#endif // Q_OS_UNIX
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName(GCS_BIG_NAME " Daemon");
+    QCoreApplication::setOrganizationName(ORG_BIG_NAME);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless ground control station: telemetry, logging, relay and stream service");
+    parser.addHelpOption();
+    QCommandLineOption configOption(QStringList() << "c" << "config", "Configuration file.", "config", "gcsd.conf");
+    parser.addOption(configOption);
+    parser.process(app);
+
+    GcsDaemon daemon;
+    QString errorString;
+
+    if (!daemon.loadConfig(parser.value(configOption), &errorString)
+        || !daemon.start(&errorString)) {
+        qCritical() << qPrintable(errorString);
+        return 1;
+    }
+
+#ifdef Q_OS_UNIX
+    setupSignalHandlers();
+#endif
+
+    int ret = app.exec();
+    daemon.stop();
+    return ret;
+}
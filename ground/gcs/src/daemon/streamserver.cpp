@@ -0,0 +1,85 @@
+/**
+ ******************************************************************************
+ *
+ * @file       streamserver.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSDaemon GCS Daemon
+ * @{
+ * @brief JSON stream service of the headless GCS daemon
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "streamserver.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QDebug>
+
+StreamServer::StreamServer(QObject *parent) : QObject(parent),
+    m_server(new QTcpServer(this)),
+    m_clientCount(0)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &StreamServer::clientConnected);
+}
+
+StreamServer::~StreamServer()
+{
+    foreach(QTcpSocket * client, m_clients) {
+        client->close();
+    }
+    m_server->close();
+}
+
+bool StreamServer::listen(quint16 port, QString *errorString)
+{
+    if (!m_server->listen(QHostAddress::Any, port)) {
+        *errorString = tr("Couldn't start stream service: ") + m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+void StreamServer::broadcast(const QByteArray &data)
+{
+    foreach(QTcpSocket * client, m_clients) {
+        if (client->isOpen()) {
+            client->write(data);
+        }
+    }
+}
+
+void StreamServer::clientConnected()
+{
+    QTcpSocket *pending = m_server->nextPendingConnection();
+
+    if (pending == Q_NULLPTR) {
+        return;
+    }
+    qDebug() << "StreamServer - client connected" << pending->peerAddress().toString();
+
+    connect(pending, &QTcpSocket::disconnected, this, &StreamServer::clientDisconnected);
+    m_clients.append(pending);
+    m_clientCount.store(m_clients.size());
+}
+
+void StreamServer::clientDisconnected()
+{
+    QTcpSocket *client = static_cast<QTcpSocket *>(sender());
+
+    m_clients.removeAll(client);
+    m_clientCount.store(m_clients.size());
+    client->deleteLater();
+}
@@ -0,0 +1,66 @@
+/**
+ ******************************************************************************
+ *
+ * @file       streamserver.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSDaemon GCS Daemon
+ * @{
+ * @brief JSON stream service of the headless GCS daemon
+ *
+ * Same newline delimited JSON format as the StreamService plugin,
+ * with an additional "link" member naming the link of the object.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef STREAMSERVER_H
+#define STREAMSERVER_H
+
+#include <QObject>
+#include <QList>
+#include <QAtomicInt>
+
+class QTcpServer;
+class QTcpSocket;
+
+class StreamServer : public QObject {
+    Q_OBJECT
+
+public:
+    StreamServer(QObject *parent = 0);
+    ~StreamServer();
+
+    bool listen(quint16 port, QString *errorString);
+
+    // Thread safe, lets the links skip the JSON encoding when nobody listens
+    bool hasClients() const
+    {
+        return m_clientCount.load() > 0;
+    }
+
+public slots:
+    void broadcast(const QByteArray &data);
+
+private slots:
+    void clientConnected();
+    void clientDisconnected();
+
+private:
+    QTcpServer *m_server;
+    QList<QTcpSocket *> m_clients;
+    QAtomicInt m_clientCount;
+};
+
+#endif // STREAMSERVER_H
@@ -0,0 +1,444 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrylink.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSDaemon GCS Daemon
+ * @{
+ * @brief One vehicle link of the headless GCS daemon
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "telemetrylink.h"
+#include "streamserver.h"
+#include "gcsdaemon.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavtalk.h"
+#include "telemetry.h"
+#include "telemetrymonitor.h"
+#include <utils/logfile.h>
+
+#include <QTimer>
+#include <QDir>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSerialPort>
+#include <QtEndian>
+#include <QDebug>
+
+// Framing of the relay client input, see UAVTalk
+static const quint8 SYNC_VAL       = 0x3C;
+static const quint8 TYPE_MASK      = 0xF8;
+static const quint8 TYPE_VER       = 0x20;
+static const int MIN_HEADER_LENGTH = 8;
+static const int MAX_HEADER_LENGTH = 10;
+static const int MAX_PAYLOAD_LENGTH = 256;
+
+/**
+ * Removes all complete UAVTalk frames from the buffer and returns them,
+ * bytes in front of a sync byte are dropped. Several relay clients may
+ * write to the same vehicle, only whole frames can be interleaved.
+ */
+static QByteArray takeFrames(QByteArray &buffer)
+{
+    QByteArray frames;
+    int pos = 0;
+
+    while (buffer.size() - pos >= 4) {
+        const quint8 *data = reinterpret_cast<const quint8 *>(buffer.constData()) + pos;
+        if (data[0] != SYNC_VAL || (data[1] & TYPE_MASK) != TYPE_VER) {
+            ++pos;
+            continue;
+        }
+        int size = qFromLittleEndian<quint16>(data + 2);
+        if (size < MIN_HEADER_LENGTH || size > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+            ++pos;
+            continue;
+        }
+        // Frame plus CRC byte
+        if (buffer.size() - pos < size + 1) {
+            break;
+        }
+        frames.append(buffer.constData() + pos, size + 1);
+        pos += size + 1;
+    }
+    buffer.remove(0, pos);
+    return frames;
+}
+
+TelemetryLink::TelemetryLink(const LinkConfig &config, StreamServer *streamServer) :
+    m_config(config),
+    m_streamServer(streamServer),
+    m_streamSubscription(0),
+    m_objMngr(0),
+    m_device(0),
+    m_uavTalk(0),
+    m_telemetry(0),
+    m_telemetryMonitor(0),
+    m_connected(false),
+    m_reopenTimer(0),
+    m_logFile(0),
+    m_logTalk(0),
+    m_relayServer(0),
+    m_memoryKb(0),
+    m_lastCpuNs(0),
+    m_lastReportMs(0)
+{}
+
+TelemetryLink::~TelemetryLink()
+{
+    stop();
+}
+
+void TelemetryLink::start()
+{
+    qint64 memoryBefore = GcsDaemon::residentMemoryKb();
+
+    m_objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+
+    if (!m_config.logDir.isEmpty()) {
+        openLog();
+    }
+
+    // The log writes every update as it happens, the stream sends them in batches
+    if (m_logTalk) {
+        foreach(QList<UAVObject *> instances, m_objMngr->getObjects()) {
+            foreach(UAVObject * obj, instances) {
+                subscribe(obj);
+            }
+        }
+        connect(m_objMngr, &UAVObjectManager::newInstance, this, &TelemetryLink::newInstance);
+    }
+    if (m_streamServer) {
+        m_streamSubscription = m_objMngr->getUpdateBus()->subscribe(this);
+        m_streamSubscription->setDataCaptured(true);
+        connect(m_streamSubscription, &UAVObjectUpdateSubscription::updated, this, &TelemetryLink::objectsUpdated);
+    }
+
+    if (m_config.relayPort != 0) {
+        m_relayServer = new QTcpServer(this);
+        connect(m_relayServer, &QTcpServer::newConnection, this, &TelemetryLink::relayClientConnected);
+        if (!m_relayServer->listen(QHostAddress::Any, m_config.relayPort)) {
+            qWarning() << "TelemetryLink" << m_config.name << "- couldn't start relay:" << m_relayServer->errorString();
+        }
+    }
+
+    m_reopenTimer = new QTimer(this);
+    m_reopenTimer->setSingleShot(true);
+    m_reopenTimer->setInterval(REOPEN_PERIOD_MS);
+    connect(m_reopenTimer, &QTimer::timeout, this, &TelemetryLink::openDevice);
+
+    openDevice();
+
+    m_memoryKb     = GcsDaemon::residentMemoryKb() - memoryBefore;
+    m_lastCpuNs    = GcsDaemon::threadCpuTimeNs();
+    m_lastReportMs = QDateTime::currentMSecsSinceEpoch();
+}
+
+void TelemetryLink::stop()
+{
+    if (!m_objMngr) {
+        return;
+    }
+
+    closeDevice();
+
+    if (m_relayServer) {
+        foreach(QTcpSocket * client, m_relayClients.keys()) {
+            client->disconnect(this);
+            client->close();
+            delete client;
+        }
+        m_relayClients.clear();
+        delete m_relayServer;
+        m_relayServer = 0;
+    }
+
+    if (m_logTalk) {
+        delete m_logTalk;
+        m_logTalk = 0;
+        m_logFile->close();
+        qDebug() << "TelemetryLink" << m_config.name << "- closed log" << m_logFile->fileName();
+        delete m_logFile;
+        m_logFile = 0;
+    }
+
+    delete m_reopenTimer;
+    m_reopenTimer = 0;
+
+    // The objects are owned by the manager
+    delete m_objMngr;
+    m_objMngr = 0;
+}
+
+void TelemetryLink::reportStats()
+{
+    quint64 cpuNs = GcsDaemon::threadCpuTimeNs();
+    qint64 nowMs  = QDateTime::currentMSecsSinceEpoch();
+    double cpuPercent = 0.0;
+
+    if (nowMs > m_lastReportMs) {
+        cpuPercent = (cpuNs - m_lastCpuNs) / 1e4 / (nowMs - m_lastReportMs);
+    }
+    m_lastCpuNs    = cpuNs;
+    m_lastReportMs = nowMs;
+
+    QString report = QString("%1: %2, cpu %3%, memory %4 kB")
+                     .arg(m_config.name)
+                     .arg(m_connected ? "connected" : (m_uavTalk ? "open" : "closed"))
+                     .arg(cpuPercent, 0, 'f', 1)
+                     .arg(m_memoryKb);
+    if (m_uavTalk) {
+        UAVTalk::ComStats stats = m_uavTalk->getStats();
+        report += QString(", rx %1 bytes %2 objects %3 errors, tx %4 bytes %5 objects")
+                  .arg(stats.rxBytes).arg(stats.rxObjects).arg(stats.rxErrors)
+                  .arg(stats.txBytes).arg(stats.txObjects);
+    }
+    if (m_relayServer) {
+        report += QString(", %1 relay clients").arg(m_relayClients.size());
+    }
+    emit statsReport(report);
+}
+
+void TelemetryLink::openDevice()
+{
+    if (m_config.type == "serial") {
+        QSerialPort *port = new QSerialPort(m_config.device, this);
+        port->setBaudRate(m_config.baudRate);
+        if (!port->open(QIODevice::ReadWrite)) {
+            qWarning() << "TelemetryLink" << m_config.name << "- couldn't open" << m_config.device << ":" << port->errorString();
+            delete port;
+            m_reopenTimer->start();
+            return;
+        }
+        connect(port, static_cast<void(QSerialPort::*) (QSerialPort::SerialPortError)>(&QSerialPort::error), this,
+                [this, port](QSerialPort::SerialPortError error) {
+            if (error == QSerialPort::ResourceError && m_device == port) {
+                // Device unplugged
+                deviceClosed();
+            }
+        });
+        m_device = port;
+    } else {
+        // Connects in the background, the other links of this thread keep running meanwhile
+        QTcpSocket *socket = new QTcpSocket(this);
+        connect(socket, &QTcpSocket::connected, this, &TelemetryLink::deviceOpened);
+        connect(socket, &QTcpSocket::disconnected, this, &TelemetryLink::deviceClosed);
+        connect(socket, static_cast<void(QAbstractSocket::*) (QAbstractSocket::SocketError)>(&QAbstractSocket::error), this,
+                [this, socket](QAbstractSocket::SocketError) {
+            if (m_device != socket) {
+                return;
+            }
+            if (m_uavTalk) {
+                deviceClosed();
+            } else {
+                connectFailed(socket->errorString());
+            }
+        });
+        // A host that doesn't answer only fails after the system TCP timeout
+        QTimer::singleShot(REOPEN_PERIOD_MS, socket, [this, socket]() {
+            if (m_device == socket && !m_uavTalk) {
+                connectFailed(tr("connection timed out"));
+            }
+        });
+        m_device = socket;
+        socket->connectToHost(m_config.host, m_config.port);
+        return;
+    }
+    deviceOpened();
+}
+
+void TelemetryLink::connectFailed(const QString &error)
+{
+    qWarning() << "TelemetryLink" << m_config.name << "- couldn't connect to" << m_config.host << m_config.port << ":" << error;
+    closeDevice();
+    m_reopenTimer->start();
+}
+
+void TelemetryLink::deviceOpened()
+{
+    qDebug() << "TelemetryLink" << m_config.name << "- device open";
+
+    // The link feeds UAVTalk itself so that the relay sees the same bytes
+    m_uavTalk = new UAVTalk(m_device, m_objMngr);
+    connect(m_device, &QIODevice::readyRead, this, &TelemetryLink::deviceReadyRead);
+
+    if (m_config.telemetry) {
+        m_telemetry = new Telemetry(m_uavTalk, m_objMngr);
+        m_telemetryMonitor = new TelemetryMonitor(m_objMngr, m_telemetry);
+        connect(m_telemetryMonitor, &TelemetryMonitor::connected, this, &TelemetryLink::telemetryConnected);
+        connect(m_telemetryMonitor, &TelemetryMonitor::disconnected, this, &TelemetryLink::telemetryDisconnected);
+    }
+}
+
+void TelemetryLink::closeDevice()
+{
+    if (m_reopenTimer) {
+        m_reopenTimer->stop();
+    }
+    if (!m_device) {
+        return;
+    }
+
+    // Same order as the TelemetryManager
+    delete m_telemetryMonitor;
+    m_telemetryMonitor = 0;
+    delete m_telemetry;
+    m_telemetry = 0;
+    delete m_uavTalk;
+    m_uavTalk = 0;
+
+    m_device->disconnect(this);
+    m_device->close();
+    m_device->deleteLater();
+    m_device    = 0;
+    m_connected = false;
+}
+
+void TelemetryLink::deviceReadyRead()
+{
+    if (!m_device) {
+        return;
+    }
+
+    QByteArray data = m_device->readAll();
+
+    for (QHash<QTcpSocket *, QByteArray>::const_iterator it = m_relayClients.constBegin(); it != m_relayClients.constEnd(); ++it) {
+        it.key()->write(data);
+    }
+    m_uavTalk->processInputBytes(reinterpret_cast<const quint8 *>(data.constData()), data.size());
+}
+
+void TelemetryLink::deviceClosed()
+{
+    qWarning() << "TelemetryLink" << m_config.name << "- device closed";
+    closeDevice();
+    if (m_reopenTimer) {
+        m_reopenTimer->start();
+    }
+}
+
+void TelemetryLink::objectUpdated(UAVObject *obj)
+{
+    if (m_logTalk) {
+        m_logTalk->sendObject(obj, false, false);
+    }
+}
+
+void TelemetryLink::objectsUpdated(const UAVObjectUpdateSubscription::UpdateBatch &batch)
+{
+    if (!m_streamServer || !m_streamServer->hasClients()) {
+        return;
+    }
+
+    qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+    QByteArray data;
+    foreach(const UAVObjectUpdateSubscription::Update &update, batch) {
+        QJsonObject json;
+        m_streamSubscription->sampleToJson(update, json);
+        json.insert("gcs_timestamp_ms", QJsonValue(timestamp));
+        json.insert("link", QJsonValue(m_config.name));
+        data += QJsonDocument(json).toJson(QJsonDocument::Compact) + "\n";
+    }
+    emit streamData(data);
+}
+
+void TelemetryLink::newInstance(UAVObject *obj)
+{
+    subscribe(obj);
+}
+
+void TelemetryLink::telemetryConnected()
+{
+    qDebug() << "TelemetryLink" << m_config.name << "- telemetry connected";
+    m_connected = true;
+}
+
+void TelemetryLink::telemetryDisconnected()
+{
+    qDebug() << "TelemetryLink" << m_config.name << "- telemetry disconnected";
+    m_connected = false;
+}
+
+void TelemetryLink::relayClientConnected()
+{
+    QTcpSocket *client = m_relayServer->nextPendingConnection();
+
+    if (!client) {
+        return;
+    }
+    qDebug() << "TelemetryLink" << m_config.name << "- relay client connected" << client->peerAddress().toString();
+
+    connect(client, &QTcpSocket::readyRead, this, &TelemetryLink::relayClientReadyRead);
+    connect(client, &QTcpSocket::disconnected, this, &TelemetryLink::relayClientDisconnected);
+    m_relayClients.insert(client, QByteArray());
+}
+
+void TelemetryLink::relayClientReadyRead()
+{
+    QTcpSocket *client = static_cast<QTcpSocket *>(sender());
+    QByteArray &buffer = m_relayClients[client];
+
+    buffer.append(client->readAll());
+    QByteArray frames = takeFrames(buffer);
+    if (!frames.isEmpty() && m_device) {
+        m_device->write(frames);
+    }
+}
+
+void TelemetryLink::relayClientDisconnected()
+{
+    QTcpSocket *client = static_cast<QTcpSocket *>(sender());
+
+    m_relayClients.remove(client);
+    client->deleteLater();
+}
+
+void TelemetryLink::openLog()
+{
+    QDir dir(m_config.logDir);
+
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning() << "TelemetryLink" << m_config.name << "- couldn't create log directory" << m_config.logDir;
+        return;
+    }
+
+    m_logFile = new LogFile();
+    // Long sessions, compressed by default
+    m_logFile->setFileName(dir.filePath(QString("%1-%2.%3")
+                                        .arg(m_config.name)
+                                        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"))
+                                        .arg(m_config.compressLog ? "oplz" : "opl")));
+    if (!m_logFile->open(QIODevice::WriteOnly)) {
+        qWarning() << "TelemetryLink" << m_config.name << "- couldn't open log" << m_logFile->fileName();
+        delete m_logFile;
+        m_logFile = 0;
+        return;
+    }
+    m_logTalk = new UAVTalk(m_logFile, m_objMngr);
+    qDebug() << "TelemetryLink" << m_config.name << "- logging to" << m_logFile->fileName();
+}
+
+void TelemetryLink::subscribe(UAVObject *obj)
+{
+    connect(obj, &UAVObject::objectUpdated, this, &TelemetryLink::objectUpdated);
+}
@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrylink.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSDaemon GCS Daemon
+ * @{
+ * @brief One vehicle link of the headless GCS daemon
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TELEMETRYLINK_H
+#define TELEMETRYLINK_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QPointer>
+
+#include "uavobjectupdatebus.h"
+
+class QIODevice;
+class QTimer;
+class QTcpServer;
+class QTcpSocket;
+class LogFile;
+class UAVObject;
+class UAVObjectManager;
+class UAVTalk;
+class Telemetry;
+class TelemetryMonitor;
+class StreamServer;
+
+struct LinkConfig {
+    QString name;
+    // "serial" or "tcp"
+    QString type;
+    QString device;
+    qint32  baudRate;
+    QString host;
+    quint16 port;
+    // Run the GCS side of the telemetry handshake, otherwise only listen
+    bool    telemetry;
+    // Directory for .opl logs, empty to disable logging
+    QString logDir;
+    bool compressLog;
+    // TCP port forwarding the raw UAVTalk stream, 0 to disable
+    quint16 relayPort;
+};
+
+/**
+ * A vehicle link with its own object manager, UAVTalk, telemetry,
+ * logger and relay. Lives in its own thread, all slots must be
+ * invoked through queued connections.
+ */
+class TelemetryLink : public QObject {
+    Q_OBJECT
+
+public:
+    TelemetryLink(const LinkConfig &config, StreamServer *streamServer);
+    ~TelemetryLink();
+
+    QString name() const
+    {
+        return m_config.name;
+    }
+
+public slots:
+    void start();
+    void stop();
+    void reportStats();
+
+signals:
+    void streamData(const QByteArray &data);
+    void statsReport(const QString &report);
+
+private slots:
+    void openDevice();
+    void deviceOpened();
+    void deviceReadyRead();
+    void deviceClosed();
+    void objectUpdated(UAVObject *obj);
+    void objectsUpdated(const UAVObjectUpdateSubscription::UpdateBatch &batch);
+    void newInstance(UAVObject *obj);
+    void telemetryConnected();
+    void telemetryDisconnected();
+    void relayClientConnected();
+    void relayClientReadyRead();
+    void relayClientDisconnected();
+
+private:
+    static const int REOPEN_PERIOD_MS = 5000;
+
+    LinkConfig m_config;
+    QPointer<StreamServer> m_streamServer;
+    UAVObjectUpdateSubscription *m_streamSubscription;
+
+    UAVObjectManager *m_objMngr;
+    QIODevice *m_device;
+    UAVTalk *m_uavTalk;
+    Telemetry *m_telemetry;
+    TelemetryMonitor *m_telemetryMonitor;
+    bool m_connected;
+    QTimer *m_reopenTimer;
+
+    LogFile *m_logFile;
+    UAVTalk *m_logTalk;
+
+    QTcpServer *m_relayServer;
+    QHash<QTcpSocket *, QByteArray> m_relayClients;
+
+    qint64 m_memoryKb;
+    quint64 m_lastCpuNs;
+    qint64 m_lastReportMs;
+
+    void connectFailed(const QString &error);
+    void closeDevice();
+    void openLog();
+    void subscribe(UAVObject *obj);
+};
+
+#endif // TELEMETRYLINK_H
@@ -0,0 +1,261 @@
+/**
+ ******************************************************************************
+ *
+ * @file       gadgetbench.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GadgetBench Gadget benchmark
+ * @{
+ * @brief Renders one gadget offscreen while it is fed updates and times its frames
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "gadgetbench.h"
+#include "updatefeed.h"
+
+#include <coreplugin/icore.h>
+#include <coreplugin/iuavgadget.h>
+#include <coreplugin/uavgadgetinstancemanager.h>
+
+#include <QEventLoop>
+#include <QSettings>
+#include <QTemporaryFile>
+#include <QTimer>
+#include <QWidget>
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+BenchApplication::BenchApplication(int &argc, char * *argv) : QApplication(argc, argv),
+    m_window(0),
+    m_pendingNs(0),
+    m_paints(0),
+    m_timing(false)
+{
+    m_clock.start();
+}
+
+void BenchApplication::record(QWidget *window)
+{
+    m_window = window;
+    reset();
+}
+
+void BenchApplication::reset()
+{
+    m_frames.clear();
+    m_pendingNs = 0;
+    m_paints    = 0;
+}
+
+bool BenchApplication::inWindow(QObject *receiver) const
+{
+    return receiver->isWidgetType() && static_cast<QWidget *>(receiver)->window() == m_window;
+}
+
+bool BenchApplication::notify(QObject *receiver, QEvent *event)
+{
+    if (!m_window || !inWindow(receiver)) {
+        return QApplication::notify(receiver, event);
+    }
+
+    QEvent::Type type = event->type();
+    if (type == QEvent::Paint) {
+        m_paints++;
+    }
+    // Only the outermost event is timed, paints are sent from the update request
+    if (m_timing || (type != QEvent::UpdateRequest && type != QEvent::UpdateLater
+                     && type != QEvent::Paint && type != QEvent::Timer)) {
+        return QApplication::notify(receiver, event);
+    }
+
+    bool flush   = type == QEvent::UpdateRequest && receiver == m_window;
+    qint64 start = m_clock.nsecsElapsed();
+    m_timing     = true;
+    bool ret     = QApplication::notify(receiver, event);
+    m_timing     = false;
+    m_pendingNs += m_clock.nsecsElapsed() - start;
+    if (flush) {
+        m_frames.append(m_pendingNs / 1e6);
+        m_pendingNs = 0;
+    }
+    return ret;
+}
+
+GadgetBench::GadgetBench(BenchApplication *app, const Options &options) :
+    m_app(app),
+    m_options(options)
+{}
+
+qint64 GadgetBench::cpuTimeUs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation, exit, kernel, user;
+
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    // 100 ns units
+    quint64 k = ((quint64)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    quint64 u = ((quint64)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return (k + u) / 10;
+
+#else
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (qint64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+           + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+
+#endif
+}
+
+void GadgetBench::wait(UpdateFeed *feed, int ms)
+{
+    QEventLoop loop;
+
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    QObject::connect(feed, &UpdateFeed::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+static double percentile(const QVector<double> &sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    // Nearest rank
+    int rank = (int)ceil(p / 100.0 * sorted.size());
+    return sorted.at(qBound(0, rank - 1, sorted.size() - 1));
+}
+
+bool GadgetBench::measure(UpdateFeed *feed, QJsonObject *result, QString *errorString)
+{
+    if (!feed->start(errorString)) {
+        return false;
+    }
+    wait(feed, m_options.warmupMs);
+
+    m_app->reset();
+    feed->resetUpdates();
+    QElapsedTimer timer;
+    timer.start();
+    qint64 cpuStart = cpuTimeUs();
+
+    wait(feed, m_options.durationMs);
+
+    double seconds  = timer.nsecsElapsed() / 1e9;
+    double cpuMs    = (cpuTimeUs() - cpuStart) / 1e3;
+    quint64 updates = feed->updates();
+    QVector<double> frames = m_app->frames();
+    int paints = m_app->paints();
+    feed->stop();
+
+    if (updates == 0) {
+        *errorString = "No updates during the run";
+        return false;
+    }
+
+    (*result)["seconds"]          = seconds;
+    (*result)["updates"]          = (double)updates;
+    (*result)["updatesPerSecond"] = updates / seconds;
+    (*result)["cpuMs"]            = cpuMs;
+    (*result)["cpuPerUpdateUs"]   = cpuMs * 1e3 / updates;
+
+    if (m_app->recordedWindow()) {
+        std::sort(frames.begin(), frames.end());
+        double total = 0;
+        foreach(double frame, frames) {
+            total += frame;
+        }
+        QJsonObject frameTime;
+        frameTime["mean"] = frames.isEmpty() ? 0 : total / frames.size();
+        frameTime["p50"]  = percentile(frames, 50);
+        frameTime["p95"]  = percentile(frames, 95);
+        frameTime["p99"]  = percentile(frames, 99);
+        frameTime["max"]  = frames.isEmpty() ? 0 : frames.last();
+        (*result)["frames"]          = frames.size();
+        (*result)["framesPerSecond"] = frames.size() / seconds;
+        (*result)["paintsPerSecond"] = paints / seconds;
+        (*result)["frameTimeMs"]     = frameTime;
+    }
+    return true;
+}
+
+QJsonObject GadgetBench::runBaseline(UpdateFeed *feed, QString *errorString)
+{
+    QJsonObject result;
+
+    m_app->record(0);
+    if (!measure(feed, &result, errorString)) {
+        return QJsonObject();
+    }
+    return result;
+}
+
+QJsonObject GadgetBench::run(const QString &gadget, UpdateFeed *feed, QString *errorString)
+{
+    Core::UAVGadgetInstanceManager *im = Core::ICore::instance()->uavGadgetInstanceManager();
+    QString classId       = gadget.section(':', 0, 0);
+    QString configuration = gadget.section(':', 1);
+
+    if (!im->classIds().contains(classId)) {
+        *errorString = QString("Unknown gadget %1").arg(classId);
+        return QJsonObject();
+    }
+    QStringList configurations = im->configurationNames(classId);
+    if (configuration.isEmpty() && !configurations.isEmpty()) {
+        configuration = configurations.first();
+    } else if (!configurations.contains(configuration)) {
+        *errorString = QString("Unknown configuration %1 of %2").arg(configuration).arg(classId);
+        return QJsonObject();
+    }
+
+    Core::IUAVGadget *uavGadget = im->createGadget(classId, 0, false);
+    // Selected by name, as when a workspace is restored
+    QTemporaryFile stateFile;
+    stateFile.open();
+    {
+        QSettings state(stateFile.fileName(), QSettings::IniFormat);
+        state.setValue("activeConfiguration", configuration);
+        uavGadget->restoreState(&state);
+    }
+
+    QWidget *widget = uavGadget->widget();
+    widget->resize(m_options.size);
+    widget->show();
+
+    QJsonObject result;
+    result["gadget"]        = classId;
+    result["configuration"] = configuration;
+
+    m_app->record(widget);
+    bool ok = measure(feed, &result, errorString);
+    m_app->record(0);
+
+    im->removeGadget(uavGadget);
+    if (!ok) {
+        return QJsonObject();
+    }
+    return result;
+}
@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ *
+ * @file       gadgetbench.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GadgetBench Gadget benchmark
+ * @{
+ * @brief Renders one gadget offscreen while it is fed updates and times its frames
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef GADGETBENCH_H
+#define GADGETBENCH_H
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+class UpdateFeed;
+
+/**
+ * Times the rendering work of one top level widget from QApplication::notify():
+ * paint and update requests and the timers of its widgets (QQuickWidget renders
+ * its scene from a timer). A frame is the work up to and including an update
+ * request of the window, which paints the dirty widgets and flushes the backing store.
+ */
+class BenchApplication : public QApplication {
+    Q_OBJECT
+
+public:
+    BenchApplication(int &argc, char * *argv);
+
+    void record(QWidget *window);
+    void reset();
+
+    QWidget *recordedWindow() const
+    {
+        return m_window;
+    }
+
+    // Milliseconds
+    QVector<double> frames() const
+    {
+        return m_frames;
+    }
+    int paints() const
+    {
+        return m_paints;
+    }
+
+    bool notify(QObject *receiver, QEvent *event);
+
+private:
+    QWidget *m_window;
+    QElapsedTimer m_clock;
+    QVector<double> m_frames;
+    qint64 m_pendingNs;
+    int m_paints;
+    bool m_timing;
+
+    bool inWindow(QObject *receiver) const;
+};
+
+class GadgetBench {
+public:
+    struct Options {
+        QSize size;
+        int warmupMs;
+        int durationMs;
+    };
+
+    GadgetBench(BenchApplication *app, const Options &options);
+
+    // Process CPU time in microseconds, user and system
+    static qint64 cpuTimeUs();
+
+    // Only the feed, the CPU used without a gadget to render
+    QJsonObject runBaseline(UpdateFeed *feed, QString *errorString);
+
+    // classId or classId:configuration, the first configuration by default
+    QJsonObject run(const QString &gadget, UpdateFeed *feed, QString *errorString);
+
+private:
+    BenchApplication *m_app;
+    Options m_options;
+
+    bool measure(UpdateFeed *feed, QJsonObject *result, QString *errorString);
+    static void wait(UpdateFeed *feed, int ms);
+};
+
+#endif // GADGETBENCH_H
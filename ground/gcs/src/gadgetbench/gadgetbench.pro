@@ -0,0 +1,50 @@
+#
+# Offscreen rendering benchmark of the visual gadgets: loads the GCS plugins,
+# renders each gadget with the software raster backend while it is fed
+# synthetic or replayed UAVObject updates, and reports frame time
+# percentiles, paints/s and CPU per update as JSON for trend tracking.
+#
+# Unlike the daemon it links the plugin libraries, the gadgets are the real ones.
+#
+
+include(../../gcs.pri)
+
+TEMPLATE = app
+TARGET = $${GCS_APP_TARGET}-gadgetbench
+DESTDIR = $$GCS_APP_PATH
+
+CONFIG += console
+CONFIG -= app_bundle
+
+QT += widgets xml
+
+include(../libs/utils/utils.pri)
+include(../libs/extensionsystem/extensionsystem.pri)
+include(../plugins/coreplugin/coreplugin.pri)
+include(../plugins/uavobjects/uavobjects.pri)
+include(../plugins/uavtalk/uavtalk.pri)
+
+LIBS += -L$$GCS_PLUGIN_PATH/$$ORG_BIG_NAME
+LIBS *= -l$$qtLibraryName(Aggregation)
+
+INCLUDEPATH += \
+    $$GCS_SOURCE_TREE/src/plugins \
+    $$GCS_SOURCE_TREE/src/libs
+
+HEADERS += \
+    gadgetbench.h \
+    updatefeed.h
+
+SOURCES += \
+    main.cpp \
+    gadgetbench.cpp \
+    updatefeed.cpp
+
+!win32:!macx {
+    target.path = /bin
+    INSTALLS += target
+    QMAKE_RPATHDIR  = $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_LIBRARY_PATH, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_PLUGIN_PATH/$$ORG_BIG_NAME, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH))
+    include(../rpath.pri)
+}
@@ -0,0 +1,284 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GadgetBench Gadget benchmark
+ * @{
+ * @brief Gadget benchmark entry point
+ *
+ * Usage: librepilot-gcs-gadgetbench [-g ClassId[:Configuration]]... [--rate Hz | --replay log] [-o results.json]
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "gadgetbench.h"
+#include "updatefeed.h"
+
+#include "utils/xmlconfig.h"
+#include "utils/pathutils.h"
+
+#include <extensionsystem/pluginmanager.h>
+#include <extensionsystem/pluginspec.h>
+#include <coreplugin/icore.h>
+#include <coreplugin/uavgadgetinstancemanager.h>
+#include <uavobjects/uavobjectmanager.h>
+
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMainWindow>
+#include <QSettings>
+#include <QSysInfo>
+#include <QTemporaryDir>
+
+// The visual gadgets, each with its first configuration
+static const char *DEFAULT_GADGETS[] = {
+    "ScopeGadget", "OPMapGadget", "DialGadget", "LineardialGadget", "SystemHealthGadget", "PfdQmlGadget"
+};
+
+// Objects the default configurations of these gadgets show
+static const char *DEFAULT_OBJECTS[] = {
+    "AttitudeState", "PositionState", "VelocityState", "AirspeedState", "GPSPositionSensor", "GPSSatellites",
+    "BaroSensor", "AccelState", "GyroState", "MagState", "ActuatorDesired", "ActuatorCommand",
+    "ManualControlCommand", "StabilizationDesired", "FlightStatus", "FlightBatteryState", "SystemAlarms",
+    "SystemStats"
+};
+
+static bool intValue(const QCommandLineParser &parser, const QCommandLineOption &option, int min, int max, int *value)
+{
+    if (!parser.isSet(option)) {
+        return true;
+    }
+    bool ok;
+    int res = parser.value(option).toInt(&ok);
+    if (!ok || res < min || res > max) {
+        qCritical() << "Invalid value for" << option.names().last() << ":" << parser.value(option);
+        return false;
+    }
+    *value = res;
+    return true;
+}
+
+// The settings of a fresh install, in a temporary directory so the user settings are not touched
+static bool loadFactoryDefaults(const QString &configFile, const QString &settingsPath)
+{
+    QSettings::setPath(XmlConfig::XmlSettingsFormat, QSettings::UserScope, settingsPath);
+    QSettings::setPath(XmlConfig::XmlSettingsFormat, QSettings::SystemScope, Utils::GetDataPath());
+
+    QString fileName = configFile;
+    if (fileName.isEmpty()) {
+        fileName = Utils::GetDataPath() + "configurations/default.xml";
+    }
+    if (!QFile::exists(fileName)) {
+        qCritical() << "Configuration file" << fileName << "does not exist";
+        return false;
+    }
+
+    QSettings qs(fileName, XmlConfig::XmlSettingsFormat);
+    QSettings settings;
+    foreach(QString key, qs.allKeys()) {
+        settings.setValue(key, qs.value(key));
+    }
+    return true;
+}
+
+int main(int argc, char * *argv)
+{
+    // Software rendering without a display, unless asked otherwise
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    if (qEnvironmentVariableIsEmpty("QT_QUICK_BACKEND")) {
+        qputenv("QT_QUICK_BACKEND", "software");
+    }
+
+    BenchApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName(GCS_BIG_NAME " Gadget Benchmark");
+    QCoreApplication::setOrganizationName(ORG_BIG_NAME);
+    QSettings::setDefaultFormat(XmlConfig::XmlSettingsFormat);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders the visual gadgets offscreen while they are fed UAVObject updates, "
+                                     "reports frame times, paints/s and CPU per update as JSON");
+    parser.addHelpOption();
+    QCommandLineOption gadgetOption(QStringList() << "g" << "gadget", "Gadget to benchmark, repeatable. All visual gadgets by default.", "class[:configuration]");
+    QCommandLineOption listOption("list", "List the gadgets and their configurations.");
+    QCommandLineOption rateOption("rate", "Synthetic update rate of each object.", "Hz", "50");
+    QCommandLineOption objectsOption("objects", "Objects updated by the synthetic feed, comma separated.", "names");
+    QCommandLineOption replayOption("replay", "Replay a telemetry log instead of the synthetic feed.", "log");
+    QCommandLineOption speedOption("replay-speed", "Log replay speed.", "factor", "1");
+    QCommandLineOption durationOption("duration", "Measured time of each gadget.", "seconds", "10");
+    QCommandLineOption warmupOption("warmup", "Time before the measurement starts.", "seconds", "2");
+    QCommandLineOption widthOption("width", "Gadget width.", "pixels", "800");
+    QCommandLineOption heightOption("height", "Gadget height.", "pixels", "600");
+    QCommandLineOption configOption("config-file", "Factory configuration the gadget configurations are read from.", "file");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "JSON results file, standard output by default.", "file");
+    parser.addOption(gadgetOption);
+    parser.addOption(listOption);
+    parser.addOption(rateOption);
+    parser.addOption(objectsOption);
+    parser.addOption(replayOption);
+    parser.addOption(speedOption);
+    parser.addOption(durationOption);
+    parser.addOption(warmupOption);
+    parser.addOption(widthOption);
+    parser.addOption(heightOption);
+    parser.addOption(configOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    int rate     = 50;
+    int duration = 10;
+    int warmup   = 2;
+    int width    = 800;
+    int height   = 600;
+    double speed = 1.0;
+
+    if (!intValue(parser, rateOption, 1, 1000, &rate)
+        || !intValue(parser, durationOption, 1, 3600, &duration)
+        || !intValue(parser, warmupOption, 0, 3600, &warmup)
+        || !intValue(parser, widthOption, 16, 8192, &width)
+        || !intValue(parser, heightOption, 16, 8192, &height)) {
+        return 1;
+    }
+    if (parser.isSet(speedOption)) {
+        bool ok;
+        speed = parser.value(speedOption).toDouble(&ok);
+        if (!ok || speed <= 0.0) {
+            qCritical() << "Invalid value for replay-speed :" << parser.value(speedOption);
+            return 1;
+        }
+    }
+
+    QStringList gadgets = parser.values(gadgetOption);
+    if (gadgets.isEmpty()) {
+        for (unsigned int i = 0; i < sizeof(DEFAULT_GADGETS) / sizeof(DEFAULT_GADGETS[0]); i++) {
+            gadgets << DEFAULT_GADGETS[i];
+        }
+    }
+    QStringList objects = parser.value(objectsOption).split(',', QString::SkipEmptyParts);
+    if (objects.isEmpty()) {
+        for (unsigned int i = 0; i < sizeof(DEFAULT_OBJECTS) / sizeof(DEFAULT_OBJECTS[0]); i++) {
+            objects << DEFAULT_OBJECTS[i];
+        }
+    }
+
+    QTemporaryDir settingsDir;
+    XmlConfig::setCacheDirectory(settingsDir.path());
+    if (!settingsDir.isValid() || !loadFactoryDefaults(parser.value(configOption), settingsDir.path())) {
+        return 1;
+    }
+
+    // The plugins are loaded as the GCS does
+    ExtensionSystem::PluginManager pluginManager;
+    pluginManager.setFileExtension(QLatin1String("pluginspec"));
+    pluginManager.setPluginPaths(Utils::GetPluginPaths());
+    pluginManager.loadPlugins();
+    foreach(ExtensionSystem::PluginSpec * spec, pluginManager.plugins()) {
+        if (spec->hasError()) {
+            qWarning() << spec->errorString();
+        }
+    }
+
+    UAVObjectManager *objManager = pluginManager.getObject<UAVObjectManager>();
+    if (!Core::ICore::instance() || !objManager) {
+        qCritical() << "The Core and UAVObjects plugins are required";
+        return 1;
+    }
+    // Its workspaces would be rendered too
+    Core::ICore::instance()->mainWindow()->hide();
+
+    if (parser.isSet(listOption)) {
+        Core::UAVGadgetInstanceManager *im = Core::ICore::instance()->uavGadgetInstanceManager();
+        foreach(QString classId, im->classIds()) {
+            qDebug().noquote() << classId << ":" << im->configurationNames(classId).join(", ");
+        }
+        return 0;
+    }
+
+    UpdateFeed *feed;
+    if (parser.isSet(replayOption)) {
+        feed = new ReplayFeed(objManager, parser.value(replayOption), speed, &app);
+    } else {
+        feed = new SyntheticFeed(objManager, objects, rate, &app);
+    }
+
+    GadgetBench::Options options;
+    options.size       = QSize(width, height);
+    options.warmupMs   = warmup * 1000;
+    options.durationMs = duration * 1000;
+    GadgetBench bench(&app, options);
+    QString errorString;
+
+    QJsonObject baseline = bench.runBaseline(feed, &errorString);
+    if (baseline.isEmpty()) {
+        qCritical() << "Baseline :" << qPrintable(errorString);
+        return 1;
+    }
+    double baselineCpu = baseline["cpuPerUpdateUs"].toDouble();
+    qDebug("%-40s %8.1f us cpu/update", "baseline", baselineCpu);
+
+    QJsonArray results;
+    int failures = 0;
+    foreach(QString gadget, gadgets) {
+        QJsonObject result = bench.run(gadget, feed, &errorString);
+        if (result.isEmpty()) {
+            qCritical() << gadget << ":" << qPrintable(errorString);
+            failures++;
+            continue;
+        }
+        // What the gadget adds to the processing of an update
+        result["renderCpuPerUpdateUs"] = result["cpuPerUpdateUs"].toDouble() - baselineCpu;
+        results.append(result);
+
+        QJsonObject frameTime = result["frameTimeMs"].toObject();
+        qDebug("%-40s %8.1f us cpu/update %6.1f fps %6.1f paints/s  p50 %6.2f  p95 %6.2f  p99 %6.2f ms",
+               qPrintable(gadget), result["renderCpuPerUpdateUs"].toDouble(),
+               result["framesPerSecond"].toDouble(), result["paintsPerSecond"].toDouble(),
+               frameTime["p50"].toDouble(), frameTime["p95"].toDouble(), frameTime["p99"].toDouble());
+    }
+
+    QJsonObject report;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["qt"]        = QString(qVersion());
+    report["platform"]  = QGuiApplication::platformName();
+    report["system"]    = QSysInfo::prettyProductName();
+    report["cpu"]       = QSysInfo::currentCpuArchitecture();
+    report["feed"]      = feed->description();
+    report["width"]     = width;
+    report["height"]    = height;
+    report["baseline"]  = baseline;
+    report["gadgets"]   = results;
+
+    QByteArray json = QJsonDocument(report).toJson();
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QFile::WriteOnly | QFile::Truncate) || file.write(json) != json.size()) {
+            qCritical() << "Could not write" << file.fileName() << file.errorString();
+            return 1;
+        }
+    } else {
+        QFile out;
+        out.open(stdout, QFile::WriteOnly);
+        out.write(json);
+    }
+
+    return failures ? 1 : 0;
+}
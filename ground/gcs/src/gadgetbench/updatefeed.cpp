@@ -0,0 +1,214 @@
+/**
+ ******************************************************************************
+ *
+ * @file       updatefeed.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GadgetBench Gadget benchmark
+ * @{
+ * @brief UAVObject updates fed to the benchmarked gadgets, synthetic or from a log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "updatefeed.h"
+
+#include <uavobjects/uavobjectmanager.h>
+#include <uavobjects/uavobject.h>
+#include <uavobjects/uavobjectfield.h>
+#include <uavtalk/uavtalk.h>
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <cmath>
+
+// Period of the synthetic motion and of the enum steps
+#define SINE_PERIOD_S 5.0
+#define ENUM_STEP_S   2.0
+
+UpdateFeed::UpdateFeed(UAVObjectManager *objManager, QObject *parent) : QObject(parent),
+    m_objManager(objManager),
+    m_updates(0)
+{}
+
+void UpdateFeed::countUpdates()
+{
+    foreach(const QList<UAVObject *> &instances, m_objManager->getObjects()) {
+        foreach(UAVObject * obj, instances) {
+            connect(obj, &UAVObject::objectUnpacked, this, &UpdateFeed::objectUnpacked, Qt::UniqueConnection);
+        }
+    }
+}
+
+void UpdateFeed::objectUnpacked(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+    m_updates++;
+}
+
+SyntheticFeed::SyntheticFeed(UAVObjectManager *objManager, const QStringList &objectNames, int rateHz, QObject *parent) :
+    UpdateFeed(objManager, parent),
+    m_objectNames(objectNames),
+    m_rate(rateHz)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(1000 / m_rate);
+    connect(&m_timer, &QTimer::timeout, this, &SyntheticFeed::tick);
+}
+
+bool SyntheticFeed::start(QString *errorString)
+{
+    m_objects.clear();
+    foreach(const QString &name, m_objectNames) {
+        UAVObject *obj = m_objManager->getObject(name);
+        if (!obj) {
+            *errorString = QString("Unknown object %1").arg(name);
+            return false;
+        }
+
+        Object object;
+        object.obj = obj;
+        object.data.resize(obj->getNumBytes());
+        int offset = 0;
+        foreach(UAVObjectField * field, obj->getFields()) {
+            Field f;
+            f.offset   = offset;
+            f.type     = field->getType();
+            f.elements = field->getNumElements();
+            f.options  = field->getOptions().size();
+            object.fields.append(f);
+            offset    += field->getNumBytes();
+        }
+        m_objects.append(object);
+    }
+    countUpdates();
+    m_clock.start();
+    m_timer.start();
+    return true;
+}
+
+void SyntheticFeed::stop()
+{
+    m_timer.stop();
+}
+
+QString SyntheticFeed::description() const
+{
+    return QString("synthetic, %1 objects at %2 Hz").arg(m_objectNames.size()).arg(m_rate);
+}
+
+void SyntheticFeed::tick()
+{
+    double t = m_clock.nsecsElapsed() / 1e9;
+
+    for (int i = 0; i < m_objects.size(); i++) {
+        Object &object = m_objects[i];
+        quint8 *data   = (quint8 *)object.data.data();
+
+        // Start from the current data, bitfields and strings are kept
+        object.obj->pack(data);
+        for (int j = 0; j < object.fields.size(); j++) {
+            const Field &f = object.fields.at(j);
+            for (int k = 0; k < f.elements; k++) {
+                double s = sin(2 * M_PI * t / SINE_PERIOD_S + (j * 7 + k) * 0.37);
+                switch (f.type) {
+                case UAVObjectField::INT8:
+                    data[f.offset + k] = (quint8)(qint8)(100 * s);
+                    break;
+                case UAVObjectField::INT16:
+                    qToLittleEndian<qint16>((qint16)(1000 * s), &data[f.offset + 2 * k]);
+                    break;
+                case UAVObjectField::INT32:
+                    qToLittleEndian<qint32>((qint32)(10000 * s), &data[f.offset + 4 * k]);
+                    break;
+                case UAVObjectField::UINT8:
+                    data[f.offset + k] = (quint8)(50 + 50 * s);
+                    break;
+                case UAVObjectField::UINT16:
+                    qToLittleEndian<quint16>((quint16)(500 + 500 * s), &data[f.offset + 2 * k]);
+                    break;
+                case UAVObjectField::UINT32:
+                    qToLittleEndian<quint32>((quint32)(1000 + 1000 * s), &data[f.offset + 4 * k]);
+                    break;
+                case UAVObjectField::FLOAT32:
+                {
+                    float value = 45 * s;
+                    quint32 bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    qToLittleEndian<quint32>(bits, &data[f.offset + 4 * k]);
+                    break;
+                }
+                case UAVObjectField::ENUM:
+                    if (f.options > 0) {
+                        data[f.offset + k] = (quint8)(((int)(t / ENUM_STEP_S) + k) % f.options);
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        object.obj->unpack(data);
+    }
+}
+
+ReplayFeed::ReplayFeed(UAVObjectManager *objManager, const QString &fileName, double speed, QObject *parent) :
+    UpdateFeed(objManager, parent),
+    m_fileName(fileName),
+    m_speed(speed),
+    m_uavTalk(0)
+{
+    connect(&m_logFile, &LogFile::replayFinished, this, &UpdateFeed::finished);
+}
+
+ReplayFeed::~ReplayFeed()
+{
+    stop();
+}
+
+bool ReplayFeed::start(QString *errorString)
+{
+    m_logFile.setFileName(m_fileName);
+    if (!m_logFile.open(QIODevice::ReadOnly)) {
+        *errorString = QString("Could not open log %1").arg(m_fileName);
+        return false;
+    }
+    m_uavTalk = new UAVTalk(&m_logFile, m_objManager);
+    connect(&m_logFile, SIGNAL(readyRead()), m_uavTalk, SLOT(processInputStream()));
+    countUpdates();
+    m_logFile.setReplaySpeed(m_speed);
+    if (!m_logFile.startReplay()) {
+        *errorString = QString("Could not replay log %1").arg(m_fileName);
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void ReplayFeed::stop()
+{
+    if (m_logFile.isOpen()) {
+        m_logFile.stopReplay();
+        m_logFile.close();
+    }
+    delete m_uavTalk;
+    m_uavTalk = 0;
+}
+
+QString ReplayFeed::description() const
+{
+    return QString("replay of %1 at %2x").arg(QFileInfo(m_fileName).fileName()).arg(m_speed);
+}
@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ *
+ * @file       updatefeed.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GadgetBench Gadget benchmark
+ * @{
+ * @brief UAVObject updates fed to the benchmarked gadgets, synthetic or from a log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UPDATEFEED_H
+#define UPDATEFEED_H
+
+#include <utils/logfile.h>
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+class UAVObject;
+class UAVObjectManager;
+class UAVTalk;
+
+/**
+ * Updates are delivered the way telemetry delivers them, through UAVObject::unpack(),
+ * so the gadgets see objectUnpacked/objectUpdated and the update bus sees EVENT_UNPACKED.
+ */
+class UpdateFeed : public QObject {
+    Q_OBJECT
+
+public:
+    UpdateFeed(UAVObjectManager *objManager, QObject *parent = 0);
+
+    virtual bool start(QString *errorString) = 0;
+    virtual void stop() = 0;
+    virtual QString description() const = 0;
+
+    // Objects unpacked since the last reset
+    quint64 updates() const
+    {
+        return m_updates;
+    }
+    void resetUpdates()
+    {
+        m_updates = 0;
+    }
+
+signals:
+    // The log ended
+    void finished();
+
+protected:
+    UAVObjectManager *m_objManager;
+
+    void countUpdates();
+
+private slots:
+    void objectUnpacked(UAVObject *obj);
+
+private:
+    quint64 m_updates;
+};
+
+/**
+ * Every field element of the objects follows a slow sine with its own phase,
+ * enums step through their options every two seconds. Bitfields and strings keep
+ * their value. Read only GCS access does not matter, the data is unpacked.
+ */
+class SyntheticFeed : public UpdateFeed {
+    Q_OBJECT
+
+public:
+    SyntheticFeed(UAVObjectManager *objManager, const QStringList &objectNames, int rateHz, QObject *parent = 0);
+
+    bool start(QString *errorString);
+    void stop();
+    QString description() const;
+
+private slots:
+    void tick();
+
+private:
+    struct Field {
+        int offset;
+        int type;
+        int elements;
+        int options;
+    };
+    struct Object {
+        UAVObject *obj;
+        QVector<Field> fields;
+        QByteArray data;
+    };
+
+    QStringList m_objectNames;
+    int m_rate;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QList<Object> m_objects;
+};
+
+/**
+ * Replays a telemetry log through UAVTalk, as the logging plugin does
+ */
+class ReplayFeed : public UpdateFeed {
+    Q_OBJECT
+
+public:
+    ReplayFeed(UAVObjectManager *objManager, const QString &fileName, double speed, QObject *parent = 0);
+    ~ReplayFeed();
+
+    bool start(QString *errorString);
+    void stop();
+    QString description() const;
+
+private:
+    QString m_fileName;
+    double m_speed;
+    LogFile m_logFile;
+    UAVTalk *m_uavTalk;
+};
+
+#endif // UPDATEFEED_H
@@ -139,6 +139,8 @@ enum { debugLeaks = 0 };
     determine the type of an object.
     If there are more than one object of the given type in
     the object pool, this method will choose an arbitrary one of them.
+    The result is cached until the object pool changes, use
+    ObjectHandle to keep it across calls.
 
     \sa addObject()
  */
@@ -149,6 +151,7 @@ enum { debugLeaks = 0 };
     This method is aware of Aggregation::Aggregate, i.e. it uses
     the Aggregation::query methods instead of qobject_cast to
     determine the type of an object.
+    The result is cached until the object pool changes.
 
     \sa addObject()
  */
@@ -231,6 +234,33 @@ QList<QObject *> PluginManager::allObjects() const
     return d->allObjects;
 }
 
+/*!
+    \fn QList<QObject *> PluginManager::objectsOfType(const QMetaObject *type, QueryFunction query) const
+    \internal
+    Objects of the pool matching \a query, computed once per \a type until the pool changes.
+ */
+QList<QObject *> PluginManager::objectsOfType(const QMetaObject *type, QueryFunction query) const
+{
+    // The pool does not change while the lock is held
+    QReadLocker lock(&m_lock);
+    {
+        QMutexLocker cacheLock(&m_typeCacheLock);
+        QHash<const QMetaObject *, QList<QObject *> >::const_iterator it = m_typeCache.constFind(type);
+        if (it != m_typeCache.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QList<QObject *> results;
+    foreach(QObject * obj, d->allObjects) {
+        results += query(obj);
+    }
+
+    QMutexLocker cacheLock(&m_typeCacheLock);
+    m_typeCache.insert(type, results);
+    return results;
+}
+
 /*!
     \fn void PluginManager::loadPlugins()
     Tries to load all the plugins that were previously found when
@@ -545,6 +575,8 @@ void PluginManagerPrivate::addObject(QObject *obj)
         }
 
         allObjects.append(obj);
+        q->m_typeCache.clear();
+        q->m_generation.ref();
     }
     emit q->objectAdded(obj);
 }
@@ -572,6 +604,8 @@ void PluginManagerPrivate::removeObject(QObject *obj)
     emit q->aboutToRemoveObject(obj);
     QWriteLocker lock(&(q->m_lock));
     allObjects.removeAll(obj);
+    q->m_typeCache.clear();
+    q->m_generation.ref();
 }
 
 /*!
@@ -35,6 +35,9 @@
 #include <QtCore/QObject>
 #include <QtCore/QStringList>
 #include <QtCore/QReadWriteLock>
+#include <QtCore/QMutex>
+#include <QtCore/QHash>
+#include <QtCore/QAtomicInt>
 
 QT_BEGIN_NAMESPACE
 class QTextStream;
@@ -67,31 +70,22 @@ public:
     QList<QObject *> allObjects() const;
     template <typename T> QList<T *> getObjects() const
     {
-        QReadLocker lock(&m_lock);
-
         QList<T *> results;
-        QList<QObject *> all = allObjects();
-        QList<T *> result;
-        foreach(QObject * obj, all) {
-            result = Aggregation::query_all<T>(obj);
-            if (!result.isEmpty()) {
-                results += result;
-            }
+        foreach(QObject * obj, objectsOfType(&T::staticMetaObject, &queryAll<T>)) {
+            results.append(static_cast<T *>(obj));
         }
         return results;
     }
     template <typename T> T *getObject() const
     {
-        QReadLocker lock(&m_lock);
-
-        QList<QObject *> all = allObjects();
-        T *result = 0;
-        foreach(QObject * obj, all) {
-            if ((result = Aggregation::query<T>(obj)) != 0) {
-                break;
-            }
-        }
-        return result;
+        QList<QObject *> objects = objectsOfType(&T::staticMetaObject, &queryAll<T>);
+
+        return objects.isEmpty() ? 0 : static_cast<T *>(objects.first());
+    }
+    // Changes whenever an object is added to or removed from the pool
+    int objectPoolGeneration() const
+    {
+        return m_generation.loadAcquire();
     }
 
     // Plugin operations
@@ -126,13 +120,67 @@ private slots:
     void startTests();
 
 private:
+    typedef QList<QObject *> (*QueryFunction)(QObject *obj);
+
     Internal::PluginManagerPrivate *d;
     static PluginManager *m_instance;
     mutable QReadWriteLock m_lock;
     bool m_allPluginsLoaded;
+    // Lookup results by type, cleared when the pool changes
+    mutable QMutex m_typeCacheLock;
+    mutable QHash<const QMetaObject *, QList<QObject *> > m_typeCache;
+    QAtomicInt m_generation;
+
+    QList<QObject *> objectsOfType(const QMetaObject *type, QueryFunction query) const;
+    template <typename T> static QList<QObject *> queryAll(QObject *obj)
+    {
+        QList<QObject *> results;
+        foreach(T * result, Aggregation::query_all<T>(obj)) {
+            results.append(result);
+        }
+        return results;
+    }
 
     friend class Internal::PluginManagerPrivate;
 };
+
+/**
+ * Holds the object of a type from the pool, looked up again only after the
+ * pool changed. Meant for objects fetched on every update, to be used from
+ * one thread.
+ */
+template <typename T> class ObjectHandle {
+public:
+    ObjectHandle(PluginManager *pluginManager = PluginManager::instance())
+        : m_pluginManager(pluginManager), m_generation(-1), m_object(0)
+    {}
+
+    T *get() const
+    {
+        int generation = m_pluginManager->objectPoolGeneration();
+
+        if (generation != m_generation) {
+            m_object     = m_pluginManager->getObject<T>();
+            m_generation = generation;
+        }
+        return m_object;
+    }
+
+    T *operator->() const
+    {
+        return get();
+    }
+
+    operator T *() const
+    {
+        return get();
+    }
+
+private:
+    PluginManager *m_pluginManager;
+    mutable int m_generation;
+    mutable T *m_object;
+};
 } // namespace ExtensionSystem
 
 #endif // EXTENSIONSYSTEM_PLUGINMANAGER_H
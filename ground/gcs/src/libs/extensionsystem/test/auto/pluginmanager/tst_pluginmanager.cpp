@@ -33,6 +33,7 @@
 #include <QtTest/QtTest>
 
 #include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
 
 using namespace ExtensionSystem;
 
@@ -47,6 +48,9 @@ private slots:
     void addRemoveObjects();
     void getObject();
     void getObjects();
+    void getObjectAfterAddRemove();
+    void objectHandle();
+    void lookupTiming();
     void plugins();
     void circularPlugins();
     void correctPlugins1();
@@ -54,6 +58,8 @@ private slots:
 private:
     PluginManager *m_pm;
     SignalReceiver *m_sr;
+    // Added to the pool by a test, removed by cleanup() even if it fails
+    QList<QObject *> m_pool;
 };
 
 class SignalReceiver : public QObject {
@@ -110,6 +116,11 @@ void tst_PluginManager::init()
 
 void tst_PluginManager::cleanup()
 {
+    foreach(QObject * obj, m_pool) {
+        m_pm->removeObject(obj);
+    }
+    qDeleteAll(m_pool);
+    m_pool.clear();
     delete m_pm;
     delete m_sr;
 }
@@ -200,6 +211,107 @@ void tst_PluginManager::getObjects()
     delete object11;
 }
 
+void tst_PluginManager::getObjectAfterAddRemove()
+{
+    MyClass1 *object1   = new MyClass1;
+    MyClass11 *object11 = new MyClass11;
+
+    // Cached results, empty ones too, are dropped when the pool changes
+    QCOMPARE(m_pm->getObject<MyClass1>(), (MyClass1 *)0);
+    QCOMPARE(m_pm->getObjects<MyClass1>(), QList<MyClass1 *>());
+    m_pm->addObject(object11);
+    QCOMPARE(m_pm->getObject<MyClass1>(), qobject_cast<MyClass1 *>(object11));
+    QCOMPARE(m_pm->getObject<MyClass11>(), object11);
+    m_pm->addObject(object1);
+    QCOMPARE(m_pm->getObject<MyClass1>(), qobject_cast<MyClass1 *>(object11));
+    QCOMPARE(m_pm->getObjects<MyClass1>(), QList<MyClass1 *>() << object11 << object1);
+    m_pm->removeObject(object11);
+    QCOMPARE(m_pm->getObject<MyClass1>(), object1);
+    QCOMPARE(m_pm->getObject<MyClass11>(), (MyClass11 *)0);
+    QCOMPARE(m_pm->getObjects<MyClass1>(), QList<MyClass1 *>() << object1);
+    m_pm->removeObject(object1);
+    QCOMPARE(m_pm->getObject<MyClass1>(), (MyClass1 *)0);
+    QCOMPARE(m_pm->getObjects<MyClass11>(), QList<MyClass11 *>());
+    delete object1;
+    delete object11;
+}
+
+void tst_PluginManager::objectHandle()
+{
+    MyClass2 *object2 = new MyClass2;
+    MyClass2 *other   = new MyClass2;
+    ObjectHandle<MyClass2> handle(m_pm);
+
+    QCOMPARE(handle.get(), (MyClass2 *)0);
+    m_pm->addObject(object2);
+    QCOMPARE(handle.get(), object2);
+    QCOMPARE((MyClass2 *)handle, object2);
+    int generation = m_pm->objectPoolGeneration();
+    QCOMPARE(handle.get(), object2);
+    QCOMPARE(m_pm->objectPoolGeneration(), generation);
+    // Replaced by another object of the type
+    m_pm->removeObject(object2);
+    m_pm->addObject(other);
+    QCOMPARE(handle.get(), other);
+    m_pm->removeObject(other);
+    QCOMPARE(handle.get(), (MyClass2 *)0);
+    delete object2;
+    delete other;
+}
+
+/**
+    Looks up an object in a pool the size of the GCS one, as getObject()
+    did before the cache, with getObject() and with a handle, and reports
+    the times
+ */
+void tst_PluginManager::lookupTiming()
+{
+    const int poolSize = 150;
+    const int lookups  = 20000;
+
+    for (int i = 0; i < poolSize; i++) {
+        m_pool.append(new MyClass1);
+        m_pm->addObject(m_pool.last());
+    }
+    MyClass2 *object2 = new MyClass2;
+    m_pool.append(object2);
+    m_pm->addObject(object2);
+
+    QElapsedTimer timer;
+    MyClass2 *found = 0;
+    timer.start();
+    for (int i = 0; i < lookups; i++) {
+        found = 0;
+        foreach(QObject * obj, m_pm->allObjects()) {
+            if ((found = Aggregation::query<MyClass2>(obj)) != 0) {
+                break;
+            }
+        }
+    }
+    qint64 scanNs = timer.nsecsElapsed();
+    QCOMPARE(found, object2);
+
+    timer.restart();
+    for (int i = 0; i < lookups; i++) {
+        found = m_pm->getObject<MyClass2>();
+    }
+    qint64 cachedNs = timer.nsecsElapsed();
+    QCOMPARE(found, object2);
+
+    ObjectHandle<MyClass2> handle(m_pm);
+    timer.restart();
+    for (int i = 0; i < lookups; i++) {
+        found = handle.get();
+    }
+    qint64 handleNs = timer.nsecsElapsed();
+    QCOMPARE(found, object2);
+
+    qDebug() << "PluginManager -" << poolSize + 1 << "objects, per lookup:"
+             << "scan" << scanNs / lookups << "ns,"
+             << "cached" << cachedNs / lookups << "ns,"
+             << "handle" << handleNs / lookups << "ns";
+}
+
 void tst_PluginManager::plugins()
 {
     m_pm->setPluginPaths(QStringList() << "plugins");
@@ -380,6 +380,25 @@ Point Core::FromLatLngToLocal(PointLatLng const & latlng)
     pLocal.Offset(renderOffset);
     return pLocal;
 }
+void Core::FromLatLngToLocal(QVector<PointLatLng> const & latlng, QVector<QPointF> & local)
+{
+    int count = latlng.size();
+    QVector<double> lat(count);
+    QVector<double> lng(count);
+    QVector<double> x(count);
+    QVector<double> y(count);
+
+    for (int i = 0; i < count; ++i) {
+        lat[i] = latlng.at(i).Lat();
+        lng[i] = latlng.at(i).Lng();
+    }
+    Projection()->FromLatLngToPixels(lat.constData(), lng.constData(), x.data(), y.data(), count, Zoom());
+
+    local.resize(count);
+    for (int i = 0; i < count; ++i) {
+        local[i] = QPointF(x.at(i) + renderOffset.X(), y.at(i) + renderOffset.Y());
+    }
+}
 int Core::GetMaxZoomToFitRect(RectLatLng const & rect)
 {
     int zoom = 0;
@@ -54,6 +54,8 @@
 #include <QDateTime>
 
 #include <QObject>
+#include <QVector>
+#include <QPointF>
 
 namespace mapcontrol {
 class OPMapControl;
@@ -272,6 +274,8 @@ public:
 
     Point FromLatLngToLocal(PointLatLng const & latlng);
 
+    void FromLatLngToLocal(QVector<PointLatLng> const & latlng, QVector<QPointF> & local);
+
     int GetMaxZoomToFitRect(RectLatLng const & rect);
 
     void BeginDrag(core::Point const & pt);
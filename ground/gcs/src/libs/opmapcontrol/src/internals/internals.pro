@@ -29,3 +29,9 @@ SOURCES += ./projections/lks94projection.cpp \
     ./projections/platecarreeprojection.cpp 
 LIBS += -L../build \
     -lcore
+
+# The batch projections are written for the vectorizer, let it if-convert
+# the clipping and run at -O2
+*-g++* {
+    QMAKE_CXXFLAGS += -fno-trapping-math -ftree-vectorize -fvect-cost-model=cheap
+}
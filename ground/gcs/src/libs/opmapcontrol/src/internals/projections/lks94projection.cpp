@@ -66,6 +66,28 @@ Point LKS94Projection::FromLatLngToPixel(double lat, double lng, int const &  zo
     return ret;
 }
 
+// Same datum transformations as FromLatLngToPixel() without the floor(). The
+// iterative geodetic conversion does not suit a vectorized loop, a batch only
+// saves the per point calls and keeps the sub-pixel precision.
+void LKS94Projection::FromLatLngToPixels(const double *lat, const double *lng, double *x, double *y, int count, int zoom)
+{
+    double res = GetTileMatrixResolution(zoom);
+    QVector <double> lks(3);
+
+    for (int i = 0; i < count; ++i) {
+        lks.resize(3);
+        lks[0] = Clip(lng[i], MinLongitude, MaxLongitude);
+        lks[1] = Clip(lat[i], MinLatitude, MaxLatitude);
+        lks[2] = 0;
+        lks    = DTM10(lks);
+        lks    = MTD10(lks);
+        lks    = DTM00(lks);
+
+        x[i] = (lks[0] + orignX) / res;
+        y[i] = (orignY - lks[1]) / res;
+    }
+}
+
 internals::PointLatLng LKS94Projection::FromPixelToLatLng(int const & x, int const &  y, int const &  zoom)
 {
     internals::PointLatLng ret; // = internals::PointLatLng::Empty;
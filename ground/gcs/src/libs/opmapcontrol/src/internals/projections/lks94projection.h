@@ -45,6 +45,7 @@ public:
     virtual double Flattening() const;
     virtual core::Point FromLatLngToPixel(double lat, double lng, int const & zoom);
     virtual internals::PointLatLng FromPixelToLatLng(int const & x, int const &  y, int const &  zoom);
+    virtual void FromLatLngToPixels(const double *lat, const double *lng, double *x, double *y, int count, int zoom);
     virtual double GetGroundResolution(int const & zoom, double const & latitude);
     virtual Size GetTileMatrixMinXY(int const & zoom);
     virtual Size GetTileMatrixMaxXY(int const & zoom);
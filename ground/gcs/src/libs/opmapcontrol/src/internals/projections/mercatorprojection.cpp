@@ -51,6 +51,34 @@ Point MercatorProjection::FromLatLngToPixel(double lat, double lng, const int &z
 
     return ret;
 }
+// Same arithmetic as FromLatLngToPixel() without the rounding, with the
+// polynomial FastSin() and FastLog() so that the loop has no calls nor branches
+// and the compiler vectorizes it
+void MercatorProjection::FromLatLngToPixels(const double *lat, const double *lng, double *x, double *y, int count, int zoom)
+{
+    const double minLat = MinLatitude;
+    const double maxLat = MaxLatitude;
+    const double minLng = MinLongitude;
+    const double maxLng = MaxLongitude;
+
+    Size s = GetTileMatrixSizePixel(zoom);
+    const double mapSizeX = s.Width();
+    const double mapSizeY = s.Height();
+    const double maxX     = mapSizeX - 1;
+    const double maxY     = mapSizeY - 1;
+
+    for (int i = 0; i < count; ++i) {
+        double la = qMin(qMax(lat[i], minLat), maxLat);
+        double lo = qMin(qMax(lng[i], minLng), maxLng);
+        double sinLatitude = FastSin(la * M_PI / 180);
+        double px = (lo + 180) / 360 * mapSizeX;
+        double py = (0.5 - FastLog((1 + sinLatitude) / (1 - sinLatitude)) / (4 * M_PI)) * mapSizeY;
+
+        // Clipped to the map like FromLatLngToPixel(), (int)(x + 0.5) is then its result
+        x[i] = qMin(qMax(px, 0.0), maxX);
+        y[i] = qMin(qMax(py, 0.0), maxY);
+    }
+}
 internals::PointLatLng MercatorProjection::FromPixelToLatLng(const int &x, const int &y, const int &zoom)
 {
     internals::PointLatLng ret; // = internals::PointLatLng.Empty;
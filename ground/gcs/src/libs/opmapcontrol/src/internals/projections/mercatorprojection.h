@@ -42,6 +42,7 @@ public:
     virtual double Flattening() const;
     virtual core::Point FromLatLngToPixel(double lat, double lng, int const & zoom);
     virtual internals::PointLatLng FromPixelToLatLng(const int &x, const int &y, const int &zoom);
+    virtual void FromLatLngToPixels(const double *lat, const double *lng, double *x, double *y, int count, int zoom);
     virtual Size GetTileMatrixMinXY(const int &zoom);
     virtual Size GetTileMatrixMaxXY(const int &zoom);
 private:
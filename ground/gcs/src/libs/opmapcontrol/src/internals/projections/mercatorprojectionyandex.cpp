@@ -54,6 +54,33 @@ Point MercatorProjectionYandex::FromLatLngToPixel(double lat, double lng, const
 
     return ret;
 }
+// FromLatLngToPixel() without the truncation. With sin(chi) = k sin(lat),
+//   log(z) = log(tan(pi/4 + lat/2)) - k log(tan(pi/4 + chi/2))
+//          = (log((1 + s) / (1 - s)) - k log((1 + k s) / (1 - k s))) / 2
+// where s = sin(lat), which needs only FastSin() and FastLog(): the loop has no
+// calls nor branches and the compiler vectorizes it
+void MercatorProjectionYandex::FromLatLngToPixels(const double *lat, const double *lng, double *x, double *y, int count, int zoom)
+{
+    const double minLat = MinLatitude;
+    const double maxLat = MaxLatitude;
+    const double minLng = MinLongitude;
+    const double maxLng = MaxLongitude;
+    const double degRad = DEG_RAD;
+
+    const double a  = 6378137;
+    const double k  = 0.0818191908426;
+    const double z1 = pow(2, 23 - zoom);
+
+    for (int i = 0; i < count; ++i) {
+        double rLon = qMin(qMax(lng[i], minLng), maxLng) * degRad;
+        double rLat = qMin(qMax(lat[i], minLat), maxLat) * degRad;
+        double s    = FastSin(rLat);
+        double logZ = 0.5 * (FastLog((1 + s) / (1 - s)) - k * FastLog((1 + k * s) / (1 - k * s)));
+
+        x[i] = ((20037508.342789 + a * rLon) * 53.5865938 / z1);
+        y[i] = ((20037508.342789 - a * logZ) * 53.5865938 / z1);
+    }
+}
 internals::PointLatLng MercatorProjectionYandex::FromPixelToLatLng(const int &x, const int &y, const int &zoom)
 {
     // Size s = GetTileMatrixSizePixel(zoom);
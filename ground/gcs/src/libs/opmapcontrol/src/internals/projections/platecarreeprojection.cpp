@@ -49,6 +49,22 @@ Point PlateCarreeProjection::FromLatLngToPixel(double lat, double lng, const int
 
     return ret;
 }
+// Same arithmetic as FromLatLngToPixel() without the truncation
+void PlateCarreeProjection::FromLatLngToPixels(const double *lat, const double *lng, double *x, double *y, int count, int zoom)
+{
+    const double minLat = MinLatitude;
+    const double maxLat = MaxLatitude;
+    const double minLng = MinLongitude;
+    const double maxLng = MaxLongitude;
+
+    Size s = GetTileMatrixSizePixel(zoom);
+    const double scale = 360.0 / s.Width();
+
+    for (int i = 0; i < count; ++i) {
+        y[i] = (90.0 - qMin(qMax(lat[i], minLat), maxLat)) / scale;
+        x[i] = (qMin(qMax(lng[i], minLng), maxLng) + 180.0) / scale;
+    }
+}
 internals::PointLatLng PlateCarreeProjection::FromPixelToLatLng(const int &x, const int &y, const int &zoom)
 {
     internals::PointLatLng ret; // = internals::PointLatLng.Empty;
@@ -49,6 +49,16 @@ PointLatLng PureProjection::FromPixelToLatLng(const Point &p, const int &zoom)
     return FromPixelToLatLng(p.X(), p.Y(), zoom);
 }
 
+
+void PureProjection::FromLatLngToPixels(const double *lat, const double *lng, double *x, double *y, int count, int zoom)
+{
+    for (int i = 0; i < count; ++i) {
+        Point p = FromLatLngToPixel(lat[i], lng[i], zoom);
+        x[i] = p.X();
+        y[i] = p.Y();
+    }
+}
+
 Point PureProjection::FromPixelToTileXY(const Point &p)
 {
     return Point((int)(p.X() / TileSize().Width()), (int)(p.Y() / TileSize().Height()));
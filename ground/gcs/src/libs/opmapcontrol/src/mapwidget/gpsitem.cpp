@@ -73,11 +73,9 @@ void GPSItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
             if (timer.elapsed() > trailtime * 1000) {
                 TrailItem *ob = new TrailItem(position, altitude, Qt::red, map);
                 trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
                 if (!lasttrailline.IsEmpty()) {
                     TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::green, map);
                     trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
                 }
                 lasttrailline = position;
                 timer.restart();
@@ -86,11 +84,9 @@ void GPSItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
             if (qAbs(internals::PureProjection::DistanceBetweenLatLng(lastcoord, position) * 1000) > traildistance) {
                 TrailItem *ob = new TrailItem(position, altitude, Qt::red, map);
                 trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
                 if (!lasttrailline.IsEmpty()) {
                     TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::green, map);
                     trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
                 }
                 lasttrailline = position;
                 lastcoord     = position;
@@ -128,8 +124,7 @@ void GPSItem::RefreshPos()
 {
     localposition = map->FromLatLngToLocal(coord);
     this->setPos(localposition.X(), localposition.Y());
-    emit setChildPosition();
-    emit setChildLine();
+    TrailItem::RefreshPositions(map, trail, trailLine);
 }
 
 void GPSItem::setOpacitySlot(qreal opacity)
@@ -28,9 +28,18 @@
 #include "gpsitem.h"
 #include "homeitem.h"
 #include "mapgraphicitem.h"
+#include "waypointline.h"
+#include "waypointcircle.h"
 #include <QGraphicsSceneMouseEvent>
 
 namespace mapcontrol {
+const double MapGraphicItem::OVERLAY_MARGIN = 0.5;
+
+static bool overlaps(internals::RectLatLng const & a, internals::RectLatLng const & b)
+{
+    return a.Left() <= b.Right() && b.Left() <= a.Right() && a.Bottom() <= b.Top() && b.Bottom() <= a.Top();
+}
+
 MapGraphicItem::MapGraphicItem(internals::Core *core, Configuration *configuration) : core(core), config(configuration), MapRenderTransform(1),
     maxZoom(17), minZoom(2), zoomReal(0), zoomDigi(0), isSelected(false), rotation(0)
 {
@@ -42,12 +51,26 @@ MapGraphicItem::MapGraphicItem(internals::Core *core, Configuration *configurati
     core->SetMapType(MapType::GoogleHybrid);
     this->SetZoom(2);
     this->setFlag(ItemIsFocusable);
+    overlayIndex   = new MapItemIndex;
+    clusterZoom    = 13;
+    overlayOpacity = 1;
     connect(core, SIGNAL(OnNeedInvalidation()), this, SLOT(Core_OnNeedInvalidation()));
     connect(core, SIGNAL(OnMapDrag()), this, SLOT(childPosRefresh()));
     connect(core, SIGNAL(OnMapZoomChanged()), this, SLOT(childPosRefresh()));
     setCacheMode(QGraphicsItem::ItemCoordinateCache);
 }
 
+MapGraphicItem::~MapGraphicItem()
+{
+    // The overlays unregister themselves when deleted, delete them while the index exists
+    QList<QGraphicsItem *> overlays = overlayIndex->Items();
+
+    overlayIndex->Clear();
+    shownOverlays.clear();
+    qDeleteAll(overlays);
+    delete overlayIndex;
+}
+
 void MapGraphicItem::start()
 {
     core->StartSystem();
@@ -81,15 +104,193 @@ void MapGraphicItem::Core_OnNeedInvalidation()
 {
     this->update();
     emit childRefreshPosition();
+    refreshOverlays();
 }
 void MapGraphicItem::childPosRefresh()
 {
     emit childRefreshPosition();
+    refreshOverlays();
 }
 void MapGraphicItem::setOverlayOpacity(qreal value)
 {
+    overlayOpacity = value;
+    foreach(WayPointCluster * cluster, clusters) {
+        cluster->setOpacity(value);
+    }
     emit childSetOpacity(value);
 }
+void MapGraphicItem::UpdateOverlay(QGraphicsItem *item, internals::RectLatLng const & rect)
+{
+    if (!overlayIndex->Insert(item, rect)) {
+        return;
+    }
+    // Everything is shown until the first refresh
+    setOverlayShown(item, cullArea.IsEmpty() || overlaps(cullArea, rect));
+}
+void MapGraphicItem::RemoveOverlay(QGraphicsItem *item)
+{
+    overlayIndex->Remove(item);
+    shownOverlays.remove(item);
+    culledOverlays.remove(item);
+}
+QPointF MapGraphicItem::OverlayPos(QGraphicsItem *item)
+{
+    WayPointItem *wp = qgraphicsitem_cast<WayPointItem *>(item);
+
+    if (wp && wp->IsCulled()) {
+        core::Point point = FromLatLngToLocal(wp->Coord());
+        return QPointF(point.X(), point.Y());
+    }
+    return item->pos();
+}
+internals::PointLatLng MapGraphicItem::OverlayCoord(QGraphicsItem *item)
+{
+    WayPointItem *wp = qgraphicsitem_cast<WayPointItem *>(item);
+
+    if (wp) {
+        return wp->Coord();
+    }
+    HomeItem *home = qgraphicsitem_cast<HomeItem *>(item);
+    if (home) {
+        return home->Coord();
+    }
+    return FromLocalToLatLng(item->pos().x(), item->pos().y());
+}
+void MapGraphicItem::setOverlayShown(QGraphicsItem *item, bool shown)
+{
+    WayPointItem *wp = qgraphicsitem_cast<WayPointItem *>(item);
+
+    if (wp) {
+        wp->SetCulled(!shown);
+    } else if (shown) {
+        // Only what the culling hid is shown again, a line hidden by its owner stays hidden
+        if (culledOverlays.remove(item)) {
+            item->setVisible(true);
+        }
+    } else if (item->isVisible()) {
+        culledOverlays.insert(item);
+        item->setVisible(false);
+    }
+    if (shown) {
+        shownOverlays.insert(item);
+    } else {
+        shownOverlays.remove(item);
+    }
+}
+void MapGraphicItem::refreshOverlays()
+{
+    internals::RectLatLng view = core->CurrentViewArea();
+
+    cullArea = internals::RectLatLng::Inflate(view, view.HeightLat() * OVERLAY_MARGIN, view.WidthLng() * OVERLAY_MARGIN);
+
+    QVector<QGraphicsItem *> found;
+    overlayIndex->Query(cullArea, found);
+
+    QVector<WayPointItem *> waypoints;
+    QVector<internals::PointLatLng> coords;
+    QVector<QGraphicsItem *> others;
+    foreach(QGraphicsItem * item, found) {
+        WayPointItem *wp = qgraphicsitem_cast<WayPointItem *>(item);
+        if (wp) {
+            waypoints.append(wp);
+            coords.append(wp->Coord());
+        } else {
+            others.append(item);
+        }
+    }
+
+    // Only the WayPoints around the view are projected, in one batch
+    QVector<QPointF> local;
+    FromLatLngToLocal(coords, local);
+
+    QVector<bool> clustered(waypoints.size(), false);
+    int clusterCount = 0;
+    if (Zoom() <= clusterZoom) {
+        clusterCount = clusterWayPoints(waypoints, local, clustered);
+    }
+    for (int i = clusterCount; i < clusters.size(); ++i) {
+        clusters.at(i)->setVisible(false);
+    }
+
+    QSet<QGraphicsItem *> shown;
+    QSet<QGraphicsItem *> grouped;
+    for (int i = 0; i < waypoints.size(); ++i) {
+        WayPointItem *wp = waypoints.at(i);
+        if (clustered.at(i)) {
+            grouped.insert(wp);
+            wp->SetCulled(true);
+        } else {
+            shown.insert(wp);
+            wp->SetCulled(false);
+            wp->SetLocalPos(local.at(i));
+        }
+    }
+    // Lines and circles between two clustered WayPoints are hidden with them
+    foreach(QGraphicsItem * item, others) {
+        WayPointLine *line     = qgraphicsitem_cast<WayPointLine *>(item);
+        WayPointCircle *circle = qgraphicsitem_cast<WayPointCircle *>(item);
+        QGraphicsItem *from    = line ? line->Source() : (circle ? circle->Center() : 0);
+        QGraphicsItem *to      = line ? line->Destination() : (circle ? circle->Radius() : 0);
+        if (grouped.contains(from) && grouped.contains(to)) {
+            continue;
+        }
+        shown.insert(item);
+        setOverlayShown(item, true);
+        if (line) {
+            line->refreshLocations();
+        } else if (circle) {
+            circle->refreshLocations();
+        }
+    }
+
+    // Overlays that left the area around the view
+    foreach(QGraphicsItem * item, shownOverlays) {
+        if (!shown.contains(item)) {
+            setOverlayShown(item, false);
+        }
+    }
+    shownOverlays.swap(shown);
+}
+/**
+ * Groups the WayPoints falling in the same grid cell of the view, returns the number of cluster markers used
+ */
+int MapGraphicItem::clusterWayPoints(QVector<WayPointItem *> const & waypoints, QVector<QPointF> const & local, QVector<bool> & clustered)
+{
+    QHash<quint64, QVector<int> > cells;
+
+    for (int i = 0; i < waypoints.size(); ++i) {
+        WayPointItem *wp = waypoints.at(i);
+        // Never group what the user is working on
+        if (wp->IsHidden() || wp->isSelected()) {
+            continue;
+        }
+        quint32 x = (quint32)(qint32)floor(local.at(i).x() / CLUSTER_CELL);
+        quint32 y = (quint32)(qint32)floor(local.at(i).y() / CLUSTER_CELL);
+        cells[((quint64)x << 32) | y].append(i);
+    }
+
+    int used = 0;
+    foreach(const QVector<int> &cell, cells) {
+        if (cell.size() < MIN_CLUSTER) {
+            continue;
+        }
+        QPointF center;
+        foreach(int i, cell) {
+            clustered[i] = true;
+            center += local.at(i);
+        }
+        if (used == clusters.size()) {
+            WayPointCluster *cluster = new WayPointCluster(this);
+            cluster->setOpacity(overlayOpacity);
+            clusters.append(cluster);
+        }
+        WayPointCluster *cluster = clusters.at(used++);
+        cluster->SetCount(cell.size());
+        cluster->setPos(center / cell.size());
+        cluster->setVisible(true);
+    }
+    return used;
+}
 void MapGraphicItem::ConstructLastImage(int const & zoomdiff)
 {
     QImage temp;
@@ -382,6 +583,18 @@ core::Point MapGraphicItem::FromLatLngToLocal(internals::PointLatLng const & poi
     }
     return ret;
 }
+void MapGraphicItem::FromLatLngToLocal(QVector<internals::PointLatLng> const & points, QVector<QPointF> & local)
+{
+    core->FromLatLngToLocal(points, local);
+
+    if (MapRenderTransform != 1) {
+        qreal dx = ((boundingRect().width() * MapRenderTransform) - (boundingRect().width())) / 2;
+        qreal dy = ((boundingRect().height() * MapRenderTransform) - (boundingRect().height())) / 2;
+        for (int i = 0; i < local.size(); ++i) {
+            local[i] = QPointF(local.at(i).x() * MapRenderTransform - dx, local.at(i).y() * MapRenderTransform - dy);
+        }
+    }
+}
 internals::PointLatLng MapGraphicItem::FromLocalToLatLng(int x, int y)
 {
     if (MapRenderTransform != 1) {
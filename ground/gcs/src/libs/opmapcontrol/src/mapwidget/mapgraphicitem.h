@@ -32,6 +32,8 @@
 #include "../core/diagnostics.h"
 #include "configuration.h"
 #include "waypointitem.h"
+#include "waypointcluster.h"
+#include "mapitemindex.h"
 
 #include <QGraphicsItem>
 #include <QtGui>
@@ -40,6 +42,7 @@
 #include <QBrush>
 #include <QFont>
 #include <QObject>
+#include <QSet>
 
 namespace mapcontrol {
 class WayPointItem;
@@ -65,6 +68,7 @@ public:
      * @return
      */
     MapGraphicItem(internals::Core *core, Configuration *configuration);
+    ~MapGraphicItem();
     QRectF boundingRect() const;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                QWidget *widget);
@@ -77,6 +81,65 @@ public:
      * @return core::Point Local item point
      */
     core::Point FromLatLngToLocal(internals::PointLatLng const & point);
+    /**
+     * @brief Converts many LatLong coordinates to local item coordinates in one go,
+     *        with sub-pixel precision
+     *
+     * @param points LatLong points to be converted
+     * @param local Local item points, resized to the number of points
+     */
+    void FromLatLngToLocal(QVector<internals::PointLatLng> const & points, QVector<QPointF> & local);
+    /**
+     * @brief Adds a WayPoint, WayPoint line or circle to the spatial index, or updates its
+     *        LatLng bounding box, and culls it if out of view
+     *
+     * @param item the overlay item
+     * @param rect its bounding box
+     */
+    void UpdateOverlay(QGraphicsItem *item, internals::RectLatLng const & rect);
+    /**
+     * @brief Removes an overlay item from the spatial index, called by its destructor
+     *
+     * @param item the overlay item
+     */
+    void RemoveOverlay(QGraphicsItem *item);
+    /**
+     * @brief Returns true if the overlay item is neither out of view nor clustered
+     *
+     * @param item the overlay item
+     */
+    bool IsOverlayShown(QGraphicsItem *item) const
+    {
+        return shownOverlays.contains(item);
+    }
+    /**
+     * @brief Returns the local position of a WayPoint or Home item, projected if
+     *        the WayPoint is culled
+     *
+     * @param item the WayPoint or Home item
+     */
+    QPointF OverlayPos(QGraphicsItem *item);
+    /**
+     * @brief Returns the LatLng coordinate of a WayPoint or Home item
+     *
+     * @param item the WayPoint or Home item
+     */
+    internals::PointLatLng OverlayCoord(QGraphicsItem *item);
+    /**
+     * @brief Sets the zoom up to which dense groups of WayPoints are shown as a single
+     *        cluster marker, -1 to never group them
+     *
+     * @param value
+     */
+    void SetClusterZoom(int const & value)
+    {
+        clusterZoom = value;
+        refreshOverlays();
+    }
+    int ClusterZoom() const
+    {
+        return clusterZoom;
+    }
     /**
      * @brief Converts from local item coordinates to LatLong point
      *
@@ -175,6 +238,35 @@ private:
     }
 
     qreal rotation;
+
+    /**
+     * @brief Overlays within this much of the view size around the view are kept positioned,
+     *        so that a short pan does not reveal stale items
+     */
+    static const double OVERLAY_MARGIN;
+    /**
+     * @brief Size in pixels of the grid used to group WayPoints into clusters
+     */
+    static const int CLUSTER_CELL = 40;
+    /**
+     * @brief Minimum number of WayPoints in a grid cell to make a cluster
+     */
+    static const int MIN_CLUSTER  = 4;
+    MapItemIndex *overlayIndex;
+    internals::RectLatLng cullArea;
+    QSet<QGraphicsItem *> shownOverlays;
+    // Lines and circles hidden by the culling, WayPoints keep their own state
+    QSet<QGraphicsItem *> culledOverlays;
+    QList<WayPointCluster *> clusters;
+    int clusterZoom;
+    qreal overlayOpacity;
+    /**
+     * @brief Repositions the overlays within the view, culls the others and
+     *        groups dense WayPoints at low zoom
+     */
+    void refreshOverlays();
+    int clusterWayPoints(QVector<WayPointItem *> const & waypoints, QVector<QPointF> const & local, QVector<bool> & clustered);
+    void setOverlayShown(QGraphicsItem *item, bool shown);
     /**
      * @brief Creates a rectangle that represents the "view" of the cuurent map, to compensate
      *       rotation
@@ -0,0 +1,226 @@
+/**
+ ******************************************************************************
+ *
+ * @file       mapitemindex.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @brief      Quadtree of the map overlay items over latitude and longitude
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "mapitemindex.h"
+
+namespace mapcontrol {
+MapItemIndex::MapItemIndex()
+{
+    Box world = { -180, -90, 180, 90 };
+
+    root = newNode(world, 0);
+}
+
+MapItemIndex::~MapItemIndex()
+{
+    deleteNode(root);
+}
+
+bool MapItemIndex::Insert(QGraphicsItem *item, internals::RectLatLng const & rect)
+{
+    Box box = toBox(rect);
+    Node *node = nodes.value(item);
+
+    if (node) {
+        int index = indexOf(node, item);
+        if (node->items.at(index).box == box) {
+            return false;
+        }
+        // Stays in its quadrant, only the box changes
+        if (findNode(box) == node) {
+            node->items[index].box = box;
+            return true;
+        }
+        Remove(item);
+    }
+
+    node = findNode(box);
+    Item entry = { item, box };
+    node->items.append(entry);
+    nodes.insert(item, node);
+
+    if (!node->children[0] && node->items.size() > NODE_CAPACITY && node->depth < MAX_DEPTH) {
+        split(node);
+    }
+    return true;
+}
+
+void MapItemIndex::Remove(QGraphicsItem *item)
+{
+    Node *node = nodes.take(item);
+
+    if (!node) {
+        return;
+    }
+    node->items[indexOf(node, item)] = node->items.last();
+    node->items.removeLast();
+}
+
+bool MapItemIndex::Contains(QGraphicsItem *item) const
+{
+    return nodes.contains(item);
+}
+
+void MapItemIndex::Query(internals::RectLatLng const & rect, QVector<QGraphicsItem *> & result) const
+{
+    query(root, toBox(rect), result);
+}
+
+QList<QGraphicsItem *> MapItemIndex::Items() const
+{
+    return nodes.keys();
+}
+
+int MapItemIndex::Count() const
+{
+    return nodes.size();
+}
+
+void MapItemIndex::Clear()
+{
+    deleteNode(root);
+    nodes.clear();
+
+    Box world = { -180, -90, 180, 90 };
+    root = newNode(world, 0);
+}
+
+MapItemIndex::Box MapItemIndex::toBox(internals::RectLatLng const & rect)
+{
+    Box box = { rect.Left(), rect.Bottom(), rect.Right(), rect.Top() };
+
+    return box;
+}
+
+MapItemIndex::Node *MapItemIndex::newNode(Box const & box, int depth)
+{
+    Node *node = new Node;
+
+    node->box   = box;
+    node->depth = depth;
+    for (int i = 0; i < 4; ++i) {
+        node->children[i] = 0;
+    }
+    return node;
+}
+
+void MapItemIndex::deleteNode(Node *node)
+{
+    if (node->children[0]) {
+        for (int i = 0; i < 4; ++i) {
+            deleteNode(node->children[i]);
+        }
+    }
+    delete node;
+}
+
+/**
+ * Deepest existing quadrant that fully contains the box, the root for boxes outside of the world
+ */
+MapItemIndex::Node *MapItemIndex::findNode(Box const & box) const
+{
+    Node *node = root;
+
+    while (node->children[0]) {
+        Node *child = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (node->children[i]->box.contains(box)) {
+                child = node->children[i];
+                break;
+            }
+        }
+        if (!child) {
+            break;
+        }
+        node = child;
+    }
+    return node;
+}
+
+int MapItemIndex::indexOf(Node *node, QGraphicsItem *item)
+{
+    for (int i = 0; i < node->items.size(); ++i) {
+        if (node->items.at(i).item == item) {
+            return i;
+        }
+    }
+    Q_ASSERT(false);
+    return -1;
+}
+
+void MapItemIndex::split(Node *node)
+{
+    double midLng = (node->box.west + node->box.east) / 2;
+    double midLat = (node->box.south + node->box.north) / 2;
+    Box quadrants[4] = {
+        { node->box.west, midLat,          midLng,         node->box.north },
+        { midLng,         midLat,          node->box.east, node->box.north },
+        { node->box.west, node->box.south, midLng,         midLat          },
+        { midLng,         node->box.south, node->box.east, midLat          }
+    };
+
+    for (int i = 0; i < 4; ++i) {
+        node->children[i] = newNode(quadrants[i], node->depth + 1);
+    }
+
+    // Push down the items that fit in a quadrant, the others stay here
+    QVector<Item> items;
+    items.swap(node->items);
+    foreach(const Item &entry, items) {
+        Node *target = node;
+        for (int i = 0; i < 4; ++i) {
+            if (node->children[i]->box.contains(entry.box)) {
+                target = node->children[i];
+                break;
+            }
+        }
+        target->items.append(entry);
+        nodes[entry.item] = target;
+    }
+    for (int i = 0; i < 4; ++i) {
+        Node *child = node->children[i];
+        if (child->items.size() > NODE_CAPACITY && child->depth < MAX_DEPTH) {
+            split(child);
+        }
+    }
+}
+
+void MapItemIndex::query(Node *node, Box const & box, QVector<QGraphicsItem *> & result) const
+{
+    foreach(const Item &entry, node->items) {
+        if (entry.box.intersects(box)) {
+            result.append(entry.item);
+        }
+    }
+    if (node->children[0]) {
+        for (int i = 0; i < 4; ++i) {
+            if (node->children[i]->box.intersects(box)) {
+                query(node->children[i], box, result);
+            }
+        }
+    }
+}
+}
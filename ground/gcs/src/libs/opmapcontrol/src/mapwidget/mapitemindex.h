@@ -0,0 +1,114 @@
+/**
+ ******************************************************************************
+ *
+ * @file       mapitemindex.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @brief      Quadtree of the map overlay items over latitude and longitude
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef MAPITEMINDEX_H
+#define MAPITEMINDEX_H
+
+#include "../internals/rectlatlng.h"
+#include <QHash>
+#include <QVector>
+#include <QList>
+
+class QGraphicsItem;
+
+namespace mapcontrol {
+/**
+ * @brief Spatial index of the overlay items, each with its bounding box in LatLng
+ *
+ * Items are kept in the smallest quadrant that fully contains their box, a
+ * waypoint is a box of size 0. Finding the items within the view area visits
+ * only the quadrants that intersect it.
+ *
+ * @class MapItemIndex mapitemindex.h "mapitemindex.h"
+ */
+class MapItemIndex {
+public:
+    MapItemIndex();
+    ~MapItemIndex();
+
+    /**
+     * @brief Adds an item, or moves it if already indexed
+     *
+     * @return false if the item was already indexed with the same box
+     */
+    bool Insert(QGraphicsItem *item, internals::RectLatLng const & rect);
+    void Remove(QGraphicsItem *item);
+    bool Contains(QGraphicsItem *item) const;
+    /**
+     * @brief Appends to result the items whose box intersects rect
+     */
+    void Query(internals::RectLatLng const & rect, QVector<QGraphicsItem *> & result) const;
+    QList<QGraphicsItem *> Items() const;
+    int Count() const;
+    void Clear();
+
+private:
+    static const int NODE_CAPACITY = 16;
+    static const int MAX_DEPTH     = 20;
+
+    struct Box {
+        double west;
+        double south;
+        double east;
+        double north;
+
+        bool contains(Box const & other) const
+        {
+            return west <= other.west && other.east <= east && south <= other.south && other.north <= north;
+        }
+        bool intersects(Box const & other) const
+        {
+            return west <= other.east && other.west <= east && south <= other.north && other.south <= north;
+        }
+        bool operator==(Box const & other) const
+        {
+            return west == other.west && south == other.south && east == other.east && north == other.north;
+        }
+    };
+    struct Item {
+        QGraphicsItem *item;
+        Box box;
+    };
+    struct Node {
+        Box box;
+        int depth;
+        Node *children[4];
+        QVector<Item> items;
+    };
+
+    Node *root;
+    QHash<QGraphicsItem *, Node *> nodes;
+
+    static Box toBox(internals::RectLatLng const & rect);
+    Node *newNode(Box const & box, int depth);
+    void deleteNode(Node *node);
+    Node *findNode(Box const & box) const;
+    static int indexOf(Node *node, QGraphicsItem *item);
+    void split(Node *node);
+    void query(Node *node, Box const & box, QVector<QGraphicsItem *> & result) const;
+};
+}
+#endif // MAPITEMINDEX_H
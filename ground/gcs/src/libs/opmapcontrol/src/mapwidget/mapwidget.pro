@@ -17,7 +17,9 @@ SOURCES += mapgraphicitem.cpp \
     mapripper.cpp \
     traillineitem.cpp \
     waypointline.cpp \
-    waypointcircle.cpp
+    waypointcircle.cpp \
+    waypointcluster.cpp \
+    mapitemindex.cpp
 
 LIBS += -L../build \
     -lcore \
@@ -45,7 +47,9 @@ HEADERS += mapgraphicitem.h \
     mapripper.h \
     traillineitem.h \
     waypointline.h \
-    waypointcircle.h
+    waypointcircle.h \
+    waypointcluster.h \
+    mapitemindex.h
 QT += opengl
 QT += network
 QT += sql
@@ -404,7 +404,7 @@ void OPMapWidget::WPSetVisibleAll(bool value)
 
         if (w) {
             if (w->Number() != -1) {
-                w->setVisible(value);
+                w->setUserVisible(value);
             }
         }
     }
@@ -25,6 +25,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "trailitem.h"
+#include "traillineitem.h"
 #include <QDateTime>
 namespace mapcontrol {
 TrailItem::TrailItem(internals::PointLatLng const & coord, int const & altitude, QBrush color, MapGraphicItem *map) : QGraphicsItem(map), coord(coord), m_brush(color), m_map(map)
@@ -58,4 +59,48 @@ void TrailItem::setPosSLOT()
 {
     setPos(m_map->FromLatLngToLocal(this->coord).X(), m_map->FromLatLngToLocal(this->coord).Y());
 }
+
+/**
+ * Moves all the trail points and trail lines of a vehicle, projecting their
+ * coordinates in a single batch instead of once per item
+ */
+void TrailItem::RefreshPositions(MapGraphicItem *map, QGraphicsItemGroup *trail, QGraphicsItemGroup *trailLine)
+{
+    QList<TrailItem *> points;
+    QList<TrailLineItem *> lines;
+    QVector<internals::PointLatLng> coords;
+
+    foreach(QGraphicsItem * i, trail->childItems()) {
+        TrailItem *t = qgraphicsitem_cast<TrailItem *>(i);
+
+        if (t) {
+            points.append(t);
+            coords.append(t->coord);
+        }
+    }
+    foreach(QGraphicsItem * i, trailLine->childItems()) {
+        TrailLineItem *l = qgraphicsitem_cast<TrailLineItem *>(i);
+
+        if (l) {
+            lines.append(l);
+            coords.append(l->coord1);
+            coords.append(l->coord2);
+        }
+    }
+    if (coords.isEmpty()) {
+        return;
+    }
+
+    QVector<QPointF> local;
+    map->FromLatLngToLocal(coords, local);
+
+    int index = 0;
+    foreach(TrailItem * t, points) {
+        t->setPos(local.at(index++));
+    }
+    foreach(TrailLineItem * l, lines) {
+        l->setLine(QLineF(local.at(index), local.at(index + 1)));
+        index += 2;
+    }
+}
 }
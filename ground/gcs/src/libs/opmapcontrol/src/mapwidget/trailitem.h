@@ -45,6 +45,8 @@ public:
     QRectF boundingRect() const;
     int type() const;
     internals::PointLatLng coord;
+
+    static void RefreshPositions(MapGraphicItem *map, QGraphicsItemGroup *trail, QGraphicsItemGroup *trailLine);
 private:
     QBrush m_brush;
     MapGraphicItem *m_map;
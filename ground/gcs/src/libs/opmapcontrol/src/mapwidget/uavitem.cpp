@@ -251,11 +251,9 @@ void UAVItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
             if (timer.elapsed() > trailtime * 1000) {
                 TrailItem *ob = new TrailItem(position, altitude, Qt::green, map);
                 trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
                 if (!lasttrailline.IsEmpty()) {
                     TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::red, map);
                     trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
                 }
                 lasttrailline = position;
                 timer.restart();
@@ -264,11 +262,9 @@ void UAVItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
             if (qAbs(internals::PureProjection::DistanceBetweenLatLng(lastcoord, position) * 1000) > traildistance) {
                 TrailItem *ob = new TrailItem(position, altitude, Qt::green, map);
                 trail->addToGroup(ob);
-                connect(this, SIGNAL(setChildPosition()), ob, SLOT(setPosSLOT()));
                 if (!lasttrailline.IsEmpty()) {
                     TrailLineItem *obj = new TrailLineItem(lasttrailline, position, Qt::red, map);
                     trailLine->addToGroup(obj);
-                    connect(this, SIGNAL(setChildLine()), obj, SLOT(setLineSlot()));
                 }
                 lasttrailline = position;
                 lastcoord     = position;
@@ -336,8 +332,7 @@ void UAVItem::RefreshPos()
 {
     localposition = map->FromLatLngToLocal(coord);
     this->setPos(localposition.X(), localposition.Y());
-    emit setChildPosition();
-    emit setChildLine();
+    TrailItem::RefreshPositions(map, trail, trailLine);
     updateTextOverlay();
 }
 
@@ -50,6 +50,11 @@ WayPointCircle::WayPointCircle(HomeItem *radius, WayPointItem *center, bool cloc
     connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
 }
 
+WayPointCircle::~WayPointCircle()
+{
+    my_map->RemoveOverlay(this);
+}
+
 int WayPointCircle::type() const
 {
     // Enable the use of qgraphicsitem_cast with this item.
@@ -107,8 +112,20 @@ void WayPointCircle::paint(QPainter *painter, const QStyleOptionGraphicsItem *op
 
 void WayPointCircle::refreshLocations()
 {
-    line = QLineF(my_center->pos(), my_radius->pos());
-    this->setRect(my_center->pos().x(), my_center->pos().y(), 2 * line.length(), 2 * line.length());
+    internals::PointLatLng center = my_map->OverlayCoord(my_center);
+    internals::PointLatLng edge   = my_map->OverlayCoord(my_radius);
+    // Radius in degrees of latitude, longitude degrees shrink away from the equator
+    double scale  = qMax(cos(center.Lat() * M_PI / 180), 0.01);
+    double dLat   = edge.Lat() - center.Lat();
+    double dLng   = (edge.Lng() - center.Lng()) * scale;
+    double radius = sqrt(dLat * dLat + dLng * dLng);
+
+    my_map->UpdateOverlay(this, internals::RectLatLng(center.Lat() + radius, center.Lng() - radius / scale, 2 * radius / scale, 2 * radius));
+    if (!my_map->IsOverlayShown(this)) {
+        return;
+    }
+    line = QLineF(my_map->OverlayPos(my_center), my_map->OverlayPos(my_radius));
+    this->setRect(line.p1().x(), line.p1().y(), 2 * line.length(), 2 * line.length());
     this->update();
 }
 
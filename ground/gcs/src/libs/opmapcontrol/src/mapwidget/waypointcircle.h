@@ -42,11 +42,20 @@ public:
     enum { Type = UserType + 9 };
     WayPointCircle(WayPointItem *center, WayPointItem *radius, bool clockwise, MapGraphicItem *map, QColor color = Qt::green, bool dashed = false, int width = -1);
     WayPointCircle(HomeItem *center, WayPointItem *radius, bool clockwise, MapGraphicItem *map, QColor color = Qt::green, bool dashed = false, int width = -1);
+    ~WayPointCircle();
     int type() const;
     void setColor(const QColor &color)
     {
         myColor = color;
     }
+    QGraphicsItem *Center() const
+    {
+        return my_center;
+    }
+    QGraphicsItem *Radius() const
+    {
+        return my_radius;
+    }
 private:
     QGraphicsItem *my_center;
     QGraphicsItem *my_radius;
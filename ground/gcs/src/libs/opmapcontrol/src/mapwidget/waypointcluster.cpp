@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ *
+ * @file       waypointcluster.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @brief      A graphicsItem standing for a group of waypoints too close to be told apart
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "waypointcluster.h"
+
+namespace mapcontrol {
+WayPointCluster::WayPointCluster(QGraphicsItem *parent) : QGraphicsItem(parent), count(0), radius(10)
+{
+    this->setFlag(QGraphicsItem::ItemIgnoresTransformations, true);
+    this->setZValue(11);
+}
+
+QRectF WayPointCluster::boundingRect() const
+{
+    return QRectF(-radius, -radius, 2 * radius, 2 * radius);
+}
+
+void WayPointCluster::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setPen(QPen(Qt::white, 2));
+    painter->setBrush(QColor(0, 90, 200, 200));
+    painter->drawEllipse(boundingRect().adjusted(1, 1, -1, -1));
+    painter->drawText(boundingRect(), Qt::AlignCenter, text);
+}
+
+int WayPointCluster::type() const
+{
+    return Type;
+}
+
+void WayPointCluster::SetCount(int value)
+{
+    if (count == value) {
+        return;
+    }
+    count = value;
+    text  = QString::number(count);
+
+    // Grow with the number of digits
+    prepareGeometryChange();
+    radius = 8 + 3 * text.length();
+    setToolTip(QString(QObject::tr("%1 waypoints, zoom in to show them")).arg(count));
+    this->update();
+}
+}
@@ -0,0 +1,58 @@
+/**
+ ******************************************************************************
+ *
+ * @file       waypointcluster.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @brief      A graphicsItem standing for a group of waypoints too close to be told apart
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef WAYPOINTCLUSTER_H
+#define WAYPOINTCLUSTER_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+
+namespace mapcontrol {
+/**
+ * @brief Marker drawn instead of the waypoints of a dense area at low zoom
+ *
+ * @class WayPointCluster waypointcluster.h "waypointcluster.h"
+ */
+class WayPointCluster : public QGraphicsItem {
+public:
+    enum { Type = UserType + 10 };
+    WayPointCluster(QGraphicsItem *parent);
+    QRectF boundingRect() const;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget);
+    int type() const;
+    void SetCount(int value);
+    int Count() const
+    {
+        return count;
+    }
+private:
+    int count;
+    QString text;
+    qreal radius;
+};
+}
+#endif // WAYPOINTCLUSTER_H
@@ -32,6 +32,9 @@
 namespace mapcontrol {
 WayPointItem::WayPointItem(const internals::PointLatLng &coord, int const & altitude, MapGraphicItem *map, wptype type) : coord(coord), reached(false), description(""), shownumber(true), isDragging(false), altitude(altitude), map(map), myType(type)
 {
+    culled      = false;
+    userVisible = true;
+
     text    = 0;
     numberI = 0;
     isMagic = false;
@@ -52,12 +55,17 @@ WayPointItem::WayPointItem(const internals::PointLatLng &coord, int const & alti
     }
     connect(this, SIGNAL(waypointdoubleclick(WayPointItem *)), map, SIGNAL(wpdoubleclicked(WayPointItem *)));
     emit manualCoordChange(this);
-    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    if (isMagic) {
+        connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    }
     connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
 }
 
 WayPointItem::WayPointItem(MapGraphicItem *map, bool magicwaypoint) : reached(false), description(""), shownumber(true), isDragging(false), altitude(0), map(map)
 {
+    culled      = false;
+    userVisible = true;
+
     relativeCoord.bearing  = 0;
     relativeCoord.distance = 0;
     relativeCoord.altitudeRelative = 0;
@@ -87,11 +95,16 @@ WayPointItem::WayPointItem(MapGraphicItem *map, bool magicwaypoint) : reached(fa
     }
     connect(this, SIGNAL(waypointdoubleclick(WayPointItem *)), map, SIGNAL(wpdoubleclicked(WayPointItem *)));
     emit manualCoordChange(this);
-    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    if (isMagic) {
+        connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    }
     connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
 }
 WayPointItem::WayPointItem(const internals::PointLatLng &coord, int const & altitude, const QString &description, MapGraphicItem *map, wptype type) : coord(coord), reached(false), description(description), shownumber(true), isDragging(false), altitude(altitude), map(map), myType(type)
 {
+    culled      = false;
+    userVisible = true;
+
     text    = 0;
     numberI = 0;
     isMagic = false;
@@ -112,12 +125,17 @@ WayPointItem::WayPointItem(const internals::PointLatLng &coord, int const & alti
     }
     connect(this, SIGNAL(waypointdoubleclick(WayPointItem *)), map, SIGNAL(wpdoubleclicked(WayPointItem *)));
     emit manualCoordChange(this);
-    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    if (isMagic) {
+        connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    }
     connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
 }
 
 WayPointItem::WayPointItem(const distBearingAltitude &relativeCoordenate, const QString &description, MapGraphicItem *map) : relativeCoord(relativeCoordenate), reached(false), description(description), shownumber(true), isDragging(false), map(map)
 {
+    culled      = false;
+    userVisible = true;
+
     myHome = map->Home;
     if (myHome) {
         connect(myHome, SIGNAL(homePositionChanged(internals::PointLatLng, float)), this, SLOT(onHomePositionChanged(internals::PointLatLng, float)));
@@ -139,7 +157,9 @@ WayPointItem::WayPointItem(const distBearingAltitude &relativeCoordenate, const
     RefreshPos();
     connect(this, SIGNAL(waypointdoubleclick(WayPointItem *)), map, SIGNAL(wpdoubleclicked(WayPointItem *)));
     emit manualCoordChange(this);
-    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    if (isMagic) {
+        connect(map, SIGNAL(childRefreshPosition()), this, SLOT(RefreshPos()));
+    }
     connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
 }
 
@@ -214,6 +234,7 @@ void WayPointItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
     if (isDragging) {
         coord = map->FromLocalToLatLng(this->pos().x(), this->pos().y());
+        map->UpdateOverlay(this, internals::RectLatLng(coord.Lat(), coord.Lng(), 0, 0));
         QString coord_str = " " + QString::number(coord.Lat(), 'f', 6) + "   " + QString::number(coord.Lng(), 'f', 6);
         if (myHome) {
             map->Projection()->offSetFromLatLngs(myHome->Coord(), coord, relativeCoord.distance, relativeCoord.bearing);
@@ -395,17 +416,46 @@ int WayPointItem::type() const
 WayPointItem::~WayPointItem()
 {
     emit aboutToBeDeleted(this);
+    if (!isMagic) {
+        map->RemoveOverlay(this);
+    }
 
     --WayPointItem::snumber;
 }
 void WayPointItem::RefreshPos()
 {
-    core::Point point = map->FromLatLngToLocal(coord);
+    if (!isMagic) {
+        // Culls the WayPoint if it moved out of view, or brings it back
+        map->UpdateOverlay(this, internals::RectLatLng(coord.Lat(), coord.Lng(), 0, 0));
+    }
+    if (!culled) {
+        core::Point point = map->FromLatLngToLocal(coord);
+        this->setPos(point.X(), point.Y());
+    }
+    emit localPositionChanged(this->pos(), this);
+}
 
-    this->setPos(point.X(), point.Y());
+void WayPointItem::SetLocalPos(QPointF const & point)
+{
+    this->setPos(point);
     emit localPositionChanged(this->pos(), this);
 }
 
+void WayPointItem::SetCulled(bool value)
+{
+    if (culled == value) {
+        return;
+    }
+    culled = value;
+    QGraphicsItem::setVisible(userVisible && !culled);
+}
+
+void WayPointItem::setUserVisible(bool visible)
+{
+    userVisible = visible;
+    QGraphicsItem::setVisible(userVisible && !culled);
+}
+
 void WayPointItem::setOpacitySlot(qreal opacity)
 {
     setOpacity(opacity);
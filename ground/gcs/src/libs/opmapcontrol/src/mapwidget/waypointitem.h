@@ -193,6 +193,42 @@ public:
         myCustomString = arg;
     }
     void setFlag(GraphicsItemFlag flag, bool enabled);
+    /**
+     * @brief Shows or hides the WayPoint, a culled WayPoint stays hidden until back in view.
+     *        QGraphicsItem::setVisible() is not virtual, use this one instead
+     *
+     * @param visible
+     */
+    void setUserVisible(bool visible);
+    /**
+     * @brief Returns true if the WayPoint was hidden with setUserVisible()
+     *
+     */
+    bool IsHidden()
+    {
+        return !userVisible;
+    }
+    /**
+     * @brief Returns true if the WayPoint is out of view or part of a cluster,
+     *        it is then hidden and its local position is not kept up to date
+     *
+     */
+    bool IsCulled()
+    {
+        return culled;
+    }
+    /**
+     * @brief Culls or restores the WayPoint, used by the map
+     *
+     * @param value
+     */
+    void SetCulled(bool value);
+    /**
+     * @brief Moves the WayPoint to an already projected local position, used by the map
+     *
+     * @param point
+     */
+    void SetLocalPos(QPointF const & point);
     ~WayPointItem();
 
     static int snumber;
@@ -217,6 +253,8 @@ private:
     MapGraphicItem *map;
     int number;
     bool isMagic;
+    bool culled;
+    bool userVisible;
 
     QGraphicsSimpleTextItem *text;
     QGraphicsRectItem *textBG;
@@ -32,7 +32,6 @@ namespace mapcontrol {
 WayPointLine::WayPointLine(WayPointItem *from, WayPointItem *to, MapGraphicItem *map, QColor color, bool dashed, int width) : QGraphicsLineItem(map),
     source(from), destination(to), my_map(map), myColor(color), dashed(dashed), lineWidth(width)
 {
-    this->setLine(to->pos().x(), to->pos().y(), from->pos().x(), from->pos().y());
     connect(from, SIGNAL(localPositionChanged(QPointF, WayPointItem *)), this, SLOT(refreshLocations()));
     connect(to, SIGNAL(localPositionChanged(QPointF, WayPointItem *)), this, SLOT(refreshLocations()));
     connect(from, SIGNAL(aboutToBeDeleted(WayPointItem *)), this, SLOT(waypointdeleted()));
@@ -44,13 +43,13 @@ WayPointLine::WayPointLine(WayPointItem *from, WayPointItem *to, MapGraphicItem
     } else if (myColor == Qt::red) {
         this->setZValue(8);
     }
+    refreshLocations();
     connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
 }
 
 WayPointLine::WayPointLine(HomeItem *from, WayPointItem *to, MapGraphicItem *map, QColor color, bool dashed, int width) : QGraphicsLineItem(map),
     source(from), destination(to), my_map(map), myColor(color), dashed(dashed), lineWidth(width)
 {
-    this->setLine(to->pos().x(), to->pos().y(), from->pos().x(), from->pos().y());
     connect(from, SIGNAL(homePositionChanged(internals::PointLatLng, float)), this, SLOT(refreshLocations()));
     connect(to, SIGNAL(localPositionChanged(QPointF, WayPointItem *)), this, SLOT(refreshLocations()));
     connect(to, SIGNAL(aboutToBeDeleted(WayPointItem *)), this, SLOT(waypointdeleted()));
@@ -61,8 +60,13 @@ WayPointLine::WayPointLine(HomeItem *from, WayPointItem *to, MapGraphicItem *map
     } else if (myColor == Qt::red) {
         this->setZValue(8);
     }
+    refreshLocations();
     connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
 }
+WayPointLine::~WayPointLine()
+{
+    my_map->RemoveOverlay(this);
+}
 int WayPointLine::type() const
 {
     // Enable the use of qgraphicsitem_cast with this item.
@@ -122,7 +126,17 @@ void WayPointLine::paint(QPainter *painter, const QStyleOptionGraphicsItem *opti
 
 void WayPointLine::refreshLocations()
 {
-    this->setLine(destination->pos().x(), destination->pos().y(), source->pos().x(), source->pos().y());
+    internals::PointLatLng from = my_map->OverlayCoord(source);
+    internals::PointLatLng to   = my_map->OverlayCoord(destination);
+
+    my_map->UpdateOverlay(this, internals::RectLatLng::FromLTRB(qMin(from.Lng(), to.Lng()), qMax(from.Lat(), to.Lat()),
+                                                                qMax(from.Lng(), to.Lng()), qMin(from.Lat(), to.Lat())));
+    if (!my_map->IsOverlayShown(this)) {
+        return;
+    }
+    QPointF p1 = my_map->OverlayPos(destination);
+    QPointF p2 = my_map->OverlayPos(source);
+    this->setLine(p1.x(), p1.y(), p2.x(), p2.y());
 }
 
 void WayPointLine::waypointdeleted()
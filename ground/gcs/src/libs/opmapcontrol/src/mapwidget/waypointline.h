@@ -42,12 +42,21 @@ public:
     enum { Type = UserType + 8 };
     WayPointLine(WayPointItem *from, WayPointItem *to, MapGraphicItem *map, QColor color = Qt::green, bool dashed = false, int width = -1);
     WayPointLine(HomeItem *from, WayPointItem *to, MapGraphicItem *map, QColor color = Qt::green, bool dashed = false, int width = -1);
+    ~WayPointLine();
     int type() const;
     QPainterPath shape() const;
     void setColor(const QColor &color)
     {
         myColor = color;
     }
+    QGraphicsItem *Source() const
+    {
+        return source;
+    }
+    QGraphicsItem *Destination() const
+    {
+        return destination;
+    }
 private:
     QGraphicsItem *source;
     QGraphicsItem *destination;
@@ -0,0 +1,38 @@
+#
+# Overlay spatial index against a linear scan, and the per frame cost of
+# repositioning 2000 waypoints with and without viewport culling
+#
+
+include(../../../../../gcs.pri)
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = mapitemindextest
+
+QT = core gui widgets testlib
+
+MAP_DIR = $$GCS_SOURCE_TREE/src/libs/opmapcontrol/src
+
+INCLUDEPATH += $$MAP_DIR/mapwidget $$MAP_DIR/internals $$MAP_DIR/core
+
+HEADERS += \
+    $$MAP_DIR/mapwidget/mapitemindex.h \
+    $$MAP_DIR/core/point.h \
+    $$MAP_DIR/core/size.h \
+    $$MAP_DIR/internals/pointlatlng.h \
+    $$MAP_DIR/internals/rectlatlng.h \
+    $$MAP_DIR/internals/sizelatlng.h \
+    $$MAP_DIR/internals/pureprojection.h \
+    $$MAP_DIR/internals/projections/mercatorprojection.h
+
+SOURCES += \
+    tst_mapitemindex.cpp \
+    $$MAP_DIR/mapwidget/mapitemindex.cpp \
+    $$MAP_DIR/core/point.cpp \
+    $$MAP_DIR/core/size.cpp \
+    $$MAP_DIR/internals/pointlatlng.cpp \
+    $$MAP_DIR/internals/rectlatlng.cpp \
+    $$MAP_DIR/internals/sizelatlng.cpp \
+    $$MAP_DIR/internals/pureprojection.cpp \
+    $$MAP_DIR/internals/projections/mercatorprojection.cpp
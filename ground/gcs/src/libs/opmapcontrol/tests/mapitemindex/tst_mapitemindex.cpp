@@ -0,0 +1,250 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_mapitemindex.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Overlay spatial index queries and viewport culling frame times
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "mapitemindex.h"
+#include "projections/mercatorprojection.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QElapsedTimer>
+#include <QtWidgets/QGraphicsRectItem>
+
+using namespace mapcontrol;
+
+class tst_MapItemIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void query();
+    void move();
+    void remove();
+    void frameTime();
+
+private:
+    // A survey grid with lines between consecutive waypoints
+    static const int WAYPOINTS = 2000;
+
+    QVector<QGraphicsItem *> m_items;
+    QVector<internals::RectLatLng> m_rects;
+    QHash<QGraphicsItem *, int> m_positions;
+
+    void createSurvey(MapItemIndex &index);
+    QSet<QGraphicsItem *> linearScan(internals::RectLatLng const & rect) const;
+    static bool overlaps(internals::RectLatLng const & a, internals::RectLatLng const & b);
+};
+
+void tst_MapItemIndex::init()
+{
+    qsrand(42);
+}
+
+void tst_MapItemIndex::cleanup()
+{
+    qDeleteAll(m_items);
+    m_items.clear();
+    m_rects.clear();
+    m_positions.clear();
+}
+
+/**
+ * Waypoints on a 50 x 40 grid about 100 m apart, and the lines joining them
+ */
+void tst_MapItemIndex::createSurvey(MapItemIndex &index)
+{
+    internals::PointLatLng last;
+
+    for (int i = 0; i < WAYPOINTS; ++i) {
+        int row = i / 50;
+        int col = (row % 2) ? 49 - i % 50 : i % 50;
+        internals::PointLatLng coord(46.0 + row * 0.0009, 7.0 + col * 0.0013);
+
+        m_items.append(new QGraphicsRectItem);
+        m_rects.append(internals::RectLatLng(coord.Lat(), coord.Lng(), 0, 0));
+        if (i > 0) {
+            m_items.append(new QGraphicsLineItem);
+            m_rects.append(internals::RectLatLng::FromLTRB(qMin(last.Lng(), coord.Lng()), qMax(last.Lat(), coord.Lat()),
+                                                           qMax(last.Lng(), coord.Lng()), qMin(last.Lat(), coord.Lat())));
+        }
+        last = coord;
+    }
+    for (int i = 0; i < m_items.size(); ++i) {
+        m_positions.insert(m_items.at(i), i);
+        QVERIFY(index.Insert(m_items.at(i), m_rects.at(i)));
+    }
+    QCOMPARE(index.Count(), m_items.size());
+}
+
+bool tst_MapItemIndex::overlaps(internals::RectLatLng const & a, internals::RectLatLng const & b)
+{
+    return a.Left() <= b.Right() && b.Left() <= a.Right() && a.Bottom() <= b.Top() && b.Bottom() <= a.Top();
+}
+
+QSet<QGraphicsItem *> tst_MapItemIndex::linearScan(internals::RectLatLng const & rect) const
+{
+    QSet<QGraphicsItem *> result;
+
+    for (int i = 0; i < m_items.size(); ++i) {
+        if (overlaps(m_rects.at(i), rect)) {
+            result.insert(m_items.at(i));
+        }
+    }
+    return result;
+}
+
+void tst_MapItemIndex::query()
+{
+    MapItemIndex index;
+
+    createSurvey(index);
+
+    for (int i = 0; i < 200; ++i) {
+        double lat    = 45.99 + (qrand() / (double)RAND_MAX) * 0.05;
+        double lng    = 6.99 + (qrand() / (double)RAND_MAX) * 0.08;
+        double width  = (qrand() / (double)RAND_MAX) * 0.03;
+        double height = (qrand() / (double)RAND_MAX) * 0.02;
+        internals::RectLatLng rect(lat, lng, width, height);
+
+        QVector<QGraphicsItem *> found;
+        index.Query(rect, found);
+        QSet<QGraphicsItem *> result = found.toList().toSet();
+        QCOMPARE(result.size(), found.size());
+        QCOMPARE(result, linearScan(rect));
+    }
+}
+
+void tst_MapItemIndex::move()
+{
+    MapItemIndex index;
+
+    createSurvey(index);
+
+    // Same box, nothing to do
+    QVERIFY(!index.Insert(m_items.first(), m_rects.first()));
+
+    // Move a quarter of the items to the other side of the world
+    for (int i = 0; i < m_items.size(); i += 4) {
+        m_rects[i] = internals::RectLatLng(-m_rects.at(i).Lat(), -m_rects.at(i).Lng(), 0, 0);
+        QVERIFY(index.Insert(m_items.at(i), m_rects.at(i)));
+    }
+    QCOMPARE(index.Count(), m_items.size());
+
+    QList<internals::RectLatLng> areas;
+    areas << internals::RectLatLng(46.1, 6.9, 0.2, 0.2) << internals::RectLatLng(-45.9, -7.1, 0.2, 0.2);
+    foreach(internals::RectLatLng area, areas) {
+        QVector<QGraphicsItem *> found;
+        index.Query(area, found);
+        QCOMPARE(found.toList().toSet(), linearScan(area));
+    }
+}
+
+void tst_MapItemIndex::remove()
+{
+    MapItemIndex index;
+
+    createSurvey(index);
+
+    for (int i = 0; i < m_items.size(); i += 2) {
+        index.Remove(m_items.at(i));
+        QVERIFY(!index.Contains(m_items.at(i)));
+    }
+    // Unknown items are ignored
+    index.Remove(m_items.first());
+    QCOMPARE(index.Count(), m_items.size() / 2);
+
+    QVector<QGraphicsItem *> found;
+    index.Query(internals::RectLatLng(90, -180, 360, 180), found);
+    QCOMPARE(found.size(), m_items.size() / 2);
+    foreach(QGraphicsItem * item, found) {
+        QVERIFY(m_positions.value(item) % 2 == 1);
+    }
+
+    index.Clear();
+    QCOMPARE(index.Count(), 0);
+}
+
+/**
+ * Cost of a pan or zoom step: before, every waypoint was projected; now only
+ * those around the view, found through the index, are
+ */
+void tst_MapItemIndex::frameTime()
+{
+    MapItemIndex index;
+
+    createSurvey(index);
+
+    projections::MercatorProjection projection;
+    const int frames = 200;
+    const int zoom   = 17;
+
+    // About 1000 x 700 pixels at zoom 17 plus half of it around, a corner of the survey
+    internals::RectLatLng view(46.02, 7.0, 0.0054, 0.0025);
+    internals::RectLatLng area = internals::RectLatLng::Inflate(view, view.HeightLat() * 0.5, view.WidthLng() * 0.5);
+
+    QElapsedTimer timer;
+    qint64 checksum = 0;
+
+    timer.start();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int i = 0; i < m_items.size(); ++i) {
+            if (m_rects.at(i).WidthLng() == 0 && m_rects.at(i).HeightLat() == 0) {
+                core::Point p = projection.FromLatLngToPixel(m_rects.at(i).Lat(), m_rects.at(i).Lng(), zoom);
+                checksum += p.X();
+            }
+        }
+    }
+    double allMs = timer.nsecsElapsed() / 1e6 / frames;
+
+    int visible = 0;
+    timer.start();
+    for (int frame = 0; frame < frames; ++frame) {
+        QVector<QGraphicsItem *> found;
+        index.Query(area, found);
+
+        QVector<double> lat;
+        QVector<double> lng;
+        foreach(QGraphicsItem * item, found) {
+            if (item->type() == QGraphicsRectItem::Type) {
+                internals::RectLatLng rect = m_rects.at(m_positions.value(item));
+                lat.append(rect.Lat());
+                lng.append(rect.Lng());
+            }
+        }
+        QVector<double> x(lat.size());
+        QVector<double> y(lat.size());
+        projection.FromLatLngToPixels(lat.constData(), lng.constData(), x.data(), y.data(), lat.size(), zoom);
+        visible = lat.size();
+    }
+    double culledMs = timer.nsecsElapsed() / 1e6 / frames;
+
+    QVERIFY(checksum != 0);
+    QVERIFY(visible > 0 && visible < WAYPOINTS);
+    qDebug("%d waypoints, %d around the view: all %6.3f ms/frame, culled %6.3f ms/frame",
+           WAYPOINTS, visible, allMs, culledMs);
+}
+
+QTEST_GUILESS_MAIN(tst_MapItemIndex)
+
+#include "tst_mapitemindex.moc"
@@ -0,0 +1,49 @@
+#
+# Batch map projection against the per point projection, and its throughput
+# The benchmark prints the points per second of both
+#
+
+include(../../../../../gcs.pri)
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = projectiontest
+
+QT = core testlib
+
+MAP_DIR = $$GCS_SOURCE_TREE/src/libs/opmapcontrol/src
+
+INCLUDEPATH += $$MAP_DIR/internals $$MAP_DIR/core $$GCS_SOURCE_TREE/src/libs
+
+HEADERS += \
+    $$MAP_DIR/core/point.h \
+    $$MAP_DIR/core/size.h \
+    $$MAP_DIR/internals/pointlatlng.h \
+    $$MAP_DIR/internals/rectlatlng.h \
+    $$MAP_DIR/internals/sizelatlng.h \
+    $$MAP_DIR/internals/pureprojection.h \
+    $$MAP_DIR/internals/projections/mercatorprojection.h \
+    $$MAP_DIR/internals/projections/mercatorprojectionyandex.h \
+    $$MAP_DIR/internals/projections/platecarreeprojection.h \
+    $$MAP_DIR/internals/projections/platecarreeprojectionpergo.h \
+    $$MAP_DIR/internals/projections/lks94projection.h
+
+SOURCES += \
+    tst_projection.cpp \
+    $$MAP_DIR/core/point.cpp \
+    $$MAP_DIR/core/size.cpp \
+    $$MAP_DIR/internals/pointlatlng.cpp \
+    $$MAP_DIR/internals/rectlatlng.cpp \
+    $$MAP_DIR/internals/sizelatlng.cpp \
+    $$MAP_DIR/internals/pureprojection.cpp \
+    $$MAP_DIR/internals/projections/mercatorprojection.cpp \
+    $$MAP_DIR/internals/projections/mercatorprojectionyandex.cpp \
+    $$MAP_DIR/internals/projections/platecarreeprojection.cpp \
+    $$MAP_DIR/internals/projections/platecarreeprojectionpergo.cpp \
+    $$MAP_DIR/internals/projections/lks94projection.cpp
+
+# Built like the map library
+*-g++* {
+    QMAKE_CXXFLAGS += -fno-trapping-math -ftree-vectorize -fvect-cost-model=cheap
+}
@@ -0,0 +1,301 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_projection.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Batch map projection accuracy and throughput
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "projections/mercatorprojection.h"
+#include "projections/mercatorprojectionyandex.h"
+#include "projections/platecarreeprojection.h"
+#include "projections/platecarreeprojectionpergo.h"
+#include "projections/lks94projection.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QVector>
+
+// Largest difference in pixels of the batch to the libm projection, it is 2.6e-6 at zoom 21
+static const double TOLERANCE = 1e-5;
+
+class tst_Projection : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void mercator();
+    void mercatorAccuracy();
+    void plateCarree();
+    void plateCarreePergo();
+    void yandex();
+    void yandexAccuracy();
+    void lks94();
+    void defaultImplementation();
+    void benchmark();
+
+private:
+    static const int POINTS   = 10000;
+    static const int MAX_ZOOM = 21;
+
+    // Also outside of the projection limits, to check the clipping
+    QVector<double> m_lat;
+    QVector<double> m_lng;
+};
+
+// Rounded, the batch and per point results differ only across a pixel boundary
+// the batch result is within the tolerance of
+static bool sameRounding(double batch, int rounded, int expected)
+{
+    return rounded == expected || qAbs(batch - qMax(rounded, expected)) <= TOLERANCE;
+}
+
+void tst_Projection::initTestCase()
+{
+    qsrand(42);
+    m_lat.resize(POINTS);
+    m_lng.resize(POINTS);
+    for (int i = 0; i < POINTS; ++i) {
+        m_lat[i] = (qrand() / (double)RAND_MAX) * 180.0 - 90.0;
+        m_lng[i] = (qrand() / (double)RAND_MAX) * 360.0 - 180.0;
+    }
+}
+
+/**
+ * The batch is clipped to the map, rounded to the nearest pixel it gives the per point result
+ */
+void tst_Projection::mercator()
+{
+    projections::MercatorProjection projection;
+    QVector<double> x(POINTS);
+    QVector<double> y(POINTS);
+
+    for (int zoom = 0; zoom <= MAX_ZOOM; ++zoom) {
+        projection.FromLatLngToPixels(m_lat.constData(), m_lng.constData(), x.data(), y.data(), POINTS, zoom);
+
+        Size s = projection.GetTileMatrixSizePixel(zoom);
+        for (int i = 0; i < POINTS; ++i) {
+            QVERIFY(x.at(i) >= 0 && x.at(i) <= s.Width() - 1);
+            QVERIFY(y.at(i) >= 0 && y.at(i) <= s.Height() - 1);
+            core::Point p = projection.FromLatLngToPixel(m_lat.at(i), m_lng.at(i), zoom);
+            QVERIFY(sameRounding(x.at(i) + 0.5, (int)(x.at(i) + 0.5), p.X()));
+            QVERIFY(sameRounding(y.at(i) + 0.5, (int)(y.at(i) + 0.5), p.Y()));
+        }
+    }
+}
+
+/**
+ * The polynomial sin and log against libm, in the arithmetic of FromLatLngToPixel()
+ */
+void tst_Projection::mercatorAccuracy()
+{
+    projections::MercatorProjection projection;
+    QVector<double> x(POINTS);
+    QVector<double> y(POINTS);
+    double maxError = 0;
+
+    for (int zoom = 0; zoom <= MAX_ZOOM; ++zoom) {
+        projection.FromLatLngToPixels(m_lat.constData(), m_lng.constData(), x.data(), y.data(), POINTS, zoom);
+
+        Size s = projection.GetTileMatrixSizePixel(zoom);
+        double mapSizeX = s.Width();
+        double mapSizeY = s.Height();
+        for (int i = 0; i < POINTS; ++i) {
+            double lat = qBound(-85.05112878, m_lat.at(i), 85.05112878);
+            double lng = qBound(-177.0, m_lng.at(i), 177.0);
+            double sinLatitude = sin(lat * M_PI / 180);
+            double px = qBound(0.0, (lng + 180) / 360 * mapSizeX, mapSizeX - 1);
+            double py = qBound(0.0, (0.5 - log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * M_PI)) * mapSizeY, mapSizeY - 1);
+
+            maxError = qMax(maxError, qMax(qAbs(x.at(i) - px), qAbs(y.at(i) - py)));
+        }
+    }
+    qDebug("largest error %g pixel", maxError);
+    QVERIFY(maxError <= TOLERANCE);
+}
+
+/**
+ * Truncated the batch gives the per point result
+ */
+void tst_Projection::plateCarree()
+{
+    projections::PlateCarreeProjection projection;
+    QVector<double> x(POINTS);
+    QVector<double> y(POINTS);
+
+    for (int zoom = 0; zoom <= MAX_ZOOM; ++zoom) {
+        projection.FromLatLngToPixels(m_lat.constData(), m_lng.constData(), x.data(), y.data(), POINTS, zoom);
+
+        for (int i = 0; i < POINTS; ++i) {
+            core::Point p = projection.FromLatLngToPixel(m_lat.at(i), m_lng.at(i), zoom);
+            QCOMPARE((int)x.at(i), p.X());
+            QCOMPARE((int)y.at(i), p.Y());
+        }
+    }
+}
+
+void tst_Projection::plateCarreePergo()
+{
+    projections::PlateCarreeProjectionPergo projection;
+    QVector<double> x(POINTS);
+    QVector<double> y(POINTS);
+
+    for (int zoom = 0; zoom <= MAX_ZOOM; ++zoom) {
+        projection.FromLatLngToPixels(m_lat.constData(), m_lng.constData(), x.data(), y.data(), POINTS, zoom);
+
+        for (int i = 0; i < POINTS; ++i) {
+            core::Point p = projection.FromLatLngToPixel(m_lat.at(i), m_lng.at(i), zoom);
+            QCOMPARE((int)x.at(i), p.X());
+            QCOMPARE((int)y.at(i), p.Y());
+        }
+    }
+}
+
+/**
+ * Truncated the batch gives the per point result
+ */
+void tst_Projection::yandex()
+{
+    projections::MercatorProjectionYandex projection;
+    QVector<double> x(POINTS);
+    QVector<double> y(POINTS);
+
+    for (int zoom = 0; zoom <= MAX_ZOOM; ++zoom) {
+        projection.FromLatLngToPixels(m_lat.constData(), m_lng.constData(), x.data(), y.data(), POINTS, zoom);
+
+        for (int i = 0; i < POINTS; ++i) {
+            core::Point p = projection.FromLatLngToPixel(m_lat.at(i), m_lng.at(i), zoom);
+            QCOMPARE((int)x.at(i), p.X());
+            QVERIFY(sameRounding(y.at(i), (int)y.at(i), p.Y()));
+        }
+    }
+}
+
+/**
+ * The sin and log form of the batch against the tan, asin and pow of FromLatLngToPixel()
+ */
+void tst_Projection::yandexAccuracy()
+{
+    projections::MercatorProjectionYandex projection;
+    QVector<double> x(POINTS);
+    QVector<double> y(POINTS);
+    const double a = 6378137;
+    const double k = 0.0818191908426;
+    double maxError = 0;
+
+    for (int zoom = 0; zoom <= MAX_ZOOM; ++zoom) {
+        projection.FromLatLngToPixels(m_lat.constData(), m_lng.constData(), x.data(), y.data(), POINTS, zoom);
+
+        double z1 = pow(2, 23 - zoom);
+        for (int i = 0; i < POINTS; ++i) {
+            double rLat = qBound(-85.05112878, m_lat.at(i), 85.05112878) * M_PI / 180;
+            double z    = tan(M_PI / 4 + rLat / 2) / pow((tan(M_PI / 4 + asin(k * sin(rLat)) / 2)), k);
+            double py   = ((20037508.342789 - a * log(z)) * 53.5865938 / z1);
+
+            maxError = qMax(maxError, qAbs(y.at(i) - py));
+        }
+    }
+    qDebug("largest error %g pixel", maxError);
+    QVERIFY(maxError <= TOLERANCE);
+}
+
+/**
+ * Floored the batch gives the per point result, over Lithuania
+ */
+void tst_Projection::lks94()
+{
+    projections::LKS94Projection projection;
+    const int count = 1000;
+    QVector<double> lat(count);
+    QVector<double> lng(count);
+    QVector<double> x(count);
+    QVector<double> y(count);
+
+    for (int i = 0; i < count; ++i) {
+        lat[i] = 53.0 + 4.0 * i / count;
+        lng[i] = 20.0 + 7.5 * m_lng.at(i) / 360.0 + 3.75;
+    }
+    for (int zoom = 0; zoom <= 11; ++zoom) {
+        projection.FromLatLngToPixels(lat.constData(), lng.constData(), x.data(), y.data(), count, zoom);
+
+        for (int i = 0; i < count; ++i) {
+            core::Point p = projection.FromLatLngToPixel(lat.at(i), lng.at(i), zoom);
+            QCOMPARE((int)floor(x.at(i)), p.X());
+            QCOMPARE((int)floor(y.at(i)), p.Y());
+        }
+    }
+}
+
+/**
+ * Projections without a batch implementation fall back to the per point one
+ */
+void tst_Projection::defaultImplementation()
+{
+    projections::MercatorProjection projection;
+    QVector<double> x(POINTS);
+    QVector<double> y(POINTS);
+    const int zoom = 12;
+
+    projection.internals::PureProjection::FromLatLngToPixels(m_lat.constData(), m_lng.constData(), x.data(), y.data(), POINTS, zoom);
+    for (int i = 0; i < POINTS; ++i) {
+        core::Point p = projection.FromLatLngToPixel(m_lat.at(i), m_lng.at(i), zoom);
+        QCOMPARE(x.at(i), (double)p.X());
+        QCOMPARE(y.at(i), (double)p.Y());
+    }
+}
+
+void tst_Projection::benchmark()
+{
+    const int count = 1000000;
+    const int zoom  = 18;
+    QVector<double> lat(count);
+    QVector<double> lng(count);
+    QVector<double> x(count);
+    QVector<double> y(count);
+
+    // A long flight log around a field
+    for (int i = 0; i < count; ++i) {
+        lat[i] = 46.0 + 0.01 * sin(i * 0.001);
+        lng[i] = 7.0 + 0.01 * cos(i * 0.001);
+    }
+
+    projections::MercatorProjection projection;
+    QElapsedTimer timer;
+    qint64 checksum = 0;
+
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        core::Point p = projection.FromLatLngToPixel(lat.at(i), lng.at(i), zoom);
+        checksum += p.X() + p.Y();
+    }
+    double pointSeconds = timer.nsecsElapsed() / 1e9;
+
+    timer.start();
+    projection.FromLatLngToPixels(lat.constData(), lng.constData(), x.data(), y.data(), count, zoom);
+    double batchSeconds = timer.nsecsElapsed() / 1e9;
+
+    QVERIFY(checksum != 0);
+    qDebug("per point %6.1f Mpoints/s, batch %6.1f Mpoints/s, speedup %4.2f",
+           count / pointSeconds / 1e6, count / batchSeconds / 1e6, pointSeconds / batchSeconds);
+}
+
+QTEST_GUILESS_MAIN(tst_Projection)
+
+#include "tst_projection.moc"
@@ -52,6 +52,16 @@ public:
      * \return         The updated crc value.
      */
     static quint8 updateCRC(quint8 crc, const quint8 *data, qint32 length);
+
+    /**
+     * Update the CRC-32 (IEEE 802.3, as zlib) value with new data.
+     *
+     * \param crc      The current crc value, 0 to start.
+     * \param data     Pointer to a buffer of \a data_len bytes.
+     * \param length   Number of bytes in the \a data buffer.
+     * \return         The updated crc value.
+     */
+    static quint32 updateCRC32(quint32 crc, const quint8 *data, qint32 length);
 };
 } // namespace Utils
 
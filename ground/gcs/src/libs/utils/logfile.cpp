@@ -23,9 +23,165 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "logfile.h"
+#include "crc.h"
 
 #include <QDebug>
 #include <QtGlobal>
+#include <QtEndian>
+#include <QThread>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QElapsedTimer>
+
+/*
+ * Block compressed format (.oplz), all values little endian:
+ *   header  "OPLZ", u16 version, u16 reserved
+ *   block   "OPLB", u32 payload size, u32 raw size, u32 records,
+ *           u32 first timestamp, u32 last timestamp, u32 payload CRC-32, payload
+ *           the payload is the qCompress()ed run of plain .opl records
+ *   index   "OPLI", u32 count, count * (u64 offset, u32 first timestamp, u32 last timestamp, u32 records)
+ *   trailer u64 index offset, "OPLE"
+ * The index and trailer are missing if the writer did not close the file,
+ * the blocks are then found by scanning.
+ */
+static const char BLOCK_FILE_MAGIC[]  = "OPLZ";
+static const char BLOCK_MAGIC[]       = "OPLB";
+static const char INDEX_MAGIC[]       = "OPLI";
+static const char TRAILER_MAGIC[]     = "OPLE";
+static const quint16 BLOCK_FILE_VERSION = 1;
+static const int FILE_HEADER_SIZE     = 8;
+static const int BLOCK_HEADER_SIZE    = 28;
+static const int INDEX_ENTRY_SIZE     = 20;
+static const int TRAILER_SIZE         = 12;
+static const quint32 MAX_BLOCK_SIZE   = 16 * 1024 * 1024;
+// Raw blocks waiting for the compressor before the writer blocks
+static const int MAX_PENDING_BLOCKS   = 16;
+
+/**
+ * Groups the records of a log in blocks, compresses and writes them in its
+ * own thread. A partial block is written after FLUSH_INTERVAL_MS so that a
+ * slow log reaches the disk, and is not lost if the GCS crashes.
+ */
+class LogFileCompressor : public QThread {
+public:
+    LogFileCompressor(QFile *file) : m_file(file), m_records(0), m_firstTimeStamp(0), m_lastTimeStamp(0), m_finishing(false) {}
+
+    void append(quint32 timeStamp, const char *data, qint64 dataSize)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (m_records == 0) {
+            m_firstTimeStamp = timeStamp;
+            m_age.start();
+            // Starts the flush timeout
+            m_queued.wakeOne();
+        }
+        m_block.append((const char *)&timeStamp, sizeof(timeStamp));
+        m_block.append((const char *)&dataSize, sizeof(dataSize));
+        m_block.append(data, dataSize);
+        m_lastTimeStamp = timeStamp;
+        ++m_records;
+        if (m_block.size() >= LogFile::BLOCK_SIZE || timeStamp - m_firstTimeStamp >= LogFile::BLOCK_DURATION_MS) {
+            while (m_queue.size() >= MAX_PENDING_BLOCKS) {
+                m_dequeued.wait(&m_mutex);
+            }
+            enqueueBlock();
+        }
+    }
+
+    // Write the pending blocks and stop, returns the index of the written blocks
+    QVector<LogFile::BlockInfo> finish()
+    {
+        m_mutex.lock();
+        enqueueBlock();
+        m_finishing = true;
+        m_queued.wakeOne();
+        m_mutex.unlock();
+        wait();
+        return m_index;
+    }
+
+protected:
+    void run()
+    {
+        forever {
+            m_mutex.lock();
+            while (m_queue.isEmpty() && !m_finishing) {
+                if (m_records == 0) {
+                    m_queued.wait(&m_mutex);
+                } else if (m_age.elapsed() >= LogFile::FLUSH_INTERVAL_MS) {
+                    enqueueBlock();
+                } else {
+                    m_queued.wait(&m_mutex, LogFile::FLUSH_INTERVAL_MS - m_age.elapsed());
+                }
+            }
+            if (m_queue.isEmpty()) {
+                m_mutex.unlock();
+                break;
+            }
+            Pending pending = m_queue.dequeue();
+            m_dequeued.wakeOne();
+            m_mutex.unlock();
+
+            QByteArray payload = qCompress(pending.raw);
+            quint8 header[BLOCK_HEADER_SIZE];
+            memcpy(header, BLOCK_MAGIC, 4);
+            qToLittleEndian<quint32>(payload.size(), &header[4]);
+            qToLittleEndian<quint32>(pending.raw.size(), &header[8]);
+            qToLittleEndian<quint32>(pending.info.records, &header[12]);
+            qToLittleEndian<quint32>(pending.info.firstTimeStamp, &header[16]);
+            qToLittleEndian<quint32>(pending.info.lastTimeStamp, &header[20]);
+            qToLittleEndian<quint32>(Utils::Crc::updateCRC32(0, (const quint8 *)payload.constData(), payload.size()), &header[24]);
+
+            pending.info.offset = m_file->pos();
+            if (m_file->write((const char *)header, sizeof(header)) != sizeof(header)
+                || m_file->write(payload) != payload.size()) {
+                qWarning() << "LogFile - failed to write block to" << m_file->fileName();
+                continue;
+            }
+            m_file->flush();
+            m_index.append(pending.info);
+        }
+    }
+
+private:
+    typedef struct {
+        QByteArray raw;
+        LogFile::BlockInfo info;
+    } Pending;
+
+    QFile *m_file;
+    QMutex m_mutex;
+    QWaitCondition m_queued;
+    QWaitCondition m_dequeued;
+    QQueue<Pending> m_queue;
+    // Block being filled
+    QByteArray m_block;
+    quint32 m_records;
+    quint32 m_firstTimeStamp;
+    quint32 m_lastTimeStamp;
+    QElapsedTimer m_age;
+    bool m_finishing;
+    QVector<LogFile::BlockInfo> m_index;
+
+    // Called with m_mutex locked
+    void enqueueBlock()
+    {
+        if (m_records == 0) {
+            return;
+        }
+        Pending pending;
+        pending.raw = m_block;
+        pending.info.offset = 0;
+        pending.info.firstTimeStamp = m_firstTimeStamp;
+        pending.info.lastTimeStamp  = m_lastTimeStamp;
+        pending.info.records = m_records;
+        m_queue.enqueue(pending);
+        m_queued.wakeOne();
+        m_block.clear();
+        m_records = 0;
+    }
+};
 
 LogFile::LogFile(QObject *parent) : QIODevice(parent),
     m_timer(this),
@@ -36,11 +192,22 @@ LogFile::LogFile(QObject *parent) : QIODevice(parent),
     m_playbackSpeed(1.0),
     paused(false),
     m_useProvidedTimeStamp(false),
-    m_providedTimeStamp(0)
+    m_providedTimeStamp(0),
+    m_compressed(false),
+    m_compressor(0),
+    m_nextBlock(0),
+    m_scanOffset(0)
 {
     connect(&m_timer, &QTimer::timeout, this, &LogFile::timerFired);
 }
 
+LogFile::~LogFile()
+{
+    if (m_compressor) {
+        close();
+    }
+}
+
 bool LogFile::isSequential() const
 {
     // returning true fixes "UAVTalk - error : bad type" errors when replaying a log file
@@ -70,6 +237,32 @@ bool LogFile::open(OpenMode mode)
         return false;
     }
 
+    m_blockIndex.clear();
+    m_blockReader.close();
+    m_blockReader.setData(QByteArray());
+    m_compressed = false;
+    if (m_file.isWritable()) {
+        if (fileName().endsWith(".oplz", Qt::CaseInsensitive)) {
+            quint8 header[FILE_HEADER_SIZE];
+            memcpy(header, BLOCK_FILE_MAGIC, 4);
+            qToLittleEndian<quint16>(BLOCK_FILE_VERSION, &header[4]);
+            qToLittleEndian<quint16>(0, &header[6]);
+            m_file.write((const char *)header, sizeof(header));
+
+            m_compressed = true;
+            m_compressor = new LogFileCompressor(&m_file);
+            m_compressor->start(QThread::LowPriority);
+        }
+    } else if (m_file.peek(4) == QByteArray(BLOCK_FILE_MAGIC, 4)) {
+        m_compressed = true;
+        if (!readIndex()) {
+            qWarning() << "LogFile - no block index in" << fileName() << ", scanning for blocks";
+        }
+        m_file.seek(FILE_HEADER_SIZE);
+        m_nextBlock  = 0;
+        m_scanOffset = FILE_HEADER_SIZE;
+    }
+
     // TODO: Write a header at the beginng describing objects so that in future
     // they can be read back if ID's change
 
@@ -85,6 +278,30 @@ void LogFile::close()
 {
     qDebug() << "LogFile - close" << fileName();
     emit aboutToClose();
+    if (m_compressor) {
+        QVector<BlockInfo> index = m_compressor->finish();
+        delete m_compressor;
+        m_compressor = 0;
+
+        // Block index and trailer
+        qint64 indexOffset = m_file.pos();
+        QByteArray data(8 + index.size() * INDEX_ENTRY_SIZE + TRAILER_SIZE, 0);
+        quint8 *p = (quint8 *)data.data();
+        memcpy(p, INDEX_MAGIC, 4);
+        qToLittleEndian<quint32>(index.size(), p + 4);
+        p += 8;
+        foreach(const BlockInfo &info, index) {
+            qToLittleEndian<quint64>(info.offset, p);
+            qToLittleEndian<quint32>(info.firstTimeStamp, p + 8);
+            qToLittleEndian<quint32>(info.lastTimeStamp, p + 12);
+            qToLittleEndian<quint32>(info.records, p + 16);
+            p += INDEX_ENTRY_SIZE;
+        }
+        qToLittleEndian<quint64>(indexOffset, p);
+        memcpy(p + 8, TRAILER_MAGIC, 4);
+        m_file.write(data);
+    }
+    m_blockReader.close();
     m_file.close();
     QIODevice::close();
 }
@@ -99,6 +316,12 @@ qint64 LogFile::writeData(const char *data, qint64 dataSize)
     // This is used when saving logs from on-board logging
     quint32 timeStamp = m_useProvidedTimeStamp ? m_providedTimeStamp : m_myTime.elapsed();
 
+    if (m_compressed) {
+        m_compressor->append(timeStamp, data, dataSize);
+        emit bytesWritten(dataSize);
+        return dataSize;
+    }
+
     m_file.write((char *)&timeStamp, sizeof(timeStamp));
     m_file.write((char *)&dataSize, sizeof(dataSize));
 
@@ -139,7 +362,7 @@ qint64 LogFile::bytesAvailable() const
 
 void LogFile::timerFired()
 {
-    if (m_file.bytesAvailable() > 4) {
+    if (replayBytesAvailable() > 4) {
         int time;
         time = m_myTime.elapsed();
 
@@ -149,12 +372,12 @@ void LogFile::timerFired()
 
             // read data size
             qint64 dataSize;
-            if (m_file.bytesAvailable() < (qint64)sizeof(dataSize)) {
+            if (replayBytesAvailable() < (qint64)sizeof(dataSize)) {
                 qDebug() << "LogFile - end of log file reached";
                 stopReplay();
                 return;
             }
-            m_file.read((char *)&dataSize, sizeof(dataSize));
+            replayRead((char *)&dataSize, sizeof(dataSize));
 
             // check size consistency
             if (dataSize < 1 || dataSize > (1024 * 1024)) {
@@ -164,12 +387,13 @@ void LogFile::timerFired()
             }
 
             // read data
-            if (m_file.bytesAvailable() < dataSize) {
+            if (replayBytesAvailable() < dataSize) {
                 qDebug() << "LogFile - end of log file reached";
                 stopReplay();
                 return;
             }
-            QByteArray data = m_file.read(dataSize);
+            QByteArray data(dataSize, Qt::Uninitialized);
+            replayRead(data.data(), dataSize);
 
             // make data available
             m_mutex.lock();
@@ -179,13 +403,13 @@ void LogFile::timerFired()
             emit readyRead();
 
             // read next timestamp
-            if (m_file.bytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
+            if (replayBytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
                 qDebug() << "LogFile - end of log file reached";
                 stopReplay();
                 return;
             }
             m_previousTimeStamp = m_nextTimeStamp;
-            m_file.read((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
+            replayRead((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
 
             // some validity checks
             if ((m_nextTimeStamp < m_previousTimeStamp) // logfile goes back in time
@@ -224,11 +448,11 @@ bool LogFile::startReplay()
     m_dataBuffer.clear();
 
     // read next timestamp
-    if (m_file.bytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
+    if (replayBytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
         qWarning() << "LogFile - invalid log file!";
         return false;
     }
-    m_file.read((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
+    replayRead((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
 
     m_timer.setInterval(10);
     m_timer.start();
@@ -279,3 +503,154 @@ bool LogFile::resumeReplay()
     emit replayStarted();
     return true;
 }
+
+/**
+ * Hand the current block over to the compressor thread
+ */
+/**
+ * Read the block index from the end of a compressed log
+ */
+bool LogFile::readIndex()
+{
+    qint64 size = m_file.size();
+
+    if (size < FILE_HEADER_SIZE + 8 + TRAILER_SIZE || !m_file.seek(size - TRAILER_SIZE)) {
+        return false;
+    }
+    QByteArray trailer = m_file.read(TRAILER_SIZE);
+    if (trailer.size() != TRAILER_SIZE || !trailer.endsWith(QByteArray(TRAILER_MAGIC, 4))) {
+        return false;
+    }
+    qint64 indexOffset = qFromLittleEndian<quint64>((const uchar *)trailer.constData());
+    if (indexOffset < FILE_HEADER_SIZE || indexOffset > size - TRAILER_SIZE - 8 || !m_file.seek(indexOffset)) {
+        return false;
+    }
+    QByteArray index = m_file.read(size - TRAILER_SIZE - indexOffset);
+    if (index.size() < 8 || !index.startsWith(QByteArray(INDEX_MAGIC, 4))) {
+        return false;
+    }
+    const uchar *p   = (const uchar *)index.constData();
+    quint32 count    = qFromLittleEndian<quint32>(p + 4);
+    if (index.size() != 8 + (qint64)count * INDEX_ENTRY_SIZE) {
+        return false;
+    }
+    p += 8;
+    for (quint32 i = 0; i < count; ++i, p += INDEX_ENTRY_SIZE) {
+        BlockInfo info;
+        info.offset = qFromLittleEndian<quint64>(p);
+        info.firstTimeStamp = qFromLittleEndian<quint32>(p + 8);
+        info.lastTimeStamp  = qFromLittleEndian<quint32>(p + 12);
+        info.records = qFromLittleEndian<quint32>(p + 16);
+        m_blockIndex.append(info);
+    }
+    return true;
+}
+
+/**
+ * Read, check and decompress the block at offset into the replay buffer
+ */
+bool LogFile::readBlock(qint64 offset, qint64 *nextOffset)
+{
+    if (!m_file.seek(offset)) {
+        return false;
+    }
+    QByteArray header = m_file.read(BLOCK_HEADER_SIZE);
+    if (header.size() != BLOCK_HEADER_SIZE || !header.startsWith(QByteArray(BLOCK_MAGIC, 4))) {
+        return false;
+    }
+    const uchar *p = (const uchar *)header.constData();
+    quint32 payloadSize = qFromLittleEndian<quint32>(p + 4);
+    quint32 rawSize     = qFromLittleEndian<quint32>(p + 8);
+    quint32 crc = qFromLittleEndian<quint32>(p + 24);
+    if (payloadSize > MAX_BLOCK_SIZE || rawSize > MAX_BLOCK_SIZE) {
+        return false;
+    }
+    QByteArray payload = m_file.read(payloadSize);
+    if (payload.size() != (int)payloadSize
+        || Utils::Crc::updateCRC32(0, (const quint8 *)payload.constData(), payload.size()) != crc) {
+        return false;
+    }
+    QByteArray raw = qUncompress(payload);
+    if (raw.size() != (int)rawSize) {
+        return false;
+    }
+
+    m_blockReader.close();
+    m_blockReader.setData(raw);
+    m_blockReader.open(QIODevice::ReadOnly);
+    *nextOffset = offset + BLOCK_HEADER_SIZE + payloadSize;
+    return true;
+}
+
+/**
+ * Load the next valid block for replay, corrupted blocks are skipped
+ */
+bool LogFile::loadNextBlock()
+{
+    qint64 nextOffset;
+
+    if (!m_blockIndex.isEmpty()) {
+        while (m_nextBlock < m_blockIndex.size()) {
+            const BlockInfo &info = m_blockIndex.at(m_nextBlock++);
+            if (readBlock(info.offset, &nextOffset)) {
+                return true;
+            }
+            qWarning() << "LogFile - skipping corrupted block at" << info.offset << "time"
+                       << info.firstTimeStamp << "-" << info.lastTimeStamp;
+        }
+        return false;
+    }
+
+    // No index, walk the blocks and resynchronize on the next block magic after a corrupted one
+    while (m_scanOffset >= 0 && m_scanOffset + BLOCK_HEADER_SIZE <= m_file.size()) {
+        if (readBlock(m_scanOffset, &nextOffset)) {
+            m_scanOffset = nextOffset;
+            return true;
+        }
+        qWarning() << "LogFile - skipping corrupted data at" << m_scanOffset;
+        m_scanOffset = findBlock(m_scanOffset + 1);
+    }
+    return false;
+}
+
+/**
+ * Offset of the next block magic from the given offset, -1 if none
+ */
+qint64 LogFile::findBlock(qint64 from)
+{
+    static const int CHUNK_SIZE = 64 * 1024;
+    QByteArray magic(BLOCK_MAGIC, 4);
+
+    while (m_file.seek(from)) {
+        QByteArray chunk = m_file.read(CHUNK_SIZE);
+        if (chunk.size() < magic.size()) {
+            break;
+        }
+        int found = chunk.indexOf(magic);
+        if (found >= 0) {
+            return from + found;
+        }
+        // The magic may straddle two chunks
+        from += chunk.size() - (magic.size() - 1);
+    }
+    return -1;
+}
+
+qint64 LogFile::replayBytesAvailable()
+{
+    if (!m_compressed) {
+        return m_file.bytesAvailable();
+    }
+    // Records do not span blocks, move on when the current one is used up
+    while (m_blockReader.bytesAvailable() == 0) {
+        if (!loadNextBlock()) {
+            return 0;
+        }
+    }
+    return m_blockReader.bytesAvailable();
+}
+
+qint64 LogFile::replayRead(char *data, qint64 maxlen)
+{
+    return m_compressed ? m_blockReader.read(data, maxlen) : m_file.read(data, maxlen);
+}
@@ -34,11 +34,36 @@
 #include <QDebug>
 #include <QBuffer>
 #include <QFile>
+#include <QVector>
 
+class LogFileCompressor;
+
+/**
+ * Telemetry log, records of [timestamp][size][UAVTalk frame].
+ *
+ * Files named *.oplz are written in the block compressed format: the records
+ * are grouped in blocks that are zlib compressed by a background thread, each
+ * with a CRC-32 and its time range, followed by an index of the blocks.
+ * A corrupted block is skipped on replay. Both formats are read transparently.
+ */
 class QTCREATOR_UTILS_EXPORT LogFile : public QIODevice {
     Q_OBJECT
 public:
+    typedef struct {
+        qint64  offset;
+        quint32 firstTimeStamp;
+        quint32 lastTimeStamp;
+        quint32 records;
+    } BlockInfo;
+
+    // Uncompressed size and time span after which a block is compressed
+    static const int BLOCK_SIZE = 256 * 1024;
+    static const quint32 BLOCK_DURATION_MS = 5000;
+    // Time after which a partial block is compressed anyway
+    static const int FLUSH_INTERVAL_MS = 1000;
+
     explicit LogFile(QObject *parent = 0);
+    ~LogFile();
 
     QString fileName() const
     {
@@ -53,6 +78,16 @@ public:
 
     bool isPlaying() const;
 
+    bool isCompressed() const
+    {
+        return m_compressed;
+    }
+    // Blocks of a compressed log opened for reading, empty if its index is missing
+    QVector<BlockInfo> blocks() const
+    {
+        return m_blockIndex;
+    }
+
     bool open(OpenMode mode);
     void close();
 
@@ -113,6 +148,21 @@ protected:
 private:
     bool m_useProvidedTimeStamp;
     qint32 m_providedTimeStamp;
+
+    // Block compressed format
+    bool m_compressed;
+    LogFileCompressor *m_compressor;
+    QVector<BlockInfo> m_blockIndex;
+    int m_nextBlock;
+    qint64 m_scanOffset;
+    QBuffer m_blockReader;
+
+    bool readIndex();
+    bool readBlock(qint64 offset, qint64 *nextOffset);
+    bool loadNextBlock();
+    qint64 findBlock(qint64 from);
+    qint64 replayBytesAvailable();
+    qint64 replayRead(char *data, qint64 maxlen);
 };
 
 #endif // LOGFILE_H
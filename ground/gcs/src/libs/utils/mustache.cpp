@@ -128,6 +128,16 @@ QVariant QtVariantContext::value(const QString & key) const
     if (key == "." && !m_contextStack.isEmpty()) {
         return m_contextStack.last();
     }
+    // Plain keys, the usual case, are looked up without splitting them
+    if (!key.contains(QLatin1Char('.'))) {
+        for (int i = m_contextStack.count() - 1; i >= 0; i--) {
+            QVariant value = variantMapValue(m_contextStack.at(i), key);
+            if (!value.isNull()) {
+                return value;
+            }
+        }
+        return QVariant();
+    }
     QStringList keyPath = key.split(".");
     for (int i = m_contextStack.count() - 1; i >= 0; i--) {
         QVariant value = variantMapValueForKeyPath(m_contextStack.at(i), keyPath);
@@ -140,8 +150,11 @@ QVariant QtVariantContext::value(const QString & key) const
 
 bool QtVariantContext::isFalse(const QString & key) const
 {
-    QVariant value = this->value(key);
+    return isFalse(value(key));
+}
 
+bool QtVariantContext::isFalse(const QVariant & value)
+{
     switch (value.userType()) {
     case QVariant::Bool:
         return !value.toBool();
@@ -162,10 +175,12 @@ bool QtVariantContext::isFalse(const QString & key) const
 
 QString QtVariantContext::stringValue(const QString & key) const
 {
-    if (isFalse(key)) {
+    QVariant value = this->value(key);
+
+    if (isFalse(value)) {
         return QString();
     }
-    return value(key).toString();
+    return value.toString();
 }
 
 void QtVariantContext::push(const QString & key, int index)
@@ -187,8 +202,10 @@ void QtVariantContext::pop()
 
 int QtVariantContext::listCount(const QString & key) const
 {
-    if (value(key).userType() == QVariant::List) {
-        return value(key).toList().count();
+    QVariant value = this->value(key);
+
+    if (value.userType() == QVariant::List) {
+        return value.toList().count();
     }
     return 0;
 }
@@ -338,28 +355,127 @@ QString Renderer::render(const QString & _template, int startPos, int endPos, Co
             lastTagEnd = tag.end;
             break;
         case Tag::Partial:
-        {
-            QString tagStartMarker = m_tagStartMarker;
-            QString tagEndMarker   = m_tagEndMarker;
+            output    += renderPartial(tag.key, context);
+            lastTagEnd = tag.end;
+            break;
+        case Tag::SetDelimiter:
+            lastTagEnd = tag.end;
+            break;
+        case Tag::Comment:
+            lastTagEnd = tag.end;
+            break;
+        case Tag::Null:
+            break;
+        }
+    }
 
-            m_tagStartMarker = m_defaultTagStartMarker;
-            m_tagEndMarker   = m_defaultTagEndMarker;
+    return output;
+}
 
-            m_partialStack.push(tag.key);
+QString Renderer::renderPartial(const QString & key, Context *context)
+{
+    QString tagStartMarker = m_tagStartMarker;
+    QString tagEndMarker   = m_tagEndMarker;
 
-            QString partial = context->partialValue(tag.key);
-            output    += render(partial, 0, partial.length(), context);
-            lastTagEnd = tag.end;
+    m_tagStartMarker = m_defaultTagStartMarker;
+    m_tagEndMarker   = m_defaultTagEndMarker;
+
+    m_partialStack.push(key);
+
+    QString partial = context->partialValue(key);
+    QString output  = render(partial, 0, partial.length(), context);
 
-            m_partialStack.pop();
+    m_partialStack.pop();
 
-            m_tagStartMarker = tagStartMarker;
-            m_tagEndMarker   = tagEndMarker;
+    m_tagStartMarker = tagStartMarker;
+    m_tagEndMarker   = tagEndMarker;
+
+    return output;
+}
+
+Template Renderer::compile(const QString & _template)
+{
+    Template compiled;
+
+    m_error.clear();
+    m_errorPos = -1;
+    m_errorPartial.clear();
+
+    m_tagStartMarker = m_defaultTagStartMarker;
+    m_tagEndMarker   = m_defaultTagEndMarker;
+
+    compile(_template, 0, _template.length(), &compiled.m_nodes);
+    return compiled;
+}
+
+/** Walks the template as render() does, but keeps the text and tags instead of
+ * rendering them, so the result of findTag() and findEndTag() is only computed once.
+ */
+void Renderer::compile(const QString & _template, int startPos, int endPos, QVector<Node> *nodes)
+{
+    int lastTagEnd = startPos;
+    Node text;
+
+    while (m_errorPos == -1) {
+        Tag tag = findTag(_template, lastTagEnd, endPos);
+        if (tag.type == Tag::Null) {
+            text.text = _template.mid(lastTagEnd, endPos - lastTagEnd);
+            if (!text.text.isEmpty()) {
+                nodes->append(text);
+            }
+            break;
+        }
+        text.text = _template.mid(lastTagEnd, tag.start - lastTagEnd);
+        if (!text.text.isEmpty()) {
+            nodes->append(text);
+        }
+        switch (tag.type) {
+        case Tag::Value:
+        {
+            Node node;
+            node.type       = Tag::Value;
+            node.key        = tag.key;
+            node.escapeMode = tag.escapeMode;
+            nodes->append(node);
+            lastTagEnd = tag.end;
         }
         break;
-        case Tag::SetDelimiter:
+        case Tag::SectionStart:
+        case Tag::InvertedSectionStart:
+        {
+            Tag endTag = findEndTag(_template, tag, endPos);
+            if (endTag.type == Tag::Null) {
+                if (m_errorPos == -1) {
+                    setError(tag.type == Tag::SectionStart ? "No matching end tag found for section" :
+                             "No matching end tag found for inverted section", tag.start);
+                }
+            } else {
+                Node node;
+                node.type = tag.type;
+                node.key  = tag.key;
+                if (tag.type == Tag::SectionStart) {
+                    node.text = _template.mid(tag.end, endTag.start - tag.end);
+                }
+                compile(_template, tag.end, endTag.start, &node.children);
+                nodes->append(node);
+                lastTagEnd = endTag.end;
+            }
+        }
+        break;
+        case Tag::SectionEnd:
+            setError("Unexpected end tag", tag.start);
             lastTagEnd = tag.end;
             break;
+        case Tag::Partial:
+        {
+            Node node;
+            node.type = Tag::Partial;
+            node.key  = tag.key;
+            nodes->append(node);
+            lastTagEnd = tag.end;
+        }
+        break;
+        case Tag::SetDelimiter:
         case Tag::Comment:
             lastTagEnd = tag.end;
             break;
@@ -367,10 +483,73 @@ QString Renderer::render(const QString & _template, int startPos, int endPos, Co
             break;
         }
     }
+}
+
+QString Renderer::render(const Template & compiled, Context *context)
+{
+    QString output;
+
+    m_error.clear();
+    m_errorPos = -1;
+    m_errorPartial.clear();
 
+    m_tagStartMarker = m_defaultTagStartMarker;
+    m_tagEndMarker   = m_defaultTagEndMarker;
+
+    render(compiled.m_nodes, context, &output);
     return output;
 }
 
+void Renderer::render(const QVector<Node> & nodes, Context *context, QString *output)
+{
+    foreach(const Node &node, nodes) {
+        switch (node.type) {
+        case Tag::Null:
+            *output += node.text;
+            break;
+        case Tag::Value:
+        {
+            QString value = context->stringValue(node.key);
+            if (node.escapeMode == Tag::Escape) {
+                value = escapeHtml(value);
+            } else if (node.escapeMode == Tag::Unescape) {
+                value = unescapeHtml(value);
+            }
+            *output += value;
+        }
+        break;
+        case Tag::SectionStart:
+        {
+            int listCount = context->listCount(node.key);
+            if (listCount > 0) {
+                for (int i = 0; i < listCount; i++) {
+                    context->push(node.key, i);
+                    render(node.children, context, output);
+                    context->pop();
+                }
+            } else if (context->canEval(node.key)) {
+                *output += context->eval(node.key, node.text, this);
+            } else if (!context->isFalse(node.key)) {
+                context->push(node.key);
+                render(node.children, context, output);
+                context->pop();
+            }
+        }
+        break;
+        case Tag::InvertedSectionStart:
+            if (context->isFalse(node.key)) {
+                render(node.children, context, output);
+            }
+            break;
+        case Tag::Partial:
+            *output += renderPartial(node.key, context);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 void Renderer::setError(const QString & error, int pos)
 {
     Q_ASSERT(!error.isEmpty());
@@ -17,6 +17,7 @@
 #include <QtCore/QStack>
 #include <QtCore/QString>
 #include <QtCore/QVariant>
+#include <QtCore/QVector>
 
 #include "utils_global.h"
 
@@ -118,6 +119,7 @@ public:
 
 private:
     QVariant value(const QString & key) const;
+    static bool isFalse(const QVariant & value);
 
     QStack<QVariant> m_contextStack;
 };
@@ -192,6 +194,39 @@ struct Tag {
     EscapeMode escapeMode;
 };
 
+/** A piece of a compiled template: literal text, or a tag with the
+ * pieces of its section.
+ */
+struct Node {
+    Node()
+        : type(Tag::Null)
+        , escapeMode(Tag::Escape)
+    {}
+
+    Tag::Type       type; /// Null for literal text
+    QString         text; /// The literal text, or the unrendered section for Context::eval()
+    QString         key;
+    Tag::EscapeMode escapeMode;
+    QVector<Node>   children;
+};
+
+/** A template parsed once by Renderer::compile(). Rendering it does not
+ * scan the template text again, partials are still fetched from the context.
+ */
+class QTCREATOR_UTILS_EXPORT Template {
+public:
+    Template() {}
+
+    bool isEmpty() const
+    {
+        return m_nodes.isEmpty();
+    }
+
+private:
+    friend class Renderer;
+    QVector<Node> m_nodes;
+};
+
 /** Renders Mustache templates, replacing mustache tags with
  * values from a provided context.
  */
@@ -204,6 +239,17 @@ public:
      */
     QString render(const QString & _template, Context *context);
 
+    /** Parse @p _template into a Template which can be rendered any number of times.
+     * Parse errors are reported by error() as for render(), the compiled template then
+     * holds what was parsed before the error.
+     */
+    Template compile(const QString & _template);
+
+    /** Render a template returned by compile(), the result is the same as
+     * rendering the template text.
+     */
+    QString render(const Template & compiled, Context *context);
+
     /** Returns a message describing the last error encountered by the previous
      * render() call.
      */
@@ -229,6 +275,9 @@ public:
 
 private:
     QString render(const QString & _template, int startPos, int endPos, Context *context);
+    void compile(const QString & _template, int startPos, int endPos, QVector<Node> *nodes);
+    void render(const QVector<Node> & nodes, Context *context, QString *output);
+    QString renderPartial(const QString & key, Context *context);
 
     Tag findTag(const QString & content, int pos, int endPos);
     Tag findEndTag(const QString & content, const Tag & startTag, int endPos);
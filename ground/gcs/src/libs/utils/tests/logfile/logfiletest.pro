@@ -0,0 +1,28 @@
+#
+# Round trip, corruption and throughput of the plain and block compressed log formats
+# The benchmark prints the compression ratio and the write/replay MB/s
+#
+
+include(../../../../../gcs.pri)
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = logfiletest
+
+QT = core testlib
+
+DEFINES += QTCREATOR_UTILS_STATIC_LIB
+
+UTILS_DIR = $$GCS_SOURCE_TREE/src/libs/utils
+
+INCLUDEPATH += $$UTILS_DIR
+
+HEADERS += \
+    $$UTILS_DIR/logfile.h \
+    $$UTILS_DIR/crc.h
+
+SOURCES += \
+    tst_logfile.cpp \
+    $$UTILS_DIR/logfile.cpp \
+    $$UTILS_DIR/crc.cpp
@@ -0,0 +1,279 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_logfile.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Plain and block compressed log round trip, corruption and throughput
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logfile.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QtEndian>
+#include <QtCore/QThread>
+
+#include <math.h>
+
+class tst_LogFile : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void roundTrip_data();
+    void roundTrip();
+    void corruptedBlock_data();
+    void corruptedBlock();
+    void flushesPartialBlock();
+    void benchmark();
+
+private:
+    // Size of an attitude-like UAVTalk frame
+    static const int RECORD_SIZE = 48;
+
+    QTemporaryDir m_dir;
+
+    static QByteArray record(int index);
+    void writeLog(const QString &fileName, int count, quint32 timeStep);
+    void replay(const QString &fileName, QByteArray *data);
+};
+
+/**
+ * Index followed by slowly varying floats, compresses roughly like telemetry
+ */
+QByteArray tst_LogFile::record(int index)
+{
+    QByteArray data(RECORD_SIZE, 0);
+    uchar *p = (uchar *)data.data();
+
+    qToLittleEndian<quint32>(index, p);
+    for (int i = 4; i + 4 <= RECORD_SIZE; i += 4) {
+        float value = sin(index * 0.01 + i) * 100.0;
+        memcpy(p + i, &value, sizeof(value));
+    }
+    return data;
+}
+
+void tst_LogFile::writeLog(const QString &fileName, int count, quint32 timeStep)
+{
+    LogFile log;
+
+    log.setFileName(fileName);
+    QVERIFY(log.open(QIODevice::WriteOnly));
+    log.useProvidedTimeStamp(true);
+    for (int i = 0; i < count; ++i) {
+        log.setNextTimeStamp(i * timeStep);
+        log.write(record(i));
+    }
+    log.close();
+}
+
+void tst_LogFile::replay(const QString &fileName, QByteArray *data)
+{
+    LogFile log;
+
+    log.setFileName(fileName);
+    QVERIFY(log.open(QIODevice::ReadOnly));
+    connect(&log, &QIODevice::readyRead, [&log, data]() {
+        data->append(log.readAll());
+    });
+    QSignalSpy finished(&log, SIGNAL(replayFinished()));
+    log.setReplaySpeed(1e6);
+    QVERIFY(log.startReplay());
+    QVERIFY(finished.wait(60000));
+    log.close();
+}
+
+void tst_LogFile::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+void tst_LogFile::roundTrip_data()
+{
+    QTest::addColumn<QString>("extension");
+
+    QTest::newRow("plain") << "opl";
+    QTest::newRow("compressed") << "oplz";
+}
+
+void tst_LogFile::roundTrip()
+{
+    QFETCH(QString, extension);
+
+    const int count  = 20000;
+    QString fileName = m_dir.filePath("roundtrip." + extension);
+
+    writeLog(fileName, count, 10);
+
+    QByteArray expected;
+    for (int i = 0; i < count; ++i) {
+        expected += record(i);
+    }
+    QByteArray data;
+    replay(fileName, &data);
+    QCOMPARE(data.size(), expected.size());
+    QVERIFY(data == expected);
+
+    LogFile log;
+    log.setFileName(fileName);
+    QVERIFY(log.open(QIODevice::ReadOnly));
+    QCOMPARE(log.isCompressed(), extension == "oplz");
+    if (log.isCompressed()) {
+        // 10 ms apart, a block every BLOCK_DURATION_MS
+        QVector<LogFile::BlockInfo> blocks = log.blocks();
+        QVERIFY(blocks.size() > 1);
+        quint32 records = 0;
+        quint32 lastTimeStamp = 0;
+        foreach(const LogFile::BlockInfo &block, blocks) {
+            QVERIFY(block.firstTimeStamp >= lastTimeStamp);
+            QVERIFY(block.lastTimeStamp >= block.firstTimeStamp);
+            lastTimeStamp = block.lastTimeStamp;
+            records += block.records;
+        }
+        QCOMPARE(records, quint32(count));
+    }
+    log.close();
+}
+
+void tst_LogFile::corruptedBlock_data()
+{
+    QTest::addColumn<bool>("withIndex");
+
+    QTest::newRow("indexed") << true;
+    QTest::newRow("scanned") << false;
+}
+
+void tst_LogFile::corruptedBlock()
+{
+    QFETCH(bool, withIndex);
+
+    const int count  = 5000;
+    QString fileName = m_dir.filePath(QString("corrupted%1.oplz").arg(withIndex));
+
+    writeLog(fileName, count, 10);
+
+    QVector<LogFile::BlockInfo> blocks;
+    {
+        LogFile log;
+        log.setFileName(fileName);
+        QVERIFY(log.open(QIODevice::ReadOnly));
+        blocks = log.blocks();
+        log.close();
+    }
+    QVERIFY(blocks.size() > 3);
+
+    // Damage the payload of the second block
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(blocks[1].offset + 40));
+    char byte;
+    QVERIFY(file.getChar(&byte));
+    QVERIFY(file.seek(blocks[1].offset + 40));
+    QVERIFY(file.putChar(~byte));
+    if (!withIndex) {
+        // Lose the trailer, as if the writer crashed
+        QVERIFY(file.resize(file.size() - 1));
+    }
+    file.close();
+
+    QByteArray data;
+    replay(fileName, &data);
+
+    // Everything but the second block is replayed, in order
+    int skipped = blocks[1].records;
+    QCOMPARE(data.size(), (count - skipped) * RECORD_SIZE);
+    for (int i = 0; i < count - skipped; ++i) {
+        int index = i < (int)blocks[0].records ? i : i + skipped;
+        QVERIFY(data.mid(i * RECORD_SIZE, RECORD_SIZE) == record(index));
+    }
+}
+
+void tst_LogFile::flushesPartialBlock()
+{
+    const int count  = 3;
+    QString fileName = m_dir.filePath("partial.oplz");
+    LogFile log;
+
+    log.setFileName(fileName);
+    QVERIFY(log.open(QIODevice::WriteOnly));
+    log.useProvidedTimeStamp(true);
+    QByteArray expected;
+    for (int i = 0; i < count; ++i) {
+        log.setNextTimeStamp(i * 10);
+        log.write(record(i));
+        expected += record(i);
+    }
+
+    // Far from full, the block is written once it is old enough
+    QThread::msleep(LogFile::FLUSH_INTERVAL_MS / 2);
+    QCOMPARE(QFileInfo(fileName).size(), (qint64)8);
+    QTRY_VERIFY_WITH_TIMEOUT(QFileInfo(fileName).size() > 8, LogFile::FLUSH_INTERVAL_MS * 5);
+
+    // and replayed from a log that is still open, found by scanning
+    QByteArray data;
+    replay(fileName, &data);
+    QVERIFY(data == expected);
+
+    log.close();
+    data.clear();
+    replay(fileName, &data);
+    QVERIFY(data == expected);
+}
+
+void tst_LogFile::benchmark()
+{
+    const int count = 500000;
+    QByteArray expected;
+
+    for (int i = 0; i < count; ++i) {
+        expected += record(i);
+    }
+    double megabytes = expected.size() / (1024.0 * 1024.0);
+
+    qint64 plainSize = 0;
+    foreach(QString extension, QStringList() << "opl" << "oplz") {
+        QString fileName = m_dir.filePath("benchmark." + extension);
+        QElapsedTimer timer;
+
+        timer.start();
+        writeLog(fileName, count, 1);
+        double writeSeconds = timer.nsecsElapsed() / 1e9;
+
+        QByteArray data;
+        timer.start();
+        replay(fileName, &data);
+        double readSeconds = timer.nsecsElapsed() / 1e9;
+        QVERIFY(data == expected);
+
+        qint64 size = QFileInfo(fileName).size();
+        if (extension == "opl") {
+            plainSize = size;
+        }
+        qDebug("%-5s %10lld bytes, ratio %5.2f, write %7.1f MB/s, replay %7.1f MB/s",
+               qPrintable(extension), size, (double)plainSize / size,
+               megabytes / writeSeconds, megabytes / readSeconds);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_LogFile)
+
+#include "tst_logfile.moc"
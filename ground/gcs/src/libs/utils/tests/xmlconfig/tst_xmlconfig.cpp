@@ -0,0 +1,313 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_xmlconfig.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      XML settings format round trip, compatibility, cache and throughput
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "xmlconfig.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QBuffer>
+#include <QtCore/QRect>
+#include <QtXml/QDomDocument>
+
+class tst_XmlConfig : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void roundTrip();
+    void domCompatibility();
+    void cache();
+    void benchmark();
+
+private:
+    QTemporaryDir m_dir;
+
+    static QSettings::SettingsMap largeConfiguration(int gadgets);
+    static QByteArray toXml(const QSettings::SettingsMap &map);
+    static QSettings::SettingsMap fromXml(const QByteArray &data);
+    static void writeFile(const QString &fileName, const QSettings::SettingsMap &map);
+    static QSettings::SettingsMap readFile(const QString &fileName);
+};
+
+/**
+ * Settings shaped like the GCS ones, a group per gadget configuration
+ */
+QSettings::SettingsMap tst_XmlConfig::largeConfiguration(int gadgets)
+{
+    QSettings::SettingsMap map;
+
+    for (int i = 0; i < gadgets; ++i) {
+        QString group = QString("Plugins/UAVGadgetManager/Gadget%1/configInfo %2/data").arg(i % 50).arg(i);
+        map.insert(group + "/version", "1.2.0");
+        map.insert(group + "/locked", i % 2 == 0);
+        map.insert(group + "/name", QString("Gadget configuration %1").arg(i));
+        map.insert(group + "/rate", i * 10);
+        map.insert(group + "/scale", i * 0.125);
+        map.insert(group + "/geometry", QRect(i, i + 1, 640, 480));
+        map.insert(group + "/state", QByteArray(64, char(i)));
+        for (int j = 0; j < 4; ++j) {
+            map.insert(QString("%1/curves/%2/color").arg(group).arg(j), QString("#%1").arg(i * 4 + j, 6, 16, QChar('0')));
+        }
+    }
+    return map;
+}
+
+QByteArray tst_XmlConfig::toXml(const QSettings::SettingsMap &map)
+{
+    QBuffer buffer;
+
+    buffer.open(QIODevice::WriteOnly);
+    XmlConfig::writeXmlFile(buffer, map);
+    return buffer.data();
+}
+
+QSettings::SettingsMap tst_XmlConfig::fromXml(const QByteArray &data)
+{
+    QSettings::SettingsMap map;
+    QBuffer buffer;
+
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    XmlConfig::readXmlFile(buffer, map);
+    return map;
+}
+
+void tst_XmlConfig::writeFile(const QString &fileName, const QSettings::SettingsMap &map)
+{
+    QFile file(fileName);
+
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(XmlConfig::writeXmlFile(file, map));
+}
+
+QSettings::SettingsMap tst_XmlConfig::readFile(const QString &fileName)
+{
+    QSettings::SettingsMap map;
+    QFile file(fileName);
+
+    if (file.open(QIODevice::ReadOnly)) {
+        XmlConfig::readXmlFile(file, map);
+    }
+    return map;
+}
+
+void tst_XmlConfig::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    XmlConfig::setCacheDirectory(QString());
+}
+
+void tst_XmlConfig::roundTrip()
+{
+    QSettings::SettingsMap map;
+
+    map.insert("General/Language", "en");
+    map.insert("General/OverrideLanguage", false);
+    map.insert("General/Count", 42);
+    map.insert("General/Escaped", "<a href=\"x\">&amp;</a>");
+    map.insert("General/AtSign", "@home");
+    map.insert("Some group/key with spaces%", "value");
+    map.insert("Array/size", 2);
+    map.insert("Array/1/Name", "first");
+    map.insert("Array/2/Name", "second");
+    map.insert("Window/Geometry", QRect(10, 20, 300, 400));
+    map.insert("Window/State", QByteArray("\x00\x01\xff", 3));
+    map.insert("Window/Multiline", "line 1\nline 2");
+
+    QSettings::SettingsMap read = fromXml(toXml(map));
+
+    QCOMPARE(read.size(), map.size());
+    QCOMPARE(read.value("General/Language").toString(), QString("en"));
+    QCOMPARE(read.value("General/OverrideLanguage").toBool(), false);
+    QCOMPARE(read.value("General/Count").toInt(), 42);
+    QCOMPARE(read.value("General/Escaped").toString(), map.value("General/Escaped").toString());
+    QCOMPARE(read.value("General/AtSign").toString(), QString("@home"));
+    QCOMPARE(read.value("Some group/key with spaces%").toString(), QString("value"));
+    QCOMPARE(read.value("Array/size").toInt(), 2);
+    QCOMPARE(read.value("Array/1/Name").toString(), QString("first"));
+    QCOMPARE(read.value("Array/2/Name").toString(), QString("second"));
+    QCOMPARE(read.value("Window/Geometry").toRect(), QRect(10, 20, 300, 400));
+    QCOMPARE(read.value("Window/State").toByteArray(), QByteArray("\x00\x01\xff", 3));
+    QCOMPARE(read.value("Window/Multiline").toString(), QString("line 1\nline 2"));
+}
+
+/**
+ * Files written by the former QDomDocument based writer still load
+ */
+void tst_XmlConfig::domCompatibility()
+{
+    QByteArray data(
+        "<gcs>\n"
+        "  <General>\n"
+        "    <Language>en</Language>\n"
+        "    <Geometry>@Rect(1 2 3 4)</Geometry>\n"
+        "  </General>\n"
+        "  <Array>\n"
+        "    <arr_1>\n"
+        "      <Name>first</Name>\n"
+        "    </arr_1>\n"
+        "    <size>1</size>\n"
+        "  </Array>\n"
+        "  <Some__PCT__20group>\n"
+        "    <Key>a &amp; b</Key>\n"
+        "    <Empty></Empty>\n"
+        "  </Some__PCT__20group>\n"
+        "</gcs>\n");
+
+    QSettings::SettingsMap read = fromXml(data);
+
+    QCOMPARE(read.size(), 5);
+    QCOMPARE(read.value("General/Language").toString(), QString("en"));
+    QCOMPARE(read.value("General/Geometry").toRect(), QRect(1, 2, 3, 4));
+    QCOMPARE(read.value("Array/1/Name").toString(), QString("first"));
+    QCOMPARE(read.value("Array/size").toString(), QString("1"));
+    QCOMPARE(read.value("Some group/Key").toString(), QString("a & b"));
+    QVERIFY(!read.contains("Some group/Empty"));
+
+    // The DOM parser accepts what is written now
+    QDomDocument document;
+    QVERIFY(document.setContent(toXml(read), true));
+    QCOMPARE(document.documentElement().tagName(), QString("gcs"));
+}
+
+void tst_XmlConfig::cache()
+{
+    QString fileName  = m_dir.filePath("cached.xml");
+    QString cachePath = m_dir.filePath("cache");
+
+    XmlConfig::setCacheDirectory(cachePath);
+
+    QSettings::SettingsMap map;
+    map.insert("General/Language", "en");
+    map.insert("General/Count", 42);
+    writeFile(fileName, map);
+
+    // Written along with the file
+    QStringList caches = QDir(cachePath).entryList(QDir::Files);
+    QCOMPARE(caches.size(), 1);
+    QString cacheName = QDir(cachePath).filePath(caches.first());
+
+    QSettings::SettingsMap read = readFile(fileName);
+    QCOMPARE(read.value("General/Language").toString(), QString("en"));
+    QCOMPARE(read.value("General/Count").toString(), QString("42"));
+
+    // Prove a hit by altering the cached map, keeping its header
+    {
+        QFile file(cacheName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_6);
+        quint32 magic;
+        quint32 version;
+        QByteArray hash;
+        QSettings::SettingsMap cached;
+        stream >> magic >> version >> hash >> cached;
+        QCOMPARE(stream.status(), QDataStream::Ok);
+        QCOMPARE(cached.value("General/Count").toString(), QString("42"));
+        cached.insert("General/Count", "cached");
+        file.resize(0);
+        file.seek(0);
+        stream << magic << version << hash << cached;
+    }
+    QCOMPARE(readFile(fileName).value("General/Count").toString(), QString("cached"));
+
+    // An edited file invalidates the cache
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QByteArray data = file.readAll();
+        data.replace("<Count>42</Count>", "<Count>43</Count>");
+        file.resize(0);
+        file.seek(0);
+        file.write(data);
+    }
+    QCOMPARE(readFile(fileName).value("General/Count").toString(), QString("43"));
+
+    // A corrupted cache is ignored
+    {
+        QFile file(cacheName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.resize(file.size() / 2));
+    }
+    QSettings::SettingsMap fallback = readFile(fileName);
+    QCOMPARE(fallback.value("General/Language").toString(), QString("en"));
+    QCOMPARE(fallback.value("General/Count").toString(), QString("43"));
+
+    // What the writer caches is what parsing the file gives
+    QSettings::SettingsMap large = largeConfiguration(100);
+    writeFile(fileName, large);
+    QSettings::SettingsMap cached = readFile(fileName);
+    XmlConfig::setCacheDirectory(QString());
+    QSettings::SettingsMap parsed = readFile(fileName);
+    QCOMPARE(cached.keys(), parsed.keys());
+    foreach(const QString &key, parsed.keys()) {
+        QCOMPARE(cached.value(key), parsed.value(key));
+    }
+}
+
+void tst_XmlConfig::benchmark()
+{
+    QString fileName  = m_dir.filePath("benchmark.xml");
+    QString cachePath = m_dir.filePath("benchmark");
+
+    QSettings::SettingsMap map = largeConfiguration(5600);
+    QElapsedTimer timer;
+
+    XmlConfig::setCacheDirectory(QString());
+    timer.start();
+    QByteArray data  = toXml(map);
+    double writeMs   = timer.nsecsElapsed() / 1e6;
+    double megabytes = data.size() / (1024.0 * 1024.0);
+    QVERIFY(megabytes > 4.0);
+
+    timer.start();
+    QDomDocument document;
+    QVERIFY(document.setContent(data, true));
+    double domMs = timer.nsecsElapsed() / 1e6;
+
+    timer.start();
+    QSettings::SettingsMap parsed = fromXml(data);
+    double parseMs = timer.nsecsElapsed() / 1e6;
+    QCOMPARE(parsed.size(), map.size());
+
+    XmlConfig::setCacheDirectory(cachePath);
+    writeFile(fileName, map);
+    timer.start();
+    QSettings::SettingsMap cached = readFile(fileName);
+    double cachedMs = timer.nsecsElapsed() / 1e6;
+    QCOMPARE(cached.size(), map.size());
+    XmlConfig::setCacheDirectory(QString());
+
+    qDebug("%.1f MB, %d keys", megabytes, map.size());
+    qDebug("write          %8.1f ms", writeMs);
+    qDebug("DOM parse only %8.1f ms", domMs);
+    qDebug("stream read    %8.1f ms", parseMs);
+    qDebug("cached read    %8.1f ms", cachedMs);
+}
+
+QTEST_GUILESS_MAIN(tst_XmlConfig)
+
+#include "tst_xmlconfig.moc"
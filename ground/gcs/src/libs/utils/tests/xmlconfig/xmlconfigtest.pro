@@ -0,0 +1,26 @@
+#
+# Round trip, former DOM format compatibility and hash validated cache of the XML settings format
+# The benchmark prints the parse, cached load and write times of a 5 MB configuration
+#
+
+include(../../../../../gcs.pri)
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = xmlconfigtest
+
+QT = core xml testlib
+
+DEFINES += QTCREATOR_UTILS_STATIC_LIB
+
+UTILS_DIR = $$GCS_SOURCE_TREE/src/libs/utils
+
+INCLUDEPATH += $$UTILS_DIR
+
+HEADERS += \
+    $$UTILS_DIR/xmlconfig.h
+
+SOURCES += \
+    tst_xmlconfig.cpp \
+    $$UTILS_DIR/xmlconfig.cpp
@@ -39,121 +39,328 @@
 #include <QSize>
 #include <QPoint>
 #include <QtCore/QUrl>
-
-#define NUM_PREFIX "arr_"
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDir>
+#include <QtCore/QHash>
+
+#define NUM_PREFIX    "arr_"
+#define CACHE_MAGIC   0x58434643
+#define CACHE_VERSION 1
 
 QString XmlConfig::rootName = "gcs";
+QString XmlConfig::cacheDir;
 
 const QSettings::Format XmlConfig::XmlSettingsFormat =
     QSettings::registerFormat("xml", XmlConfig::readXmlFile, XmlConfig::writeXmlFile);
 
 
+/**
+ * Element of the document built by writeXmlFile(), one per key path component
+ */
+struct XmlConfig::Node {
+    QString name;
+    QString text;
+    QList<Node *> children;
+    QHash<QString, Node *> index;
+
+    ~Node()
+    {
+        qDeleteAll(children);
+    }
+};
+
+void XmlConfig::setCacheDirectory(const QString &path)
+{
+    cacheDir = path;
+}
+
+QString XmlConfig::cacheDirectory()
+{
+    return cacheDir;
+}
+
+/**
+ * Read a settings file. With a cache directory set, the map is loaded from
+ * the binary copy of the file if the hash of the file content still matches.
+ */
 bool XmlConfig::readXmlFile(QIODevice &device, QSettings::SettingsMap &map)
 {
-    QDomDocument domDoc;
-    QDomElement root;
-    QString errorStr;
-    int errorLine;
-    int errorColumn;
-
-    if (!domDoc.setContent(&device, true, &errorStr, &errorLine,
-                           &errorColumn)) {
+    QByteArray data   = device.readAll();
+    QString cacheName = cacheFileName(device);
+    QByteArray hash;
+
+    if (!cacheName.isEmpty()) {
+        hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+        if (readCache(cacheName, hash, map)) {
+            return true;
+        }
+    }
+    if (!parseXml(data, map)) {
+        return false;
+    }
+    if (!cacheName.isEmpty()) {
+        writeCache(cacheName, hash, map);
+    }
+    return true;
+}
+
+/**
+ * Single pass over the document, an element with text is a key whose path
+ * is given by the enclosing elements. As with the former DOM reader the value
+ * is the whole text of the element and whitespace only text is ignored.
+ */
+bool XmlConfig::parseXml(const QByteArray &data, QSettings::SettingsMap &map)
+{
+    struct Element {
+        QString path;
+        QString text;
+        bool    hasText;
+    };
+
+    QXmlStreamReader xml(data);
+    QVector<Element> stack;
+
+    while (!xml.atEnd()) {
+        switch (xml.readNext()) {
+        case QXmlStreamReader::StartElement:
+        {
+            Element element;
+            QString name    = decodeName(xml.qualifiedName().toString());
+            element.path    = stack.isEmpty() ? QString() : stack.last().path;
+            element.hasText = false;
+            if (name != XmlConfig::rootName) {
+                element.path = element.path.isEmpty() ? name : element.path + '/' + name;
+            }
+            stack.append(element);
+            break;
+        }
+        case QXmlStreamReader::Characters:
+            if (!stack.isEmpty() && !xml.isWhitespace()) {
+                stack.last().text   += xml.text();
+                stack.last().hasText = true;
+            }
+            break;
+
+        case QXmlStreamReader::EndElement:
+        {
+            Element element = stack.takeLast();
+            if (element.hasText) {
+                map.insert(element.path, stringToVariant(element.text));
+            }
+            if (!stack.isEmpty()) {
+                stack.last().text += element.text;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    if (xml.hasError()) {
         QString err = QString(tr("GCS config")) +
                       tr("Parse error at line %1, column %2:\n%3")
-                      .arg(errorLine)
-                      .arg(errorColumn)
-                      .arg(errorStr);
+                      .arg(xml.lineNumber())
+                      .arg(xml.columnNumber())
+                      .arg(xml.errorString());
         qFatal("%s", err.toLatin1().data());
         return false;
     }
-    root = domDoc.documentElement();
-    handleNode(&root, map);
+    return true;
+}
 
+bool XmlConfig::writeXmlFile(QIODevice &device, const QSettings::SettingsMap &map)
+{
+    Node root;
+
+    root.name = XmlConfig::rootName;
+    QMapIterator<QString, QVariant> iter(map);
+    while (iter.hasNext()) {
+        iter.next();
+        Node *node = &root;
+        foreach(QString elem, iter.key().split('/', QString::SkipEmptyParts)) {
+            elem = encodeName(elem, iter.key());
+            Node *child = node->index.value(elem);
+            if (!child) {
+                child       = new Node;
+                child->name = elem;
+                node->children.append(child);
+                node->index.insert(elem, child);
+            }
+            node = child;
+        }
+        node->text += variantToString(iter.value());
+    }
+
+    QByteArray data;
+    {
+        QXmlStreamWriter xml(&data);
+        xml.setAutoFormatting(true);
+        xml.setAutoFormattingIndent(2);
+        writeNode(xml, &root);
+        xml.writeEndDocument();
+    }
+    if (device.write(data) != data.size()) {
+        return false;
+    }
+
+    // Cache what reading the file back will give, so that the next read is instant too
+    QString cacheName = cacheFileName(device);
+    if (!cacheName.isEmpty()) {
+        QSettings::SettingsMap written;
+        cacheNode(&root, written, QString());
+        writeCache(cacheName, QCryptographicHash::hash(data, QCryptographicHash::Sha1), written);
+    }
     return true;
 }
 
-void XmlConfig::handleNode(QDomElement *node, QSettings::SettingsMap &map, QString path)
+void XmlConfig::writeNode(QXmlStreamWriter &xml, const Node *node)
 {
-    if (!node) {
-        return;
+    xml.writeStartElement(node->name);
+    if (!node->text.isNull()) {
+        xml.writeCharacters(node->text);
+    }
+    foreach(const Node * child, node->children) {
+        writeNode(xml, child);
+    }
+    xml.writeEndElement();
+}
+
+/**
+ * Fill the map the way parseXml() would from the written document
+ * @returns the whole text of the element
+ */
+QString XmlConfig::cacheNode(const Node *node, QSettings::SettingsMap &map, QString path)
+{
+    QString name = decodeName(node->name);
+
+    if (name != XmlConfig::rootName) {
+        path = path.isEmpty() ? name : path + '/' + name;
+    }
+    bool hasText = !isBlank(node->text);
+    QString text = hasText ? node->text : QString();
+    foreach(const Node * child, node->children) {
+        text += cacheNode(child, map, path);
+    }
+    if (hasText) {
+        map.insert(path, stringToVariant(text));
     }
-    // qDebug() << "XmlConfig::handleNode start";
+    return text;
+}
 
-    QString nodeName = node->nodeName();
+QString XmlConfig::encodeName(const QString &name, const QString &key)
+{
+    // Xml tags are restrictive with allowed characters,
+    // so we urlencode and replace % with __PCT__ on file
+    QString elem = QString(QUrl::toPercentEncoding(name));
+
+    elem = elem.replace("%", "__PCT__");
     // For arrays, QT will use simple numbers as keys, which is not a valid element in XML.
     // Therefore we prefixed these.
+    if (elem.startsWith(NUM_PREFIX)) {
+        qWarning() << "ERROR: Settings must not start with " << NUM_PREFIX
+                   << " in: " + key;
+    }
+    if (QRegExp("[0-9]").exactMatch(elem.left(1))) {
+        elem.prepend(NUM_PREFIX);
+    }
+    return elem;
+}
+
+QString XmlConfig::decodeName(const QString &name)
+{
+    QString nodeName = name;
+
     if (nodeName.startsWith(NUM_PREFIX)) {
         nodeName.replace(NUM_PREFIX, "");
     }
-    // Xml tags are restrictive with allowed characters,
-    // so we urlencode and replace % with __PCT__ on file
     nodeName = nodeName.replace("__PCT__", "%");
-    nodeName = QUrl::fromPercentEncoding(nodeName.toLatin1());
-
-    if (nodeName == XmlConfig::rootName) {
-        ;
-    } else if (path == "") {
-        path = nodeName;
-    } else {
-        path += "/" + nodeName;
-    }
-
-// qDebug() << "Node: " << ": " << path << " Children: " << node->childNodes().length();
-    for (int i = 0; i < node->childNodes().length(); ++i) {
-        QDomNode child = node->childNodes().item(i);
-        if (child.isElement()) {
-            handleNode(static_cast<QDomElement *>(&child), map, path);
-        } else if (child.isText()) {
-// qDebug() << "Key: " << path << " Value:" << node->text();
-            map.insert(path, stringToVariant(node->text()));
-        } else {
-            qDebug() << "Child not Element or text!" << child.nodeType();
+    return QUrl::fromPercentEncoding(nodeName.toLatin1());
+}
+
+/**
+ * Whitespace only text, skipped by parseXml() as it was by the DOM parser
+ */
+bool XmlConfig::isBlank(const QString &text)
+{
+    for (int i = 0; i < text.size(); ++i) {
+        ushort c = text.at(i).unicode();
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return false;
         }
     }
-// qDebug() << "XmlConfig::handleNode end";
+    return true;
 }
 
-bool XmlConfig::writeXmlFile(QIODevice &device, const QSettings::SettingsMap &map)
+/**
+ * Cache files are named after the settings file path, only files are cached
+ */
+QString XmlConfig::cacheFileName(QIODevice &device)
 {
-    QDomDocument outDocument;
+    QFileDevice *file = qobject_cast<QFileDevice *>(&device);
 
-// qDebug() << "writeXmlFile start";
-    outDocument.appendChild(outDocument.createElement(XmlConfig::rootName));
-    QMapIterator<QString, QVariant> iter(map);
-    while (iter.hasNext()) {
-        iter.next();
-// qDebug() << "Entry: " << iter.key() << ": " << iter.value().toString() << endl;
-        QDomNode node = outDocument.firstChild();
-        foreach(QString elem, iter.key().split('/')) {
-            if (elem == "") {
-                continue;
-            }
-            // Xml tags are restrictive with allowed characters,
-            // so we urlencode and replace % with __PCT__ on file
-            elem = QString(QUrl::toPercentEncoding(elem));
-            elem = elem.replace("%", "__PCT__");
-            // For arrays, QT will use simple numbers as keys, which is not a valid element in XML.
-            // Therefore we prefixed these.
-            if (elem.startsWith(NUM_PREFIX)) {
-                qWarning() << "ERROR: Settings must not start with " << NUM_PREFIX
-                           << " in: " + iter.key();
-            }
-            if (QRegExp("[0-9]").exactMatch(elem.left(1))) {
-                elem.prepend(NUM_PREFIX);
-            }
-            if (node.firstChildElement(elem).isNull()) {
-                node.appendChild(outDocument.createElement(elem));
-            }
-            node = node.firstChildElement(elem);
-        }
-        node.appendChild(outDocument.createTextNode(variantToString(iter.value())));
+    if (cacheDir.isEmpty() || !file || file->fileName().isEmpty()) {
+        return QString();
     }
-    device.write(outDocument.toByteArray(2).constData());
-// qDebug() << "Dokument:\n" << outDocument.toByteArray(2).constData();
-// qDebug() << "writeXmlFile end";
+    QByteArray id = QCryptographicHash::hash(QFileInfo(file->fileName()).absoluteFilePath().toUtf8(),
+                                             QCryptographicHash::Md5).toHex();
+    return QDir(cacheDir).filePath(QString::fromLatin1(id) + ".cache");
+}
+
+bool XmlConfig::readCache(const QString &fileName, const QByteArray &hash, QSettings::SettingsMap &map)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic;
+    quint32 version;
+    QByteArray fileHash;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION) {
+        return false;
+    }
+    stream >> fileHash;
+    if (fileHash != hash) {
+        return false;
+    }
+    QSettings::SettingsMap cached;
+    stream >> cached;
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "XmlConfig - corrupted cache" << fileName;
+        return false;
+    }
+    map.swap(cached);
     return true;
 }
 
+void XmlConfig::writeCache(const QString &fileName, const QByteArray &hash, const QSettings::SettingsMap &map)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "XmlConfig - could not write cache" << fileName;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << quint32(CACHE_MAGIC) << quint32(CACHE_VERSION) << hash << map;
+    // Values of types without stream operators make the cache unusable
+    if (stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+    }
+    file.commit();
+}
+
 
 QSettings::SettingsMap XmlConfig::settingsToMap(QSettings & qs)
 {
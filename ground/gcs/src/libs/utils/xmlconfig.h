@@ -28,16 +28,19 @@
 
 #if defined(QTCREATOR_UTILS_LIB)
 #  define XMLCONFIG_EXPORT Q_DECL_EXPORT
+#elif  defined(QTCREATOR_UTILS_STATIC_LIB)
+#  define XMLCONFIG_EXPORT
 #else
 #  define XMLCONFIG_EXPORT Q_DECL_IMPORT
 #endif
 
 #include <QtCore/qglobal.h>
 #include <QSettings>
-#include <QDomElement>
 #include <QObject>
 #include <QDataStream>
 
+class QXmlStreamWriter;
+
 class XMLCONFIG_EXPORT XmlConfig : QObject {
     Q_OBJECT
 public:
@@ -46,10 +49,25 @@ public:
     static bool readXmlFile(QIODevice &device, QSettings::SettingsMap &map);
     static bool writeXmlFile(QIODevice &device, const QSettings::SettingsMap &map);
 
+    // Binary copies of the parsed files are kept there, empty disables the cache
+    static void setCacheDirectory(const QString &path);
+    static QString cacheDirectory();
+
 private:
+    struct Node;
+
     static QString rootName;
+    static QString cacheDir;
 
-    static void handleNode(QDomElement *node, QSettings::SettingsMap &map, QString path = "");
+    static bool parseXml(const QByteArray &data, QSettings::SettingsMap &map);
+    static void writeNode(QXmlStreamWriter &xml, const Node *node);
+    static QString cacheNode(const Node *node, QSettings::SettingsMap &map, QString path);
+    static QString encodeName(const QString &name, const QString &key);
+    static QString decodeName(const QString &name);
+    static bool isBlank(const QString &text);
+    static QString cacheFileName(QIODevice &device);
+    static bool readCache(const QString &fileName, const QByteArray &hash, QSettings::SettingsMap &map);
+    static void writeCache(const QString &fileName, const QByteArray &hash, const QSettings::SettingsMap &map);
     static QSettings::SettingsMap settingsToMap(QSettings & qs);
     static QString variantToString(const QVariant &v);
     static QVariant stringToVariant(const QString &s);
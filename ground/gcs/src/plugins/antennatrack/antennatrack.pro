@@ -14,6 +14,7 @@ HEADERS += \
     telemetryparser.h \
     antennatrackgadget.h \
     antennatrackwidget.h \
+    trackingengine.h \
     antennatrackgadgetfactory.h \
     antennatrackgadgetconfiguration.h \
     antennatrackgadgetoptionspage.h
@@ -25,6 +26,7 @@ SOURCES += \
     antennatrackgadget.cpp \
     antennatrackgadgetfactory.cpp \
     antennatrackwidget.cpp \
+    trackingengine.cpp \
     antennatrackgadgetconfiguration.cpp \
     antennatrackgadgetoptionspage.cpp
 
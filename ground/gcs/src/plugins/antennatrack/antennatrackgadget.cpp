@@ -89,11 +89,13 @@ void AntennaTrackGadget::loadConfiguration(IUAVGadgetConfiguration *config)
         }
     }
     m_widget->dataStreamGroupBox->setHidden(false);
+    m_widget->setTrackingConfiguration(AntennaTrackConfig);
 
     parser = new TelemetryParser();
 
     connect(parser, SIGNAL(position(double, double, double)), m_widget, SLOT(setPosition(double, double, double)));
     connect(parser, SIGNAL(home(double, double, double)), m_widget, SLOT(setHomePosition(double, double, double)));
+    connect(parser, SIGNAL(velocity(double, double, double)), m_widget, SLOT(setVelocity(double, double, double)));
     connect(parser, SIGNAL(packet(QString)), m_widget, SLOT(dumpPacket(QString)));
 }
 
@@ -41,7 +41,13 @@ AntennaTrackGadgetConfiguration::AntennaTrackGadgetConfiguration(QString classId
     m_defaultFlow(QSerialPort::UnknownFlowControl),
     m_defaultParity(QSerialPort::UnknownParity),
     m_defaultStopBits(QSerialPort::UnknownStopBits),
-    m_defaultTimeOut(5000)
+    m_defaultTimeOut(5000),
+    m_trackingRate(50),
+    m_telemetryLatency(150),
+    m_actuationLatency(50),
+    m_azimuthSlewRate(180),
+    m_elevationSlewRate(90),
+    m_prediction(true)
 {
     // if a saved configuration exists load it
     if (qSettings != 0) {
@@ -71,6 +77,13 @@ AntennaTrackGadgetConfiguration::AntennaTrackGadgetConfiguration(QString classId
         m_defaultParity   = parity;
         m_defaultStopBits = stopbits;
         m_connectionMode  = conMode;
+
+        m_trackingRate      = qSettings->value("trackingRate", m_trackingRate).toInt();
+        m_telemetryLatency  = qSettings->value("telemetryLatency", m_telemetryLatency).toInt();
+        m_actuationLatency  = qSettings->value("actuationLatency", m_actuationLatency).toInt();
+        m_azimuthSlewRate   = qSettings->value("azimuthSlewRate", m_azimuthSlewRate).toDouble();
+        m_elevationSlewRate = qSettings->value("elevationSlewRate", m_elevationSlewRate).toDouble();
+        m_prediction        = qSettings->value("prediction", m_prediction).toBool();
     }
 }
 
@@ -89,6 +102,13 @@ IUAVGadgetConfiguration *AntennaTrackGadgetConfiguration::clone()
     m->m_defaultStopBits = m_defaultStopBits;
     m->m_defaultPort     = m_defaultPort;
     m->m_connectionMode  = m_connectionMode;
+
+    m->m_trackingRate      = m_trackingRate;
+    m->m_telemetryLatency  = m_telemetryLatency;
+    m->m_actuationLatency  = m_actuationLatency;
+    m->m_azimuthSlewRate   = m_azimuthSlewRate;
+    m->m_elevationSlewRate = m_elevationSlewRate;
+    m->m_prediction        = m_prediction;
     return m;
 }
 
@@ -105,4 +125,10 @@ void AntennaTrackGadgetConfiguration::saveConfig(QSettings *settings) const
     settings->setValue("defaultStopBits", m_defaultStopBits);
     settings->setValue("defaultPort", m_defaultPort);
     settings->setValue("connectionMode", m_connectionMode);
+    settings->setValue("trackingRate", m_trackingRate);
+    settings->setValue("telemetryLatency", m_telemetryLatency);
+    settings->setValue("actuationLatency", m_actuationLatency);
+    settings->setValue("azimuthSlewRate", m_azimuthSlewRate);
+    settings->setValue("elevationSlewRate", m_elevationSlewRate);
+    settings->setValue("prediction", m_prediction);
 }
@@ -120,6 +120,57 @@ public:
         return m_defaultTimeOut;
     }
 
+    // tracking configuration
+    void setTrackingRate(int hz)
+    {
+        m_trackingRate = hz;
+    }
+    void setTelemetryLatency(int ms)
+    {
+        m_telemetryLatency = ms;
+    }
+    void setActuationLatency(int ms)
+    {
+        m_actuationLatency = ms;
+    }
+    void setAzimuthSlewRate(double rate)
+    {
+        m_azimuthSlewRate = rate;
+    }
+    void setElevationSlewRate(double rate)
+    {
+        m_elevationSlewRate = rate;
+    }
+    void setPrediction(bool enabled)
+    {
+        m_prediction = enabled;
+    }
+
+    int trackingRate()
+    {
+        return m_trackingRate;
+    }
+    int telemetryLatency()
+    {
+        return m_telemetryLatency;
+    }
+    int actuationLatency()
+    {
+        return m_actuationLatency;
+    }
+    double azimuthSlewRate()
+    {
+        return m_azimuthSlewRate;
+    }
+    double elevationSlewRate()
+    {
+        return m_elevationSlewRate;
+    }
+    bool prediction()
+    {
+        return m_prediction;
+    }
+
     void saveConfig(QSettings *settings) const;
     IUAVGadgetConfiguration *clone();
 
@@ -132,6 +183,12 @@ private:
     QSerialPort::Parity m_defaultParity;
     QSerialPort::StopBits m_defaultStopBits;
     long m_defaultTimeOut;
+    int m_trackingRate;
+    int m_telemetryLatency;
+    int m_actuationLatency;
+    double m_azimuthSlewRate;
+    double m_elevationSlewRate;
+    bool m_prediction;
 };
 
 #endif // ANTENNATRACKGADGETCONFIGURATION_H
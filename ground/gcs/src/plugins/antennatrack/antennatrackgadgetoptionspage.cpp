@@ -132,6 +132,14 @@ QWidget *AntennaTrackGadgetOptionsPage::createPage(QWidget *parent)
     // TIMEOUT
     options_page->timeoutSpinBox->setValue(m_config->timeOut());
 
+    // TRACKING
+    options_page->trackingRateSpinBox->setValue(m_config->trackingRate());
+    options_page->telemetryLatencySpinBox->setValue(m_config->telemetryLatency());
+    options_page->actuationLatencySpinBox->setValue(m_config->actuationLatency());
+    options_page->azimuthSlewRateSpinBox->setValue(m_config->azimuthSlewRate());
+    options_page->elevationSlewRateSpinBox->setValue(m_config->elevationSlewRate());
+    options_page->predictionCheckBox->setChecked(m_config->prediction());
+
     QStringList connectionModes;
     connectionModes << "Serial";
     options_page->connectionMode->addItems(connectionModes);
@@ -164,6 +172,12 @@ void AntennaTrackGadgetOptionsPage::apply()
     m_config->setParity((QSerialPort::Parity)options_page->parityComboBox->itemData(options_page->parityComboBox->currentIndex()).toInt());
     m_config->setTimeOut(options_page->timeoutSpinBox->value());
     m_config->setConnectionMode(options_page->connectionMode->currentText());
+    m_config->setTrackingRate(options_page->trackingRateSpinBox->value());
+    m_config->setTelemetryLatency(options_page->telemetryLatencySpinBox->value());
+    m_config->setActuationLatency(options_page->actuationLatencySpinBox->value());
+    m_config->setAzimuthSlewRate(options_page->azimuthSlewRateSpinBox->value());
+    m_config->setElevationSlewRate(options_page->elevationSlewRateSpinBox->value());
+    m_config->setPrediction(options_page->predictionCheckBox->isChecked());
 }
 
 void AntennaTrackGadgetOptionsPage::finish()
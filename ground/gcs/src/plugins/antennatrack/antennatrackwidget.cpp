@@ -41,8 +41,12 @@ AntennaTrackWidget::AntennaTrackWidget(QWidget *parent) : QWidget(parent)
 {
     setupUi(this);
 
-    azimuth_old   = 0;
-    elevation_old = 0;
+    stepper_position = 0;
+    servo_old        = -1;
+
+    engine = new TrackingEngine(this);
+    connect(engine, &TrackingEngine::pointingChanged, this, &AntennaTrackWidget::setAntennaPosition);
+    engine->start();
 }
 
 AntennaTrackWidget::~AntennaTrackWidget()
@@ -52,6 +56,15 @@ void AntennaTrackWidget::setPort(QPointer<QSerialPort> portx)
     port = portx;
 }
 
+void AntennaTrackWidget::setTrackingConfiguration(AntennaTrackGadgetConfiguration *config)
+{
+    engine->setTrackingRate(config->trackingRate());
+    engine->setTelemetryLatency(config->telemetryLatency());
+    engine->setActuationLatency(config->actuationLatency());
+    engine->setSlewRates(config->azimuthSlewRate(), config->elevationSlewRate());
+    engine->setPrediction(config->prediction());
+}
+
 void AntennaTrackWidget::dumpPacket(const QString &packet)
 {
     textBrowser->append(packet);
@@ -95,7 +108,7 @@ void AntennaTrackWidget::setPosition(double lat, double lon, double alt)
     TrackData.Latitude  = lat;
     TrackData.Longitude = lon;
     TrackData.Altitude  = alt;
-    calcAntennaPosition();
+    engine->setPosition(lat, lon, alt);
 }
 
 void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
@@ -129,65 +142,22 @@ void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
     TrackData.HomeLatitude  = lat;
     TrackData.HomeLongitude = lon;
     TrackData.HomeAltitude  = alt;
-    calcAntennaPosition();
+    engine->setHome(lat, lon, alt);
 }
 
-void AntennaTrackWidget::calcAntennaPosition(void)
+void AntennaTrackWidget::setVelocity(double north, double east, double down)
 {
-    /** http://www.movable-type.co.uk/scripts/latlong.html **/
-    double lat1, lat2, lon1, lon2, a, c, d, x, y, brng;
-    double azimuth, elevation;
-    double gcsAlt = TrackData.HomeAltitude; // Home MSL altitude
-    double uavAlt = TrackData.Altitude; // UAV MSL altitude
-    double dAlt   = uavAlt - gcsAlt; // Altitude difference
-
-    // Convert to radians
-    lat1 = TrackData.HomeLatitude * (M_PI / 180); // Home lat
-    lon1 = TrackData.HomeLongitude * (M_PI / 180); // Home lon
-    lat2 = TrackData.Latitude * (M_PI / 180); // UAV lat
-    lon2 = TrackData.Longitude * (M_PI / 180); // UAV lon
-
-    // Bearing
-    /**
-       var y = Math.sin(dLon) * Math.cos(lat2);
-       var x = Math.cos(lat1)*Math.sin(lat2) -
-            Math.sin(lat1)*Math.cos(lat2)*Math.cos(dLon);
-       var brng = Math.atan2(y, x).toDeg();
-     **/
-    y    = sin(lon2 - lon1) * cos(lat2);
-    x    = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(lon2 - lon1);
-    brng = atan2((sin(lon2 - lon1) * cos(lat2)), (cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(lon2 - lon1))) * (180 / M_PI);
-    if (brng < 0) {
-        brng += 360;
-    }
-
-    // bearing to stepper
-    azimuth = brng;
-
-    // Haversine formula for distance
-    /**
-       var R = 6371; // km
-       var dLat = (lat2-lat1).toRad();
-       var dLon = (lon2-lon1).toRad();
-       var a = Math.sin(dLat/2) * Math.sin(dLat/2) +
-            Math.cos(lat1.toRad()) * Math.cos(lat2.toRad()) *
-            Math.sin(dLon/2) * Math.sin(dLon/2);
-       var c = 2 * Math.atan2(Math.sqrt(a), Math.sqrt(1-a));
-       var d = R * c;
-     **/
-    a = sin((lat2 - lat1) / 2) * sin((lat2 - lat1) / 2) +
-        cos(lat1) * cos(lat2) *
-        sin((lon2 - lon1) / 2) * sin((lon2 - lon1) / 2);
-    c = 2 * atan2(sqrt(a), sqrt(1 - a));
-    d = 6371 * 1000 * c;
+    engine->setVelocity(north, east, down);
+}
 
+/**
+ * Called by the tracking engine at the tracking rate, azimuth from north and
+ * elevation above the horizon where the vehicle will be once the tracker moved
+ */
+void AntennaTrackWidget::setAntennaPosition(double azimuth, double elevation)
+{
     // Elevation  v depends servo direction
-    if (d != 0) {
-        elevation = 90 - (atan(dAlt / d) * (180 / M_PI));
-    } else {
-        elevation = 0;
-    }
-    // ! TODO: sanity check
+    elevation = 90 - elevation;
 
     QString str3;
     str3.sprintf("%.0f deg", azimuth);
@@ -197,16 +167,23 @@ void AntennaTrackWidget::calcAntennaPosition(void)
     elevation_value->setText(str3);
 
     // servo value 2000-4000
-    int servo   = (int)(2000.0 / 180 * elevation + 2000);
-    int stepper = (int)(400.0 / 360 * (azimuth - azimuth_old));
+    int servo = (int)(2000.0 / 180 * elevation + 2000);
+
+    // The stepper moves relative, keep track of its absolute position so the small
+    // moves at the tracking rate do not get lost in rounding, and turn the short way
+    int target  = qRound(400.0 / 360 * azimuth) % 400;
+    int stepper = target - stepper_position;
+    if (stepper > 200) {
+        stepper -= 400;
+    } else if (stepper < -200) {
+        stepper += 400;
+    }
 
     // send azimuth and elevation to tracker hardware
-    str3.sprintf("move %d 2000 2000 2000 %d\r", stepper, servo);
-    if (port->isOpen()) {
-        if (azimuth_old != azimuth || elevation != elevation_old) {
-            port->write(str3.toLatin1());
-        }
+    if (port && port->isOpen() && (stepper != 0 || servo != servo_old)) {
+        str3.sprintf("move %d 2000 2000 2000 %d\r", stepper, servo);
+        port->write(str3.toLatin1());
+        stepper_position = target;
+        servo_old        = servo;
     }
-    azimuth_old   = azimuth;
-    elevation_old = elevation;
 }
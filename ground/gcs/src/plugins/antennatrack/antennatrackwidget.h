@@ -30,6 +30,7 @@
 
 #include "ui_antennatrackwidget.h"
 #include "antennatrackgadgetconfiguration.h"
+#include "trackingengine.h"
 #include "uavobject.h"
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
@@ -56,17 +57,21 @@ public:
     ~AntennaTrackWidget();
     TrackData_t TrackData;
     void setPort(QPointer<QSerialPort> portx);
+    void setTrackingConfiguration(AntennaTrackGadgetConfiguration *config);
 
 private slots:
     void setPosition(double, double, double);
     void setHomePosition(double, double, double);
+    void setVelocity(double, double, double);
+    void setAntennaPosition(double azimuth, double elevation);
     void dumpPacket(const QString &packet);
 
 private:
-    void calcAntennaPosition(void);
     QGraphicsSvgItem *marker;
     QPointer<QSerialPort> port;
-    double azimuth_old;
-    double elevation_old;
+    TrackingEngine *engine;
+    // Where the tracker hardware was last sent, stepper 0..399 from north
+    int stepper_position;
+    int servo_old;
 };
 #endif /* ANTENNATRACKWIDGET_H_ */
@@ -53,6 +53,18 @@ TelemetryParser::TelemetryParser(QObject *parent) : GPSParser(parent)
     } else {
         qDebug() << "Error: Object is unknown (HomeLocation).";
     }
+
+    // Both are NED velocities for the antenna prediction, the latest one is used
+    QStringList velocityObjects;
+    velocityObjects << "VelocityState" << "GPSVelocitySensor";
+    foreach(QString name, velocityObjects) {
+        gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject(name));
+        if (gpsObj != NULL) {
+            connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateVelocity(UAVObject *)));
+        } else {
+            qDebug() << "Error: Object is unknown (" << name << ").";
+        }
+    }
 }
 
 TelemetryParser::~TelemetryParser()
@@ -80,3 +92,12 @@ void TelemetryParser::updateGPS(UAVObject *object1)
     lon *= 1E-7;
     emit position(lat, lon, alt);
 }
+
+void TelemetryParser::updateVelocity(UAVObject *object1)
+{
+    double north = object1->getField(QString("North"))->getDouble();
+    double east  = object1->getField(QString("East"))->getDouble();
+    double down  = object1->getField(QString("Down"))->getDouble();
+
+    emit velocity(north, east, down);
+}
@@ -0,0 +1,23 @@
+#
+# Antenna tracking engine: slew limits, and the pointing error on replayed
+# flights with and without latency compensation, printed by the test
+#
+
+include(../../../../gcs.pri)
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = trackingtest
+
+QT = core testlib
+
+TRACK_DIR = $$GCS_SOURCE_TREE/src/plugins/antennatrack
+
+INCLUDEPATH += $$TRACK_DIR
+
+HEADERS += $$TRACK_DIR/trackingengine.h
+
+SOURCES += \
+    tst_tracking.cpp \
+    $$TRACK_DIR/trackingengine.cpp
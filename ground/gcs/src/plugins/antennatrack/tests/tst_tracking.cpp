@@ -0,0 +1,285 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_tracking.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Antenna tracking pointing error on replayed flights
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "trackingengine.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QVector>
+#include <algorithm>
+#include <math.h>
+
+class tst_Tracking : public QObject {
+    Q_OBJECT
+
+private slots:
+    void slewLimits();
+    void azimuthWraps();
+    void velocityFromPositions();
+    void lowPass();
+    void orbit();
+
+private:
+    static const int GPS_PERIOD_MS     = 200;
+    static const int TELEMETRY_LATENCY = 150;
+    static const int TELEMETRY_JITTER  = 40;
+    static const int ACTUATION_LATENCY = 50;
+    static const int TRACKING_RATE     = 50;
+
+    struct Track {
+        double north, east, down;
+        double vNorth, vEast, vDown;
+    };
+
+    struct Stats {
+        double mean;
+        double p95;
+        double max;
+    };
+
+    typedef Track (*Trajectory)(double t);
+
+    static Track lowPassAt(double t);
+    static Track orbitAt(double t);
+    static Stats replay(Trajectory trajectory, int durationMs, bool prediction);
+    static void check(const char *name, Trajectory trajectory, int durationMs);
+};
+
+static const double HOME_LAT = 47.0;
+static const double HOME_LON = 8.0;
+static const double HOME_ALT = 400.0;
+static const double METERS_PER_DEG = 6378137.0 * M_PI / 180.0;
+
+static void toLLA(const double ned[3], double *lat, double *lon, double *alt)
+{
+    *lat = HOME_LAT + ned[0] / METERS_PER_DEG;
+    *lon = HOME_LON + ned[1] / (METERS_PER_DEG * cos(HOME_LAT * M_PI / 180.0));
+    *alt = HOME_ALT - ned[2];
+}
+
+// Angle between the antenna axis and the direction of the vehicle
+static double pointingError(const TrackingEngine::Pointing &p, double north, double east, double down)
+{
+    double az1 = p.azimuth * M_PI / 180.0;
+    double el1 = p.elevation * M_PI / 180.0;
+    double az2 = atan2(east, north);
+    double el2 = atan2(-down, sqrt(north * north + east * east));
+    double dot = cos(el1) * cos(az1) * cos(el2) * cos(az2)
+                 + cos(el1) * sin(az1) * cos(el2) * sin(az2)
+                 + sin(el1) * sin(el2);
+
+    return acos(qBound(-1.0, dot, 1.0)) * 180.0 / M_PI;
+}
+
+/**
+ * Fast pass 40 m beside the tracker, 30 m/s and 30 m above it
+ */
+tst_Tracking::Track tst_Tracking::lowPassAt(double t)
+{
+    Track track = { -600 + 30 * t, 40, -30, 30, 0, 0 };
+
+    return track;
+}
+
+/**
+ * Orbit of 80 m radius at 25 m/s, 150 m east of the tracker
+ */
+tst_Tracking::Track tst_Tracking::orbitAt(double t)
+{
+    double w    = 25.0 / 80.0;
+    Track track = { 80 * cos(w * t), 150 + 80 * sin(w * t), -60,
+                    -80 * w * sin(w * t), 80 * w * cos(w * t), 0 };
+
+    return track;
+}
+
+/**
+ * Replays GPS positions and velocities sampled at 5 Hz and delivered late by the
+ * telemetry, steps the engine at the tracking rate and measures the pointing error
+ * against the true position at actuation time.
+ */
+tst_Tracking::Stats tst_Tracking::replay(Trajectory trajectory, int durationMs, bool prediction)
+{
+    TrackingEngine engine;
+
+    engine.setTelemetryLatency(TELEMETRY_LATENCY);
+    engine.setActuationLatency(ACTUATION_LATENCY);
+    engine.setSlewRates(180, 90);
+    engine.setPrediction(prediction);
+    engine.setHomeAt(HOME_LAT, HOME_LON, HOME_ALT);
+
+    // Same jitter for both runs
+    qsrand(1);
+    QVector<qint64> receivedMs;
+    QVector<Track> samples;
+    for (int ms = 0; ms < durationMs; ms += GPS_PERIOD_MS) {
+        receivedMs.append(ms + TELEMETRY_LATENCY + qrand() % (TELEMETRY_JITTER + 1));
+        samples.append(trajectory(ms / 1000.0));
+    }
+
+    QVector<double> errors;
+    int next = 0;
+    for (int now = 0; now < durationMs; now += 1000 / TRACKING_RATE) {
+        while (next < samples.size() && receivedMs.at(next) <= now) {
+            const Track &s = samples.at(next);
+            double ned[3]  = { s.north, s.east, s.down };
+            double lat, lon, alt;
+            toLLA(ned, &lat, &lon, &alt);
+            engine.setPositionAt(receivedMs.at(next), lat, lon, alt);
+            engine.setVelocityAt(receivedMs.at(next), s.vNorth, s.vEast, s.vDown);
+            ++next;
+        }
+        if (!engine.isValid()) {
+            continue;
+        }
+
+        TrackingEngine::Pointing command = engine.stepAt(now);
+        // Let the first fixes and the initial slew settle
+        if (now < 1000) {
+            continue;
+        }
+        Track truth = trajectory((now + ACTUATION_LATENCY) / 1000.0);
+        errors.append(pointingError(command, truth.north, truth.east, truth.down));
+    }
+
+    std::sort(errors.begin(), errors.end());
+    double sum = 0;
+    foreach(double e, errors) {
+        sum += e;
+    }
+    Stats stats;
+    stats.mean = sum / errors.size();
+    stats.p95  = errors.at(errors.size() * 95 / 100);
+    stats.max  = errors.last();
+    return stats;
+}
+
+void tst_Tracking::check(const char *name, Trajectory trajectory, int durationMs)
+{
+    Stats naive     = replay(trajectory, durationMs, false);
+    Stats predicted = replay(trajectory, durationMs, true);
+
+    qDebug() << name << "pointing error, latest position: mean" << naive.mean << "p95" << naive.p95 << "max" << naive.max << "deg";
+    qDebug() << name << "pointing error, predicted: mean" << predicted.mean << "p95" << predicted.p95 << "max" << predicted.max << "deg";
+
+    QVERIFY(predicted.mean < 0.5);
+    QVERIFY(predicted.p95 < 1.5);
+    QVERIFY(predicted.mean * 4 < naive.mean);
+    QVERIFY(predicted.max < naive.max);
+}
+
+void tst_Tracking::slewLimits()
+{
+    TrackingEngine engine;
+
+    engine.setTelemetryLatency(0);
+    engine.setActuationLatency(0);
+    engine.setSlewRates(100, 50);
+    engine.setHomeAt(HOME_LAT, HOME_LON, HOME_ALT);
+
+    double lat, lon, alt;
+    double north[3] = { 100, 0, 0 };
+    toLLA(north, &lat, &lon, &alt);
+    engine.setPositionAt(0, lat, lon, alt);
+    TrackingEngine::Pointing p = engine.stepAt(0);
+    QVERIFY(qAbs(p.azimuth) < 0.01);
+    QVERIFY(qAbs(p.elevation) < 0.01);
+
+    // Jumps to east and 45 degrees up, 20 ms steps move 2 and 1 degrees
+    double east[3] = { 0, 100, -100 };
+    toLLA(east, &lat, &lon, &alt);
+    engine.setPositionAt(0, lat, lon, alt);
+    p = engine.stepAt(20);
+    QVERIFY(qAbs(p.azimuth - 2) < 1e-6);
+    QVERIFY(qAbs(p.elevation - 1) < 1e-6);
+    for (int ms = 40; ms <= 1000; ms += 20) {
+        p = engine.stepAt(ms);
+    }
+    QVERIFY(qAbs(p.azimuth - 90) < 0.1);
+    QVERIFY(qAbs(p.elevation - 45) < 0.1);
+}
+
+void tst_Tracking::azimuthWraps()
+{
+    TrackingEngine engine;
+
+    engine.setTelemetryLatency(0);
+    engine.setActuationLatency(0);
+    engine.setSlewRates(100, 0);
+    engine.setHomeAt(HOME_LAT, HOME_LON, HOME_ALT);
+
+    double lat, lon, alt;
+    double west[3] = { 100, -2, 0 };
+    toLLA(west, &lat, &lon, &alt);
+    engine.setPositionAt(0, lat, lon, alt);
+    TrackingEngine::Pointing p = engine.stepAt(0);
+    QVERIFY(p.azimuth > 358 && p.azimuth < 359);
+
+    // Through north, not around
+    double east[3] = { 100, 2, 0 };
+    toLLA(east, &lat, &lon, &alt);
+    engine.setPositionAt(0, lat, lon, alt);
+    p = engine.stepAt(100);
+    QVERIFY(p.azimuth > 1 && p.azimuth < 2);
+}
+
+void tst_Tracking::velocityFromPositions()
+{
+    TrackingEngine engine;
+
+    engine.setTelemetryLatency(0);
+    engine.setActuationLatency(0);
+    engine.setSlewRates(0, 0);
+    engine.setHomeAt(HOME_LAT, HOME_LON, HOME_ALT);
+
+    // No velocity object, 10 m/s east from two fixes
+    double lat, lon, alt;
+    double p0[3] = { 100, 0, 0 };
+    double p1[3] = { 100, 10, 0 };
+    toLLA(p0, &lat, &lon, &alt);
+    engine.setPositionAt(0, lat, lon, alt);
+    toLLA(p1, &lat, &lon, &alt);
+    engine.setPositionAt(1000, lat, lon, alt);
+
+    TrackingEngine::Pointing p = engine.targetAt(2000);
+    QVERIFY(qAbs(p.azimuth - atan2(20.0, 100.0) * 180.0 / M_PI) < 0.01);
+
+    engine.setPrediction(false);
+    p = engine.targetAt(2000);
+    QVERIFY(qAbs(p.azimuth - atan2(10.0, 100.0) * 180.0 / M_PI) < 0.01);
+}
+
+void tst_Tracking::lowPass()
+{
+    check("low pass", &tst_Tracking::lowPassAt, 40000);
+}
+
+void tst_Tracking::orbit()
+{
+    check("orbit", &tst_Tracking::orbitAt, 60000);
+}
+
+QTEST_GUILESS_MAIN(tst_Tracking)
+
+#include "tst_tracking.moc"
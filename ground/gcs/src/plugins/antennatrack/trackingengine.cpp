@@ -0,0 +1,269 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trackingengine.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup AntennaTrackGadgetPlugin Antenna Track Gadget Plugin
+ * @{
+ * @brief Latency compensated antenna pointing at a fixed rate
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "trackingengine.h"
+
+#include <QTimer>
+#include <math.h>
+
+#define EARTH_RADIUS 6378137.0
+#define RAD2DEG      (180.0 / M_PI)
+#define DEG2RAD      (M_PI / 180.0)
+
+static double wrap360(double angle)
+{
+    angle = fmod(angle, 360.0);
+    return angle < 0 ? angle + 360.0 : angle;
+}
+
+// Shortest way from one angle to another, -180..180
+static double wrap180(double angle)
+{
+    angle = wrap360(angle);
+    return angle > 180.0 ? angle - 360.0 : angle;
+}
+
+static double limit(double delta, double rate, double dt)
+{
+    if (rate <= 0) {
+        return delta;
+    }
+    return qBound(-rate * dt, delta, rate * dt);
+}
+
+TrackingEngine::TrackingEngine(QObject *parent) : QObject(parent),
+    m_timer(new QTimer(this)),
+    m_trackingRate(50),
+    m_telemetryLatency(150),
+    m_actuationLatency(50),
+    m_azimuthRate(180),
+    m_elevationRate(90),
+    m_prediction(true),
+    m_homeSet(false),
+    m_homeLat(0),
+    m_homeLon(0),
+    m_homeAlt(0),
+    m_metersPerDegLat(EARTH_RADIUS * DEG2RAD),
+    m_metersPerDegLon(EARTH_RADIUS * DEG2RAD),
+    m_positionCount(0),
+    m_velocitySet(false),
+    m_lastStepMs(0),
+    m_commandSet(false)
+{
+    m_command.azimuth   = 0;
+    m_command.elevation = 0;
+    m_command.distance  = 0;
+
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &TrackingEngine::tick);
+    m_clock.start();
+}
+
+TrackingEngine::~TrackingEngine()
+{}
+
+void TrackingEngine::setTrackingRate(int hz)
+{
+    m_trackingRate = qBound(1, hz, 1000);
+    if (m_timer->isActive()) {
+        m_timer->start(1000 / m_trackingRate);
+    }
+}
+
+void TrackingEngine::setTelemetryLatency(int ms)
+{
+    m_telemetryLatency = qMax(0, ms);
+}
+
+void TrackingEngine::setActuationLatency(int ms)
+{
+    m_actuationLatency = qMax(0, ms);
+}
+
+void TrackingEngine::setSlewRates(double azimuthRate, double elevationRate)
+{
+    m_azimuthRate   = azimuthRate;
+    m_elevationRate = elevationRate;
+}
+
+void TrackingEngine::setPrediction(bool enabled)
+{
+    m_prediction = enabled;
+}
+
+void TrackingEngine::start()
+{
+    m_timer->start(1000 / m_trackingRate);
+}
+
+void TrackingEngine::stop()
+{
+    m_timer->stop();
+}
+
+void TrackingEngine::setHome(double lat, double lon, double alt)
+{
+    setHomeAt(lat, lon, alt);
+}
+
+void TrackingEngine::setPosition(double lat, double lon, double alt)
+{
+    setPositionAt(m_clock.elapsed(), lat, lon, alt);
+}
+
+void TrackingEngine::setVelocity(double north, double east, double down)
+{
+    setVelocityAt(m_clock.elapsed(), north, east, down);
+}
+
+void TrackingEngine::setHomeAt(double lat, double lon, double alt)
+{
+    m_homeSet         = true;
+    m_homeLat         = lat;
+    m_homeLon         = lon;
+    m_homeAlt         = alt;
+    m_metersPerDegLon = EARTH_RADIUS * DEG2RAD * cos(lat * DEG2RAD);
+}
+
+void TrackingEngine::setPositionAt(qint64 receivedMs, double lat, double lon, double alt)
+{
+    if (m_positionCount > 0) {
+        m_positions[0] = m_positions[1];
+    }
+    Fix &fix = m_positions[1];
+
+    // When it was sampled, not when it arrived
+    fix.ms  = receivedMs - m_telemetryLatency;
+    fix.lat = lat;
+    fix.lon = lon;
+    fix.alt = alt;
+
+    m_positionCount = qMin(m_positionCount + 1, 2);
+    if (m_positionCount == 1) {
+        m_positions[0] = fix;
+    }
+}
+
+void TrackingEngine::setVelocityAt(qint64 receivedMs, double north, double east, double down)
+{
+    m_velocity.ms    = receivedMs - m_telemetryLatency;
+    m_velocity.north = north;
+    m_velocity.east  = east;
+    m_velocity.down  = down;
+    m_velocitySet    = true;
+}
+
+TrackingEngine::Sample TrackingEngine::toNED(const Fix &fix) const
+{
+    Sample sample;
+
+    // Flat earth around home, well below a degree of error at tracking ranges
+    sample.ms    = fix.ms;
+    sample.north = (fix.lat - m_homeLat) * m_metersPerDegLat;
+    sample.east  = wrap180(fix.lon - m_homeLon) * m_metersPerDegLon;
+    sample.down  = m_homeAlt - fix.alt;
+    return sample;
+}
+
+TrackingEngine::Sample TrackingEngine::velocityAt(qint64 ms) const
+{
+    Sample velocity;
+
+    if (m_velocitySet && ms - m_velocity.ms <= VELOCITY_TIMEOUT_MS) {
+        return m_velocity;
+    }
+
+    velocity.ms    = ms;
+    velocity.north = 0;
+    velocity.east  = 0;
+    velocity.down  = 0;
+    if (m_positionCount == 2) {
+        Sample p0 = toNED(m_positions[0]);
+        Sample p1 = toNED(m_positions[1]);
+        qint64 dt = p1.ms - p0.ms;
+        if (dt > 0 && dt <= VELOCITY_TIMEOUT_MS && ms - p1.ms <= VELOCITY_TIMEOUT_MS) {
+            velocity.north = (p1.north - p0.north) * 1000.0 / dt;
+            velocity.east  = (p1.east - p0.east) * 1000.0 / dt;
+            velocity.down  = (p1.down - p0.down) * 1000.0 / dt;
+        }
+    }
+    return velocity;
+}
+
+TrackingEngine::Pointing TrackingEngine::targetAt(qint64 ms) const
+{
+    Pointing target = m_command;
+
+    if (!isValid()) {
+        return target;
+    }
+
+    Sample position = toNED(m_positions[1]);
+    if (m_prediction) {
+        Sample velocity = velocityAt(ms);
+        double dt = qBound<qint64>(0, ms - position.ms, MAX_EXTRAPOLATION_MS) / 1000.0;
+        position.north += velocity.north * dt;
+        position.east  += velocity.east * dt;
+        position.down  += velocity.down * dt;
+    }
+
+    target.distance = sqrt(position.north * position.north + position.east * position.east);
+    target.azimuth  = wrap360(atan2(position.east, position.north) * RAD2DEG);
+    if (target.distance > 0 || position.down != 0) {
+        target.elevation = atan2(-position.down, target.distance) * RAD2DEG;
+    } else {
+        target.elevation = 0;
+    }
+    return target;
+}
+
+TrackingEngine::Pointing TrackingEngine::stepAt(qint64 nowMs)
+{
+    Pointing target = targetAt(nowMs + m_actuationLatency);
+
+    if (!m_commandSet) {
+        m_command    = target;
+        m_commandSet = true;
+    } else {
+        double dt = qMax<qint64>(0, nowMs - m_lastStepMs) / 1000.0;
+        m_command.azimuth   = wrap360(m_command.azimuth + limit(wrap180(target.azimuth - m_command.azimuth), m_azimuthRate, dt));
+        m_command.elevation = m_command.elevation + limit(target.elevation - m_command.elevation, m_elevationRate, dt);
+        m_command.distance  = target.distance;
+    }
+    m_lastStepMs = nowMs;
+    return m_command;
+}
+
+void TrackingEngine::tick()
+{
+    if (!isValid()) {
+        return;
+    }
+
+    Pointing command = stepAt(m_clock.elapsed());
+    emit pointingChanged(command.azimuth, command.elevation);
+}
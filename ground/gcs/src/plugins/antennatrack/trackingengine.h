@@ -0,0 +1,159 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trackingengine.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup AntennaTrackGadgetPlugin Antenna Track Gadget Plugin
+ * @{
+ * @brief Latency compensated antenna pointing at a fixed rate
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TRACKINGENGINE_H
+#define TRACKINGENGINE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+class QTimer;
+
+/**
+ * Points the antenna where the vehicle is at actuation time rather than where
+ * it was when its last GPS position was sampled.
+ *
+ * Positions and velocities are stamped on arrival, minus the telemetry latency.
+ * At every tick of the tracking rate the position is extrapolated with the
+ * latest velocity to now plus the actuation latency, and the pointing moves
+ * toward it no faster than the slew rate limits.
+ *
+ * The *At() methods take the time explicitly so recorded flights can be replayed.
+ */
+class TrackingEngine : public QObject {
+    Q_OBJECT
+
+public:
+    struct Pointing {
+        // Degrees, azimuth 0..360 from north, elevation above the horizon
+        double azimuth;
+        double elevation;
+        // Meters, horizontal
+        double distance;
+    };
+
+    TrackingEngine(QObject *parent = 0);
+    ~TrackingEngine();
+
+    void setTrackingRate(int hz);
+    void setTelemetryLatency(int ms);
+    void setActuationLatency(int ms);
+    // Degrees per second, 0 for no limit
+    void setSlewRates(double azimuthRate, double elevationRate);
+    // Without prediction the latest position is used as is
+    void setPrediction(bool enabled);
+
+    int trackingRate() const
+    {
+        return m_trackingRate;
+    }
+
+    bool isValid() const
+    {
+        return m_homeSet && m_positionCount > 0;
+    }
+
+    void setHomeAt(double lat, double lon, double alt);
+    void setPositionAt(qint64 receivedMs, double lat, double lon, double alt);
+    void setVelocityAt(qint64 receivedMs, double north, double east, double down);
+
+    // Where the vehicle is expected at the given time, without slew limits
+    Pointing targetAt(qint64 ms) const;
+    // Moves the commanded pointing toward the target for the actuation at nowMs
+    Pointing stepAt(qint64 nowMs);
+
+    Pointing pointing() const
+    {
+        return m_command;
+    }
+
+public slots:
+    void start();
+    void stop();
+    void setHome(double lat, double lon, double alt);
+    void setPosition(double lat, double lon, double alt);
+    void setVelocity(double north, double east, double down);
+
+signals:
+    void pointingChanged(double azimuth, double elevation);
+
+private slots:
+    void tick();
+
+private:
+    // Older velocities are replaced by the difference of the last two positions
+    static const int VELOCITY_TIMEOUT_MS = 2000;
+    // Beyond that a lost link would swing the antenna away
+    static const int MAX_EXTRAPOLATION_MS = 3000;
+
+    struct Fix {
+        qint64 ms;
+        double lat;
+        double lon;
+        double alt;
+    };
+
+    struct Sample {
+        qint64 ms;
+        double north;
+        double east;
+        double down;
+    };
+
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+
+    int m_trackingRate;
+    int m_telemetryLatency;
+    int m_actuationLatency;
+    double m_azimuthRate;
+    double m_elevationRate;
+    bool m_prediction;
+
+    bool m_homeSet;
+    double m_homeLat;
+    double m_homeLon;
+    double m_homeAlt;
+    // Local tangent plane scale around home
+    double m_metersPerDegLat;
+    double m_metersPerDegLon;
+
+    // Last two positions, converted when used so home can change any time
+    Fix m_positions[2];
+    int m_positionCount;
+    Sample m_velocity;
+    bool m_velocitySet;
+
+    Pointing m_command;
+    qint64 m_lastStepMs;
+    bool m_commandSet;
+
+    Sample toNED(const Fix &fix) const;
+    Sample velocityAt(qint64 ms) const;
+};
+
+#endif // TRACKINGENGINE_H
@@ -0,0 +1,430 @@
+/**
+ ******************************************************************************
+ *
+ * @file       systemident.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Identifies the rate loop plant and computes the stabilization gains for it
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "systemident.h"
+
+#include <unsupported/Eigen/FFT>
+
+#include <QObject>
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <math.h>
+#include <string.h>
+
+const double SystemIdent::MIN_COHERENCE = 0.5;
+
+SystemIdent::Model SystemIdent::modelFromState(const SystemIdentState::DataFields &state)
+{
+    Model model;
+
+    for (int i = 0; i < AXES; i++) {
+        model.beta[i]  = state.Beta[i];
+        model.bias[i]  = state.Bias[i];
+        model.noise[i] = state.Noise[i];
+    }
+    model.tau   = exp(state.Tau);
+    model.delay = state.GyroReadTimeAverage;
+    model.valid = true;
+    return model;
+}
+
+/**
+ * Damping and noise from the SmoothQuick value, -1 is the smoothest and +1 the quickest
+ */
+SystemIdent::Tuning SystemIdent::tuningFromSettings(const SystemIdentSettings::DataFields &settings)
+{
+    Tuning tuning;
+    double smoothQuick = qBound(-1.0, (double)settings.SmoothQuickValue, 1.0);
+    double damp;
+    double noise;
+
+    if (smoothQuick < 0) {
+        damp  = settings.DampRate - smoothQuick * (settings.DampMax - settings.DampRate);
+        noise = settings.NoiseRate + smoothQuick * (settings.NoiseRate - settings.NoiseMin);
+    } else {
+        damp  = settings.DampRate - smoothQuick * (settings.DampRate - settings.DampMin);
+        noise = settings.NoiseRate + smoothQuick * (settings.NoiseMax - settings.NoiseRate);
+    }
+    tuning.damp  = damp / 100.0;
+    tuning.noise = noise / 1000.0;
+    tuning.derivativeFactor       = settings.DerivativeFactor;
+    tuning.outerLoopKpSoftClamp   = settings.OuterLoopKpSoftClamp;
+    tuning.calculateYaw           = settings.CalculateYaw;
+    tuning.yawToRollPitchRatioMin = settings.YawToRollPitchPIDRatioMin;
+    tuning.yawToRollPitchRatioMax = settings.YawToRollPitchPIDRatioMax;
+    return tuning;
+}
+
+QVector<SystemIdent::FrequencyPoint> SystemIdent::frequencyResponse(const QVector<double> &input, const QVector<double> &output,
+                                                                    double samplePeriod, int segmentLength)
+{
+    QVector<FrequencyPoint> response;
+    int length = qMin(input.size(), output.size());
+
+    if (segmentLength < 8 || length < segmentLength || samplePeriod <= 0) {
+        return response;
+    }
+
+    int bins = segmentLength / 2 + 1;
+    std::vector<double> window(segmentLength);
+    for (int i = 0; i < segmentLength; i++) {
+        window[i] = 0.5 - 0.5 * cos(2.0 * M_PI * i / segmentLength);
+    }
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+    std::vector<double> x(segmentLength);
+    std::vector<double> y(segmentLength);
+    std::vector<std::complex<double> > fx;
+    std::vector<std::complex<double> > fy;
+    std::vector<double> pxx(bins, 0.0);
+    std::vector<double> pyy(bins, 0.0);
+    std::vector<std::complex<double> > pxy(bins, 0.0);
+
+    for (int start = 0; start + segmentLength <= length; start += segmentLength / 2) {
+        double meanX = 0;
+        double meanY = 0;
+        for (int i = 0; i < segmentLength; i++) {
+            meanX += input[start + i];
+            meanY += output[start + i];
+        }
+        meanX /= segmentLength;
+        meanY /= segmentLength;
+        for (int i = 0; i < segmentLength; i++) {
+            x[i] = (input[start + i] - meanX) * window[i];
+            y[i] = (output[start + i] - meanY) * window[i];
+        }
+        fft.fwd(fx, x);
+        fft.fwd(fy, y);
+        for (int k = 0; k < bins; k++) {
+            pxx[k] += std::norm(fx[k]);
+            pyy[k] += std::norm(fy[k]);
+            pxy[k] += std::conj(fx[k]) * fy[k];
+        }
+    }
+
+    response.reserve(bins - 1);
+    for (int k = 1; k < bins; k++) {
+        FrequencyPoint point;
+        point.frequency = k / (segmentLength * samplePeriod);
+        if (pxx[k] > 0) {
+            std::complex<double> h = pxy[k] / pxx[k];
+            point.magnitude = std::abs(h);
+            point.phase     = std::arg(h) * 180.0 / M_PI;
+        } else {
+            point.magnitude = 0;
+            point.phase     = 0;
+        }
+        point.coherence = (pxx[k] > 0 && pyy[k] > 0) ? std::norm(pxy[k]) / (pxx[k] * pyy[k]) : 0;
+        response.append(point);
+    }
+    return response;
+}
+
+/**
+ * With m = |H| w, 1 / m^2 = (1 + tau^2 w^2) / exp(2 beta) is linear in w^2.
+ * The delay is what is left of the phase once the integrator and the lag
+ * are taken out, -w delay.
+ */
+bool SystemIdent::fitPlant(const QVector<FrequencyPoint> &response, double minFrequency, double maxFrequency,
+                           double *beta, double *tau, double *delay)
+{
+    QVector<FrequencyPoint> points;
+
+    foreach(const FrequencyPoint &point, response) {
+        if (point.frequency >= minFrequency && point.frequency <= maxFrequency
+            && point.coherence >= MIN_COHERENCE && point.magnitude > 0) {
+            points.append(point);
+        }
+    }
+    if (points.size() < 5) {
+        return false;
+    }
+
+    // Weighted for the relative error
+    double sw = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    foreach(const FrequencyPoint &point, points) {
+        double w = 2.0 * M_PI * point.frequency;
+        double m = point.magnitude * w;
+        double x = w * w;
+        double y = 1.0 / (m * m);
+        double weight = point.coherence / (y * y);
+        sw  += weight;
+        sx  += weight * x;
+        sy  += weight * y;
+        sxx += weight * x * x;
+        sxy += weight * x * y;
+    }
+    double det = sw * sxx - sx * sx;
+    if (det <= 0) {
+        return false;
+    }
+    double c0 = (sxx * sy - sx * sxy) / det;
+    double c1 = (sw * sxy - sx * sy) / det;
+    if (c0 <= 0) {
+        return false;
+    }
+    *beta = -0.5 * log(c0);
+    *tau  = c1 > 0 ? sqrt(c1 / c0) : 0;
+
+    double swx = 0, sxx2 = 0;
+    double last = 0;
+    for (int i = 0; i < points.size(); i++) {
+        double w = 2.0 * M_PI * points[i].frequency;
+        double residual = points[i].phase * M_PI / 180.0 + M_PI / 2 + atan(w * *tau);
+        // Unwrapped, the first point close to zero
+        double reference = i == 0 ? 0 : last;
+        while (residual - reference > M_PI) {
+            residual -= 2 * M_PI;
+        }
+        while (residual - reference < -M_PI) {
+            residual += 2 * M_PI;
+        }
+        last  = residual;
+        swx  += points[i].coherence * residual * w;
+        sxx2 += points[i].coherence * w * w;
+    }
+    *delay = qMax(0.0, -swx / sxx2);
+    return true;
+}
+
+bool SystemIdent::identify(const LogSegment &log, Identification *identification, double minFrequency, double maxFrequency)
+{
+    Model &model = identification->model;
+    int tuned    = 0;
+    double tau   = 0;
+    double delay = 0;
+
+    model.valid = false;
+    model.tau   = 0;
+    model.delay = 0;
+    for (int i = 0; i < AXES; i++) {
+        const QVector<double> &gyro     = log.gyro[i];
+        const QVector<double> &actuator = log.actuator[i];
+
+        identification->plant[i] = frequencyResponse(actuator, gyro, log.samplePeriod);
+        identification->closedLoop[i] = frequencyResponse(log.rateDesired[i], gyro, log.samplePeriod);
+        identification->axisValid[i]  = fitPlant(identification->plant[i], minFrequency, maxFrequency,
+                                                 &model.beta[i], &identification->axisTau[i], &identification->axisDelay[i]);
+        if (!identification->axisValid[i]) {
+            model.beta[i] = 0;
+            identification->axisTau[i]   = 0;
+            identification->axisDelay[i] = 0;
+        } else if (i != YAW) {
+            tau   += identification->axisTau[i];
+            delay += identification->axisDelay[i];
+            tuned++;
+        }
+
+        // Hover trim, and the gyro variance sample to sample
+        double mean  = 0;
+        double noise = 0;
+        for (int k = 0; k < actuator.size(); k++) {
+            mean += actuator[k];
+        }
+        for (int k = 1; k < gyro.size(); k++) {
+            noise += (gyro[k] - gyro[k - 1]) * (gyro[k] - gyro[k - 1]);
+        }
+        model.bias[i]  = actuator.isEmpty() ? 0 : mean / actuator.size();
+        model.noise[i] = gyro.size() < 2 ? 0 : noise / (2.0 * (gyro.size() - 1));
+    }
+    if (tuned > 0) {
+        model.tau   = tau / tuned;
+        model.delay = delay / tuned;
+        model.valid = true;
+    }
+    return model.valid;
+}
+
+SystemIdent::Gains SystemIdent::computeGains(const Model &model, const Tuning &tuning)
+{
+    Gains gains;
+
+    memset(&gains, 0, sizeof(gains));
+    const double tau  = model.tau;
+    const double damp = tuning.damp;
+    if (!model.valid || tau <= 0 || damp <= 0) {
+        return gains;
+    }
+
+    // The derivative filter that keeps the high frequency gain below the noise
+    // limit, for the axis with the most gain, and the pole frequency it allows
+    double wn    = 1.0 / tau;
+    double tauD  = 0;
+    for (int i = 0; i < 30; i++) {
+        tauD = 0;
+        for (int axis = ROLL; axis <= PITCH; axis++) {
+            double t = (2 * damp * tau * wn - 1)
+                       / (4 * tau * damp * damp * wn * wn - 2 * damp * wn - tau * wn * wn + exp(model.beta[axis]) * tuning.noise);
+            tauD = qMax(tauD, t);
+        }
+        if (tauD <= 0 || !std::isfinite(tauD)) {
+            return gains;
+        }
+        wn = (tau + tauD) / (tau * tauD) / (2 * damp + 2);
+    }
+
+    // The first real pole is slow, the integral does not drive overshoot
+    const double a = ((tau + tauD) / tau / tauD - 2 * damp * wn) / 20.0;
+    const double b = (tau + tauD) / tau / tauD - 2 * damp * wn - a;
+
+    // The inner loop seen by the outer loop as a first order low pass,
+    // for a critically damped outer loop
+    const double zetaO = 1.3;
+    double kpO = 1 / 4.0 / (zetaO * zetaO) / (1 / wn);
+    double kiO = 0.75 * kpO / (2 * M_PI * tau * 10.0);
+    if (tuning.outerLoopKpSoftClamp > 0 && kpO > tuning.outerLoopKpSoftClamp) {
+        kiO *= tuning.outerLoopKpSoftClamp / kpO;
+        kpO  = tuning.outerLoopKpSoftClamp;
+    }
+
+    for (int axis = 0; axis < AXES; axis++) {
+        if (axis == YAW && tuning.calculateYaw == SystemIdentSettings::CALCULATEYAW_FALSE) {
+            continue;
+        }
+        double beta = exp(model.beta[axis]);
+        double ki   = a * b * wn * wn * tau * tauD / beta;
+        double kp   = tau * tauD * ((a + b) * wn * wn + 2 * a * b * damp * wn) / beta - ki * tauD;
+        double kd   = (tau * tauD * (a * b + wn * wn + (a + b) * 2 * damp * wn) - 1) / beta - kp * tauD;
+
+        gains.rate[axis][KP] = kp;
+        gains.rate[axis][KI] = ki;
+        gains.rate[axis][KD] = kd * tuning.derivativeFactor;
+        gains.attitude[axis][0] = kpO;
+        gains.attitude[axis][1] = kiO;
+        gains.axisTuned[axis]   = true;
+    }
+
+    if (gains.axisTuned[YAW] && tuning.calculateYaw == SystemIdentSettings::CALCULATEYAW_TRUELIMITTORATIO
+        && gains.rate[PITCH][KP] > 0) {
+        double ratio   = gains.rate[YAW][KP] / gains.rate[PITCH][KP];
+        double limited = qBound(tuning.yawToRollPitchRatioMin, ratio, tuning.yawToRollPitchRatioMax);
+        for (int i = 0; i < 3; i++) {
+            gains.rate[YAW][i] *= limited / ratio;
+        }
+    }
+
+    gains.naturalFrequency = wn;
+    gains.derivativeTau    = tauD;
+    gains.realPoles[0]     = a;
+    gains.realPoles[1]     = b;
+    gains.valid = true;
+    for (int axis = 0; axis < AXES; axis++) {
+        if (!gains.axisTuned[axis]) {
+            continue;
+        }
+        gains.margins[axis] = rateLoopMargins(model, axis, gains.rate[axis], tauD);
+        for (int i = 0; i < 3; i++) {
+            gains.valid &= std::isfinite(gains.rate[axis][i]) && gains.rate[axis][i] >= 0;
+        }
+    }
+    return gains;
+}
+
+/**
+ * Open loop (Kp + Ki / s + Kd s / (tau_d s + 1)) exp(beta) exp(-delay s) / (s (tau s + 1)),
+ * scanned over log spaced frequencies
+ */
+SystemIdent::Margins SystemIdent::rateLoopMargins(const Model &model, int axis, const double rate[3], double derivativeTau)
+{
+    Margins margins;
+
+    margins.crossover   = 0;
+    margins.phaseMargin = 0;
+    margins.gainMargin  = 0;
+
+    const double beta = exp(model.beta[axis]);
+    const int steps   = 4000;
+    const double minW = 0.1;
+    const double maxW = 100000.0;
+    double lastMagnitude = 0;
+    double lastPhase     = 0;
+
+    for (int i = 0; i <= steps; i++) {
+        double w = minW * pow(maxW / minW, (double)i / steps);
+        std::complex<double> s(0, w);
+        std::complex<double> controller = rate[KP] + rate[KI] / s + rate[KD] * s / (derivativeTau * s + 1.0);
+        double magnitude = std::abs(controller) * beta / (w * sqrt(1 + w * w * model.tau * model.tau));
+        // Continuous phase, the controller alone stays within +-90 deg
+        double phase     = (std::arg(controller) - M_PI / 2 - atan(w * model.tau) - w * model.delay) * 180.0 / M_PI;
+
+        if (i > 0) {
+            if (margins.crossover == 0 && lastMagnitude >= 1 && magnitude < 1) {
+                margins.crossover   = w / (2 * M_PI);
+                margins.phaseMargin = 180.0 + phase;
+            }
+            if (margins.gainMargin == 0 && lastPhase > -180.0 && phase <= -180.0) {
+                margins.gainMargin = -20.0 * log10(magnitude);
+            }
+        }
+        lastMagnitude = magnitude;
+        lastPhase     = phase;
+    }
+    return margins;
+}
+
+SystemIdent::Result SystemIdent::analyzeState(const Model &model, const Tuning &tuning)
+{
+    Result result;
+
+    result.fromLog = false;
+    result.identification.model = model;
+    for (int i = 0; i < AXES; i++) {
+        result.identification.axisTau[i]   = model.tau;
+        result.identification.axisDelay[i] = model.delay;
+        result.identification.axisValid[i] = model.valid;
+    }
+    result.gains = computeGains(model, tuning);
+    if (!result.gains.valid) {
+        result.error = QObject::tr("No stable gains for the measured plant");
+    }
+    return result;
+}
+
+SystemIdent::Result SystemIdent::analyzeLog(const LogSegment &log, const Tuning &tuning)
+{
+    Result result;
+
+    result.fromLog = true;
+    if (!identify(log, &result.identification)) {
+        memset(&result.gains, 0, sizeof(result.gains));
+        result.error = QObject::tr("Not enough roll or pitch excitation in the log");
+        return result;
+    }
+    // Nothing to tune yaw with
+    Tuning axisTuning = tuning;
+    if (!result.identification.axisValid[YAW]) {
+        axisTuning.calculateYaw = SystemIdentSettings::CALCULATEYAW_FALSE;
+    }
+    result.gains = computeGains(result.identification.model, axisTuning);
+    if (!result.gains.valid) {
+        result.error = QObject::tr("No stable gains for the measured plant");
+    }
+    return result;
+}
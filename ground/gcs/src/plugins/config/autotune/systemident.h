@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ *
+ * @file       systemident.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Identifies the rate loop plant and computes the stabilization gains for it
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SYSTEMIDENT_H
+#define SYSTEMIDENT_H
+
+#include "systemidentstate.h"
+#include "systemidentsettings.h"
+
+#include <QString>
+#include <QVector>
+
+/**
+ * The plant seen by the rate loop, from actuator desired to gyro rate, is
+ *
+ *   exp(beta) * exp(-delay s) / (s (tau s + 1))
+ *
+ * the same model the flight side SystemIdent module estimates as Beta and
+ * Tau. It is either taken from SystemIdentState or identified from a log
+ * segment with Welch averaged cross spectra.
+ *
+ * The gains are placed as in the flight side AutoTune module: for the rate
+ * loop PID, with the derivative low pass tau_d, the closed loop poles are
+ * a damped pair at wn and two real poles. The margins are predicted from
+ * the open loop including the delay.
+ */
+class SystemIdent {
+public:
+    enum Axis { ROLL = 0, PITCH = 1, YAW = 2, AXES = 3 };
+    enum RateGain { KP = 0, KI = 1, KD = 2 };
+
+    struct Model {
+        // ln of the control gain, (deg/s^2) per unit of actuator
+        double beta[AXES];
+        // actuator for motionless hover
+        double bias[AXES];
+        // gyro vibration, (deg/s)^2
+        double noise[AXES];
+        // s
+        double tau;
+        double delay;
+        bool   valid;
+    };
+
+    struct FrequencyPoint {
+        // Hz
+        double frequency;
+        double magnitude;
+        // deg
+        double phase;
+        double coherence;
+    };
+
+    // Fixed rate samples, one vector per axis
+    struct LogSegment {
+        // s
+        double samplePeriod;
+        QVector<double> gyro[AXES];
+        QVector<double> actuator[AXES];
+        // optional, for the closed loop response
+        QVector<double> rateDesired[AXES];
+    };
+
+    struct Identification {
+        // tau and delay of roll and pitch averaged, like the flight side
+        Model  model;
+        double axisTau[AXES];
+        double axisDelay[AXES];
+        bool   axisValid[AXES];
+        // gyro / actuator
+        QVector<FrequencyPoint> plant[AXES];
+        // gyro / rate desired
+        QVector<FrequencyPoint> closedLoop[AXES];
+    };
+
+    struct Tuning {
+        // rate loop damping ratio
+        double damp;
+        // high frequency gain limit
+        double noise;
+        double derivativeFactor;
+        double outerLoopKpSoftClamp;
+        int    calculateYaw;
+        double yawToRollPitchRatioMin;
+        double yawToRollPitchRatioMax;
+    };
+
+    struct Margins {
+        // Hz, 0 if there is none
+        double crossover;
+        // deg
+        double phaseMargin;
+        // dB
+        double gainMargin;
+    };
+
+    struct Gains {
+        double  rate[AXES][3];
+        double  attitude[AXES][2];
+        bool    axisTuned[AXES];
+        Margins margins[AXES];
+        // rad/s
+        double  naturalFrequency;
+        // s
+        double  derivativeTau;
+        // rad/s
+        double  realPoles[2];
+        bool    valid;
+    };
+
+    struct Result {
+        bool           fromLog;
+        Identification identification;
+        Gains          gains;
+        QString        error;
+    };
+
+    static const int SEGMENT_LENGTH = 512;
+    static const double MIN_COHERENCE;
+
+    static Model modelFromState(const SystemIdentState::DataFields &state);
+    static Tuning tuningFromSettings(const SystemIdentSettings::DataFields &settings);
+
+    // Welch estimate of output / input, Hann window with half overlap, without the DC bin
+    static QVector<FrequencyPoint> frequencyResponse(const QVector<double> &input, const QVector<double> &output,
+                                                     double samplePeriod, int segmentLength = SEGMENT_LENGTH);
+    // Fits the model to the coherent points between the frequencies
+    static bool fitPlant(const QVector<FrequencyPoint> &response, double minFrequency, double maxFrequency,
+                         double *beta, double *tau, double *delay);
+    static bool identify(const LogSegment &log, Identification *identification,
+                         double minFrequency = 2.0, double maxFrequency = 60.0);
+
+    static Gains computeGains(const Model &model, const Tuning &tuning);
+    static Margins rateLoopMargins(const Model &model, int axis, const double rate[3], double derivativeTau);
+
+    static Result analyzeState(const Model &model, const Tuning &tuning);
+    static Result analyzeLog(const LogSegment &log, const Tuning &tuning);
+};
+
+#endif // SYSTEMIDENT_H
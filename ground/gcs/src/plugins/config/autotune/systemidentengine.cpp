@@ -0,0 +1,134 @@
+/**
+ ******************************************************************************
+ *
+ * @file       systemidentengine.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Runs the autotune analysis off the GUI thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "systemidentengine.h"
+
+#include "uavobjectmanager.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+SystemIdentEngine::SystemIdentEngine(QObject *parent) : QObject(parent),
+    m_following(false), m_pending(false)
+{
+    m_result.fromLog                    = false;
+    m_result.gains.valid                = false;
+    m_result.identification.model.valid = false;
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(analysisFinished()));
+}
+
+SystemIdentEngine::~SystemIdentEngine()
+{
+    // The analysis only works on its own copies, but its result is delivered here
+    m_watcher.waitForFinished();
+}
+
+bool SystemIdentEngine::analyze(const SystemIdentState::DataFields &state, const SystemIdentSettings::DataFields &settings)
+{
+    if (isRunning()) {
+        return false;
+    }
+    m_watcher.setFuture(QtConcurrent::run(&SystemIdent::analyzeState, SystemIdent::modelFromState(state),
+                                          SystemIdent::tuningFromSettings(settings)));
+    return true;
+}
+
+bool SystemIdentEngine::analyze(const SystemIdent::LogSegment &log, const SystemIdentSettings::DataFields &settings)
+{
+    if (isRunning()) {
+        return false;
+    }
+    m_watcher.setFuture(QtConcurrent::run(&SystemIdent::analyzeLog, log, SystemIdent::tuningFromSettings(settings)));
+    return true;
+}
+
+bool SystemIdentEngine::analyze(UAVObjectManager *objMngr)
+{
+    SystemIdentState *state       = SystemIdentState::GetInstance(objMngr);
+    SystemIdentSettings *settings = SystemIdentSettings::GetInstance(objMngr);
+
+    Q_ASSERT(state && settings);
+    return analyze(state->getData(), settings->getData());
+}
+
+void SystemIdentEngine::follow(UAVObjectManager *objMngr)
+{
+    SystemIdentState *state       = SystemIdentState::GetInstance(objMngr);
+    SystemIdentSettings *settings = SystemIdentSettings::GetInstance(objMngr);
+
+    Q_ASSERT(state && settings);
+    connect(state, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(stateUpdated(UAVObject *)), Qt::UniqueConnection);
+    connect(settings, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(settingsUpdated(UAVObject *)), Qt::UniqueConnection);
+    m_state     = state->getData();
+    m_settings  = settings->getData();
+    m_following = true;
+    analyzeFollowed();
+}
+
+void SystemIdentEngine::setSettings(const SystemIdentSettings::DataFields &settings)
+{
+    m_settings = settings;
+    analyzeFollowed();
+}
+
+void SystemIdentEngine::stateUpdated(UAVObject *obj)
+{
+    m_state = static_cast<SystemIdentState *>(obj)->getData();
+    analyzeFollowed();
+}
+
+void SystemIdentEngine::settingsUpdated(UAVObject *obj)
+{
+    m_settings = static_cast<SystemIdentSettings *>(obj)->getData();
+    analyzeFollowed();
+}
+
+void SystemIdentEngine::analyzeFollowed()
+{
+    if (!m_following) {
+        return;
+    }
+    if (isRunning()) {
+        // Telemetry can arrive faster than the analysis, only the latest data matters
+        m_pending = true;
+        return;
+    }
+    m_pending = false;
+    analyze(m_state, m_settings);
+}
+
+void SystemIdentEngine::analysisFinished()
+{
+    m_result = m_watcher.result();
+    if (!m_result.error.isEmpty()) {
+        qDebug() << "SystemIdentEngine -" << m_result.error;
+    }
+    emit finished(m_result.error.isEmpty());
+    if (m_pending) {
+        analyzeFollowed();
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ *
+ * @file       systemidentengine.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Runs the autotune analysis off the GUI thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SYSTEMIDENTENGINE_H
+#define SYSTEMIDENTENGINE_H
+
+#include "systemident.h"
+
+#include <QObject>
+#include <QFutureWatcher>
+
+class UAVObject;
+class UAVObjectManager;
+
+/**
+ * Analyzes the board estimate or a log segment in the thread pool and
+ * emits finished() on the thread it lives in. The inputs are copied, so
+ * the caller can keep updating its objects while the analysis runs.
+ *
+ * After follow() every SystemIdentState or SystemIdentSettings update is
+ * analyzed. Updates received while an analysis runs are coalesced into
+ * one more analysis of the latest data once it finishes.
+ */
+class SystemIdentEngine : public QObject {
+    Q_OBJECT
+
+public:
+    SystemIdentEngine(QObject *parent = 0);
+    ~SystemIdentEngine();
+
+    bool isRunning() const
+    {
+        return m_watcher.isRunning();
+    }
+
+    // Result of the last finished analysis
+    SystemIdent::Result result() const
+    {
+        return m_result;
+    }
+
+public slots:
+    // All analyze() calls return false if an analysis is already running
+    bool analyze(const SystemIdentState::DataFields &state, const SystemIdentSettings::DataFields &settings);
+    bool analyze(const SystemIdent::LogSegment &log, const SystemIdentSettings::DataFields &settings);
+    // SystemIdentState and SystemIdentSettings as last received from the board
+    bool analyze(UAVObjectManager *objMngr);
+
+    void follow(UAVObjectManager *objMngr);
+    // Replaces the followed settings until the board sends new ones, to preview a tuning
+    void setSettings(const SystemIdentSettings::DataFields &settings);
+
+signals:
+    void finished(bool success);
+
+private slots:
+    void analysisFinished();
+    void stateUpdated(UAVObject *obj);
+    void settingsUpdated(UAVObject *obj);
+
+private:
+    QFutureWatcher<SystemIdent::Result> m_watcher;
+    SystemIdent::Result m_result;
+    SystemIdentState::DataFields m_state;
+    SystemIdentSettings::DataFields m_settings;
+    bool m_following;
+    bool m_pending;
+
+    void analyzeFollowed();
+};
+
+#endif // SYSTEMIDENTENGINE_H
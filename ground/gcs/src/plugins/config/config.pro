@@ -2,7 +2,7 @@ TEMPLATE = lib
 TARGET = Config
 DEFINES += CONFIG_LIBRARY
 
-QT += widgets svg opengl qml quick
+QT += widgets svg opengl qml quick concurrent
 
 # silence eigen warnings
 #QMAKE_CXXFLAGS_WARN_ON += -Wno-deprecated-declarations
@@ -37,6 +37,7 @@ HEADERS += \
     inputchannelform.h \
     configcamerastabilizationwidget.h \
     configtxpidwidget.h \
+    configautotunewidget.h \
     outputchannelform.h \    
     cfg_vehicletypes/vehicleconfig.h \
     cfg_vehicletypes/configccpmwidget.h \
@@ -67,7 +68,9 @@ HEADERS += \
     configoplinkwidget.h \
     configrevonanohwwidget.h \
     configsparky2hwwidget.h \
-    failsafechannelform.h
+    failsafechannelform.h \
+    autotune/systemident.h \
+    autotune/systemidentengine.h
 
 SOURCES += \
     configplugin.cpp \
@@ -86,6 +89,7 @@ SOURCES += \
     configcamerastabilizationwidget.cpp \
     configrevowidget.cpp \
     configtxpidwidget.cpp \
+    configautotunewidget.cpp \
     cfg_vehicletypes/vehicleconfig.cpp \
     cfg_vehicletypes/configccpmwidget.cpp \
     cfg_vehicletypes/configmultirotorwidget.cpp \
@@ -109,7 +113,9 @@ SOURCES += \
     configoplinkwidget.cpp \
     configrevonanohwwidget.cpp \
     configsparky2hwwidget.cpp \
-    failsafechannelform.cpp
+    failsafechannelform.cpp \
+    autotune/systemident.cpp \
+    autotune/systemidentengine.cpp
 
 FORMS += \
     airframe.ui \
@@ -130,6 +136,7 @@ FORMS += \
     outputchannelform.ui \
     revosensors.ui \
     txpid.ui \
+    autotune.ui \
     mixercurve.ui \
     configrevohwwidget.ui \
     configspracingf3hwwidget.ui \
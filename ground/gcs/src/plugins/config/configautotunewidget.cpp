@@ -1,21 +1,45 @@
+/**
+ ******************************************************************************
+ *
+ * @file       configautotunewidget.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ *             The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief The Configuration Gadget used to adjust or recalculate autotuning
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
 #include "configautotunewidget.h"
 
 #include "ui_autotune.h"
 
-#include "relaytuningsettings.h"
-#include "relaytuning.h"
-#include "stabilizationsettings.h"
+#include "autotune/systemidentengine.h"
+#include "systemidentsettings.h"
 #include "hwsettings.h"
 
 #include <QDebug>
 #include <QStringList>
 #include <QWidget>
-#include <QTextEdit>
-#include <QVBoxLayout>
+#include <QLabel>
 #include <QPushButton>
-#include <QDesktopServices>
-#include <QUrl>
-#include <QList>
+
+static const char *const AXIS_NAMES[SystemIdent::AXES] = { "Roll", "Pitch", "Yaw" };
 
 ConfigAutotuneWidget::ConfigAutotuneWidget(QWidget *parent) :
     ConfigTaskWidget(parent)
@@ -30,126 +54,119 @@ ConfigAutotuneWidget::ConfigAutotuneWidget(QWidget *parent) :
 
     disableMouseWheelEvents();
 
-    // Whenever any value changes compute new potential stabilization settings
-    connect(m_autotune->rateTuning, SIGNAL(valueChanged(int)), this, SLOT(recomputeStabilization()));
-    connect(m_autotune->attitudeTuning, SIGNAL(valueChanged(int)), this, SLOT(recomputeStabilization()));
-
     addUAVObject("HwSettings");
     addWidget(m_autotune->enableAutoTune);
 
-    RelayTuning *relayTuning = RelayTuning::GetInstance(getObjectManager());
-    Q_ASSERT(relayTuning);
-    if (relayTuning) {
-        connect(relayTuning, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(recomputeStabilization()));
-    }
+    // The computed values follow the estimate and settings received from the board
+    m_engine = new SystemIdentEngine(this);
+    connect(m_engine, SIGNAL(finished(bool)), this, SLOT(showResult(bool)));
+    m_autotune->useComputedValues->setEnabled(false);
+    m_engine->follow(getObjectManager());
+
+    // Show the gains of the slider position before it is applied
+    connect(m_autotune->smoothQuick, SIGNAL(valueChanged(int)), this, SLOT(previewTuning()));
 
     // Connect the apply button for the stabilization settings
     connect(m_autotune->useComputedValues, SIGNAL(pressed()), this, SLOT(saveStabilization()));
 }
 
-/**
- * Apply the stabilization settings computed
- */
-void ConfigAutotuneWidget::saveStabilization()
+void ConfigAutotuneWidget::previewTuning()
 {
-    StabilizationSettings *stabilizationSettings = StabilizationSettings::GetInstance(getObjectManager());
+    SystemIdentSettings *systemIdentSettings = SystemIdentSettings::GetInstance(getObjectManager());
 
-    Q_ASSERT(stabilizationSettings);
-    if (!stabilizationSettings) {
+    Q_ASSERT(systemIdentSettings);
+    if (!systemIdentSettings) {
         return;
     }
 
-    // Make sure to recompute in case the other stab settings changed since
-    // the last time
-    recomputeStabilization();
-
-    // Apply this data to the board
-    stabilizationSettings->setData(stabSettings);
-    stabilizationSettings->updated();
+    SystemIdentSettings::DataFields settings = systemIdentSettings->getData();
+    // Need to divide by 100 because that is what the .ui file does to get the UAVO
+    settings.SmoothQuickValue = m_autotune->smoothQuick->value() / 100.0;
+    m_engine->setSettings(settings);
 }
 
 /**
- * Called whenever the gain ratios or measured values
- * are changed
+ * Display the gains of the last analysis and their predicted margins
  */
-void ConfigAutotuneWidget::recomputeStabilization()
+void ConfigAutotuneWidget::showResult(bool success)
 {
-    RelayTuningSettings *relayTuningSettings = RelayTuningSettings::GetInstance(getObjectManager());
+    const SystemIdent::Result result = m_engine->result();
+    const SystemIdent::Gains &gains  = result.gains;
+
+    QLabel *rate[SystemIdent::AXES][3] = {
+        { m_autotune->rollRateKp,  m_autotune->rollRateKi,  m_autotune->rollRateKd  },
+        { m_autotune->pitchRateKp, m_autotune->pitchRateKi, m_autotune->pitchRateKd },
+        { m_autotune->yawRateKp,   m_autotune->yawRateKi,   m_autotune->yawRateKd   }
+    };
+    QLabel *attitude[SystemIdent::AXES][2] = {
+        { m_autotune->rollAttitudeKp,  m_autotune->rollAttitudeKi  },
+        { m_autotune->pitchAttitudeKp, m_autotune->pitchAttitudeKi },
+        { m_autotune->yawAttitudeKp,   m_autotune->yawAttitudeKi   }
+    };
+
+    QStringList margins;
+    for (int axis = 0; axis < SystemIdent::AXES; axis++) {
+        bool tuned = success && gains.axisTuned[axis];
+        for (int i = 0; i < 3; i++) {
+            rate[axis][i]->setText(tuned ? QString::number(gains.rate[axis][i]) : QString("-"));
+        }
+        for (int i = 0; i < 2; i++) {
+            attitude[axis][i]->setText(tuned ? QString::number(gains.attitude[axis][i]) : QString("-"));
+        }
+        if (tuned) {
+            margins << tr("%1: crossover %2 Hz, phase margin %3 deg, gain margin %4 dB")
+                .arg(AXIS_NAMES[axis])
+                .arg(gains.margins[axis].crossover, 0, 'f', 1)
+                .arg(gains.margins[axis].phaseMargin, 0, 'f', 0)
+                .arg(gains.margins[axis].gainMargin, 0, 'f', 1);
+        }
+    }
 
-    Q_ASSERT(relayTuningSettings);
-    if (!relayTuningSettings) {
-        return;
+    if (!success) {
+        m_autotune->analysisStatus->setText(result.error);
+    } else if (!gains.valid) {
+        m_autotune->analysisStatus->setText(tr("The measured properties do not give stable gains."));
+    } else {
+        m_autotune->analysisStatus->setText(margins.join("\n"));
     }
+    m_autotune->useComputedValues->setEnabled(success && gains.valid);
+}
 
-    RelayTuning *relayTuning = RelayTuning::GetInstance(getObjectManager());
-    Q_ASSERT(relayTuning);
-    if (!relayTuning) {
+/**
+ * Apply the stabilization settings computed to the destination bank
+ */
+void ConfigAutotuneWidget::saveStabilization()
+{
+    const SystemIdent::Gains gains = m_engine->result().gains;
+
+    if (!gains.valid) {
         return;
     }
 
-    StabilizationSettings *stabilizationSettings = StabilizationSettings::GetInstance(getObjectManager());
-    Q_ASSERT(stabilizationSettings);
-    if (!stabilizationSettings) {
+    UAVObject *stabBank = getObject(QString("StabilizationSettingsBank%1").arg(m_autotune->destinationBank->value()));
+    Q_ASSERT(stabBank);
+    if (!stabBank) {
         return;
     }
 
-    RelayTuning::DataFields relayTuningData = relayTuning->getData();
-    RelayTuningSettings::DataFields tuningSettingsData = relayTuningSettings->getData();
-    stabSettings = stabilizationSettings->getData();
-
-    // Need to divide these by 100 because that is what the .ui file does
-    // to get the UAVO
-    const double gain_ratio_r = m_autotune->rateTuning->value() / 100.0;
-    const double zero_ratio_r = m_autotune->rateTuning->value() / 100.0;
-    const double gain_ratio_p = m_autotune->attitudeTuning->value() / 100.0;
-    const double zero_ratio_p = m_autotune->attitudeTuning->value() / 100.0;
-
-    // For now just run over roll and pitch
-    for (int i = 0; i < 2; i++) {
-        if (relayTuningData.Period[i] == 0 || relayTuningData.Gain[i] == 0) {
+    // The element order of the PID fields is that of SystemIdent::RateGain
+    for (int axis = 0; axis < SystemIdent::AXES; axis++) {
+        if (!gains.axisTuned[axis]) {
             continue;
         }
-
-        double wu  = 1000.0 * 2 * M_PI / relayTuningData.Period[i]; // ultimate freq = output osc freq (rad/s)
-
-        double wc  = wu * gain_ratio_r;      // target openloop crossover frequency (rad/s)
-        double zc  = wc * zero_ratio_r;      // controller zero location (rad/s)
-        double kpu = 4.0f / M_PI / relayTuningData.Gain[i]; // ultimate gain, i.e. the proportional gain for instablity
-        double kp  = kpu * gain_ratio_r;     // proportional gain
-        double ki  = zc * kp;                // integral gain
-
-        // Now calculate gains for the next loop out knowing it is the integral of
-        // the inner loop -- the plant is position/velocity = scale*1/s
-        double wc2 = wc * gain_ratio_p; // crossover of the attitude loop
-        double kp2 = wc2; // kp of attitude
-        double ki2 = wc2 * zero_ratio_p * kp2; // ki of attitude
-
-        switch (i) {
-        case 0: // Roll
-
-            stabSettings.RollRatePID[StabilizationSettings::ROLLRATEPID_KP] = kp;
-            stabSettings.RollRatePID[StabilizationSettings::ROLLRATEPID_KI] = ki;
-            stabSettings.RollPI[StabilizationSettings::ROLLPI_KP] = kp2;
-            stabSettings.RollPI[StabilizationSettings::ROLLPI_KI] = ki2;
-            break;
-        case 1: // Pitch
-            stabSettings.PitchRatePID[StabilizationSettings::PITCHRATEPID_KP] = kp;
-            stabSettings.PitchRatePID[StabilizationSettings::PITCHRATEPID_KI] = ki;
-            stabSettings.PitchPI[StabilizationSettings::PITCHPI_KP] = kp2;
-            stabSettings.PitchPI[StabilizationSettings::PITCHPI_KI] = ki2;
-            break;
+        UAVObjectField *rateField     = stabBank->getField(QString("%1RatePID").arg(AXIS_NAMES[axis]));
+        UAVObjectField *attitudeField = stabBank->getField(QString("%1PI").arg(AXIS_NAMES[axis]));
+        Q_ASSERT(rateField && attitudeField);
+        for (int i = 0; i < 3; i++) {
+            rateField->setDouble(gains.rate[axis][i], i);
+        }
+        for (int i = 0; i < 2; i++) {
+            attitudeField->setDouble(gains.attitude[axis][i], i);
         }
     }
 
-    // Display these computed settings
-    m_autotune->rollRateKp->setText(QString().number(stabSettings.RollRatePID[StabilizationSettings::ROLLRATEPID_KP]));
-    m_autotune->rollRateKi->setText(QString().number(stabSettings.RollRatePID[StabilizationSettings::ROLLRATEPID_KI]));
-    m_autotune->rollAttitudeKp->setText(QString().number(stabSettings.RollPI[StabilizationSettings::ROLLPI_KP]));
-    m_autotune->rollAttitudeKi->setText(QString().number(stabSettings.RollPI[StabilizationSettings::ROLLPI_KI]));
-    m_autotune->pitchRateKp->setText(QString().number(stabSettings.PitchRatePID[StabilizationSettings::PITCHRATEPID_KP]));
-    m_autotune->pitchRateKi->setText(QString().number(stabSettings.PitchRatePID[StabilizationSettings::PITCHRATEPID_KI]));
-    m_autotune->pitchAttitudeKp->setText(QString().number(stabSettings.PitchPI[StabilizationSettings::PITCHPI_KP]));
-    m_autotune->pitchAttitudeKi->setText(QString().number(stabSettings.PitchPI[StabilizationSettings::PITCHPI_KI]));
+    // Apply this data to the board
+    stabBank->updated();
 }
 
 void ConfigAutotuneWidget::refreshWidgetsValuesImpl(UAVObject *obj)
@@ -169,5 +186,4 @@ void ConfigAutotuneWidget::updateObjectsFromWidgetsImpl()
     quint8 enableModule    = (m_autotune->enableAutoTune->isChecked()) ? HwSettings::OPTIONALMODULES_ENABLED : HwSettings::OPTIONALMODULES_DISABLED;
 
     hwSettings->setOptionalModules(HwSettings::OPTIONALMODULES_AUTOTUNE, enableModule);
-    ;
 }
@@ -2,7 +2,8 @@
  ******************************************************************************
  *
  * @file       configautotunewidget.h
- * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ *             The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
  * @addtogroup GCSPlugins GCS Plugins
  * @{
  * @addtogroup ConfigPlugin Config Plugin
@@ -32,14 +33,10 @@
 #include "uavobjectmanager.h"
 #include "uavobject.h"
 
-#include "stabilizationsettings.h"
-#include "relaytuningsettings.h"
-#include "relaytuning.h"
-
 #include <QWidget>
-#include <QTimer>
 
 class Ui_AutotuneWidget;
+class SystemIdentEngine;
 
 class ConfigAutotuneWidget : public ConfigTaskWidget {
     Q_OBJECT
@@ -48,14 +45,15 @@ public:
 
 private:
     Ui_AutotuneWidget *m_autotune;
-    StabilizationSettings::DataFields stabSettings;
+    SystemIdentEngine *m_engine;
 
 protected:
     virtual void refreshWidgetsValuesImpl(UAVObject *obj);
     virtual void updateObjectsFromWidgetsImpl();
 
 private slots:
-    void recomputeStabilization();
+    void previewTuning();
+    void showResult(bool success);
     void saveStabilization();
 };
 
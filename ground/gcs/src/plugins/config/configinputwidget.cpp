@@ -428,8 +428,6 @@ ConfigInputWidget::ConfigInputWidget(QWidget *parent) :
         m_txAccess3->setTransform(m_txAccess3Orig, true);
     }
     wizardUi->graphicsView->fitInView(m_txMainBody, Qt::KeepAspectRatio);
-    animate = new QTimer(this);
-    connect(animate, SIGNAL(timeout()), this, SLOT(moveTxControls()));
 
     heliChannelOrder << ManualControlSettings::CHANNELGROUPS_COLLECTIVE <<
         ManualControlSettings::CHANNELGROUPS_THROTTLE <<
@@ -486,7 +484,11 @@ void ConfigInputWidget::resetTxControls()
 }
 
 ConfigInputWidget::~ConfigInputWidget()
-{}
+{
+    if (Core::AnimationClock::instance()) {
+        Core::AnimationClock::instance()->stop(this);
+    }
+}
 
 void ConfigInputWidget::enableControls(bool enable)
 {
@@ -1330,70 +1332,70 @@ void ConfigInputWidget::setTxMovement(txMovements movement)
         movePos = 0;
         growing = true;
         currentMovement = moveLeftVerticalStick;
-        animate->start(100);
+        Core::AnimationClock::instance()->start(this, 100);
         break;
     case moveRightVerticalStick:
         movePos = 0;
         growing = true;
         currentMovement = moveRightVerticalStick;
-        animate->start(100);
+        Core::AnimationClock::instance()->start(this, 100);
         break;
     case moveLeftHorizontalStick:
         movePos = 0;
         growing = true;
         currentMovement = moveLeftHorizontalStick;
-        animate->start(100);
+        Core::AnimationClock::instance()->start(this, 100);
         break;
     case moveRightHorizontalStick:
         movePos = 0;
         growing = true;
         currentMovement = moveRightHorizontalStick;
-        animate->start(100);
+        Core::AnimationClock::instance()->start(this, 100);
         break;
     case moveAccess0:
         movePos = 0;
         growing = true;
         currentMovement = moveAccess0;
-        animate->start(100);
+        Core::AnimationClock::instance()->start(this, 100);
         break;
     case moveAccess1:
         movePos = 0;
         growing = true;
         currentMovement = moveAccess1;
-        animate->start(100);
+        Core::AnimationClock::instance()->start(this, 100);
         break;
     case moveAccess2:
         movePos = 0;
         growing = true;
         currentMovement = moveAccess2;
-        animate->start(100);
+        Core::AnimationClock::instance()->start(this, 100);
         break;
     case moveAccess3:
         movePos = 0;
         growing = true;
         currentMovement = moveAccess3;
-        animate->start(100);
+        Core::AnimationClock::instance()->start(this, 100);
         break;
     case moveFlightMode:
         movePos = 0;
         growing = true;
         currentMovement = moveFlightMode;
-        animate->start(1000);
+        Core::AnimationClock::instance()->start(this, 1000);
         break;
     case centerAll:
         movePos = 0;
         currentMovement = centerAll;
-        animate->start(1000);
+        Core::AnimationClock::instance()->start(this, 1000);
         break;
     case moveAll:
         movePos = 0;
         growing = true;
         currentMovement = moveAll;
-        animate->start(50);
+        Core::AnimationClock::instance()->start(this, 50);
         break;
     case nothing:
         movePos = 0;
-        animate->stop();
+        Core::AnimationClock::instance()->stop(this);
         break;
     default:
         Q_ASSERT(0);
@@ -1401,6 +1403,17 @@ void ConfigInputWidget::setTxMovement(txMovements movement)
     }
 }
 
+/**
+ * Called by the animation clock at the pace set by setTxMovement(), one step per call
+ */
+bool ConfigInputWidget::advanceAnimation(qint64 elapsedMs)
+{
+    Q_UNUSED(elapsedMs);
+
+    moveTxControls();
+    return true;
+}
+
 void ConfigInputWidget::moveTxControls()
 {
     QTransform trans;
@@ -47,6 +47,8 @@
 #include <QList>
 #include <QTimer>
 
+#include <coreplugin/animationclock.h>
+
 class Ui_InputWidget;
 class Ui_InputWizardWidget;
 
@@ -55,7 +57,7 @@ class QSvgRenderer;
 class QGraphicsSvgItem;
 class QGraphicsSimpleTextItem;
 
-class ConfigInputWidget : public ConfigTaskWidget {
+class ConfigInputWidget : public ConfigTaskWidget, public Core::IAnimation {
     Q_OBJECT
 public:
     ConfigInputWidget(QWidget *parent = 0);
@@ -183,7 +185,7 @@ private:
     QTransform m_txFlightModeCountTextOrig;
     QTransform m_txMainBodyOrig;
     QTransform m_txArrowsOrig;
-    QTimer *animate;
+    bool advanceAnimation(qint64 elapsedMs);
     void resetTxControls();
     void setMoveFromCommand(int command);
 
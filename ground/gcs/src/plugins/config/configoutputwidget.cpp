@@ -253,8 +253,7 @@ void ConfigOutputWidget::assignOutputChannel(UAVDataObject *obj, QString &str)
 {
     // FIXME: use signal/ slot approach
     UAVObjectField *field = obj->getField(str);
-    QStringList options   = field->getOptions();
-    int index = options.indexOf(field->getValue().toString());
+    int index = field->getOptionIndex(field->getValue().toString());
 
     OutputChannelForm *outputChannelForm = getOutputChannelForm(index);
 
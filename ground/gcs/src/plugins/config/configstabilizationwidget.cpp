@@ -30,7 +30,6 @@
 #include "ui_stabilization.h"
 
 #include <uavobjectmanager.h>
-#include "objectpersistence.h"
 
 #include "altitudeholdsettings.h"
 #include "stabilizationsettings.h"
@@ -68,9 +67,6 @@ ConfigStabilizationWidget::ConfigStabilizationWidget(QWidget *parent) : ConfigTa
 
     setupExpoPlot();
 
-    realtimeUpdates = new QTimer(this);
-    connect(realtimeUpdates, SIGNAL(timeout()), this, SLOT(apply()));
-
     connect(ui->realTimeUpdates_6, SIGNAL(toggled(bool)), this, SLOT(realtimeUpdatesSlot(bool)));
     addWidget(ui->realTimeUpdates_6);
     connect(ui->realTimeUpdates_8, SIGNAL(toggled(bool)), this, SLOT(realtimeUpdatesSlot(bool)));
@@ -252,7 +248,7 @@ void ConfigStabilizationWidget::refreshWidgetsValuesImpl(UAVObject *obj)
 
     // Check and update basic/advanced checkboxes only if something connected
     // if something not "basic": Rate value out of slider limits or different Pitch/Roll values
-    if (ui->lowThrottleZeroIntegral_8->isEnabled() && !realtimeUpdates->isActive()) {
+    if (ui->lowThrottleZeroIntegral_8->isEnabled() && !isRealtimeUpdating()) {
         if ((ui->attitudeRollResponse->value() == ui->attitudePitchResponse->value()) &&
             (ui->rateRollResponse->value() == ui->ratePitchResponse->value()) &&
             (ui->rateRollResponse->value() <= ui->RateResponsivenessSlider->maximum()) &&
@@ -447,31 +443,17 @@ void ConfigStabilizationWidget::resetBank(int bank)
     }
 }
 
-void ConfigStabilizationWidget::restoreBank(int bank)
+void ConfigStabilizationWidget::restoreBanks(QList<int> banks)
 {
-    UAVObject *stabBankObject = getStabBankObject(bank);
+    QList<UAVDataObject *> stabBankObjects;
 
-    if (stabBankObject) {
-        ObjectPersistence *objectPersistenceObject = ObjectPersistence::GetInstance(getObjectManager());
-        QTimer updateTimer(this);
-        QEventLoop eventLoop(this);
-        connect(&updateTimer, SIGNAL(timeout()), &eventLoop, SLOT(quit()));
-        connect(objectPersistenceObject, SIGNAL(objectUpdated(UAVObject *)), &eventLoop, SLOT(quit()));
-
-        ObjectPersistence::DataFields data;
-        data.Operation  = ObjectPersistence::OPERATION_LOAD;
-        data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
-        data.ObjectID   = stabBankObject->getObjID();
-        data.InstanceID = stabBankObject->getInstID();
-        objectPersistenceObject->setData(data);
-        objectPersistenceObject->updated();
-        updateTimer.start(500);
-        eventLoop.exec();
-        if (updateTimer.isActive()) {
-            stabBankObject->requestUpdate();
+    foreach(int bank, banks) {
+        UAVDataObject *stabBankObject = dynamic_cast<UAVDataObject *>(getStabBankObject(bank));
+        if (stabBankObject) {
+            stabBankObjects.append(stabBankObject);
         }
-        updateTimer.stop();
     }
+    reloadObjects(stabBankObjects);
 }
 
 void ConfigStabilizationWidget::copyBank(int fromBank, int toBank)
@@ -529,11 +511,13 @@ void ConfigStabilizationWidget::bankAction(const QString &mapping)
     } else if (action == "restore") {
         int bank = list[1].toInt();
         Q_ASSERT((bank >= 0) && (bank < m_stabSettingsBankCount));
-        restoreBank(bank);
+        restoreBanks(QList<int>() << bank);
     } else if (action == "restoreAll") {
+        QList<int> banks;
         for (int bank = 0; bank < m_stabSettingsBankCount; bank++) {
-            restoreBank(bank);
+            banks.append(bank);
         }
+        restoreBanks(banks);
     } else if (action == "reset") {
         int bank = list[1].toInt();
         Q_ASSERT((bank >= 0) && (bank < m_stabSettingsBankCount));
@@ -552,10 +536,10 @@ void ConfigStabilizationWidget::realtimeUpdatesSlot(bool value)
     ui->realTimeUpdates_12->setChecked(value);
     ui->realTimeUpdates_7->setChecked(value);
 
-    if (value && !realtimeUpdates->isActive()) {
-        realtimeUpdates->start(AUTOMATIC_UPDATE_RATE);
-    } else if (!value && realtimeUpdates->isActive()) {
-        realtimeUpdates->stop();
+    if (value && !isRealtimeUpdating()) {
+        startRealtimeUpdates(REALTIME_UPDATE_RATE);
+    } else if (!value && isRealtimeUpdating()) {
+        stopRealtimeUpdates();
     }
 }
 
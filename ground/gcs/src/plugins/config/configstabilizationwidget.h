@@ -60,12 +60,11 @@ protected:
 
 private:
     Ui_StabilizationWidget *ui;
-    QTimer *realtimeUpdates;
     QList<QTabBar *> m_stabTabBars;
     QString m_stabilizationObjectsString;
 
-    // Milliseconds between automatic 'Instant Updates'
-    static const int AUTOMATIC_UPDATE_RATE   = 500;
+    // Most 'Instant Updates' per second, changes in between are sent together
+    static const int REALTIME_UPDATE_RATE    = 20;
 
     static const int EXPO_CURVE_POINTS_COUNT = 100;
     constexpr static const double EXPO_CURVE_CONSTANT = 1.01395948;
@@ -87,7 +86,7 @@ private:
     void setupExpoPlot();
     void setupStabBanksGUI();
     void resetBank(int bank);
-    void restoreBank(int bank);
+    void restoreBanks(QList<int> banks);
     void copyBank(int fromBank, int toBank);
     void swapBank(int fromBank, int toBank);
 
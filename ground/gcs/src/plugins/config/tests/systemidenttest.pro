@@ -0,0 +1,23 @@
+#
+# Identifies synthetic plants with known answers and checks the gains placed for them
+#
+
+include(../../../../gcs.pri)
+include(../../uavobjects/tests/uavobjectstest.pri)
+
+TARGET = systemidenttest
+
+QT += concurrent
+
+INCLUDEPATH += \
+    $$PLUGINS_DIR/config/autotune \
+    $$GCS_SOURCE_TREE/src/libs/eigen
+
+HEADERS += \
+    $$PLUGINS_DIR/config/autotune/systemident.h \
+    $$PLUGINS_DIR/config/autotune/systemidentengine.h
+
+SOURCES += \
+    tst_systemident.cpp \
+    $$PLUGINS_DIR/config/autotune/systemident.cpp \
+    $$PLUGINS_DIR/config/autotune/systemidentengine.cpp
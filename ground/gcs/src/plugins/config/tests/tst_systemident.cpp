@@ -0,0 +1,436 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_systemident.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Identifies synthetic plants with known answers and checks the gains placed for them
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "systemident.h"
+#include "systemidentengine.h"
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "systemidentstate.h"
+#include "systemidentsettings.h"
+
+#include <QtTest/QtTest>
+#include <QtTest/QSignalSpy>
+
+#include <QtCore/QObject>
+
+#include <cmath>
+#include <complex>
+#include <deque>
+#include <random>
+
+static const double SAMPLE_PERIOD = 0.002;
+static const double PLANT_TAU     = 0.0183; // exp(-4)
+static const double PLANT_DELAY   = 0.004;
+
+/**
+ * Rate loop flown with a P controller and a random excitation on the
+ * actuator, the plant integrated at ten times the sample rate.
+ * The actuator is held over a sample, which adds half a sample to the delay.
+ */
+static void simulateAxis(SystemIdent::LogSegment *log, int axis, double beta, double bias,
+                         double excitation, double gyroNoise, int samples, unsigned seed)
+{
+    const int substeps = 10;
+    double dt   = log->samplePeriod / substeps;
+    double gain = exp(beta);
+    double kp   = 20.0 / gain;
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> excite(0, excitation);
+    std::normal_distribution<double> noise(0, gyroNoise);
+    std::deque<double> delayLine((int)lround(PLANT_DELAY / dt), bias);
+    double rate  = 0;
+    double accel = 0;
+
+    for (int k = 0; k < samples; k++) {
+        double gyro     = rate + noise(rng);
+        double actuator = bias + excite(rng) - kp * gyro;
+        log->gyro[axis].append(gyro);
+        log->actuator[axis].append(actuator);
+        log->rateDesired[axis].append(0);
+        for (int i = 0; i < substeps; i++) {
+            delayLine.push_back(actuator);
+            double delayed = delayLine.front();
+            delayLine.pop_front();
+            accel += dt * (gain * (delayed - bias) - accel) / PLANT_TAU;
+            rate  += dt * accel;
+        }
+    }
+}
+
+/**
+ * Unit rate step through the rate PID, derivative filtered by tau_d.
+ * Returns the overshoot, the rate after one second in finalRate.
+ */
+static double stepOvershoot(const SystemIdent::Model &model, int axis, const double pid[3], double derivativeTau,
+                            double *finalRate)
+{
+    double dt   = 1e-5;
+    double gain = exp(model.beta[axis]);
+    std::deque<double> delayLine((int)lround(model.delay / dt), 0.0);
+    double rate  = 0;
+    double accel = 0;
+    double integral   = 0;
+    double derivative = 0;
+    double peak  = 0;
+
+    for (int k = 0; k < (int)(1.0 / dt); k++) {
+        double error = 1.0 - rate;
+        integral += error * dt;
+        double d = (error - derivative) / derivativeTau;
+        derivative += d * dt;
+        delayLine.push_back(pid[SystemIdent::KP] * error + pid[SystemIdent::KI] * integral + pid[SystemIdent::KD] * d);
+        double delayed = delayLine.front();
+        delayLine.pop_front();
+        accel += dt * (gain * delayed - accel) / model.tau;
+        rate  += dt * accel;
+        peak   = qMax(peak, rate);
+    }
+    *finalRate = rate;
+    return peak - 1.0;
+}
+
+static SystemIdentState::DataFields defaultState()
+{
+    SystemIdentState::DataFields state;
+
+    memset(&state, 0, sizeof(state));
+    state.Tau     = -4.0;
+    state.Beta[0] = 10.0;
+    state.Beta[1] = 10.0;
+    state.Beta[2] = 7.0;
+    state.GyroReadTimeAverage = 0.001;
+    return state;
+}
+
+static SystemIdentSettings::DataFields defaultSettings()
+{
+    SystemIdentSettings::DataFields settings;
+
+    memset(&settings, 0, sizeof(settings));
+    settings.DampMin   = 90;
+    settings.DampRate  = 110;
+    settings.DampMax   = 150;
+    settings.NoiseMin  = 6;
+    settings.NoiseRate = 10;
+    settings.NoiseMax  = 16;
+    settings.CalculateYaw = SystemIdentSettings::CALCULATEYAW_TRUELIMITTORATIO;
+    settings.YawToRollPitchPIDRatioMin = 1.0;
+    settings.YawToRollPitchPIDRatioMax = 2.5;
+    settings.DerivativeFactor     = 1.0;
+    settings.OuterLoopKpSoftClamp = 6.5;
+    settings.SmoothQuickValue     = 0.0;
+    return settings;
+}
+
+class tst_SystemIdent : public QObject {
+    Q_OBJECT
+
+private slots:
+    void welchMatchesFilter();
+    void identifiesPlant();
+    void shortLogFails();
+    void smoothQuick();
+    void placesPoles_data();
+    void placesPoles();
+    void yawRatio();
+    void engine();
+    void follow();
+};
+
+/**
+ * y[k] = a y[k-1] + (1 - a) x[k], the response is exact for white input
+ */
+void tst_SystemIdent::welchMatchesFilter()
+{
+    const double alpha = 0.8;
+
+    std::mt19937 rng(1);
+    std::normal_distribution<double> white(0, 1);
+    QVector<double> input;
+    QVector<double> output;
+    double y = 0;
+
+    for (int k = 0; k < 30000; k++) {
+        double x = white(rng);
+        y = alpha * y + (1 - alpha) * x;
+        input.append(x);
+        output.append(y);
+    }
+
+    QVector<SystemIdent::FrequencyPoint> response = SystemIdent::frequencyResponse(input, output, SAMPLE_PERIOD);
+    QCOMPARE(response.size(), SystemIdent::SEGMENT_LENGTH / 2);
+    QCOMPARE(response.first().frequency, 1.0 / (SystemIdent::SEGMENT_LENGTH * SAMPLE_PERIOD));
+
+    foreach(const SystemIdent::FrequencyPoint &point, response) {
+        double w = 2.0 * M_PI * point.frequency * SAMPLE_PERIOD;
+        std::complex<double> exact = (1 - alpha) / (1.0 - alpha * std::exp(std::complex<double>(0, -w)));
+        QVERIFY(fabs(point.magnitude - std::abs(exact)) < 0.02 * std::abs(exact) + 0.002);
+        QVERIFY(fabs(point.phase - std::arg(exact) * 180.0 / M_PI) < 2.0);
+        QVERIFY(point.coherence > 0.98);
+    }
+}
+
+/**
+ * Closed loop data, the excitation makes the actuator to gyro response
+ * coherent over the fitted range
+ */
+void tst_SystemIdent::identifiesPlant()
+{
+    const double beta[3] = { 10.0, 9.5, 7.0 };
+    const double bias[3] = { 0.02, -0.01, 0.05 };
+    SystemIdent::LogSegment log;
+
+    log.samplePeriod = SAMPLE_PERIOD;
+    for (int i = 0; i < SystemIdent::AXES; i++) {
+        simulateAxis(&log, i, beta[i], bias[i], i == SystemIdent::YAW ? 0.1 : 0.02, 1.0, 30000, 10 + i);
+    }
+
+    SystemIdent::Identification identification;
+    QVERIFY(SystemIdent::identify(log, &identification));
+
+    const SystemIdent::Model &model = identification.model;
+    for (int i = 0; i < SystemIdent::AXES; i++) {
+        QVERIFY(identification.axisValid[i]);
+        QVERIFY(fabs(model.beta[i] - beta[i]) < 0.15);
+        QVERIFY(fabs(model.bias[i] - bias[i]) < 0.005);
+        // Sample to sample gyro variance of the 1 deg/s noise
+        QVERIFY(model.noise[i] > 0.9 && model.noise[i] < 1.2);
+        QCOMPARE(identification.plant[i].size(), SystemIdent::SEGMENT_LENGTH / 2);
+    }
+    QVERIFY(fabs(model.tau - PLANT_TAU) < 0.2 * PLANT_TAU);
+    QVERIFY(fabs(model.delay - (PLANT_DELAY + SAMPLE_PERIOD / 2)) < 0.0015);
+}
+
+void tst_SystemIdent::shortLogFails()
+{
+    SystemIdent::LogSegment log;
+
+    log.samplePeriod = SAMPLE_PERIOD;
+    for (int i = 0; i < SystemIdent::AXES; i++) {
+        simulateAxis(&log, i, 10.0, 0.0, 0.02, 1.0, SystemIdent::SEGMENT_LENGTH - 1, 20 + i);
+    }
+
+    SystemIdent::Result result = SystemIdent::analyzeLog(log, SystemIdent::tuningFromSettings(defaultSettings()));
+    QVERIFY(result.fromLog);
+    QVERIFY(!result.identification.model.valid);
+    QVERIFY(!result.gains.valid);
+    QVERIFY(!result.error.isEmpty());
+}
+
+void tst_SystemIdent::smoothQuick()
+{
+    SystemIdentSettings::DataFields settings = defaultSettings();
+
+    settings.SmoothQuickValue = -1.0;
+    SystemIdent::Tuning smooth = SystemIdent::tuningFromSettings(settings);
+    QCOMPARE(smooth.damp, 1.5);
+    QCOMPARE(smooth.noise, 0.006);
+
+    settings.SmoothQuickValue = 0.0;
+    SystemIdent::Tuning rate = SystemIdent::tuningFromSettings(settings);
+    QCOMPARE(rate.damp, 1.1);
+    QCOMPARE(rate.noise, 0.01);
+
+    settings.SmoothQuickValue = 1.0;
+    SystemIdent::Tuning quick = SystemIdent::tuningFromSettings(settings);
+    QCOMPARE(quick.damp, 0.9);
+    QCOMPARE(quick.noise, 0.016);
+}
+
+void tst_SystemIdent::placesPoles_data()
+{
+    QTest::addColumn<double>("smoothQuick");
+
+    QTest::newRow("smooth") << -1.0;
+    QTest::newRow("rate") << 0.0;
+    QTest::newRow("quick") << 1.0;
+}
+
+/**
+ * Without the delay, the rate loop characteristic polynomial
+ *   tau tau_d s^4 + (tau + tau_d) s^3 + s^2 + B ((kp tau_d + kd) s^2 + (kp + ki tau_d) s + ki)
+ * has the damped pair at wn and the real poles a and b
+ */
+void tst_SystemIdent::placesPoles()
+{
+    QFETCH(double, smoothQuick);
+
+    SystemIdentSettings::DataFields settings = defaultSettings();
+    settings.SmoothQuickValue = smoothQuick;
+    SystemIdent::Tuning tuning = SystemIdent::tuningFromSettings(settings);
+    SystemIdent::Model model   = SystemIdent::modelFromState(defaultState());
+    SystemIdent::Gains gains   = SystemIdent::computeGains(model, tuning);
+
+    QVERIFY(gains.valid);
+    double wn   = gains.naturalFrequency;
+    double tauD = gains.derivativeTau;
+    double a    = gains.realPoles[0];
+    double b    = gains.realPoles[1];
+    double zeta = tuning.damp;
+
+    for (int i = SystemIdent::ROLL; i <= SystemIdent::PITCH; i++) {
+        const double *pid = gains.rate[i];
+        double B = exp(model.beta[i]);
+        double scale = model.tau * tauD;
+        double actual[4] = {
+            (model.tau + tauD) / scale,
+            (1 + B * (pid[SystemIdent::KP] * tauD + pid[SystemIdent::KD])) / scale,
+            B * (pid[SystemIdent::KP] + pid[SystemIdent::KI] * tauD) / scale,
+            B * pid[SystemIdent::KI] / scale
+        };
+        double expected[4] = {
+            a + b + 2 * zeta * wn,
+            a * b + wn * wn + 2 * zeta * wn * (a + b),
+            (a + b) * wn * wn + 2 * zeta * wn * a * b,
+            a * b * wn * wn
+        };
+        for (int k = 0; k < 4; k++) {
+            QVERIFY(fabs(actual[k] - expected[k]) < 1e-6 * fabs(expected[k]));
+        }
+
+        QVERIFY(gains.axisTuned[i]);
+        QVERIFY(gains.margins[i].crossover > 1.0);
+        QVERIFY(gains.margins[i].phaseMargin > 45.0);
+        QVERIFY(gains.margins[i].gainMargin > 12.0);
+
+        double finalRate;
+        double overshoot = stepOvershoot(model, i, pid, tauD, &finalRate);
+        QVERIFY(overshoot < 0.25);
+        QVERIFY(fabs(finalRate - 1.0) < 0.02);
+    }
+    for (int i = 0; i < SystemIdent::AXES; i++) {
+        QVERIFY(gains.attitude[i][0] <= settings.OuterLoopKpSoftClamp + 1e-6);
+        QVERIFY(gains.attitude[i][1] > 0);
+    }
+}
+
+void tst_SystemIdent::yawRatio()
+{
+    SystemIdentSettings::DataFields settings = defaultSettings();
+    SystemIdent::Model model = SystemIdent::modelFromState(defaultState());
+    SystemIdent::Gains gains = SystemIdent::computeGains(model, SystemIdent::tuningFromSettings(settings));
+
+    // A weaker yaw asks for more than the ratio allows
+    QVERIFY(gains.axisTuned[SystemIdent::YAW]);
+    double ratio = gains.rate[SystemIdent::YAW][SystemIdent::KP] / gains.rate[SystemIdent::PITCH][SystemIdent::KP];
+    QVERIFY(fabs(ratio - settings.YawToRollPitchPIDRatioMax) < 1e-6);
+    QVERIFY(gains.margins[SystemIdent::YAW].phaseMargin > 30.0);
+
+    settings.CalculateYaw = SystemIdentSettings::CALCULATEYAW_TRUEIGNORELIMIT;
+    gains = SystemIdent::computeGains(model, SystemIdent::tuningFromSettings(settings));
+    ratio = gains.rate[SystemIdent::YAW][SystemIdent::KP] / gains.rate[SystemIdent::PITCH][SystemIdent::KP];
+    QVERIFY(ratio > settings.YawToRollPitchPIDRatioMax);
+
+    settings.CalculateYaw = SystemIdentSettings::CALCULATEYAW_FALSE;
+    gains = SystemIdent::computeGains(model, SystemIdent::tuningFromSettings(settings));
+    QVERIFY(!gains.axisTuned[SystemIdent::YAW]);
+    QVERIFY(gains.valid);
+}
+
+/**
+ * The engine analyzes the board objects in the thread pool and matches the direct computation
+ */
+void tst_SystemIdent::engine()
+{
+    UAVObjectManager *objMngr = new UAVObjectManager();
+
+    UAVObjectsInitialize(objMngr);
+
+    SystemIdentState *state = SystemIdentState::GetInstance(objMngr);
+    SystemIdentState::DataFields data = state->getData();
+    data.Beta[SystemIdentState::BETA_PITCH] = 9.5;
+    state->setData(data);
+
+    SystemIdentEngine engine;
+    QSignalSpy finished(&engine, SIGNAL(finished(bool)));
+    QVERIFY(engine.analyze(objMngr));
+    QVERIFY(finished.wait(5000));
+    QCOMPARE(finished.first().at(0).toBool(), true);
+    QVERIFY(!engine.isRunning());
+
+    SystemIdent::Result expected = SystemIdent::analyzeState(SystemIdent::modelFromState(data),
+                                                             SystemIdent::tuningFromSettings(SystemIdentSettings::GetInstance(objMngr)->getData()));
+    SystemIdent::Result result   = engine.result();
+    QVERIFY(!result.fromLog);
+    QVERIFY(result.gains.valid);
+    for (int i = 0; i < SystemIdent::AXES; i++) {
+        for (int k = 0; k < 3; k++) {
+            QCOMPARE(result.gains.rate[i][k], expected.gains.rate[i][k]);
+        }
+    }
+
+    delete objMngr;
+}
+
+/**
+ * A followed engine analyzes the object updates and ends on the latest data
+ */
+void tst_SystemIdent::follow()
+{
+    UAVObjectManager *objMngr = new UAVObjectManager();
+
+    UAVObjectsInitialize(objMngr);
+
+    SystemIdentState *state       = SystemIdentState::GetInstance(objMngr);
+    SystemIdentSettings *settings = SystemIdentSettings::GetInstance(objMngr);
+
+    SystemIdentEngine engine;
+    QSignalSpy finished(&engine, SIGNAL(finished(bool)));
+    engine.follow(objMngr);
+
+    // Sent before the event loop runs, at most one analysis is queued behind the running one
+    SystemIdentState::DataFields data = state->getData();
+    data.Beta[SystemIdentState::BETA_PITCH] = 9.5;
+    state->setData(data);
+    SystemIdentSettings::DataFields tuning = settings->getData();
+    tuning.SmoothQuickValue = 0.5;
+    settings->setData(tuning);
+
+    SystemIdent::Result expected = SystemIdent::analyzeState(SystemIdent::modelFromState(data),
+                                                             SystemIdent::tuningFromSettings(tuning));
+    QVERIFY(expected.gains.valid);
+    QTRY_COMPARE_WITH_TIMEOUT(engine.result().gains.rate[SystemIdent::PITCH][SystemIdent::KP],
+                              expected.gains.rate[SystemIdent::PITCH][SystemIdent::KP], 5000);
+    QTRY_VERIFY(!engine.isRunning());
+    QVERIFY(finished.count() <= 3);
+    QCOMPARE(finished.last().at(0).toBool(), true);
+
+    // A preview replaces the settings without touching the object
+    tuning.SmoothQuickValue = -0.5;
+    engine.setSettings(tuning);
+    expected = SystemIdent::analyzeState(SystemIdent::modelFromState(data), SystemIdent::tuningFromSettings(tuning));
+    QTRY_COMPARE_WITH_TIMEOUT(engine.result().gains.rate[SystemIdent::PITCH][SystemIdent::KP],
+                              expected.gains.rate[SystemIdent::PITCH][SystemIdent::KP], 5000);
+    QCOMPARE(settings->getData().SmoothQuickValue, 0.5f);
+
+    delete objMngr;
+}
+
+QTEST_GUILESS_MAIN(tst_SystemIdent)
+
+#include "tst_systemident.moc"
@@ -0,0 +1,231 @@
+/**
+ ******************************************************************************
+ *
+ * @file       animationclock.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief      Single frame paced clock driving the animations of all gadgets
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "animationclock.h"
+
+#include <QtCore/QLoggingCategory>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
+
+// The wakeup rate every second while animations run, enable with
+// QT_LOGGING_RULES="gcs.animationclock.debug=true"
+Q_LOGGING_CATEGORY(animationClockLog, "gcs.animationclock", QtWarningMsg)
+
+using namespace Core;
+
+AnimationClock *AnimationClock::m_instance = 0;
+
+AnimationClock::AnimationClock(QObject *parent) : QObject(parent),
+    m_ticking(false),
+    m_frameInterval(16),
+    m_lastTick(0),
+    m_rateStart(0),
+    m_rateWakeups(0),
+    m_wakeupRate(0)
+{
+    m_instance = this;
+    m_clock.start();
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
+    // No screens without a GUI application, the clock then assumes 60 Hz
+    if (qobject_cast<QGuiApplication *>(qApp)) {
+        connect(qApp, SIGNAL(primaryScreenChanged(QScreen *)), this, SLOT(updateFrameInterval()));
+    }
+    updateFrameInterval();
+}
+
+AnimationClock::~AnimationClock()
+{
+    m_instance = 0;
+}
+
+/**
+ * Run an animation on the clock, it is advanced from the next tick on
+ * @param intervalMs Minimum time between two advances, 0 for every frame
+ */
+void AnimationClock::start(IAnimation *animation, int intervalMs)
+{
+    int index = indexOf(animation);
+
+    if (index >= 0) {
+        m_entries[index].interval = intervalMs;
+    } else {
+        Entry entry;
+        entry.animation = animation;
+        entry.interval  = intervalMs;
+        entry.elapsed   = 0;
+        m_entries.append(entry);
+    }
+    updateTimer();
+}
+
+/**
+ * Remove an animation, must be called before deleting a running animation
+ */
+void AnimationClock::stop(IAnimation *animation)
+{
+    int index = indexOf(animation);
+
+    if (index < 0) {
+        return;
+    }
+    if (m_ticking) {
+        // Removed at the end of the tick
+        m_entries[index].animation = 0;
+        return;
+    }
+    m_entries.remove(index);
+    updateTimer();
+}
+
+bool AnimationClock::isRunning(IAnimation *animation) const
+{
+    return indexOf(animation) >= 0;
+}
+
+int AnimationClock::runningCount() const
+{
+    int count = 0;
+
+    foreach(const Entry &entry, m_entries) {
+        if (entry.animation) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+int AnimationClock::indexOf(IAnimation *animation) const
+{
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).animation == animation) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Tick at the display refresh rate, or slower if only step animations run
+ */
+void AnimationClock::updateTimer()
+{
+    if (m_entries.isEmpty()) {
+        m_timer.stop();
+        setWakeupRate(0);
+        return;
+    }
+
+    int interval = -1;
+    foreach(const Entry &entry, m_entries) {
+        int entryInterval = qMax(entry.interval, m_frameInterval);
+        if (interval < 0 || entryInterval < interval) {
+            interval = entryInterval;
+        }
+    }
+    if (!m_timer.isActive()) {
+        m_lastTick    = m_clock.elapsed();
+        m_rateStart   = m_lastTick;
+        m_rateWakeups = 0;
+        m_timer.start(interval);
+    } else if (m_timer.interval() != interval) {
+        m_timer.setInterval(interval);
+    }
+}
+
+void AnimationClock::updateFrameInterval()
+{
+    QScreen *screen = QGuiApplication::primaryScreen();
+    qreal rate = screen ? screen->refreshRate() : 60.0;
+
+    m_frameInterval = qBound(4, qRound(1000.0 / (rate > 0 ? rate : 60.0)), 100);
+    if (m_timer.isActive()) {
+        updateTimer();
+    }
+}
+
+/**
+ * Advance all due animations in a row, their scene changes are repainted together
+ */
+void AnimationClock::tick()
+{
+    qint64 now     = m_clock.elapsed();
+    qint64 elapsed = now - m_lastTick;
+
+    m_lastTick = now;
+
+    m_ticking = true;
+    // Animations started during the tick are advanced on the next one
+    int count = m_entries.size();
+    for (int i = 0; i < count; ++i) {
+        Entry &entry = m_entries[i];
+        if (!entry.animation) {
+            continue;
+        }
+        entry.elapsed += elapsed;
+        // Half a frame early rather than a whole frame late
+        if (entry.elapsed + m_frameInterval / 2 < entry.interval) {
+            continue;
+        }
+        // The animation is given all the time since its last advance, not the interval
+        qint64 elapsedMs = entry.elapsed;
+        entry.elapsed = 0;
+        if (!entry.animation->advanceAnimation(elapsedMs)) {
+            // The entry may have moved if the animation started another one
+            m_entries[i].animation = 0;
+        }
+    }
+    m_ticking = false;
+
+    for (int i = m_entries.size() - 1; i >= 0; --i) {
+        if (!m_entries.at(i).animation) {
+            m_entries.remove(i);
+        }
+    }
+
+    ++m_rateWakeups;
+    if (now - m_rateStart >= 1000) {
+        setWakeupRate(m_rateWakeups * 1000.0 / (now - m_rateStart));
+        qCDebug(animationClockLog) << "AnimationClock -" << m_wakeupRate << "wakeups/s," << runningCount() << "animations";
+        m_rateStart   = now;
+        m_rateWakeups = 0;
+    }
+    updateTimer();
+}
+
+void AnimationClock::setWakeupRate(double rate)
+{
+    if (rate != m_wakeupRate) {
+        m_wakeupRate = rate;
+        emit wakeupRateChanged(rate);
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
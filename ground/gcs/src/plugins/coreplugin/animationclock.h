@@ -0,0 +1,126 @@
+/**
+ ******************************************************************************
+ *
+ * @file       animationclock.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief      Single frame paced clock driving the animations of all gadgets
+ *
+ * Instead of running its own timer, a gadget implements IAnimation and starts
+ * itself on the clock when it has something to animate:
+ *
+ *   Core::AnimationClock::instance()->start(this);
+ *
+ * All running animations are advanced in the same tick, paced to the refresh
+ * rate of the primary screen, so that the scene changes they make end up in
+ * one repaint. advanceAnimation() returns false when the animation is done.
+ * Step animations that do not need every frame pass their step interval to
+ * start() and are advanced on the closest tick. The timer only runs while an
+ * animation does.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef ANIMATIONCLOCK_H
+#define ANIMATIONCLOCK_H
+
+#include "core_global.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+#include <QtCore/QElapsedTimer>
+
+class QScreen;
+
+namespace Core {
+class CORE_EXPORT IAnimation {
+public:
+    virtual ~IAnimation() {}
+
+    // Called on the clock ticks with the time since the previous call, return false to stop
+    virtual bool advanceAnimation(qint64 elapsedMs) = 0;
+};
+
+class CORE_EXPORT AnimationClock : public QObject {
+    Q_OBJECT
+
+public:
+    AnimationClock(QObject *parent);
+    ~AnimationClock();
+
+    static AnimationClock *instance()
+    {
+        return m_instance;
+    }
+
+    // Every frame by default, a running animation gets its new interval
+    void start(IAnimation *animation, int intervalMs = 0);
+    void stop(IAnimation *animation);
+    bool isRunning(IAnimation *animation) const;
+    int runningCount() const;
+
+    int frameInterval() const
+    {
+        return m_frameInterval;
+    }
+    // The shared timer runs only while an animation does
+    bool isActive() const
+    {
+        return m_timer.isActive();
+    }
+    // Timer wakeups over the last second, 0 when stopped
+    double wakeupRate() const
+    {
+        return m_wakeupRate;
+    }
+
+signals:
+    void wakeupRateChanged(double wakeupsPerSecond);
+
+private slots:
+    void tick();
+    void updateFrameInterval();
+
+private:
+    struct Entry {
+        IAnimation *animation;
+        int interval;
+        qint64 elapsed;
+    };
+
+    static AnimationClock *m_instance;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QVector<Entry> m_entries;
+    bool m_ticking;
+    int m_frameInterval;
+    qint64 m_lastTick;
+    qint64 m_rateStart;
+    int m_rateWakeups;
+    double m_wakeupRate;
+
+    int indexOf(IAnimation *animation) const;
+    void updateTimer();
+    void setWakeupRate(double rate);
+};
+} // namespace Core
+
+#endif // ANIMATIONCLOCK_H
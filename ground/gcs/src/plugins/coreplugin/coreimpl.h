@@ -57,6 +57,7 @@ public:
     UAVGadgetInstanceManager *uavGadgetInstanceManager() const;
     VariableManager *variableManager() const;
     ThreadManager *threadManager() const;
+    AnimationClock *animationClock() const;
     ModeManager *modeManager() const;
     MimeDatabase *mimeDatabase() const;
 
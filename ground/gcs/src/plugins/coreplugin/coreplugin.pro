@@ -43,6 +43,7 @@ SOURCES += \
     coreplugin.cpp \
     variablemanager.cpp \
     threadmanager.cpp \
+    animationclock.cpp \
     modemanager.cpp \
     coreimpl.cpp \
     plugindialog.cpp \
@@ -99,6 +100,7 @@ HEADERS += \
     coreplugin.h \
     variablemanager.h \
     threadmanager.h \
+    animationclock.h \
     modemanager.h \
     coreimpl.h \
     plugindialog.h \
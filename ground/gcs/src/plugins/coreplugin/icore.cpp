@@ -155,6 +155,14 @@
     real time thread - anywhere in the application.
  */
 
+/*!
+    \fn AnimationClock *ICore::animationClock() const
+    \brief Returns the application's animation clock.
+
+    The animation clock advances the animations of all gadgets in a single
+    tick paced to the display refresh, and only runs while something animates.
+ */
+
 /*!
     \fn ModeManager *ICore::modeManager() const
     \brief Returns the application's mode manager.
@@ -51,6 +51,7 @@ class SettingsDatabase;
 class UniqueIDManager;
 class VariableManager;
 class ThreadManager;
+class AnimationClock;
 class UAVGadgetManager;
 class UAVGadgetInstanceManager;
 class IConfigurablePlugin;
@@ -79,6 +80,7 @@ public:
     virtual MessageManager *messageManager() const       = 0;
     virtual VariableManager *variableManager() const     = 0;
     virtual ThreadManager *threadManager() const         = 0;
+    virtual AnimationClock *animationClock() const       = 0;
     virtual ModeManager *modeManager() const = 0;
     virtual ConnectionManager *connectionManager() const = 0;
     virtual UAVGadgetInstanceManager *uavGadgetInstanceManager() const = 0;
@@ -56,6 +56,7 @@
 
 #include "settingsdialog.h"
 #include "threadmanager.h"
+#include "animationclock.h"
 #include "uniqueidmanager.h"
 #include "variablemanager.h"
 
@@ -113,6 +114,7 @@ MainWindow::MainWindow() :
     m_actionManager(new ActionManagerPrivate(this)),
     m_variableManager(new VariableManager(this)),
     m_threadManager(new ThreadManager(this)),
+    m_animationClock(new AnimationClock(this)),
     m_modeManager(0),
     m_connectionManager(0),
     m_mimeDatabase(new MimeDatabase),
@@ -848,6 +850,11 @@ ThreadManager *MainWindow::threadManager() const
     return m_threadManager;
 }
 
+AnimationClock *MainWindow::animationClock() const
+{
+    return m_animationClock;
+}
+
 ConnectionManager *MainWindow::connectionManager() const
 {
     return m_connectionManager;
@@ -61,6 +61,7 @@ class SettingsDatabase;
 class UniqueIDManager;
 class VariableManager;
 class ThreadManager;
+class AnimationClock;
 class ViewManagerInterface;
 class UAVGadgetManager;
 class UAVGadgetInstanceManager;
@@ -103,6 +104,7 @@ public:
     Core::ConnectionManager *connectionManager() const;
     Core::VariableManager *variableManager() const;
     Core::ThreadManager *threadManager() const;
+    Core::AnimationClock *animationClock() const;
     Core::ModeManager *modeManager() const;
     Core::MimeDatabase *mimeDatabase() const;
     Internal::GeneralSettings *generalSettings() const;
@@ -180,6 +182,7 @@ private:
     MessageManager *m_messageManager;
     VariableManager *m_variableManager;
     ThreadManager *m_threadManager;
+    AnimationClock *m_animationClock;
     ModeManager *m_modeManager;
     QList<UAVGadgetManager *> m_uavGadgetManagers;
     UAVGadgetInstanceManager *m_uavGadgetInstanceManager;
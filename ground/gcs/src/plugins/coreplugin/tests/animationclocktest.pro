@@ -0,0 +1,26 @@
+#
+# Shared animation clock: the timer runs only while an animation does, and
+# its wakeup rate
+#
+
+include(../../../../gcs.pri)
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = animationclocktest
+
+QT = core gui testlib
+
+CORE_DIR = $$GCS_SOURCE_TREE/src/plugins/coreplugin
+
+# Built into the test rather than linked with the Core plugin
+DEFINES += CORE_LIBRARY
+
+INCLUDEPATH += $$CORE_DIR
+
+HEADERS += $$CORE_DIR/animationclock.h
+
+SOURCES += \
+    tst_animationclock.cpp \
+    $$CORE_DIR/animationclock.cpp
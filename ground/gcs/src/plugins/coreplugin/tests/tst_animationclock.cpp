@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_animationclock.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Shared animation clock timer and wakeup rate
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "animationclock.h"
+
+#include <QtTest/QtTest>
+
+using namespace Core;
+
+class Animation : public IAnimation {
+public:
+    Animation() : advances(0), remaining(-1) {}
+
+    bool advanceAnimation(qint64 elapsedMs)
+    {
+        Q_UNUSED(elapsedMs);
+        ++advances;
+        return remaining < 0 || --remaining > 0;
+    }
+
+    int advances;
+    // Advances before the animation ends, -1 to run until stopped
+    int remaining;
+};
+
+class tst_AnimationClock : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void stopsWhenIdle();
+    void stopsWithLastAnimation();
+    void wakeupRate();
+
+private:
+    AnimationClock *m_clock;
+};
+
+void tst_AnimationClock::init()
+{
+    m_clock = new AnimationClock(this);
+}
+
+void tst_AnimationClock::cleanup()
+{
+    delete m_clock;
+}
+
+/**
+ * No animation, no timer. It starts with the first animation and stops with the last one.
+ */
+void tst_AnimationClock::stopsWhenIdle()
+{
+    Animation first;
+    Animation second;
+
+    QVERIFY(!m_clock->isActive());
+    m_clock->start(&first);
+    QVERIFY(m_clock->isActive());
+    m_clock->start(&second, 50);
+    QTRY_VERIFY(first.advances >= 3 && second.advances >= 1);
+
+    m_clock->stop(&first);
+    QVERIFY(m_clock->isActive());
+    m_clock->stop(&second);
+    QVERIFY(!m_clock->isActive());
+    QCOMPARE(m_clock->runningCount(), 0);
+
+    // Nothing is advanced any more
+    int advances = first.advances + second.advances;
+    QTest::qWait(100);
+    QCOMPARE(first.advances + second.advances, advances);
+
+    // and the timer restarts with the next animation
+    advances = first.advances;
+    m_clock->start(&first);
+    QVERIFY(m_clock->isActive());
+    QTRY_VERIFY(first.advances > advances);
+    m_clock->stop(&first);
+    QVERIFY(!m_clock->isActive());
+}
+
+/**
+ * An animation that ends by itself stops the timer on the same tick
+ */
+void tst_AnimationClock::stopsWithLastAnimation()
+{
+    Animation animation;
+
+    animation.remaining = 3;
+    m_clock->start(&animation);
+    QTRY_VERIFY(!m_clock->isActive());
+    QCOMPARE(animation.advances, 3);
+    QVERIFY(!m_clock->isRunning(&animation));
+
+    animation.remaining = 2;
+    m_clock->start(&animation);
+    QVERIFY(m_clock->isActive());
+    QTRY_VERIFY(!m_clock->isActive());
+    QCOMPARE(animation.advances, 5);
+}
+
+/**
+ * Measured every second while running, back to 0 when the timer stops
+ */
+void tst_AnimationClock::wakeupRate()
+{
+    Animation animation;
+    QSignalSpy changed(m_clock, SIGNAL(wakeupRateChanged(double)));
+
+    QCOMPARE(m_clock->wakeupRate(), 0.0);
+    m_clock->start(&animation, 20);
+    QTRY_VERIFY_WITH_TIMEOUT(m_clock->wakeupRate() > 0, 3000);
+
+    // At most one wakeup per 20 ms interval, and not much less
+    QVERIFY(m_clock->wakeupRate() <= 1000.0 / 20 + 5);
+    QVERIFY(m_clock->wakeupRate() >= 10);
+    QCOMPARE(changed.count(), 1);
+
+    m_clock->stop(&animation);
+    QCOMPARE(m_clock->wakeupRate(), 0.0);
+    QCOMPARE(changed.count(), 2);
+    QCOMPARE(changed.last().at(0).toDouble(), 0.0);
+}
+
+QTEST_GUILESS_MAIN(tst_AnimationClock)
+
+#include "tst_animationclock.moc"
@@ -59,14 +59,13 @@ DialGadgetWidget::DialGadgetWidget(QWidget *parent) : QGraphicsView(parent)
 
 // beSmooth = true;
     beSmooth = false;
-
-    // This timer mechanism makes needles rotate smoothly
-    connect(&dialTimer, SIGNAL(timeout()), this, SLOT(rotateNeedles()));
 }
 
 DialGadgetWidget::~DialGadgetWidget()
 {
-    // Do nothing
+    if (Core::AnimationClock::instance()) {
+        Core::AnimationClock::instance()->stop(this);
+    }
 }
 
 /*!
@@ -421,9 +420,7 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
         needle1Value = 0;
         needle2Value = 0;
         needle3Value = 0;
-        if (!dialTimer.isActive()) {
-            dialTimer.start();
-        }
+        Core::AnimationClock::instance()->start(this);
         dialError = false;
     } else {
         qDebug() << "no file: display default background.";
@@ -478,7 +475,7 @@ void DialGadgetWidget::setDialFont(QString fontProps)
 
 
 // Converts the value into an angle:
-// this enables smooth rotation in rotateNeedles below
+// this enables smooth rotation in advanceAnimation below
 void DialGadgetWidget::setNeedle1(double value)
 {
     if (rotateN1) {
@@ -490,9 +487,7 @@ void DialGadgetWidget::setNeedle1(double value)
     if (vertN1) {
         needle1Target = (value * n1Factor) / (n1MaxValue - n1MinValue);
     }
-    if (!dialTimer.isActive()) {
-        dialTimer.start();
-    }
+    Core::AnimationClock::instance()->start(this);
     if (m_text1) {
         QString s;
         s.sprintf("%.2f", value * n1Factor);
@@ -511,9 +506,7 @@ void DialGadgetWidget::setNeedle2(double value)
     if (vertN2) {
         needle2Target = (value * n2Factor) / (n2MaxValue - n2MinValue);
     }
-    if (!dialTimer.isActive()) {
-        dialTimer.start();
-    }
+    Core::AnimationClock::instance()->start(this);
     if (m_text2) {
         QString s;
         s.sprintf("%.2f", value * n2Factor);
@@ -532,9 +525,7 @@ void DialGadgetWidget::setNeedle3(double value)
     if (vertN3) {
         needle3Target = (value * n3Factor) / (n3MaxValue - n3MinValue);
     }
-    if (!dialTimer.isActive()) {
-        dialTimer.start();
-    }
+    Core::AnimationClock::instance()->start(this);
     if (m_text3) {
         QString s;
         s.sprintf("%.2f", value * n3Factor);
@@ -544,23 +535,25 @@ void DialGadgetWidget::setNeedle3(double value)
 
 // Take an input value and rotate the dial accordingly
 // Rotation is smooth, starts fast and slows down when
-// approaching the target.
+// approaching the target. The move follows the time elapsed since
+// the last frame, late frames do not slow it down.
 // We aim for a 0.5 degree precision.
 //
 // Note: this code is valid even if needle1 and needle2 point
 // to the same element.
-void DialGadgetWidget::rotateNeedles()
+bool DialGadgetWidget::advanceAnimation(qint64 elapsedMs)
 {
     if (dialError) {
         // We get there in case the dial file is missing or corrupt.
-        dialTimer.stop();
-        return;
+        return false;
     }
+    // Part of the way left covered since the last frame
+    double ease = 1.0 - pow(0.8, (double)elapsedMs / NEEDLE_STEP_MS);
     int dialRun = 3;
     if (n2enabled) {
         double needle2Diff;
         if (beSmooth && fabs(needle2Value - needle2Target) > 0.5) {
-            needle2Diff = (needle2Target - needle2Value) / 5;
+            needle2Diff = (needle2Target - needle2Value) * ease;
         } else {
             needle2Diff = needle2Target - needle2Value;
             dialRun--;
@@ -592,7 +585,7 @@ void DialGadgetWidget::rotateNeedles()
     // We assume that needle1 always exists!
     double needle1Diff;
     if (beSmooth && fabs(needle1Value - needle1Target) > 0.5) {
-        needle1Diff = (needle1Target - needle1Value) / 5;
+        needle1Diff = (needle1Target - needle1Value) * ease;
     } else {
         needle1Diff = needle1Target - needle1Value;
         dialRun--;
@@ -616,7 +609,7 @@ void DialGadgetWidget::rotateNeedles()
     if (n3enabled) {
         double needle3Diff;
         if (beSmooth && fabs(needle3Value - needle3Target) > 0.5) {
-            needle3Diff = (needle3Target - needle3Value) / 5;
+            needle3Diff = (needle3Target - needle3Value) * ease;
         } else {
             needle3Diff = needle3Target - needle3Value;
             dialRun--;
@@ -640,9 +633,7 @@ void DialGadgetWidget::rotateNeedles()
         dialRun--;
     }
 
-    // Now check: if dialRun is now zero, we should
-    // just stop the timer since all needles have finished moving
-    if (!dialRun) {
-        dialTimer.stop();
-    }
+    // Now check: if dialRun is now zero, all needles
+    // have finished moving and the animation stops
+    return dialRun > 0;
 }
@@ -0,0 +1,134 @@
+/**
+ ******************************************************************************
+ *
+ * @file       debuglogbuffer.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Compact storage of downloaded flight side log entries
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "debuglogbuffer.h"
+
+#include <string.h>
+
+DebugLogBuffer::DebugLogBuffer()
+{}
+
+void DebugLogBuffer::clear()
+{
+    m_records.clear();
+    m_offsets.clear();
+}
+
+int DebugLogBuffer::append(const Entry &entry)
+{
+    if (entry.Type == DebugLogEntry::TYPE_EMPTY) {
+        return 0;
+    }
+
+    const quint32 data_len = DebugLogEntry::DATA_NUMELEM;
+
+    m_offsets.append(m_records.size());
+    appendRecord(&m_records, entry, qMin((quint32)entry.Size, data_len));
+    int appended = 1;
+
+    if (entry.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        const quint32 header_len = HEADER_SIZE;
+
+        Entry fields;
+        quint32 start = entry.Size;
+
+        // cycle until there is space for another object
+        while (start + header_len + 1 < data_len) {
+            memset(&fields, 0xFF, sizeof(Entry));
+            memcpy(&fields, &entry.Data[start], header_len);
+            // check wether a packed object is found
+            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
+            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
+            quint32 toread = header_len + fields.Size;
+            if (!(toread + start > data_len)) {
+                memcpy(&fields, &entry.Data[start], toread);
+                m_offsets.append(m_records.size());
+                appendRecord(&m_records, fields, fields.Size);
+                appended++;
+            }
+            start += toread;
+        }
+    }
+    return appended;
+}
+
+DebugLogBuffer::Entry DebugLogBuffer::at(int index) const
+{
+    Entry entry;
+
+    int offset = m_offsets.at(index);
+
+    readRecord(m_records.constData() + offset, m_records.size() - offset, &entry);
+    return entry;
+}
+
+void DebugLogBuffer::writeRecord(QByteArray *out, const Entry &entry)
+{
+    int length = 0;
+
+    if (entry.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        // The objects packed after the first one are only delimited by the erased flash after them
+        length = DebugLogEntry::DATA_NUMELEM;
+        while (length > 0 && entry.Data[length - 1] == 0xFF) {
+            length--;
+        }
+    } else if (entry.Type != DebugLogEntry::TYPE_EMPTY) {
+        length = qMin((int)entry.Size, (int)DebugLogEntry::DATA_NUMELEM);
+    }
+    appendRecord(out, entry, length);
+}
+
+int DebugLogBuffer::readRecord(const char *data, int size, Entry *entry)
+{
+    quint16 length;
+
+    if (size < (int)sizeof(length)) {
+        return 0;
+    }
+    memcpy(&length, data, sizeof(length));
+
+    int recordSize = sizeof(length) + HEADER_SIZE + length;
+    if (length > DebugLogEntry::DATA_NUMELEM || size < recordSize) {
+        return 0;
+    }
+
+    // Unused data reads as erased flash for packed objects, and terminates text
+    memset(entry, 0, sizeof(Entry));
+    memcpy(entry, data + sizeof(length), HEADER_SIZE + length);
+    if (entry->Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        memset(&entry->Data[length], 0xFF, DebugLogEntry::DATA_NUMELEM - length);
+    }
+    return recordSize;
+}
+
+void DebugLogBuffer::appendRecord(QByteArray *out, const Entry &entry, int dataLength)
+{
+    quint16 length = dataLength;
+
+    out->append((const char *)&length, sizeof(length));
+    out->append((const char *)&entry, HEADER_SIZE + length);
+}
@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ *
+ * @file       debuglogbuffer.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Compact storage of downloaded flight side log entries
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DEBUGLOGBUFFER_H
+#define DEBUGLOGBUFFER_H
+
+#include "debuglogentry.h"
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * Append only list of log entries. Each entry is a record of its data length,
+ * the DebugLogEntry header and only the data bytes in use, instead of a
+ * DebugLogEntry object per entry. The records are also the format of the
+ * download checkpoint files.
+ *
+ * Entries holding several objects are split into one entry per object, the
+ * first keeps the TYPE_MULTIPLEUAVOBJECTS type.
+ */
+class DebugLogBuffer {
+public:
+    typedef DebugLogEntry::DataFields Entry;
+
+    // Flight, FlightTime, Entry, Type, ObjectID, InstanceID and Size
+    static const int HEADER_SIZE = sizeof(Entry) - DebugLogEntry::DATA_NUMELEM;
+
+    DebugLogBuffer();
+
+    void clear();
+
+    int count() const
+    {
+        return m_offsets.size();
+    }
+
+    int byteSize() const
+    {
+        return m_records.size();
+    }
+
+    // Returns how many entries were appended, none for an empty entry
+    int append(const Entry &entry);
+    Entry at(int index) const;
+
+    // Record of an entry as received from the board, before it is split
+    static void writeRecord(QByteArray *out, const Entry &entry);
+    // Returns the size of the record read, 0 if it is incomplete
+    static int readRecord(const char *data, int size, Entry *entry);
+
+private:
+    QByteArray m_records;
+    QVector<int> m_offsets;
+
+    static void appendRecord(QByteArray *out, const Entry &entry, int dataLength);
+};
+
+#endif // DEBUGLOGBUFFER_H
@@ -0,0 +1,326 @@
+/**
+ ******************************************************************************
+ *
+ * @file       debuglogdownloader.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Downloads the flight side log entries
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "debuglogdownloader.h"
+
+#include "uavobjectmanager.h"
+#include "debuglogcontrol.h"
+#include "debuglogentry.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+DebugLogDownloader::DebugLogDownloader(UAVObjectManager *objMngr, QObject *parent) : QObject(parent),
+    m_retries(3),
+    m_running(false),
+    m_cancelled(false),
+    m_firstFlight(0),
+    m_lastFlight(0),
+    m_failures(0),
+    m_next(NONE),
+    m_loaded(NONE),
+    m_loading(NONE),
+    m_requesting(NONE),
+    m_verifying(false),
+    m_identity(0),
+    m_resumeAt(NONE),
+    m_resumed(0),
+    m_received(0),
+    m_bytes(0)
+{
+    m_control = DebugLogControl::GetInstance(objMngr);
+    Q_ASSERT(m_control);
+
+    m_entry   = DebugLogEntry::GetInstance(objMngr);
+    Q_ASSERT(m_entry);
+}
+
+DebugLogDownloader::~DebugLogDownloader()
+{}
+
+double DebugLogDownloader::entriesPerSecond() const
+{
+    return m_received * 1000.0 / qMax((qint64)1, m_timer.elapsed());
+}
+
+double DebugLogDownloader::bytesPerSecond() const
+{
+    return m_bytes * 1000.0 / qMax((qint64)1, m_timer.elapsed());
+}
+
+bool DebugLogDownloader::start(int firstFlight, int lastFlight)
+{
+    if (m_running) {
+        return false;
+    }
+    m_buffer.clear();
+    m_cancelled   = false;
+    m_firstFlight = firstFlight;
+    m_lastFlight  = lastFlight;
+    m_failures    = 0;
+    m_next        = slot(firstFlight, 0);
+    m_loaded      = NONE;
+    m_loading     = NONE;
+    m_requesting  = NONE;
+    m_verifying   = false;
+    m_identity    = 0;
+    m_resumeAt    = NONE;
+    m_resumed     = 0;
+    m_received    = 0;
+    m_bytes       = 0;
+
+    openCheckpoint();
+
+    connect(m_control, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(controlCompleted(UAVObject *, bool)));
+    connect(m_entry, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(entryCompleted(UAVObject *, bool)));
+    m_running = true;
+    m_timer.start();
+    pump();
+    return true;
+}
+
+void DebugLogDownloader::cancel()
+{
+    if (!m_running) {
+        return;
+    }
+    m_cancelled = true;
+    pump();
+}
+
+/**
+ * Reads back the entries of an earlier download of the same flights, or starts a new file
+ */
+void DebugLogDownloader::openCheckpoint()
+{
+    m_checkpoint.close();
+    if (m_checkpointFileName.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(QFileInfo(m_checkpointFileName).absolutePath());
+    m_checkpoint.setFileName(m_checkpointFileName);
+    if (!m_checkpoint.open(QIODevice::ReadWrite)) {
+        qWarning() << "DebugLogDownloader - could not open" << m_checkpointFileName << m_checkpoint.errorString();
+        return;
+    }
+
+    QByteArray data = m_checkpoint.readAll();
+    QDataStream header(data);
+    header.setVersion(QDataStream::Qt_5_6);
+    quint32 magic    = 0;
+    quint32 version  = 0;
+    qint32 first     = -1;
+    qint32 last      = -1;
+    quint32 identity = 0;
+    header >> magic >> version >> first >> last >> identity;
+
+    int length = 0;
+    if (header.status() == QDataStream::Ok && magic == CHECKPOINT_MAGIC && version == CHECKPOINT_VERSION
+        && first == m_firstFlight && last == m_lastFlight) {
+        length = HEADER_LENGTH;
+        DebugLogBuffer::Entry entry;
+        int size;
+        while ((size = DebugLogBuffer::readRecord(data.constData() + length, data.size() - length, &entry)) > 0) {
+            m_buffer.append(entry);
+            m_next = (entry.Type == DebugLogEntry::TYPE_EMPTY) ? slot(entry.Flight + 1, 0) : slot(entry.Flight, entry.Entry + 1);
+            m_resumed++;
+            length += size;
+        }
+    }
+
+    // Drops a record cut short, or the file of other flights
+    if (length == 0) {
+        writeHeader(0);
+    } else {
+        m_checkpoint.resize(length);
+        m_checkpoint.seek(length);
+        m_checkpoint.flush();
+    }
+    if (m_resumed > 0) {
+        qDebug() << "DebugLogDownloader - resuming after" << m_resumed << "entries from" << m_checkpointFileName;
+        m_verifying = true;
+        m_identity  = identity;
+        m_resumeAt  = m_next;
+        m_next      = slot(m_firstFlight, 0);
+    }
+}
+
+/**
+ * Starts the file over, with the flight time of the first entry once it is known
+ */
+void DebugLogDownloader::writeHeader(quint32 identity)
+{
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << CHECKPOINT_MAGIC << CHECKPOINT_VERSION << (qint32)m_firstFlight << (qint32)m_lastFlight << identity;
+    m_checkpoint.resize(0);
+    m_checkpoint.seek(0);
+    m_checkpoint.write(header);
+    m_checkpoint.flush();
+}
+
+/**
+ * Keeps one entry request and one control load in progress
+ */
+void DebugLogDownloader::pump()
+{
+    if (!m_running) {
+        return;
+    }
+    if (m_cancelled || m_failures > m_retries || flight(m_next) > m_lastFlight) {
+        // The board objects are shared, so leave only once they are free again
+        if (m_loading == NONE && m_requesting == NONE) {
+            finish(!m_cancelled && m_failures <= m_retries);
+        }
+        return;
+    }
+    if (m_requesting == NONE && m_loaded == m_next) {
+        m_requesting = m_next;
+        m_entry->requestUpdate();
+    }
+    if (m_loading == NONE) {
+        // The board answers the request before it handles the next load
+        qint64 target = (m_requesting == NONE) ? m_next : m_next + 1;
+        if (m_loaded != target) {
+            load(target);
+        }
+    }
+}
+
+void DebugLogDownloader::load(qint64 target)
+{
+    DebugLogControl::DataFields control = m_control->getData();
+
+    control.Operation = DebugLogControl::OPERATION_RETRIEVE;
+    control.Flight    = flight(target);
+    control.Entry     = entry(target);
+    m_control->setData(control);
+    m_loading = target;
+    m_control->updated();
+}
+
+void DebugLogDownloader::controlCompleted(UAVObject *, bool success)
+{
+    if (m_loading == NONE) {
+        return;
+    }
+    if (success) {
+        m_loaded = m_loading;
+    } else {
+        m_loaded = NONE;
+        m_failures++;
+    }
+    m_loading = NONE;
+    pump();
+}
+
+void DebugLogDownloader::entryCompleted(UAVObject *, bool success)
+{
+    if (m_requesting == NONE) {
+        return;
+    }
+    qint64 requested = m_requesting;
+    m_requesting = NONE;
+
+    if (!success) {
+        // Asked again, once more loaded if the board went on to the next entry
+        m_failures++;
+        pump();
+        return;
+    }
+
+    DebugLogBuffer::Entry data = m_entry->getData();
+    if (slot(data.Flight, data.Entry) != requested) {
+        // The request overtook the load, or the load was lost
+        qDebug() << "DebugLogDownloader - got entry" << data.Flight << data.Entry << "instead of" << flight(requested) << entry(requested);
+        m_failures++;
+        m_loaded = NONE;
+        pump();
+        return;
+    }
+    m_failures = 0;
+    if (m_verifying) {
+        m_verifying = false;
+        if (data.FlightTime == m_identity) {
+            m_next = m_resumeAt;
+            pump();
+            return;
+        }
+        qDebug() << "DebugLogDownloader - the board log changed since" << m_checkpointFileName << "was written, starting over";
+        m_buffer.clear();
+        m_resumed = 0;
+    }
+    received(data);
+    m_next     = (data.Type == DebugLogEntry::TYPE_EMPTY) ? slot(data.Flight + 1, 0) : requested + 1;
+    emit progress(m_resumed + m_received, entriesPerSecond());
+    pump();
+}
+
+void DebugLogDownloader::received(const DebugLogBuffer::Entry &entry)
+{
+    m_buffer.append(entry);
+    m_received++;
+    m_bytes += sizeof(DebugLogBuffer::Entry);
+
+    if (m_checkpoint.isOpen()) {
+        // The file holds no entries before the first one
+        if (slot(entry.Flight, entry.Entry) == slot(m_firstFlight, 0)) {
+            writeHeader(entry.FlightTime);
+        }
+        QByteArray record;
+        DebugLogBuffer::writeRecord(&record, entry);
+        m_checkpoint.write(record);
+        m_checkpoint.flush();
+    }
+}
+
+void DebugLogDownloader::finish(bool success)
+{
+    m_control->disconnect(this);
+    m_entry->disconnect(this);
+    m_running = false;
+
+    // Entries of a checkpoint the board did not confirm are not shown
+    if (m_verifying) {
+        m_verifying = false;
+        m_buffer.clear();
+        m_resumed = 0;
+    }
+    if (m_checkpoint.isOpen()) {
+        m_checkpoint.close();
+        if (success) {
+            m_checkpoint.remove();
+        }
+    }
+    qDebug() << "DebugLogDownloader -" << m_received << "entries," << qRound(entriesPerSecond()) << "entries/s,"
+             << qRound(bytesPerSecond()) << "bytes/s" << (success ? "" : "- incomplete");
+    emit finished(success);
+}
@@ -0,0 +1,175 @@
+/**
+ ******************************************************************************
+ *
+ * @file       debuglogdownloader.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Downloads the flight side log entries
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DEBUGLOGDOWNLOADER_H
+#define DEBUGLOGDOWNLOADER_H
+
+#include "debuglogbuffer.h"
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+
+class UAVObject;
+class UAVObjectManager;
+class DebugLogControl;
+class DebugLogEntry;
+
+/**
+ * The board loads one entry at a time into its DebugLogEntry, when told to by
+ * DebugLogControl, and telemetry runs one transaction per object. So instead
+ * of waiting for the control ack and then for the entry, the entry request is
+ * followed right away by the control loading the next entry: the board handles
+ * both in order, and each entry costs one round trip instead of two.
+ *
+ * Every entry received carries its flight and entry number, one that is not
+ * the entry asked for is loaded and requested again.
+ *
+ * With a checkpoint file, the entries are appended to it as they come and a
+ * download of the same flights starts after the last one. The board log could
+ * have been erased and written again since, so the first entry is downloaded
+ * again and its flight time compared to the one of the file before resuming.
+ * The file is removed once the download completes.
+ */
+class DebugLogDownloader : public QObject {
+    Q_OBJECT
+
+public:
+    DebugLogDownloader(UAVObjectManager *objMngr, QObject *parent = 0);
+    ~DebugLogDownloader();
+
+    void setCheckpointFile(const QString &fileName)
+    {
+        m_checkpointFileName = fileName;
+    }
+
+    // Consecutive failed or mismatched transactions before giving up
+    void setRetries(int retries)
+    {
+        m_retries = retries;
+    }
+
+    bool isRunning() const
+    {
+        return m_running;
+    }
+
+    const DebugLogBuffer &buffer() const
+    {
+        return m_buffer;
+    }
+
+    // Board entries read back from the checkpoint
+    int entriesResumed() const
+    {
+        return m_resumed;
+    }
+
+    // Board entries received, and how fast, since start
+    int entriesReceived() const
+    {
+        return m_received;
+    }
+    double entriesPerSecond() const;
+    double bytesPerSecond() const;
+
+    // The flights are downloaded up to and including the last one
+    bool start(int firstFlight, int lastFlight);
+
+public slots:
+    // Waits for the transactions in progress, then finishes unsuccessfully
+    void cancel();
+
+signals:
+    void progress(int entries, double entriesPerSecond);
+    void finished(bool success);
+
+private slots:
+    void controlCompleted(UAVObject *obj, bool success);
+    void entryCompleted(UAVObject *obj, bool success);
+
+private:
+    static const quint32 CHECKPOINT_MAGIC   = 0x44424c47; // "DBLG"
+    static const quint32 CHECKPOINT_VERSION = 2;
+    // Magic, version, first and last flight, flight time of the first entry
+    static const int HEADER_LENGTH = 5 * sizeof(quint32);
+    static const qint64 NONE = -1;
+
+    DebugLogControl *m_control;
+    DebugLogEntry *m_entry;
+    DebugLogBuffer m_buffer;
+    QString m_checkpointFileName;
+    QFile m_checkpoint;
+    int m_retries;
+
+    bool m_running;
+    bool m_cancelled;
+    int m_firstFlight;
+    int m_lastFlight;
+    int m_failures;
+
+    // Entry to download next, the entry the board was last told to load,
+    // and the entries of the transactions in progress
+    qint64 m_next;
+    qint64 m_loaded;
+    qint64 m_loading;
+    qint64 m_requesting;
+
+    // While the first entry is checked against the checkpoint,
+    // where to go on from if it is the same
+    bool m_verifying;
+    quint32 m_identity;
+    qint64 m_resumeAt;
+
+    QElapsedTimer m_timer;
+    int m_resumed;
+    int m_received;
+    qint64 m_bytes;
+
+    void openCheckpoint();
+    void writeHeader(quint32 identity);
+    void received(const DebugLogBuffer::Entry &entry);
+    void pump();
+    void load(qint64 slot);
+    void finish(bool success);
+
+    static qint64 slot(int flight, int entry)
+    {
+        return ((qint64)flight << 16) | entry;
+    }
+    static int flight(qint64 slot)
+    {
+        return slot >> 16;
+    }
+    static int entry(qint64 slot)
+    {
+        return slot & 0xFFFF;
+    }
+};
+
+#endif // DEBUGLOGDOWNLOADER_H
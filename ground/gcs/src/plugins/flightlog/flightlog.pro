@@ -11,11 +11,15 @@ include(../../plugins/uavtalk/uavtalk.pri)
 
 HEADERS += \
     flightlogplugin.h \
-    flightlogmanager.h
+    flightlogmanager.h \
+    debuglogbuffer.h \
+    debuglogdownloader.h
 
 SOURCES += \
     flightlogplugin.cpp \
-    flightlogmanager.cpp
+    flightlogmanager.cpp \
+    debuglogbuffer.cpp \
+    debuglogdownloader.cpp
 
 OTHER_FILES += \
     Flightlog.pluginspec \
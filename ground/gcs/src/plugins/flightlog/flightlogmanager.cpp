@@ -26,9 +26,11 @@
  */
 
 #include "flightlogmanager.h"
+#include "debuglogdownloader.h"
 #include "extensionsystem/pluginmanager.h"
 
 #include <QApplication>
+#include <QFile>
 #include <QFileDialog>
 #include <QXmlStreamReader>
 #include <QMessageBox>
@@ -38,6 +40,7 @@
 #include "uavobjecthelper.h"
 #include "uavtalk/uavtalk.h"
 #include "utils/logfile.h"
+#include "utils/pathutils.h"
 #include "uavdataobject.h"
 #include <uavobjectutil/uavobjectutilmanager.h>
 
@@ -75,6 +78,10 @@ FlightLogManager::FlightLogManager(QObject *parent) :
     m_objectPersistence = ObjectPersistence::GetInstance(m_objectManager);
     Q_ASSERT(m_objectPersistence);
 
+    m_logEntries = new DebugLogEntryModel(m_objectManager, this);
+    m_downloader = new DebugLogDownloader(m_objectManager, this);
+    connect(m_downloader, SIGNAL(finished(bool)), this, SLOT(downloadFinished(bool)));
+
     updateFlightEntries(m_flightLogStatus->getFlight());
 
     setupLogSettings();
@@ -88,40 +95,11 @@ FlightLogManager::FlightLogManager(QObject *parent) :
 
 FlightLogManager::~FlightLogManager()
 {
-    while (!m_logEntries.isEmpty()) {
-        delete m_logEntries.takeFirst();
-    }
     while (!m_uavoEntries.isEmpty()) {
         delete m_uavoEntries.takeFirst();
     }
 }
 
-void addLogEntries(QQmlListProperty<ExtendedDebugLogEntry> *list, ExtendedDebugLogEntry *entry)
-{
-    Q_UNUSED(list);
-    Q_UNUSED(entry);
-}
-
-int countLogEntries(QQmlListProperty<ExtendedDebugLogEntry> *list)
-{
-    return static_cast< QList<ExtendedDebugLogEntry *> *>(list->data)->size();
-}
-
-ExtendedDebugLogEntry *logEntryAt(QQmlListProperty<ExtendedDebugLogEntry> *list, int index)
-{
-    return static_cast< QList<ExtendedDebugLogEntry *> *>(list->data)->at(index);
-}
-
-void clearLogEntries(QQmlListProperty<ExtendedDebugLogEntry> *list)
-{
-    return static_cast< QList<ExtendedDebugLogEntry *> *>(list->data)->clear();
-}
-
-QQmlListProperty<ExtendedDebugLogEntry> FlightLogManager::logEntries()
-{
-    return QQmlListProperty<ExtendedDebugLogEntry>(this, &m_logEntries, &addLogEntries, &countLogEntries, &logEntryAt, &clearLogEntries);
-}
-
 void addUAVOEntries(QQmlListProperty<UAVOLogSettingsWrapper> *list, UAVOLogSettingsWrapper *entry)
 {
     Q_UNUSED(list);
@@ -168,6 +146,12 @@ void FlightLogManager::clearAllLogs()
         // Then empty locally
         clearLogList();
     }
+    // The entries of an interrupted download are gone from the board too,
+    // even if only the ack was lost
+    QString checkpoint = checkpointFileName();
+    if (!checkpoint.isEmpty()) {
+        QFile::remove(checkpoint);
+    }
 
     QApplication::restoreOverrideCursor();
     setDisableControls(false);
@@ -175,24 +159,20 @@ void FlightLogManager::clearAllLogs()
 
 void FlightLogManager::clearLogList()
 {
-    QList<ExtendedDebugLogEntry *> tmpList(m_logEntries);
-    m_logEntries.clear();
+    m_logEntries->setEntries(DebugLogBuffer());
 
     emit logEntriesChanged();
     setDisableExport(true);
-
-    while (!tmpList.isEmpty()) {
-        delete tmpList.takeFirst();
-    }
 }
 
 void FlightLogManager::retrieveLogs(int flightToRetrieve)
 {
+    if (m_downloader->isRunning()) {
+        return;
+    }
     setDisableControls(true);
     QApplication::setOverrideCursor(Qt::WaitCursor);
     m_cancelDownload = false;
-    UAVObjectUpdaterHelper updateHelper;
-    UAVObjectRequestHelper requestHelper;
 
     clearLogList();
 
@@ -200,83 +180,45 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     int startFlight = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
     int endFlight   = (flightToRetrieve == -1) ? m_flightLogStatus->getFlight() : flightToRetrieve;
 
-    // Prepare to send request for event retrieval
-    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
-    for (int flight = startFlight; flight <= endFlight; flight++) {
-        m_flightLogControl->setFlight(flight);
-        bool gotLast = false;
-        int slot     = 0;
-        while (!gotLast) {
-            // Send request for loading flight entry on flight side and wait for ack/nack
-            m_flightLogControl->setEntry(slot);
-
-            if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
-                requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
-                if (m_flightLogEntry->getType() != DebugLogEntry::TYPE_EMPTY) {
-                    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
-                    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
-
-                    logEntry->setData(m_flightLogEntry->getData(), m_objectManager);
-                    m_logEntries << logEntry;
-                    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-                        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
-                        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
-                        const quint32 header_len = total_len - data_len;
-
-                        DebugLogEntry::DataFields fields;
-                        quint32 start = logEntry->getData().Size;
-
-                        // cycle until there is space for another object
-                        while (start + header_len + 1 < data_len) {
-                            memset(&fields, 0xFF, total_len);
-                            memcpy(&fields, &logEntry->getData().Data[start], header_len);
-                            // check wether a packed object is found
-                            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
-                            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
-                            quint32 toread = header_len + fields.Size;
-                            if (!(toread + start > data_len)) {
-                                memcpy(&fields, &logEntry->getData().Data[start], toread);
-                                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
-                                subEntry->setData(fields, m_objectManager);
-                                m_logEntries << subEntry;
-                            }
-                            start += toread;
-                        }
-                    }
-
-                    // Increment to get next entry from flight side
-                    slot++;
-                } else {
-                    // We are done, not more entries on this flight
-                    gotLast = true;
-                }
-            } else {
-                // We failed for some reason
-                break;
-            }
-            if (m_cancelDownload) {
-                break;
-            }
-        }
-        if (m_cancelDownload) {
-            break;
-        }
-    }
+    // An interrupted download of the same flights continues where it stopped
+    m_downloader->setCheckpointFile(checkpointFileName());
+    m_downloader->start(startFlight, endFlight);
+}
 
+void FlightLogManager::downloadFinished(bool success)
+{
     if (m_cancelDownload) {
-        clearLogList();
+        // The checkpoint is kept for the next download
         m_cancelDownload = false;
+    } else {
+        // What was downloaded of a failed download is still shown
+        m_logEntries->setEntries(m_downloader->buffer());
+    }
+    if (!success) {
+        qDebug() << "FlightLogManager - download stopped after" << m_downloader->buffer().count() << "entries";
     }
 
     emit logEntriesChanged();
-    setDisableExport(m_logEntries.count() == 0);
+    setDisableExport(logEntriesCount() == 0);
 
     QApplication::restoreOverrideCursor();
     setDisableControls(false);
 }
 
+QString FlightLogManager::checkpointFileName()
+{
+    QByteArray serial = m_objectUtilManager->getBoardCPUSerial();
+
+    if (serial.isEmpty()) {
+        return QString();
+    }
+    return Utils::GetStoragePath() + "debuglog/" + serial.toHex() + ".dlog";
+}
+
 void FlightLogManager::exportToOPL(QString fileName)
 {
+    const DebugLogBuffer &entries = m_logEntries->entries();
+
     // Fix the file name
     fileName.replace(QString(".opl"), QString("%1.opl"));
 
@@ -285,13 +227,14 @@ void FlightLogManager::exportToOPL(QString fileName)
     int currentFlight = 0;
     quint32 adjustedBaseTime = 0;
     // Continue until all entries are exported
-    while (currentEntry < m_logEntries.count()) {
+    while (currentEntry < entries.count()) {
+        DebugLogBuffer::Entry entry = entries.at(currentEntry);
         if (m_adjustExportedTimestamps) {
-            adjustedBaseTime = m_logEntries[currentEntry]->getFlightTime();
+            adjustedBaseTime = entry.FlightTime;
         }
 
         // Get current flight
-        currentFlight = m_logEntries[currentEntry]->getFlight();
+        currentFlight = entry.Flight;
 
         LogFile logFile;
         logFile.useProvidedTimeStamp(true);
@@ -302,17 +245,21 @@ void FlightLogManager::exportToOPL(QString fileName)
         UAVTalk uavTalk(&logFile, m_objectManager);
 
         // Export entries until no more available or flight changes
-        while (currentEntry < m_logEntries.count() && m_logEntries[currentEntry]->getFlight() == currentFlight) {
-            ExtendedDebugLogEntry *entry = m_logEntries[currentEntry];
+        while (currentEntry < entries.count()) {
+            entry = entries.at(currentEntry);
+            if (entry.Flight != currentFlight) {
+                break;
+            }
+            UAVDataObject *object = m_logEntries->uavObject(entry);
 
             // Only log uavobjects
-            if (entry->getType() == ExtendedDebugLogEntry::TYPE_UAVOBJECT || entry->getType() == ExtendedDebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+            if (object) {
                 // Set timestamp that should be logged for this entry
-                logFile.setNextTimeStamp(entry->getFlightTime() - adjustedBaseTime);
+                logFile.setNextTimeStamp(entry.FlightTime - adjustedBaseTime);
 
                 // Use UAVTalk to log complete message to file
-                uavTalk.sendObject(entry->uavObject(), false, false);
-                qDebug() << entry->getFlightTime() - adjustedBaseTime << "=" << entry->toStringBrief();
+                uavTalk.sendObject(object, false, false);
+                qDebug() << entry.FlightTime - adjustedBaseTime << "=" << object->toStringBrief();
             }
             currentEntry++;
         }
@@ -330,12 +277,13 @@ void FlightLogManager::exportToCSV(QString fileName)
         quint32 baseTime = 0;
         quint32 currentFlight = 0;
         csvStream << "Flight" << '\t' << "Flight Time" << '\t' << "Entry" << '\t' << "Data" << '\n';
-        foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
-            if (m_adjustExportedTimestamps && entry->getFlight() != currentFlight) {
-                currentFlight = entry->getFlight();
-                baseTime = entry->getFlightTime();
+        for (int i = 0; i < m_logEntries->entries().count(); i++) {
+            DebugLogBuffer::Entry entry = m_logEntries->entries().at(i);
+            if (m_adjustExportedTimestamps && entry.Flight != currentFlight) {
+                currentFlight = entry.Flight;
+                baseTime = entry.FlightTime;
             }
-            entry->toCSV(&csvStream, baseTime);
+            m_logEntries->toCSV(&csvStream, entry, baseTime);
         }
         csvStream.flush();
         csvFile.flush();
@@ -358,12 +306,13 @@ void FlightLogManager::exportToXML(QString fileName)
 
         quint32 baseTime = 0;
         quint32 currentFlight = 0;
-        foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
-            if (m_adjustExportedTimestamps && entry->getFlight() != currentFlight) {
-                currentFlight = entry->getFlight();
-                baseTime = entry->getFlightTime();
+        for (int i = 0; i < m_logEntries->entries().count(); i++) {
+            DebugLogBuffer::Entry entry = m_logEntries->entries().at(i);
+            if (m_adjustExportedTimestamps && entry.Flight != currentFlight) {
+                currentFlight = entry.Flight;
+                baseTime = entry.FlightTime;
             }
-            entry->toXML(&xmlWriter, baseTime);
+            m_logEntries->toXML(&xmlWriter, entry, baseTime);
         }
         xmlWriter.writeEndElement();
         xmlWriter.writeEndDocument();
@@ -374,7 +323,7 @@ void FlightLogManager::exportToXML(QString fileName)
 
 void FlightLogManager::exportLogs()
 {
-    if (m_logEntries.isEmpty()) {
+    if (logEntriesCount() == 0) {
         return;
     }
 
@@ -414,7 +363,10 @@ void FlightLogManager::exportLogs()
 
 void FlightLogManager::cancelExportLogs()
 {
-    m_cancelDownload = true;
+    if (m_downloader->isRunning()) {
+        m_cancelDownload = true;
+        m_downloader->cancel();
+    }
 }
 
 void FlightLogManager::loadSettings()
@@ -625,67 +577,125 @@ bool FlightLogManager::updateLogWrapper(QString name, int level, int period)
     return false;
 }
 
-ExtendedDebugLogEntry::ExtendedDebugLogEntry() : DebugLogEntry(),
-    m_object(0)
+DebugLogEntryModel::DebugLogEntryModel(UAVObjectManager *objectManager, QObject *parent) : QAbstractListModel(parent),
+    m_objectManager(objectManager)
 {}
 
-ExtendedDebugLogEntry::~ExtendedDebugLogEntry()
+DebugLogEntryModel::~DebugLogEntryModel()
 {
-    if (m_object) {
-        delete m_object;
-        m_object = 0;
+    qDeleteAll(m_objects);
+}
+
+int DebugLogEntryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_entries.count();
+}
+
+QVariant DebugLogEntryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_entries.count()) {
+        return QVariant();
+    }
+    DebugLogBuffer::Entry entry = m_entries.at(index.row());
+    switch (role) {
+    case FlightRole:
+        return entry.Flight;
+
+    case FlightTimeRole:
+        return entry.FlightTime;
+
+    case EntryRole:
+        return entry.Entry;
+
+    case TypeRole:
+        return entry.Type;
+
+    case LogStringRole:
+        return logString(entry);
+
+    default:
+        return QVariant();
     }
 }
 
-QString ExtendedDebugLogEntry::getLogString()
+QHash<int, QByteArray> DebugLogEntryModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[FlightRole]     = "Flight";
+    roles[FlightTimeRole] = "FlightTime";
+    roles[EntryRole]      = "Entry";
+    roles[TypeRole]       = "Type";
+    roles[LogStringRole]  = "LogString";
+    return roles;
+}
+
+void DebugLogEntryModel::setEntries(const DebugLogBuffer &entries)
 {
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
-        return QString((const char *)getData().Data);
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        return m_object->toString().replace("\n", " ").replace("\t", " ");
+    beginResetModel();
+    m_entries = entries;
+    endResetModel();
+}
+
+static QString entryText(const DebugLogBuffer::Entry &entry)
+{
+    return QString::fromUtf8((const char *)entry.Data, qstrnlen((const char *)entry.Data, DebugLogEntry::DATA_NUMELEM));
+}
+
+UAVDataObject *DebugLogEntryModel::uavObject(const DebugLogBuffer::Entry &entry) const
+{
+    if (entry.Type != DebugLogEntry::TYPE_UAVOBJECT && entry.Type != DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        return NULL;
+    }
+    quint64 key = ((quint64)entry.ObjectID << 32) | entry.InstanceID;
+    UAVDataObject *object;
+    if (m_objects.contains(key)) {
+        object = m_objects.value(key);
     } else {
-        return "";
+        UAVDataObject *base = qobject_cast<UAVDataObject *>(m_objectManager->getObject(entry.ObjectID));
+        object = base ? base->clone(entry.InstanceID) : NULL;
+        m_objects.insert(key, object);
     }
+    if (object) {
+        object->unpack(entry.Data);
+    }
+    return object;
+}
+
+QString DebugLogEntryModel::logString(const DebugLogBuffer::Entry &entry) const
+{
+    if (entry.Type == DebugLogEntry::TYPE_TEXT) {
+        return entryText(entry);
+    }
+    UAVDataObject *object = uavObject(entry);
+    return object ? object->toString().replace("\n", " ").replace("\t", " ") : QString();
 }
 
-void ExtendedDebugLogEntry::toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime)
+void DebugLogEntryModel::toXML(QXmlStreamWriter *xmlWriter, const DebugLogBuffer::Entry &entry, quint32 baseTime) const
 {
     xmlWriter->writeStartElement("entry");
-    xmlWriter->writeAttribute("flight", QString::number(getFlight() + 1));
-    xmlWriter->writeAttribute("flighttime", QString::number(getFlightTime() - baseTime));
-    xmlWriter->writeAttribute("entry", QString::number(getEntry()));
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
+    xmlWriter->writeAttribute("flight", QString::number(entry.Flight + 1));
+    xmlWriter->writeAttribute("flighttime", QString::number(entry.FlightTime - baseTime));
+    xmlWriter->writeAttribute("entry", QString::number(entry.Entry));
+    if (entry.Type == DebugLogEntry::TYPE_TEXT) {
         xmlWriter->writeAttribute("type", "text");
-        xmlWriter->writeTextElement("message", QString((const char *)getData().Data));
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        xmlWriter->writeTextElement("message", entryText(entry));
+    } else if (UAVDataObject *object = uavObject(entry)) {
         xmlWriter->writeAttribute("type", "uavobject");
-        m_object->toXML(xmlWriter);
+        object->toXML(xmlWriter);
     }
     xmlWriter->writeEndElement(); // entry
 }
 
-void ExtendedDebugLogEntry::toCSV(QTextStream *csvStream, quint32 baseTime)
+void DebugLogEntryModel::toCSV(QTextStream *csvStream, const DebugLogBuffer::Entry &entry, quint32 baseTime) const
 {
     QString data;
 
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
-        data = QString((const char *)getData().Data);
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        data = m_object->toString().replace("\n", "").replace("\t", "");
-    }
-    *csvStream << QString::number(getFlight() + 1) << '\t' << QString::number(getFlightTime() - baseTime) << '\t' << QString::number(getEntry()) << '\t' << data << '\n';
-}
-
-void ExtendedDebugLogEntry::setData(const DebugLogEntry::DataFields &data, UAVObjectManager *objectManager)
-{
-    DebugLogEntry::setData(data);
-
-    if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        UAVDataObject *object = (UAVDataObject *)objectManager->getObject(getObjectID(), getInstanceID());
-        Q_ASSERT(object);
-        m_object = object->clone(getInstanceID());
-        m_object->unpack(getData().Data);
+    if (entry.Type == DebugLogEntry::TYPE_TEXT) {
+        data = entryText(entry);
+    } else if (UAVDataObject *object = uavObject(entry)) {
+        data = object->toString().replace("\n", "").replace("\t", "");
     }
+    *csvStream << QString::number(entry.Flight + 1) << '\t' << QString::number(entry.FlightTime - baseTime) << '\t' << QString::number(entry.Entry) << '\t' << data << '\n';
 }
 
 
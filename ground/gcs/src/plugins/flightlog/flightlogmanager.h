@@ -31,6 +31,7 @@
 #include <QObject>
 #include <QList>
 #include <QHash>
+#include <QAbstractListModel>
 #include <QQmlListProperty>
 #include <QSemaphore>
 #include <QXmlStreamWriter>
@@ -44,6 +45,9 @@
 #include "debuglogcontrol.h"
 #include "objectpersistence.h"
 #include "uavtalk/telemetrymanager.h"
+#include "debuglogbuffer.h"
+
+class DebugLogDownloader;
 
 class UAVOLogSettingsWrapper : public QObject {
     Q_OBJECT Q_PROPERTY(UAVDataObject *object READ object NOTIFY objectChanged)
@@ -137,41 +141,42 @@ private:
     bool m_dirty;
 };
 
-class ExtendedDebugLogEntry : public DebugLogEntry {
-    Q_OBJECT Q_PROPERTY(QString LogString READ getLogString WRITE setLogString NOTIFY LogStringUpdated)
+class DebugLogEntryModel : public QAbstractListModel {
+    Q_OBJECT
 
 public:
-    explicit ExtendedDebugLogEntry();
-    ~ExtendedDebugLogEntry();
+    enum Roles { FlightRole = Qt::UserRole + 1, FlightTimeRole, EntryRole, TypeRole, LogStringRole };
 
-    QString getLogString();
-    void toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime);
-    void toCSV(QTextStream *csvStream, quint32 baseTime);
-    UAVDataObject *uavObject()
-    {
-        return m_object;
-    }
+    explicit DebugLogEntryModel(UAVObjectManager *objectManager, QObject *parent = 0);
+    ~DebugLogEntryModel();
 
-    void setData(const DataFields & data, UAVObjectManager *objectManager);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
 
-public slots:
-    void setLogString(QString arg)
+    const DebugLogBuffer &entries() const
     {
-        Q_UNUSED(arg);
+        return m_entries;
     }
+    void setEntries(const DebugLogBuffer &entries);
 
-signals:
-    void LogStringUpdated(QString arg);
+    // The logged object unpacked into a copy shared by the entries of that object, NULL if unknown
+    UAVDataObject *uavObject(const DebugLogBuffer::Entry &entry) const;
+    QString logString(const DebugLogBuffer::Entry &entry) const;
+    void toXML(QXmlStreamWriter *xmlWriter, const DebugLogBuffer::Entry &entry, quint32 baseTime) const;
+    void toCSV(QTextStream *csvStream, const DebugLogBuffer::Entry &entry, quint32 baseTime) const;
 
 private:
-    UAVDataObject *m_object;
+    UAVObjectManager *m_objectManager;
+    DebugLogBuffer m_entries;
+    mutable QHash<quint64, UAVDataObject *> m_objects;
 };
 
 class FlightLogManager : public QObject {
     Q_OBJECT Q_PROPERTY(DebugLogStatus *flightLogStatus READ flightLogStatus)
     Q_PROPERTY(DebugLogControl * flightLogControl READ flightLogControl)
     Q_PROPERTY(DebugLogSettings * flightLogSettings READ flightLogSettings)
-    Q_PROPERTY(QQmlListProperty<ExtendedDebugLogEntry> logEntries READ logEntries NOTIFY logEntriesChanged)
+    Q_PROPERTY(QAbstractItemModel * logEntries READ logEntries CONSTANT)
     Q_PROPERTY(QStringList flightEntries READ flightEntries NOTIFY flightEntriesChanged)
     Q_PROPERTY(bool disableControls READ disableControls WRITE setDisableControls NOTIFY disableControlsChanged)
     Q_PROPERTY(bool disableExport READ disableExport WRITE setDisableExport NOTIFY disableExportChanged)
@@ -188,7 +193,10 @@ public:
     explicit FlightLogManager(QObject *parent = 0);
     ~FlightLogManager();
 
-    QQmlListProperty<ExtendedDebugLogEntry> logEntries();
+    QAbstractItemModel *logEntries() const
+    {
+        return m_logEntries;
+    }
     QQmlListProperty<UAVOLogSettingsWrapper> uavoEntries();
 
     QStringList flightEntries();
@@ -246,7 +254,7 @@ public:
     }
     int logEntriesCount()
     {
-        return m_logEntries.count();
+        return m_logEntries->rowCount();
     }
 signals:
     void logEntriesChanged();
@@ -319,6 +327,7 @@ private slots:
     void setupLogStatuses();
     void connectionStatusChanged();
     bool updateLogWrapper(QString name, int level, int period);
+    void downloadFinished(bool success);
 
 private:
     UAVObjectManager *m_objectManager;
@@ -330,7 +339,8 @@ private:
     DebugLogSettings *m_flightLogSettings;
     ObjectPersistence *m_objectPersistence;
 
-    QList<ExtendedDebugLogEntry *> m_logEntries;
+    DebugLogDownloader *m_downloader;
+    DebugLogEntryModel *m_logEntries;
     QStringList m_flightEntries;
     QStringList m_logSettings;
     QStringList m_logStatuses;
@@ -341,6 +351,7 @@ private:
     void exportToOPL(QString fileName);
     void exportToCSV(QString fileName);
     void exportToXML(QString fileName);
+    QString checkpointFileName();
 
     static const int UAVTALK_TIMEOUT = 4000;
     static const int LOG_SETTINGS_FILE_VERSION = 1;
@@ -0,0 +1,19 @@
+#
+# Downloads the flight side logs from a stand-in board over a loopback UAVTalk link
+#
+
+include(../../../../gcs.pri)
+include(../../uavtalk/tests/uavtalktest.pri)
+
+TARGET = debuglogdownloadertest
+
+INCLUDEPATH += $$PLUGINS_DIR/flightlog
+
+HEADERS += \
+    $$PLUGINS_DIR/flightlog/debuglogbuffer.h \
+    $$PLUGINS_DIR/flightlog/debuglogdownloader.h
+
+SOURCES += \
+    tst_debuglogdownloader.cpp \
+    $$PLUGINS_DIR/flightlog/debuglogbuffer.cpp \
+    $$PLUGINS_DIR/flightlog/debuglogdownloader.cpp
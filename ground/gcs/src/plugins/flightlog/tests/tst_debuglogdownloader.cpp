@@ -0,0 +1,525 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_debuglogdownloader.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Downloads logs from a stand-in board and reports its time against two round trips per entry
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavtalk.h"
+#include "telemetry.h"
+#include "loopbackdevice.h"
+#include "debuglogdownloader.h"
+#include "gcstelemetrystats.h"
+#include "debuglogcontrol.h"
+#include "debuglogentry.h"
+#include "attitudestate.h"
+#include "gyrostate.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QIODevice>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QTemporaryDir>
+
+/**
+ * Flight side of the log retrieval: a Retrieve command loads the flash entry
+ * into DebugLogEntry, or an empty entry past the last one of the flight. The
+ * board UAVTalk answers the entry requests with whatever DebugLogEntry holds.
+ */
+class FlightLogging : public QObject {
+public:
+    FlightLogging(UAVObjectManager *objMngr, int loadTime) :
+        m_loadTime(loadTime), m_delay(0), m_loads(0), m_stopAt(-1)
+    {
+        m_entry   = DebugLogEntry::GetInstance(objMngr);
+        m_control = DebugLogControl::GetInstance(objMngr);
+        connect(m_control, &UAVObject::objectUnpacked, this, [this](UAVObject *) {
+            DebugLogControl::DataFields control = m_control->getData();
+            if (control.Operation == DebugLogControl::OPERATION_RETRIEVE) {
+                QTimer::singleShot(m_loadTime + m_delay, this, [this, control]() {
+                    load(control);
+                });
+                m_delay = 0;
+            }
+        });
+    }
+
+    void write(const DebugLogEntry::DataFields &entry)
+    {
+        m_flash.insert(key(entry.Flight, entry.Entry), entry);
+    }
+
+    // The next load takes that much longer
+    void delayNextLoad(int delay)
+    {
+        m_delay = delay;
+    }
+
+    // Loads are ignored from then on
+    void stopAt(int loads)
+    {
+        m_stopAt = loads;
+    }
+
+    int loads() const
+    {
+        return m_loads;
+    }
+
+private:
+    DebugLogEntry *m_entry;
+    DebugLogControl *m_control;
+    int m_loadTime;
+    int m_delay;
+    int m_loads;
+    int m_stopAt;
+    QHash<quint32, DebugLogEntry::DataFields> m_flash;
+
+    static quint32 key(quint16 flight, quint16 entry)
+    {
+        return ((quint32)flight << 16) | entry;
+    }
+
+    void load(const DebugLogControl::DataFields &control)
+    {
+        if (m_loads == m_stopAt) {
+            return;
+        }
+        m_loads++;
+
+        DebugLogEntry::DataFields entry;
+        if (m_flash.contains(key(control.Flight, control.Entry))) {
+            entry = m_flash.value(key(control.Flight, control.Entry));
+        } else {
+            memset(&entry, 0, sizeof(entry));
+            entry.Flight = control.Flight;
+            entry.Entry  = control.Entry;
+            entry.Type   = DebugLogEntry::TYPE_EMPTY;
+        }
+        m_entry->setData(entry);
+    }
+};
+
+class tst_DebugLogDownloader : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void downloadsAll();
+    void resumes();
+    void checkpointMismatch();
+    void logChanged();
+    void staleEntry();
+    void givesUp();
+    void timing();
+
+private:
+    static const int LINK_LATENCY  = 10;
+    static const int LOAD_TIME     = 2;
+    static const int FLIGHT_LENGTH = 20;
+
+    LoopbackDevice *m_gcsDevice;
+    LoopbackDevice *m_boardDevice;
+    UAVObjectManager *m_gcsMngr;
+    UAVObjectManager *m_boardMngr;
+    UAVTalk *m_gcsTalk;
+    UAVTalk *m_boardTalk;
+    Telemetry *m_telemetry;
+    FlightLogging *m_flight;
+    DebugLogDownloader *m_downloader;
+    QTemporaryDir *m_dir;
+    // Entries of both flights, in order
+    QList<DebugLogEntry::DataFields> m_entries;
+
+    void addEntry(DebugLogEntry::DataFields entry);
+    DebugLogEntry::DataFields entry(int flight, int entry, int type);
+    DebugLogEntry::DataFields objectEntry(int flight, int entry, UAVObject *obj);
+    DebugLogBuffer expected(int firstFlight, int lastFlight);
+    bool sameEntries(const DebugLogBuffer &buffer, const DebugLogBuffer &expected);
+    bool downloadOneByOne(int lastFlight, DebugLogBuffer *buffer);
+};
+
+void tst_DebugLogDownloader::init()
+{
+    m_gcsDevice   = new LoopbackDevice(LINK_LATENCY);
+    m_boardDevice = new LoopbackDevice(LINK_LATENCY);
+    m_gcsDevice->setPeer(m_boardDevice);
+    m_boardDevice->setPeer(m_gcsDevice);
+
+    m_gcsMngr   = new UAVObjectManager();
+    UAVObjectsInitialize(m_gcsMngr);
+    m_boardMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_boardMngr);
+
+    m_gcsTalk   = new UAVTalk(m_gcsDevice, m_gcsMngr);
+    m_boardTalk = new UAVTalk(m_boardDevice, m_boardMngr);
+    m_telemetry = new Telemetry(m_gcsTalk, m_gcsMngr);
+    connect(m_gcsDevice, SIGNAL(readyRead()), m_gcsTalk, SLOT(processInputStream()));
+    connect(m_boardDevice, SIGNAL(readyRead()), m_boardTalk, SLOT(processInputStream()));
+
+    GCSTelemetryStats *gcsStats = GCSTelemetryStats::GetInstance(m_gcsMngr);
+    GCSTelemetryStats::DataFields stats = gcsStats->getData();
+    stats.Status = GCSTelemetryStats::STATUS_CONNECTED;
+    gcsStats->setData(stats);
+
+    m_flight = new FlightLogging(m_boardMngr, LOAD_TIME);
+    m_entries.clear();
+
+    // Flight 0: text, an object, and an entry packing two objects
+    AttitudeState *attitude = AttitudeState::GetInstance(m_boardMngr);
+    GyroState *gyro = GyroState::GetInstance(m_boardMngr);
+    attitude->setRoll(10.0);
+    gyro->setZ(-5.0);
+
+    DebugLogEntry::DataFields text = entry(0, 0, DebugLogEntry::TYPE_TEXT);
+    strcpy((char *)text.Data, "Armed");
+    text.Size = strlen("Armed") + 1;
+    addEntry(text);
+    addEntry(objectEntry(0, 1, attitude));
+
+    DebugLogEntry::DataFields multiple = objectEntry(0, 2, attitude);
+    multiple.Type = DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS;
+    DebugLogEntry::DataFields packed   = objectEntry(0, 2, gyro);
+    memcpy(&multiple.Data[multiple.Size], &packed, DebugLogBuffer::HEADER_SIZE + packed.Size);
+    addEntry(multiple);
+
+    strcpy((char *)text.Data, "Disarmed");
+    text.Size  = strlen("Disarmed") + 1;
+    text.Entry = 3;
+    addEntry(text);
+
+    // Flight 1: objects only
+    for (int i = 0; i < FLIGHT_LENGTH; i++) {
+        attitude->setYaw(i);
+        addEntry(objectEntry(1, i, attitude));
+    }
+
+    m_dir = new QTemporaryDir();
+    m_downloader = new DebugLogDownloader(m_gcsMngr);
+}
+
+void tst_DebugLogDownloader::cleanup()
+{
+    delete m_downloader;
+    delete m_dir;
+    delete m_flight;
+    delete m_telemetry;
+    delete m_gcsTalk;
+    delete m_boardTalk;
+    delete m_gcsMngr;
+    delete m_boardMngr;
+    delete m_gcsDevice;
+    delete m_boardDevice;
+}
+
+void tst_DebugLogDownloader::addEntry(DebugLogEntry::DataFields entry)
+{
+    m_flight->write(entry);
+    m_entries.append(entry);
+}
+
+DebugLogEntry::DataFields tst_DebugLogDownloader::entry(int flight, int entry, int type)
+{
+    DebugLogEntry::DataFields fields;
+
+    // Unused flash reads as erased
+    memset(&fields, 0xFF, sizeof(fields));
+    fields.Flight     = flight;
+    fields.FlightTime = 1000 * flight + 10 * entry;
+    fields.Entry      = entry;
+    fields.Type       = type;
+    fields.ObjectID   = 0;
+    fields.InstanceID = 0;
+    fields.Size = 0;
+    return fields;
+}
+
+DebugLogEntry::DataFields tst_DebugLogDownloader::objectEntry(int flight, int entry, UAVObject *obj)
+{
+    DebugLogEntry::DataFields fields = this->entry(flight, entry, DebugLogEntry::TYPE_UAVOBJECT);
+
+    fields.ObjectID   = obj->getObjID();
+    fields.InstanceID = obj->getInstID();
+    fields.Size = obj->getNumBytes();
+    obj->pack(fields.Data);
+    return fields;
+}
+
+DebugLogBuffer tst_DebugLogDownloader::expected(int firstFlight, int lastFlight)
+{
+    DebugLogBuffer buffer;
+
+    foreach(const DebugLogEntry::DataFields &entry, m_entries) {
+        if (entry.Flight >= firstFlight && entry.Flight <= lastFlight) {
+            buffer.append(entry);
+        }
+    }
+    return buffer;
+}
+
+bool tst_DebugLogDownloader::sameEntries(const DebugLogBuffer &buffer, const DebugLogBuffer &expected)
+{
+    if (buffer.count() != expected.count()) {
+        qDebug() << "got" << buffer.count() << "entries instead of" << expected.count();
+        return false;
+    }
+    for (int i = 0; i < buffer.count(); i++) {
+        DebugLogBuffer::Entry entry = buffer.at(i);
+        DebugLogBuffer::Entry other = expected.at(i);
+        if (memcmp(&entry, &other, DebugLogBuffer::HEADER_SIZE + entry.Size)) {
+            qDebug() << "entry" << i << "differs";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Load, wait for the ack, request, wait for the entry, for each entry in turn
+ */
+bool tst_DebugLogDownloader::downloadOneByOne(int lastFlight, DebugLogBuffer *buffer)
+{
+    DebugLogControl *control = DebugLogControl::GetInstance(m_gcsMngr);
+    DebugLogEntry *entry     = DebugLogEntry::GetInstance(m_gcsMngr);
+    bool success = true;
+    QEventLoop eventLoop;
+    QTimer timer;
+
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), &eventLoop, SLOT(quit()));
+    connect(control, SIGNAL(transactionCompleted(UAVObject *, bool)), &eventLoop, SLOT(quit()));
+    connect(entry, SIGNAL(transactionCompleted(UAVObject *, bool)), &eventLoop, SLOT(quit()));
+
+    for (int flight = 0; flight <= lastFlight && success; flight++) {
+        bool gotLast = false;
+        for (int slot = 0; !gotLast && success; slot++) {
+            DebugLogControl::DataFields data = control->getData();
+            data.Operation = DebugLogControl::OPERATION_RETRIEVE;
+            data.Flight    = flight;
+            data.Entry     = slot;
+            control->setData(data);
+            control->updated();
+            timer.start(1000);
+            eventLoop.exec();
+            entry->requestUpdate();
+            timer.start(1000);
+            eventLoop.exec();
+            success &= timer.isActive();
+            buffer->append(entry->getData());
+            gotLast = (entry->getType() == DebugLogEntry::TYPE_EMPTY);
+        }
+    }
+    return success;
+}
+
+void tst_DebugLogDownloader::downloadsAll()
+{
+    QSignalSpy finished(m_downloader, SIGNAL(finished(bool)));
+    QSignalSpy progress(m_downloader, SIGNAL(progress(int, double)));
+
+    QVERIFY(m_downloader->start(0, 1));
+    QVERIFY(m_downloader->isRunning());
+    QVERIFY(!m_downloader->start(0, 1));
+    QTRY_COMPARE(finished.count(), 1);
+
+    QCOMPARE(finished.at(0).at(0).toBool(), true);
+    QVERIFY(!m_downloader->isRunning());
+    // Every flash entry and the empty one ending each flight
+    QCOMPARE(m_downloader->entriesReceived(), m_entries.size() + 2);
+    QCOMPARE(progress.count(), m_entries.size() + 2);
+    QVERIFY(m_downloader->entriesPerSecond() > 0);
+
+    // The packed object is an entry of its own
+    const DebugLogBuffer &buffer = m_downloader->buffer();
+    QCOMPARE(buffer.count(), m_entries.size() + 1);
+    QVERIFY(sameEntries(buffer, expected(0, 1)));
+    QCOMPARE((int)buffer.at(2).Type, (int)DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS);
+    QCOMPARE((quint32)buffer.at(3).ObjectID, (quint32)GyroState::OBJID);
+    QCOMPARE(QString((const char *)buffer.at(4).Data), QString("Disarmed"));
+}
+
+void tst_DebugLogDownloader::resumes()
+{
+    QString fileName = m_dir->filePath("board.dlog");
+    QSignalSpy finished(m_downloader, SIGNAL(finished(bool)));
+
+    // Interrupted part way through the second flight
+    m_downloader->setCheckpointFile(fileName);
+    connect(m_downloader, &DebugLogDownloader::progress, m_downloader, [this](int entries, double) {
+        if (entries == 12) {
+            m_downloader->cancel();
+        }
+    });
+    QVERIFY(m_downloader->start(0, 1));
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(finished.at(0).at(0).toBool(), false);
+    QVERIFY(QFile::exists(fileName));
+
+    // Along with a record cut short
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::Append));
+    file.write(QByteArray(5, 1));
+    file.close();
+
+    DebugLogDownloader downloader(m_gcsMngr);
+    QSignalSpy resumed(&downloader, SIGNAL(finished(bool)));
+    downloader.setCheckpointFile(fileName);
+    int loads = m_flight->loads();
+    QVERIFY(downloader.start(0, 1));
+    QTRY_COMPARE(resumed.count(), 1);
+
+    QCOMPARE(resumed.at(0).at(0).toBool(), true);
+    QVERIFY(downloader.entriesResumed() >= 12);
+    QCOMPARE(downloader.entriesResumed() + downloader.entriesReceived(), m_entries.size() + 2);
+    QVERIFY(m_flight->loads() - loads < m_entries.size());
+    QVERIFY(sameEntries(downloader.buffer(), expected(0, 1)));
+    // Done with
+    QVERIFY(!QFile::exists(fileName));
+}
+
+void tst_DebugLogDownloader::checkpointMismatch()
+{
+    QString fileName = m_dir->filePath("board.dlog");
+    QSignalSpy finished(m_downloader, SIGNAL(finished(bool)));
+
+    m_downloader->setCheckpointFile(fileName);
+    connect(m_downloader, &DebugLogDownloader::progress, m_downloader, [this](int entries, double) {
+        if (entries == 3) {
+            m_downloader->cancel();
+        }
+    });
+    QVERIFY(m_downloader->start(0, 1));
+    QTRY_COMPARE(finished.count(), 1);
+    QVERIFY(QFile::exists(fileName));
+
+    // Entries of other flights are not reused
+    DebugLogDownloader downloader(m_gcsMngr);
+    QSignalSpy other(&downloader, SIGNAL(finished(bool)));
+    downloader.setCheckpointFile(fileName);
+    QVERIFY(downloader.start(1, 1));
+    QTRY_COMPARE(other.count(), 1);
+
+    QCOMPARE(other.at(0).at(0).toBool(), true);
+    QCOMPARE(downloader.entriesResumed(), 0);
+    QVERIFY(sameEntries(downloader.buffer(), expected(1, 1)));
+}
+
+void tst_DebugLogDownloader::logChanged()
+{
+    QString fileName = m_dir->filePath("board.dlog");
+    QSignalSpy finished(m_downloader, SIGNAL(finished(bool)));
+
+    m_downloader->setCheckpointFile(fileName);
+    connect(m_downloader, &DebugLogDownloader::progress, m_downloader, [this](int entries, double) {
+        if (entries == 12) {
+            m_downloader->cancel();
+        }
+    });
+    QVERIFY(m_downloader->start(0, 1));
+    QTRY_COMPARE(finished.count(), 1);
+    QVERIFY(QFile::exists(fileName));
+
+    // The flash was erased and the same flights logged again
+    for (int i = 0; i < m_entries.size(); i++) {
+        m_entries[i].FlightTime += 500;
+        m_flight->write(m_entries.at(i));
+    }
+
+    DebugLogDownloader downloader(m_gcsMngr);
+    QSignalSpy restarted(&downloader, SIGNAL(finished(bool)));
+    downloader.setCheckpointFile(fileName);
+    QVERIFY(downloader.start(0, 1));
+    QTRY_COMPARE(restarted.count(), 1);
+
+    QCOMPARE(restarted.at(0).at(0).toBool(), true);
+    QCOMPARE(downloader.entriesResumed(), 0);
+    QCOMPARE(downloader.entriesReceived(), m_entries.size() + 2);
+    QVERIFY(sameEntries(downloader.buffer(), expected(0, 1)));
+    QVERIFY(!QFile::exists(fileName));
+}
+
+void tst_DebugLogDownloader::staleEntry()
+{
+    QSignalSpy finished(m_downloader, SIGNAL(finished(bool)));
+
+    // A request comes before its entry is loaded
+    connect(m_downloader, &DebugLogDownloader::progress, m_downloader, [this](int entries, double) {
+        if (entries == 5) {
+            m_flight->delayNextLoad(8 * LINK_LATENCY);
+        }
+    });
+    QVERIFY(m_downloader->start(0, 1));
+    QTRY_COMPARE(finished.count(), 1);
+
+    QCOMPARE(finished.at(0).at(0).toBool(), true);
+    QVERIFY(sameEntries(m_downloader->buffer(), expected(0, 1)));
+    // Each entry and the empty ones are loaded once, and one more after each empty one
+    QVERIFY(m_flight->loads() > m_entries.size() + 4);
+}
+
+void tst_DebugLogDownloader::givesUp()
+{
+    QString fileName = m_dir->filePath("board.dlog");
+    QSignalSpy finished(m_downloader, SIGNAL(finished(bool)));
+
+    m_flight->stopAt(8);
+    m_downloader->setCheckpointFile(fileName);
+    QVERIFY(m_downloader->start(0, 1));
+    QTRY_COMPARE(finished.count(), 1);
+
+    QCOMPARE(finished.at(0).at(0).toBool(), false);
+    QVERIFY(m_downloader->buffer().count() > 0);
+    QVERIFY(m_downloader->buffer().count() < m_entries.size());
+    QVERIFY(QFile::exists(fileName));
+}
+
+void tst_DebugLogDownloader::timing()
+{
+    QSignalSpy finished(m_downloader, SIGNAL(finished(bool)));
+    QElapsedTimer timer;
+    DebugLogBuffer oneByOne;
+
+    timer.start();
+    QVERIFY(downloadOneByOne(1, &oneByOne));
+    qint64 oneByOneMs = timer.elapsed();
+    QVERIFY(sameEntries(oneByOne, expected(0, 1)));
+
+    timer.start();
+    QVERIFY(m_downloader->start(0, 1));
+    QTRY_COMPARE(finished.count(), 1);
+    qint64 downloaderMs = timer.elapsed();
+    QVERIFY(sameEntries(m_downloader->buffer(), expected(0, 1)));
+
+    qDebug("%d entries, %d ms link latency, %d ms entry load", m_entries.size(), LINK_LATENCY, LOAD_TIME);
+    qDebug("one by one %lld ms, downloader %lld ms, %.0f entries/s, %.0f bytes/s", oneByOneMs, downloaderMs,
+           m_downloader->entriesPerSecond(), m_downloader->bytesPerSecond());
+}
+
+QTEST_GUILESS_MAIN(tst_DebugLogDownloader)
+
+#include "tst_debuglogdownloader.moc"
@@ -88,10 +88,7 @@ void GCSControlGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 
 ManualControlCommand *GCSControlGadget::getManualControlCommand()
 {
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-
-    return dynamic_cast<ManualControlCommand *>(objManager->getObject(QString("ManualControlCommand")));
+    return ManualControlCommand::GetInstance(m_objManager);
 }
 
 void GCSControlGadget::manualControlCommandUpdated(UAVObject *manualControlCommand)
@@ -340,9 +337,7 @@ double GCSControlGadget::constrain(double value)
 void GCSControlGadget::buttonState(ButtonNumber number, bool pressed)
 {
     if ((buttonSettings[number].ActionID > 0) && (buttonSettings[number].FunctionID > 0) && (pressed)) { // this button is configured
-        ExtensionSystem::PluginManager *pm  = ExtensionSystem::PluginManager::instance();
-        UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-        UAVDataObject *manualControlCommand = dynamic_cast<UAVDataObject *>(objManager->getObject(QString("ManualControlCommand")));
+        UAVDataObject *manualControlCommand = getManualControlCommand();
         bool currentCGSControl = ((GCSControlGadgetWidget *)m_widget)->getGCSControl();
         bool currentUDPControl = ((GCSControlGadgetWidget *)m_widget)->getUDPControl();
 
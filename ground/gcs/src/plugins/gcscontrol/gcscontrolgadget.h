@@ -29,6 +29,7 @@
 #define GCSControlGADGET_H_
 
 #include <coreplugin/iuavgadget.h>
+#include <extensionsystem/pluginmanager.h>
 #include "manualcontrolcommand.h"
 #include "gcscontrolgadgetconfiguration.h"
 #include "sdlgamepad/sdlgamepad.h"
@@ -44,6 +45,7 @@ class IUAVGadget;
 // class QWidget;
 // class QString;
 class GCSControlGadgetWidget;
+class UAVObjectManager;
 
 using namespace Core;
 
@@ -71,6 +73,7 @@ public:
 private:
     ManualControlCommand *getManualControlCommand();
     double constrain(double value);
+    ExtensionSystem::ObjectHandle<UAVObjectManager> m_objManager;
     QTime joystickTime;
     QWidget *m_widget;
     QList<int> m_context;
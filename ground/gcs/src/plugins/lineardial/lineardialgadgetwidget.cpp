@@ -27,6 +27,7 @@
 
 #include "lineardialgadgetwidget.h"
 #include <utils/stylehelper.h>
+#include <math.h>
 #include <QFileDialog>
 #include <QOpenGLWidget>
 #include <QDebug>
@@ -49,15 +50,13 @@ LineardialGadgetWidget::LineardialGadgetWidget(QWidget *parent) : QGraphicsView(
     indexValue  = 0;
     places = 0;
     factor = 1;
-
-    // This timer mechanism makes the index rotate smoothly
-    connect(&dialTimer, SIGNAL(timeout()), this, SLOT(moveIndex()));
-    dialTimer.start(30);
 }
 
 LineardialGadgetWidget::~LineardialGadgetWidget()
 {
-    // Do nothing
+    if (Core::AnimationClock::instance()) {
+        Core::AnimationClock::instance()->stop(this);
+    }
 }
 
 /*!
@@ -149,8 +148,8 @@ void LineardialGadgetWidget::updateIndex(UAVObject *object1)
             fieldValue->setPlainText(s);
         }
 
-        if (index && !dialTimer.isActive()) {
-            dialTimer.start();
+        if (index) {
+            Core::AnimationClock::instance()->start(this, INDEX_STEP_MS);
         }
     } else {
         qDebug() << "Wrong field, maybe an issue with object disconnection ?";
@@ -344,8 +343,8 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
 
         // Reset the current index value:
         indexValue = 0;
-        if (!dialTimer.isActive() && index) {
-            dialTimer.start();
+        if (index) {
+            Core::AnimationClock::instance()->start(this, INDEX_STEP_MS);
         }
     } else {
         qDebug() << "no file ";
@@ -407,7 +406,7 @@ void LineardialGadgetWidget::resizeEvent(QResizeEvent *event)
 }
 
 // Converts the value into an percentage:
-// this enables smooth movement in moveIndex below
+// this enables smooth movement in advanceAnimation below
 void LineardialGadgetWidget::setIndex(double value)
 {
     if (verticalDial) {
@@ -419,18 +418,19 @@ void LineardialGadgetWidget::setIndex(double value)
 
 // Take an input value and move the index accordingly
 // Move is smooth, starts fast and slows down when
-// approaching the target.
-void LineardialGadgetWidget::moveIndex()
+// approaching the target, at the same speed whatever the
+// time between two frames.
+bool LineardialGadgetWidget::advanceAnimation(qint64 elapsedMs)
 {
     if (!index) { // Safeguard
-        dialTimer.stop();
-        return;
+        return false;
     }
+    bool moving = true;
     if ((abs(int((indexValue - indexTarget) * 10)) > 3)) {
-        indexValue += (indexTarget - indexValue) / 5;
+        indexValue += (indexTarget - indexValue) * (1.0 - pow(0.8, (double)elapsedMs / INDEX_STEP_MS));
     } else {
         indexValue = indexTarget;
-        dialTimer.stop();
+        moving     = false;
     }
     QTransform matrix;
     index->resetTransform();
@@ -443,4 +443,5 @@ void LineardialGadgetWidget::moveIndex()
     index->setTransform(matrix, false);
 
     update();
+    return moving;
 }
@@ -37,6 +37,7 @@
 #include <uavtalk/uavtalk.h>
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/actionmanager/actionmanager.h>
+#include <coreplugin/generalsettings.h>
 
 #include <QApplication>
 #include <QDebug>
@@ -75,7 +76,7 @@ QIODevice *LoggingConnection::openDevice(const QString &deviceName)
 {
     closeDevice(deviceName);
 
-    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("OpenPilot Log (*.opl)"));
+    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("OpenPilot Log (*.opl *.oplz)"));
     if (!fileName.isNull()) {
         logFile.setFileName(fileName);
         if (logFile.open(QIODevice::ReadOnly)) {
@@ -117,7 +118,7 @@ QString LoggingConnection::shortName()
     return QString("Logfile");
 }
 
-LoggingThread::LoggingThread() : QThread(), uavTalk(0)
+LoggingThread::LoggingThread() : QThread(), uavTalk(0), subscription(0)
 {}
 
 LoggingThread::~LoggingThread()
@@ -138,24 +139,29 @@ bool LoggingThread::openFile(QString file)
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
 
-    uavTalk = new UAVTalk(&logFile, objManager);
+    uavTalk = new UAVTalk(&logFile, objManager, settings->useUDPMirror());
 
     return true;
 };
 
 /**
- * Logs an object update to the file.  Data format is the
+ * Logs the object updates to the file.  Data format is the
  * timestamp as a 32 bit uint counting ms from start of
  * file writing (flight time will be embedded in stream),
  * then object packet size, then the packed UAVObject.
  */
-void LoggingThread::objectUpdated(UAVObject *obj)
+void LoggingThread::objectsUpdated(const UAVObjectUpdateSubscription::UpdateBatch &batch)
 {
     QWriteLocker locker(&lock);
 
-    if (!uavTalk->sendObject(obj, false, false)) {
-        qDebug() << "LoggingThread - error logging" << obj->getName();
+    foreach(const UAVObjectUpdateSubscription::Update &update, batch) {
+        // The values as they were when updated
+        UAVObject *obj = subscription->sample(update);
+        if (!uavTalk->sendObject(obj, false, false)) {
+            qDebug() << "LoggingThread - error logging" << obj->getName();
+        }
     }
 };
 
@@ -166,7 +172,7 @@ void LoggingThread::run()
 }
 
 /**
- * Connect signals from all the objects updates to the write routine then
+ * Subscribe the write routine to the updates of all the objects then
  * run event loop
  */
 void LoggingThread::startLogging()
@@ -176,17 +182,12 @@ void LoggingThread::startLogging()
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
-    QList< QList<UAVObject *> > list;
-    list = objManager->getObjects();
-    QList< QList<UAVObject *> >::const_iterator i;
-    QList<UAVObject *>::const_iterator j;
-    int objects = 0;
-
-    for (i = list.constBegin(); i != list.constEnd(); ++i) {
-        for (j = (*i).constBegin(); j != (*i).constEnd(); ++j) {
-            connect(*j, &UAVObject::objectUpdated, this, &LoggingThread::objectUpdated);
-            objects++;
-        }
+    {
+        QWriteLocker locker(&lock);
+        // One subscription for all objects, including the instances created later
+        subscription = objManager->getUpdateBus()->subscribe(this);
+        subscription->setDataCaptured(true);
+        connect(subscription, &UAVObjectUpdateSubscription::updated, this, &LoggingThread::objectsUpdated);
     }
 
     GCSTelemetryStats *gcsStatsObj = GCSTelemetryStats::GetInstance(objManager);
@@ -202,7 +203,7 @@ void LoggingThread::startLogging()
 }
 
 /**
- * Disconnect signals from all the objects, close the log file and stop
+ * Unsubscribe from the object updates, close the log file and stop
  * the event loop
  */
 void LoggingThread::stopLogging()
@@ -211,20 +212,9 @@ void LoggingThread::stopLogging()
 
     qDebug() << "LoggingThread - stop logging";
 
-    // Disconnect all objects we registered with:
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-
-    QList< QList<UAVObject *> > list;
-    list = objManager->getObjects();
-    QList< QList<UAVObject *> >::const_iterator i;
-    QList<UAVObject *>::const_iterator j;
-
-    for (i = list.constBegin(); i != list.constEnd(); ++i) {
-        for (j = (*i).constBegin(); j != (*i).constEnd(); ++j) {
-            disconnect(*j, &UAVObject::objectUpdated, this, &LoggingThread::objectUpdated);
-        }
-    }
+    // The updates not delivered yet are dropped with it
+    delete subscription;
+    subscription = 0;
 
     logFile.close();
 
@@ -355,12 +345,19 @@ bool LoggingPlugin::initialize(const QStringList & args, QString *errMsg)
 void LoggingPlugin::toggleLogging()
 {
     if (state == IDLE) {
+        QString compressedFilter = tr("Compressed OpenPilot Log (*.oplz)");
+        QString selectedFilter;
         QString fileName = QFileDialog::getSaveFileName(NULL, tr("Start Log"),
                                                         tr("OP-%0.opl").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss")),
-                                                        tr("OpenPilot Log (*.opl)"));
+                                                        tr("OpenPilot Log (*.opl)") + ";;" + compressedFilter,
+                                                        &selectedFilter);
         if (fileName.isEmpty()) {
             return;
         }
+        // The format follows the extension, the dialog does not always change it
+        if (selectedFilter == compressedFilter && fileName.endsWith(".opl")) {
+            fileName.append("z");
+        }
 
         startLogging(fileName);
     } else if (state == LOGGING) {
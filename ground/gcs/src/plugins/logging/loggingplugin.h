@@ -33,6 +33,7 @@
 #include <coreplugin/iconnection.h>
 #include <extensionsystem/iplugin.h>
 #include <utils/logfile.h>
+#include "uavobjectupdatebus.h"
 
 #include <QThread>
 #include <QQueue>
@@ -97,7 +98,7 @@ protected:
     void run();
 
 private slots:
-    void objectUpdated(UAVObject *obj);
+    void objectsUpdated(const UAVObjectUpdateSubscription::UpdateBatch &batch);
     void transactionCompleted(UAVObject *obj, bool success);
 
 private:
@@ -105,6 +106,7 @@ private:
     QQueue<UAVDataObject *> queue;
     LogFile logFile;
     UAVTalk *uavTalk;
+    UAVObjectUpdateSubscription *subscription;
 
     void retrieveSettings();
     void retrieveNextObject();
@@ -238,7 +238,7 @@ OPMapGadgetWidget::OPMapGadgetWidget(QWidget *parent) : QWidget(parent)
     connect(table, SIGNAL(receivePathPlanFromUAV()), UAVProxy, SLOT(receivePathPlan()));
 #endif
     magicWayPoint = m_map->magicWPCreate();
-    magicWayPoint->setVisible(false);
+    magicWayPoint->setUserVisible(false);
 
     m_map->setOverlayOpacity(0.5);
 
@@ -1295,7 +1295,7 @@ void OPMapGadgetWidget::setMapMode(opMapModeType mode)
 
         hideMagicWaypointControls();
 
-        magicWayPoint->setVisible(false);
+        magicWayPoint->setUserVisible(false);
         m_map->WPSetVisibleAll(true);
 
         break;
@@ -1311,7 +1311,7 @@ void OPMapGadgetWidget::setMapMode(opMapModeType mode)
         // delete the normal waypoints from the map
 
         m_map->WPSetVisibleAll(false);
-        magicWayPoint->setVisible(true);
+        magicWayPoint->setUserVisible(true);
 
         break;
     }
@@ -80,9 +80,8 @@ public:
         FieldTreeItem(index, data, parent), m_enumOptions(field->getOptions()), m_field(field) {}
     void setData(QVariant value, int column)
     {
-        QStringList options = m_field->getOptions();
-        QVariant tmpValue   = m_field->getValue(m_index);
-        int tmpValIndex     = options.indexOf(tmpValue.toString());
+        QVariant tmpValue = m_field->getValue(m_index);
+        int tmpValIndex   = m_field->getOptionIndex(tmpValue.toString());
         TreeItem::setData(value, column);
 
         setChanged(tmpValIndex != value);
@@ -104,9 +103,8 @@ public:
     }
     void update()
     {
-        QStringList options = m_field->getOptions();
         QVariant value = m_field->getValue(m_index);
-        int valIndex   = options.indexOf(value.toString());
+        int valIndex   = m_field->getOptionIndex(value.toString());
 
         if (data() != valIndex || changed()) {
             TreeItem::setData(valIndex);
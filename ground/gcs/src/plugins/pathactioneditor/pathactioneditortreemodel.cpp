@@ -164,9 +164,8 @@ void PathActionEditorTreeModel::addSingleField(int index, UAVObjectField *field,
         switch (type) {
         case UAVObjectField::ENUM:
         {
-            QStringList options = field->getOptions();
             QVariant value = field->getValue();
-            data.append(options.indexOf(value.toString()));
+            data.append(field->getOptionIndex(value.toString()));
             data.append(field->getUnits());
             item = new EnumFieldTreeItem(field, index, data);
             break;
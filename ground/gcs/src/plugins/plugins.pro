@@ -245,3 +245,11 @@ plugin_streamservice.depends = plugin_coreplugin
 plugin_streamservice.depends += plugin_uavobjects
 plugin_streamservice.depends += plugin_uavtalk
 SUBDIRS += plugin_streamservice
+
+# Shared memory export of UAV Objects (POSIX only)
+unix {
+    plugin_shmexport.subdir = shmexport
+    plugin_shmexport.depends = plugin_coreplugin
+    plugin_shmexport.depends += plugin_uavobjects
+    SUBDIRS += plugin_shmexport
+}
@@ -110,6 +110,38 @@ void PlotData::clear()
     }
 }
 
+/**
+ * Fill the plot with the samples recorded before it was created
+ */
+void PlotData::backfill(UAVObjectHistory *history)
+{
+    if (m_isEnumPlot || !history) {
+        return;
+    }
+
+    qint64 toMs   = QDateTime::currentMSecsSinceEpoch();
+    qint64 fromMs = plotType() == ChronoPlot ? toMs - (qint64)(m_plotDataSize * 1000.0) : 0;
+    UAVObjectHistory::View view = history->range(m_object, m_field, m_element, fromMs, toMs);
+
+    // The sequential plot keeps the last samples, the chrono plot the last seconds.
+    // The oldest ones of the view may already be overwritten by new updates.
+    int first    = plotType() == SequentialPlot ? qMax(0, view.size() - (int)m_plotDataSize) : 0;
+    double scale = pow(10, m_scalePower);
+    for (int i = qMax(first, view.overwritten()); i < view.size(); ++i) {
+        double currentValue = view.value(i) * scale;
+
+        if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
+            calcMathFunction(currentValue);
+        } else {
+            m_yDataEntries.append(currentValue);
+        }
+        m_xDataEntries.append(plotType() == SequentialPlot ? m_xDataEntries.size() : view.timestamp(i) / 1000.0);
+    }
+    if (!view.isValid()) {
+        qDebug() << "PlotData - history of" << m_object->getName() << "overwritten while read";
+    }
+}
+
 bool PlotData::hasData() const
 {
     if (!m_isEnumPlot) {
@@ -41,6 +41,7 @@
 #include <QTime>
 #include <QVector>
 #include <uavdataobject.h>
+#include <uavobjecthistory.h>
 
 /*!
    \brief Defines the different type of plots.
@@ -94,6 +95,7 @@ public:
 
     void updatePlotData();
     void clear();
+    void backfill(UAVObjectHistory *history);
 
     bool hasData() const;
     QString lastDataAsString();
@@ -129,6 +129,9 @@ ScopeGadgetWidget::~ScopeGadgetWidget()
 
         disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)));
     }
+    foreach(UAVObject * obj, m_historyObjects) {
+        objManager->getHistory()->untrack(obj);
+    }
 
     clearCurvePlots();
 }
@@ -406,7 +409,12 @@ void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubFie
     if (!m_connectedUAVObjects.contains(object->getName())) {
         m_connectedUAVObjects.append(object->getName());
         connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)));
+        // Keep recording while the scope is open, for the scopes opened later
+        if (objManager->getHistory()->track(object)) {
+            m_historyObjects.append(object);
+        }
     }
+    plotData->backfill(objManager->getHistory());
 
     m_mutex.lock();
     replot();
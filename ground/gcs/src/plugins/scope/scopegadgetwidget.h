@@ -152,6 +152,8 @@ private:
     double m_plotDataSize;
     int m_refreshInterval;
     QList<QString> m_connectedUAVObjects;
+    // Objects recorded in the object manager history on behalf of this scope
+    QList<UAVObject *> m_historyObjects;
     QMap<QString, PlotData *> m_curvesData;
 
     QTimer *replotTimer;
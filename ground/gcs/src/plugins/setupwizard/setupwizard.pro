@@ -1,7 +1,7 @@
 TEMPLATE = lib 
 TARGET = SetupWizard 
 
-QT += widgets svg
+QT += widgets svg concurrent
 
 include(../../plugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
@@ -43,7 +43,8 @@ HEADERS += \
     pages/selectionpage.h \
     pages/airframeinitialtuningpage.h \
     vehicletemplateexportdialog.h \
-    vehicletemplateselectorwidget.h
+    vehicletemplateselectorwidget.h \
+    vehicletemplatecatalog.h
 
 SOURCES += \
     setupwizardplugin.cpp \
@@ -78,7 +79,8 @@ SOURCES += \
     pages/selectionpage.cpp \
     pages/airframeinitialtuningpage.cpp \
     vehicletemplateexportdialog.cpp \
-    vehicletemplateselectorwidget.cpp
+    vehicletemplateselectorwidget.cpp \
+    vehicletemplatecatalog.cpp
 
 OTHER_FILES += SetupWizard.pluginspec
 
@@ -0,0 +1,241 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_vehicletemplatecatalog.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Vehicle template catalog index and its cache
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "vehicletemplatecatalog.h"
+
+#include <QtTest/QtTest>
+
+#include <QBuffer>
+#include <QImage>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+
+class tst_VehicleTemplateCatalog : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void index();
+    void cache();
+    void invalidation();
+    void corruptIndex();
+    void benchmark();
+
+private:
+    QTemporaryDir *m_dir;
+
+    QString templatePath(const QString &name) const;
+    QString indexPath() const;
+    QList<VehicleTemplateCatalog::Entry> scan() const;
+    void writeTemplate(const QString &name, const QString &uuid, bool photo, const QString &comment = QString());
+};
+
+void tst_VehicleTemplateCatalog::init()
+{
+    m_dir = new QTemporaryDir();
+    QVERIFY(m_dir->isValid());
+    QVERIFY(QDir(m_dir->path()).mkpath("templates"));
+}
+
+void tst_VehicleTemplateCatalog::cleanup()
+{
+    delete m_dir;
+}
+
+QString tst_VehicleTemplateCatalog::templatePath(const QString &name) const
+{
+    return QDir(m_dir->path()).filePath("templates/" + name);
+}
+
+QString tst_VehicleTemplateCatalog::indexPath() const
+{
+    return QDir(m_dir->path()).filePath("index/vehicletemplates.index");
+}
+
+QList<VehicleTemplateCatalog::Entry> tst_VehicleTemplateCatalog::scan() const
+{
+    VehicleTemplateCatalog::Directory directory = { QDir(m_dir->path()).filePath("templates"), true };
+
+    return VehicleTemplateCatalog::scan(QList<VehicleTemplateCatalog::Directory>() << directory, indexPath());
+}
+
+void tst_VehicleTemplateCatalog::writeTemplate(const QString &name, const QString &uuid, bool photo, const QString &comment)
+{
+    QJsonObject json;
+
+    json["name"]    = name;
+    json["uuid"]    = uuid;
+    json["type"]    = 1;
+    json["subtype"] = 2;
+    json["comment"] = comment;
+    if (photo) {
+        QImage image(640, 480, QImage::Format_RGB32);
+        image.fill(Qt::darkCyan);
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+        json["photo"] = QString::fromLatin1(png.toBase64());
+    }
+
+    QFile file(templatePath(name + ".optmpl"));
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write(QJsonDocument(json).toJson());
+}
+
+void tst_VehicleTemplateCatalog::index()
+{
+    writeTemplate("b", "{uuid-b}", false);
+    writeTemplate("a", "{uuid-a}", true);
+    QFile broken(templatePath("c.optmpl"));
+    QVERIFY(broken.open(QFile::WriteOnly));
+    broken.write("{ \"name\": ");
+    broken.close();
+
+    QList<VehicleTemplateCatalog::Entry> entries = scan();
+    QCOMPARE(entries.size(), 2);
+    QCOMPARE(entries.at(0).name, QString("a"));
+    QCOMPARE(entries.at(0).uuid, QString("{uuid-a}"));
+    QCOMPARE(entries.at(0).type, 1);
+    QCOMPARE(entries.at(0).subtype, 2);
+    QVERIFY(entries.at(0).editable);
+    QCOMPARE(entries.at(0).path, QFileInfo(templatePath("a.optmpl")).absoluteFilePath());
+    QCOMPARE(entries.at(1).name, QString("b"));
+    QVERIFY(entries.at(1).thumbnail.isEmpty());
+
+    QImage thumbnail;
+    QVERIFY(thumbnail.loadFromData(entries.at(0).thumbnail, "PNG"));
+    QCOMPARE(thumbnail.width(), (int)VehicleTemplateCatalog::THUMBNAIL_SIZE);
+    QCOMPARE(thumbnail.height(), VehicleTemplateCatalog::THUMBNAIL_SIZE * 3 / 4);
+
+    QJsonObject json = VehicleTemplateCatalog::load(entries.at(0).path);
+    QCOMPARE(json["uuid"].toString(), QString("{uuid-a}"));
+    QVERIFY(!json["photo"].toString().isEmpty());
+}
+
+void tst_VehicleTemplateCatalog::cache()
+{
+    writeTemplate("a", "{uuid-a}", true);
+    QCOMPARE(scan().size(), 1);
+    QVERIFY(QFile::exists(indexPath()));
+
+    // Prove a hit by renaming the template in the index only
+    {
+        QFile file(indexPath());
+        QVERIFY(file.open(QFile::ReadWrite));
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_6);
+        quint32 magic, version, count;
+        QString path, name, uuid;
+        qint32 type, subtype;
+        qint64 size, modified;
+        QByteArray thumbnail;
+        stream >> magic >> version >> count >> path >> name >> uuid >> type >> subtype >> size >> modified >> thumbnail;
+        QCOMPARE(count, (quint32)1);
+        QCOMPARE(name, QString("a"));
+        file.resize(0);
+        file.seek(0);
+        stream << magic << version << count << path << QString("indexed") << uuid << type << subtype << size << modified << thumbnail;
+    }
+    QList<VehicleTemplateCatalog::Entry> entries = scan();
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries.at(0).name, QString("indexed"));
+}
+
+void tst_VehicleTemplateCatalog::invalidation()
+{
+    writeTemplate("a", "{uuid-a}", false);
+    writeTemplate("b", "{uuid-b}", false);
+    QCOMPARE(scan().size(), 2);
+
+    // Edited, the size changes
+    writeTemplate("a", "{uuid-edited}", false, "a longer comment");
+    QList<VehicleTemplateCatalog::Entry> entries = scan();
+    QCOMPARE(entries.size(), 2);
+    QCOMPARE(entries.at(0).uuid, QString("{uuid-edited}"));
+
+    // Removed, also from the index
+    QVERIFY(QFile::remove(templatePath("b.optmpl")));
+    entries = scan();
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries.at(0).name, QString("a"));
+    writeTemplate("b", "{uuid-b}", false);
+    QCOMPARE(scan().size(), 2);
+}
+
+void tst_VehicleTemplateCatalog::corruptIndex()
+{
+    writeTemplate("a", "{uuid-a}", true);
+    QCOMPARE(scan().size(), 1);
+
+    QFile file(indexPath());
+    QVERIFY(file.open(QFile::ReadWrite));
+    file.resize(file.size() / 2);
+    file.close();
+
+    QList<VehicleTemplateCatalog::Entry> entries = scan();
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries.at(0).name, QString("a"));
+    QVERIFY(!entries.at(0).thumbnail.isEmpty());
+}
+
+/**
+ * Lists the shipped templates of every vehicle type, the first time and with the index
+ */
+void tst_VehicleTemplateCatalog::benchmark()
+{
+    QList<VehicleTemplateCatalog::Directory> directories;
+    qint64 bytes = 0;
+
+    foreach(const QFileInfo &info, QDir(VEHICLETEMPLATES_DIR).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        VehicleTemplateCatalog::Directory directory = { info.absoluteFilePath(), false };
+        directories << directory;
+        foreach(const QFileInfo &file, QDir(info.absoluteFilePath()).entryInfoList(QDir::Files)) {
+            bytes += file.size();
+        }
+    }
+    if (directories.isEmpty()) {
+        QSKIP("No vehicle templates in " VEHICLETEMPLATES_DIR);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    int count = VehicleTemplateCatalog::scan(directories, indexPath()).size();
+    double coldMs = timer.nsecsElapsed() / 1e6;
+
+    timer.restart();
+    QCOMPARE(VehicleTemplateCatalog::scan(directories, indexPath()).size(), count);
+    double warmMs = timer.nsecsElapsed() / 1e6;
+
+    qDebug("%d templates, %.1f MB", count, bytes / 1e6);
+    qDebug("first scan     %8.1f ms", coldMs);
+    qDebug("indexed scan   %8.1f ms", warmMs);
+    qDebug("index size     %8.1f kB", QFileInfo(indexPath()).size() / 1e3);
+    QVERIFY(warmMs < coldMs);
+}
+
+QTEST_GUILESS_MAIN(tst_VehicleTemplateCatalog)
+
+#include "tst_vehicletemplatecatalog.moc"
@@ -0,0 +1,25 @@
+#
+# Vehicle template catalog: indexing, index cache hits and invalidation, and the
+# time to list the shipped templates with and without the index, printed by the test
+#
+
+include(../../../../gcs.pri)
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = vehicletemplatecatalogtest
+
+QT = core gui testlib
+
+WIZARD_DIR = $$GCS_SOURCE_TREE/src/plugins/setupwizard
+
+DEFINES += VEHICLETEMPLATES_DIR=\\\"$$GCS_SOURCE_TREE/src/share/vehicletemplates\\\"
+
+INCLUDEPATH += $$WIZARD_DIR
+
+HEADERS += $$WIZARD_DIR/vehicletemplatecatalog.h
+
+SOURCES += \
+    tst_vehicletemplatecatalog.cpp \
+    $$WIZARD_DIR/vehicletemplatecatalog.cpp
@@ -0,0 +1,225 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehicletemplatecatalog.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup SetupWizard Setup Wizard
+ * @{
+ * @brief Index of the vehicle templates, cached on disk
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "vehicletemplatecatalog.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSet>
+
+static const quint32 INDEX_MAGIC   = 0x56544349; // "VTCI"
+static const quint32 INDEX_VERSION = 1;
+
+static QDataStream &operator<<(QDataStream &stream, const VehicleTemplateCatalog::Entry &entry)
+{
+    stream << entry.path << entry.name << entry.uuid << (qint32)entry.type << (qint32)entry.subtype
+           << entry.size << entry.modified << entry.thumbnail;
+    return stream;
+}
+
+static QDataStream &operator>>(QDataStream &stream, VehicleTemplateCatalog::Entry &entry)
+{
+    qint32 type;
+    qint32 subtype;
+
+    stream >> entry.path >> entry.name >> entry.uuid >> type >> subtype
+    >> entry.size >> entry.modified >> entry.thumbnail;
+    entry.type     = type;
+    entry.subtype  = subtype;
+    entry.editable = false;
+    return stream;
+}
+
+static QHash<QString, VehicleTemplateCatalog::Entry> readIndex(const QString &indexFile)
+{
+    QHash<QString, VehicleTemplateCatalog::Entry> entries;
+    QFile file(indexFile);
+
+    if (!file.open(QFile::ReadOnly)) {
+        return entries;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION) {
+        return entries;
+    }
+    for (quint32 i = 0; i < count; i++) {
+        VehicleTemplateCatalog::Entry entry;
+        stream >> entry;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "VehicleTemplateCatalog - ignoring corrupt index" << indexFile;
+            entries.clear();
+            break;
+        }
+        entries.insert(entry.path, entry);
+    }
+    return entries;
+}
+
+static void writeIndex(const QString &indexFile, const QHash<QString, VehicleTemplateCatalog::Entry> &entries)
+{
+    QDir().mkpath(QFileInfo(indexFile).absolutePath());
+    // Another scan may write the same index, the last one wins
+    QSaveFile file(indexFile);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "VehicleTemplateCatalog - could not write index" << indexFile << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << INDEX_MAGIC << INDEX_VERSION << (quint32)entries.size();
+    foreach(const VehicleTemplateCatalog::Entry &entry, entries) {
+        stream << entry;
+    }
+    if (!file.commit()) {
+        qWarning() << "VehicleTemplateCatalog - could not write index" << indexFile << file.errorString();
+    }
+}
+
+QList<VehicleTemplateCatalog::Entry> VehicleTemplateCatalog::scan(const QList<Directory> &directories, const QString &indexFile)
+{
+    QList<Entry> templates;
+    QHash<QString, Entry> entries = readIndex(indexFile);
+    bool changed = false;
+    QStringList names;
+
+    names << "*.optmpl";
+    names << "*.vtmpl"; // Vehicle template
+
+    foreach(const Directory &directory, directories) {
+        QDir templateDir(directory.path);
+
+        qDebug() << "Loading templates from base path:" << directory.path;
+        templateDir.setNameFilters(names);
+        templateDir.setSorting(QDir::Name);
+
+        QSet<QString> present;
+        foreach(const QFileInfo &fileInfo, templateDir.entryInfoList(QDir::Files)) {
+            QString path    = fileInfo.absoluteFilePath();
+            qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+            present.insert(path);
+            Entry entry = entries.value(path);
+            if (entry.path.isEmpty() || entry.size != fileInfo.size() || entry.modified != modified) {
+                if (!index(path, &entry)) {
+                    // Not indexed, parsed again next time
+                    changed |= entries.remove(path) > 0;
+                    continue;
+                }
+                entry.size     = fileInfo.size();
+                entry.modified = modified;
+                entries.insert(path, entry);
+                changed = true;
+            }
+            entry.editable = directory.editable;
+            templates.append(entry);
+        }
+
+        // Removed files
+        QString dirPath = templateDir.absolutePath();
+        QMutableHashIterator<QString, Entry> it(entries);
+        while (it.hasNext()) {
+            it.next();
+            if (!present.contains(it.key()) && QFileInfo(it.key()).absolutePath() == dirPath) {
+                it.remove();
+                changed = true;
+            }
+        }
+    }
+
+    if (changed && !indexFile.isEmpty()) {
+        writeIndex(indexFile, entries);
+    }
+    return templates;
+}
+
+QJsonObject VehicleTemplateCatalog::load(const QString &path, QString *errorString)
+{
+    QFile file(path);
+
+    if (!file.open(QFile::ReadOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return QJsonObject();
+    }
+
+    QJsonParseError error;
+    QJsonDocument templateDoc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        if (errorString) {
+            *errorString = error.errorString();
+        }
+        return QJsonObject();
+    }
+    return templateDoc.object();
+}
+
+bool VehicleTemplateCatalog::index(const QString &path, Entry *entry)
+{
+    QString errorString;
+    QJsonObject json = load(path, &errorString);
+
+    if (json.isEmpty()) {
+        qDebug() << "Error parsing json file: "
+                 << path << ". Error was:" << errorString;
+        return false;
+    }
+
+    entry->path    = path;
+    entry->name    = json["name"].toString();
+    entry->uuid    = json["uuid"].toString();
+    entry->type    = json["type"].toInt();
+    entry->subtype = json["subtype"].toInt();
+    entry->thumbnail.clear();
+
+    if (!json.value("photo").isUndefined()) {
+        QImage photo;
+        if (photo.loadFromData(QByteArray::fromBase64(json.value("photo").toString().toLatin1()), "PNG")) {
+            QImage thumbnail = photo.scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            QBuffer buffer(&entry->thumbnail);
+            buffer.open(QIODevice::WriteOnly);
+            thumbnail.save(&buffer, "PNG");
+        }
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehicletemplatecatalog.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup SetupWizard Setup Wizard
+ * @{
+ * @brief Index of the vehicle templates, cached on disk
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef VEHICLETEMPLATECATALOG_H
+#define VEHICLETEMPLATECATALOG_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+/**
+ * Templates are mostly their embedded photo, parsing all of them to list their
+ * names takes seconds. The catalog keeps what the list needs, with a small
+ * thumbnail, in an index file. A template is parsed again only when its size or
+ * modification time changed, the whole template is loaded on selection.
+ *
+ * scan() only does file I/O and QImage work, it can run off the GUI thread.
+ */
+class VehicleTemplateCatalog {
+public:
+    struct Directory {
+        QString path;
+        // Templates added by the user
+        bool editable;
+    };
+
+    struct Entry {
+        QString path;
+        QString name;
+        QString uuid;
+        int type;
+        int subtype;
+        bool editable;
+        // File at the time it was indexed
+        qint64 size;
+        qint64 modified;
+        // PNG, empty without photo
+        QByteArray thumbnail;
+    };
+
+    static const int THUMBNAIL_SIZE = 64;
+
+    // Templates of the directories in order, by file name in each. Parse errors are skipped.
+    static QList<Entry> scan(const QList<Directory> &directories, const QString &indexFile);
+
+    // Parses the whole template
+    static QJsonObject load(const QString &path, QString *errorString = 0);
+
+private:
+    static bool index(const QString &path, Entry *entry);
+};
+
+#endif // VEHICLETEMPLATECATALOG_H
@@ -33,15 +33,34 @@
 #include <QDebug>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QtConcurrent/QtConcurrentRun>
 #include "vehicletemplateexportdialog.h"
 #include "utils/pathutils.h"
 
+QJsonObject *VehicleTemplate::templateObject()
+{
+    if (!m_templateObject) {
+        QString errorString;
+        QJsonObject json = VehicleTemplateCatalog::load(m_entry.path, &errorString);
+        if (json.isEmpty()) {
+            qDebug() << "Error parsing json file: "
+                     << m_entry.path << ". Error was:" << errorString;
+            return NULL;
+        }
+        m_templateObject = new QJsonObject(json);
+    }
+    return m_templateObject;
+}
+
 VehicleTemplateSelectorWidget::VehicleTemplateSelectorWidget(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::VehicleTemplateSelectorWidget), m_photoItem(NULL)
 {
     ui->setupUi(this);
     ui->templateImage->setScene(new QGraphicsScene());
+    ui->templateList->setIconSize(QSize(VehicleTemplateCatalog::THUMBNAIL_SIZE / 2, VehicleTemplateCatalog::THUMBNAIL_SIZE / 2));
+    m_catalogWatcher = new QFutureWatcher<QList<VehicleTemplateCatalog::Entry> >(this);
+    connect(m_catalogWatcher, SIGNAL(finished()), this, SLOT(templatesLoaded()));
     connect(ui->templateList, SIGNAL(itemSelectionChanged()), this, SLOT(templateSelectionChanged()));
     connect(ui->deleteTemplateButton, SIGNAL(clicked()), this, SLOT(deleteSelectedTemplate()));
     connect(ui->addTemplateButton, SIGNAL(clicked()), this, SLOT(addTemplate()));
@@ -66,14 +85,21 @@ void VehicleTemplateSelectorWidget::setTemplateInfo(int vehicleType, int vehicle
     updateTemplates();
 }
 
-QJsonObject *VehicleTemplateSelectorWidget::selectedTemplate() const
+VehicleTemplate *VehicleTemplateSelectorWidget::selectedVehicleTemplate() const
 {
     if (ui->templateList->currentRow() >= 0) {
-        return ui->templateList->item(ui->templateList->currentRow())->data(Qt::UserRole + 1).value<QJsonObject *>();
+        return m_templates.value(ui->templateList->item(ui->templateList->currentRow())->data(Qt::UserRole + 1).toString(), NULL);
     }
     return NULL;
 }
 
+QJsonObject *VehicleTemplateSelectorWidget::selectedTemplate() const
+{
+    VehicleTemplate *templ = selectedVehicleTemplate();
+
+    return templ ? templ->templateObject() : NULL;
+}
+
 bool VehicleTemplateSelectorWidget::selectedTemplateEditable() const
 {
     if (ui->templateList->currentRow() >= 0) {
@@ -104,10 +130,9 @@ void VehicleTemplateSelectorWidget::deleteSelectedTemplate()
                                   QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
             QFile fileToDelete(selectedTemplatePath());
             if (fileToDelete.remove()) {
-                QJsonObject *templObj = selectedTemplate();
-                if (templObj) {
-                    VehicleTemplate *templ = m_templates[templObj->value("uuid").toString()];
-                    m_templates.remove(templObj->value("uuid").toString());
+                VehicleTemplate *templ = selectedVehicleTemplate();
+                if (templ) {
+                    m_templates.remove(templ->entry().uuid);
                     delete templ;
                 }
                 delete ui->templateList->item(ui->templateList->currentRow());
@@ -239,42 +264,6 @@ QString VehicleTemplateSelectorWidget::getTemplatePath()
     }
 }
 
-void VehicleTemplateSelectorWidget::loadFilesInDir(QString templateBasePath, bool local)
-{
-    QDir templateDir(templateBasePath);
-
-    qDebug() << "Loading templates from base path:" << templateBasePath;
-    QStringList names;
-    names << "*.optmpl";
-    names << "*.vtmpl"; // Vehicle template
-    templateDir.setNameFilters(names);
-    templateDir.setSorting(QDir::Name);
-    QStringList files = templateDir.entryList();
-    foreach(QString fileName, files) {
-        QString fullPathName = QString("%1/%2").arg(templateDir.absolutePath()).arg(fileName);
-        QFile file(fullPathName);
-
-        if (file.open(QFile::ReadOnly)) {
-            QByteArray jsonData = file.readAll();
-            QJsonParseError error;
-            QJsonDocument templateDoc = QJsonDocument::fromJson(jsonData, &error);
-            if (error.error == QJsonParseError::NoError) {
-                QJsonObject json = templateDoc.object();
-                if (airframeIsCompatible(json["type"].toInt(), json["subtype"].toInt())) {
-                    QString uuid = json["uuid"].toString();
-                    if (!m_templates.contains(uuid)) {
-                        m_templates[json["uuid"].toString()] = new VehicleTemplate(new QJsonObject(json), local, fullPathName);
-                    }
-                }
-            } else {
-                qDebug() << "Error parsing json file: "
-                         << fileName << ". Error was:" << error.errorString();
-            }
-        }
-        file.close();
-    }
-}
-
 void VehicleTemplateSelectorWidget::loadValidFiles()
 {
     ui->templateList->clear();
@@ -283,8 +272,26 @@ void VehicleTemplateSelectorWidget::loadValidFiles()
     }
     m_templates.clear();
     QString path = getTemplatePath();
-    loadFilesInDir(QString("%1/%2/").arg(Utils::InsertDataPath("%%DATAPATH%%vehicletemplates")).arg(path), false);
-    loadFilesInDir(QString("%1/%2/").arg(Utils::InsertStoragePath("%%STOREPATH%%vehicletemplates")).arg(path), true);
+    VehicleTemplateCatalog::Directory builtIn = { QString("%1/%2/").arg(Utils::InsertDataPath("%%DATAPATH%%vehicletemplates")).arg(path), false };
+    VehicleTemplateCatalog::Directory local   = { QString("%1/%2/").arg(Utils::InsertStoragePath("%%STOREPATH%%vehicletemplates")).arg(path), true };
+    QList<VehicleTemplateCatalog::Directory> directories;
+    directories << builtIn << local;
+
+    // Off the GUI thread, templatesLoaded() fills the list.
+    // A scan still running is superseded, its result is dropped.
+    m_catalogWatcher->setFuture(QtConcurrent::run(&VehicleTemplateCatalog::scan, directories,
+                                                  Utils::InsertStoragePath("%%STOREPATH%%vehicletemplates.index")));
+}
+
+void VehicleTemplateSelectorWidget::templatesLoaded()
+{
+    foreach(const VehicleTemplateCatalog::Entry &entry, m_catalogWatcher->result()) {
+        if (airframeIsCompatible(entry.type, entry.subtype) && !m_templates.contains(entry.uuid)) {
+            m_templates[entry.uuid] = new VehicleTemplate(entry);
+        }
+    }
+    ui->templateList->clear();
+    setupTemplateList();
 }
 
 void VehicleTemplateSelectorWidget::setupTemplateList()
@@ -294,9 +301,14 @@ void VehicleTemplateSelectorWidget::setupTemplateList()
     foreach(QString templ, m_templates.keys()) {
         VehicleTemplate *vtemplate = m_templates[templ];
 
-        item = new QListWidgetItem(vtemplate->templateObject()->value("name").toString(), ui->templateList);
-        item->setData(Qt::UserRole + 1, QVariant::fromValue(vtemplate->templateObject()));
+        item = new QListWidgetItem(vtemplate->entry().name, ui->templateList);
+        item->setData(Qt::UserRole + 1, QVariant::fromValue(templ));
         item->setData(Qt::UserRole + 2, QVariant::fromValue(vtemplate->editable()));
+        if (!vtemplate->entry().thumbnail.isEmpty()) {
+            QPixmap thumbnail;
+            thumbnail.loadFromData(vtemplate->entry().thumbnail, "PNG");
+            item->setIcon(QIcon(thumbnail));
+        }
         if (vtemplate->editable()) {
             item->setData(Qt::ForegroundRole, QVariant::fromValue(QColor(Qt::darkGreen)));
             item->setData(Qt::ToolTipRole, QVariant::fromValue(tr("Local template.")));
@@ -308,7 +320,7 @@ void VehicleTemplateSelectorWidget::setupTemplateList()
     ui->templateList->sortItems(Qt::AscendingOrder);
 
     item = new QListWidgetItem(tr("Current Tuning"));
-    item->setData(Qt::UserRole + 1, QVariant::fromValue((QJsonObject *)NULL));
+    item->setData(Qt::UserRole + 1, QVariant::fromValue(QString()));
     ui->templateList->insertItem(0, item);
     ui->templateList->setCurrentRow(0);
     // TODO Add generics to top under item Current tuning
@@ -28,6 +28,9 @@
 #ifndef VEHICLETEMPLATESELECTORWIDGET_H
 #define VEHICLETEMPLATESELECTORWIDGET_H
 
+#include "vehicletemplatecatalog.h"
+
+#include <QFutureWatcher>
 #include <QGraphicsItem>
 #include <QJsonObject>
 #include <QWidget>
@@ -38,8 +41,8 @@ class VehicleTemplateSelectorWidget;
 
 class VehicleTemplate {
 public:
-    VehicleTemplate(QJsonObject *templateObject, bool editable, QString templatePath) :
-        m_templateObject(templateObject), m_editable(editable), m_templatePath(templatePath) {}
+    VehicleTemplate(const VehicleTemplateCatalog::Entry &entry) :
+        m_entry(entry), m_templateObject(NULL) {}
 
     ~VehicleTemplate()
     {
@@ -48,25 +51,27 @@ public:
         }
     }
 
-    QJsonObject *templateObject()
+    // Parsed on first use, NULL if the file can't be read anymore
+    QJsonObject *templateObject();
+
+    const VehicleTemplateCatalog::Entry &entry() const
     {
-        return m_templateObject;
+        return m_entry;
     }
 
     bool editable()
     {
-        return m_editable;
+        return m_entry.editable;
     }
 
     QString templatePath()
     {
-        return m_templatePath;
+        return m_entry.path;
     }
 
 private:
+    VehicleTemplateCatalog::Entry m_entry;
     QJsonObject *m_templateObject;
-    bool m_editable;
-    QString m_templatePath;
 };
 
 class VehicleTemplateSelectorWidget : public QWidget {
@@ -91,9 +96,9 @@ private:
 
     QMap<QString, VehicleTemplate *> m_templates;
     QGraphicsPixmapItem *m_photoItem;
+    QFutureWatcher<QList<VehicleTemplateCatalog::Entry> > *m_catalogWatcher;
 
     void loadValidFiles();
-    void loadFilesInDir(QString templateBasePath, bool local);
     void setupTemplateList();
     QString getTemplateKey(QJsonObject *templ);
     void updatePhoto(QJsonObject *templ);
@@ -102,9 +107,11 @@ private:
     QString getTemplatePath();
     bool selectedTemplateEditable() const;
     QString selectedTemplatePath() const;
+    VehicleTemplate *selectedVehicleTemplate() const;
 
 private slots:
     void updateTemplates();
+    void templatesLoaded();
     void deleteSelectedTemplate();
     void addTemplate();
 };
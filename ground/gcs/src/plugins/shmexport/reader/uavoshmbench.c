@@ -0,0 +1,254 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavoshmbench.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmExportPlugin Shared Memory Export Plugin
+ * @{
+ * @brief Reader latency and throughput benchmark for the shared memory export
+ *
+ * Usage: uavoshmbench [-r readers] [-d seconds] [-w rate] [-n name]
+ *
+ * Forks the given number of reader processes which follow the event ring and
+ * read the updated slot for each event. Each reader reports the latency
+ * between the update and its read (median, 99th percentile, max) and its
+ * read throughput.
+ *
+ * Without -w the readers attach to a running GCS. With -w the benchmark
+ * creates the region itself and publishes synthetic updates of 64 objects
+ * at the given rate (updates/s), which allows measurements without a board.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavoshmreader.h"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_OBJECTS     64
+#define BENCH_OBJECT_SIZE 64
+#define MAX_SAMPLES       (1 << 22)
+
+static int compareU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void sleepUs(uint64_t us)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000;
+    nanosleep(&ts, NULL);
+}
+
+static int runReader(int id, const char *name, int seconds)
+{
+    UAVOShmReader reader;
+    UAVOShmEvent events[256];
+    uint8_t data[UAVOSHM_MAX_DATA];
+    uint32_t *samples;
+    uint64_t lost = 0;
+    uint64_t reads = 0;
+    uint64_t start, end;
+    int count = 0;
+    int n;
+
+    for (n = 0; uavoshm_open(&reader, name) != 0; ++n) {
+        if (n > 100) {
+            perror("uavoshm_open");
+            return 1;
+        }
+        sleepUs(10000);
+    }
+    samples = malloc(MAX_SAMPLES * sizeof(uint32_t));
+    if (samples == NULL) {
+        perror("malloc");
+        uavoshm_close(&reader);
+        return 1;
+    }
+
+    start   = uavoshm_now_us();
+    end     = start + (uint64_t)seconds * 1000000ULL;
+    while (uavoshm_now_us() < end) {
+        int num = uavoshm_read_events(&reader, events, 256, &lost);
+        if (num == 0) {
+            // Busy polling gives the lowest latency, yield to stay fair with the writer
+            sched_yield();
+            continue;
+        }
+        for (n = 0; n < num; ++n) {
+            uint64_t timestamp;
+            if (uavoshm_read_slot(&reader, events[n].slotIndex, data, sizeof(data), &timestamp, NULL) < 0) {
+                continue;
+            }
+            ++reads;
+            if (count < MAX_SAMPLES) {
+                // Latency of this event, the slot may already hold a newer value
+                samples[count++] = (uint32_t)(uavoshm_now_us() - events[n].timestampUs);
+            }
+        }
+    }
+    end = uavoshm_now_us();
+
+    qsort(samples, count, sizeof(uint32_t), compareU32);
+    printf("reader %d: %llu reads, %.0f reads/s, %llu lost, latency us p50 %u p99 %u max %u\n",
+           id, (unsigned long long)reads, reads * 1e6 / (double)(end - start), (unsigned long long)lost,
+           count ? samples[count / 2] : 0, count ? samples[(uint64_t)count * 99 / 100] : 0,
+           count ? samples[count - 1] : 0);
+
+    free(samples);
+    uavoshm_close(&reader);
+    return 0;
+}
+
+static int runWriter(const char *name, int rate, int seconds)
+{
+    uint64_t size = uavoshm_region_size(UAVOSHM_SLOT_COUNT, UAVOSHM_RING_SIZE);
+    UAVOShmHeader *header;
+    UAVOShmSlot *slots;
+    UAVOShmEvent *ring;
+    uint64_t start, now, published = 0;
+    int fd;
+    int n;
+
+    // Never take over the region of a running GCS
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        return 1;
+    }
+    if (ftruncate(fd, size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        return 1;
+    }
+    header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (header == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    header->version    = UAVOSHM_VERSION;
+    header->headerSize = sizeof(UAVOShmHeader);
+    header->slotSize   = sizeof(UAVOShmSlot);
+    header->eventSize  = sizeof(UAVOShmEvent);
+    header->slotCount  = UAVOSHM_SLOT_COUNT;
+    header->ringSize   = UAVOSHM_RING_SIZE;
+    header->writerPid  = getpid();
+    header->slotOffset = sizeof(UAVOShmHeader);
+    header->ringOffset = header->slotOffset + (uint64_t)UAVOSHM_SLOT_COUNT * sizeof(UAVOShmSlot);
+    slots = (UAVOShmSlot *)((char *)header + header->slotOffset);
+    ring  = (UAVOShmEvent *)((char *)header + header->ringOffset);
+    for (n = 0; n < BENCH_OBJECTS; ++n) {
+        slots[n].objId    = 0x1000 + n;
+        slots[n].numBytes = BENCH_OBJECT_SIZE;
+    }
+    header->slotsUsed = BENCH_OBJECTS;
+    __atomic_store_n(&header->magic, UAVOSHM_MAGIC, __ATOMIC_RELEASE);
+
+    start = uavoshm_now_us();
+    do {
+        now = uavoshm_now_us();
+        // Catch up with the requested rate
+        while (published < (now - start) * rate / 1000000ULL) {
+            uint32_t index = published % BENCH_OBJECTS;
+            UAVOShmSlot *slot   = &slots[index];
+            UAVOShmEvent *event = &ring[published & (UAVOSHM_RING_SIZE - 1)];
+            uint32_t seq = slot->seq;
+
+            __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            memset(slot->data, (int)published, BENCH_OBJECT_SIZE);
+            slot->timestampUs = uavoshm_now_us();
+            slot->updateCount++;
+            __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+
+            __atomic_store_n(&event->seq, 0, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            event->timestampUs = slot->timestampUs;
+            event->slotIndex   = index;
+            event->objId  = slot->objId;
+            event->instId = 0;
+            __atomic_store_n(&event->seq, published + 1, __ATOMIC_RELEASE);
+            __atomic_store_n(&header->ringHead, ++published, __ATOMIC_RELEASE);
+        }
+        sleepUs(100);
+    } while (now - start < (uint64_t)seconds * 1000000ULL);
+
+    printf("writer: %llu updates\n", (unsigned long long)published);
+    munmap(header, size);
+    close(fd);
+    shm_unlink(name);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *name = UAVOSHM_DEFAULT_NAME;
+    int readers = 1;
+    int seconds = 10;
+    int rate    = 0;
+    int opt;
+    int n;
+
+    while ((opt = getopt(argc, argv, "r:d:w:n:")) != -1) {
+        switch (opt) {
+        case 'r':
+            readers = atoi(optarg);
+            break;
+        case 'd':
+            seconds = atoi(optarg);
+            break;
+        case 'w':
+            rate = atoi(optarg);
+            break;
+        case 'n':
+            name = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-r readers] [-d seconds] [-w rate] [-n name]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (n = 0; n < readers; ++n) {
+        if (fork() == 0) {
+            return runReader(n, name, seconds);
+        }
+    }
+    if (rate > 0) {
+        // Let the readers run a little longer than the writer so that they see every update
+        runWriter(name, rate, seconds > 1 ? seconds - 1 : 1);
+    }
+    for (n = 0; n < readers; ++n) {
+        wait(NULL);
+    }
+    return 0;
+}
@@ -0,0 +1,15 @@
+# Standalone reader benchmark for the shared memory export, not part of the GCS build
+TEMPLATE = app
+TARGET = uavoshmbench
+CONFIG += console
+CONFIG -= qt app_bundle
+
+HEADERS += \
+    ../uavoshm.h \
+    uavoshmreader.h
+
+SOURCES += \
+    uavoshmreader.c \
+    uavoshmbench.c
+
+linux-*:LIBS += -lrt
@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavoshmreader.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmExportPlugin Shared Memory Export Plugin
+ * @{
+ * @brief Reader side of the UAVObject shared memory export
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavoshmreader.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+/* An update takes a copy of at most UAVOSHM_MAX_DATA bytes, the writer is gone long before this */
+#define READ_SLOT_TRIES 100000
+
+uint64_t uavoshm_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+int uavoshm_open(UAVOShmReader *reader, const char *name)
+{
+    struct stat st;
+    const UAVOShmHeader *header;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = shm_open(name ? name : UAVOSHM_DEFAULT_NAME, O_RDONLY, 0);
+    if (reader->fd < 0) {
+        return -1;
+    }
+    if (fstat(reader->fd, &st) != 0 || (size_t)st.st_size < sizeof(UAVOShmHeader)) {
+        close(reader->fd);
+        errno = EAGAIN;
+        return -1;
+    }
+    reader->size = st.st_size;
+    reader->base = mmap(NULL, reader->size, PROT_READ, MAP_SHARED, reader->fd, 0);
+    if (reader->base == MAP_FAILED) {
+        close(reader->fd);
+        return -1;
+    }
+
+    header = (const UAVOShmHeader *)reader->base;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != UAVOSHM_MAGIC ||
+        header->version != UAVOSHM_VERSION ||
+        header->slotSize != sizeof(UAVOShmSlot) ||
+        header->eventSize != sizeof(UAVOShmEvent) ||
+        uavoshm_region_size(header->slotCount, header->ringSize) > reader->size) {
+        munmap(reader->base, reader->size);
+        close(reader->fd);
+        errno = EPROTO;
+        return -1;
+    }
+
+    reader->header = header;
+    reader->slots  = (const UAVOShmSlot *)((const char *)reader->base + header->slotOffset);
+    reader->ring   = header->ringSize ? (const UAVOShmEvent *)((const char *)reader->base + header->ringOffset) : NULL;
+    reader->tail   = __atomic_load_n(&header->ringHead, __ATOMIC_ACQUIRE);
+    return 0;
+}
+
+void uavoshm_close(UAVOShmReader *reader)
+{
+    if (reader->header) {
+        munmap(reader->base, reader->size);
+        close(reader->fd);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+int uavoshm_find_slot(const UAVOShmReader *reader, uint32_t objId, uint16_t instId)
+{
+    uint32_t used = __atomic_load_n(&reader->header->slotsUsed, __ATOMIC_ACQUIRE);
+    uint32_t n;
+
+    for (n = 0; n < used; ++n) {
+        if (reader->slots[n].objId == objId && reader->slots[n].instId == instId) {
+            return (int)n;
+        }
+    }
+    return -1;
+}
+
+int uavoshm_read_slot(const UAVOShmReader *reader, int slot, void *data, size_t size,
+                      uint64_t *timestampUs, uint32_t *updateCount)
+{
+    const UAVOShmSlot *s = &reader->slots[slot];
+    uint32_t seq1, seq2 = 0;
+    uint64_t timestamp = 0;
+    uint32_t count     = 0;
+    int tries = 0;
+
+    if (size < s->numBytes) {
+        return -1;
+    }
+
+    do {
+        if (++tries > READ_SLOT_TRIES) {
+            /* The writer died in the middle of an update, or keeps updating faster than we copy */
+            errno = EAGAIN;
+            return -1;
+        }
+        seq1 = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (seq1 & 1) {
+            continue;
+        }
+        memcpy(data, s->data, s->numBytes);
+        timestamp = s->timestampUs;
+        count     = s->updateCount;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq2 = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+    } while ((seq1 & 1) || seq1 != seq2);
+
+    if (timestampUs) {
+        *timestampUs = timestamp;
+    }
+    if (updateCount) {
+        *updateCount = count;
+    }
+    return s->numBytes;
+}
+
+int uavoshm_read_events(UAVOShmReader *reader, UAVOShmEvent *events, int maxEvents, uint64_t *lost)
+{
+    uint64_t head;
+    uint32_t ringSize;
+    int count = 0;
+
+    if (reader->ring == NULL) {
+        return 0;
+    }
+
+    ringSize = reader->header->ringSize;
+    head     = __atomic_load_n(&reader->header->ringHead, __ATOMIC_ACQUIRE);
+    if (head - reader->tail > ringSize) {
+        if (lost) {
+            *lost += head - reader->tail - ringSize;
+        }
+        reader->tail = head - ringSize;
+    }
+
+    while (reader->tail < head && count < maxEvents) {
+        const UAVOShmEvent *e = &reader->ring[reader->tail & (ringSize - 1)];
+        uint64_t expected     = reader->tail + 1;
+
+        if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) == expected) {
+            events[count] = *e;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&e->seq, __ATOMIC_RELAXED) == expected) {
+                ++count;
+            } else if (lost) {
+                ++*lost;
+            }
+        } else if (lost) {
+            // Overwritten by the writer lapping us
+            ++*lost;
+        }
+        ++reader->tail;
+    }
+    return count;
+}
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavoshmreader.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmExportPlugin Shared Memory Export Plugin
+ * @{
+ * @brief Reader side of the UAVObject shared memory export
+ *
+ * Plain C, depends only on POSIX. Several processes can read concurrently,
+ * readers never block the GCS.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOSHMREADER_H
+#define UAVOSHMREADER_H
+
+#include "../uavoshm.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int    fd;
+    void   *base;
+    size_t size;
+    const UAVOShmHeader *header;
+    const UAVOShmSlot   *slots;
+    const UAVOShmEvent  *ring;
+    uint64_t tail; /* next event to read */
+} UAVOShmReader;
+
+/**
+ * Attach to the region published by the GCS.
+ * \param name Region name, NULL for UAVOSHM_DEFAULT_NAME
+ * \return 0 on success, -1 on failure (errno is set)
+ */
+int uavoshm_open(UAVOShmReader *reader, const char *name);
+void uavoshm_close(UAVOShmReader *reader);
+
+/**
+ * Look up the slot of an object instance.
+ * \return The slot index or -1 if the object has not been registered (yet)
+ */
+int uavoshm_find_slot(const UAVOShmReader *reader, uint32_t objId, uint16_t instId);
+
+/**
+ * Copy a consistent snapshot of a slot.
+ * \param data Destination buffer, at least the object size
+ * \param timestampUs Optional, receives the CLOCK_MONOTONIC update time
+ * \param updateCount Optional, receives the number of updates so far
+ * \return Number of bytes copied, or -1 if the buffer is too small or if no
+ *         consistent snapshot could be taken (errno is set to EAGAIN)
+ */
+int uavoshm_read_slot(const UAVOShmReader *reader, int slot, void *data, size_t size,
+                      uint64_t *timestampUs, uint32_t *updateCount);
+
+/**
+ * Fetch the update events published since the last call.
+ * The first call starts at the current head of the ring.
+ * \param lost Optional, incremented by the number of events overwritten before they could be read
+ * \return Number of events copied, 0 if none or if the ring is disabled
+ */
+int uavoshm_read_events(UAVOShmReader *reader, UAVOShmEvent *events, int maxEvents, uint64_t *lost);
+
+/**
+ * Current time on the clock used for the slot and event timestamps
+ */
+uint64_t uavoshm_now_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UAVOSHMREADER_H
@@ -0,0 +1,20 @@
+TEMPLATE = lib
+TARGET = ShmExportPlugin
+
+include(../../plugin.pri)
+include(../../plugins/coreplugin/coreplugin.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+
+linux-*:LIBS += -lrt
+
+HEADERS += \
+    uavoshm.h \
+    shmexportplugin.h
+
+SOURCES += shmexportplugin.cpp
+
+OTHER_FILES += \
+    ShmExportPlugin.pluginspec \
+    reader/uavoshmreader.h \
+    reader/uavoshmreader.c \
+    reader/uavoshmbench.c
@@ -0,0 +1,289 @@
+/**
+ ******************************************************************************
+ *
+ * @file       shmexportplugin.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmExportPlugin Shared Memory Export Plugin
+ * @{
+ * @brief Exports UAV Objects to co-located processes through shared memory
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "shmexportplugin.h"
+
+#include "extensionsystem/pluginmanager.h"
+#include "../uavobjects/uavobjectmanager.h"
+
+#include <QDebug>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+static quint64 monotonicTimeUs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (quint64)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+ShmExportPlugin::ShmExportPlugin() :
+    m_name(UAVOSHM_DEFAULT_NAME),
+    m_events(true),
+    m_fd(-1),
+    m_region(MAP_FAILED),
+    m_size(0),
+    m_header(NULL),
+    m_slots(NULL),
+    m_ring(NULL)
+{}
+
+ShmExportPlugin::~ShmExportPlugin()
+{
+    destroyRegion();
+}
+
+bool ShmExportPlugin::initialize(const QStringList &arguments, QString *errorString)
+{
+    for (int i = 0; i < arguments.size(); ++i) {
+        if (arguments.at(i) == "-shmname" && i + 1 < arguments.size()) {
+            m_name = arguments.at(++i).toLocal8Bit();
+            if (!m_name.startsWith('/')) {
+                m_name.prepend('/');
+            }
+        } else if (arguments.at(i) == "-shmnoevents") {
+            m_events = false;
+        }
+    }
+
+    // Another instance exporting under the same name is no reason to fail the GCS
+    QString error;
+    if (!createRegion(&error)) {
+        qWarning() << "ShmExportPlugin -" << error << "- export disabled";
+    }
+    Q_UNUSED(errorString);
+    return true;
+}
+
+void ShmExportPlugin::extensionsInitialized()
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+
+    Q_ASSERT(objManager);
+
+    if (m_region == MAP_FAILED) {
+        return;
+    }
+    foreach(QList<UAVObject *> list, objManager->getObjects()) {
+        foreach(UAVObject * obj, list) {
+            newObject(obj);
+        }
+    }
+    connect(objManager, &UAVObjectManager::newObject, this, &ShmExportPlugin::newObject);
+    connect(objManager, &UAVObjectManager::newInstance, this, &ShmExportPlugin::newObject);
+}
+
+void ShmExportPlugin::shutdown()
+{
+    foreach(UAVObject * obj, m_slotIndex.keys()) {
+        disconnect(obj, 0, this, 0);
+    }
+    m_slotIndex.clear();
+    destroyRegion();
+}
+
+/**
+ * Process id of the writer of an existing region, 0 if it can't be read
+ */
+static pid_t regionWriter(const char *name)
+{
+    pid_t pid = 0;
+    int fd    = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(UAVOShmHeader)) {
+        void *region = mmap(NULL, sizeof(UAVOShmHeader), PROT_READ, MAP_SHARED, fd, 0);
+        if (region != MAP_FAILED) {
+            pid = static_cast<const UAVOShmHeader *>(region)->writerPid;
+            munmap(region, sizeof(UAVOShmHeader));
+        }
+    }
+    close(fd);
+    return pid;
+}
+
+/**
+ * Create the shared memory region and initialize its header.
+ * A stale region left over by a previous crashed instance is replaced,
+ * the region of an instance still running is left alone.
+ */
+bool ShmExportPlugin::createRegion(QString *errorString)
+{
+    quint32 ringSize = m_events ? UAVOSHM_RING_SIZE : 0;
+
+    m_size = uavoshm_region_size(UAVOSHM_SLOT_COUNT, ringSize);
+
+    m_fd   = shm_open(m_name.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (m_fd < 0 && errno == EEXIST) {
+        pid_t writer = regionWriter(m_name.constData());
+        if (writer > 0 && (kill(writer, 0) == 0 || errno == EPERM)) {
+            *errorString = tr("Shared memory region %1 is in use by process %2, use -shmname to export under another name")
+                           .arg(QString(m_name)).arg(writer);
+            return false;
+        }
+        qDebug() << "ShmExportPlugin - replacing stale region" << m_name << "of process" << writer;
+        shm_unlink(m_name.constData());
+        m_fd = shm_open(m_name.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (m_fd < 0) {
+        *errorString = tr("Couldn't create shared memory region %1: %2").arg(QString(m_name)).arg(strerror(errno));
+        return false;
+    }
+    if (ftruncate(m_fd, m_size) != 0) {
+        *errorString = tr("Couldn't size shared memory region %1: %2").arg(QString(m_name)).arg(strerror(errno));
+        destroyRegion();
+        return false;
+    }
+    m_region = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (m_region == MAP_FAILED) {
+        *errorString = tr("Couldn't map shared memory region %1: %2").arg(QString(m_name)).arg(strerror(errno));
+        destroyRegion();
+        return false;
+    }
+
+    // ftruncate() zero fills the region, only the header needs to be set up
+    m_header = static_cast<UAVOShmHeader *>(m_region);
+    m_header->version    = UAVOSHM_VERSION;
+    m_header->headerSize = sizeof(UAVOShmHeader);
+    m_header->slotSize   = sizeof(UAVOShmSlot);
+    m_header->eventSize  = sizeof(UAVOShmEvent);
+    m_header->slotCount  = UAVOSHM_SLOT_COUNT;
+    m_header->ringSize   = ringSize;
+    m_header->writerPid  = getpid();
+    m_header->slotOffset = sizeof(UAVOShmHeader);
+    m_header->ringOffset = m_header->slotOffset + (quint64)UAVOSHM_SLOT_COUNT * sizeof(UAVOShmSlot);
+
+    m_slots = reinterpret_cast<UAVOShmSlot *>(static_cast<char *>(m_region) + m_header->slotOffset);
+    m_ring  = ringSize ? reinterpret_cast<UAVOShmEvent *>(static_cast<char *>(m_region) + m_header->ringOffset) : NULL;
+
+    // Readers wait for the magic before trusting the rest of the header
+    __atomic_store_n(&m_header->magic, UAVOSHM_MAGIC, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+void ShmExportPlugin::destroyRegion()
+{
+    if (m_region != MAP_FAILED) {
+        munmap(m_region, m_size);
+        m_region = MAP_FAILED;
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+        shm_unlink(m_name.constData());
+        m_fd = -1;
+    }
+    m_header = NULL;
+    m_slots  = NULL;
+    m_ring   = NULL;
+}
+
+/**
+ * Assign a slot to a newly registered object (or instance) and publish its current value
+ */
+void ShmExportPlugin::newObject(UAVObject *obj)
+{
+    if (m_header == NULL || m_slotIndex.contains(obj)) {
+        return;
+    }
+
+    quint32 index = m_header->slotsUsed;
+    if (index >= m_header->slotCount) {
+        qWarning() << "ShmExportPlugin - no free slot for" << obj->getName() << obj->getInstID();
+        return;
+    }
+    if (obj->getNumBytes() > UAVOSHM_MAX_DATA) {
+        qWarning() << "ShmExportPlugin - object too large to export" << obj->getName();
+        return;
+    }
+
+    UAVOShmSlot *slot = &m_slots[index];
+    slot->objId    = obj->getObjID();
+    slot->instId   = obj->getInstID();
+    slot->numBytes = obj->getNumBytes();
+    // Make the slot identity visible before the slot itself
+    __atomic_store_n(&m_header->slotsUsed, index + 1, __ATOMIC_RELEASE);
+
+    m_slotIndex.insert(obj, index);
+    connect(obj, &UAVObject::objectUpdated, this, &ShmExportPlugin::objectUpdated);
+
+    publish(index, obj);
+}
+
+void ShmExportPlugin::objectUpdated(UAVObject *obj)
+{
+    QHash<UAVObject *, quint32>::const_iterator it = m_slotIndex.constFind(obj);
+
+    if (it != m_slotIndex.constEnd()) {
+        publish(it.value(), obj);
+    }
+}
+
+/**
+ * Copy the object data into its slot under the sequence lock and,
+ * if enabled, append an update event to the ring.
+ */
+void ShmExportPlugin::publish(quint32 index, UAVObject *obj)
+{
+    UAVOShmSlot *slot = &m_slots[index];
+    quint64 now = monotonicTimeUs();
+    quint32 seq = slot->seq;
+
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    obj->pack(slot->data);
+    slot->timestampUs = now;
+    slot->updateCount++;
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+
+    if (m_ring == NULL) {
+        return;
+    }
+
+    quint64 head = m_header->ringHead;
+    UAVOShmEvent *event = &m_ring[head & (m_header->ringSize - 1)];
+
+    __atomic_store_n(&event->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    event->timestampUs = now;
+    event->slotIndex   = index;
+    event->objId  = slot->objId;
+    event->instId = slot->instId;
+    __atomic_store_n(&event->seq, head + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&m_header->ringHead, head + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ *
+ * @file       shmexportplugin.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmExportPlugin Shared Memory Export Plugin
+ * @{
+ * @brief Exports UAV Objects to co-located processes through shared memory
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SHMEXPORTPLUGIN_H
+#define SHMEXPORTPLUGIN_H
+
+#include <extensionsystem/iplugin.h>
+#include "uavoshm.h"
+
+#include <QtPlugin>
+#include <QHash>
+
+class UAVObject;
+
+class ShmExportPlugin : public ExtensionSystem::IPlugin {
+    Q_OBJECT
+                                                    Q_PLUGIN_METADATA(IID "LibrePilot.ShmExport")
+
+public:
+    ShmExportPlugin();
+    ~ShmExportPlugin();
+
+    bool initialize(const QStringList &arguments, QString *errorString);
+    void extensionsInitialized();
+    void shutdown();
+
+private slots:
+    void newObject(UAVObject *obj);
+    void objectUpdated(UAVObject *obj);
+
+private:
+    QByteArray m_name;
+    bool m_events;
+
+    int m_fd;
+    void *m_region;
+    size_t m_size;
+
+    UAVOShmHeader *m_header;
+    UAVOShmSlot *m_slots;
+    UAVOShmEvent *m_ring;
+
+    QHash<UAVObject *, quint32> m_slotIndex;
+
+    bool createRegion(QString *errorString);
+    void destroyRegion();
+    void publish(quint32 index, UAVObject *obj);
+};
+
+#endif // SHMEXPORTPLUGIN_H
@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavoshm.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ShmExportPlugin Shared Memory Export Plugin
+ * @{
+ * @brief Layout of the UAVObject shared memory region
+ *
+ * This header is shared between the GCS (writer) and the reader library
+ * and must stay plain C.
+ *
+ * The region starts with a UAVOShmHeader, followed by slotCount UAVOShmSlot
+ * records (one per object instance, holding its latest packed DataFields)
+ * and, optionally, a ring of ringSize UAVOShmEvent records.
+ *
+ * Slots are protected by a sequence lock: the writer makes the sequence odd,
+ * copies the data and makes it even again. A reader copies the slot and
+ * retries if the sequence was odd or changed in the meantime.
+ * Slot identity (objId, instId, numBytes) is written once before slotsUsed
+ * is incremented and never changes afterwards.
+ *
+ * The event ring has a single producer. ringHead is the total number of
+ * events ever published; event n lives in entry (n % ringSize) and carries
+ * seq == n + 1 once complete. Readers keep their own tail and detect
+ * overruns by comparing it with ringHead.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOSHM_H
+#define UAVOSHM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UAVOSHM_MAGIC        0x4F565155u /* "UQVO" */
+#define UAVOSHM_VERSION      1
+#define UAVOSHM_DEFAULT_NAME "/librepilot-uavo"
+
+/* Same as the UAVTalk maximum payload length */
+#define UAVOSHM_MAX_DATA     256
+#define UAVOSHM_SLOT_COUNT   1024
+/* Must be a power of two */
+#define UAVOSHM_RING_SIZE    4096
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t slotSize;
+    uint32_t eventSize;
+    uint32_t slotCount;
+    uint32_t ringSize; /* 0 if the event ring is disabled */
+    uint32_t writerPid;
+    uint64_t slotOffset;
+    uint64_t ringOffset;
+    uint32_t slotsUsed; /* atomic, written with release semantics */
+    uint32_t reserved;
+    uint64_t ringHead; /* atomic, written with release semantics */
+} UAVOShmHeader;
+
+typedef struct {
+    uint32_t seq; /* sequence lock, odd while the writer is updating */
+    uint32_t objId;
+    uint16_t instId;
+    uint16_t numBytes;
+    uint32_t updateCount;
+    uint64_t timestampUs; /* CLOCK_MONOTONIC time of the update */
+    uint8_t  data[UAVOSHM_MAX_DATA];
+} UAVOShmSlot;
+
+typedef struct {
+    uint64_t seq; /* event number + 1 when complete, 0 while being written */
+    uint64_t timestampUs;
+    uint32_t slotIndex;
+    uint32_t objId;
+    uint16_t instId;
+    uint16_t reserved[3];
+} UAVOShmEvent;
+
+static inline uint64_t uavoshm_region_size(uint32_t slotCount, uint32_t ringSize)
+{
+    return sizeof(UAVOShmHeader) + (uint64_t)slotCount * sizeof(UAVOShmSlot) + (uint64_t)ringSize * sizeof(UAVOShmEvent);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UAVOSHM_H
@@ -39,6 +39,7 @@
 
 StreamServicePlugin::StreamServicePlugin() :
     port(7891),
+    pSubscription(Q_NULLPTR),
     isSubscribed(false) {}
 
 StreamServicePlugin::~StreamServicePlugin()
@@ -100,7 +101,22 @@ void StreamServicePlugin::objectUpdated(UAVObject *pObj)
     QJsonObject qtjson;
 
     pObj->toJson(qtjson);
+    sendJson(qtjson);
+}
 
+void StreamServicePlugin::objectsUpdated(const UAVObjectUpdateSubscription::UpdateBatch &batch)
+{
+    foreach(const UAVObjectUpdateSubscription::Update &update, batch) {
+        if (update.obj->isDataObject()) {
+            QJsonObject qtjson;
+            pSubscription->sampleToJson(update, qtjson);
+            sendJson(qtjson);
+        }
+    }
+}
+
+void StreamServicePlugin::sendJson(QJsonObject &qtjson)
+{
     // Adds timestamp: Milliseconds from epoch
     qtjson.insert("gcs_timestamp_ms", QJsonValue(QDateTime::currentMSecsSinceEpoch()));
 
@@ -145,11 +161,10 @@ inline void StreamServicePlugin::makeSureIsSubscribed()
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     Q_ASSERT(objManager);
 
-    QList< QList<UAVDataObject *> > objList = objManager->getDataObjects();
-    foreach(QList<UAVDataObject *> list, objList) {
-        foreach(UAVDataObject * obj, list) {
-            connect(obj, &UAVDataObject::objectUpdated, this, &StreamServicePlugin::objectUpdated);
-        }
-    }
+    // One subscription for all objects, including the instances created later.
+    // Every update is streamed with the values it had when it was posted.
+    pSubscription = objManager->getUpdateBus()->subscribe(this);
+    pSubscription->setDataCaptured(true);
+    connect(pSubscription, &UAVObjectUpdateSubscription::updated, this, &StreamServicePlugin::objectsUpdated);
     isSubscribed = true;
 }
@@ -29,9 +29,11 @@
 
 #include <extensionsystem/iplugin.h>
 #include "../uavobjects/uavobject.h"
+#include "../uavobjects/uavobjectupdatebus.h"
 
 #include <QtPlugin>
 
+class QJsonObject;
 class QTcpServer;
 class QTcpSocket;
 
@@ -49,6 +51,7 @@ public:
 
 public slots:
     void objectUpdated(UAVObject *pObj);
+    void objectsUpdated(const UAVObjectUpdateSubscription::UpdateBatch &batch);
 
 private slots:
     void clientConnected();
@@ -59,8 +62,10 @@ private:
 
     QTcpServer *pServer;
     QList<QTcpSocket *> activeClients;
+    UAVObjectUpdateSubscription *pSubscription;
     bool isSubscribed;
 
+    void sendJson(QJsonObject &qtjson);
     inline void makeSureIsSubscribed();
 };
 
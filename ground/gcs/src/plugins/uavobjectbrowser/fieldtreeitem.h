@@ -93,9 +93,8 @@ public:
 
     void setData(QVariant value, int column)
     {
-        QStringList options = m_field->getOptions();
-        QVariant tmpValue   = m_field->getValue(m_index);
-        int tmpValIndex     = options.indexOf(tmpValue.toString());
+        QVariant tmpValue = m_field->getValue(m_index);
+        int tmpValIndex   = m_field->getOptionIndex(tmpValue.toString());
 
         setChanged(tmpValIndex != value);
         TreeItem::setData(value, column);
@@ -120,9 +119,8 @@ public:
 
     void update()
     {
-        QStringList options = m_field->getOptions();
         QVariant value = m_field->getValue(m_index);
-        int valIndex   = options.indexOf(value.toString());
+        int valIndex   = m_field->getOptionIndex(value.toString());
 
         if (data() != valIndex || changed()) {
             TreeItem::setData(valIndex);
@@ -0,0 +1,218 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_uavodescription.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectBrowserPlugin UAVObject Browser Plugin
+ * @{
+ * @brief Checks compiled Mustache templates against the text ones and times the object descriptions
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavodescription.h"
+#include "utils/mustache.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+
+// Times each object description is rendered in the benchmark
+static const int ROUNDS = 20;
+
+class tst_UAVODescription : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void compiledMatchesText_data();
+    void compiledMatchesText();
+    void compileError();
+    void allDescriptions();
+
+private:
+    UAVObjectManager *m_objMngr;
+    QString m_template;
+    QList<UAVObject *> m_objects;
+};
+
+void tst_UAVODescription::initTestCase()
+{
+    m_objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+
+    // One instance per object definition
+    foreach(const QList<UAVDataObject *> &instances, m_objMngr->getDataObjects()) {
+        m_objects.append(instances.first());
+    }
+
+    QFile file(":/uavobjectbrowser/resources/uavodescription.mustache");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QTextStream stream(&file);
+    m_template = stream.readAll();
+}
+
+void tst_UAVODescription::cleanupTestCase()
+{
+    delete m_objMngr;
+}
+
+void tst_UAVODescription::compiledMatchesText_data()
+{
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("value") << "a {{name}} b {{missing}} c";
+    QTest::newRow("escape") << "{{html}} {{{html}}} {{&html}}";
+    QTest::newRow("list") << "{{#list}}[{{item}}{{delim}}]{{/list}}";
+    QTest::newRow("nested") << "{{#list}}{{#sub}}<{{item}}{{.}}>{{/sub}}{{/list}}";
+    QTest::newRow("hash") << "{{#hash}}{{inner}} {{name}}{{/hash}} {{hash.inner}}";
+    QTest::newRow("inverted") << "{{^missing}}none{{/missing}}{{^name}}hidden{{/name}}{{^empty}}empty{{/empty}}";
+    QTest::newRow("standalone") << "line\n  {{#flag}}\n  shown\n  {{/flag}}\n{{! comment }}\nend\n";
+    QTest::newRow("delimiter") << "{{=<% %>=}}<% name %> {{name}}<%={{ }}=%> {{name}}";
+    QTest::newRow("partial") << "[{{>part}}] {{>missing}}";
+}
+
+void tst_UAVODescription::compiledMatchesText()
+{
+    QFETCH(QString, text);
+
+    QVariantHash item;
+    item["item"] = "x";
+    item["sub"]  = QVariantList() << "1" << "2";
+    QVariantHash last;
+    last["item"]  = "y";
+    last["delim"] = ",";
+    QVariantHash hash;
+    hash["inner"] = "in";
+    QVariantHash args;
+    args["name"]  = "object";
+    args["html"]  = "<a & \"b\">";
+    args["list"]  = QVariantList() << item << last;
+    args["hash"]  = hash;
+    args["flag"]  = true;
+    args["empty"] = QVariantList();
+
+    QHash<QString, QString> partials;
+    partials["part"] = "{{name}}{{#list}}-{{item}}{{/list}}";
+    Mustache::PartialMap partialMap(partials);
+
+    Mustache::QtVariantContext textContext(args, &partialMap);
+    Mustache::Renderer textRenderer;
+    QString expected = textRenderer.render(text, &textContext);
+    QVERIFY(textRenderer.error().isEmpty());
+
+    Mustache::Renderer renderer;
+    Mustache::Template compiled = renderer.compile(text);
+    QVERIFY(renderer.error().isEmpty());
+    // The compiled template renders the same any number of times
+    for (int i = 0; i < 2; i++) {
+        Mustache::QtVariantContext context(args, &partialMap);
+        QCOMPARE(renderer.render(compiled, &context), expected);
+        QVERIFY(renderer.error().isEmpty());
+    }
+}
+
+void tst_UAVODescription::compileError()
+{
+    Mustache::Renderer textRenderer;
+    Mustache::QtVariantContext context(QVariantHash());
+
+    textRenderer.render("ok {{#open}} never closed", &context);
+
+    Mustache::Renderer renderer;
+    renderer.compile("ok {{#open}} never closed");
+    QVERIFY(!renderer.error().isEmpty());
+    QCOMPARE(renderer.error(), textRenderer.error());
+    QCOMPARE(renderer.errorPos(), textRenderer.errorPos());
+}
+
+/**
+ * Renders the description of every object as the browser did before,
+ * from the template text, then from the compiled template and then from
+ * the cache, and checks all three give the same HTML. The times are
+ * only reported, they depend too much on the machine to be checked.
+ */
+void tst_UAVODescription::allDescriptions()
+{
+    QVERIFY(m_objects.size() > 0);
+
+    QElapsedTimer timer;
+    qint64 textNs     = 0;
+    qint64 compiledNs = 0;
+    qint64 cachedNs   = 0;
+    QStringList textHtml;
+
+    timer.start();
+    for (int round = 0; round < ROUNDS; round++) {
+        textHtml.clear();
+        foreach(UAVObject * obj, m_objects) {
+            Mustache::QtVariantContext context(UAVODescription::objectHash(obj));
+            Mustache::Renderer renderer;
+            textHtml.append(renderer.render(m_template, &context));
+        }
+    }
+    textNs = timer.nsecsElapsed();
+
+    QStringList compiledHtml;
+    timer.restart();
+    for (int round = 0; round < ROUNDS; round++) {
+        // A new description has an empty cache
+        UAVODescription description(m_template);
+        compiledHtml.clear();
+        foreach(UAVObject * obj, m_objects) {
+            compiledHtml.append(description.description(obj));
+        }
+    }
+    compiledNs = timer.nsecsElapsed();
+
+    UAVODescription description(m_template);
+    foreach(UAVObject * obj, m_objects) {
+        description.description(obj);
+    }
+    QStringList cachedHtml;
+    timer.restart();
+    for (int round = 0; round < ROUNDS; round++) {
+        cachedHtml.clear();
+        foreach(UAVObject * obj, m_objects) {
+            cachedHtml.append(description.description(obj));
+        }
+    }
+    cachedNs = timer.nsecsElapsed();
+
+    for (int i = 0; i < m_objects.size(); i++) {
+        QVERIFY(textHtml.at(i).contains(m_objects.at(i)->getName()));
+        QCOMPARE(compiledHtml.at(i), textHtml.at(i));
+        QCOMPARE(cachedHtml.at(i), textHtml.at(i));
+    }
+
+    int renders = ROUNDS * m_objects.size();
+    qDebug() << "UAVODescription -" << m_objects.size() << "objects, per description:"
+             << "text" << textNs / renders / 1000 << "us,"
+             << "compiled" << compiledNs / renders / 1000 << "us,"
+             << "cached" << cachedNs / renders / 1000 << "us";
+}
+
+QTEST_GUILESS_MAIN(tst_UAVODescription)
+
+#include "tst_uavodescription.moc"
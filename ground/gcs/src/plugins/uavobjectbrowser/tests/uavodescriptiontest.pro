@@ -0,0 +1,23 @@
+#
+# Renders the object descriptions from the text template, the compiled template and the cache
+#
+
+include(../../../../gcs.pri)
+include(../../uavobjects/tests/uavobjectstest.pri)
+
+TARGET = uavodescriptiontest
+
+INCLUDEPATH += \
+    $$PLUGINS_DIR/uavobjectbrowser \
+    $$GCS_SOURCE_TREE/src/libs
+
+HEADERS += \
+    $$PLUGINS_DIR/uavobjectbrowser/uavodescription.h \
+    $$GCS_SOURCE_TREE/src/libs/utils/mustache.h
+
+SOURCES += \
+    tst_uavodescription.cpp \
+    $$PLUGINS_DIR/uavobjectbrowser/uavodescription.cpp \
+    $$GCS_SOURCE_TREE/src/libs/utils/mustache.cpp
+
+RESOURCES += $$PLUGINS_DIR/uavobjectbrowser/uavobjectbrowser.qrc
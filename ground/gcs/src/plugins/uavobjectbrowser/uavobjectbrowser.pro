@@ -16,7 +16,8 @@ HEADERS += \
     uavobjecttreemodel.h \
     treeitem.h \
     browseritemdelegate.h \
-    fieldtreeitem.h
+    fieldtreeitem.h \
+    uavodescription.h
 
 SOURCES += \
     browserplugin.cpp \
@@ -28,7 +29,8 @@ SOURCES += \
     uavobjecttreemodel.cpp \
     treeitem.cpp \
     browseritemdelegate.cpp \
-    fieldtreeitem.cpp
+    fieldtreeitem.cpp \
+    uavodescription.cpp
 
 OTHER_FILES += UAVObjectBrowser.pluginspec
 
@@ -36,7 +36,7 @@
 #include "treeitem.h"
 #include "uavobjectmanager.h"
 #include "extensionsystem/pluginmanager.h"
-#include "utils/mustache.h"
+#include "uavodescription.h"
 
 #include <QDebug>
 
@@ -65,7 +65,7 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
     m_browser->treeView->setEditTriggers(QAbstractItemView::AllEditTriggers);
     m_browser->treeView->setSelectionBehavior(QAbstractItemView::SelectItems);
 
-    m_mustacheTemplate = loadFileIntoString(QString(":/uavobjectbrowser/resources/uavodescription.mustache"));
+    m_description = new UAVODescription(loadFileIntoString(QString(":/uavobjectbrowser/resources/uavodescription.mustache")));
 
     showDescription(m_viewoptions->cbDescription->isChecked());
 
@@ -95,6 +95,7 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
 UAVObjectBrowserWidget::~UAVObjectBrowserWidget()
 {
     delete m_browser;
+    delete m_description;
 }
 
 void UAVObjectBrowserWidget::setViewOptions(bool categorized, bool scientific, bool metadata, bool description)
@@ -299,87 +300,6 @@ void UAVObjectBrowserWidget::splitterMoved()
     emit splitterChanged(m_browser->splitter->saveState());
 }
 
-QString UAVObjectBrowserWidget::createObjectDescription(UAVObject *object)
-{
-    QString mustache(m_mustacheTemplate);
-
-    QVariantHash uavoHash;
-
-    uavoHash["OBJECT_NAME_TITLE"] = tr("Name");
-    uavoHash["OBJECT_NAME"] = object->getName();
-    uavoHash["CATEGORY_TITLE"]    = tr("Category");
-    uavoHash["CATEGORY"]          = object->getCategory();
-    uavoHash["TYPE_TITLE"]        = tr("Type");
-    uavoHash["TYPE"] = object->isMetaDataObject() ? tr("Metadata") : object->isSettingsObject() ? tr("Setting") : tr("Data");
-    uavoHash["SIZE_TITLE"]        = tr("Size");
-    uavoHash["SIZE"] = object->getNumBytes();
-    uavoHash["DESCRIPTION_TITLE"] = tr("Description");
-    uavoHash["DESCRIPTION"]       = object->getDescription().replace("@ref", "");
-    uavoHash["MULTI_INSTANCE_TITLE"] = tr("Multi");
-    uavoHash["MULTI_INSTANCE"]    = object->isSingleInstance() ? tr("No") : tr("Yes");
-    uavoHash["FIELDS_NAME_TITLE"] = tr("Fields");
-    QVariantList fields;
-    foreach(UAVObjectField * field, object->getFields()) {
-        QVariantHash fieldHash;
-
-        fieldHash["FIELD_NAME_TITLE"] = tr("Name");
-        fieldHash["FIELD_NAME"] = field->getName();
-        fieldHash["FIELD_TYPE_TITLE"] = tr("Type");
-        fieldHash["FIELD_TYPE"] = QString("%1%2").arg(field->getTypeAsString(),
-                                                      (field->getNumElements() > 1 ? QString("[%1]").arg(field->getNumElements()) : QString()));
-        if (!field->getUnits().isEmpty()) {
-            fieldHash["FIELD_UNIT_TITLE"] = tr("Unit");
-            fieldHash["FIELD_UNIT"] = field->getUnits();
-        }
-        if (!field->getOptions().isEmpty()) {
-            fieldHash["FIELD_OPTIONS_TITLE"] = tr("Options");
-            QVariantList options;
-            foreach(QString option, field->getOptions()) {
-                QVariantHash optionHash;
-
-                optionHash["FIELD_OPTION"] = option;
-                if (!options.isEmpty()) {
-                    optionHash["FIELD_OPTION_DELIM"] = ", ";
-                }
-                options.append(optionHash);
-            }
-            fieldHash["FIELD_OPTIONS"] = options;
-        }
-        if (field->getElementNames().count() > 1) {
-            fieldHash["FIELD_ELEMENTS_TITLE"] = tr("Elements");
-            QVariantList elements;
-            for (int i = 0; i < field->getElementNames().count(); i++) {
-                QString element = field->getElementNames().at(i);
-                QVariantHash elementHash;
-                elementHash["FIELD_ELEMENT"] = element;
-                QString limitsString = field->getLimitsAsString(i);
-                if (!limitsString.isEmpty()) {
-                    elementHash["FIELD_ELEMENT_LIMIT"] = limitsString.prepend(" (").append(")");
-                }
-                if (!elements.isEmpty()) {
-                    elementHash["FIELD_ELEMENT_DELIM"] = ", ";
-                }
-                elements.append(elementHash);
-            }
-            fieldHash["FIELD_ELEMENTS"] = elements;
-        } else if (!field->getLimitsAsString(0).isEmpty()) {
-            fieldHash["FIELD_LIMIT_TITLE"] = tr("Limits");
-            fieldHash["FIELD_LIMIT"] = field->getLimitsAsString(0);
-        }
-
-        if (!field->getDescription().isEmpty()) {
-            fieldHash["FIELD_DESCRIPTION_TITLE"] = tr("Description");
-            fieldHash["FIELD_DESCRIPTION"] = field->getDescription();
-        }
-
-        fields.append(fieldHash);
-    }
-    uavoHash["FIELDS"] = fields;
-    Mustache::QtVariantContext context(uavoHash);
-    Mustache::Renderer renderer;
-    return renderer.render(mustache, &context);
-}
-
 void UAVObjectBrowserWidget::enableSendRequest(bool enable)
 {
     m_browser->sendButton->setEnabled(enable);
@@ -396,7 +316,7 @@ void UAVObjectBrowserWidget::updateDescription()
     if (objItem) {
         UAVObject *obj = objItem->object();
         if (obj) {
-            m_browser->descriptionText->setText(createObjectDescription(obj));
+            m_browser->descriptionText->setText(m_description->description(obj));
             return;
         }
     }
@@ -41,6 +41,7 @@ class QPushButton;
 class ObjectTreeItem;
 class Ui_UAVObjectBrowser;
 class Ui_viewoptions;
+class UAVODescription;
 
 class TreeSortFilterProxyModel : public QSortFilterProxyModel {
 public:
@@ -102,7 +103,6 @@ private slots:
     void searchLineChanged(QString searchText);
     void searchTextCleared();
     void splitterMoved();
-    QString createObjectDescription(UAVObject *object);
 
 signals:
     void viewOptionsChanged(bool categorized, bool scientific, bool metadata, bool description);
@@ -120,7 +120,7 @@ private:
     QColor m_recentlyUpdatedColor;
     QColor m_manuallyChangedColor;
     bool m_onlyHilightChangedValues;
-    QString m_mustacheTemplate;
+    UAVODescription *m_description;
 
     void updateObjectPersistance(ObjectPersistence::OperationOptions op, UAVObject *obj);
     void enableSendRequest(bool enable);
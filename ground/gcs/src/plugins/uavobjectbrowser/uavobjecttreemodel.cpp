@@ -226,9 +226,8 @@ void UAVObjectTreeModel::addSingleField(int index, UAVObjectField *field, TreeIt
     case UAVObjectField::BITFIELD:
     case UAVObjectField::ENUM:
     {
-        QStringList options = field->getOptions();
         QVariant value = field->getValue(index);
-        data.append(options.indexOf(value.toString()));
+        data.append(field->getOptionIndex(value.toString()));
         data.append(field->getUnits());
         item = new EnumFieldTreeItem(field, index, data);
         break;
@@ -387,7 +386,18 @@ QVariant UAVObjectTreeModel::data(const QModelIndex &index, int role) const
         return QVariant();
 
     case Qt::ToolTipRole:
+    {
+        // Data age of the objects, computed when the tooltip is shown
+        ObjectTreeItem *objItem = dynamic_cast<ObjectTreeItem *>(item);
+        if (objItem && !dynamic_cast<MetaObjectTreeItem *>(item)) {
+            qint64 age = objItem->object()->getDataAgeMs();
+            QString updates = age < 0 ? tr("Never updated") :
+                              tr("Updated %1 times, last update %2 s ago")
+                              .arg(objItem->object()->getUpdateSequence()).arg(age / 1000.0, 0, 'f', 1);
+            return item->description().isEmpty() ? updates : item->description() + "\n" + updates;
+        }
         return item->description();
+    }
 
     case Qt::ForegroundRole:
         if (!dynamic_cast<TopTreeItem *>(item) && !item->isKnown()) {
@@ -0,0 +1,136 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavodescription.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectBrowserPlugin UAVObject Browser Plugin
+ * @{
+ * @brief Renders the HTML description of an object definition
+ *****************************************************************************/
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavodescription.h"
+
+#include "uavobject.h"
+#include "uavobjectfield.h"
+
+#include <QDebug>
+
+UAVODescription::UAVODescription(const QString &mustacheTemplate)
+{
+    Mustache::Renderer renderer;
+
+    m_template = renderer.compile(mustacheTemplate);
+    if (!renderer.error().isEmpty()) {
+        qDebug() << "UAVODescription - template error at" << renderer.errorPos() << renderer.error();
+    }
+}
+
+QString UAVODescription::description(UAVObject *object)
+{
+    QHash<quint32, QString>::const_iterator cached = m_cache.constFind(object->getObjID());
+
+    if (cached != m_cache.constEnd()) {
+        return cached.value();
+    }
+
+    Mustache::QtVariantContext context(objectHash(object));
+    Mustache::Renderer renderer;
+    QString html = renderer.render(m_template, &context);
+    m_cache.insert(object->getObjID(), html);
+    return html;
+}
+
+QVariantHash UAVODescription::objectHash(UAVObject *object)
+{
+    QVariantHash uavoHash;
+
+    uavoHash["OBJECT_NAME_TITLE"] = tr("Name");
+    uavoHash["OBJECT_NAME"] = object->getName();
+    uavoHash["CATEGORY_TITLE"]    = tr("Category");
+    uavoHash["CATEGORY"]          = object->getCategory();
+    uavoHash["TYPE_TITLE"]        = tr("Type");
+    uavoHash["TYPE"] = object->isMetaDataObject() ? tr("Metadata") : object->isSettingsObject() ? tr("Setting") : tr("Data");
+    uavoHash["SIZE_TITLE"]        = tr("Size");
+    uavoHash["SIZE"] = object->getNumBytes();
+    uavoHash["DESCRIPTION_TITLE"] = tr("Description");
+    uavoHash["DESCRIPTION"]       = object->getDescription().replace("@ref", "");
+    uavoHash["MULTI_INSTANCE_TITLE"] = tr("Multi");
+    uavoHash["MULTI_INSTANCE"]    = object->isSingleInstance() ? tr("No") : tr("Yes");
+    uavoHash["FIELDS_NAME_TITLE"] = tr("Fields");
+    QVariantList fields;
+    foreach(UAVObjectField * field, object->getFields()) {
+        QVariantHash fieldHash;
+
+        fieldHash["FIELD_NAME_TITLE"] = tr("Name");
+        fieldHash["FIELD_NAME"] = field->getName();
+        fieldHash["FIELD_TYPE_TITLE"] = tr("Type");
+        fieldHash["FIELD_TYPE"] = QString("%1%2").arg(field->getTypeAsString(),
+                                                      (field->getNumElements() > 1 ? QString("[%1]").arg(field->getNumElements()) : QString()));
+        if (!field->getUnits().isEmpty()) {
+            fieldHash["FIELD_UNIT_TITLE"] = tr("Unit");
+            fieldHash["FIELD_UNIT"] = field->getUnits();
+        }
+        if (!field->getOptions().isEmpty()) {
+            fieldHash["FIELD_OPTIONS_TITLE"] = tr("Options");
+            QVariantList options;
+            foreach(QString option, field->getOptions()) {
+                QVariantHash optionHash;
+
+                optionHash["FIELD_OPTION"] = option;
+                if (!options.isEmpty()) {
+                    optionHash["FIELD_OPTION_DELIM"] = ", ";
+                }
+                options.append(optionHash);
+            }
+            fieldHash["FIELD_OPTIONS"] = options;
+        }
+        if (field->getElementNames().count() > 1) {
+            fieldHash["FIELD_ELEMENTS_TITLE"] = tr("Elements");
+            QVariantList elements;
+            for (int i = 0; i < field->getElementNames().count(); i++) {
+                QString element = field->getElementNames().at(i);
+                QVariantHash elementHash;
+                elementHash["FIELD_ELEMENT"] = element;
+                QString limitsString = field->getLimitsAsString(i);
+                if (!limitsString.isEmpty()) {
+                    elementHash["FIELD_ELEMENT_LIMIT"] = limitsString.prepend(" (").append(")");
+                }
+                if (!elements.isEmpty()) {
+                    elementHash["FIELD_ELEMENT_DELIM"] = ", ";
+                }
+                elements.append(elementHash);
+            }
+            fieldHash["FIELD_ELEMENTS"] = elements;
+        } else if (!field->getLimitsAsString(0).isEmpty()) {
+            fieldHash["FIELD_LIMIT_TITLE"] = tr("Limits");
+            fieldHash["FIELD_LIMIT"] = field->getLimitsAsString(0);
+        }
+
+        if (!field->getDescription().isEmpty()) {
+            fieldHash["FIELD_DESCRIPTION_TITLE"] = tr("Description");
+            fieldHash["FIELD_DESCRIPTION"] = field->getDescription();
+        }
+
+        fields.append(fieldHash);
+    }
+    uavoHash["FIELDS"] = fields;
+    return uavoHash;
+}
@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavodescription.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectBrowserPlugin UAVObject Browser Plugin
+ * @{
+ * @brief Renders the HTML description of an object definition
+ *****************************************************************************/
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef UAVODESCRIPTION_H
+#define UAVODESCRIPTION_H
+
+#include "utils/mustache.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QVariantHash>
+
+class UAVObject;
+
+/**
+ * The description only depends on the object definition, so it is
+ * rendered once per object ID with the template compiled once.
+ */
+class UAVODescription {
+    // Keeps the translations made for the browser widget
+    Q_DECLARE_TR_FUNCTIONS(UAVObjectBrowserWidget)
+
+public:
+    explicit UAVODescription(const QString &mustacheTemplate);
+
+    QString description(UAVObject *object);
+
+    // The values the template is rendered with
+    static QVariantHash objectHash(UAVObject *object);
+
+private:
+    Mustache::Template m_template;
+    QHash<quint32, QString> m_cache;
+};
+
+#endif // UAVODESCRIPTION_H
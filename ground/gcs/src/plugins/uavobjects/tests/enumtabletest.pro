@@ -0,0 +1,11 @@
+#
+# Generated enum option tables of the UAVObject fields
+# The benchmark prints the option lookup times of enum heavy settings, by table and by name
+#
+
+include(../../../../gcs.pri)
+include(uavobjectstest.pri)
+
+TARGET = enumtabletest
+
+SOURCES += tst_enumtable.cpp
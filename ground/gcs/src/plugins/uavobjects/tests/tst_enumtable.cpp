@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_enumtable.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief Checks the generated enum option tables against the option names
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavobjectfield.h"
+#include "flightmodesettings.h"
+#include "hwsettings.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+
+class tst_EnumTable : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void allOptions();
+    void typedAccessors();
+    void setValue();
+    void benchmark();
+    void cleanupTestCase();
+
+private:
+    UAVObjectManager *m_objMngr;
+
+    QList<UAVObjectField *> enumFields(UAVObject *obj);
+};
+
+void tst_EnumTable::initTestCase()
+{
+    m_objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+}
+
+QList<UAVObjectField *> tst_EnumTable::enumFields(UAVObject *obj)
+{
+    QList<UAVObjectField *> fields;
+
+    foreach(UAVObjectField * field, obj->getFields()) {
+        if (field->getType() == UAVObjectField::ENUM) {
+            fields.append(field);
+        }
+    }
+    return fields;
+}
+
+void tst_EnumTable::allOptions()
+{
+    int count = 0;
+
+    foreach(QList<UAVObject *> instances, m_objMngr->getObjects()) {
+        foreach(UAVObjectField * field, enumFields(instances.first())) {
+            QStringList options = field->getOptions();
+            for (int i = 0; i < options.length(); i++) {
+                QCOMPARE(field->getOptionIndex(options[i]), i);
+            }
+            QCOMPARE(field->getOptionIndex(QString()), -1);
+            QCOMPARE(field->getOptionIndex("NotAnOption"), -1);
+            QCOMPARE(field->getOptionIndex(options[0].toLower() + "_"), -1);
+            count++;
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void tst_EnumTable::typedAccessors()
+{
+    QCOMPARE(QString(FlightModeSettings::armingOption(FlightModeSettings_Arming::RollLeft)), QString("Roll Left"));
+    QCOMPARE(QString(HwSettings::rmMainPortOption(HwSettings_RMMainPort::SBus)), QString("S.Bus"));
+    QVERIFY(FlightModeSettings::armingOption((FlightModeSettings_Arming::Enum)255) == NULL);
+
+    FlightModeSettings_Arming::Enum arming;
+    QVERIFY(FlightModeSettings::armingFromOption("Pitch Aft", &arming));
+    QCOMPARE(arming, FlightModeSettings_Arming::PitchAft);
+    QVERIFY(!FlightModeSettings::armingFromOption("PitchAft", &arming));
+    QCOMPARE(arming, FlightModeSettings_Arming::PitchAft);
+
+    // The same lookup from a QString
+    QVERIFY(FlightModeSettings::armingFromOption(QString("Roll Left"), &arming));
+    QCOMPARE(arming, FlightModeSettings_Arming::RollLeft);
+    QVERIFY(!FlightModeSettings::armingFromOption(QString(), &arming));
+
+    HwSettings_RMMainPort::Enum port;
+    QVERIFY(HwSettings::rmMainPortFromOption("MAVLink", &port));
+    QCOMPARE(port, HwSettings_RMMainPort::MAVLink);
+
+    // Raw option indexes, for example combo box rows, are range checked
+    QVERIFY(HwSettings::rmMainPortFromIndex(HwSettings_RMMainPort::SBus, &port));
+    QCOMPARE(port, HwSettings_RMMainPort::SBus);
+    QVERIFY(!HwSettings::rmMainPortFromIndex(-1, &port));
+    QVERIFY(!HwSettings::rmMainPortFromIndex(HwSettings::GetInstance(m_objMngr)->getField("RM_MainPort")->getOptions().size(), &port));
+    QCOMPARE(port, HwSettings_RMMainPort::SBus);
+}
+
+void tst_EnumTable::setValue()
+{
+    HwSettings *hwSettings = HwSettings::GetInstance(m_objMngr);
+    UAVObjectField *field  = hwSettings->getField("RM_MainPort");
+
+    field->setValue("HoTT Telemetry");
+    QCOMPARE(hwSettings->rmMainPort(), HwSettings_RMMainPort::HoTTTelemetry);
+    QCOMPARE(field->getValue().toString(), QString("HoTT Telemetry"));
+    QVERIFY(field->checkValue("DSM"));
+    QVERIFY(!field->checkValue("DSMX"));
+
+    // Invalid values default to the first option
+    field->setValue("DSMX");
+    QCOMPARE(hwSettings->rmMainPort(), HwSettings_RMMainPort::Disabled);
+}
+
+void tst_EnumTable::benchmark()
+{
+    const int rounds = 200;
+    QList<UAVObjectField *> fields = enumFields(FlightModeSettings::GetInstance(m_objMngr))
+                                     + enumFields(HwSettings::GetInstance(m_objMngr));
+    QStringList names;
+    QList<UAVObjectField *> nameFields;
+    int checksum = 0;
+
+    foreach(UAVObjectField * field, fields) {
+        foreach(QString option, field->getOptions()) {
+            names << option;
+            nameFields << field;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < names.length(); i++) {
+            checksum += nameFields[i]->getOptions().indexOf(names[i]);
+        }
+    }
+    double byNameNs = timer.nsecsElapsed() / (double)(rounds * names.length());
+
+    timer.start();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < names.length(); i++) {
+            checksum -= nameFields[i]->getOptionIndex(names[i]);
+        }
+    }
+    double byTableNs = timer.nsecsElapsed() / (double)(rounds * names.length());
+    QCOMPARE(checksum, 0);
+
+    // What the settings widgets and the object browser do for each value
+    timer.start();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < names.length(); i++) {
+            UAVObjectField *field = nameFields[i];
+            for (quint32 element = 0; element < field->getNumElements(); element++) {
+                field->setValue(names[i], element);
+                field->isWithinLimits(field->getValue(element), element);
+            }
+        }
+    }
+    double setGetNs = timer.nsecsElapsed() / (double)rounds;
+
+    qDebug("%d enum fields, %d options", fields.length(), names.length());
+    qDebug("option lookup by name  %8.1f ns", byNameNs);
+    qDebug("option lookup by table %8.1f ns", byTableNs);
+    qDebug("set, get and check all %8.1f us", setGetNs / 1000.0);
+}
+
+void tst_EnumTable::cleanupTestCase()
+{
+    delete m_objMngr;
+}
+
+QTEST_GUILESS_MAIN(tst_EnumTable)
+
+#include "tst_enumtable.moc"
@@ -0,0 +1,314 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_uavobjecthistory.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief Recording, ranges, ring buffer wrap and budget of the object history
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavobjecthistory.h"
+#include "attitudestate.h"
+#include "gyrostate.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+
+#include <limits>
+
+class tst_UAVObjectHistory : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void recordsUpdates();
+    void selectsRange();
+    void wrapsRing();
+    void recordsWhileViewed();
+    void detectsOverwrite();
+    void tracksReferences();
+    void dropsOldSamples();
+    void keepsBudget();
+
+private:
+    UAVObjectManager *m_objMngr;
+    UAVObjectHistory *m_history;
+    AttitudeState *m_attitude;
+    UAVObjectField *m_q1;
+
+    void setAttitude(float q1);
+    UAVObjectHistory::View all() const;
+};
+
+void tst_UAVObjectHistory::init()
+{
+    m_objMngr  = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+    m_history  = new UAVObjectHistory();
+    m_attitude = AttitudeState::GetInstance(m_objMngr);
+    QVERIFY(m_attitude);
+    m_q1 = m_attitude->getField("q1");
+    QVERIFY(m_q1);
+}
+
+void tst_UAVObjectHistory::cleanup()
+{
+    delete m_history;
+    delete m_objMngr;
+}
+
+void tst_UAVObjectHistory::setAttitude(float q1)
+{
+    AttitudeState::DataFields data = m_attitude->getData();
+
+    data.q1 = q1;
+    m_attitude->setData(data);
+}
+
+UAVObjectHistory::View tst_UAVObjectHistory::all() const
+{
+    return m_history->range(m_attitude, m_q1, 0, 0, std::numeric_limits<qint64>::max());
+}
+
+void tst_UAVObjectHistory::recordsUpdates()
+{
+    // Not recorded before it is tracked
+    setAttitude(-1);
+    QVERIFY(m_history->track(m_attitude));
+    QVERIFY(m_history->isTracked(m_attitude));
+    QVERIFY(all().isEmpty());
+
+    for (int i = 0; i < 10; ++i) {
+        setAttitude(i);
+    }
+    // Manual updates are recorded too
+    m_attitude->updated();
+    QCOMPARE(m_history->sampleCount(m_attitude), 11);
+
+    UAVObjectHistory::View view = all();
+    QCOMPARE(view.size(), 11);
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(view.value(i), (double)i);
+        if (i > 0) {
+            QVERIFY(view.timestamp(i) >= view.timestamp(i - 1));
+        }
+    }
+    QCOMPARE(view.value(10), 9.0);
+
+    // Out of range element, or field of another object
+    QVERIFY(m_history->range(m_attitude, m_q1, 1, 0, std::numeric_limits<qint64>::max()).isEmpty());
+    GyroState *gyro = GyroState::GetInstance(m_objMngr);
+    QVERIFY(m_history->range(m_attitude, gyro->getField("x"), 0, 0, std::numeric_limits<qint64>::max()).isEmpty());
+    QVERIFY(m_history->range(gyro, gyro->getField("x"), 0, 0, std::numeric_limits<qint64>::max()).isEmpty());
+}
+
+void tst_UAVObjectHistory::selectsRange()
+{
+    QVERIFY(m_history->track(m_attitude));
+
+    setAttitude(1);
+    QThread::msleep(20);
+    setAttitude(2);
+    setAttitude(3);
+
+    UAVObjectHistory::View view = all();
+    QCOMPARE(view.size(), 3);
+    qint64 first = view.timestamp(0);
+    qint64 last  = view.timestamp(2);
+    QVERIFY(last > first);
+
+    // Both ends are inclusive
+    UAVObjectHistory::View head = m_history->range(m_attitude, m_q1, 0, first, first);
+    QCOMPARE(head.size(), 1);
+    QCOMPARE(head.value(0), 1.0);
+
+    UAVObjectHistory::View tail = m_history->range(m_attitude, m_q1, 0, first + 1, last);
+    QCOMPARE(tail.size(), 2);
+    QCOMPARE(tail.value(0), 2.0);
+    QCOMPARE(tail.value(1), 3.0);
+
+    QVERIFY(m_history->range(m_attitude, m_q1, 0, last + 1, last + 1000).isEmpty());
+    QVERIFY(m_history->range(m_attitude, m_q1, 0, 0, first - 1).isEmpty());
+}
+
+void tst_UAVObjectHistory::wrapsRing()
+{
+    const int capacity = UAVObjectHistory::MIN_CAPACITY;
+
+    QVERIFY(m_history->track(m_attitude, capacity));
+
+    // Oldest samples are overwritten, the view comes in order across the wrap
+    for (int i = 0; i < capacity * 2 + 5; ++i) {
+        setAttitude(i);
+    }
+    QCOMPARE(m_history->sampleCount(m_attitude), capacity);
+
+    UAVObjectHistory::View view = all();
+    QCOMPARE(view.size(), capacity);
+    for (int i = 0; i < capacity; ++i) {
+        QCOMPARE(view.value(i), (double)(capacity + 5 + i));
+    }
+
+    // The segments are the ring buffer itself, split where it wraps
+    QCOMPARE(view.segmentCount(), 2);
+    QCOMPARE(view.segmentSize(0) + view.segmentSize(1), capacity);
+    QCOMPARE(view.values(1), view.values(0) - (capacity - view.segmentSize(0)));
+    int index = 0;
+    for (int segment = 0; segment < view.segmentCount(); ++segment) {
+        for (int i = 0; i < view.segmentSize(segment); ++i, ++index) {
+            QCOMPARE(view.values(segment)[i], view.value(index));
+            QCOMPARE(view.timestamps(segment)[i], view.timestamp(index));
+        }
+    }
+    QVERIFY(view.isValid());
+}
+
+void tst_UAVObjectHistory::recordsWhileViewed()
+{
+    QVERIFY(m_history->track(m_attitude));
+
+    setAttitude(1);
+    setAttitude(2);
+
+    // Holding a view does not block recording in the same thread
+    UAVObjectHistory::View view = all();
+    setAttitude(3);
+    QCOMPARE(m_history->sampleCount(m_attitude), 3);
+
+    // and the view keeps the samples it was made of
+    QCOMPARE(view.size(), 2);
+    QCOMPARE(view.value(1), 2.0);
+    QVERIFY(view.isValid());
+    QCOMPARE(all().size(), 3);
+
+    // The ring buffer outlives the series while viewed
+    m_history->untrack(m_attitude);
+    QVERIFY(!m_history->isTracked(m_attitude));
+    QCOMPARE(view.value(0), 1.0);
+    QVERIFY(view.isValid());
+}
+
+void tst_UAVObjectHistory::detectsOverwrite()
+{
+    const int capacity = UAVObjectHistory::MIN_CAPACITY;
+
+    QVERIFY(m_history->track(m_attitude, capacity));
+    for (int i = 0; i < capacity; ++i) {
+        setAttitude(i);
+    }
+    UAVObjectHistory::View view = all();
+    QCOMPARE(view.size(), capacity);
+    QCOMPARE(view.overwritten(), 0);
+
+    // Each new sample takes the slot of the oldest one of the view
+    setAttitude(capacity);
+    setAttitude(capacity + 1);
+    QCOMPARE(view.overwritten(), 2);
+    QVERIFY(!view.isValid());
+    QCOMPARE(view.value(2), 2.0);
+
+    for (int i = 0; i < capacity * 2; ++i) {
+        setAttitude(i);
+    }
+    QCOMPARE(view.overwritten(), capacity);
+
+    // A view of the newest samples stays valid longer
+    UAVObjectHistory::View tail = m_history->range(m_attitude, m_q1, 0, all().timestamp(capacity - 2), std::numeric_limits<qint64>::max());
+    QVERIFY(tail.size() >= 2);
+    int older = capacity - tail.size();
+    for (int i = 0; i < older; ++i) {
+        setAttitude(i);
+    }
+    QVERIFY(tail.isValid());
+    setAttitude(0);
+    QVERIFY(!tail.isValid());
+}
+
+void tst_UAVObjectHistory::tracksReferences()
+{
+    QCOMPARE(m_history->memoryUsed(), qint64(0));
+    QVERIFY(m_history->track(m_attitude));
+    qint64 used = m_history->memoryUsed();
+    QVERIFY(used > 0);
+
+    // A second consumer shares the series
+    QVERIFY(m_history->track(m_attitude));
+    QCOMPARE(m_history->memoryUsed(), used);
+    setAttitude(1);
+
+    m_history->untrack(m_attitude);
+    QVERIFY(m_history->isTracked(m_attitude));
+    QCOMPARE(m_history->sampleCount(m_attitude), 1);
+
+    m_history->untrack(m_attitude);
+    QVERIFY(!m_history->isTracked(m_attitude));
+    QCOMPARE(m_history->memoryUsed(), qint64(0));
+
+    // No longer recorded
+    setAttitude(2);
+    QCOMPARE(m_history->sampleCount(m_attitude), 0);
+}
+
+void tst_UAVObjectHistory::dropsOldSamples()
+{
+    m_history->setRetention(1);
+    QVERIFY(m_history->track(m_attitude));
+
+    setAttitude(1);
+    setAttitude(2);
+    QThread::msleep(10);
+    setAttitude(3);
+
+    UAVObjectHistory::View view = all();
+    QCOMPARE(view.size(), 1);
+    QCOMPARE(view.value(0), 3.0);
+}
+
+void tst_UAVObjectHistory::keepsBudget()
+{
+    QVERIFY(m_history->track(m_attitude, 1000));
+    qint64 sampleBytes = m_history->memoryUsed() / 1000;
+    m_history->untrack(m_attitude);
+
+    // The capacity is reduced to what is left of the budget
+    m_history->setMemoryBudget(sampleBytes * 100);
+    QVERIFY(m_history->track(m_attitude, 1000));
+    QCOMPARE(m_history->memoryUsed(), sampleBytes * 100);
+    for (int i = 0; i < 150; ++i) {
+        setAttitude(i);
+    }
+    QCOMPARE(m_history->sampleCount(m_attitude), 100);
+
+    // Nothing left for another object
+    GyroState *gyro = GyroState::GetInstance(m_objMngr);
+    QTest::ignoreMessage(QtWarningMsg, "UAVObjectHistory - memory budget exhausted, not tracking \"GyroState\"");
+    QVERIFY(!m_history->track(gyro));
+    QVERIFY(!m_history->isTracked(gyro));
+}
+
+QTEST_GUILESS_MAIN(tst_UAVObjectHistory)
+
+#include "tst_uavobjecthistory.moc"
@@ -0,0 +1,358 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_uavobjectupdatebus.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief Batching, coalescing, filtering and cross thread delivery of the update bus
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavobjectupdatebus.h"
+#include "attitudestate.h"
+#include "gyrostate.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+
+typedef UAVObjectUpdateSubscription::Update Update;
+typedef UAVObjectUpdateSubscription::UpdateBatch UpdateBatch;
+
+/**
+ * Collects the batches delivered to a subscription. The counters can be
+ * read from another thread.
+ */
+class BatchRecorder : public QObject {
+public:
+    BatchRecorder() : m_updates(0), m_deliveryThread(0)
+    {}
+
+    void record(UAVObjectUpdateSubscription *subscription)
+    {
+        connect(subscription, &UAVObjectUpdateSubscription::updated, this, [this](const UpdateBatch &batch) {
+            m_batches.append(batch);
+            m_updates.fetchAndAddOrdered(batch.size());
+            m_deliveryThread.storeRelease(QThread::currentThread());
+        });
+    }
+
+    QList<UpdateBatch> m_batches;
+    QAtomicInt m_updates;
+    QAtomicPointer<QThread> m_deliveryThread;
+};
+
+class tst_UAVObjectUpdateBus : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void batchesEveryUpdate();
+    void coalescesWhenAsked();
+    void capturesData();
+    void filtersObjectIds();
+    void filtersEvents();
+    void stats();
+    void boundsPending();
+    void crossThread();
+    void unsubscribesWithContext();
+
+private:
+    UAVObjectManager *m_objMngr;
+    UAVObjectUpdateBus *m_bus;
+    AttitudeState *m_attitude;
+    GyroState *m_gyro;
+
+    void setAttitude(float q1);
+};
+
+void tst_UAVObjectUpdateBus::init()
+{
+    m_objMngr  = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+    m_bus      = m_objMngr->getUpdateBus();
+    m_attitude = AttitudeState::GetInstance(m_objMngr);
+    m_gyro     = GyroState::GetInstance(m_objMngr);
+    QVERIFY(m_attitude && m_gyro);
+}
+
+void tst_UAVObjectUpdateBus::cleanup()
+{
+    delete m_objMngr;
+}
+
+void tst_UAVObjectUpdateBus::setAttitude(float q1)
+{
+    AttitudeState::DataFields data = m_attitude->getData();
+
+    data.q1 = q1;
+    m_attitude->setData(data);
+}
+
+void tst_UAVObjectUpdateBus::batchesEveryUpdate()
+{
+    BatchRecorder recorder;
+
+    recorder.record(m_bus->subscribe(&recorder));
+
+    setAttitude(1);
+    setAttitude(2);
+    m_gyro->updated();
+    setAttitude(3);
+    QVERIFY(recorder.m_batches.isEmpty());
+
+    QCoreApplication::processEvents();
+    QCOMPARE(recorder.m_batches.size(), 1);
+    const UpdateBatch &batch = recorder.m_batches.first();
+    QCOMPARE(batch.size(), 4);
+    QCOMPARE(batch.at(0).obj, (UAVObject *)m_attitude);
+    QCOMPARE(batch.at(2).obj, (UAVObject *)m_gyro);
+    QCOMPARE(batch.at(3).obj, (UAVObject *)m_attitude);
+    foreach(const Update &update, batch) {
+        QCOMPARE(update.count, quint32(1));
+        QVERIFY(update.data.isEmpty());
+    }
+    // Sequences of the attitude updates follow each other
+    QCOMPARE(batch.at(1).sequence, batch.at(0).sequence + 1);
+    QCOMPARE(batch.at(3).sequence, batch.at(1).sequence + 1);
+
+    // Nothing more to deliver
+    QCoreApplication::processEvents();
+    QCOMPARE(recorder.m_batches.size(), 1);
+}
+
+void tst_UAVObjectUpdateBus::coalescesWhenAsked()
+{
+    BatchRecorder recorder;
+    UAVObjectUpdateSubscription *subscription = m_bus->subscribe(&recorder, UAVObjectUpdateBus::EVENT_ALL);
+
+    subscription->setCoalesced(true);
+    recorder.record(subscription);
+
+    setAttitude(1);
+    m_gyro->updated();
+    setAttitude(2);
+    m_attitude->updated();
+    QCoreApplication::processEvents();
+
+    QCOMPARE(recorder.m_batches.size(), 1);
+    const UpdateBatch &batch = recorder.m_batches.first();
+    QCOMPARE(batch.size(), 2);
+    QCOMPARE(batch.at(0).obj, (UAVObject *)m_attitude);
+    QCOMPARE(batch.at(0).count, quint32(3));
+    QCOMPARE(batch.at(0).events, quint32(UAVObjectUpdateBus::EVENT_UPDATED | UAVObjectUpdateBus::EVENT_UPDATED_AUTO
+                                         | UAVObjectUpdateBus::EVENT_UPDATED_MANUAL));
+    QCOMPARE(batch.at(0).sequence, m_attitude->getUpdateSequence());
+    QCOMPARE(batch.at(1).obj, (UAVObject *)m_gyro);
+    QCOMPARE(batch.at(1).count, quint32(1));
+}
+
+void tst_UAVObjectUpdateBus::capturesData()
+{
+    BatchRecorder recorder;
+    UAVObjectUpdateSubscription *subscription = m_bus->subscribe(&recorder);
+
+    subscription->setDataCaptured(true);
+    recorder.record(subscription);
+
+    for (int i = 0; i < 5; ++i) {
+        setAttitude(i);
+    }
+    QCoreApplication::processEvents();
+
+    // Each sample keeps its own value, the object only has the last one
+    QCOMPARE(recorder.m_batches.size(), 1);
+    const UpdateBatch &batch = recorder.m_batches.first();
+    QCOMPARE(batch.size(), 5);
+    for (int i = 0; i < batch.size(); ++i) {
+        QCOMPARE(batch.at(i).data.size(), (int)m_attitude->getNumBytes());
+        AttitudeState *sample = qobject_cast<AttitudeState *>(subscription->sample(batch.at(i)));
+        QVERIFY(sample);
+        QVERIFY(sample != m_attitude);
+        QCOMPARE(sample->getData().q1, (float)i);
+    }
+    QCOMPARE(m_attitude->getData().q1, 4.0f);
+
+    // Without captured data the sample is the object itself
+    Update update = batch.first();
+    update.data.clear();
+    QCOMPARE(subscription->sample(update), (UAVObject *)m_attitude);
+}
+
+void tst_UAVObjectUpdateBus::filtersObjectIds()
+{
+    BatchRecorder recorder;
+    UAVObjectUpdateSubscription *subscription = m_bus->subscribe(&recorder, QList<quint32>() << GyroState::OBJID);
+
+    recorder.record(subscription);
+
+    setAttitude(1);
+    m_gyro->updated();
+    QCoreApplication::processEvents();
+    QCOMPARE(recorder.m_batches.size(), 1);
+    QCOMPARE(recorder.m_batches.last().size(), 1);
+    QCOMPARE(recorder.m_batches.last().first().obj, (UAVObject *)m_gyro);
+
+    subscription->addObjectId(AttitudeState::OBJID);
+    subscription->removeObjectId(GyroState::OBJID);
+    setAttitude(2);
+    m_gyro->updated();
+    QCoreApplication::processEvents();
+    QCOMPARE(recorder.m_batches.size(), 2);
+    QCOMPARE(recorder.m_batches.last().size(), 1);
+    QCOMPARE(recorder.m_batches.last().first().obj, (UAVObject *)m_attitude);
+
+    // Nothing posted, nothing delivered
+    m_gyro->updated();
+    QCoreApplication::processEvents();
+    QCOMPARE(recorder.m_batches.size(), 2);
+}
+
+void tst_UAVObjectUpdateBus::filtersEvents()
+{
+    BatchRecorder recorder;
+
+    recorder.record(m_bus->subscribe(&recorder, UAVObjectUpdateBus::EVENT_UNPACKED));
+
+    setAttitude(1);
+    m_attitude->updated();
+    QCoreApplication::processEvents();
+    QVERIFY(recorder.m_batches.isEmpty());
+
+    QByteArray data(m_attitude->getNumBytes(), 0);
+    m_attitude->pack(reinterpret_cast<quint8 *>(data.data()));
+    m_attitude->unpack(reinterpret_cast<const quint8 *>(data.constData()));
+    QCoreApplication::processEvents();
+    QCOMPARE(recorder.m_batches.size(), 1);
+    QCOMPARE(recorder.m_batches.first().first().events, quint32(UAVObjectUpdateBus::EVENT_UNPACKED));
+}
+
+void tst_UAVObjectUpdateBus::stats()
+{
+    BatchRecorder recorder;
+    UAVObjectUpdateSubscription *subscription = m_bus->subscribe(&recorder);
+
+    recorder.record(subscription);
+
+    for (int i = 0; i < 3; ++i) {
+        setAttitude(i);
+    }
+    QThread::msleep(5);
+    QCoreApplication::processEvents();
+    setAttitude(3);
+    QCoreApplication::processEvents();
+
+    UAVObjectUpdateSubscription::Stats stats = subscription->getStats();
+    QCOMPARE(stats.posts, quint64(4));
+    QCOMPARE(stats.updates, quint64(4));
+    QCOMPARE(stats.deliveries, quint64(2));
+    QCOMPARE(stats.drops, quint64(0));
+    QVERIFY(stats.lastLatencyUs >= 0);
+    // The first batch waited at least the 5 ms
+    QVERIFY(stats.maxLatencyUs >= 5000);
+    QVERIFY(stats.averageLatencyUs <= stats.maxLatencyUs);
+
+    subscription->resetStats();
+    stats = subscription->getStats();
+    QCOMPARE(stats.posts, quint64(0));
+    QCOMPARE(stats.deliveries, quint64(0));
+    QCOMPARE(stats.maxLatencyUs, qint64(0));
+}
+
+void tst_UAVObjectUpdateBus::boundsPending()
+{
+    BatchRecorder recorder;
+    UAVObjectUpdateSubscription *subscription = m_bus->subscribe(&recorder);
+
+    subscription->setMaxPending(3);
+    subscription->setDataCaptured(true);
+    recorder.record(subscription);
+
+    // The first ones are kept, the later ones dropped
+    for (int i = 0; i < 5; ++i) {
+        setAttitude(i);
+    }
+    QCoreApplication::processEvents();
+    QCOMPARE(recorder.m_batches.size(), 1);
+    QCOMPARE(recorder.m_batches.first().size(), 3);
+    AttitudeState *sample = qobject_cast<AttitudeState *>(subscription->sample(recorder.m_batches.first().last()));
+    QCOMPARE(sample->getData().q1, 2.0f);
+    QCOMPARE(subscription->getStats().posts, quint64(5));
+    QCOMPARE(subscription->getStats().drops, quint64(2));
+
+    // Room again once delivered, with the data of each update
+    for (int i = 5; i < 8; ++i) {
+        setAttitude(i);
+    }
+    QCoreApplication::processEvents();
+    QCOMPARE(recorder.m_batches.size(), 2);
+    QCOMPARE(recorder.m_batches.last().size(), 3);
+    for (int i = 0; i < 3; ++i) {
+        sample = qobject_cast<AttitudeState *>(subscription->sample(recorder.m_batches.last().at(i)));
+        QCOMPARE(sample->getData().q1, (float)(5 + i));
+    }
+    QCOMPARE(subscription->getStats().drops, quint64(2));
+}
+
+void tst_UAVObjectUpdateBus::crossThread()
+{
+    QThread thread;
+    BatchRecorder *recorder = new BatchRecorder();
+
+    recorder->moveToThread(&thread);
+    // Subscribed from here, delivered in the thread of the recorder
+    recorder->record(m_bus->subscribe(recorder));
+    thread.start();
+
+    for (int i = 0; i < 100; ++i) {
+        setAttitude(i);
+    }
+
+    QTRY_COMPARE(recorder->m_updates.load(), 100);
+    QCOMPARE(recorder->m_deliveryThread.loadAcquire(), &thread);
+
+    thread.quit();
+    QVERIFY(thread.wait(5000));
+    delete recorder;
+}
+
+void tst_UAVObjectUpdateBus::unsubscribesWithContext()
+{
+    QVERIFY(!m_bus->hasSubscribers());
+    {
+        BatchRecorder recorder;
+        m_bus->subscribe(&recorder)->setDataCaptured(true);
+        QVERIFY(m_bus->hasSubscribers());
+        setAttitude(1);
+    }
+    QVERIFY(!m_bus->hasSubscribers());
+
+    // The delivery scheduled for the deleted subscription is dropped
+    QCoreApplication::processEvents();
+    setAttitude(2);
+}
+
+QTEST_GUILESS_MAIN(tst_UAVObjectUpdateBus)
+
+#include "tst_uavobjectupdatebus.moc"
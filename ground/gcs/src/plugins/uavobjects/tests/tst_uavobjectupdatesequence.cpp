@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_uavobjectupdatesequence.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief Update sequence numbers and data age of the objects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavobjectupdatebus.h"
+#include "attitudestate.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <QtCore/QJsonObject>
+
+class tst_UAVObjectUpdateSequence : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void countsDataUpdates();
+    void countsFieldSets();
+    void ignoresManualUpdates();
+    void ages();
+    void streamsSequenceAndAge();
+
+private:
+    UAVObjectManager *m_objMngr;
+    AttitudeState *m_attitude;
+};
+
+void tst_UAVObjectUpdateSequence::init()
+{
+    m_objMngr  = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+    m_attitude = AttitudeState::GetInstance(m_objMngr);
+    QVERIFY(m_attitude);
+}
+
+void tst_UAVObjectUpdateSequence::cleanup()
+{
+    delete m_objMngr;
+}
+
+void tst_UAVObjectUpdateSequence::countsDataUpdates()
+{
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(0));
+    QCOMPARE(m_attitude->getUpdateTimestampUs(), qint64(0));
+
+    AttitudeState::DataFields data = m_attitude->getData();
+    data.q1 = 1;
+    m_attitude->setData(data);
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(1));
+    qint64 timestamp = m_attitude->getUpdateTimestampUs();
+    QVERIFY(timestamp > 0);
+
+    // The same data set again is still an update
+    m_attitude->setData(data);
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(2));
+    QVERIFY(m_attitude->getUpdateTimestampUs() >= timestamp);
+
+    QByteArray packed(m_attitude->getNumBytes(), 0);
+    m_attitude->pack(reinterpret_cast<quint8 *>(packed.data()));
+    m_attitude->unpack(reinterpret_cast<const quint8 *>(packed.constData()));
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(3));
+}
+
+void tst_UAVObjectUpdateSequence::countsFieldSets()
+{
+    // Through the generic field
+    m_attitude->getField("q2")->setDouble(2.0);
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(1));
+    QVERIFY(m_attitude->getUpdateTimestampUs() > 0);
+
+    // and through the typed setter, only when the value changes
+    m_attitude->setQ1(1.0f);
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(2));
+    m_attitude->setQ1(1.0f);
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(2));
+
+    // Out of range elements change nothing
+    m_attitude->getField("q2")->setDouble(3.0, 1);
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(2));
+}
+
+void tst_UAVObjectUpdateSequence::ignoresManualUpdates()
+{
+    // updated() sends the data as is, it does not change it
+    m_attitude->updated();
+    QCOMPARE(m_attitude->getUpdateSequence(), quint32(0));
+    QCOMPARE(m_attitude->getDataAgeMs(), qint64(-1));
+}
+
+void tst_UAVObjectUpdateSequence::ages()
+{
+    QCOMPARE(m_attitude->getDataAgeMs(), qint64(-1));
+
+    m_attitude->setQ1(1.0f);
+    QThread::msleep(20);
+    QVERIFY(m_attitude->getDataAgeMs() >= 20);
+
+    m_attitude->setQ1(2.0f);
+    QVERIFY(m_attitude->getDataAgeMs() < 20);
+}
+
+void tst_UAVObjectUpdateSequence::streamsSequenceAndAge()
+{
+    // Only the stream carries them, saved and exported objects do not
+    QJsonObject exported;
+
+    m_attitude->setQ1(1.0f);
+    m_attitude->toJson(exported);
+    QVERIFY(!exported.contains("updateSequence"));
+    QVERIFY(!exported.contains("updateAgeMs"));
+
+    QObject context;
+    UAVObjectUpdateSubscription *subscription = m_objMngr->getUpdateBus()->subscribe(&context);
+    subscription->setDataCaptured(true);
+    UAVObjectUpdateSubscription::UpdateBatch batch;
+    connect(subscription, &UAVObjectUpdateSubscription::updated, [&batch](const UAVObjectUpdateSubscription::UpdateBatch &updates) {
+        batch += updates;
+    });
+
+    m_attitude->setQ1(2.0f);
+    m_attitude->setQ1(3.0f);
+    AttitudeState::DataFields data = m_attitude->getData();
+    m_attitude->setData(data);
+    QThread::msleep(20);
+    QCoreApplication::processEvents();
+
+    QCOMPARE(batch.size(), 1);
+    QJsonObject streamed;
+    subscription->sampleToJson(batch.first(), streamed);
+    QCOMPARE(streamed["name"].toString(), QString("AttitudeState"));
+    QCOMPARE(streamed["updateSequence"].toVariant().toLongLong(), (qint64)m_attitude->getUpdateSequence());
+    QVERIFY(streamed["updateAgeMs"].toVariant().toLongLong() >= 20);
+}
+
+QTEST_GUILESS_MAIN(tst_UAVObjectUpdateSequence)
+
+#include "tst_uavobjectupdatesequence.moc"
@@ -0,0 +1,10 @@
+#
+# Recording, ranges, ring buffer wrap and memory budget of the UAVObject history
+#
+
+include(../../../../gcs.pri)
+include(uavobjectstest.pri)
+
+TARGET = uavobjecthistorytest
+
+SOURCES += tst_uavobjecthistory.cpp
@@ -0,0 +1,52 @@
+#
+# UAVObjects core and the generated objects, built into a plugin unit test
+# without the plugin manager. Include after gcs.pri.
+#
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+QT = core qml testlib
+
+DEFINES += UAVOBJECTS_LIBRARY QTCREATOR_UTILS_STATIC_LIB
+
+PLUGINS_DIR = $$GCS_SOURCE_TREE/src/plugins
+
+INCLUDEPATH += \
+    $$PLUGINS_DIR \
+    $$PLUGINS_DIR/uavobjects
+
+HEADERS += \
+    $$PLUGINS_DIR/uavobjects/uavobject.h \
+    $$PLUGINS_DIR/uavobjects/uavmetaobject.h \
+    $$PLUGINS_DIR/uavobjects/uavdataobject.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectfield.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectmanager.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectupdatebus.h \
+    $$PLUGINS_DIR/uavobjects/uavobjecthistory.h
+
+SOURCES += \
+    $$PLUGINS_DIR/uavobjects/uavobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavmetaobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavdataobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectfield.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectmanager.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectupdatebus.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjecthistory.cpp \
+    $$GCS_SOURCE_TREE/src/libs/utils/crc.cpp
+
+UAVOBJ_XML_DIR = $${ROOT_DIR}/shared/uavobjectdefinition
+UAVOBJ_ROOT_DIR = $${ROOT_DIR}
+
+# The test projects all sit in src/plugins/<plugin>/tests
+win32 {
+    UAVOBJGENERATOR = ../../../../../uavobjgenerator/uavobjgenerator.exe
+} else {
+    UAVOBJGENERATOR = ../../../../../uavobjgenerator/uavobjgenerator
+}
+
+include($$PLUGINS_DIR/uavobjects/uavobjectlist.pri)
+include($$PLUGINS_DIR/uavobjects/uavobjgenerator.pri)
+
+INCLUDEPATH += $$OUT_PWD
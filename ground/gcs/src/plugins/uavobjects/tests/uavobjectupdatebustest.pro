@@ -0,0 +1,10 @@
+#
+# Batching, coalescing, filtering, stats and cross thread delivery of the UAVObject update bus
+#
+
+include(../../../../gcs.pri)
+include(uavobjectstest.pri)
+
+TARGET = uavobjectupdatebustest
+
+SOURCES += tst_uavobjectupdatebus.cpp
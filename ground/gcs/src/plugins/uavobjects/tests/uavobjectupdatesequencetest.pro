@@ -0,0 +1,10 @@
+#
+# Update sequence numbers and data age of the UAVObjects
+#
+
+include(../../../../gcs.pri)
+include(uavobjectstest.pri)
+
+TARGET = uavobjectupdatesequencetest
+
+SOURCES += tst_uavobjectupdatesequence.cpp
@@ -27,6 +27,7 @@
  */
 #include "uavmetaobject.h"
 #include "uavobjectfield.h"
+#include "uavobjectupdatebus.h"
 
 /**
  * Constructor
@@ -94,8 +95,10 @@ void UAVMetaObject::setData(const Metadata & mdata)
     QMutexLocker locker(mutex);
 
     parentMetadata = mdata;
+    markDataUpdated();
     emit objectUpdatedAuto(this); // trigger object updated event
     emit objectUpdated(this);
+    postUpdate(UAVObjectUpdateBus::EVENT_UPDATED | UAVObjectUpdateBus::EVENT_UPDATED_AUTO);
 }
 
 /**
@@ -27,6 +27,7 @@
  */
 #include "uavobject.h"
 
+#include "uavobjectupdatebus.h"
 #include <utils/crc.h>
 
 #include <QtEndian>
@@ -35,6 +36,7 @@
 #include <QXmlStreamReader>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QElapsedTimer>
 
 using namespace Utils;
 
@@ -66,7 +68,10 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
     this->data         = 0;
     this->numBytes     = 0;
     this->mutex        = new QMutex(QMutex::Recursive);
+    this->updateBus    = 0;
     m_isKnown = false;
+    m_updateSequence    = 0;
+    m_updateTimestampUs = 0;
 }
 
 /**
@@ -209,6 +214,7 @@ void UAVObject::updated()
 {
     emit objectUpdatedManual(this);
     emit objectUpdated(this);
+    postUpdate(UAVObjectUpdateBus::EVENT_UPDATED | UAVObjectUpdateBus::EVENT_UPDATED_MANUAL);
 }
 
 /**
@@ -325,8 +331,10 @@ qint32 UAVObject::unpack(const quint8 *dataIn)
         fields[n]->unpack(&dataIn[offset]);
         offset += fields[n]->getNumBytes();
     }
+    markDataUpdated();
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
+    postUpdate(UAVObjectUpdateBus::EVENT_UPDATED | UAVObjectUpdateBus::EVENT_UNPACKED);
 
     return numBytes;
 }
@@ -626,6 +634,62 @@ void UAVObject::setIsKnown(bool isKnown)
     }
 }
 
+/**
+ * Set the bus the updates of this object are posted to, done by the object manager
+ */
+void UAVObject::setUpdateBus(UAVObjectUpdateBus *bus)
+{
+    updateBus = bus;
+}
+
+static QElapsedTimer startedClock()
+{
+    QElapsedTimer clock;
+
+    clock.start();
+    return clock;
+}
+
+/**
+ * Monotonic clock shared by all objects, in microseconds
+ */
+qint64 UAVObject::clockUs()
+{
+    static const QElapsedTimer clock = startedClock();
+
+    return clock.nsecsElapsed() / 1000;
+}
+
+/**
+ * Time since the last data update, -1 if the object was never updated
+ */
+qint64 UAVObject::getDataAgeMs() const
+{
+    qint64 timestamp = m_updateTimestampUs.load();
+
+    return timestamp == 0 ? -1 : (clockUs() - timestamp) / 1000;
+}
+
+/**
+ * Count a data update and stamp it, called before the update events are emitted
+ */
+void UAVObject::markDataUpdated()
+{
+    // Never 0, that is "never updated"
+    m_updateTimestampUs.store(qMax<qint64>(clockUs(), 1));
+    m_updateSequence.fetchAndAddOrdered(1);
+}
+
+/**
+ * Post an update to the bus, cheap when nobody subscribed
+ */
+void UAVObject::postUpdate(quint32 events)
+{
+    if (updateBus && updateBus->hasSubscribers()) {
+        updateBus->post(this, events);
+    }
+}
+
 bool UAVObject::isSettingsObject()
 {
     return false;
@@ -33,6 +33,7 @@
 #include <QObject>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QAtomicInteger>
 #include <QString>
 #include <QList>
 #include <QFile>
@@ -50,6 +51,7 @@
 #define UAVOBJ_UPDATE_MODE_MASK                0x3
 
 class UAVObjectField;
+class UAVObjectUpdateBus;
 class QXmlStreamWriter;
 class QXmlStreamReader;
 class QJsonObject;
@@ -145,6 +147,21 @@ public:
     bool isKnown() const;
     void setIsKnown(bool isKnown);
 
+    void setUpdateBus(UAVObjectUpdateBus *bus);
+
+    // Number of data updates (unpack, setData or a field set) so far, can be polled from any thread without locking
+    Q_INVOKABLE quint32 getUpdateSequence() const
+    {
+        return m_updateSequence.load();
+    }
+    // Time of the last data update on the clockUs() clock, 0 if never updated
+    qint64 getUpdateTimestampUs() const
+    {
+        return m_updateTimestampUs.load();
+    }
+    Q_INVOKABLE qint64 getDataAgeMs() const;
+    static qint64 clockUs();
+
     virtual bool isSettingsObject();
     virtual bool isDataObject();
     virtual bool isMetaDataObject();
@@ -194,13 +211,20 @@ protected:
     QMutex *mutex;
     quint8 *data;
     QList<UAVObjectField *> fields;
+    UAVObjectUpdateBus *updateBus;
 
     void initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes);
     void setDescription(const QString & description);
     void setCategory(const QString & category);
+    void postUpdate(quint32 events);
+    void markDataUpdated();
 
 private:
+    friend class UAVObjectField;
+
     bool m_isKnown;
+    QAtomicInteger<quint32> m_updateSequence;
+    QAtomicInteger<qint64> m_updateTimestampUs;
 
 private slots:
     void fieldUpdated(UAVObjectField *field);
@@ -51,6 +51,17 @@ UAVObjectField::UAVObjectField(const QString & name, const QString & description
     constructorInitialize(name, description, units, type, elementNames, options, limits);
 }
 
+UAVObjectField::UAVObjectField(const QString & name, const QString & description, const QString & units, const QStringList & elementNames, const EnumTable *enumTable, const QString &limits)
+{
+    QStringList options;
+
+    for (quint32 n = 0; n < enumTable->numOptions; ++n) {
+        options.append(QString::fromLatin1(enumTable->options[n]));
+    }
+    constructorInitialize(name, description, units, ENUM, elementNames, options, limits);
+    this->enumTable = enumTable;
+}
+
 void UAVObjectField::constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
 {
     // Copy params
@@ -59,6 +70,7 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     this->units        = units;
     this->type         = type;
     this->options      = options;
+    this->enumTable    = NULL;
     this->numElements  = elementNames.length();
     this->offset       = 0;
     this->data         = NULL;
@@ -350,12 +362,15 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()) && options.indexOf(var.toString()) <= options.indexOf(struc.values.at(1).toString()))) {
+            {
+                int option = getOptionIndex(var.toString());
+                if (!(option >= getOptionIndex(struc.values.at(0).toString()) && option <= getOptionIndex(struc.values.at(1).toString()))) {
                     return false;
                 }
                 return true;
 
                 break;
+            }
             case STRING:
                 return true;
 
@@ -400,7 +415,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()))) {
+                if (!(getOptionIndex(var.toString()) >= getOptionIndex(struc.values.at(0).toString()))) {
                     return false;
                 }
                 return true;
@@ -443,7 +458,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) <= options.indexOf(struc.values.at(0).toString()))) {
+                if (!(getOptionIndex(var.toString()) <= getOptionIndex(struc.values.at(0).toString()))) {
                     return false;
                 }
                 return true;
@@ -671,6 +686,14 @@ QStringList UAVObjectField::getOptions()
     return options;
 }
 
+int UAVObjectField::getOptionIndex(const QString & option)
+{
+    if (enumTable) {
+        return enumTable->indexOf(option);
+    }
+    return options.indexOf(option);
+}
+
 quint32 UAVObjectField::getNumElements()
 {
     return numElements;
@@ -1080,7 +1103,7 @@ bool UAVObjectField::checkValue(const QVariant & value, quint32 index)
             break;
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = getOptionIndex(value.toString());
             return (tmpenum < 0) ? false : true;
 
             break;
@@ -1151,7 +1174,7 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
         }
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = getOptionIndex(value.toString());
             // Default to 0 on invalid values.
             if (tmpenum < 0) {
                 tmpenum = 0;
@@ -1179,6 +1202,7 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
             break;
         }
         }
+        obj->markDataUpdated();
     }
 }
 
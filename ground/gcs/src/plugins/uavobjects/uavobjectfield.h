@@ -54,8 +54,59 @@ public:
         int board;
     } LimitStruct;
 
+    /**
+     * Options of an enum field, generated with the object. The option index is found
+     * with a perfect hash of the option name, the generator chose the seed so that each
+     * option has its own slot.
+     */
+    struct EnumTable {
+        const char *const *options;
+        quint32 numOptions;
+        const qint16 *hashSlots; // option index of each slot, -1 if unused
+        quint32 numSlots; // power of 2
+        quint32 seed;
+
+        // FNV-1a of the UTF-16 code units, the generator computes the same
+        static quint32 hash(const QChar *str, int length, quint32 seed)
+        {
+            quint32 h = 2166136261u ^ seed;
+
+            for (int i = 0; i < length; ++i) {
+                h ^= str[i].unicode();
+                h *= 16777619u;
+            }
+            return h;
+        }
+        // Same hash of a Latin-1 string, whose bytes are its UTF-16 code units
+        static quint32 hash(const char *str, int length, quint32 seed)
+        {
+            quint32 h = 2166136261u ^ seed;
+
+            for (int i = 0; i < length; ++i) {
+                h ^= (quint8)str[i];
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        // -1 if not an option
+        int indexOf(const QString & option) const
+        {
+            int index = hashSlots[hash(option.constData(), option.length(), seed) & (numSlots - 1)];
+
+            return (index >= 0 && option == QLatin1String(options[index])) ? index : -1;
+        }
+        int indexOf(const char *option) const
+        {
+            int index = hashSlots[hash(option, qstrlen(option), seed) & (numSlots - 1)];
+
+            return (index >= 0 && qstrcmp(option, options[index]) == 0) ? index : -1;
+        }
+    };
+
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString & limits = QString());
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
+    UAVObjectField(const QString & name, const QString & description, const QString & units, const QStringList & elementNames, const EnumTable *enumTable, const QString & limits = QString());
     void initialize(quint8 *data, quint32 dataOffset, UAVObject *obj);
     UAVObject *getObject();
     FieldType getType();
@@ -66,6 +117,7 @@ public:
     quint32 getNumElements();
     QStringList getElementNames();
     QStringList getOptions();
+    int getOptionIndex(const QString & option);
     qint32 pack(quint8 *dataOut);
     qint32 unpack(const quint8 *dataIn);
     QVariant getValue(quint32 index = 0);
@@ -102,6 +154,7 @@ protected:
     FieldType type;
     QStringList elementNames;
     QStringList options;
+    const EnumTable *enumTable;
     quint32 numElements;
     quint32 numBytesPerElement;
     quint32 offset;
@@ -0,0 +1,340 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjecthistory.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Shared time-series history of the object fields
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjecthistory.h"
+#include "uavobject.h"
+#include "uavobjectfield.h"
+
+#include <QDateTime>
+#include <QVarLengthArray>
+#include <QtEndian>
+#include <QDebug>
+
+#include <string.h>
+#include <atomic>
+
+UAVObjectHistory::UAVObjectHistory(QObject *parent) : QObject(parent),
+    m_memoryBudget(64 * 1024 * 1024),
+    m_memoryUsed(0),
+    m_retention(0)
+{}
+
+UAVObjectHistory::~UAVObjectHistory()
+{
+    qDeleteAll(m_series);
+}
+
+/**
+ * Total size of the ring buffers, objects tracked once the budget is used get smaller buffers
+ */
+void UAVObjectHistory::setMemoryBudget(qint64 bytes)
+{
+    QWriteLocker locker(&m_lock);
+
+    m_memoryBudget = bytes;
+}
+
+qint64 UAVObjectHistory::memoryBudget() const
+{
+    QReadLocker locker(&m_lock);
+
+    return m_memoryBudget;
+}
+
+qint64 UAVObjectHistory::memoryUsed() const
+{
+    QReadLocker locker(&m_lock);
+
+    return m_memoryUsed;
+}
+
+/**
+ * Age after which samples are dropped, 0 keeps them until the ring buffer is full
+ */
+void UAVObjectHistory::setRetention(qint64 ms)
+{
+    QWriteLocker locker(&m_lock);
+
+    m_retention = ms;
+}
+
+qint64 UAVObjectHistory::retention() const
+{
+    QReadLocker locker(&m_lock);
+
+    return m_retention;
+}
+
+/**
+ * Start recording the updates of an object instance, or add a reference if already recorded
+ * @param capacity Maximum number of samples, reduced to what is left of the memory budget
+ * @returns false if the object has no numeric field or the budget is exhausted
+ */
+bool UAVObjectHistory::track(UAVObject *obj, int capacity)
+{
+    QWriteLocker locker(&m_lock);
+
+    Series *series = m_series.value(obj);
+
+    if (series) {
+        ++series->refCount;
+        return true;
+    }
+
+    QVector<UAVObjectField *> fields;
+    QVector<int> fieldColumns;
+    int columns = 0;
+    foreach(UAVObjectField * field, obj->getFields()) {
+        if (field->getType() != UAVObjectField::STRING) {
+            fields.append(field);
+            fieldColumns.append(columns);
+            columns += field->getNumElements();
+        }
+    }
+    if (columns == 0) {
+        return false;
+    }
+
+    qint64 sampleBytes = sizeof(qint64) + columns * sizeof(double);
+    capacity = qMin<qint64>(capacity, (m_memoryBudget - m_memoryUsed) / sampleBytes);
+    if (capacity < MIN_CAPACITY) {
+        qWarning() << "UAVObjectHistory - memory budget exhausted, not tracking" << obj->getName();
+        return false;
+    }
+
+    QSharedPointer<Ring> ring(new Ring);
+    ring->capacity = capacity;
+    ring->timestamps.resize(capacity);
+    ring->values.resize(capacity * columns);
+
+    series = new Series;
+    series->obj          = obj;
+    series->refCount     = 1;
+    series->capacity     = capacity;
+    series->first        = 0;
+    series->count        = 0;
+    series->columns      = columns;
+    series->ring         = ring;
+    series->fields       = fields;
+    series->fieldColumns = fieldColumns;
+    series->bytes        = capacity * sampleBytes;
+
+    m_series.insert(obj, series);
+    m_memoryUsed += series->bytes;
+
+    // Record in the thread that updates the object, so that no sample is coalesced
+    connect(obj, &UAVObject::objectUpdated, this, &UAVObjectHistory::record, Qt::DirectConnection);
+    return true;
+}
+
+/**
+ * Release a reference, the history of the object is dropped with the last one
+ */
+void UAVObjectHistory::untrack(UAVObject *obj)
+{
+    QWriteLocker locker(&m_lock);
+
+    Series *series = m_series.value(obj);
+
+    if (!series || --series->refCount > 0) {
+        return;
+    }
+    disconnect(obj, &UAVObject::objectUpdated, this, &UAVObjectHistory::record);
+    m_series.remove(obj);
+    m_memoryUsed -= series->bytes;
+    delete series;
+}
+
+bool UAVObjectHistory::isTracked(UAVObject *obj) const
+{
+    QReadLocker locker(&m_lock);
+
+    return m_series.contains(obj);
+}
+
+int UAVObjectHistory::sampleCount(UAVObject *obj) const
+{
+    QReadLocker locker(&m_lock);
+
+    Series *series = m_series.value(obj);
+
+    return series ? series->count : 0;
+}
+
+/**
+ * Get the samples of a field element with fromMs <= timestamp <= toMs, oldest first
+ */
+UAVObjectHistory::View UAVObjectHistory::range(UAVObject *obj, UAVObjectField *field, int element, qint64 fromMs, qint64 toMs) const
+{
+    View view;
+
+    QReadLocker locker(&m_lock);
+
+    Series *series = m_series.value(obj);
+    if (!series || element < 0 || element >= (int)field->getNumElements()) {
+        return view;
+    }
+    int f = series->fields.indexOf(field);
+    if (f < 0) {
+        return view;
+    }
+
+    const Ring *ring         = series->ring.data();
+    const qint64 *timestamps = ring->timestamps.constData();
+    int capacity = series->capacity;
+    int first    = series->first;
+
+    // Timestamps do not decrease, binary search both ends in logical order
+    int begin    = 0;
+    int end      = series->count;
+    while (begin < end) {
+        int mid = (begin + end) / 2;
+        if (timestamps[(first + mid) % capacity] < fromMs) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    int last = begin;
+    end = series->count;
+    while (last < end) {
+        int mid = (last + end) / 2;
+        if (timestamps[(first + mid) % capacity] <= toMs) {
+            last = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    if (last == begin) {
+        return view;
+    }
+
+    // The window is at most two contiguous runs of the ring buffer
+    const double *column = ring->values.constData() + (series->fieldColumns.at(f) + element) * capacity;
+    int start = (first + begin) % capacity;
+
+    view.m_ring          = series->ring;
+    view.m_size          = last - begin;
+    view.m_head          = qMin(view.m_size, capacity - start);
+    view.m_timestamps[0] = timestamps + start;
+    view.m_values[0]     = column + start;
+    view.m_timestamps[1] = timestamps;
+    view.m_values[1]     = column;
+    // The samples of the series are the last ones written
+    view.m_firstSequence = (quint32)ring->writes.load() - series->count + begin;
+    return view;
+}
+
+int UAVObjectHistory::View::overwritten() const
+{
+    if (!m_ring) {
+        return 0;
+    }
+    // The samples were read before, like a seqlock reader
+    std::atomic_thread_fence(std::memory_order_acquire);
+    quint32 written = (quint32)m_ring->writes.load() - m_firstSequence;
+    if (written <= (quint32)m_ring->capacity) {
+        return 0;
+    }
+    return qMin<quint32>(written - m_ring->capacity, m_size);
+}
+
+void UAVObjectHistory::record(UAVObject *obj)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVarLengthArray<quint8, 256> data(obj->getNumBytes());
+
+    obj->pack(data.data());
+
+    QWriteLocker locker(&m_lock);
+
+    Series *series = m_series.value(obj);
+    if (!series) {
+        return;
+    }
+
+    Ring *ring   = series->ring.data();
+    int capacity = series->capacity;
+    if (series->count == capacity) {
+        series->first = (series->first + 1) % capacity;
+        --series->count;
+    }
+    if (m_retention > 0) {
+        while (series->count > 0 && ring->timestamps.at(series->first) < now - m_retention) {
+            series->first = (series->first + 1) % capacity;
+            --series->count;
+        }
+    }
+
+    // Counted first, so that a view reading the slot sees it overwritten
+    ring->writes.fetchAndAddOrdered(1);
+    int index = (series->first + series->count) % capacity;
+    ring->timestamps[index] = now;
+    double *values = ring->values.data() + index;
+    for (int f = 0; f < series->fields.size(); ++f) {
+        UAVObjectField *field = series->fields.at(f);
+        int column = series->fieldColumns.at(f);
+        for (quint32 i = 0; i < field->getNumElements(); ++i) {
+            values[(column + i) * capacity] = decode(field, data.constData(), i);
+        }
+    }
+    ++series->count;
+}
+
+/**
+ * Read an element from the packed object data, enums as their index
+ */
+double UAVObjectHistory::decode(UAVObjectField *field, const quint8 *data, quint32 index)
+{
+    const quint8 *element = data + field->getDataOffset() + index * (field->getNumBytes() / field->getNumElements());
+
+    switch (field->getType()) {
+    case UAVObjectField::INT8:
+        return (qint8)element[0];
+
+    case UAVObjectField::INT16:
+        return qFromLittleEndian<qint16>(element);
+
+    case UAVObjectField::INT32:
+        return qFromLittleEndian<qint32>(element);
+
+    case UAVObjectField::UINT16:
+        return qFromLittleEndian<quint16>(element);
+
+    case UAVObjectField::UINT32:
+        return qFromLittleEndian<quint32>(element);
+
+    case UAVObjectField::FLOAT32:
+    {
+        quint32 raw = qFromLittleEndian<quint32>(element);
+        float value;
+        memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+    default:
+        return element[0];
+    }
+}
@@ -0,0 +1,190 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjecthistory.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Shared time-series history of the object fields
+ *
+ * Nothing is recorded until a consumer tracks an object. From then on every
+ * update of the object is stored, one time-stamped sample per update, in a ring
+ * buffer with one column per numeric field element. Tracking is reference
+ * counted, a gadget opened later on an already tracked object can back-fill
+ * its display from the history at once:
+ *
+ *   UAVObjectHistory *history = objMngr->getHistory();
+ *   history->track(obj);
+ *   UAVObjectHistory::View view = history->range(obj, field, element, fromMs, toMs);
+ *   for (int i = 0; i < view.size(); ++i) ... view.timestamp(i), view.value(i)
+ *   ...
+ *   history->untrack(obj);
+ *
+ * A View points into the ring buffer, nothing is copied and no lock is held
+ * while it is read, also in the thread that records the object. The buffer
+ * is kept as long as a view of it exists. Samples that the ring buffer
+ * wrapped over since the view was taken are overwritten, the oldest first:
+ * read the samples, then check isValid() or overwritten().
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTHISTORY_H
+#define UAVOBJECTHISTORY_H
+
+#include "uavobjects_global.h"
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QAtomicInt>
+
+class UAVObject;
+class UAVObjectField;
+
+class UAVOBJECTS_EXPORT UAVObjectHistory : public QObject {
+    Q_OBJECT
+
+private:
+    struct Ring;
+
+public:
+    static const int DEFAULT_CAPACITY = 6000;
+    static const int MIN_CAPACITY     = 16;
+
+    /**
+     * Samples of one field element within a time range, oldest first, in at
+     * most two contiguous segments of the ring buffer
+     */
+    class UAVOBJECTS_EXPORT View {
+    public:
+        View() : m_size(0), m_head(0), m_firstSequence(0)
+        {
+            m_timestamps[0] = m_timestamps[1] = 0;
+            m_values[0]     = m_values[1] = 0;
+        }
+
+        int size() const
+        {
+            return m_size;
+        }
+        bool isEmpty() const
+        {
+            return m_size == 0;
+        }
+        // Milliseconds since epoch
+        qint64 timestamp(int index) const
+        {
+            return index < m_head ? m_timestamps[0][index] : m_timestamps[1][index - m_head];
+        }
+        double value(int index) const
+        {
+            return index < m_head ? m_values[0][index] : m_values[1][index - m_head];
+        }
+
+        // 1 or 2 segments, 0 when empty
+        int segmentCount() const
+        {
+            return m_size == 0 ? 0 : (m_size > m_head ? 2 : 1);
+        }
+        int segmentSize(int segment) const
+        {
+            return segment == 0 ? m_head : m_size - m_head;
+        }
+        const qint64 *timestamps(int segment) const
+        {
+            return m_timestamps[segment];
+        }
+        const double *values(int segment) const
+        {
+            return m_values[segment];
+        }
+
+        // Number of the oldest samples overwritten, or being overwritten, since the view was taken
+        int overwritten() const;
+        bool isValid() const
+        {
+            return overwritten() == 0;
+        }
+
+    private:
+        friend class UAVObjectHistory;
+
+        QSharedPointer<const Ring> m_ring;
+        const qint64 *m_timestamps[2];
+        const double *m_values[2];
+        int m_size;
+        int m_head;
+        // Ring write count of the first sample
+        quint32 m_firstSequence;
+    };
+
+    UAVObjectHistory(QObject *parent = 0);
+    ~UAVObjectHistory();
+
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+    qint64 memoryUsed() const;
+    void setRetention(qint64 ms);
+    qint64 retention() const;
+
+    bool track(UAVObject *obj, int capacity = DEFAULT_CAPACITY);
+    void untrack(UAVObject *obj);
+    bool isTracked(UAVObject *obj) const;
+
+    View range(UAVObject *obj, UAVObjectField *field, int element, qint64 fromMs, qint64 toMs) const;
+    int sampleCount(UAVObject *obj) const;
+
+private slots:
+    void record(UAVObject *obj);
+
+private:
+    // Shared with the views, it outlives the series while they exist
+    struct Ring {
+        int capacity;
+        QVector<qint64> timestamps;
+        // Column major, capacity values per column
+        QVector<double> values;
+        // Samples written, counted before the slot is written
+        QAtomicInt writes;
+    };
+
+    struct Series {
+        UAVObject *obj;
+        int refCount;
+        int capacity;
+        // Index of the oldest sample and number of samples
+        int first;
+        int count;
+        int columns;
+        QSharedPointer<Ring> ring;
+        QVector<UAVObjectField *> fields;
+        QVector<int> fieldColumns;
+        qint64 bytes;
+    };
+
+    mutable QReadWriteLock m_lock;
+    QHash<UAVObject *, Series *> m_series;
+    qint64 m_memoryBudget;
+    qint64 m_memoryUsed;
+    qint64 m_retention;
+
+    static double decode(UAVObjectField *field, const quint8 *data, quint32 index);
+};
+
+#endif // UAVOBJECTHISTORY_H
@@ -35,7 +35,9 @@
  */
 UAVObjectManager::UAVObjectManager()
 {
-    mutex = new QMutex(QMutex::Recursive);
+    mutex     = new QMutex(QMutex::Recursive);
+    updateBus = new UAVObjectUpdateBus(this);
+    history   = new UAVObjectHistory(this);
 }
 
 UAVObjectManager::~UAVObjectManager()
@@ -84,6 +86,7 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
                 for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
                     UAVDataObject *cobj = obj->clone(instidx);
                     cobj->initialize(mobj);
+                    cobj->setUpdateBus(updateBus);
                     objects[objidx].append(cobj);
                     getObject(cobj->getObjID())->emitNewInstance(cobj);
                     emit newInstance(cobj);
@@ -97,6 +100,7 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
                 return false;
             }
             // Add the actual object instance in the list
+            obj->setUpdateBus(updateBus);
             objects[objidx].append(obj);
             getObject(obj->getObjID())->emitNewInstance(obj);
             emit newInstance(obj);
@@ -121,6 +125,7 @@ void UAVObjectManager::addObject(UAVObject *obj)
 {
     // Add to list
     QList<UAVObject *> list;
+    obj->setUpdateBus(updateBus);
     list.append(obj);
     objects.append(list);
     emit newObject(obj);
@@ -229,14 +234,17 @@ UAVObject *UAVObjectManager::getObject(const QString *name, quint32 objId, quint
     QMutexLocker locker(mutex);
 
     // Check if this object type is already in the list
+    // Const access only, the lists may be shared with a copy returned by getObjects()
+    // and must not detach on this hot path
     for (int objidx = 0; objidx < objects.length(); ++objidx) {
+        const QList<UAVObject *> &instances = objects.at(objidx);
         // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
+        if (instances.length() > 0) {
+            if ((name != NULL && instances.at(0)->getName().compare(name) == 0) || (name == NULL && instances.at(0)->getObjID() == objId)) {
                 // Look for the requested instance ID
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == instId) {
-                        return objects[objidx][instidx];
+                for (int instidx = 0; instidx < instances.length(); ++instidx) {
+                    if (instances.at(instidx)->getInstID() == instId) {
+                        return instances.at(instidx);
                     }
                 }
             }
@@ -272,10 +280,11 @@ QList<UAVObject *> UAVObjectManager::getObjectInstances(const QString *name, qui
 
     // Check if this object type is already in the list
     for (int objidx = 0; objidx < objects.length(); ++objidx) {
+        const QList<UAVObject *> &instances = objects.at(objidx);
         // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx];
+        if (instances.length() > 0) {
+            if ((name != NULL && instances.at(0)->getName().compare(name) == 0) || (name == NULL && instances.at(0)->getObjID() == objId)) {
+                return instances;
             }
         }
     }
@@ -366,10 +375,11 @@ qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
 
     // Check if this object type is already in the list
     for (int objidx = 0; objidx < objects.length(); ++objidx) {
+        const QList<UAVObject *> &instances = objects.at(objidx);
         // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx].length();
+        if (instances.length() > 0) {
+            if ((name != NULL && instances.at(0)->getName().compare(name) == 0) || (name == NULL && instances.at(0)->getObjID() == objId)) {
+                return instances.length();
             }
         }
     }
@@ -32,6 +32,8 @@
 #include "uavobject.h"
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
+#include "uavobjectupdatebus.h"
+#include "uavobjecthistory.h"
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
@@ -56,6 +58,15 @@ public:
     qint32 getNumInstances(const QString & name);
     qint32 getNumInstances(quint32 objId);
 
+    UAVObjectUpdateBus *getUpdateBus()
+    {
+        return updateBus;
+    }
+    UAVObjectHistory *getHistory()
+    {
+        return history;
+    }
+
     void toJson(QJsonObject &jsonObject, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
     void toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport);
     void toJson(QJsonObject &jsonObject, const QList<UAVObject *> &objectsToExport);
@@ -70,6 +81,8 @@ private:
 
     QList< QList<UAVObject *> > objects;
     QMutex *mutex;
+    UAVObjectUpdateBus *updateBus;
+    UAVObjectHistory *history;
 
     void addObject(UAVObject *obj);
     UAVObject *getObject(const QString *name, quint32 objId, quint32 instId);
@@ -0,0 +1,434 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectupdatebus.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Batched delivery of object updates to subscribers in any thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectupdatebus.h"
+#include "uavobject.h"
+#include "uavdataobject.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QJsonObject>
+#include <QPointer>
+#include <QThread>
+
+#include <string.h>
+
+static const QEvent::Type DeliveryEventType = static_cast<QEvent::Type>(QEvent::registerEventType());
+
+/**
+ * Posted to a subscription to deliver its batch. Qt deletes the posted
+ * events, the memory is kept for the next ones instead of freed.
+ */
+class DeliveryEvent : public QEvent {
+public:
+    DeliveryEvent() : QEvent(DeliveryEventType)
+    {}
+
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
+private:
+    // At most two events per subscription are in flight, the one being
+    // handled and the next one
+    static const int POOL_SIZE = 32;
+    static QBasicMutex poolMutex;
+    static void *pool[POOL_SIZE];
+    static int poolCount;
+};
+
+QBasicMutex DeliveryEvent::poolMutex;
+void *DeliveryEvent::pool[DeliveryEvent::POOL_SIZE];
+int DeliveryEvent::poolCount = 0;
+
+void *DeliveryEvent::operator new(size_t size)
+{
+    {
+        QMutexLocker locker(&poolMutex);
+        if (poolCount > 0 && size == sizeof(DeliveryEvent)) {
+            return pool[--poolCount];
+        }
+    }
+    return ::operator new(size);
+}
+
+void DeliveryEvent::operator delete(void *ptr)
+{
+    {
+        QMutexLocker locker(&poolMutex);
+        if (poolCount < POOL_SIZE) {
+            pool[poolCount++] = ptr;
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+UAVObjectUpdateBus::UAVObjectUpdateBus(QObject *parent) : QObject(parent),
+    m_subscriberCount(0),
+    m_captureCount(0)
+{
+    m_clock.start();
+}
+
+UAVObjectUpdateBus::~UAVObjectUpdateBus()
+{
+    QMutexLocker locker(&m_mutex);
+
+    foreach(UAVObjectUpdateSubscription * subscription, m_subscriptions) {
+        subscription->m_bus = 0;
+    }
+    m_subscriptions.clear();
+    m_subscriberCount.store(0);
+    m_captureCount.store(0);
+}
+
+/**
+ * Subscribe to the updates of all objects
+ * @param context The updated() signal is emitted in the thread of this object, the subscription is deleted with it
+ * @param eventMask EventFlag bits of the events to deliver
+ */
+UAVObjectUpdateSubscription *UAVObjectUpdateBus::subscribe(QObject *context, quint32 eventMask)
+{
+    return subscribe(context, QList<quint32>(), eventMask);
+}
+
+/**
+ * Subscribe to the updates of the given objects, all instances
+ */
+UAVObjectUpdateSubscription *UAVObjectUpdateBus::subscribe(QObject *context, const QList<quint32> &objIds, quint32 eventMask)
+{
+    Q_ASSERT(context);
+
+    UAVObjectUpdateSubscription *subscription = new UAVObjectUpdateSubscription(this, eventMask);
+
+    foreach(quint32 objId, objIds) {
+        subscription->m_objIds.insert(objId);
+    }
+    if (context->thread() != subscription->thread()) {
+        subscription->moveToThread(context->thread());
+    }
+    subscription->setParent(context);
+
+    QMutexLocker locker(&m_mutex);
+    m_subscriptions.append(subscription);
+    m_subscriberCount.store(m_subscriptions.size());
+    return subscription;
+}
+
+void UAVObjectUpdateBus::unsubscribe(UAVObjectUpdateSubscription *subscription)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_subscriptions.removeAll(subscription);
+    m_subscriberCount.store(m_subscriptions.size());
+    if (subscription->m_dataCaptured) {
+        m_captureCount.deref();
+    }
+}
+
+/**
+ * Queue an update for all matching subscriptions. A delivery is scheduled
+ * for the subscriptions that had nothing pending yet.
+ */
+void UAVObjectUpdateBus::post(UAVObject *obj, quint32 events)
+{
+    if (!hasSubscribers()) {
+        return;
+    }
+
+    qint64 now = nowUs();
+    quint32 sequence = obj->getUpdateSequence();
+    QByteArray noData;
+    QByteArray *data = &noData;
+
+    // The object lock is taken before the bus lock, as in unpack() and setData()
+    if (m_captureCount.load() > 0) {
+        data = &m_packBuffers.localData();
+        data->resize(obj->getNumBytes());
+        obj->pack(reinterpret_cast<quint8 *>(data->data()));
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    foreach(UAVObjectUpdateSubscription * subscription, m_subscriptions) {
+        if (subscription->enqueue(obj, events, now, sequence, *data)) {
+            QCoreApplication::postEvent(subscription, new DeliveryEvent());
+        }
+    }
+}
+
+UAVObjectUpdateSubscription::UAVObjectUpdateSubscription(UAVObjectUpdateBus *bus, quint32 eventMask) :
+    m_bus(bus),
+    m_eventMask(eventMask),
+    m_coalesced(false),
+    m_dataCaptured(false),
+    m_maxPending(DEFAULT_MAX_PENDING),
+    m_deliveryPending(false),
+    m_totalLatencyUs(0),
+    m_delivering(false)
+{
+    memset(&m_stats, 0, sizeof(Stats));
+}
+
+UAVObjectUpdateSubscription::~UAVObjectUpdateSubscription()
+{
+    if (m_bus) {
+        m_bus->unsubscribe(this);
+    }
+    qDeleteAll(m_samples);
+}
+
+void UAVObjectUpdateSubscription::addObjectId(quint32 objId)
+{
+    if (!m_bus) {
+        return;
+    }
+    QMutexLocker locker(&m_bus->m_mutex);
+    m_objIds.insert(objId);
+}
+
+void UAVObjectUpdateSubscription::removeObjectId(quint32 objId)
+{
+    if (!m_bus) {
+        return;
+    }
+    QMutexLocker locker(&m_bus->m_mutex);
+    m_objIds.remove(objId);
+}
+
+void UAVObjectUpdateSubscription::setCoalesced(bool coalesced)
+{
+    if (!m_bus) {
+        return;
+    }
+    QMutexLocker locker(&m_bus->m_mutex);
+    m_coalesced = coalesced;
+}
+
+void UAVObjectUpdateSubscription::setDataCaptured(bool captured)
+{
+    if (!m_bus) {
+        return;
+    }
+    QMutexLocker locker(&m_bus->m_mutex);
+    if (captured != m_dataCaptured) {
+        m_dataCaptured = captured;
+        if (captured) {
+            m_bus->m_captureCount.ref();
+        } else {
+            m_bus->m_captureCount.deref();
+        }
+    }
+}
+
+void UAVObjectUpdateSubscription::setMaxPending(int maxPending)
+{
+    if (!m_bus) {
+        return;
+    }
+    QMutexLocker locker(&m_bus->m_mutex);
+    m_maxPending = qMax(1, maxPending);
+}
+
+UAVObject *UAVObjectUpdateSubscription::sample(const Update &update)
+{
+    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(update.obj);
+
+    if (update.data.isEmpty() || !dataObject) {
+        return update.obj;
+    }
+    UAVDataObject *copy = m_samples.value(update.obj);
+    if (!copy) {
+        copy = dataObject->clone(dataObject->getInstID());
+        m_samples.insert(update.obj, copy);
+    }
+    copy->unpack(reinterpret_cast<const quint8 *>(update.data.constData()));
+    return copy;
+}
+
+void UAVObjectUpdateSubscription::sampleToJson(const Update &update, QJsonObject &jsonObject)
+{
+    sample(update)->toJson(jsonObject);
+    jsonObject["updateSequence"] = (qint64)update.sequence;
+    jsonObject["updateAgeMs"]    = m_bus ? (m_bus->nowUs() - update.postedUs) / 1000 : update.obj->getDataAgeMs();
+}
+
+UAVObjectUpdateSubscription::Stats UAVObjectUpdateSubscription::getStats() const
+{
+    if (!m_bus) {
+        return m_stats;
+    }
+    QMutexLocker locker(&m_bus->m_mutex);
+    return m_stats;
+}
+
+void UAVObjectUpdateSubscription::resetStats()
+{
+    if (!m_bus) {
+        return;
+    }
+    QMutexLocker locker(&m_bus->m_mutex);
+    memset(&m_stats, 0, sizeof(Stats));
+    m_totalLatencyUs = 0;
+}
+
+/**
+ * Add an update to the pending batch, called with the bus mutex held
+ * @returns true if a delivery must be scheduled
+ */
+bool UAVObjectUpdateSubscription::enqueue(UAVObject *obj, quint32 events, qint64 nowUs, quint32 sequence, const QByteArray &data)
+{
+    events &= m_eventMask;
+    if (events == 0 || (!m_objIds.isEmpty() && !m_objIds.contains(obj->getObjID()))) {
+        return false;
+    }
+
+    ++m_stats.posts;
+
+    // Coalesce with a pending update of the same instance, it keeps its first post time
+    QHash<UAVObject *, int>::const_iterator it = m_coalesced ? m_pendingIndex.constFind(obj) : m_pendingIndex.constEnd();
+    if (it != m_pendingIndex.constEnd()) {
+        Update &update = m_pending[it.value()];
+        update.events  |= events;
+        update.sequence = sequence;
+        ++update.count;
+        if (m_dataCaptured) {
+            captureData(update, data);
+        }
+    } else if (m_pending.size() >= m_maxPending) {
+        // The subscriber does not keep up, its memory stays bounded
+        ++m_stats.drops;
+    } else {
+        Update update;
+        update.obj      = obj;
+        update.events   = events;
+        update.count    = 1;
+        update.postedUs = nowUs;
+        update.sequence = sequence;
+        if (m_dataCaptured) {
+            captureData(update, data);
+        }
+        if (m_coalesced) {
+            m_pendingIndex.insert(obj, m_pending.size());
+        }
+        m_pending.append(update);
+    }
+
+    if (m_deliveryPending) {
+        return false;
+    }
+    m_deliveryPending = true;
+    return true;
+}
+
+/**
+ * Copy the packed data into the update, into the buffer of an earlier
+ * update if there is one. Called with the bus mutex held.
+ */
+void UAVObjectUpdateSubscription::captureData(Update &update, const QByteArray &data)
+{
+    if (update.data.isNull() && !m_spareData.isEmpty()) {
+        update.data = m_spareData.takeLast();
+    }
+    update.data.resize(data.size());
+    memcpy(update.data.data(), data.constData(), data.size());
+}
+
+/**
+ * Keep the data buffers of a delivered batch the subscriber did not hold on to
+ */
+void UAVObjectUpdateSubscription::recycleData(const UpdateBatch &batch)
+{
+    static const int MAX_SPARE_DATA = 256;
+
+    QMutexLocker locker(&m_bus->m_mutex);
+
+    for (int i = 0; i < batch.size() && m_spareData.size() < MAX_SPARE_DATA; ++i) {
+        const QByteArray &data = batch.at(i).data;
+        if (!data.isNull() && data.isDetached()) {
+            m_spareData.append(data);
+        }
+    }
+}
+
+bool UAVObjectUpdateSubscription::event(QEvent *event)
+{
+    if (event->type() == DeliveryEventType) {
+        deliver();
+        return true;
+    }
+    return QObject::event(event);
+}
+
+void UAVObjectUpdateSubscription::deliver()
+{
+    if (!m_bus) {
+        return;
+    }
+    // A subscriber running an event loop in its slot gets the next batch in
+    // a vector of its own, the outer batch is still being delivered
+    UpdateBatch nested;
+    UpdateBatch &batch = m_delivering ? nested : m_batch;
+    {
+        QMutexLocker locker(&m_bus->m_mutex);
+        // Take the batch, the next post schedules a new delivery
+        batch.swap(m_pending);
+        m_pendingIndex.clear();
+        m_deliveryPending = false;
+
+        if (batch.isEmpty()) {
+            return;
+        }
+        qint64 now = m_bus->nowUs();
+        for (int i = 0; i < batch.size(); ++i) {
+            qint64 latency = now - batch.at(i).postedUs;
+            m_totalLatencyUs += latency;
+            if (latency > m_stats.maxLatencyUs) {
+                m_stats.maxLatencyUs = latency;
+            }
+        }
+        ++m_stats.deliveries;
+        m_stats.updates += batch.size();
+        m_stats.lastLatencyUs    = now - batch.first().postedUs;
+        m_stats.averageLatencyUs = (double)m_totalLatencyUs / m_stats.updates;
+    }
+
+    if (&batch == &nested) {
+        emit updated(batch);
+        return;
+    }
+    // The subscriber may delete its context, and the subscription with it
+    QPointer<UAVObjectUpdateSubscription> guard(this);
+    m_delivering = true;
+    emit updated(batch);
+    if (guard) {
+        m_delivering = false;
+        if (m_bus && m_dataCaptured) {
+            recycleData(batch);
+        }
+        batch.clear();
+    }
+}
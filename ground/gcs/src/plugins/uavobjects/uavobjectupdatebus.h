@@ -0,0 +1,209 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectupdatebus.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Batched delivery of object updates to subscribers in any thread
+ *
+ * Instead of connecting a slot to the signals of every object, a consumer
+ * subscribes once to the bus of the UAVObjectManager, for all objects or a set
+ * of object IDs. The updates posted while the consumer's thread is busy are
+ * delivered in one batch on the next turn of that thread's event loop, either
+ * every one of them or, with setCoalesced(), the latest one per instance:
+ *
+ *   UAVObjectUpdateSubscription *sub = objMngr->getUpdateBus()->subscribe(this);
+ *   connect(sub, &UAVObjectUpdateSubscription::updated, this, &Consumer::objectsUpdated);
+ *
+ * The per object signals are still emitted synchronously, consumers that rely
+ * on direct delivery (e.g. Telemetry) keep using them.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTUPDATEBUS_H
+#define UAVOBJECTUPDATEBUS_H
+
+#include "uavobjects_global.h"
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QThreadStorage>
+
+class QJsonObject;
+
+class UAVObject;
+class UAVDataObject;
+class UAVObjectUpdateBus;
+
+class UAVOBJECTS_EXPORT UAVObjectUpdateSubscription : public QObject {
+    Q_OBJECT
+
+    friend class UAVObjectUpdateBus;
+
+public:
+    struct Update {
+        UAVObject  *obj;
+        // UAVObjectUpdateBus::EventFlag bits, or-ed when coalesced
+        quint32    events;
+        // Number of posts coalesced into this entry, 1 unless coalesced
+        quint32    count;
+        // Bus clock time of the first post, in microseconds
+        qint64     postedUs;
+        // Update sequence number of the object at the last post
+        quint32    sequence;
+        // Packed object data at the last post, only with setDataCaptured()
+        QByteArray data;
+    };
+
+    typedef QVector<Update> UpdateBatch;
+
+    /**
+     * Delivery latency, time between the post of an update and its delivery
+     */
+    typedef struct {
+        quint64 deliveries;
+        quint64 updates;
+        quint64 posts;
+        qint64  lastLatencyUs;
+        qint64  maxLatencyUs;
+        double  averageLatencyUs;
+        // Posts dropped because the pending batch was full
+        quint64 drops;
+    } Stats;
+
+    static const int DEFAULT_MAX_PENDING = 4096;
+
+    ~UAVObjectUpdateSubscription();
+
+    void addObjectId(quint32 objId);
+    void removeObjectId(quint32 objId);
+
+    // Merge the updates of an instance that arrive before the delivery into
+    // one entry, for consumers that only need the latest values. Off by
+    // default, every update is delivered.
+    void setCoalesced(bool coalesced);
+    // Copy the object data into each update when it is posted, the object
+    // may have changed again by the time the batch is delivered
+    void setDataCaptured(bool captured);
+    // Most updates waiting for delivery. A subscriber that does not keep up
+    // loses the posts beyond that, counted in the stats drops.
+    void setMaxPending(int maxPending);
+
+    // The object as it was when the update was posted: with captured data a
+    // copy owned by the subscription, reused for the next updates of the same
+    // instance. Otherwise, or for metaobjects, the object itself.
+    UAVObject *sample(const Update &update);
+    // The sample as streamed: UAVObject::toJson() plus its "updateSequence"
+    // and "updateAgeMs", the time since it was posted
+    void sampleToJson(const Update &update, QJsonObject &jsonObject);
+
+    Stats getStats() const;
+    void resetStats();
+
+signals:
+    void updated(const UAVObjectUpdateSubscription::UpdateBatch &batch);
+
+protected:
+    bool event(QEvent *event);
+
+private:
+    UAVObjectUpdateSubscription(UAVObjectUpdateBus *bus, quint32 eventMask);
+
+    // Everything below is protected by the bus mutex
+    UAVObjectUpdateBus *m_bus;
+    quint32 m_eventMask;
+    bool m_coalesced;
+    bool m_dataCaptured;
+    // Empty for all objects
+    QSet<quint32> m_objIds;
+    UpdateBatch m_pending;
+    QHash<UAVObject *, int> m_pendingIndex;
+    int m_maxPending;
+    // Captured data buffers of delivered updates, reused for the next ones
+    QVector<QByteArray> m_spareData;
+    bool m_deliveryPending;
+    Stats m_stats;
+    qint64 m_totalLatencyUs;
+
+    // Used in the subscription thread only
+    QHash<UAVObject *, UAVDataObject *> m_samples;
+    // Batch being delivered. Its storage is swapped with the pending one,
+    // so once grown neither is allocated again.
+    UpdateBatch m_batch;
+    bool m_delivering;
+
+    bool enqueue(UAVObject *obj, quint32 events, qint64 nowUs, quint32 sequence, const QByteArray &data);
+    void captureData(Update &update, const QByteArray &data);
+    void recycleData(const UpdateBatch &batch);
+    void deliver();
+};
+
+class UAVOBJECTS_EXPORT UAVObjectUpdateBus : public QObject {
+    Q_OBJECT
+
+    friend class UAVObjectUpdateSubscription;
+
+public:
+    enum EventFlag {
+        EVENT_UPDATED        = 0x01, /** Any update, same as the objectUpdated() signal */
+        EVENT_UPDATED_AUTO   = 0x02, /** Data changed locally by setData() */
+        EVENT_UPDATED_MANUAL = 0x04, /** updated() called */
+        EVENT_UNPACKED       = 0x08, /** Data received from the vehicle */
+        EVENT_ALL = 0x0F
+    };
+
+    UAVObjectUpdateBus(QObject *parent = 0);
+    ~UAVObjectUpdateBus();
+
+    // The subscription lives in the thread of the context object and is deleted with it
+    UAVObjectUpdateSubscription *subscribe(QObject *context, quint32 eventMask = EVENT_UPDATED);
+    UAVObjectUpdateSubscription *subscribe(QObject *context, const QList<quint32> &objIds, quint32 eventMask = EVENT_UPDATED);
+
+    // Called by the objects, from any thread
+    void post(UAVObject *obj, quint32 events);
+
+    bool hasSubscribers() const
+    {
+        return m_subscriberCount.load() > 0;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QList<UAVObjectUpdateSubscription *> m_subscriptions;
+    QAtomicInt m_subscriberCount;
+    // Subscriptions with captured data, the data is packed before taking the mutex
+    QAtomicInt m_captureCount;
+    // Per posting thread, the data is packed before taking the mutex
+    QThreadStorage<QByteArray> m_packBuffers;
+    QElapsedTimer m_clock;
+
+    qint64 nowUs() const
+    {
+        return m_clock.nsecsElapsed() / 1000;
+    }
+    void unsubscribe(UAVObjectUpdateSubscription *subscription);
+};
+
+#endif // UAVOBJECTUPDATEBUS_H
@@ -35,6 +35,8 @@
 #include "uavtalk/oplinkmanager.h"
 #include "uavsettingsimportexport/uavsettingsimportexportfactory.h"
 #include "smartsavebutton.h"
+#include "tuningstream.h"
+#include "objectreloader.h"
 #include "mixercurvewidget.h"
 
 #include <QCheckBox>
@@ -51,7 +53,8 @@
 
 ConfigTaskWidget::ConfigTaskWidget(QWidget *parent, ConfigTaskType configType) : QWidget(parent),
     m_currentBoardId(-1), m_isConnected(false), m_isWidgetUpdatesAllowed(true), m_isDirty(false), m_refreshing(false),
-    m_wikiURL("Welcome"), m_saveButton(NULL), m_outOfLimitsStyle("background-color: rgb(255, 0, 0);"), m_realtimeUpdateTimer(NULL)
+    m_wikiURL("Welcome"), m_saveButton(NULL), m_outOfLimitsStyle("background-color: rgb(255, 0, 0);"), m_objectReloader(NULL),
+    m_tuningStream(NULL), m_realtimeUpdateRate(0)
 {
     m_configType        = configType;
 
@@ -105,10 +108,6 @@ ConfigTaskWidget::~ConfigTaskWidget()
             delete binding;
         }
     }
-    if (m_realtimeUpdateTimer) {
-        delete m_realtimeUpdateTimer;
-        m_realtimeUpdateTimer = NULL;
-    }
 }
 
 bool ConfigTaskWidget::expertMode() const
@@ -371,12 +370,20 @@ void ConfigTaskWidget::onConnect()
     refreshWidgetsValues();
 
     clearDirty();
+
+    if (isRealtimeUpdating()) {
+        startTuningStream();
+    }
 }
 
 void ConfigTaskWidget::onDisconnect()
 {
     m_isConnected = false;
 
+    if (m_tuningStream) {
+        m_tuningStream->stop();
+    }
+
     emit disconnected();
 
     updateEnableControls();
@@ -608,6 +615,47 @@ void ConfigTaskWidget::invalidateObjects()
     }
 }
 
+void ConfigTaskWidget::startRealtimeUpdates(int rate)
+{
+    if (!m_saveButton) {
+        return;
+    }
+    if (!m_tuningStream) {
+        m_tuningStream = new TuningStream(this);
+        connect(m_tuningStream, SIGNAL(aboutToSend()), this, SLOT(updateObjectsFromWidgets()));
+        connect(this, SIGNAL(widgetContentsChanged(QWidget *)), m_tuningStream, SLOT(schedule()));
+    }
+    m_realtimeUpdateRate = rate;
+    m_tuningStream->setRate(rate);
+    if (m_isConnected) {
+        startTuningStream();
+    }
+}
+
+void ConfigTaskWidget::stopRealtimeUpdates()
+{
+    m_realtimeUpdateRate = 0;
+    if (m_tuningStream) {
+        m_tuningStream->stop();
+    }
+}
+
+void ConfigTaskWidget::startTuningStream()
+{
+    QList<UAVDataObject *> objects;
+
+    // The objects the apply button would upload
+    foreach(UAVDataObject * obj, m_saveButton->getObjects()) {
+        if (obj && shouldObjectBeSaved(obj) && UAVObject::GetGcsAccess(obj->getMetadata()) != UAVObject::ACCESS_READONLY) {
+            objects.append(obj);
+        }
+    }
+    m_tuningStream->setObjects(objects);
+    m_tuningStream->start();
+    // Edits made before the start
+    m_tuningStream->schedule();
+}
+
 void ConfigTaskWidget::apply()
 {
     if (m_saveButton) {
@@ -833,57 +881,47 @@ void ConfigTaskWidget::defaultButtonClicked()
 
 void ConfigTaskWidget::reloadButtonClicked()
 {
-    if (m_realtimeUpdateTimer) {
-        return;
-    }
     int groupID = sender()->property("group").toInt();
     QList<WidgetBinding *> bindings = m_reloadGroups.values(groupID);
-    if (bindings.isEmpty()) {
-        return;
-    }
-    ObjectPersistence *objper = dynamic_cast<ObjectPersistence *>(getObjectManager()->getObject(ObjectPersistence::NAME));
-    m_realtimeUpdateTimer = new QTimer(this);
-    QEventLoop *eventLoop     = new QEventLoop(this);
-    connect(m_realtimeUpdateTimer, SIGNAL(timeout()), eventLoop, SLOT(quit()));
-    connect(objper, SIGNAL(objectUpdated(UAVObject *)), eventLoop, SLOT(quit()));
+    QList<UAVDataObject *> objects;
 
-    QList<ObjectComparator> temp;
     foreach(WidgetBinding * binding, bindings) {
-        if (binding->isEnabled() && binding->object()) {
-            ObjectComparator value;
-            value.objid     = binding->object()->getObjID();
-            value.objinstid = binding->object()->getInstID();
-            if (temp.contains(value)) {
-                continue;
-            } else {
-                temp.append(value);
-            }
-            ObjectPersistence::DataFields data;
-            data.Operation  = ObjectPersistence::OPERATION_LOAD;
-            data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
-            data.ObjectID   = binding->object()->getObjID();
-            data.InstanceID = binding->object()->getInstID();
-            objper->setData(data);
-            objper->updated();
-            m_realtimeUpdateTimer->start(500);
-            eventLoop->exec();
-            if (m_realtimeUpdateTimer->isActive()) {
-                binding->object()->requestUpdate();
-                if (binding->widget()) {
-                    setWidgetFromField(binding->widget(), binding->field(), binding);
-                }
-            }
-            m_realtimeUpdateTimer->stop();
+        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(binding->object());
+        if (binding->isEnabled() && obj && !objects.contains(obj)) {
+            objects.append(obj);
         }
     }
-    if (eventLoop) {
-        delete eventLoop;
-        eventLoop = NULL;
+    reloadObjects(objects);
+}
+
+bool ConfigTaskWidget::reloadObjects(const QList<UAVDataObject *> &objects)
+{
+    // Not while saving, the widgets are not refreshed then
+    if (objects.isEmpty() || !m_isWidgetUpdatesAllowed || (m_objectReloader && m_objectReloader->isBusy())) {
+        return false;
+    }
+    if (!m_objectReloader) {
+        m_objectReloader = new ObjectReloader(getObjectManager(), this);
+        connect(m_objectReloader, SIGNAL(finished(bool)), this, SLOT(reloadFinished()));
     }
-    if (m_realtimeUpdateTimer) {
-        delete m_realtimeUpdateTimer;
-        m_realtimeUpdateTimer = NULL;
+    m_reloadedObjects = objects;
+    disableObjectUpdates();
+    return m_objectReloader->reload(objects);
+}
+
+void ConfigTaskWidget::reloadFinished()
+{
+    QList<UAVObject *> failed = m_objectReloader->failedObjects();
+
+    enableObjectUpdates();
+    foreach(UAVDataObject * obj, m_reloadedObjects) {
+        if (failed.contains(obj)) {
+            qDebug() << "ConfigTaskWidget - could not reload" << obj->getName();
+        } else {
+            refreshWidgetsValues(obj);
+        }
     }
+    m_reloadedObjects.clear();
 }
 
 void ConfigTaskWidget::connectWidgetUpdatesToSlot(QWidget *widget, const char *function)
@@ -37,6 +37,7 @@ namespace ExtensionSystem {
 class PluginManager;
 }
 class UAVObject;
+class UAVDataObject;
 class UAVObjectField;
 class UAVObjectManager;
 class UAVObjectUtilManager;
@@ -96,6 +97,9 @@ private:
     QVariant m_value;
 };
 
+class TuningStream;
+class ObjectReloader;
+
 class UAVOBJECTWIDGETUTILS_EXPORT ConfigTaskWidget : public QWidget {
     Q_OBJECT
 
@@ -162,6 +166,17 @@ protected:
     void addHelpButton(QPushButton *button, QString url);
     void setWikiURL(QString url);
 
+    // Sends the objects changed in the widgets to the board, at most rate times a second
+    void startRealtimeUpdates(int rate);
+    void stopRealtimeUpdates();
+    bool isRealtimeUpdating() const
+    {
+        return m_realtimeUpdateRate > 0;
+    }
+
+    // Reverts the objects to the copy in the board flash, the widgets are refreshed once all are done
+    bool reloadObjects(const QList<UAVDataObject *> &objects);
+
 protected slots:
     void apply();
     void save();
@@ -210,18 +225,10 @@ private slots:
 
     void defaultButtonClicked();
     void reloadButtonClicked();
+    void reloadFinished();
     void helpButtonPressed();
 
 private:
-    struct ObjectComparator {
-        quint32 objid;
-        quint32 objinstid;
-        bool operator==(const ObjectComparator & lhs)
-        {
-            return lhs.objid == this->objid && lhs.objinstid == this->objinstid;
-        }
-    };
-
     enum ButtonTypeEnum { None, SaveButton, ApplyButton, ReloadButton, DefaultButton, HelpButton };
     struct BindingStruct {
         QString objectName;
@@ -266,7 +273,11 @@ private:
     QList<QPushButton *> m_reloadButtons;
 
     QString m_outOfLimitsStyle;
-    QTimer *m_realtimeUpdateTimer;
+    ObjectReloader *m_objectReloader;
+    QList<UAVDataObject *> m_reloadedObjects;
+
+    TuningStream *m_tuningStream;
+    int m_realtimeUpdateRate;
 
     bool setWidgetFromField(QWidget *widget, UAVObjectField *field, WidgetBinding *binding);
 
@@ -277,6 +288,7 @@ private:
     void disconnectWidgetUpdatesToSlot(QWidget *widget, const char *function);
 
     void resetLimits();
+    void startTuningStream();
 
     void loadWidgetLimits(QWidget *widget, UAVObjectField *field, int index, bool applyLimits, double scale);
 
@@ -0,0 +1,193 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectreloader.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectWidgetUtils Plugin
+ * @{
+ * @brief Reverts a set of objects to the copy saved in the board flash
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "objectreloader.h"
+
+#include "uavobjectmanager.h"
+#include "uavdataobject.h"
+#include "objectpersistence.h"
+
+#include <QDebug>
+
+ObjectReloader::ObjectReloader(UAVObjectManager *objMngr, QObject *parent) : QObject(parent),
+    m_loading(NULL),
+    m_loadAcked(false),
+    m_loadCompleted(false),
+    m_success(true)
+{
+    m_persistence = ObjectPersistence::GetInstance(objMngr);
+    Q_ASSERT(m_persistence);
+
+    // Started once the Load command is acked, after the telemetry retries
+    m_loadTimer.setSingleShot(true);
+    m_loadTimer.setInterval(DEFAULT_LOAD_TIMEOUT_MS);
+    connect(&m_loadTimer, SIGNAL(timeout()), this, SLOT(loadTimeout()));
+}
+
+ObjectReloader::~ObjectReloader()
+{}
+
+quint64 ObjectReloader::key(UAVObject *obj)
+{
+    return key(obj->getObjID(), obj->getInstID());
+}
+
+bool ObjectReloader::reload(const QList<UAVDataObject *> &objects)
+{
+    if (isBusy()) {
+        return false;
+    }
+    m_failed.clear();
+    m_success = true;
+    foreach(UAVDataObject * obj, objects) {
+        if (obj && !m_objects.contains(key(obj))) {
+            m_objects.insert(key(obj), obj);
+            m_loadQueue.append(obj);
+        }
+    }
+    if (m_objects.isEmpty()) {
+        emit finished(true);
+        return true;
+    }
+    connect(m_persistence, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(persistenceTransactionCompleted(UAVObject *, bool)));
+    connect(m_persistence, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(persistenceUnpacked(UAVObject *)));
+    loadNext();
+    return true;
+}
+
+void ObjectReloader::loadNext()
+{
+    m_loadTimer.stop();
+    m_loading = NULL;
+    if (m_loadQueue.isEmpty()) {
+        checkFinished();
+        return;
+    }
+    m_loading       = m_loadQueue.takeFirst();
+    m_loadAcked     = false;
+    m_loadCompleted = false;
+
+    ObjectPersistence::DataFields data;
+    data.Operation  = ObjectPersistence::OPERATION_LOAD;
+    data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
+    data.ObjectID   = m_loading->getObjID();
+    data.InstanceID = m_loading->getInstID();
+    m_persistence->setData(data);
+    m_persistence->updated();
+}
+
+/**
+ * The board acked the Load command, the next one is sent once it is also completed
+ */
+void ObjectReloader::persistenceTransactionCompleted(UAVObject *, bool success)
+{
+    if (!m_loading || m_loadAcked) {
+        return;
+    }
+    if (!success) {
+        if (!m_loadCompleted) {
+            done(m_loading, false);
+        }
+        loadNext();
+        return;
+    }
+    m_loadAcked = true;
+    if (m_loadCompleted) {
+        loadNext();
+    } else {
+        m_loadTimer.start();
+    }
+}
+
+/**
+ * The board reports the result of a Load command
+ */
+void ObjectReloader::persistenceUnpacked(UAVObject *)
+{
+    if (!m_loading || m_loadCompleted) {
+        return;
+    }
+    ObjectPersistence::DataFields data = m_persistence->getData();
+    if (key(data.ObjectID, data.InstanceID) != key(m_loading)) {
+        return;
+    }
+    if (data.Operation == ObjectPersistence::OPERATION_COMPLETED) {
+        // Fetch the loaded values while the next objects load
+        connect(m_loading, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(requestCompleted(UAVObject *, bool)));
+        m_loading->requestUpdate();
+    } else if (data.Operation == ObjectPersistence::OPERATION_ERROR) {
+        done(m_loading, false);
+    } else {
+        return;
+    }
+    m_loadCompleted = true;
+    if (m_loadAcked) {
+        loadNext();
+    }
+}
+
+void ObjectReloader::loadTimeout()
+{
+    // Only armed once acked, while the transaction is open its ack could still be credited to the next load
+    if (!m_loading || m_loadCompleted || !m_loadAcked) {
+        return;
+    }
+    qDebug() << "ObjectReloader - no load result for" << m_loading->getName();
+    done(m_loading, false);
+    loadNext();
+}
+
+void ObjectReloader::requestCompleted(UAVObject *obj, bool success)
+{
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(requestCompleted(UAVObject *, bool)));
+    done(obj, success);
+}
+
+void ObjectReloader::done(UAVObject *obj, bool success)
+{
+    if (!m_objects.remove(key(obj))) {
+        return;
+    }
+    if (!success) {
+        m_failed.append(obj);
+        m_success = false;
+    }
+    emit objectReloaded(obj, success);
+    checkFinished();
+}
+
+/**
+ * All objects are done and the ObjectPersistence object is free again
+ */
+void ObjectReloader::checkFinished()
+{
+    if (!m_objects.isEmpty() || m_loading) {
+        return;
+    }
+    m_persistence->disconnect(this);
+    emit finished(m_success);
+}
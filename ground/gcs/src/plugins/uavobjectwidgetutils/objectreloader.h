@@ -0,0 +1,117 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectreloader.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectWidgetUtils Plugin
+ * @{
+ * @brief Reverts a set of objects to the copy saved in the board flash
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OBJECTRELOADER_H
+#define OBJECTRELOADER_H
+
+#include "uavobjectwidgetutils_global.h"
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+
+class UAVObject;
+class UAVDataObject;
+class UAVObjectManager;
+class ObjectPersistence;
+
+/**
+ * Reloads objects from the board flash without waiting in an event loop.
+ *
+ * The board has a single ObjectPersistence object, so the Load commands
+ * go out one after the other: the next one is sent as soon as the board
+ * acked the previous one and reported it completed. The object requests
+ * that fetch the loaded values are not serialized, each one starts when
+ * its load completes and runs alongside the following loads.
+ * Completions are matched by object and instance ID.
+ */
+class UAVOBJECTWIDGETUTILS_EXPORT ObjectReloader : public QObject {
+    Q_OBJECT
+
+public:
+    ObjectReloader(UAVObjectManager *objMngr, QObject *parent = 0);
+    ~ObjectReloader();
+
+    // Longest wait for the board to report a load completed, once it acked the command
+    void setLoadTimeout(int ms)
+    {
+        m_loadTimer.setInterval(ms);
+    }
+
+    bool isBusy() const
+    {
+        return !m_objects.isEmpty() || m_loading;
+    }
+
+    // Objects that could not be reloaded by the last reload
+    QList<UAVObject *> failedObjects() const
+    {
+        return m_failed;
+    }
+
+public slots:
+    // Returns false if a reload is already running
+    bool reload(const QList<UAVDataObject *> &objects);
+
+signals:
+    void objectReloaded(UAVObject *obj, bool success);
+    void finished(bool success);
+
+private slots:
+    void persistenceTransactionCompleted(UAVObject *obj, bool success);
+    void persistenceUnpacked(UAVObject *obj);
+    void loadTimeout();
+    void requestCompleted(UAVObject *obj, bool success);
+
+private:
+    // Above the telemetry transaction timeout with its retries
+    static const int DEFAULT_LOAD_TIMEOUT_MS = 1000;
+
+    ObjectPersistence *m_persistence;
+    // All objects of the running reload, by object and instance ID
+    QHash<quint64, UAVDataObject *> m_objects;
+    QList<UAVDataObject *> m_loadQueue;
+    UAVDataObject *m_loading;
+    bool m_loadAcked;
+    bool m_loadCompleted;
+    QTimer m_loadTimer;
+    QList<UAVObject *> m_failed;
+    bool m_success;
+
+    static quint64 key(quint32 objId, quint32 instId)
+    {
+        return ((quint64)objId << 32) | instId;
+    }
+    static quint64 key(UAVObject *obj);
+
+    void loadNext();
+    void done(UAVObject *obj, bool success);
+    void checkFinished();
+};
+
+#endif // OBJECTRELOADER_H
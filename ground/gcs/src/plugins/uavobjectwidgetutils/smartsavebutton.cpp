@@ -158,6 +158,11 @@ void SmartSaveButton::setObjects(QList<UAVDataObject *> list)
     objects = list;
 }
 
+QList<UAVDataObject *> SmartSaveButton::getObjects()
+{
+    return objects;
+}
+
 void SmartSaveButton::addObject(UAVDataObject *obj)
 {
     Q_ASSERT(obj);
@@ -47,6 +47,7 @@ public:
 public:
     SmartSaveButton(ConfigTaskWidget *configTaskWidget);
     void setObjects(QList<UAVDataObject *>);
+    QList<UAVDataObject *> getObjects();
     void addObject(UAVDataObject *);
     void clearObjects();
     void removeObject(UAVDataObject *obj);
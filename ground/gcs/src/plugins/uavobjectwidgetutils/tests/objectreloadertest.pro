@@ -0,0 +1,18 @@
+#
+# Reloads objects from a stand-in board flash over a loopback UAVTalk link
+#
+
+include(../../../../gcs.pri)
+include(../../uavtalk/tests/uavtalktest.pri)
+
+TARGET = objectreloadertest
+
+DEFINES += UAVOBJECTWIDGETUTILS_LIBRARY
+
+INCLUDEPATH += $$PLUGINS_DIR/uavobjectwidgetutils
+
+HEADERS += $$PLUGINS_DIR/uavobjectwidgetutils/objectreloader.h
+
+SOURCES += \
+    tst_objectreloader.cpp \
+    $$PLUGINS_DIR/uavobjectwidgetutils/objectreloader.cpp
@@ -0,0 +1,347 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_objectreloader.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectWidgetUtils Plugin
+ * @{
+ * @brief Reloads objects from a stand-in board flash and times it against one object at a time
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavtalk.h"
+#include "telemetry.h"
+#include "loopbackdevice.h"
+#include "objectreloader.h"
+#include "gcstelemetrystats.h"
+#include "objectpersistence.h"
+#include "stabilizationsettings.h"
+#include "stabilizationsettingsbank1.h"
+#include "stabilizationsettingsbank2.h"
+#include "stabilizationsettingsbank3.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QIODevice>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+
+/**
+ * Flight side of ObjectPersistence: a Load command copies the flash copy of
+ * the object into it and answers Completed, or Error if it is not in flash.
+ */
+class FlightPersistence : public QObject {
+public:
+    FlightPersistence(UAVObjectManager *objMngr, UAVTalk *talk, int loadTime) :
+        m_objMngr(objMngr), m_talk(talk), m_loadTime(loadTime), m_loads(0)
+    {
+        m_persistence = ObjectPersistence::GetInstance(objMngr);
+        connect(m_persistence, &UAVObject::objectUnpacked, this, [this](UAVObject *) {
+            ObjectPersistence::DataFields data = m_persistence->getData();
+            if (data.Operation == ObjectPersistence::OPERATION_LOAD && !m_ignored.contains(data.ObjectID)) {
+                QTimer::singleShot(m_loadTime, this, [this, data]() {
+                    load(data);
+                });
+            }
+        });
+    }
+
+    void save(UAVObject *obj)
+    {
+        QByteArray data(obj->getNumBytes(), 0);
+
+        obj->pack((quint8 *)data.data());
+        m_flash.insert(obj->getObjID(), data);
+    }
+
+    void erase(UAVObject *obj)
+    {
+        m_flash.remove(obj->getObjID());
+    }
+
+    QByteArray flash(UAVObject *obj) const
+    {
+        return m_flash.value(obj->getObjID());
+    }
+
+    // Never answers Load commands for the object
+    void ignore(UAVObject *obj)
+    {
+        m_ignored.insert(obj->getObjID());
+    }
+
+    int loads() const
+    {
+        return m_loads;
+    }
+
+private:
+    UAVObjectManager *m_objMngr;
+    UAVTalk *m_talk;
+    ObjectPersistence *m_persistence;
+    int m_loadTime;
+    int m_loads;
+    QHash<quint32, QByteArray> m_flash;
+    QSet<quint32> m_ignored;
+
+    void load(ObjectPersistence::DataFields data)
+    {
+        UAVObject *obj = m_objMngr->getObject(data.ObjectID, data.InstanceID);
+
+        m_loads++;
+        if (obj && m_flash.contains(data.ObjectID)) {
+            obj->unpack((const quint8 *)m_flash.value(data.ObjectID).constData());
+            data.Operation = ObjectPersistence::OPERATION_COMPLETED;
+        } else {
+            data.Operation = ObjectPersistence::OPERATION_ERROR;
+        }
+        m_persistence->setData(data);
+        m_talk->sendObject(m_persistence, false, false);
+    }
+};
+
+class tst_ObjectReloader : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void reloadsFromFlash();
+    void reportsFailures();
+    void busy();
+    void timing();
+
+private:
+    static const int LINK_LATENCY = 10;
+    static const int LOAD_TIME    = 5;
+
+    LoopbackDevice *m_gcsDevice;
+    LoopbackDevice *m_boardDevice;
+    UAVObjectManager *m_gcsMngr;
+    UAVObjectManager *m_boardMngr;
+    UAVTalk *m_gcsTalk;
+    UAVTalk *m_boardTalk;
+    Telemetry *m_telemetry;
+    FlightPersistence *m_flight;
+    ObjectReloader *m_reloader;
+    QList<UAVDataObject *> m_objects;
+
+    void setKp(UAVObject *obj, double value);
+    bool sameAsFlash(UAVObject *obj);
+    bool reloadOneByOne(const QList<UAVDataObject *> &objects);
+};
+
+void tst_ObjectReloader::init()
+{
+    m_gcsDevice   = new LoopbackDevice(LINK_LATENCY);
+    m_boardDevice = new LoopbackDevice(LINK_LATENCY);
+    m_gcsDevice->setPeer(m_boardDevice);
+    m_boardDevice->setPeer(m_gcsDevice);
+
+    m_gcsMngr   = new UAVObjectManager();
+    UAVObjectsInitialize(m_gcsMngr);
+    m_boardMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_boardMngr);
+
+    m_gcsTalk   = new UAVTalk(m_gcsDevice, m_gcsMngr);
+    m_boardTalk = new UAVTalk(m_boardDevice, m_boardMngr);
+    m_telemetry = new Telemetry(m_gcsTalk, m_gcsMngr);
+    connect(m_gcsDevice, SIGNAL(readyRead()), m_gcsTalk, SLOT(processInputStream()));
+    connect(m_boardDevice, SIGNAL(readyRead()), m_boardTalk, SLOT(processInputStream()));
+
+    GCSTelemetryStats *gcsStats = GCSTelemetryStats::GetInstance(m_gcsMngr);
+    GCSTelemetryStats::DataFields stats = gcsStats->getData();
+    stats.Status = GCSTelemetryStats::STATUS_CONNECTED;
+    gcsStats->setData(stats);
+
+    m_objects.clear();
+    m_objects << StabilizationSettingsBank1::GetInstance(m_gcsMngr)
+              << StabilizationSettingsBank2::GetInstance(m_gcsMngr)
+              << StabilizationSettingsBank3::GetInstance(m_gcsMngr)
+              << StabilizationSettings::GetInstance(m_gcsMngr);
+
+    // Saved values in flash, other ones in the board RAM and in the GCS
+    m_flight = new FlightPersistence(m_boardMngr, m_boardTalk, LOAD_TIME);
+    for (int i = 0; i < m_objects.length(); i++) {
+        UAVObject *boardObj = m_boardMngr->getObject(m_objects[i]->getObjID());
+        setKp(boardObj, 0.001 * (i + 1));
+        m_flight->save(boardObj);
+        setKp(boardObj, 0.1);
+        setKp(m_objects[i], 0.2);
+    }
+
+    m_reloader = new ObjectReloader(m_gcsMngr);
+}
+
+void tst_ObjectReloader::cleanup()
+{
+    delete m_reloader;
+    delete m_flight;
+    delete m_telemetry;
+    delete m_gcsTalk;
+    delete m_boardTalk;
+    delete m_gcsMngr;
+    delete m_boardMngr;
+    delete m_gcsDevice;
+    delete m_boardDevice;
+}
+
+void tst_ObjectReloader::setKp(UAVObject *obj, double value)
+{
+    if (obj->getField("RollRatePID")) {
+        obj->getField("RollRatePID")->setDouble(value, 0);
+    } else {
+        obj->getField("VbarRollPI")->setDouble(value, 0);
+    }
+}
+
+bool tst_ObjectReloader::sameAsFlash(UAVObject *obj)
+{
+    QByteArray data(obj->getNumBytes(), 0);
+
+    obj->pack((quint8 *)data.data());
+    return data == m_flight->flash(obj);
+}
+
+/**
+ * Load, wait for the result, request, wait for the values, for each object in turn
+ */
+bool tst_ObjectReloader::reloadOneByOne(const QList<UAVDataObject *> &objects)
+{
+    ObjectPersistence *persistence = ObjectPersistence::GetInstance(m_gcsMngr);
+    bool success = true;
+    QEventLoop eventLoop;
+    QTimer timer;
+
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), &eventLoop, SLOT(quit()));
+    connect(persistence, SIGNAL(objectUnpacked(UAVObject *)), &eventLoop, SLOT(quit()));
+    foreach(UAVDataObject * obj, objects) {
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), &eventLoop, SLOT(quit()));
+    }
+
+    foreach(UAVDataObject * obj, objects) {
+        ObjectPersistence::DataFields data;
+        data.Operation  = ObjectPersistence::OPERATION_LOAD;
+        data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
+        data.ObjectID   = obj->getObjID();
+        data.InstanceID = obj->getInstID();
+        persistence->setData(data);
+        persistence->updated();
+        timer.start(500);
+        eventLoop.exec();
+        // Wait for the ack too, the next Load would be dropped
+        QTest::qWait(2 * LINK_LATENCY);
+        obj->requestUpdate();
+        timer.start(500);
+        eventLoop.exec();
+        success &= timer.isActive();
+    }
+    return success;
+}
+
+void tst_ObjectReloader::reloadsFromFlash()
+{
+    QSignalSpy reloaded(m_reloader, SIGNAL(objectReloaded(UAVObject *, bool)));
+    QSignalSpy finished(m_reloader, SIGNAL(finished(bool)));
+
+    QVERIFY(m_reloader->reload(m_objects));
+    QTRY_COMPARE(finished.count(), 1);
+
+    QCOMPARE(finished.at(0).at(0).toBool(), true);
+    QCOMPARE(reloaded.count(), m_objects.length());
+    for (int i = 0; i < reloaded.count(); i++) {
+        QCOMPARE(reloaded.at(i).at(1).toBool(), true);
+    }
+    QVERIFY(m_reloader->failedObjects().isEmpty());
+    QVERIFY(!m_reloader->isBusy());
+    QCOMPARE(m_flight->loads(), m_objects.length());
+    foreach(UAVDataObject * obj, m_objects) {
+        QVERIFY(sameAsFlash(obj));
+    }
+}
+
+void tst_ObjectReloader::reportsFailures()
+{
+    QSignalSpy finished(m_reloader, SIGNAL(finished(bool)));
+
+    // One the board does not answer for, one that was never saved
+    m_flight->ignore(m_objects[1]);
+    m_flight->erase(m_boardMngr->getObject(m_objects[2]->getObjID()));
+    m_reloader->setLoadTimeout(200);
+
+    QVERIFY(m_reloader->reload(m_objects));
+    QTRY_COMPARE(finished.count(), 1);
+
+    QCOMPARE(finished.at(0).at(0).toBool(), false);
+    QCOMPARE(m_reloader->failedObjects().length(), 2);
+    QVERIFY(m_reloader->failedObjects().contains(m_objects[1]));
+    QVERIFY(m_reloader->failedObjects().contains(m_objects[2]));
+    // The others are reloaded all the same
+    QVERIFY(sameAsFlash(m_objects[0]));
+    QVERIFY(sameAsFlash(m_objects[3]));
+    QVERIFY(!sameAsFlash(m_objects[1]));
+}
+
+void tst_ObjectReloader::busy()
+{
+    QSignalSpy finished(m_reloader, SIGNAL(finished(bool)));
+
+    QVERIFY(m_reloader->reload(m_objects.mid(0, 2)));
+    QVERIFY(m_reloader->isBusy());
+    QVERIFY(!m_reloader->reload(m_objects));
+    QTRY_COMPARE(finished.count(), 1);
+
+    QCOMPARE(m_flight->loads(), 2);
+    QVERIFY(m_reloader->reload(m_objects.mid(2)));
+    QTRY_COMPARE(finished.count(), 2);
+}
+
+void tst_ObjectReloader::timing()
+{
+    QSignalSpy finished(m_reloader, SIGNAL(finished(bool)));
+    QElapsedTimer timer;
+
+    timer.start();
+    QVERIFY(reloadOneByOne(m_objects));
+    qint64 oneByOneMs = timer.elapsed();
+    foreach(UAVDataObject * obj, m_objects) {
+        QVERIFY(sameAsFlash(obj));
+        setKp(obj, 0.2);
+    }
+
+    timer.start();
+    QVERIFY(m_reloader->reload(m_objects));
+    QTRY_COMPARE(finished.count(), 1);
+    qint64 reloaderMs = timer.elapsed();
+    foreach(UAVDataObject * obj, m_objects) {
+        QVERIFY(sameAsFlash(obj));
+    }
+
+    qDebug("%d objects, %d ms link latency, %d ms flash load", m_objects.length(), LINK_LATENCY, LOAD_TIME);
+    qDebug("one by one %lld ms, reloader %lld ms", oneByOneMs, reloaderMs);
+    QVERIFY(reloaderMs < oneByOneMs);
+}
+
+QTEST_GUILESS_MAIN(tst_ObjectReloader)
+
+#include "tst_objectreloader.moc"
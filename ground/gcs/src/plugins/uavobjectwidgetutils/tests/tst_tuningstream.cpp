@@ -0,0 +1,279 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_tuningstream.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectWidgetUtils Plugin
+ * @{
+ * @brief Streams settings changes to a loopback board and counts the updates on the wire
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavtalk.h"
+#include "telemetry.h"
+#include "loopbackdevice.h"
+#include "tuningstream.h"
+#include "gcstelemetrystats.h"
+#include "stabilizationsettings.h"
+#include "stabilizationsettingsbank1.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QIODevice>
+#include <QtCore/QElapsedTimer>
+
+class tst_TuningStream : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void unchangedSendsNothing();
+    void onlyChangedObjects();
+    void coalescesBurst();
+    void changedWhileInFlight();
+    void boardUpdateIsBaseline();
+    void stopsRetrying();
+
+private:
+    static const int RATE = 20;
+
+    LoopbackDevice *m_gcsDevice;
+    LoopbackDevice *m_boardDevice;
+    UAVObjectManager *m_gcsMngr;
+    UAVObjectManager *m_boardMngr;
+    UAVTalk *m_gcsTalk;
+    UAVTalk *m_boardTalk;
+    Telemetry *m_telemetry;
+    TuningStream *m_stream;
+
+    StabilizationSettingsBank1 *m_bank;
+    StabilizationSettings *m_settings;
+    QHash<quint32, int> m_received;
+    quint32 m_receivedBytes;
+
+    void objectReceived(UAVObject *obj);
+    bool sameOnBoard(UAVObject *obj);
+    void setRollKp(double value);
+};
+
+void tst_TuningStream::init()
+{
+    m_gcsDevice   = new LoopbackDevice();
+    m_boardDevice = new LoopbackDevice();
+    m_gcsDevice->setPeer(m_boardDevice);
+    m_boardDevice->setPeer(m_gcsDevice);
+
+    m_gcsMngr   = new UAVObjectManager();
+    UAVObjectsInitialize(m_gcsMngr);
+    m_boardMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_boardMngr);
+
+    // The board side acks the updates by itself
+    m_gcsTalk   = new UAVTalk(m_gcsDevice, m_gcsMngr);
+    m_boardTalk = new UAVTalk(m_boardDevice, m_boardMngr);
+    m_telemetry = new Telemetry(m_gcsTalk, m_gcsMngr);
+    connect(m_gcsDevice, SIGNAL(readyRead()), m_gcsTalk, SLOT(processInputStream()));
+    connect(m_boardDevice, SIGNAL(readyRead()), m_boardTalk, SLOT(processInputStream()));
+
+    // Only the handshake objects are sent while disconnected
+    GCSTelemetryStats *gcsStats = GCSTelemetryStats::GetInstance(m_gcsMngr);
+    GCSTelemetryStats::DataFields stats = gcsStats->getData();
+    stats.Status = GCSTelemetryStats::STATUS_CONNECTED;
+    gcsStats->setData(stats);
+
+    m_received.clear();
+    m_receivedBytes = 0;
+    foreach(UAVObject * obj, QList<UAVObject *>()
+            << StabilizationSettingsBank1::GetInstance(m_boardMngr)
+            << StabilizationSettings::GetInstance(m_boardMngr)) {
+        connect(obj, &UAVObject::objectUnpacked, this, &tst_TuningStream::objectReceived);
+    }
+
+    m_bank     = StabilizationSettingsBank1::GetInstance(m_gcsMngr);
+    m_settings = StabilizationSettings::GetInstance(m_gcsMngr);
+    m_stream   = new TuningStream();
+    m_stream->setRate(RATE);
+    m_stream->setObjects(QList<UAVDataObject *>() << m_bank << m_settings);
+    m_stream->start();
+}
+
+void tst_TuningStream::cleanup()
+{
+    delete m_stream;
+    delete m_telemetry;
+    delete m_gcsTalk;
+    delete m_boardTalk;
+    delete m_gcsMngr;
+    delete m_boardMngr;
+    delete m_gcsDevice;
+    delete m_boardDevice;
+}
+
+void tst_TuningStream::objectReceived(UAVObject *obj)
+{
+    m_received[obj->getObjID()]++;
+    // sync, type, size, object ID, instance ID, data, CRC
+    m_receivedBytes += 10 + obj->getNumBytes() + 1;
+}
+
+bool tst_TuningStream::sameOnBoard(UAVObject *obj)
+{
+    UAVObject *boardObj = m_boardMngr->getObject(obj->getObjID());
+    QByteArray data(obj->getNumBytes(), 0);
+    QByteArray boardData(obj->getNumBytes(), 0);
+
+    obj->pack((quint8 *)data.data());
+    boardObj->pack((quint8 *)boardData.data());
+    return data == boardData;
+}
+
+void tst_TuningStream::setRollKp(double value)
+{
+    m_bank->getField("RollRatePID")->setDouble(value, 0);
+}
+
+void tst_TuningStream::unchangedSendsNothing()
+{
+    for (int i = 0; i < 5; i++) {
+        m_stream->schedule();
+        QTest::qWait(1000 / RATE);
+    }
+    QTest::qWait(100);
+
+    QCOMPARE(m_stream->sentUpdates(), (quint32)0);
+    QCOMPARE(m_received.size(), 0);
+}
+
+void tst_TuningStream::onlyChangedObjects()
+{
+    setRollKp(0.005);
+    m_stream->schedule();
+
+    QTRY_COMPARE(m_received.value(m_bank->getObjID()), 1);
+    QTest::qWait(100);
+
+    QCOMPARE(m_stream->sentUpdates(), (quint32)1);
+    QCOMPARE(m_received.value(m_settings->getObjID()), 0);
+    QVERIFY(sameOnBoard(m_bank));
+}
+
+void tst_TuningStream::coalescesBurst()
+{
+    const int changes = 100;
+    QElapsedTimer timer;
+
+    // A slider dragged for about half a second
+    timer.start();
+    for (int i = 0; i < changes; i++) {
+        setRollKp(0.001 + i * 0.0001);
+        m_stream->schedule();
+        QTest::qWait(5);
+    }
+    qint64 duration = timer.elapsed();
+
+    QTRY_VERIFY(sameOnBoard(m_bank));
+    QTest::qWait(100);
+
+    int updates = m_received.value(m_bank->getObjID());
+    QVERIFY(updates >= 2);
+    QVERIFY(updates <= duration * RATE / 1000 + 2);
+    QCOMPARE((quint32)updates, m_stream->sentUpdates());
+    QCOMPARE(m_received.value(m_settings->getObjID()), 0);
+
+    // Uploading every object at the same rate, or at each change
+    quint32 allObjectsBytes = 2 * 11 + m_bank->getNumBytes() + m_settings->getNumBytes();
+    qDebug("%d changes in %lld ms, %d updates, %u bytes", changes, duration, updates, m_receivedBytes);
+    qDebug("all objects at the same rate %u bytes, at each change %u bytes",
+           (quint32)(duration * RATE / 1000) * allObjectsBytes, changes * allObjectsBytes);
+}
+
+void tst_TuningStream::changedWhileInFlight()
+{
+    UAVObject *boardBank = m_boardMngr->getObject(m_bank->getObjID());
+    bool changed = false;
+
+    // Changed again once the board has the first update, before the ack is back
+    connect(boardBank, &UAVObject::objectUnpacked, this, [this, &changed](UAVObject *) {
+        if (!changed) {
+            changed = true;
+            setRollKp(0.007);
+            m_stream->schedule();
+        }
+    });
+
+    setRollKp(0.006);
+    m_stream->schedule();
+
+    QTRY_COMPARE(m_received.value(m_bank->getObjID()), 2);
+    QTest::qWait(100);
+
+    QCOMPARE(m_stream->sentUpdates(), (quint32)2);
+    QVERIFY(sameOnBoard(m_bank));
+    boardBank->disconnect(this);
+}
+
+void tst_TuningStream::boardUpdateIsBaseline()
+{
+    UAVObject *boardBank = m_boardMngr->getObject(m_bank->getObjID());
+
+    // The board copy changed, e.g. another bank was loaded
+    boardBank->getField("RollRatePID")->setDouble(0.008, 0);
+    QVERIFY(m_boardTalk->sendObject(boardBank, false, false));
+
+    QTRY_VERIFY(sameOnBoard(m_bank));
+    m_stream->schedule();
+    QTest::qWait(100);
+
+    QCOMPARE(m_stream->sentUpdates(), (quint32)0);
+    QCOMPARE(m_received.size(), 0);
+}
+
+void tst_TuningStream::stopsRetrying()
+{
+    QSignalSpy failed(m_stream, SIGNAL(sendFailed(UAVObject *)));
+
+    // The board is gone, no update is acknowledged
+    disconnect(m_boardDevice, SIGNAL(readyRead()), m_boardTalk, SLOT(processInputStream()));
+    setRollKp(0.009);
+    m_stream->schedule();
+
+    QTRY_COMPARE_WITH_TIMEOUT(failed.count(), 1, 10000);
+    QCOMPARE(failed.first().at(0).value<UAVObject *>(), (UAVObject *)m_bank);
+    QCOMPARE(m_stream->sentUpdates(), (quint32)TuningStream::MAX_RETRIES + 1);
+
+    // No more attempts, nor failures, while nothing is edited
+    QTest::qWait(1500);
+    QCOMPARE(m_stream->sentUpdates(), (quint32)TuningStream::MAX_RETRIES + 1);
+    QCOMPARE(failed.count(), 1);
+
+    // The next change resumes the object
+    connect(m_boardDevice, SIGNAL(readyRead()), m_boardTalk, SLOT(processInputStream()));
+    setRollKp(0.010);
+    m_stream->schedule();
+    QTRY_VERIFY(sameOnBoard(m_bank));
+    QCOMPARE(failed.count(), 1);
+}
+
+QTEST_GUILESS_MAIN(tst_TuningStream)
+
+#include "tst_tuningstream.moc"
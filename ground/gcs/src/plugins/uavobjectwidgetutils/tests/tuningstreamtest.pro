@@ -0,0 +1,18 @@
+#
+# Streams settings changes over a loopback UAVTalk link and counts what goes on the wire
+#
+
+include(../../../../gcs.pri)
+include(../../uavtalk/tests/uavtalktest.pri)
+
+TARGET = tuningstreamtest
+
+DEFINES += UAVOBJECTWIDGETUTILS_LIBRARY
+
+INCLUDEPATH += $$PLUGINS_DIR/uavobjectwidgetutils
+
+HEADERS += $$PLUGINS_DIR/uavobjectwidgetutils/tuningstream.h
+
+SOURCES += \
+    tst_tuningstream.cpp \
+    $$PLUGINS_DIR/uavobjectwidgetutils/tuningstream.cpp
@@ -0,0 +1,205 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tuningstream.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectWidgetUtils Plugin
+ * @{
+ * @brief Sends the settings changed while they are edited, without blocking
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "tuningstream.h"
+
+#include "uavdataobject.h"
+
+#include <QDebug>
+
+TuningStream::TuningStream(QObject *parent) : QObject(parent),
+    m_rate(20),
+    m_active(false),
+    m_sentUpdates(0)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(send()));
+}
+
+TuningStream::~TuningStream()
+{
+    stop();
+}
+
+void TuningStream::setObjects(const QList<UAVDataObject *> &objects)
+{
+    bool active = m_active;
+
+    stop();
+    m_objects = objects;
+    if (active) {
+        start();
+    }
+}
+
+void TuningStream::setRate(int rate)
+{
+    m_rate = qMax(rate, 1);
+}
+
+void TuningStream::start()
+{
+    if (m_active) {
+        return;
+    }
+    m_entries.clear();
+    foreach(UAVDataObject * obj, m_objects) {
+        Entry entry;
+        entry.acked    = pack(obj);
+        entry.inFlight = false;
+        entry.failures = 0;
+        entry.failed   = false;
+        m_entries.insert(obj, entry);
+    }
+    m_sentUpdates = 0;
+    m_active = true;
+    m_lastSend.invalidate();
+    connectObjects();
+}
+
+void TuningStream::stop()
+{
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+    m_timer.stop();
+    disconnectObjects();
+    m_entries.clear();
+}
+
+void TuningStream::schedule()
+{
+    if (!m_active) {
+        return;
+    }
+    for (QHash<UAVObject *, Entry>::iterator i = m_entries.begin(); i != m_entries.end(); ++i) {
+        i->failures = 0;
+        i->failed   = false;
+    }
+    scheduleSend();
+}
+
+/**
+ * Send the changes at the next tick, further calls until then are coalesced
+ */
+void TuningStream::scheduleSend()
+{
+    if (!m_active || m_timer.isActive()) {
+        return;
+    }
+    int interval = 1000 / m_rate;
+    int elapsed  = m_lastSend.isValid() ? (int)qMin<qint64>(m_lastSend.elapsed(), interval) : interval;
+    m_timer.start(interval - elapsed);
+}
+
+void TuningStream::send()
+{
+    if (!m_active) {
+        return;
+    }
+    m_lastSend.start();
+
+    emit aboutToSend();
+
+    foreach(UAVDataObject * obj, m_objects) {
+        Entry &entry = m_entries[obj];
+        // Sent again once acknowledged, if it still differs
+        if (entry.inFlight || entry.failed) {
+            continue;
+        }
+        QByteArray data = pack(obj);
+        if (data == entry.acked) {
+            continue;
+        }
+        entry.sent     = data;
+        entry.inFlight = true;
+        m_sentUpdates++;
+        obj->updated();
+    }
+}
+
+void TuningStream::transactionCompleted(UAVObject *obj, bool success)
+{
+    if (!m_entries.contains(obj)) {
+        return;
+    }
+    Entry &entry = m_entries[obj];
+    if (!entry.inFlight) {
+        return;
+    }
+    entry.inFlight = false;
+    if (success) {
+        entry.acked    = entry.sent;
+        entry.failures = 0;
+    } else if (++entry.failures > MAX_RETRIES) {
+        qWarning() << "TuningStream - update of" << obj->getName() << "failed" << entry.failures << "times, stopped";
+        entry.failed = true;
+        emit sendFailed(obj);
+        return;
+    } else {
+        qDebug() << "TuningStream - update of" << obj->getName() << "failed, retrying";
+    }
+    // Changed while in flight, or to retry
+    if (pack(obj) != entry.acked) {
+        scheduleSend();
+    }
+}
+
+/**
+ * The board sent the object, this is its copy now
+ */
+void TuningStream::objectUnpacked(UAVObject *obj)
+{
+    if (m_entries.contains(obj)) {
+        m_entries[obj].acked = pack(obj);
+    }
+}
+
+QByteArray TuningStream::pack(UAVObject *obj)
+{
+    QByteArray data(obj->getNumBytes(), 0);
+
+    obj->pack((quint8 *)data.data());
+    return data;
+}
+
+void TuningStream::connectObjects()
+{
+    foreach(UAVDataObject * obj, m_objects) {
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)), Qt::UniqueConnection);
+        connect(obj, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(objectUnpacked(UAVObject *)), Qt::UniqueConnection);
+    }
+}
+
+void TuningStream::disconnectObjects()
+{
+    foreach(UAVDataObject * obj, m_objects) {
+        disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+        disconnect(obj, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(objectUnpacked(UAVObject *)));
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tuningstream.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectWidgetUtils Plugin
+ * @{
+ * @brief Sends the settings changed while they are edited, without blocking
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TUNINGSTREAM_H
+#define TUNINGSTREAM_H
+
+#include "uavobjectwidgetutils_global.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class UAVObject;
+class UAVDataObject;
+
+/**
+ * Keeps the board copy of a set of objects in sync while they are edited.
+ *
+ * Changes are coalesced: schedule() asks for a send, which happens at most
+ * rate() times a second. A send packs each object and compares it with the
+ * last copy the board acknowledged, only the objects that differ go out and
+ * an object is never sent again before its previous update is acknowledged.
+ * Nothing waits for the board, acknowledgements arrive as signals.
+ *
+ * A failed update is retried MAX_RETRIES times, then the object is left out
+ * and sendFailed() emitted, until the next schedule().
+ */
+class UAVOBJECTWIDGETUTILS_EXPORT TuningStream : public QObject {
+    Q_OBJECT
+
+public:
+    static const int MAX_RETRIES = 2;
+
+    TuningStream(QObject *parent = 0);
+    ~TuningStream();
+
+    void setObjects(const QList<UAVDataObject *> &objects);
+
+    // Sends per second
+    void setRate(int rate);
+    int rate() const
+    {
+        return m_rate;
+    }
+
+    bool isActive() const
+    {
+        return m_active;
+    }
+
+    // Object updates sent since started
+    quint32 sentUpdates() const
+    {
+        return m_sentUpdates;
+    }
+
+public slots:
+    // The current data of the objects is taken as the board copy
+    void start();
+    void stop();
+    // The edited values changed, this also resumes the objects that failed
+    void schedule();
+
+signals:
+    // Time to copy the edited values into the objects
+    void aboutToSend();
+    // The update of the object failed after the retries
+    void sendFailed(UAVObject *obj);
+
+private slots:
+    void send();
+    void transactionCompleted(UAVObject *obj, bool success);
+    void objectUnpacked(UAVObject *obj);
+
+private:
+    struct Entry {
+        // last data acknowledged or sent by the board
+        QByteArray acked;
+        // data of the update in flight
+        QByteArray sent;
+        bool inFlight;
+        // failed updates in a row
+        int failures;
+        // not sent until the next schedule()
+        bool failed;
+    };
+
+    QList<UAVDataObject *> m_objects;
+    QHash<UAVObject *, Entry> m_entries;
+    QTimer m_timer;
+    QElapsedTimer m_lastSend;
+    int m_rate;
+    bool m_active;
+    quint32 m_sentUpdates;
+
+    static QByteArray pack(UAVObject *obj);
+    void scheduleSend();
+    void connectObjects();
+    void disconnectObjects();
+};
+
+#endif // TUNINGSTREAM_H
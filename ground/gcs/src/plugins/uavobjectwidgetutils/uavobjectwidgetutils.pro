@@ -16,6 +16,8 @@ HEADERS += \
     mixercurvepoint.h \
     mixercurveline.h \
     smartsavebutton.h \
+    tuningstream.h \
+    objectreloader.h \
     popupwidget.h
 
 SOURCES += \
@@ -25,6 +27,8 @@ SOURCES += \
     mixercurvepoint.cpp \
     mixercurveline.cpp \
     smartsavebutton.cpp \
+    tuningstream.cpp \
+    objectreloader.cpp \
     popupwidget.cpp
 
 RESOURCES += uavobjectwidgetutils.qrc
@@ -0,0 +1,160 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectcache.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Last known settings and metadata of a board, kept on disk between connections
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "objectcache.h"
+
+#include "uavobjectmanager.h"
+#include "firmwareiapobj.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+ObjectCache::ObjectCache(const QString &directory) :
+    m_directory(directory),
+    m_changed(false)
+{}
+
+QString ObjectCache::boardKey(FirmwareIAPObj *firmwareIAPObj)
+{
+    FirmwareIAPObj::DataFields firmware = firmwareIAPObj->getData();
+    QByteArray serial((const char *)firmware.CPUSerial, FirmwareIAPObj::CPUSERIAL_NUMELEM);
+
+    if (serial.count('\0') == serial.size()) {
+        return QString();
+    }
+    // Same layout as the board description read by UAVObjectUtilManager
+    QByteArray uavoHash((const char *)firmware.Description + 60, 20);
+    return QString::fromLatin1(serial.toHex() + "-" + uavoHash.toHex());
+}
+
+QString ObjectCache::fileName() const
+{
+    return QDir(m_directory).filePath(m_boardKey + ".cache");
+}
+
+bool ObjectCache::load(const QString &boardKey)
+{
+    m_boardKey = boardKey;
+    m_entries.clear();
+    m_changed  = false;
+
+    QFile file(fileName());
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION) {
+        return false;
+    }
+    for (quint32 i = 0; i < count; i++) {
+        quint32 objId;
+        quint32 instId;
+        QByteArray data;
+        stream >> objId >> instId >> data;
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "ObjectCache - ignoring corrupt cache" << file.fileName();
+            m_entries.clear();
+            return false;
+        }
+        m_entries.insert(key(objId, instId), data);
+    }
+    return true;
+}
+
+bool ObjectCache::save()
+{
+    if (!m_changed || m_boardKey.isEmpty()) {
+        return true;
+    }
+
+    QDir().mkpath(m_directory);
+    QSaveFile file(fileName());
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "ObjectCache - could not write" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << MAGIC << VERSION << (quint32)m_entries.size();
+    for (QHash<quint64, QByteArray>::const_iterator it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        stream << (quint32)(it.key() >> 32) << (quint32)it.key() << it.value();
+    }
+    if (!file.commit()) {
+        qWarning() << "ObjectCache - could not write" << file.fileName() << file.errorString();
+        return false;
+    }
+    m_changed = false;
+    return true;
+}
+
+int ObjectCache::apply(UAVObjectManager *objMngr)
+{
+    int applied = 0;
+    QMutableHashIterator<quint64, QByteArray> it(m_entries);
+
+    while (it.hasNext()) {
+        it.next();
+        UAVObject *obj = objMngr->getObject((quint32)(it.key() >> 32), (quint32)it.key());
+        if (!obj || (quint32)it.value().size() != obj->getNumBytes()) {
+            it.remove();
+            m_changed = true;
+            continue;
+        }
+        obj->unpack((const quint8 *)it.value().constData());
+        applied++;
+    }
+    return applied;
+}
+
+bool ObjectCache::update(UAVObject *obj)
+{
+    QByteArray data(obj->getNumBytes(), 0);
+
+    obj->pack((quint8 *)data.data());
+    QByteArray &entry = m_entries[key(obj->getObjID(), obj->getInstID())];
+    if (entry == data) {
+        return false;
+    }
+    entry     = data;
+    m_changed = true;
+    return true;
+}
+
+void ObjectCache::remove(UAVObject *obj)
+{
+    m_changed |= m_entries.remove(key(obj->getObjID(), obj->getInstID())) > 0;
+}
@@ -0,0 +1,85 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectcache.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Last known settings and metadata of a board, kept on disk between connections
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OBJECTCACHE_H
+#define OBJECTCACHE_H
+
+#include "uavtalk_global.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+class UAVObject;
+class UAVObjectManager;
+class FirmwareIAPObj;
+
+/**
+ * One file per board, named after its CPU serial and the UAVO hash of its firmware.
+ * Entries are keyed by object and instance id, an object id is a hash of the object
+ * definition so an entry is never unpacked into a different object.
+ */
+class UAVTALK_EXPORT ObjectCache {
+public:
+    ObjectCache(const QString &directory);
+
+    // Empty if the board did not report a serial
+    static QString boardKey(FirmwareIAPObj *firmwareIAPObj);
+
+    // Replaces the entries with those of the board, false if there are none
+    bool load(const QString &boardKey);
+    bool save();
+
+    int size() const
+    {
+        return m_entries.size();
+    }
+
+    // Unpacks the entries into their objects, returns how many
+    int apply(UAVObjectManager *objMngr);
+
+    // Records the current data of the object, true if it differs from the entry
+    bool update(UAVObject *obj);
+    void remove(UAVObject *obj);
+
+private:
+    static const quint32 MAGIC   = 0x55414f43; // "UAOC"
+    static const quint32 VERSION = 1;
+
+    QString m_directory;
+    QString m_boardKey;
+    QHash<quint64, QByteArray> m_entries;
+    bool m_changed;
+
+    QString fileName() const;
+    static quint64 key(quint32 objId, quint32 instId)
+    {
+        return ((quint64)objId << 32) | instId;
+    }
+};
+
+#endif // OBJECTCACHE_H
@@ -69,6 +69,18 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
     connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
     updateTimer->start(1000);
 
+    // Transaction records are allocated once and reused, a single timer checks their timeouts
+    openTransactions.reserve(INITIAL_TRANSACTIONS);
+    freeTransactions.reserve(INITIAL_TRANSACTIONS);
+    for (int i = 0; i < INITIAL_TRANSACTIONS; ++i) {
+        freeTransactions.append(new ObjectTransactionInfo());
+    }
+    transactionTimerIdleTicks = 0;
+    transactionTimer = new QTimer(this);
+    connect(transactionTimer, SIGNAL(timeout()), this, SLOT(checkTransactionTimeouts()));
+    transactionTimer->setInterval(TRANSACTION_CHECK_PERIOD_MS);
+    transactionClock.start();
+
     // Setup and start the stats timer
     txErrors  = 0;
     txRetries = 0;
@@ -77,6 +89,7 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
 Telemetry::~Telemetry()
 {
     closeAllTransactions();
+    qDeleteAll(freeTransactions);
     foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
         foreach(UAVObject * object, instances) {
             // make sure we 'forget' all objects before we request it from the flight side
@@ -150,6 +163,13 @@ void Telemetry::connectToObjectInstances(UAVObject *obj, quint32 eventMask)
  */
 void Telemetry::connectToObject(UAVObject *obj, quint32 eventMask)
 {
+    // This is called for each processed event, reconnecting is only needed when the mask changes
+    QHash<UAVObject *, quint32>::iterator it = connectedEventMasks.find(obj);
+    if (it != connectedEventMasks.end() && it.value() == eventMask) {
+        return;
+    }
+    connectedEventMasks.insert(obj, eventMask);
+
     // Disconnect all
     obj->disconnect(this);
     // Connect only the selected events
@@ -269,7 +289,41 @@ void Telemetry::transactionCompleted(UAVObject *obj, bool success)
 }
 
 /**
- * Called when a transaction is not completed within the timeout period (timer event)
+ * Called periodically while transactions are pending, times out the expired ones
+ */
+void Telemetry::checkTransactionTimeouts()
+{
+    QMutexLocker locker(mutex);
+
+    qint64 now   = transactionClock.elapsed();
+    bool pending = false;
+
+    int i = 0;
+    while (i < openTransactions.size()) {
+        ObjectTransactionInfo *transInfo = openTransactions.at(i);
+        if (transInfo->timeoutMs != 0 && transInfo->timeoutMs <= now) {
+            transInfo->timeoutMs = 0;
+            transactionTimeout(transInfo);
+            // The transaction was retried or closed, the table may have changed
+            i = 0;
+            continue;
+        }
+        if (transInfo->timeoutMs != 0) {
+            pending = true;
+        }
+        ++i;
+    }
+
+    // Keep the timer running for a while, restarting it is not free
+    if (pending) {
+        transactionTimerIdleTicks = 0;
+    } else if (++transactionTimerIdleTicks >= TRANSACTION_TIMER_IDLE_TICKS) {
+        transactionTimer->stop();
+    }
+}
+
+/**
+ * Called when a transaction is not completed within the timeout period
  */
 void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
 {
@@ -326,7 +380,11 @@ void Telemetry::processObjectTransaction(ObjectTransactionInfo *transInfo)
     if (transInfo->objRequest || transInfo->acked) {
         if (sent) {
             // Start timer if a response is expected
-            transInfo->timer->start(REQ_TIMEOUT_MS);
+            transInfo->timeoutMs = transactionClock.elapsed() + REQ_TIMEOUT_MS;
+            transactionTimerIdleTicks = 0;
+            if (!transactionTimer->isActive()) {
+                transactionTimer->start();
+            }
         } else {
             // message was not sent, the transaction will not complete and will timeout
             // there is no need to wait to close the transaction and notify of completion failure
@@ -415,9 +473,8 @@ void Telemetry::processObjectQueue()
             return;
         }
         UAVObject::Metadata metadata     = objInfo.obj->getMetadata();
-        ObjectTransactionInfo *transInfo = new ObjectTransactionInfo(this);
-        transInfo->obj   = objInfo.obj;
-        transInfo->allInstances = objInfo.allInstances;
+        // Insert the transaction into the transaction table.
+        ObjectTransactionInfo *transInfo = openTransaction(objInfo.obj, objInfo.allInstances);
         transInfo->retriesRemaining = MAX_RETRIES;
         transInfo->acked = UAVObject::GetGcsTelemetryAcked(metadata);
         if (objInfo.event == EV_UPDATED || objInfo.event == EV_UPDATED_MANUAL || objInfo.event == EV_UPDATED_PERIODIC) {
@@ -425,9 +482,6 @@ void Telemetry::processObjectQueue()
         } else if (objInfo.event == EV_UPDATE_REQ) {
             transInfo->objRequest = true;
         }
-        transInfo->telem = this;
-        // Insert the transaction into the transaction map.
-        openTransaction(transInfo);
         processObjectTransaction(transInfo);
     }
 
@@ -456,9 +510,6 @@ void Telemetry::processPeriodicUpdates()
 {
     QMutexLocker locker(mutex);
 
-    // Stop timer
-    updateTimer->stop();
-
     // Iterate through each object and update its timer, if zero then transmit object.
     // Also calculate smallest delay to next update (will be used for setting timeToNextUpdateMs)
     qint32 minDelay  = MAX_UPDATE_PERIOD_MS;
@@ -500,8 +551,10 @@ void Telemetry::processPeriodicUpdates()
     // Done
     timeToNextUpdateMs = minDelay;
 
-    // Restart timer
-    updateTimer->start(timeToNextUpdateMs);
+    // Restart timer, if the period did not change the running timer already fires at the right time
+    if (updateTimer->interval() != timeToNextUpdateMs) {
+        updateTimer->start(timeToNextUpdateMs);
+    }
 }
 
 Telemetry::TelemetryStats Telemetry::getStats()
@@ -606,86 +659,77 @@ ObjectTransactionInfo *Telemetry::findTransaction(UAVObject *obj)
     quint32 objId  = obj->getObjID();
     quint16 instId = obj->getInstID();
 
-    // Lookup the transaction in the transaction map
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId, NULL);
-    if (objTransactions != NULL) {
-        ObjectTransactionInfo *trans = objTransactions->value(instId, NULL);
-        if (trans == NULL) {
-            // see if there is an ALL_INSTANCES transaction
-            trans = objTransactions->value(UAVTalk::ALL_INSTANCES, NULL);
+    // Lookup the transaction in the transaction table
+    // There are only a handful of open transactions, a linear search is the fastest
+    ObjectTransactionInfo *allInstancesTrans = NULL;
+
+    for (int i = 0; i < openTransactions.size(); ++i) {
+        ObjectTransactionInfo *trans = openTransactions.at(i);
+        if (trans->objId == objId) {
+            if (trans->instId == instId) {
+                return trans;
+            }
+            if (trans->instId == UAVTalk::ALL_INSTANCES) {
+                allInstancesTrans = trans;
+            }
         }
-        return trans;
     }
-    return NULL;
+    // see if there is an ALL_INSTANCES transaction
+    return allInstancesTrans;
 }
 
-void Telemetry::openTransaction(ObjectTransactionInfo *trans)
+ObjectTransactionInfo *Telemetry::openTransaction(UAVObject *obj, bool allInstances)
 {
-    quint32 objId  = trans->obj->getObjID();
-    quint16 instId = trans->allInstances ? UAVTalk::ALL_INSTANCES : trans->obj->getInstID();
+    ObjectTransactionInfo *trans;
 
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId, NULL);
-    if (objTransactions == NULL) {
-        objTransactions = new QMap<quint32, ObjectTransactionInfo *>();
-        transMap.insert(objId, objTransactions);
+    if (!freeTransactions.isEmpty()) {
+        trans = freeTransactions.last();
+        freeTransactions.removeLast();
+    } else {
+        // Only when more transactions than ever before are open, the record joins the pool
+        trans = new ObjectTransactionInfo();
     }
-    objTransactions->insert(instId, trans);
+
+    trans->obj    = obj;
+    trans->objId  = obj->getObjID();
+    trans->instId = allInstances ? UAVTalk::ALL_INSTANCES : obj->getInstID();
+    trans->allInstances = allInstances;
+    openTransactions.append(trans);
+    return trans;
 }
 
 void Telemetry::closeTransaction(ObjectTransactionInfo *trans)
 {
-    quint32 objId  = trans->obj->getObjID();
-    quint16 instId = trans->allInstances ? UAVTalk::ALL_INSTANCES : trans->obj->getInstID();
+    int index = openTransactions.indexOf(trans);
 
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId, NULL);
-    if (objTransactions != NULL) {
-        objTransactions->remove(instId);
-        // Keep the map even if it is empty
-        // There are at most 100 different object IDs...
+    if (index >= 0) {
+        // Order does not matter, move the last one into the hole
+        openTransactions[index] = openTransactions.last();
+        openTransactions.removeLast();
     }
-    delete trans;
+    *trans = ObjectTransactionInfo();
+    freeTransactions.append(trans);
 }
 
 void Telemetry::closeAllTransactions()
 {
-    foreach(quint32 objId, transMap.keys()) {
-        QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId, NULL);
-        foreach(quint32 instId, objTransactions->keys()) {
-            ObjectTransactionInfo *trans = objTransactions->value(instId, NULL);
-
-            qWarning() << "Telemetry - closing active transaction for object" << trans->obj->toStringBrief();
-            objTransactions->remove(instId);
-            delete trans;
-        }
-        transMap.remove(objId);
-        delete objTransactions;
+    foreach(ObjectTransactionInfo * trans, openTransactions) {
+        qWarning() << "Telemetry - closing active transaction for object" << trans->obj->toStringBrief();
+        *trans = ObjectTransactionInfo();
+        freeTransactions.append(trans);
     }
+    openTransactions.clear();
+    transactionTimer->stop();
 }
 
-ObjectTransactionInfo::ObjectTransactionInfo(QObject *parent) : QObject(parent)
+ObjectTransactionInfo::ObjectTransactionInfo()
 {
-    obj = 0;
+    obj    = 0;
+    objId  = 0;
+    instId = 0;
     allInstances     = false;
     objRequest       = false;
     retriesRemaining = 0;
-    acked = false;
-    telem = 0;
-    // Setup transaction timer
-    timer = new QTimer(this);
-    timer->setSingleShot(true);
-    connect(timer, SIGNAL(timeout()), this, SLOT(timeout()));
-}
-
-ObjectTransactionInfo::~ObjectTransactionInfo()
-{
-    telem = 0;
-    timer->stop();
-    delete timer;
-}
-
-void ObjectTransactionInfo::timeout()
-{
-    if (!telem.isNull()) {
-        telem->transactionTimeout(this);
-    }
+    acked     = false;
+    timeoutMs = 0;
 }
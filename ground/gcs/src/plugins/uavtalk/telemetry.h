@@ -34,24 +34,25 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QTimer>
-#include <QQueue>
-#include <QMap>
-
-class ObjectTransactionInfo : public QObject {
-    Q_OBJECT
+#include <QElapsedTimer>
+#include <QVector>
+#include <QHash>
 
+/**
+ * Transaction record, pooled by the Telemetry and reused
+ */
+class ObjectTransactionInfo {
 public:
-    ObjectTransactionInfo(QObject *parent);
-    ~ObjectTransactionInfo();
+    ObjectTransactionInfo();
     UAVObject *obj;
+    quint32 objId;
+    quint16 instId;
     bool allInstances;
     bool objRequest;
     qint32 retriesRemaining;
     bool acked;
-    QPointer<class Telemetry>telem;
-    QTimer *timer;
-private slots:
-    void timeout();
+    // Time (Telemetry transaction clock) at which the transaction times out, 0 if no response is awaited
+    qint64 timeoutMs;
 };
 
 class Telemetry : public QObject {
@@ -77,7 +78,6 @@ public:
     ~Telemetry();
     TelemetryStats getStats();
     void resetStats();
-    void transactionTimeout(ObjectTransactionInfo *info);
 
 private:
     // Constants
@@ -86,6 +86,11 @@ private:
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
     static const int MAX_QUEUE_SIZE = 20;
+    // Resolution of the transaction timeouts
+    static const int TRANSACTION_CHECK_PERIOD_MS = 25;
+    // The check timer stops after this many ticks without pending transaction
+    static const int TRANSACTION_TIMER_IDLE_TICKS = 40;
+    static const int INITIAL_TRANSACTIONS = 32;
 
     // Types
     /**
@@ -112,14 +117,60 @@ private:
         bool allInstances;
     } ObjectQueueInfo;
 
+    /**
+     * Fixed size event queue, a QQueue would allocate a node for each event
+     */
+    class ObjectQueue {
+    public:
+        ObjectQueue() : head(0), count(0) {}
+        bool isEmpty() const
+        {
+            return count == 0;
+        }
+        int length() const
+        {
+            return count;
+        }
+        void clear()
+        {
+            head  = 0;
+            count = 0;
+        }
+        // The caller checks the length against MAX_QUEUE_SIZE
+        void enqueue(const ObjectQueueInfo &info)
+        {
+            entries[(head + count++) % MAX_QUEUE_SIZE] = info;
+        }
+        ObjectQueueInfo dequeue()
+        {
+            ObjectQueueInfo info = entries[head];
+
+            head = (head + 1) % MAX_QUEUE_SIZE;
+            --count;
+            return info;
+        }
+
+    private:
+        ObjectQueueInfo entries[MAX_QUEUE_SIZE];
+        int head;
+        int count;
+    };
+
     // Variables
     UAVObjectManager *objMngr;
     UAVTalk *utalk;
     GCSTelemetryStats *gcsStatsObj;
     QList<ObjectTimeInfo> objList;
-    QQueue<ObjectQueueInfo> objQueue;
-    QQueue<ObjectQueueInfo> objPriorityQueue;
-    QMap<quint32, QMap<quint32, ObjectTransactionInfo *> *> transMap;
+    ObjectQueue objQueue;
+    ObjectQueue objPriorityQueue;
+    // Open transactions and the pool of free records
+    QVector<ObjectTransactionInfo *> openTransactions;
+    QVector<ObjectTransactionInfo *> freeTransactions;
+    QTimer *transactionTimer;
+    QElapsedTimer transactionClock;
+    int transactionTimerIdleTicks;
+    // Event mask each object instance is currently connected with
+    QHash<UAVObject *, quint32> connectedEventMasks;
     QMutex *mutex;
     QTimer *updateTimer;
     QTimer *statsTimer;
@@ -139,9 +190,10 @@ private:
     void processObjectQueue();
 
     ObjectTransactionInfo *findTransaction(UAVObject *obj);
-    void openTransaction(ObjectTransactionInfo *trans);
+    ObjectTransactionInfo *openTransaction(UAVObject *obj, bool allInstances);
     void closeTransaction(ObjectTransactionInfo *trans);
     void closeAllTransactions();
+    void transactionTimeout(ObjectTransactionInfo *transInfo);
 
 private slots:
     void objectUpdatedAuto(UAVObject *obj);
@@ -153,6 +205,7 @@ private slots:
     void newInstance(UAVObject *obj);
     void processPeriodicUpdates();
     void transactionCompleted(UAVObject *obj, bool success);
+    void checkTransactionTimeouts();
 };
 
 #endif // TELEMETRY_H
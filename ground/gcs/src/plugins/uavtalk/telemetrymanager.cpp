@@ -32,6 +32,8 @@
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/threadmanager.h>
+#include <coreplugin/generalsettings.h>
+#include "utils/pathutils.h"
 
 TelemetryManager::TelemetryManager() : QObject(), m_connectionState(TELEMETRY_DISCONNECTED)
 {
@@ -76,7 +78,10 @@ void TelemetryManager::start(QIODevice *dev)
 
 void TelemetryManager::onStart()
 {
-    m_uavTalk = new UAVTalk(m_telemetryDevice, m_uavobjectManager);
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
+
+    m_uavTalk = new UAVTalk(m_telemetryDevice, m_uavobjectManager, settings->useUDPMirror());
     if (false) {
         // UAVTalk must be thread safe and for that:
         // 1- all public methods must lock a mutex
@@ -99,7 +104,7 @@ void TelemetryManager::onStart()
     }
 
     m_telemetry = new Telemetry(m_uavTalk, m_uavobjectManager);
-    m_telemetryMonitor = new TelemetryMonitor(m_uavobjectManager, m_telemetry);
+    m_telemetryMonitor = new TelemetryMonitor(m_uavobjectManager, m_telemetry, Utils::GetStoragePath() + "objectcache");
 
     connect(m_telemetryMonitor, SIGNAL(connected()), this, SLOT(onConnect()));
     connect(m_telemetryMonitor, SIGNAL(disconnected()), this, SLOT(onDisconnect()));
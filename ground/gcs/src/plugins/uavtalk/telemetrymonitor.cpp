@@ -27,22 +27,31 @@
  */
 
 #include "telemetrymonitor.h"
-#include "coreplugin/connectionmanager.h"
-#include "coreplugin/icore.h"
+#include "objectcache.h"
+
+#include <QDebug>
 
 /**
  * Constructor
  */
-TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel) :
+TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel, const QString &cacheDirectory) :
     objMngr(objMngr),
     tel(tel),
     gcsStatsObj(GCSTelemetryStats::GetInstance(objMngr)),
     flightStatsObj(FlightTelemetryStats::GetInstance(objMngr)),
     firmwareIAPObj(FirmwareIAPObj::GetInstance(objMngr)),
     statsTimer(new QTimer(this)),
-    objPending(NULL),
     mutex(new QMutex(QMutex::Recursive)),
-    connectionTimer(new QTime())
+    connectionTimer(new QTime()),
+    retrieving(false),
+    retrievalWindow(INITIAL_RETRIEVAL_WINDOW),
+    dispatching(false),
+    connectedEmitted(false),
+    cache(cacheDirectory.isEmpty() ? NULL : new ObjectCache(cacheDirectory)),
+    identifying(false),
+    caching(false),
+    cachedObjects(0),
+    invalidatedObjects(0)
 {
     // Listen for flight stats updates
     connect(flightStatsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(flightStatsUpdated(UAVObject *)));
@@ -60,6 +69,8 @@ TelemetryMonitor::~TelemetryMonitor()
     gcsStats.Status = GCSTelemetryStats::STATUS_DISCONNECTED;
     // Set data
     gcsStatsObj->setData(gcsStats);
+
+    delete cache;
 }
 
 /**
@@ -88,9 +99,21 @@ void TelemetryMonitor::startRetrievingObjects()
             }
         }
     }
+    // The board is identified first, its cached objects can then be used while they are retrieved
+    queue.removeAll(firmwareIAPObj);
+    queue.prepend(firmwareIAPObj);
+    identifying        = cache != NULL;
+    caching            = false;
+    cachedObjects      = 0;
+    invalidatedObjects = 0;
+    connectedEmitted   = false;
+    retrievalWindow    = INITIAL_RETRIEVAL_WINDOW;
+    retrieving         = true;
+    retrievalTimer.start();
+
     // Start retrieving
     qDebug() << "TelemetryMonitor::startRetrievingObjects - retrieving" << queue.length() << "objects";
-    retrieveNextObject();
+    retrieveObjects();
 }
 
 /**
@@ -99,35 +122,163 @@ void TelemetryMonitor::startRetrievingObjects()
 void TelemetryMonitor::stopRetrievingObjects()
 {
     qDebug() << "TelemetryMonitor::stopRetrievingObjects - object retrieval has been cancelled";
+    foreach(UAVObject * obj, queue) {
+        obj->disconnect(this);
+    }
     queue.clear();
+    foreach(UAVObject * obj, pending) {
+        obj->disconnect(this);
+    }
+    pending.clear();
+    modified.clear();
+    retrieving  = false;
+    identifying = false;
+    caching     = false;
+}
+
+/**
+ * Settings and metadata are cached, data objects are state
+ */
+bool TelemetryMonitor::isCached(UAVObject *obj)
+{
+    UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
+
+    return dynamic_cast<UAVMetaObject *>(obj) != NULL || (dobj != NULL && dobj->isSettingsObject());
 }
 
 /**
- * Retrieve the next object in the queue
+ * Request the next objects in the queue, up to the retrieval window
  */
-void TelemetryMonitor::retrieveNextObject()
+void TelemetryMonitor::retrieveObjects()
 {
-    // If queue is empty return
-    if (queue.isEmpty()) {
-        qDebug() << "TelemetryMonitor::retrieveNextObject - object retrieval completed";
+    // A request can complete before requestUpdate() returns
+    if (!retrieving || dispatching) {
+        return;
+    }
+    dispatching = true;
+
+    int window = identifying ? 1 : retrievalWindow;
+    while (!queue.isEmpty() && pending.size() < window) {
+        // Get next object from the queue
+        UAVObject *obj = queue.dequeue();
+        // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
+
+        // Connect to object
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+
+        // Request update
+        pending.insert(obj);
+        obj->requestUpdate();
+        window = identifying ? 1 : retrievalWindow;
+    }
+
+    dispatching = false;
+    if (retrieving && queue.isEmpty() && pending.isEmpty()) {
+        retrievalCompleted();
+    }
+}
+
+/**
+ * All objects retrieved, the connection is reported now if the cache did not already
+ */
+void TelemetryMonitor::retrievalCompleted()
+{
+    retrieving = false;
+    qDebug() << "TelemetryMonitor::retrievalCompleted - object retrieval completed in" << retrievalTimer.elapsed() << "ms";
+    if (caching) {
+        if (cachedObjects > 0) {
+            qDebug() << "TelemetryMonitor::retrievalCompleted -" << cachedObjects << "cached objects validated,"
+                     << invalidatedObjects << "changed on the board";
+        }
+        cache->save();
+        caching = false;
+    }
+    if (!connectedEmitted) {
         if (firmwareIAPObj->getBoardType()) {
+            connectedEmitted = true;
             emit connected();
         } else {
             connect(firmwareIAPObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(firmwareIAPUpdated(UAVObject *)));
         }
+    }
+    emit objectsRetrieved();
+}
+
+/**
+ * The board is known, fill the objects with their last known values
+ */
+void TelemetryMonitor::loadCache()
+{
+    QString boardKey = ObjectCache::boardKey(firmwareIAPObj);
+
+    if (boardKey.isEmpty()) {
         return;
     }
+    caching = true;
+    if (!cache->load(boardKey)) {
+        qDebug() << "TelemetryMonitor::loadCache - no cached objects for board" << boardKey;
+        return;
+    }
+    cachedObjects = cache->apply(objMngr);
+    qDebug() << "TelemetryMonitor::loadCache -" << cachedObjects << "cached objects for board" << boardKey;
 
-    // Get next object from the queue
-    UAVObject *obj = queue.dequeue();
-    // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
+    // Usable now, the retrieval continues in the background and updates what changed
+    if (cachedObjects > 0 && firmwareIAPObj->getBoardType()) {
+        qDebug() << "TelemetryMonitor::loadCache - connected from the cache in" << retrievalTimer.elapsed() << "ms";
+        connectedEmitted = true;
+        // The gadgets can edit the objects from now on, before the board sent them
+        foreach(UAVObject * obj, queue) {
+            trackModifications(obj);
+        }
+        foreach(UAVObject * obj, pending) {
+            trackModifications(obj);
+        }
+        emit connected();
+    }
+}
+
+void TelemetryMonitor::trackModifications(UAVObject *obj)
+{
+    connect(obj, SIGNAL(objectUpdatedAuto(UAVObject *)), this, SLOT(objectModified(UAVObject *)));
+    connect(obj, SIGNAL(objectUpdatedManual(UAVObject *, bool)), this, SLOT(objectModified(UAVObject *)));
+}
 
-    // Connect to object
-    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+/**
+ * An object still to be retrieved was edited and sent to the board. The edit wins
+ * over the value the board sends back for the older request.
+ */
+void TelemetryMonitor::objectModified(UAVObject *obj)
+{
+    QMutexLocker locker(mutex);
 
-    // Request update
-    obj->requestUpdate();
-    objPending = obj;
+    if (queue.removeAll(obj) > 0) {
+        // Not requested yet, and no longer needed
+        obj->disconnect(this);
+    } else if (pending.contains(obj)) {
+        // Telemetry drops the update while the request is in flight, it is sent again once the request completed
+        QByteArray data(obj->getNumBytes(), 0);
+        obj->pack(reinterpret_cast<quint8 *>(data.data()));
+        modified.insert(obj, data);
+    } else {
+        return;
+    }
+    // Only what the board sent is cached
+    if (caching) {
+        cache->remove(obj);
+    }
+    retrieveObjects();
+}
+
+/**
+ * Put the edit back over the older value the board sent, and send it
+ */
+void TelemetryMonitor::restoreModified(UAVObject *obj)
+{
+    QByteArray data = modified.take(obj);
+
+    qDebug() << "TelemetryMonitor::restoreModified -" << obj->getName() << "was edited during its retrieval, sending the edit again";
+    obj->unpack(reinterpret_cast<const quint8 *>(data.constData()));
+    obj->updated();
 }
 
 /**
@@ -135,23 +286,41 @@ void TelemetryMonitor::retrieveNextObject()
  */
 void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
 {
-    Q_UNUSED(success);
     QMutexLocker locker(mutex);
 
-    if (obj == objPending) {
-        // Disconnect from sending object
-        obj->disconnect(this);
-        objPending = NULL;
+    if (!pending.remove(obj)) {
+        qCritical() << "TelemetryMonitor::transactionCompleted - unexpected object" << obj;
+        return;
+    }
+    // Disconnect from sending object
+    obj->disconnect(this);
 
-        // Process next object if telemetry is still available
-        GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
-        if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
-            retrieveNextObject();
-        } else {
-            stopRetrievingObjects();
+    if (success) {
+        retrievalWindow = qMin(retrievalWindow + 1, (int)MAX_RETRIEVAL_WINDOW);
+    } else {
+        retrievalWindow = qMax(retrievalWindow / 2, 1);
+    }
+
+    if (modified.contains(obj)) {
+        restoreModified(obj);
+    } else if (identifying && obj == firmwareIAPObj) {
+        identifying = false;
+        loadCache();
+    } else if (caching && isCached(obj)) {
+        // Only what the board sent is kept
+        if (!success) {
+            cache->remove(obj);
+        } else if (cache->update(obj) && cachedObjects > 0) {
+            invalidatedObjects++;
         }
+    }
+
+    // Process next object if telemetry is still available
+    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
+    if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
+        retrieveObjects();
     } else {
-        qCritical() << "TelemetryMonitor::retrieveNextObject - unexpected object" << obj;
+        stopRetrievingObjects();
     }
 }
 
@@ -182,6 +351,7 @@ void TelemetryMonitor::firmwareIAPUpdated(UAVObject *obj)
 
     if (firmwareIAPObj->getBoardType() != 0) {
         disconnect(firmwareIAPObj);
+        connectedEmitted = true;
         emit connected();
     }
 }
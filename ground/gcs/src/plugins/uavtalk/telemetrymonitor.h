@@ -30,6 +30,10 @@
 
 #include <QObject>
 #include <QQueue>
+#include <QSet>
+#include <QHash>
+#include <QByteArray>
+#include <QElapsedTimer>
 #include <QTimer>
 #include <QTime>
 #include <QMutex>
@@ -41,28 +45,37 @@
 #include "systemstats.h"
 #include "telemetry.h"
 
+class ObjectCache;
+
 class TelemetryMonitor : public QObject {
     Q_OBJECT
 
 public:
-    TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel);
+    // The settings and metadata of the boards are cached in cacheDirectory, not cached if empty
+    TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel, const QString &cacheDirectory = QString());
     ~TelemetryMonitor();
 
 signals:
     void connected();
     void disconnected();
     void telemetryUpdated(double txRate, double rxRate);
+    // All objects retrieved after the connection, the cached ones are validated
+    void objectsRetrieved();
 
 public slots:
     void transactionCompleted(UAVObject *obj, bool success);
     void processStatsUpdates();
     void flightStatsUpdated(UAVObject *obj);
     void firmwareIAPUpdated(UAVObject *obj);
+    void objectModified(UAVObject *obj);
 
 private:
     static const int STATS_UPDATE_PERIOD_MS  = 4000;
     static const int STATS_CONNECT_PERIOD_MS = 2000;
     static const int CONNECTION_TIMEOUT_MS   = 8000;
+    // Requests in flight during the retrieval, grown on success and halved on failure
+    static const int INITIAL_RETRIEVAL_WINDOW = 2;
+    static const int MAX_RETRIEVAL_WINDOW     = 8;
 
     UAVObjectManager *objMngr;
     Telemetry *tel;
@@ -71,13 +84,31 @@ private:
     FlightTelemetryStats *flightStatsObj;
     FirmwareIAPObj *firmwareIAPObj;
     QTimer *statsTimer;
-    UAVObject *objPending;
     QMutex *mutex;
     QTime *connectionTimer;
+    QSet<UAVObject *> pending;
+    bool retrieving;
+    int retrievalWindow;
+    bool dispatching;
+    bool connectedEmitted;
+    QElapsedTimer retrievalTimer;
+    ObjectCache *cache;
+    // The board is identified before its cache is loaded
+    bool identifying;
+    bool caching;
+    int cachedObjects;
+    int invalidatedObjects;
+    // Objects edited while their request was in flight, with the edited data
+    QHash<UAVObject *, QByteArray> modified;
 
     void startRetrievingObjects();
-    void retrieveNextObject();
+    void retrieveObjects();
     void stopRetrievingObjects();
+    void retrievalCompleted();
+    void loadCache();
+    void trackModifications(UAVObject *obj);
+    void restoreModified(UAVObject *obj);
+    static bool isCached(UAVObject *obj);
 };
 
 #endif // TELEMETRYMONITOR_H
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ *
+ * @file       loopbackdevice.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief In memory link between a GCS and a stand-in board UAVTalk, for the unit tests
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOOPBACKDEVICE_H
+#define LOOPBACKDEVICE_H
+
+#include <QtCore/QIODevice>
+#include <QtCore/QByteArray>
+#include <QtCore/QTimer>
+
+#include <string.h>
+
+/**
+ * One end of an in memory link. Written bytes reach the peer from the event
+ * loop after the latency, like on a serial port.
+ */
+class LoopbackDevice : public QIODevice {
+public:
+    LoopbackDevice(int latency = 0) : m_peer(0), m_latency(latency)
+    {
+        open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+    }
+
+    void setPeer(LoopbackDevice *peer)
+    {
+        m_peer = peer;
+    }
+
+    bool isSequential() const
+    {
+        return true;
+    }
+
+    qint64 bytesAvailable() const
+    {
+        return m_buffer.size() + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize)
+    {
+        qint64 length = qMin<qint64>(maxSize, m_buffer.size());
+
+        memcpy(data, m_buffer.constData(), length);
+        m_buffer.remove(0, length);
+        return length;
+    }
+
+    qint64 writeData(const char *data, qint64 size)
+    {
+        LoopbackDevice *peer = m_peer;
+        QByteArray chunk(data, size);
+
+        QTimer::singleShot(m_latency, peer, [peer, chunk]() {
+            peer->m_buffer.append(chunk);
+            emit peer->readyRead();
+        });
+        return size;
+    }
+
+private:
+    LoopbackDevice *m_peer;
+    int m_latency;
+    QByteArray m_buffer;
+};
+
+#endif // LOOPBACKDEVICE_H
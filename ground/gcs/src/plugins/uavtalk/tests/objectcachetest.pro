@@ -0,0 +1,20 @@
+#
+# Round trips of the on-disk object cache used to reconnect to a known board
+#
+
+include(../../../../gcs.pri)
+include(../../uavobjects/tests/uavobjectstest.pri)
+
+TARGET = objectcachetest
+
+QT += network
+
+DEFINES += UAVTALK_LIBRARY
+
+INCLUDEPATH += $$PLUGINS_DIR/uavtalk
+
+HEADERS += $$PLUGINS_DIR/uavtalk/objectcache.h
+
+SOURCES += \
+    tst_objectcache.cpp \
+    $$PLUGINS_DIR/uavtalk/objectcache.cpp
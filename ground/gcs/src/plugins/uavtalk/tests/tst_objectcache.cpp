@@ -0,0 +1,216 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_objectcache.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Checks the board key and the save, load and apply round trip of the object cache
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "objectcache.h"
+#include "firmwareiapobj.h"
+#include "systemsettings.h"
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QTemporaryDir>
+
+class tst_ObjectCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void boardKey();
+    void roundTrip();
+    void update();
+    void unknownObject();
+    void corruptFile();
+    void cleanupTestCase();
+
+private:
+    UAVObjectManager *m_objMngr;
+    FirmwareIAPObj *m_firmware;
+    SystemSettings *m_settings;
+    QTemporaryDir *m_dir;
+
+    void setBoard(quint8 serial);
+};
+
+void tst_ObjectCache::initTestCase()
+{
+    m_objMngr  = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+    m_firmware = FirmwareIAPObj::GetInstance(m_objMngr);
+    m_settings = SystemSettings::GetInstance(m_objMngr);
+    m_dir      = new QTemporaryDir();
+    QVERIFY(m_dir->isValid());
+}
+
+void tst_ObjectCache::init()
+{
+    setBoard(1);
+    m_settings->setAirframeType(SystemSettings::AIRFRAMETYPE_QUADX);
+}
+
+void tst_ObjectCache::setBoard(quint8 serial)
+{
+    FirmwareIAPObj::DataFields firmware = m_firmware->getData();
+
+    memset(firmware.CPUSerial, 0, sizeof(firmware.CPUSerial));
+    firmware.CPUSerial[0] = serial;
+    for (int i = 0; i < 20; i++) {
+        firmware.Description[60 + i] = i;
+    }
+    m_firmware->setData(firmware);
+}
+
+void tst_ObjectCache::boardKey()
+{
+    QString key = ObjectCache::boardKey(m_firmware);
+
+    QCOMPARE(key, QString("010000000000000000000000-000102030405060708090a0b0c0d0e0f10111213"));
+
+    // A new firmware has another UAVO hash, its objects may differ
+    FirmwareIAPObj::DataFields firmware = m_firmware->getData();
+    firmware.Description[79] = 0xff;
+    m_firmware->setData(firmware);
+    QVERIFY(ObjectCache::boardKey(m_firmware) != key);
+
+    // No serial, the board can not be told from another
+    memset(firmware.CPUSerial, 0, sizeof(firmware.CPUSerial));
+    m_firmware->setData(firmware);
+    QVERIFY(ObjectCache::boardKey(m_firmware).isEmpty());
+}
+
+void tst_ObjectCache::roundTrip()
+{
+    QString key = ObjectCache::boardKey(m_firmware);
+    {
+        ObjectCache cache(m_dir->path());
+        QVERIFY(!cache.load(key));
+        m_settings->setAirframeType(SystemSettings::AIRFRAMETYPE_HEXA);
+        QVERIFY(cache.update(m_settings));
+        QVERIFY(cache.update(m_settings->getMetaObject()));
+        QVERIFY(cache.save());
+    }
+
+    m_settings->setAirframeType(SystemSettings::AIRFRAMETYPE_QUADX);
+    QSignalSpy unpacked(m_settings, SIGNAL(objectUnpacked(UAVObject *)));
+
+    ObjectCache cache(m_dir->path());
+    QVERIFY(cache.load(key));
+    QCOMPARE(cache.size(), 2);
+    QCOMPARE(cache.apply(m_objMngr), 2);
+    QCOMPARE(m_settings->getAirframeType(), (quint8)SystemSettings::AIRFRAMETYPE_HEXA);
+    // Unpacked as if it came from the board, the gadgets see the change
+    QCOMPARE(unpacked.count(), 1);
+
+    // Another board has its own file
+    setBoard(2);
+    QVERIFY(!cache.load(ObjectCache::boardKey(m_firmware)));
+    QCOMPARE(cache.size(), 0);
+}
+
+void tst_ObjectCache::update()
+{
+    QString key = ObjectCache::boardKey(m_firmware);
+    ObjectCache cache(m_dir->path());
+
+    cache.load(key);
+    QVERIFY(cache.update(m_settings));
+    // Validation of an unchanged object
+    QVERIFY(!cache.update(m_settings));
+    // Changed on the board
+    m_settings->setAirframeType(SystemSettings::AIRFRAMETYPE_OCTO);
+    QVERIFY(cache.update(m_settings));
+
+    cache.remove(m_settings);
+    QCOMPARE(cache.size(), 0);
+}
+
+void tst_ObjectCache::unknownObject()
+{
+    setBoard(3);
+    QString key = ObjectCache::boardKey(m_firmware);
+    QString fileName = QDir(m_dir->path()).filePath(key + ".cache");
+    {
+        ObjectCache cache(m_dir->path());
+        cache.load(key);
+        cache.update(m_settings);
+        QVERIFY(cache.save());
+    }
+
+    // Append an entry of an unknown object and one of the wrong size
+    QFile file(fileName);
+    QVERIFY(file.open(QFile::ReadWrite));
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint32 magic, version, count;
+    stream >> magic >> version >> count;
+    file.seek(8);
+    stream << (quint32)(count + 2);
+    file.seek(file.size());
+    stream << (quint32)0x12345678 << (quint32)0 << QByteArray(4, 0);
+    stream << (quint32)m_firmware->getObjID() << (quint32)0 << QByteArray(3, 0);
+    file.close();
+
+    ObjectCache cache(m_dir->path());
+    QVERIFY(cache.load(key));
+    QCOMPARE(cache.size(), 3);
+    QCOMPARE(cache.apply(m_objMngr), 1);
+    QCOMPARE(cache.size(), 1);
+}
+
+void tst_ObjectCache::corruptFile()
+{
+    setBoard(4);
+    QString key = ObjectCache::boardKey(m_firmware);
+    {
+        ObjectCache cache(m_dir->path());
+        cache.load(key);
+        cache.update(m_settings);
+        cache.update(m_firmware);
+        QVERIFY(cache.save());
+    }
+
+    QFile file(QDir(m_dir->path()).filePath(key + ".cache"));
+    QVERIFY(file.open(QFile::ReadWrite));
+    QVERIFY(file.resize(file.size() - 5));
+    file.close();
+
+    ObjectCache cache(m_dir->path());
+    QVERIFY(!cache.load(key));
+    QCOMPARE(cache.size(), 0);
+}
+
+void tst_ObjectCache::cleanupTestCase()
+{
+    delete m_dir;
+    delete m_objMngr;
+}
+
+QTEST_GUILESS_MAIN(tst_ObjectCache)
+
+#include "tst_objectcache.moc"
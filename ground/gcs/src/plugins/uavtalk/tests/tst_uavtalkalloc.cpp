@@ -0,0 +1,387 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_uavtalkalloc.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Checks that steady state receive, ack and transmit do not allocate
+ *
+ * Only UAVTalk and Telemetry are covered. Update bus subscribers, such as
+ * the stream service, still cost an allocation per delivery, which
+ * busSubscriber() reports.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavtalk.h"
+#include "telemetry.h"
+#include "attitudestate.h"
+#include "uavobjectupdatebus.h"
+#include "gcstelemetrystats.h"
+#include <utils/crc.h>
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QObject>
+#include <QtCore/QIODevice>
+#include <QtCore/QtEndian>
+
+#include <string.h>
+
+#ifdef __GLIBC__
+// Count the heap allocations while enabled. QArrayData and friends call malloc
+// directly, wrapping operator new alone would miss them.
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static bool countAllocations = false;
+static int allocations = 0;
+
+extern "C" void *malloc(size_t size)
+{
+    if (countAllocations) {
+        ++allocations;
+    }
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    if (countAllocations) {
+        ++allocations;
+    }
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    if (countAllocations) {
+        ++allocations;
+    }
+    return __libc_realloc(ptr, size);
+}
+#endif // __GLIBC__
+
+/**
+ * Unbuffered sequential device, reads from a caller provided buffer
+ * and keeps the last written packet. Neither direction allocates.
+ */
+class PacketDevice : public QIODevice {
+public:
+    PacketDevice() : m_readData(0), m_readLength(0), m_writtenLength(0)
+    {
+        open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+    }
+
+    bool isSequential() const
+    {
+        return true;
+    }
+
+    qint64 bytesAvailable() const
+    {
+        return m_readLength + QIODevice::bytesAvailable();
+    }
+
+    void feed(const QByteArray &data)
+    {
+        m_readData   = data.constData();
+        m_readLength = data.size();
+        emit readyRead();
+    }
+
+    QByteArray written() const
+    {
+        return QByteArray(m_written, m_writtenLength);
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize)
+    {
+        qint64 length = qMin(maxSize, m_readLength);
+
+        memcpy(data, m_readData, length);
+        m_readData   += length;
+        m_readLength -= length;
+        return length;
+    }
+
+    qint64 writeData(const char *data, qint64 size)
+    {
+        m_writtenLength = qMin<qint64>(size, sizeof(m_written));
+        memcpy(m_written, data, m_writtenLength);
+        return size;
+    }
+
+private:
+    const char *m_readData;
+    qint64 m_readLength;
+    char m_written[512];
+    qint64 m_writtenLength;
+};
+
+class tst_UAVTalkAlloc : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void receive();
+    void ackedTransmit();
+    void telemetryTransactions();
+    void busSubscriber();
+    void nestedRead();
+
+private:
+    static const int PACKETS = 10000;
+    static const int WARMUP  = 100;
+
+    UAVObjectManager *m_objMngr;
+    AttitudeState *m_attitude;
+    QByteArray m_objectPacket;
+    QByteArray m_ackPacket;
+
+    void startCounting();
+    int stopCounting();
+};
+
+void tst_UAVTalkAlloc::initTestCase()
+{
+#ifndef __GLIBC__
+    QSKIP("Allocation counting needs glibc");
+#endif
+    m_objMngr  = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+    m_attitude = AttitudeState::GetInstance(m_objMngr);
+    QVERIFY(m_attitude);
+
+    // Encode an object packet with UAVTalk itself
+    PacketDevice device;
+    UAVTalk talk(&device, m_objMngr);
+    QVERIFY(talk.sendObject(m_attitude, false, false));
+    m_objectPacket = device.written();
+
+    // sync, type, size, object ID, instance ID, CRC
+    m_ackPacket.resize(11);
+    quint8 *ack = reinterpret_cast<quint8 *>(m_ackPacket.data());
+    ack[0] = 0x3C;
+    ack[1] = 0x23;
+    qToLittleEndian<quint16>(10, &ack[2]);
+    qToLittleEndian<quint32>(m_attitude->getObjID(), &ack[4]);
+    qToLittleEndian<quint16>(0, &ack[8]);
+    ack[10] = Utils::Crc::updateCRC(0, ack, 10);
+}
+
+void tst_UAVTalkAlloc::cleanupTestCase()
+{
+    delete m_objMngr;
+}
+
+void tst_UAVTalkAlloc::receive()
+{
+    PacketDevice device;
+    UAVTalk talk(&device, m_objMngr);
+
+    connect(&device, SIGNAL(readyRead()), &talk, SLOT(processInputStream()));
+
+    for (int i = 0; i < WARMUP; ++i) {
+        device.feed(m_objectPacket);
+    }
+
+    startCounting();
+    for (int i = 0; i < PACKETS; ++i) {
+        device.feed(m_objectPacket);
+    }
+    int count = stopCounting();
+
+    QCOMPARE(talk.getStats().rxObjects, quint32(WARMUP + PACKETS));
+    QCOMPARE(talk.getStats().rxErrors, quint32(0));
+    QCOMPARE(count, 0);
+}
+
+void tst_UAVTalkAlloc::ackedTransmit()
+{
+    int completed = 0;
+    PacketDevice device;
+    UAVTalk talk(&device, m_objMngr);
+
+    connect(&device, SIGNAL(readyRead()), &talk, SLOT(processInputStream()));
+    connect(&talk, &UAVTalk::transactionCompleted, [&completed](UAVObject *, bool success) {
+        if (success) {
+            ++completed;
+        }
+    });
+
+    for (int i = 0; i < WARMUP; ++i) {
+        talk.sendObject(m_attitude, true, false);
+        device.feed(m_ackPacket);
+    }
+
+    startCounting();
+    for (int i = 0; i < PACKETS; ++i) {
+        talk.sendObject(m_attitude, true, false);
+        device.feed(m_ackPacket);
+    }
+    int count = stopCounting();
+
+    QCOMPARE(completed, WARMUP + PACKETS);
+    QCOMPARE(talk.getStats().txObjects, quint32(WARMUP + PACKETS));
+    QCOMPARE(count, 0);
+}
+
+void tst_UAVTalkAlloc::telemetryTransactions()
+{
+    int completed = 0;
+    PacketDevice device;
+    UAVTalk talk(&device, m_objMngr);
+    Telemetry telemetry(&talk, m_objMngr);
+
+    connect(&device, SIGNAL(readyRead()), &talk, SLOT(processInputStream()));
+    // Disconnected with the telemetry, before completed goes out of scope
+    connect(m_attitude, &UAVObject::transactionCompleted, &telemetry, [&completed](UAVObject *, bool success) {
+        if (success) {
+            ++completed;
+        }
+    });
+
+    // Only the handshake objects are sent while disconnected
+    GCSTelemetryStats *gcsStats = GCSTelemetryStats::GetInstance(m_objMngr);
+    GCSTelemetryStats::DataFields stats = gcsStats->getData();
+    stats.Status = GCSTelemetryStats::STATUS_CONNECTED;
+    gcsStats->setData(stats);
+
+    UAVObject::Metadata metadata = m_attitude->getMetadata();
+    UAVObject::SetGcsTelemetryAcked(metadata, 1);
+    UAVObject::SetGcsTelemetryUpdateMode(metadata, UAVObject::UPDATEMODE_MANUAL);
+    m_attitude->setMetadata(metadata);
+
+    // Each update opens a Telemetry and a UAVTalk transaction, the ack closes both
+    for (int i = 0; i < WARMUP; ++i) {
+        m_attitude->updated();
+        device.feed(m_ackPacket);
+    }
+
+    startCounting();
+    for (int i = 0; i < PACKETS; ++i) {
+        m_attitude->updated();
+        device.feed(m_ackPacket);
+    }
+    int count = stopCounting();
+
+    QCOMPARE(completed, WARMUP + PACKETS);
+    QCOMPARE(telemetry.getStats().txErrors, quint32(0));
+    QCOMPARE(count, 0);
+}
+
+void tst_UAVTalkAlloc::busSubscriber()
+{
+    PacketDevice device;
+    UAVTalk talk(&device, m_objMngr);
+    QObject context;
+    int delivered = 0;
+
+    connect(&device, SIGNAL(readyRead()), &talk, SLOT(processInputStream()));
+    UAVObjectUpdateSubscription *subscription = m_objMngr->getUpdateBus()->subscribe(&context, QList<quint32>() << m_attitude->getObjID());
+    connect(subscription, &UAVObjectUpdateSubscription::updated, [&delivered](const UAVObjectUpdateSubscription::UpdateBatch &batch) {
+        delivered += batch.size();
+    });
+
+    for (int i = 0; i < WARMUP; ++i) {
+        device.feed(m_objectPacket);
+        QCoreApplication::processEvents();
+    }
+
+    startCounting();
+    for (int i = 0; i < PACKETS; ++i) {
+        device.feed(m_objectPacket);
+        QCoreApplication::processEvents();
+    }
+    int count = stopCounting();
+
+    QCOMPARE(delivered, WARMUP + PACKETS);
+    // Neither the post nor the batched delivery allocates
+    QCOMPARE(count, 0);
+}
+
+void tst_UAVTalkAlloc::nestedRead()
+{
+    PacketDevice device;
+    UAVTalk talk(&device, m_objMngr);
+    QList<float> received;
+    QByteArray stream;
+
+    // More than a read chunk, so that the nested call reads on
+    for (int i = 0; i < 32; ++i) {
+        PacketDevice encoder;
+        UAVTalk encoderTalk(&encoder, m_objMngr);
+        AttitudeState::DataFields data = m_attitude->getData();
+        data.q1 = i;
+        m_attitude->setData(data);
+        QVERIFY(encoderTalk.sendObject(m_attitude, false, false));
+        stream += encoder.written();
+    }
+    QVERIFY(stream.size() > 1024);
+
+    connect(&device, SIGNAL(readyRead()), &talk, SLOT(processInputStream()));
+    // Like a modal dialog opened by the first update, handling readyRead in its own event loop
+    connect(m_attitude, &UAVObject::objectUpdated, &talk, [&](UAVObject *) {
+        received.append(m_attitude->getData().q1);
+        if (received.size() == 1) {
+            QMetaObject::invokeMethod(&talk, "processInputStream");
+        }
+    });
+
+    quint32 rxObjects = talk.getStats().rxObjects;
+    device.feed(stream);
+    m_attitude->disconnect(&talk);
+
+    QCOMPARE(received.size(), 32);
+    for (int i = 0; i < received.size(); ++i) {
+        QCOMPARE(received.at(i), (float)i);
+    }
+    QCOMPARE(talk.getStats().rxObjects, rxObjects + 32);
+    QCOMPARE(talk.getStats().rxErrors, quint32(0));
+}
+
+void tst_UAVTalkAlloc::startCounting()
+{
+#ifdef __GLIBC__
+    allocations      = 0;
+    countAllocations = true;
+#endif
+}
+
+int tst_UAVTalkAlloc::stopCounting()
+{
+#ifdef __GLIBC__
+    countAllocations = false;
+    return allocations;
+
+#else
+    return 0;
+
+#endif
+}
+
+QTEST_GUILESS_MAIN(tst_UAVTalkAlloc)
+
+#include "tst_uavtalkalloc.moc"
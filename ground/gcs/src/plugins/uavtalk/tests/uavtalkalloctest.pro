@@ -0,0 +1,11 @@
+#
+# Counts the heap allocations of the UAVTalk/Telemetry receive, ack and transmit paths
+# Allocations are counted by wrapping malloc, the test is skipped without glibc
+#
+
+include(../../../../gcs.pri)
+include(uavtalktest.pri)
+
+TARGET = uavtalkalloctest
+
+SOURCES += tst_uavtalkalloc.cpp
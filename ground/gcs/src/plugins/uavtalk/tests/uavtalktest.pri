@@ -0,0 +1,22 @@
+#
+# uavobjectstest.pri plus UAVTalk, Telemetry and the loopback link of the unit tests
+#
+
+include(../../uavobjects/tests/uavobjectstest.pri)
+
+QT += network
+
+DEFINES += UAVTALK_LIBRARY
+
+INCLUDEPATH += \
+    $$PLUGINS_DIR/uavtalk \
+    $$PLUGINS_DIR/uavtalk/tests
+
+HEADERS += \
+    $$PLUGINS_DIR/uavtalk/uavtalk.h \
+    $$PLUGINS_DIR/uavtalk/telemetry.h \
+    $$PLUGINS_DIR/uavtalk/tests/loopbackdevice.h
+
+SOURCES += \
+    $$PLUGINS_DIR/uavtalk/uavtalk.cpp \
+    $$PLUGINS_DIR/uavtalk/telemetry.cpp
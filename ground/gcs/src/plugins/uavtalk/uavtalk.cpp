@@ -25,8 +25,6 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavtalk.h"
-#include <extensionsystem/pluginmanager.h>
-#include <coreplugin/generalsettings.h>
 #include <utils/crc.h>
 
 #include <QtEndian>
@@ -48,17 +46,21 @@ using namespace Utils;
 
 /**
  * Constructor
+ * \param[in] useUDPMirror Mirror all received and transmitted packets to UDP port 9000 on localhost
  */
-UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive)
+UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr, bool useUDPMirror) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive),
+    useUDPMirror(useUDPMirror)
 {
     rxState = STATE_SYNC;
     rxPacketLength = 0;
+    rxMirrorLength = 0;
+    rxChunkPos     = 0;
+    rxChunkLength  = 0;
 
     memset(&stats, 0, sizeof(ComStats));
 
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
-    useUDPMirror = settings->useUDPMirror();
+    transactions.reserve(INITIAL_TRANSACTIONS);
+
     if (useUDPMirror) {
         qDebug() << "UAVTalk::UAVTalk -*** UDP mirror is enabled ***";
     }
@@ -210,32 +212,60 @@ bool UAVTalk::objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVO
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
-
-    if (io && io->isReadable()) {
-        while (io->bytesAvailable() > 0) {
-            int ret = io->read((char *)&tmp, 1);
-            if (ret != -1) {
-                processInputByte(tmp);
-            } else {
-                // TODOD
+    if (!io || !io->isReadable()) {
+        return;
+    }
+    // A received object may run a nested event loop that gets here again.
+    // The chunk and its read position are shared with such nested calls so
+    // that they go on with the next byte, as the byte by byte reads did.
+    forever {
+        if (rxChunkPos >= rxChunkLength) {
+            qint64 length = (io->bytesAvailable() > 0) ? io->read((char *)rxChunk, RX_CHUNK_SIZE) : 0;
+            if (length <= 0) {
+                break;
             }
-            if (rxState == STATE_COMPLETE) {
-                mutex.lock();
-                if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
-                    stats.rxObjectBytes += rxLength;
-                    stats.rxObjects++;
-                } else {
-                    // TODO...
-                }
-                mutex.unlock();
+            rxChunkPos    = 0;
+            rxChunkLength = length;
+        }
+        processReceivedByte(rxChunk[rxChunkPos++]);
+        if (!io) {
+            // Closed by a received object
+            break;
+        }
+    }
+}
 
-                if (useUDPMirror) {
-                    // it is safe to do this outside of the above critical section as the rxDataArray is
-                    // accessed from this thread only
-                    udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
-                }
-            }
+/**
+ * Process bytes received outside of the io device.
+ * Used when the caller reads the device itself, for instance to forward the raw stream.
+ */
+void UAVTalk::processInputBytes(const quint8 *data, qint64 length)
+{
+    for (qint64 i = 0; i < length; ++i) {
+        processReceivedByte(data[i]);
+    }
+}
+
+/**
+ * Feed a byte to the receive state machine and handle the packet it completes
+ */
+void UAVTalk::processReceivedByte(quint8 rxbyte)
+{
+    processInputByte(rxbyte);
+    if (rxState == STATE_COMPLETE) {
+        mutex.lock();
+        if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
+            stats.rxObjectBytes += rxLength;
+            stats.rxObjects++;
+        } else {
+            // TODO...
+        }
+        mutex.unlock();
+
+        if (useUDPMirror) {
+            // it is safe to do this outside of the above critical section as the rxMirrorBuffer is
+            // accessed from this thread only
+            udpSocketTx->writeDatagram((const char *)rxMirrorBuffer, rxMirrorLength, QHostAddress::LocalHost, udpSocketRx->localPort());
         }
     }
 }
@@ -249,10 +279,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 {
     if (rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
         rxState = STATE_SYNC;
-
-        if (useUDPMirror) {
-            rxDataArray.clear();
-        }
+        rxMirrorLength = 0;
     }
 
     // Update stats
@@ -261,8 +288,8 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     // update packet byte count
     rxPacketLength++;
 
-    if (useUDPMirror) {
-        rxDataArray.append(rxbyte);
+    if (useUDPMirror && rxMirrorLength < MAX_PACKET_LENGTH) {
+        rxMirrorBuffer[rxMirrorLength++] = rxbyte;
     }
 
     // Receive state machine
@@ -272,6 +299,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
         if (rxbyte != SYNC_VAL) {
             // continue until sync byte is matched
             stats.rxSyncErrors++;
+            rxMirrorLength = 0;
             break;
         }
 
@@ -816,59 +844,63 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
 
 UAVTalk::Transaction *UAVTalk::findTransaction(quint32 objId, quint16 instId)
 {
-    // Lookup the transaction in the transaction map
-    QMap<quint32, Transaction *> *objTransactions = transMap.value(objId, NULL);
-    if (objTransactions != NULL) {
-        Transaction *trans = objTransactions->value(instId, NULL);
-        if (trans == NULL) {
-            // see if there is an ALL_INSTANCES transaction
-            trans = objTransactions->value(ALL_INSTANCES, NULL);
+    // Lookup the transaction in the transaction table
+    // There are only a handful of open transactions, a linear search is the fastest
+    Transaction *allInstancesTrans = NULL;
+
+    for (int i = 0; i < transactions.size(); ++i) {
+        Transaction *trans = &transactions[i];
+        if (trans->respType != 0 && trans->respObjId == objId) {
+            if (trans->respInstId == instId) {
+                return trans;
+            }
+            if (trans->respInstId == ALL_INSTANCES) {
+                allInstancesTrans = trans;
+            }
         }
-        return trans;
     }
-    return NULL;
+    // see if there is an ALL_INSTANCES transaction
+    return allInstancesTrans;
 }
 
 void UAVTalk::openTransaction(quint8 type, quint32 objId, quint16 instId)
 {
-    Transaction *trans = new Transaction();
+    Transaction *trans = NULL;
+
+    // Replace a transaction on the same instance, otherwise reuse a free entry
+    for (int i = 0; i < transactions.size(); ++i) {
+        Transaction *t = &transactions[i];
+        if (t->respType != 0 && t->respObjId == objId && t->respInstId == instId) {
+            trans = t;
+            break;
+        }
+        if (t->respType == 0 && trans == NULL) {
+            trans = t;
+        }
+    }
+    if (trans == NULL) {
+        transactions.append(Transaction());
+        trans = &transactions.last();
+    }
 
     trans->respType   = (type == TYPE_OBJ_REQ) ? TYPE_OBJ : TYPE_ACK;
     trans->respObjId  = objId;
     trans->respInstId = instId;
-
-    QMap<quint32, Transaction *> *objTransactions = transMap.value(trans->respObjId, NULL);
-    if (objTransactions == NULL) {
-        objTransactions = new QMap<quint32, Transaction *>();
-        transMap.insert(trans->respObjId, objTransactions);
-    }
-    objTransactions->insert(trans->respInstId, trans);
 }
 
 void UAVTalk::closeTransaction(Transaction *trans)
 {
-    QMap<quint32, Transaction *> *objTransactions = transMap.value(trans->respObjId, NULL);
-    if (objTransactions != NULL) {
-        objTransactions->remove(trans->respInstId);
-        // Keep the map even if it is empty
-        // There are at most 100 different object IDs...
-        delete trans;
-    }
+    trans->respType = 0;
 }
 
 void UAVTalk::closeAllTransactions()
 {
-    foreach(quint32 objId, transMap.keys()) {
-        QMap<quint32, Transaction *> *objTransactions = transMap.value(objId, NULL);
-        foreach(quint32 instId, objTransactions->keys()) {
-            Transaction *trans = objTransactions->value(instId, NULL);
-
+    for (int i = 0; i < transactions.size(); ++i) {
+        Transaction *trans = &transactions[i];
+        if (trans->respType != 0) {
             qWarning() << "UAVTalk - closing active transaction for object" << trans->respObjId;
-            objTransactions->remove(instId);
-            delete trans;
+            trans->respType = 0;
         }
-        transMap.remove(objId);
-        delete objTransactions;
     }
 }
 
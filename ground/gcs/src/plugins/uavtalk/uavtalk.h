@@ -34,7 +34,7 @@
 #include <QIODevice>
 #include <QMutex>
 #include <QMutexLocker>
-#include <QMap>
+#include <QVector>
 #include <QThread>
 #include <QtNetwork/QUdpSocket>
 
@@ -60,7 +60,7 @@ public:
         quint32 rxCrcErrors;
     } ComStats;
 
-    UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr);
+    UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr, bool useUDPMirror = false);
     ~UAVTalk();
 
     ComStats getStats();
@@ -69,6 +69,7 @@ public:
     bool sendObject(UAVObject *obj, bool acked, bool allInstances);
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
     void cancelTransaction(UAVObject *obj);
+    void processInputBytes(const quint8 *data, qint64 length);
 
 signals:
     void transactionCompleted(UAVObject *obj, bool success);
@@ -79,6 +80,7 @@ private slots:
 
 private:
 
+    // respType is 0 for a free entry
     typedef struct {
         quint8  respType;
         quint32 respObjId;
@@ -105,6 +107,11 @@ private:
 
     static const int TX_BUFFER_SIZE     = 2 * 1024;
 
+    static const int RX_CHUNK_SIZE      = 512;
+
+    // Grows past this only if more transactions are ever open at once
+    static const int INITIAL_TRANSACTIONS = 32;
+
     // Types
     typedef enum {
         STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
@@ -119,12 +126,18 @@ private:
 
     QMutex mutex;
 
-    QMap<quint32, QMap<quint32, Transaction *> *> transMap;
+    // Flat table of the open transactions, entries are reused
+    QVector<Transaction> transactions;
 
     quint8 rxBuffer[MAX_PACKET_LENGTH];
 
     quint8 txBuffer[MAX_PACKET_LENGTH];
 
+    // Bytes read from the device and not processed yet
+    quint8 rxChunk[RX_CHUNK_SIZE];
+    qint32 rxChunkPos;
+    qint32 rxChunkLength;
+
     // Variables used by the receive state machine
     // state machine variables
     qint32 rxCount;
@@ -143,11 +156,13 @@ private:
     bool useUDPMirror;
     QUdpSocket *udpSocketTx;
     QUdpSocket *udpSocketRx;
-    QByteArray rxDataArray;
+    quint8 rxMirrorBuffer[MAX_PACKET_LENGTH];
+    qint32 rxMirrorLength;
 
     // Methods
     bool objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
     bool processInputByte(quint8 rxbyte);
+    void processReceivedByte(quint8 rxbyte);
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
     UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
     void updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
@@ -16,6 +16,7 @@ HEADERS += \
     uavtalk.h \
     telemetry.h \
     telemetrymonitor.h \
+    objectcache.h \
     telemetrymanager.h \
     oplinkmanager.h \
     uavtalkplugin.h
@@ -24,6 +25,7 @@ SOURCES += \
     uavtalk.cpp \
     telemetry.cpp \
     telemetrymonitor.cpp \
+    objectcache.cpp \
     telemetrymanager.cpp \
     oplinkmanager.cpp \
     uavtalkplugin.cpp
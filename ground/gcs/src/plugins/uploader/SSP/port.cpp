@@ -30,7 +30,7 @@
 #include <QSerialPort>
 #include <QDebug>
 
-port::port(QString name, bool debug) : mstatus(port::closed), debug(debug)
+port::port(QString name, bool debug) : mstatus(port::closed), rxPos(0), debug(debug)
 {
     timer.start();
     sport = new QSerialPort(name, this);
@@ -48,9 +48,16 @@ port::port(QString name, bool debug) : mstatus(port::closed), debug(debug)
     }
 }
 
+port::port(bool debug) : mstatus(port::open), sport(NULL), rxPos(0), debug(debug)
+{
+    timer.start();
+}
+
 port::~port()
 {
-    sport->close();
+    if (sport) {
+        sport->close();
+    }
 }
 
 port::portstatus port::status()
@@ -60,23 +67,28 @@ port::portstatus port::status()
 
 int16_t port::pfSerialRead(void)
 {
-    char c[1];
+    if (rxPos >= rxBuffer.size()) {
+        // TODO why the wait ? (gcs uploader dfu does not have it)
+        sport->waitForBytesWritten(1);
+        if (!sport->bytesAvailable() && !sport->waitForReadyRead(0)) {
+            return -1;
+        }
+        rxBuffer = sport->readAll();
+        rxPos    = 0;
+        if (rxBuffer.isEmpty()) {
+            return -1;
+        }
+    }
 
-    // TODO why the wait ? (gcs uploader dfu does not have it)
-    sport->waitForBytesWritten(1);
-    if (sport->bytesAvailable() || sport->waitForReadyRead(0)) {
-        sport->read(c, 1);
-        if (debug) {
-            if (((uint8_t)c[0]) == 0xe1 || rxDebugBuff.count() > 50) {
-                qDebug() << "PORT R " << rxDebugBuff.toHex();
-                rxDebugBuff.clear();
-            }
-            rxDebugBuff.append(c[0]);
+    char c = rxBuffer.at(rxPos++);
+    if (debug) {
+        if (((uint8_t)c) == 0xe1 || rxDebugBuff.count() > 50) {
+            qDebug() << "PORT R " << rxDebugBuff.toHex();
+            rxDebugBuff.clear();
         }
-    } else {
-        return -1;
+        rxDebugBuff.append(c);
     }
-    return (uint8_t)c[0];
+    return (uint8_t)c;
 }
 
 void port::pfSerialWrite(uint8_t c)
@@ -96,6 +108,16 @@ void port::pfSerialWrite(uint8_t c)
     sport->waitForBytesWritten(1);
 }
 
+void port::pfSerialWriteBuffer(const uint8_t *buf, uint16_t length)
+{
+    sport->write((const char *)buf, length);
+    if (debug) {
+        qDebug() << "PORT T " << QByteArray((const char *)buf, length).toHex();
+    }
+    // one wait per frame instead of one per byte
+    sport->waitForBytesWritten(1);
+}
+
 uint32_t port::pfGetTime(void)
 {
     return timer.elapsed();
@@ -49,6 +49,7 @@ public:
 
     virtual int16_t pfSerialRead(void); // function to read a character from the serial input stream
     virtual void pfSerialWrite(uint8_t); // function to write a byte to be sent out the serial port
+    virtual void pfSerialWriteBuffer(const uint8_t *, uint16_t); // function to write a whole frame
     virtual uint32_t pfGetTime(void);
 
     uint8_t retryCount; // how many times have we tried to transmit the 'send' packet
@@ -77,10 +78,17 @@ public:
     uint32_t TxError;
     uint16_t flags;
 
+protected:
+    // For ports that do their own I/O, nothing is opened
+    port(bool debug);
+
 private:
     portstatus mstatus;
     QTime timer;
     QSerialPort *sport;
+    // Everything available is read at once and handed out byte by byte
+    QByteArray rxBuffer;
+    int rxPos;
 
     bool debug;
     QByteArray rxDebugBuff;
@@ -44,6 +44,10 @@
 #define SEQNUM   1
 #define DATA     2
 
+// Largest escaped frame: SYNC plus every byte of a full packet escaped
+#define MAX_FRAME_LEN     (1 + 2 * (255 + 3))
+// An ACK carries at most the window capability
+#define MAX_ACK_DATA_LEN  2
 
 // Make larger sized integers from smaller sized integers
 #define MAKEWORD16(ub, lb)          ((uint16_t)0x0000 | ((uint16_t)(ub) << 8) | (uint16_t)(lb))
@@ -112,6 +116,18 @@ static const uint16_t CRC_TABLE[] = {
     0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
 };
 
+// Sequence numbers of data packets run 1..SSP_SEQ_COUNT and wrap to 1
+static uint8_t seqAdd(uint8_t seqNo, int n)
+{
+    return (seqNo - 1 + n) % SSP_SEQ_COUNT + 1;
+}
+
+// How far 'to' is ahead of 'from', 0..SSP_SEQ_COUNT - 1
+static int seqDiff(uint8_t from, uint8_t to)
+{
+    return (to - from + SSP_SEQ_COUNT) % SSP_SEQ_COUNT;
+}
+
 /** EXTERNAL DATA **/
 
 /** EXTERNAL FUNCTIONS **/
@@ -150,6 +166,39 @@ void qssp::ssp_Init(const PortConfig_t *const info)
     thisport->RxError = 0;
     thisport->txSeqNo = 0;
     thisport->rxSeqNo = 0;
+    sf_SetWindow(1);
+}
+
+/*!
+ * \brief   Sets the largest window offered and accepted at synchronisation
+ * \param   size = 1 for stop-and-wait, up to SSP_WINDOW_MAX
+ * \return  None.
+ *
+ * \note
+ * Takes effect with the next synchronisation.
+ */
+void qssp::ssp_SetMaxWindow(uint8_t size)
+{
+    maxWindow = qBound((uint8_t)1, size, (uint8_t)SSP_WINDOW_MAX);
+}
+
+/*!
+ * \brief   Starts over with the given window, drops anything sent or received ahead
+ * \param   size = negotiated window
+ * \return  None.
+ */
+void qssp::sf_SetWindow(uint8_t size)
+{
+    window          = size;
+    txBase          = 0;
+    txCount         = 0;
+    txNextSeqNo     = 1;
+    txAcked         = false;
+    rxExpectedSeqNo = 1;
+    for (int i = 0; i <= SSP_SEQ_COUNT; i++) {
+        rxHave[i] = false;
+        rxPending[i].clear();
+    }
 }
 
 /*!
@@ -167,6 +216,9 @@ int16_t qssp::ssp_SendProcess()
 {
     int16_t value = SSP_TX_WAITING;
 
+    if (window > 1 && thisport->SendState == SSP_IDLE) {
+        return sf_SendProcessWindowed();
+    }
     if (thisport->SendState == SSP_AWAITING_ACK) {
         if (sf_CheckTimeout() == TRUE) {
             if (thisport->retryCount < thisport->maxRetryCount) {
@@ -263,6 +315,10 @@ uint16_t qssp::ssp_SendDataBlock(uint8_t *data, uint16_t length)
     while (packet_status == SSP_TX_WAITING) { // check the status
         (void)ssp_ReceiveProcess(); // process any bytes received.
         packet_status = ssp_SendProcess(); // check the send status
+        if (packet_status == SSP_TX_ACKED && txCount > 0) {
+            // windowed, an earlier packet was acked
+            packet_status = SSP_TX_WAITING;
+        }
     }
     if (packet_status == SSP_TX_ACKED) { // figure out what happened to the packet
         retval = TRUE;
@@ -288,6 +344,9 @@ int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length)
 {
     int16_t value = SSP_TX_WAITING;
 
+    if (window > 1 && thisport->SendState == SSP_IDLE) {
+        return sf_SendWindowed(data, length);
+    }
     if ((length + 2) > thisport->txBufSize) {
         // TRYING to send too much data.
         value = SSP_TX_BUFOVERRUN;
@@ -364,10 +423,13 @@ uint16_t qssp::ssp_Synchronise()
     uint16_t retval = FALSE;
 
 #ifndef USE_SENDPACKET_DATA
+    // offer a window, peers that don't know about it ignore the data of a synch packet
+    uint8_t caps[] = { SSP_CAPS_WINDOW, maxWindow };
+    sf_SetWindow(1);
     thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
     SETBIT(thisport->flags, SENT_SYNCH);
     // TODO - should this be using ssp_SendPacketData()??
-    sf_MakePacket(thisport->txBuf, NULL, 0, thisport->txSeqNo); // construct the packet
+    sf_MakePacket(thisport->txBuf, caps, maxWindow > 1 ? sizeof(caps) : 0, thisport->txSeqNo); // construct the packet
     sf_SendPacket();
     sf_SetSendTimeout();
     thisport->SendState = SSP_AWAITING_ACK;
@@ -407,15 +469,181 @@ uint16_t qssp::ssp_Synchronise()
  */
 void qssp::sf_SendPacket()
 {
+    sf_SendFrame(thisport->txBuf);
+    thisport->retryCount++;
+}
+
+/*!
+ * \brief   escapes a preformatted packet and writes it out in one go
+ * \param   packet = packet formed by sf_MakePacket
+ * \return  none.
+ */
+void qssp::sf_SendFrame(const uint8_t *packet)
+{
+    uint8_t frame[MAX_FRAME_LEN];
+    uint16_t frameLen = 0;
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+    uint16_t packetLen = packet[LENGTH] + 3;
 
-    // use the raw serial write function so the SYNC byte does not get 'escaped'
-    thisport->pfSerialWrite(SYNC);
-    for (uint8_t x = 0; x < packetLen; x++) {
-        sf_write_byte(thisport->txBuf[x]);
+    // the SYNC byte does not get 'escaped'
+    frame[frameLen++] = SYNC;
+    for (uint16_t x = 0; x < packetLen; x++) {
+        uint8_t c = packet[x];
+        if (c == SYNC) {
+            frame[frameLen++] = ESC;
+            frame[frameLen++] = ESC_SYNC;
+        } else if (c == ESC) {
+            frame[frameLen++] = ESC;
+            frame[frameLen++] = ESC;
+        } else {
+            frame[frameLen++] = c;
+        }
     }
-    thisport->retryCount++;
+    thisport->pfSerialWriteBuffer(frame, frameLen);
+}
+
+/*!
+ * \brief   sends a data packet in the next free slot of the window
+ * \param	data = pointer to data to send
+ * \param	length = number of bytes to send
+ * \return	SSP_TX_BUFOVERRUN = tried to send too much data
+ * \return	SSP_TX_WAITING = data sent and waiting for an ack to arrive
+ * \return	SSP_TX_BUSY = the window is full
+ *
+ * \note
+ * Each packet keeps its own copy, timeout and retry count so only the lost ones are resent.
+ */
+int16_t qssp::sf_SendWindowed(const uint8_t *data, uint16_t length)
+{
+    if ((length + 2) > thisport->txBufSize) {
+        return SSP_TX_BUFOVERRUN;
+    }
+    if (txCount >= window) {
+        return SSP_TX_BUSY;
+    }
+
+    TxSlot &slot = txSlots[(txBase + txCount) % SSP_WINDOW_MAX];
+    slot.packet.resize(length + 4);
+    sf_MakePacket((uint8_t *)slot.packet.data(), data, length, txNextSeqNo);
+    slot.seqNo      = txNextSeqNo;
+    slot.acked      = false;
+    slot.retryCount = 1;
+    sf_SendFrame((const uint8_t *)slot.packet.constData());
+    slot.timeout    = thisport->pfGetTime() + thisport->timeoutLen;
+
+    txNextSeqNo     = seqAdd(txNextSeqNo, 1);
+    txCount++;
+    if (debug) {
+        qDebug() << "Sent DATA PACKET:" << slot.seqNo << "outstanding" << txCount;
+    }
+    return SSP_TX_WAITING;
+}
+
+/*!
+ * \brief   resends the packets of the window that timed out
+ * \return  SSP_TX_ACKED   - packets were acked since the last call
+ * \return  SSP_TX_WAITING - packets are waiting for their ACK
+ * \return  SSP_TX_TIMEOUT - a packet was not acked after retrying, the window is dropped
+ * \return  SSP_TX_IDLE    - nothing outstanding
+ */
+int16_t qssp::sf_SendProcessWindowed()
+{
+    uint32_t now = thisport->pfGetTime();
+
+    for (uint8_t i = 0; i < txCount; i++) {
+        TxSlot &slot = txSlots[(txBase + i) % SSP_WINDOW_MAX];
+        if (slot.acked || now <= slot.timeout) {
+            continue;
+        }
+        if (slot.retryCount >= thisport->maxRetryCount) {
+            // Give up, the peer can't be in sync anymore
+            if (debug) {
+                qDebug() << "Send TimeOut!" << slot.seqNo;
+            }
+            thisport->TxError++;
+            txCount = 0;
+            txAcked = false;
+            return SSP_TX_TIMEOUT;
+        }
+        sf_SendFrame((const uint8_t *)slot.packet.constData());
+        slot.retryCount++;
+        slot.timeout = now + thisport->timeoutLen;
+        if (debug) {
+            qDebug() << "Resent DATA PACKET:" << slot.seqNo;
+        }
+    }
+    if (txAcked) {
+        txAcked = false;
+        return SSP_TX_ACKED;
+    }
+    return txCount > 0 ? SSP_TX_WAITING : SSP_TX_IDLE;
+}
+
+/*!
+ * \brief   marks a packet of the window as acked and slides the window past the acked ones
+ * \param	seqNumber = acked sequence number
+ * \return  none.
+ */
+void qssp::sf_ReceiveAckWindowed(uint8_t seqNumber)
+{
+    if (txCount == 0) {
+        return;
+    }
+    int offset = seqDiff(txSlots[txBase].seqNo, seqNumber);
+    if (offset >= txCount) {
+        // duplicate of an ACK already processed
+        return;
+    }
+    txSlots[(txBase + offset) % SSP_WINDOW_MAX].acked = true;
+    while (txCount > 0 && txSlots[txBase].acked) {
+        txBase = (txBase + 1) % SSP_WINDOW_MAX;
+        txCount--;
+        txAcked = true;
+    }
+    if (debug) {
+        qDebug() << "Received ACK:" << seqNumber << "outstanding" << txCount;
+    }
+}
+
+/*!
+ * \brief   acks a data packet of the window and hands the received data over in order
+ * \param	seqNumber = received sequence number, the packet is in rxBuf
+ * \return  true = new packet
+ * \return	false = duplicate or out of the window
+ */
+int16_t qssp::sf_ReceiveDataWindowed(uint8_t seqNumber)
+{
+    int offset = seqDiff(rxExpectedSeqNo, seqNumber);
+
+    if (offset >= window) {
+        if (offset >= SSP_SEQ_COUNT - window) {
+            // Already delivered, our ACK was lost
+            sf_SendAckPacket(seqNumber);
+        }
+        return FALSE;
+    }
+
+    // The ACK does not use rxBuf, it can go before the data is handed over
+    sf_SendAckPacket(seqNumber);
+    if (offset > 0) {
+        // Ahead of a lost packet, hold it until the gap is filled
+        if (!rxHave[seqNumber]) {
+            rxPending[seqNumber] = QByteArray((const char *)&(thisport->rxBuf[DATA]), thisport->rxBufLen);
+            rxHave[seqNumber]    = true;
+        }
+        return TRUE;
+    }
+
+    pfCallBack(&(thisport->rxBuf[DATA]), thisport->rxBufLen);
+    rxExpectedSeqNo = seqAdd(rxExpectedSeqNo, 1);
+    while (rxHave[rxExpectedSeqNo]) {
+        QByteArray pending = rxPending[rxExpectedSeqNo];
+        rxHave[rxExpectedSeqNo] = false;
+        rxPending[rxExpectedSeqNo].clear();
+        pfCallBack((uint8_t *)pending.data(), pending.size());
+        rxExpectedSeqNo = seqAdd(rxExpectedSeqNo, 1);
+    }
+    return TRUE;
 }
 
 /*!
@@ -436,21 +664,17 @@ void qssp::sf_SendPacket()
  */
 void qssp::sf_MakePacket(uint8_t *txBuf, const uint8_t *pdata, uint16_t length, uint8_t seqNo)
 {
-    uint16_t crc    = 0xffff;
-    uint16_t bufPos = 0;
-    uint8_t b;
+    uint16_t crc;
+    uint16_t bufPos = DATA + length;
 
     // add 1 for the seq. number
     txBuf[LENGTH] = length + 1;
     txBuf[SEQNUM] = seqNo;
-    crc    = sf_crc16(crc, seqNo);
-
-    length = length + 2; // add two for the length and seqno bytes which are added before the loop.
-    for (bufPos = 2; bufPos < length; bufPos++) {
-        b   = *pdata++;
-        txBuf[bufPos] = b;
-        crc = sf_crc16(crc, b); // update CRC value
+    if (length > 0) {
+        memcpy(&txBuf[DATA], pdata, length);
     }
+    // seq. number and data
+    crc = sf_crc16_buffer(0xffff, &txBuf[SEQNUM], length + 1);
     txBuf[bufPos++] = LOWERBYTE(crc);
     txBuf[bufPos]   = UPPERBYTE(crc);
 }
@@ -465,13 +689,16 @@ void qssp::sf_MakePacket(uint8_t *txBuf, const uint8_t *pdata, uint16_t length,
  *
  */
 
-void qssp::sf_SendAckPacket(uint8_t seqNumber)
+void qssp::sf_SendAckPacket(uint8_t seqNumber, const uint8_t *pdata, uint16_t length)
 {
     uint8_t AckSeqNumber = SETBIT(seqNumber, ACK_BIT);
+    // not txBuf, it holds the packet that may have to be resent
+    uint8_t packet[DATA + MAX_ACK_DATA_LEN + 2];
 
+    Q_ASSERT(length <= MAX_ACK_DATA_LEN);
     // create the packet, note we pass AckSequenceNumber directly
-    sf_MakePacket(thisport->txBuf, NULL, 0, AckSeqNumber);
-    sf_SendPacket();
+    sf_MakePacket(packet, pdata, length, AckSeqNumber);
+    sf_SendFrame(packet);
     if (debug) {
         qDebug() << "Sent ACK PACKET:" << seqNumber;
     }
@@ -536,6 +763,29 @@ uint16_t qssp::sf_crc16(uint16_t crc, uint8_t data)
 #endif
 }
 
+/*!
+ * \brief   calculates the new CRC value for a buffer
+ * \param   crc = current CRC value
+ * \param	data = bytes to add
+ * \param	length = number of bytes
+ * \return  updated CRC value
+ */
+uint16_t qssp::sf_crc16_buffer(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    const uint8_t *end = data + length;
+
+#ifdef SPP_USES_CRC
+    while (data < end) {
+        crc = (crc >> 8) ^ CRC_TABLE[(crc ^ *data++) & 0x00FF];
+    }
+#else
+    while (data < end) {
+        crc = sf_crc16(crc, *data++);
+    }
+#endif
+    return crc;
+}
+
 /*!
  * \brief   sets the timeout for the given packet
  * \param   thisport = which port to use
@@ -652,6 +902,7 @@ int16_t qssp::sf_ReceiveState(uint8_t c)
 int16_t qssp::sf_DecodeState(uint8_t c)
 {
     int16_t retval;
+    uint16_t crc;
 
     switch (thisport->decodeState) {
     case decode_idle_e:
@@ -678,11 +929,9 @@ int16_t qssp::sf_DecodeState(uint8_t c)
         break;
     case decode_seqNo_e:
         thisport->rxBuf[SEQNUM] = c;
-        thisport->crc = 0xffff;
         thisport->rxBufLen--; // subtract 1 for the seq. no.
         thisport->rxBufPos = 2;
 
-        thisport->crc = sf_crc16(thisport->crc, c);
         if (thisport->rxBufLen > 0) {
             thisport->decodeState = decode_data_e;
         } else {
@@ -692,21 +941,23 @@ int16_t qssp::sf_DecodeState(uint8_t c)
         break;
     case decode_data_e:
         thisport->rxBuf[(thisport->rxBufPos)++] = c;
-        thisport->crc = sf_crc16(thisport->crc, c);
         if (thisport->rxBufPos == (thisport->rxBufLen + 2)) {
             thisport->decodeState = decode_crc1_e;
         }
         retval = SSP_RX_RECEIVING;
         break;
     case decode_crc1_e:
-        thisport->crc = sf_crc16(thisport->crc, c);
+        // keep the low byte, the CRC is checked over the whole packet with the high byte
+        thisport->crc = c;
         thisport->decodeState = decode_crc2_e;
         retval = SSP_RX_RECEIVING;
         break;
     case decode_crc2_e:
         thisport->decodeState = decode_idle_e;
-        // verify the CRC value for the packet
-        if (sf_crc16(thisport->crc, c) == 0) {
+        // verify the CRC value for the packet, seq. number, data and both CRC bytes
+        crc = sf_crc16_buffer(0xffff, &(thisport->rxBuf[SEQNUM]), thisport->rxBufLen + 1);
+        crc = sf_crc16(crc, (uint8_t)thisport->crc);
+        if (sf_crc16(crc, c) == 0) {
             // TODO shouldn't the return value of sf_ReceivePacket() be checked?
             sf_ReceivePacket();
             retval = SSP_RX_COMPLETE;
@@ -752,8 +1003,26 @@ int16_t qssp::sf_ReceivePacket()
     int16_t value = FALSE;
 
     if (ISBITSET(thisport->rxBuf[SEQNUM], ACK_BIT)) {
+        uint8_t ackSeqNo = thisport->rxBuf[SEQNUM] & 0x7F;
+        if (window > 1 && thisport->SendState == SSP_IDLE) {
+            if (ackSeqNo != 0) {
+                sf_ReceiveAckWindowed(ackSeqNo);
+            }
+            return FALSE;
+        }
         // Received an ACK packet, need to check if it matches the previous sent packet
-        if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
+        if (ackSeqNo == (thisport->txSeqNo & 0x7f)) {
+            if (ackSeqNo == 0) {
+                // ACK of our synch request, a peer that takes the window sends back the size it accepts
+                if (thisport->rxBufLen >= 2 && thisport->rxBuf[DATA] == SSP_CAPS_WINDOW) {
+                    sf_SetWindow(qBound((uint8_t)1, thisport->rxBuf[DATA + 1], maxWindow));
+                } else {
+                    sf_SetWindow(1);
+                }
+                if (debug) {
+                    qDebug() << "Synchronised, window" << window;
+                }
+            }
             // It matches the last packet sent by us
             SETBIT(thisport->txSeqNo, ACK_BIT);
             thisport->SendState = SSP_ACKED;
@@ -773,9 +1042,19 @@ int16_t qssp::sf_ReceivePacket()
 #ifdef ACTIVE_SYNCH
             thisport->sendSynch = TRUE;
 #endif
-            sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
+            if (maxWindow > 1 && thisport->rxBufLen >= 2 && thisport->rxBuf[DATA] == SSP_CAPS_WINDOW) {
+                // take the smaller of both windows
+                uint8_t caps[] = { SSP_CAPS_WINDOW, qBound((uint8_t)1, thisport->rxBuf[DATA + 1], maxWindow) };
+                sf_SetWindow(caps[1]);
+                sf_SendAckPacket(thisport->rxBuf[SEQNUM], caps, sizeof(caps));
+            } else {
+                sf_SetWindow(1);
+                sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
+            }
             thisport->rxSeqNo   = 0;
             value = FALSE;
+        } else if (window > 1) {
+            value = sf_ReceiveDataWindowed(thisport->rxBuf[SEQNUM]);
         } else if (thisport->rxBuf[SEQNUM] == thisport->rxSeqNo) {
             // Already seen this packet, just ack it, don't act on the packet.
             sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
@@ -801,7 +1080,7 @@ int16_t qssp::sf_ReceivePacket()
     return value;
 }
 
-qssp::qssp(port *info, bool debug) : debug(debug)
+qssp::qssp(port *info, bool debug) : debug(debug), maxWindow(1)
 {
     thisport = info;
     thisport->maxRetryCount = info->max_retry;
@@ -821,6 +1100,7 @@ qssp::qssp(port *info, bool debug) : debug(debug)
     thisport->RxError = 0;
     thisport->txSeqNo = 0;
     thisport->rxSeqNo = 0;
+    sf_SetWindow(1);
 }
 
 void qssp::pfCallBack(uint8_t *buf, uint16_t size)
@@ -31,6 +31,8 @@
 #include "common.h"
 #include "port.h"
 
+#include <QByteArray>
+
 #include <stdint.h>
 
 /** LOCAL DEFINITIONS **/
@@ -61,6 +63,13 @@
 #define SSP_RX_ACK        6
 #define SSP_RX_SYNCH      7
 
+// Sliding window, offered in the SYNC packet as SSP_CAPS_WINDOW followed by the
+// window size and accepted when the ACK of the SYNC carries them back. A peer
+// that does not know about it sends a plain ACK and stop-and-wait is used.
+#define SSP_CAPS_WINDOW   'W'
+#define SSP_WINDOW_MAX    32
+#define SSP_SEQ_COUNT     127 // sequence numbers 1..127, 0 is the SYNC
+
 typedef struct {
     uint8_t  *pbuff;
     uint16_t length;
@@ -87,8 +96,31 @@ private:
     port *thisport;
     bool debug;
 
+    // Stop-and-wait when 1
+    uint8_t maxWindow;
+    uint8_t window;
+
+    struct TxSlot {
+        QByteArray packet;
+        uint8_t seqNo;
+        bool acked;
+        uint8_t retryCount;
+        uint32_t timeout;
+    };
+    // Sent and not yet acked, oldest at txBase
+    TxSlot txSlots[SSP_WINDOW_MAX];
+    uint8_t txBase;
+    uint8_t txCount;
+    uint8_t txNextSeqNo;
+    bool txAcked;
+    // Received ahead of rxExpectedSeqNo, indexed by sequence number
+    QByteArray rxPending[SSP_SEQ_COUNT + 1];
+    bool rxHave[SSP_SEQ_COUNT + 1];
+    uint8_t rxExpectedSeqNo;
+
     // static void      sf_SendSynchPacket( Port_t *thisport );
     uint16_t    sf_crc16(uint16_t crc, uint8_t data);
+    uint16_t    sf_crc16_buffer(uint16_t crc, const uint8_t *data, uint16_t length);
     void        sf_write_byte(uint8_t c);
     void        sf_SetSendTimeout();
     uint16_t    sf_CheckTimeout();
@@ -96,11 +128,18 @@ private:
     int16_t     sf_ReceiveState(uint8_t c);
 
     void        sf_SendPacket();
-    void        sf_SendAckPacket(uint8_t seqNumber);
+    void        sf_SendFrame(const uint8_t *packet);
+    void        sf_SendAckPacket(uint8_t seqNumber, const uint8_t *pdata = NULL, uint16_t length = 0);
     void        sf_MakePacket(uint8_t *buf, const uint8_t *pdata, uint16_t length, uint8_t seqNo);
     int16_t     sf_ReceivePacket();
     uint16_t    ssp_SendDataBlock(uint8_t *data, uint16_t length);
 
+    void        sf_SetWindow(uint8_t size);
+    int16_t     sf_SendWindowed(const uint8_t *data, uint16_t length);
+    int16_t     sf_SendProcessWindowed();
+    void        sf_ReceiveAckWindowed(uint8_t seqNumber);
+    int16_t     sf_ReceiveDataWindowed(uint8_t seqNumber);
+
 public:
     qssp(port *info, bool debug);
 
@@ -112,6 +151,22 @@ public:
     int16_t     ssp_ReceiveByte();
     uint16_t    ssp_Synchronise();
 
+    // Largest window offered by ssp_Synchronise() and accepted from a peer, 1 for stop-and-wait
+    void        ssp_SetMaxWindow(uint8_t size);
+    // Negotiated by the last synchronisation
+    uint8_t ssp_Window() const
+    {
+        return window;
+    }
+    bool ssp_WindowFull() const
+    {
+        return txCount >= window;
+    }
+    uint8_t ssp_Outstanding() const
+    {
+        return txCount;
+    }
+
     virtual void pfCallBack(uint8_t *, uint16_t); // call back function that is called when a full packet has been received
 };
 
@@ -28,8 +28,10 @@
 #include "qsspt.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 
-qsspt::qsspt(port *info, bool debug) : qssp(info, debug), endthread(false), datapending(false), debug(debug)
+qsspt::qsspt(port *info, bool debug) : qssp(info, debug), endthread(false), datapending(false),
+    inflight(0), sendfailed(false), debug(debug)
 {}
 
 qsspt::~qsspt()
@@ -46,7 +48,21 @@ void qsspt::run()
         receivestatus = ssp_ReceiveProcess();
         sendstatus    = ssp_SendProcess();
         sendbufmutex.lock();
-        if (datapending && receivestatus == SSP_TX_IDLE) {
+        if (ssp_Window() > 1) {
+            if (sendstatus == SSP_TX_TIMEOUT) {
+                // the window was dropped, fail the next sendData() or flush()
+                sendfailed = true;
+                txqueue.clear();
+            }
+            while (!txqueue.isEmpty() && !ssp_WindowFull()) {
+                QByteArray data = txqueue.dequeue();
+                ssp_SendData((const uint8_t *)data.constData(), data.size());
+            }
+            inflight = txqueue.size() + ssp_Outstanding();
+            if (sendstatus == SSP_TX_ACKED || sendstatus == SSP_TX_TIMEOUT) {
+                windowwait.wakeAll();
+            }
+        } else if (datapending && receivestatus == SSP_TX_IDLE) {
             ssp_SendData(mbuf, msize);
             datapending = false;
         }
@@ -63,6 +79,21 @@ bool qsspt::sendData(uint8_t *buf, uint16_t size)
         QByteArray data((const char *)buf, size);
         qDebug() << "SSP TX " << data.toHex();
     }
+    if (ssp_Window() > 1) {
+        QMutexLocker locker(&sendbufmutex);
+        while (!sendfailed && inflight >= ssp_Window()) {
+            if (!windowwait.wait(&sendbufmutex, 10000)) {
+                return false;
+            }
+        }
+        if (sendfailed) {
+            sendfailed = false;
+            return false;
+        }
+        txqueue.enqueue(QByteArray((const char *)buf, size));
+        inflight++;
+        return true;
+    }
     if (datapending) {
         return false;
     }
@@ -79,6 +110,25 @@ bool qsspt::sendData(uint8_t *buf, uint16_t size)
     return true;
 }
 
+bool qsspt::flush(int timeoutMs)
+{
+    QMutexLocker locker(&sendbufmutex);
+    QElapsedTimer timer;
+
+    timer.start();
+    while (!sendfailed && inflight > 0) {
+        int remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0 || !windowwait.wait(&sendbufmutex, remaining)) {
+            return false;
+        }
+    }
+    if (sendfailed) {
+        sendfailed = false;
+        return false;
+    }
+    return true;
+}
+
 void qsspt::pfCallBack(uint8_t *buf, uint16_t size)
 {
     if (debug) {
@@ -45,6 +45,8 @@ public:
     int packets_Available();
     int read_Packet(void *);
     bool sendData(uint8_t *buf, uint16_t size);
+    // Waits until everything sent is acked, false if a packet was not
+    bool flush(int timeoutMs = 10000);
 
 private:
     uint8_t *mbuf;
@@ -58,6 +60,11 @@ private:
     uint16_t receivestatus;
     QWaitCondition sendwait;
     QMutex msendwait;
+    // Windowed mode, sendData() only waits for room in the window
+    QQueue<QByteArray> txqueue;
+    int inflight;
+    bool sendfailed;
+    QWaitCondition windowwait;
     bool debug;
 
     virtual void pfCallBack(uint8_t *, uint16_t);
@@ -68,6 +68,7 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
             return;
         }
         serialhandle = new qsspt(info, false /*debug*/);
+        serialhandle->ssp_SetMaxWindow(SSP_DFU_WINDOW);
 
         int count = 0;
         while (!serialhandle->ssp_Synchronise() && (count < 10)) {
@@ -81,6 +82,9 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
             qDebug() << "SYNC failed";
             return;
         }
+        if (debug) {
+            qDebug() << "SSP window" << serialhandle->ssp_Window();
+        }
 
         // transfer ownership of port to serialhandle thread
         info->moveToThread(serialhandle);
@@ -309,6 +313,10 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
         // qDebug() << "UPLOAD:" << "Data=" << (int)buf[6] << (int)buf[7] << (int)buf[8] << (int)buf[9] << ";" << result << " bytes sent";
         // }
     }
+    // windowed serial returns before the packets are acked
+    if (use_serial && !serialhandle->flush()) {
+        return false;
+    }
     return true;
 }
 
@@ -38,6 +38,8 @@
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
 
 #define BUF_LEN             64
+// Packets in flight over serial when the bootloader supports it
+#define SSP_DFU_WINDOW      16
 
 // serial
 class qsspt;
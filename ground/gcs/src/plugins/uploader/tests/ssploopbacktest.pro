@@ -0,0 +1,35 @@
+#
+# SSP serial bootloader transport against a bootloader stand-in on a pseudo terminal
+# Checks the window negotiation and in order delivery with frame loss, and prints
+# the upload throughput of stop-and-wait and windowed mode at several baud rates
+# and latencies. Needs openpty, unix only.
+#
+
+include(../../../../gcs.pri)
+
+CONFIG += qtestlib testcase console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = ssploopbacktest
+
+QT = core serialport testlib
+
+SSP_DIR = $$GCS_SOURCE_TREE/src/plugins/uploader/SSP
+
+INCLUDEPATH += $$SSP_DIR
+
+HEADERS += \
+    sspstandin.h \
+    $$SSP_DIR/port.h \
+    $$SSP_DIR/qssp.h \
+    $$SSP_DIR/qsspt.h \
+    $$SSP_DIR/common.h
+
+SOURCES += \
+    tst_ssploopback.cpp \
+    sspstandin.cpp \
+    $$SSP_DIR/port.cpp \
+    $$SSP_DIR/qssp.cpp \
+    $$SSP_DIR/qsspt.cpp
+
+!macx:LIBS += -lutil
@@ -0,0 +1,241 @@
+/**
+ ******************************************************************************
+ *
+ * @file       sspstandin.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Serial bootloader stand-in on a pseudo terminal
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sspstandin.h"
+#include "qssp.h"
+
+#include <QDebug>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#ifdef Q_OS_MAC
+#include <util.h>
+#else
+#include <pty.h>
+#endif
+
+#define SYNC           225
+#define MAX_PACKET_LEN (1 + 1 + 255 + 2)
+
+LoopbackPort::LoopbackPort(int fd, const SspLink &link, quint32 seed) : port(false),
+    m_fd(fd),
+    m_link(link),
+    m_random(seed),
+    m_rxLineFree(0),
+    m_txLineFree(0),
+    m_rxPos(0)
+{
+    m_clock.start();
+}
+
+qint64 LoopbackPort::nowUs() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
+
+// 8N1, 10 bits per byte
+qint64 LoopbackPort::wireUs(int bytes) const
+{
+    return (qint64)bytes * 10 * 1000000 / m_link.baud;
+}
+
+bool LoopbackPort::lost()
+{
+    return m_link.loss > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(m_random) < m_link.loss;
+}
+
+void LoopbackPort::pump()
+{
+    qint64 now = nowUs();
+    char buf[4096];
+    ssize_t n;
+
+    // From the host, delivered once on the wire and through the latency
+    while ((n = ::read(m_fd, buf, sizeof(buf))) > 0) {
+        Chunk chunk;
+        for (ssize_t i = 0; i < n; i++) {
+            if ((uint8_t)buf[i] == SYNC && lost()) {
+                continue;
+            }
+            chunk.data.append(buf[i]);
+        }
+        m_rxLineFree = qMax(now, m_rxLineFree) + wireUs(n);
+        chunk.dueUs  = m_rxLineFree + m_link.latencyMs * 1000;
+        m_rx.enqueue(chunk);
+    }
+
+    // To the host
+    while (!m_tx.isEmpty() && m_tx.head().dueUs <= now) {
+        QByteArray &data = m_tx.head().data;
+        n = ::write(m_fd, data.constData(), data.size());
+        if (n < 0) {
+            if (errno != EAGAIN) {
+                qWarning() << "LoopbackPort - write failed" << errno;
+                m_tx.clear();
+            }
+            break;
+        }
+        data.remove(0, n);
+        if (!data.isEmpty()) {
+            break;
+        }
+        m_tx.dequeue();
+    }
+}
+
+int16_t LoopbackPort::pfSerialRead(void)
+{
+    while (m_rxPos >= m_rxReady.size()) {
+        if (m_rx.isEmpty() || m_rx.head().dueUs > nowUs()) {
+            return -1;
+        }
+        m_rxReady = m_rx.dequeue().data;
+        m_rxPos   = 0;
+    }
+    return (uint8_t)m_rxReady.at(m_rxPos++);
+}
+
+void LoopbackPort::pfSerialWrite(uint8_t c)
+{
+    pfSerialWriteBuffer(&c, 1);
+}
+
+void LoopbackPort::pfSerialWriteBuffer(const uint8_t *buf, uint16_t length)
+{
+    // Whole frames, dropped frames still take their time on the wire
+    m_txLineFree = qMax(nowUs(), m_txLineFree) + wireUs(length);
+    if (lost()) {
+        return;
+    }
+    Chunk chunk;
+    chunk.dueUs = m_txLineFree + m_link.latencyMs * 1000;
+    chunk.data  = QByteArray((const char *)buf, length);
+    m_tx.enqueue(chunk);
+}
+
+uint32_t LoopbackPort::pfGetTime(void)
+{
+    return m_clock.elapsed();
+}
+
+/**
+ * SSP of the bootloader, hands the received packets to the stand-in
+ */
+class BootloaderSsp : public qssp {
+public:
+    BootloaderSsp(port *info, SspStandIn *standIn) : qssp(info, false), m_standIn(standIn)
+    {}
+
+    void pfCallBack(uint8_t *buf, uint16_t size)
+    {
+        m_standIn->received(buf, size);
+    }
+
+private:
+    SspStandIn *m_standIn;
+};
+
+SspStandIn::SspStandIn(uint8_t maxWindow, const SspLink &link, quint32 seed) :
+    m_maxWindow(maxWindow),
+    m_link(link),
+    m_seed(seed),
+    m_master(-1),
+    m_slave(-1),
+    m_stop(0)
+{}
+
+SspStandIn::~SspStandIn()
+{
+    stop();
+    if (m_master >= 0) {
+        ::close(m_master);
+    }
+    if (m_slave >= 0) {
+        ::close(m_slave);
+    }
+}
+
+bool SspStandIn::open()
+{
+    struct termios tio;
+
+    if (::openpty(&m_master, &m_slave, NULL, NULL, NULL) != 0) {
+        qWarning() << "SspStandIn - openpty failed" << errno;
+        return false;
+    }
+    // The slave stays open so the host can close and reopen it
+    ::tcgetattr(m_slave, &tio);
+    ::cfmakeraw(&tio);
+    ::tcsetattr(m_slave, TCSANOW, &tio);
+    ::fcntl(m_master, F_SETFL, ::fcntl(m_master, F_GETFL) | O_NONBLOCK);
+    m_portName = QString::fromLocal8Bit(::ttyname(m_slave));
+    return true;
+}
+
+void SspStandIn::stop()
+{
+    m_stop.store(1);
+    wait();
+}
+
+QByteArray SspStandIn::received() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_received;
+}
+
+void SspStandIn::received(const uint8_t *buf, uint16_t size)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_received.append((const char *)buf, size);
+}
+
+void SspStandIn::run()
+{
+    uint8_t rxBuf[MAX_PACKET_LEN];
+    uint8_t txBuf[MAX_PACKET_LEN];
+    LoopbackPort loopback(m_master, m_link, m_seed);
+
+    loopback.rxBuf      = rxBuf;
+    loopback.rxBufSize  = 255;
+    loopback.txBuf      = txBuf;
+    loopback.txBufSize  = 255;
+    loopback.max_retry  = 10;
+    loopback.timeoutLen = 1000;
+
+    BootloaderSsp ssp(&loopback, this);
+    ssp.ssp_SetMaxWindow(m_maxWindow);
+
+    while (!m_stop.load()) {
+        loopback.pump();
+        ssp.ssp_ReceiveProcess();
+        ssp.ssp_SendProcess();
+        loopback.pump();
+        QThread::usleep(50);
+    }
+}
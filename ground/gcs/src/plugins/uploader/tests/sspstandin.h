@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ *
+ * @file       sspstandin.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Serial bootloader stand-in on a pseudo terminal
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SSPSTANDIN_H
+#define SSPSTANDIN_H
+
+#include "port.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QQueue>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+#include <random>
+
+struct SspLink {
+    int baud;
+    // One way
+    int latencyMs;
+    // Probability of losing a frame in each direction
+    double loss;
+};
+
+/**
+ * Bootloader end of the link, on the master side of a pseudo terminal.
+ *
+ * Bytes written by the host are held back for the time they take on the wire at
+ * the link baud rate plus the latency, and so are the frames written back.
+ * A frame is lost by dropping its SYNC byte.
+ */
+class LoopbackPort : public port {
+public:
+    LoopbackPort(int fd, const SspLink &link, quint32 seed);
+
+    int16_t pfSerialRead(void);
+    void pfSerialWrite(uint8_t c);
+    void pfSerialWriteBuffer(const uint8_t *buf, uint16_t length);
+    uint32_t pfGetTime(void);
+
+    // Moves bytes between the pseudo terminal and the delay lines
+    void pump();
+
+private:
+    struct Chunk {
+        qint64 dueUs;
+        QByteArray data;
+    };
+
+    int m_fd;
+    SspLink m_link;
+    QElapsedTimer m_clock;
+    std::mt19937 m_random;
+
+    QQueue<Chunk> m_rx;
+    QQueue<Chunk> m_tx;
+    qint64 m_rxLineFree;
+    qint64 m_txLineFree;
+    QByteArray m_rxReady;
+    int m_rxPos;
+
+    qint64 nowUs() const;
+    qint64 wireUs(int bytes) const;
+    bool lost();
+};
+
+/**
+ * Runs the bootloader side of SSP in its own thread and collects what it receives.
+ * A stand-in with a window of 1 answers like the bootloaders in the field.
+ */
+class SspStandIn : public QThread {
+public:
+    SspStandIn(uint8_t maxWindow, const SspLink &link, quint32 seed = 1);
+    ~SspStandIn();
+
+    // Creates the pseudo terminal, the host opens portName()
+    bool open();
+    QString portName() const
+    {
+        return m_portName;
+    }
+
+    void stop();
+
+    QByteArray received() const;
+    void received(const uint8_t *buf, uint16_t size);
+
+protected:
+    void run();
+
+private:
+    uint8_t m_maxWindow;
+    SspLink m_link;
+    quint32 m_seed;
+    int m_master;
+    int m_slave;
+    QString m_portName;
+    QAtomicInt m_stop;
+
+    mutable QMutex m_mutex;
+    QByteArray m_received;
+};
+
+#endif // SSPSTANDIN_H
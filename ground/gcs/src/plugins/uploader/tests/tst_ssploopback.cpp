@@ -0,0 +1,262 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_ssploopback.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      SSP serial bootloader transport against a stand-in on a pseudo terminal
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sspstandin.h"
+#include "qsspt.h"
+
+#include <QtTest/QtTest>
+
+#define MAX_PACKET_LEN (1 + 1 + 255 + 2)
+// As the DFU upload, 64 byte reports without the report id
+#define PACKET_LEN     63
+#define DFU_WINDOW     16
+
+Q_DECLARE_METATYPE(uint8_t)
+
+/**
+ * Host end, set up the way DFUObject does
+ */
+class SspHost {
+public:
+    SspHost() : info(NULL), ssp(NULL)
+    {}
+
+    ~SspHost()
+    {
+        delete ssp;
+        delete info;
+    }
+
+    bool open(const QString &portName, uint8_t maxWindow, int timeoutLen)
+    {
+        info = new port(portName, false);
+        info->rxBuf      = rxBuf;
+        info->rxBufSize  = 255;
+        info->txBuf      = txBuf;
+        info->txBufSize  = 255;
+        info->max_retry  = 10;
+        info->timeoutLen = timeoutLen;
+        if (info->status() != port::open) {
+            return false;
+        }
+
+        ssp = new qsspt(info, false);
+        ssp->ssp_SetMaxWindow(maxWindow);
+        int count = 0;
+        while (!ssp->ssp_Synchronise() && count < 10) {
+            count++;
+        }
+        if (count == 10) {
+            return false;
+        }
+        // The port stays in this thread, nothing here runs an event loop
+        ssp->start();
+        return true;
+    }
+
+    port *info;
+    qsspt *ssp;
+
+private:
+    uint8_t rxBuf[MAX_PACKET_LEN];
+    uint8_t txBuf[MAX_PACKET_LEN];
+};
+
+class tst_SspLoopback : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void negotiation_data();
+    void negotiation();
+    void transfer_data();
+    void transfer();
+    void throughput_data();
+    void throughput();
+
+private:
+    static QByteArray image(int packets);
+    static double upload(const QByteArray &data, SspHost &host, SspStandIn &standIn);
+    static double bytesPerSecond(uint8_t standInWindow, const SspLink &link, const QByteArray &data);
+};
+
+void tst_SspLoopback::initTestCase()
+{
+    qsrand(1);
+}
+
+QByteArray tst_SspLoopback::image(int packets)
+{
+    QByteArray data;
+
+    for (int i = 0; i < packets * PACKET_LEN; i++) {
+        data.append((char)(qrand() & 0xff));
+    }
+    return data;
+}
+
+/**
+ * Sends the data as the DFU upload does, seconds until the last packet is acked
+ * or -1 if the transfer failed
+ */
+double tst_SspLoopback::upload(const QByteArray &data, SspHost &host, SspStandIn &standIn)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int pos = 0; pos < data.size(); pos += PACKET_LEN) {
+        int size = qMin(PACKET_LEN, data.size() - pos);
+        if (!host.ssp->sendData((uint8_t *)data.constData() + pos, size)) {
+            return -1;
+        }
+    }
+    if (!host.ssp->flush()) {
+        return -1;
+    }
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    // Delivered before acked, this only guards against a lost ACK ending stop-and-wait early
+    for (int i = 0; i < 100 && standIn.received().size() < data.size(); i++) {
+        QThread::msleep(10);
+    }
+    return standIn.received() == data ? seconds : -1;
+}
+
+double tst_SspLoopback::bytesPerSecond(uint8_t standInWindow, const SspLink &link, const QByteArray &data)
+{
+    SspStandIn standIn(standInWindow, link);
+    SspHost host;
+
+    if (!standIn.open()) {
+        return -1;
+    }
+    standIn.start();
+    if (!host.open(standIn.portName(), DFU_WINDOW, 1000)) {
+        return -1;
+    }
+    double seconds = upload(data, host, standIn);
+    return seconds > 0 ? data.size() / seconds : -1;
+}
+
+void tst_SspLoopback::negotiation_data()
+{
+    QTest::addColumn<uint8_t>("standInWindow");
+    QTest::addColumn<uint8_t>("hostWindow");
+    QTest::addColumn<uint8_t>("window");
+
+    QTest::newRow("both windowed") << (uint8_t)16 << (uint8_t)16 << (uint8_t)16;
+    QTest::newRow("smaller bootloader window") << (uint8_t)8 << (uint8_t)16 << (uint8_t)8;
+    QTest::newRow("legacy bootloader") << (uint8_t)1 << (uint8_t)16 << (uint8_t)1;
+    QTest::newRow("legacy host") << (uint8_t)16 << (uint8_t)1 << (uint8_t)1;
+}
+
+void tst_SspLoopback::negotiation()
+{
+    QFETCH(uint8_t, standInWindow);
+    QFETCH(uint8_t, hostWindow);
+    QFETCH(uint8_t, window);
+
+    SspLink link = { 115200, 1, 0.0 };
+    SspStandIn standIn(standInWindow, link);
+    SspHost host;
+
+    QVERIFY(standIn.open());
+    standIn.start();
+    QVERIFY(host.open(standIn.portName(), hostWindow, 1000));
+    QCOMPARE(host.ssp->ssp_Window(), window);
+    QVERIFY(upload(image(8), host, standIn) > 0);
+}
+
+void tst_SspLoopback::transfer_data()
+{
+    QTest::addColumn<uint8_t>("window");
+    QTest::addColumn<double>("loss");
+
+    QTest::newRow("stop-and-wait") << (uint8_t)1 << 0.0;
+    QTest::newRow("stop-and-wait, 5% loss") << (uint8_t)1 << 0.05;
+    QTest::newRow("windowed") << (uint8_t)16 << 0.0;
+    QTest::newRow("windowed, 5% loss") << (uint8_t)16 << 0.05;
+    QTest::newRow("windowed, 10% loss") << (uint8_t)16 << 0.1;
+}
+
+void tst_SspLoopback::transfer()
+{
+    QFETCH(uint8_t, window);
+    QFETCH(double, loss);
+
+    SspLink link = { 230400, 5, loss };
+    SspStandIn standIn(window, link, 7);
+    SspHost host;
+
+    QVERIFY(standIn.open());
+    standIn.start();
+    // Short timeout, every loss costs one
+    QVERIFY(host.open(standIn.portName(), window, 100));
+    QCOMPARE(host.ssp->ssp_Window(), window);
+
+    QByteArray data = image(150);
+    QVERIFY(upload(data, host, standIn) > 0);
+}
+
+void tst_SspLoopback::throughput_data()
+{
+    QTest::addColumn<int>("baud");
+    QTest::addColumn<int>("latency");
+
+    foreach(int baud, QList<int>() << 57600 << 115200 << 230400) {
+        foreach(int latency, QList<int>() << 0 << 10 << 50) {
+            QTest::newRow(qPrintable(QString("%1 baud, %2 ms").arg(baud).arg(latency))) << baud << latency;
+        }
+    }
+}
+
+/**
+ * Upload throughput of stop-and-wait against the legacy stand-in and of the
+ * window of the DFU upload, printed by the test
+ */
+void tst_SspLoopback::throughput()
+{
+    QFETCH(int, baud);
+    QFETCH(int, latency);
+
+    SspLink link    = { baud, latency, 0.0 };
+    QByteArray data = image(48);
+
+    double legacy   = bytesPerSecond(1, link, data);
+    double windowed = bytesPerSecond(DFU_WINDOW, link, data);
+
+    qDebug() << baud << "baud," << latency << "ms latency: stop-and-wait" << (int)legacy << "B/s, windowed" << (int)windowed
+             << "B/s, line" << baud / 10 << "B/s";
+
+    QVERIFY(legacy > 0);
+    QVERIFY(windowed > 0);
+    QVERIFY(windowed * 1.1 > legacy);
+    if (latency >= 10) {
+        QVERIFY(windowed > 2 * legacy);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_SspLoopback)
+
+#include "tst_ssploopback.moc"
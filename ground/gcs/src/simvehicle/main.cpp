@@ -0,0 +1,184 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Simulated vehicle entry point
+ *
+ * Usage: librepilot-simvehicle [-n count] [--port base | --pty] [--latency ms] [--loss percent] ...
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "simfleet.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThread>
+#include <QDebug>
+
+#include <climits>
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <signal.h>
+#include <unistd.h>
+
+static int signalPipe[2];
+
+static void signalHandler(int)
+{
+    char c = 1;
+
+    // Only async signal safe calls here, the notifier quits the event loop
+    if (::write(signalPipe[1], &c, sizeof(c)) < 0) {}
+}
+
+static void setupSignalHandlers()
+{
+    if (::pipe(signalPipe) != 0) {
+        qWarning() << "Couldn't create signal pipe";
+        return;
+    }
+
+    QSocketNotifier *notifier = new QSocketNotifier(signalPipe[0], QSocketNotifier::Read, qApp);
+    QObject::connect(notifier, &QSocketNotifier::activated, qApp, &QCoreApplication::quit);
+
+    struct sigaction action;
+    action.sa_handler = signalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags   = SA_RESTART;
+    sigaction(SIGINT, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+}
+#endif // Q_OS_UNIX
+
+static bool intValue(const QCommandLineParser &parser, const QCommandLineOption &option, int min, int max, int *value)
+{
+    if (!parser.isSet(option)) {
+        return true;
+    }
+    bool ok;
+    // Base 0 accepts the board types in hex
+    int res = parser.value(option).toInt(&ok, 0);
+    if (!ok || res < min || res > max) {
+        qCritical() << "Invalid value for" << option.names().last() << ":" << parser.value(option);
+        return false;
+    }
+    *value = res;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName(GCS_BIG_NAME " Simulated Vehicle");
+    QCoreApplication::setOrganizationName(ORG_BIG_NAME);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulated vehicles answering the GCS telemetry, for load and regression testing");
+    parser.addHelpOption();
+    QCommandLineOption countOption(QStringList() << "n" << "count", "Number of vehicles.", "count", "1");
+    QCommandLineOption portOption("port", "First TCP port, vehicle i listens on port + i.", "port", "9000");
+    QCommandLineOption ptyOption("pty", "Use pseudo terminals instead of TCP ports.");
+    QCommandLineOption latencyOption("latency", "One way link latency.", "ms", "0");
+    QCommandLineOption jitterOption("jitter", "Random extra latency, up to.", "ms", "0");
+    QCommandLineOption bandwidthOption("bandwidth", "Link bandwidth in each direction, 0 for unlimited.", "bytes/s", "0");
+    QCommandLineOption lossOption("loss", "Frame loss in each direction.", "percent", "0");
+    QCommandLineOption persistOption("persist", "Directory for the saved settings, in memory if not set.", "dir");
+    QCommandLineOption threadsOption("threads", "Worker threads shared by the vehicles.", "threads", QString::number(QThread::idealThreadCount()));
+    QCommandLineOption seedOption("seed", "Seed of the link impairments.", "seed", "1");
+    QCommandLineOption statsOption("stats", "Statistics interval, 0 to disable.", "seconds", "10");
+    QCommandLineOption verboseOption("verbose", "Print the statistics of every vehicle.");
+    QCommandLineOption boardTypeOption("board-type", "Board type reported in FirmwareIAPObj.", "type", "0x09");
+    QCommandLineOption boardRevisionOption("board-revision", "Board revision reported in FirmwareIAPObj.", "revision", "3");
+    parser.addOption(countOption);
+    parser.addOption(portOption);
+    parser.addOption(ptyOption);
+    parser.addOption(latencyOption);
+    parser.addOption(jitterOption);
+    parser.addOption(bandwidthOption);
+    parser.addOption(lossOption);
+    parser.addOption(persistOption);
+    parser.addOption(threadsOption);
+    parser.addOption(seedOption);
+    parser.addOption(statsOption);
+    parser.addOption(verboseOption);
+    parser.addOption(boardTypeOption);
+    parser.addOption(boardRevisionOption);
+    parser.process(app);
+
+    int count                 = 1;
+    int port                  = 9000;
+    int threads               = QThread::idealThreadCount();
+    int seed                  = 1;
+    int stats                 = 10;
+    int boardType             = 0x09;
+    int boardRevision         = 3;
+    LinkImpairment impairment = { 0, 0, 0, 0.0 };
+
+    if (!intValue(parser, countOption, 1, 10000, &count)
+        || !intValue(parser, portOption, 1, 65535, &port)
+        || !intValue(parser, latencyOption, 0, 60000, &impairment.latencyMs)
+        || !intValue(parser, jitterOption, 0, 60000, &impairment.jitterMs)
+        || !intValue(parser, bandwidthOption, 0, INT_MAX, &impairment.bandwidth)
+        || !intValue(parser, threadsOption, 1, 1024, &threads)
+        || !intValue(parser, seedOption, 0, INT_MAX, &seed)
+        || !intValue(parser, statsOption, 0, 3600, &stats)
+        || !intValue(parser, boardTypeOption, 1, 0xff, &boardType)
+        || !intValue(parser, boardRevisionOption, 0, 0xffff, &boardRevision)) {
+        return 1;
+    }
+    if (parser.isSet(lossOption)) {
+        bool ok;
+        double loss = parser.value(lossOption).toDouble(&ok);
+        if (!ok || loss < 0.0 || loss > 100.0) {
+            qCritical() << "Invalid value for loss :" << parser.value(lossOption);
+            return 1;
+        }
+        impairment.lossRate = loss / 100.0;
+    }
+
+    SimVehicleConfig config;
+    config.name          = "sim";
+    config.index         = 0;
+    config.port          = parser.isSet(ptyOption) ? 0 : port;
+    config.impairment    = impairment;
+    config.persistDir    = parser.value(persistOption);
+    config.boardType     = boardType;
+    config.boardRevision = boardRevision;
+    config.seed          = seed;
+
+    SimFleet fleet;
+    QString errorString;
+
+    fleet.setStatsInterval(stats);
+    fleet.setVerbose(parser.isSet(verboseOption));
+    if (!fleet.start(config, count, threads, &errorString)) {
+        qCritical() << qPrintable(errorString);
+        return 1;
+    }
+
+#ifdef Q_OS_UNIX
+    setupSignalHandlers();
+#endif
+
+    int ret = app.exec();
+    fleet.stop();
+    return ret;
+}
@@ -0,0 +1,147 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ptydevice.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Pseudo terminal the GCS opens as the serial port of a vehicle
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "ptydevice.h"
+
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#if defined(Q_OS_MAC)
+#include <util.h>
+#else
+#include <pty.h>
+#endif
+
+PtyDevice::PtyDevice(QObject *parent) : QIODevice(parent),
+    m_master(-1),
+    m_slave(-1),
+    m_notifier(0)
+{}
+
+PtyDevice::~PtyDevice()
+{
+    close();
+}
+
+bool PtyDevice::open(QString *errorString)
+{
+    char name[256];
+
+    if (::openpty(&m_master, &m_slave, name, 0, 0) != 0) {
+        *errorString = tr("Couldn't create pseudo terminal: %1").arg(strerror(errno));
+        return false;
+    }
+
+    // Raw bytes in both directions, whatever the GCS configures on its side
+    struct termios tio;
+    if (::tcgetattr(m_slave, &tio) == 0) {
+        ::cfmakeraw(&tio);
+        ::tcsetattr(m_slave, TCSANOW, &tio);
+    }
+    ::fcntl(m_master, F_SETFL, ::fcntl(m_master, F_GETFL) | O_NONBLOCK);
+
+    m_slaveName = QString::fromLocal8Bit(name);
+    m_notifier  = new QSocketNotifier(m_master, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &PtyDevice::masterReadable);
+
+    return QIODevice::open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+void PtyDevice::close()
+{
+    if (m_master < 0) {
+        return;
+    }
+    QIODevice::close();
+    delete m_notifier;
+    m_notifier = 0;
+    ::close(m_master);
+    ::close(m_slave);
+    m_master = -1;
+    m_slave  = -1;
+    m_readBuffer.clear();
+}
+
+qint64 PtyDevice::bytesAvailable() const
+{
+    return m_readBuffer.size() + QIODevice::bytesAvailable();
+}
+
+qint64 PtyDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 size = qMin<qint64>(maxSize, m_readBuffer.size());
+
+    memcpy(data, m_readBuffer.constData(), size);
+    m_readBuffer.remove(0, size);
+    return size;
+}
+
+qint64 PtyDevice::writeData(const char *data, qint64 size)
+{
+    qint64 written = 0;
+
+    while (written < size) {
+        ssize_t res = ::write(m_master, data + written, size - written);
+        if (res < 0) {
+            // Nobody reading the slave and the buffer is full, same as a
+            // radio without a receiver
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            setErrorString(QString::fromLocal8Bit(strerror(errno)));
+            return -1;
+        }
+        written += res;
+    }
+    // The rest is dropped, not queued
+    return size;
+}
+
+void PtyDevice::masterReadable()
+{
+    char buffer[4096];
+    bool received = false;
+
+    forever {
+        ssize_t res = ::read(m_master, buffer, sizeof(buffer));
+        if (res > 0) {
+            m_readBuffer.append(buffer, res);
+            received = true;
+        } else if (res < 0 && errno == EINTR) {
+            continue;
+        } else {
+            break;
+        }
+    }
+    if (received) {
+        emit readyRead();
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ptydevice.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Pseudo terminal the GCS opens as the serial port of a vehicle
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PTYDEVICE_H
+#define PTYDEVICE_H
+
+#include <QIODevice>
+
+class QSocketNotifier;
+
+/**
+ * Master side of a pseudo terminal in raw mode. The slave side is kept open
+ * as well, so that the GCS can close and reopen it without hanging up the
+ * master.
+ */
+class PtyDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    PtyDevice(QObject *parent = 0);
+    ~PtyDevice();
+
+    bool open(QString *errorString);
+    void close();
+
+    // Path of the slave, e.g. /dev/pts/3
+    QString slaveName() const
+    {
+        return m_slaveName;
+    }
+
+    bool isSequential() const
+    {
+        return true;
+    }
+    qint64 bytesAvailable() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 size);
+
+private slots:
+    void masterReadable();
+
+private:
+    int m_master;
+    int m_slave;
+    QString m_slaveName;
+    QSocketNotifier *m_notifier;
+    QByteArray m_readBuffer;
+};
+
+#endif // PTYDEVICE_H
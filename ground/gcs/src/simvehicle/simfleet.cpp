@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ *
+ * @file       simfleet.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Runs the simulated vehicles in worker threads and sums up their statistics
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "simfleet.h"
+
+#include <QThread>
+#include <QTimer>
+#include <QDateTime>
+#include <QDebug>
+
+SimFleet::SimFleet(QObject *parent) : QObject(parent),
+    m_statsTimer(0),
+    m_statsInterval(10),
+    m_verbose(false),
+    m_pending(0),
+    m_connected(0),
+    m_connectCount(0),
+    m_connectMinMs(0),
+    m_connectMaxMs(0),
+    m_connectTotalMs(0),
+    m_saves(0),
+    m_lastSaves(0),
+    m_lastReportMs(0)
+{}
+
+SimFleet::~SimFleet()
+{
+    stop();
+}
+
+void SimFleet::setStatsInterval(int seconds)
+{
+    m_statsInterval = seconds;
+}
+
+void SimFleet::setVerbose(bool verbose)
+{
+    m_verbose = verbose;
+}
+
+bool SimFleet::start(const SimVehicleConfig &config, int count, int threads, QString *errorString)
+{
+    if (count < 1) {
+        *errorString = tr("No vehicle to simulate");
+        return false;
+    }
+    if (config.port != 0 && config.port + count - 1 > 65535) {
+        *errorString = tr("Not enough ports above %1 for %2 vehicles").arg(config.port).arg(count);
+        return false;
+    }
+
+    // Many vehicles share a few threads, each has its own event driven link
+    threads = qBound(1, threads, count);
+    for (int i = 0; i < threads; ++i) {
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("simvehicle%1").arg(i));
+        thread->start();
+        m_threads.append(thread);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        SimVehicleConfig vehicleConfig = config;
+
+        vehicleConfig.index = i;
+        vehicleConfig.name  = QString("%1%2").arg(config.name).arg(i + 1);
+        vehicleConfig.seed  = config.seed + i;
+        if (config.port != 0) {
+            vehicleConfig.port = config.port + i;
+        }
+
+        QThread *thread     = m_threads[i % threads];
+        SimVehicle *vehicle = new SimVehicle(vehicleConfig);
+        vehicle->moveToThread(thread);
+        connect(thread, &QThread::finished, vehicle, &QObject::deleteLater);
+        connect(vehicle, &SimVehicle::statsReport, this, &SimFleet::vehicleStats);
+        QMetaObject::invokeMethod(vehicle, "start", Qt::BlockingQueuedConnection);
+        m_vehicles.append(vehicle);
+    }
+    qDebug() << "SimFleet -" << m_vehicles.size() << "vehicles started in" << m_threads.size() << "threads";
+
+    if (m_statsInterval > 0) {
+        m_lastReportMs = QDateTime::currentMSecsSinceEpoch();
+        m_statsTimer   = new QTimer(this);
+        connect(m_statsTimer, &QTimer::timeout, this, &SimFleet::reportStats);
+        m_statsTimer->start(m_statsInterval * 1000);
+    }
+    return true;
+}
+
+void SimFleet::stop()
+{
+    if (m_statsTimer) {
+        m_statsTimer->stop();
+    }
+
+    foreach(SimVehicle * vehicle, m_vehicles) {
+        // Close the links and flush the saved settings before the threads go away
+        QMetaObject::invokeMethod(vehicle, "stop", Qt::BlockingQueuedConnection);
+    }
+    m_vehicles.clear();
+    foreach(QThread * thread, m_threads) {
+        thread->quit();
+        thread->wait();
+    }
+    qDeleteAll(m_threads);
+    m_threads.clear();
+}
+
+void SimFleet::reportStats()
+{
+    if (m_pending > 0) {
+        // Previous round not complete, the workers are overloaded
+        qWarning() << "SimFleet -" << m_pending << "vehicles did not report in time";
+    }
+    m_pending        = m_vehicles.size();
+    m_connected      = 0;
+    m_connectCount   = 0;
+    m_connectMinMs   = 0;
+    m_connectMaxMs   = 0;
+    m_connectTotalMs = 0;
+    m_saves          = 0;
+
+    foreach(SimVehicle * vehicle, m_vehicles) {
+        QMetaObject::invokeMethod(vehicle, "reportStats", Qt::QueuedConnection);
+    }
+}
+
+void SimFleet::vehicleStats(const QString &name, bool connected, qint64 connectMs, quint32 saves, const QString &report)
+{
+    Q_UNUSED(name);
+
+    if (m_verbose) {
+        qDebug() << "SimFleet -" << qPrintable(report);
+    }
+
+    if (connected) {
+        ++m_connected;
+    }
+    if (connectMs >= 0) {
+        m_connectMinMs    = m_connectCount == 0 ? connectMs : qMin(m_connectMinMs, connectMs);
+        m_connectMaxMs    = qMax(m_connectMaxMs, connectMs);
+        m_connectTotalMs += connectMs;
+        ++m_connectCount;
+    }
+    m_saves += saves;
+
+    if (m_pending > 0 && --m_pending == 0) {
+        qint64 nowMs    = QDateTime::currentMSecsSinceEpoch();
+        double seconds  = qMax<qint64>(1, nowMs - m_lastReportMs) / 1000.0;
+        QString summary = QString("%1/%2 connected").arg(m_connected).arg(m_vehicles.size());
+        if (m_connectCount > 0) {
+            summary += QString(", connect time min %1 avg %2 max %3 ms")
+                       .arg(m_connectMinMs).arg(m_connectTotalMs / m_connectCount).arg(m_connectMaxMs);
+        }
+        summary += QString(", %1 saves, %2 saves/s")
+                   .arg(m_saves).arg((m_saves - m_lastSaves) / seconds, 0, 'f', 1);
+        qDebug() << "SimFleet -" << qPrintable(summary);
+
+        m_lastSaves    = m_saves;
+        m_lastReportMs = nowMs;
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ *
+ * @file       simfleet.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Runs the simulated vehicles in worker threads and sums up their statistics
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SIMFLEET_H
+#define SIMFLEET_H
+
+#include "simvehicle.h"
+
+#include <QObject>
+#include <QList>
+
+class QThread;
+class QTimer;
+
+class SimFleet : public QObject {
+    Q_OBJECT
+
+public:
+    SimFleet(QObject *parent = 0);
+    ~SimFleet();
+
+    // Vehicle i gets config.port + i (unless 0) and config.seed + i
+    bool start(const SimVehicleConfig &config, int count, int threads, QString *errorString);
+    void setStatsInterval(int seconds);
+    void setVerbose(bool verbose);
+
+public slots:
+    void stop();
+
+private slots:
+    void reportStats();
+    void vehicleStats(const QString &name, bool connected, qint64 connectMs, quint32 saves, const QString &report);
+
+private:
+    QList<SimVehicle *> m_vehicles;
+    QList<QThread *> m_threads;
+    QTimer *m_statsTimer;
+    int m_statsInterval;
+    bool m_verbose;
+
+    // Current report round
+    int m_pending;
+    int m_connected;
+    int m_connectCount;
+    qint64 m_connectMinMs;
+    qint64 m_connectMaxMs;
+    qint64 m_connectTotalMs;
+    quint64 m_saves;
+    quint64 m_lastSaves;
+    qint64 m_lastReportMs;
+};
+
+#endif // SIMFLEET_H
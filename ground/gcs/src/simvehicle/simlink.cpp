@@ -0,0 +1,195 @@
+/**
+ ******************************************************************************
+ *
+ * @file       simlink.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Telemetry link with configurable latency, bandwidth and loss
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "simlink.h"
+
+#include <QTimer>
+#include <QtEndian>
+
+// Framing, see UAVTalk
+static const quint8 SYNC_VAL       = 0x3C;
+static const quint8 TYPE_MASK      = 0xF8;
+static const quint8 TYPE_VER       = 0x20;
+static const int MIN_HEADER_LENGTH = 8;
+static const int MAX_HEADER_LENGTH = 10;
+static const int MAX_PAYLOAD_LENGTH = 256;
+
+SimLink::SimLink(QIODevice *transport, const LinkImpairment &impairment, quint32 seed, QObject *parent) : QIODevice(parent),
+    m_transport(transport),
+    m_impairment(impairment),
+    m_random(seed),
+    m_timer(new QTimer(this))
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    foreach(Direction * direction, QList<Direction *>() << &m_tx << &m_rx) {
+        direction->queuedBytes = 0;
+        direction->busyUntilMs = 0;
+        direction->lastDueMs   = 0;
+    }
+    m_clock.start();
+
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &SimLink::deliver);
+    connect(m_transport, &QIODevice::readyRead, this, &SimLink::transportReadyRead);
+
+    open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+SimLink::~SimLink()
+{
+    m_transport->disconnect(this);
+}
+
+qint64 SimLink::bytesAvailable() const
+{
+    return m_readBuffer.size() + QIODevice::bytesAvailable();
+}
+
+qint64 SimLink::bytesToWrite() const
+{
+    return m_tx.queuedBytes + m_tx.input.size();
+}
+
+qint64 SimLink::readData(char *data, qint64 maxSize)
+{
+    qint64 size = qMin<qint64>(maxSize, m_readBuffer.size());
+
+    memcpy(data, m_readBuffer.constData(), size);
+    m_readBuffer.remove(0, size);
+    return size;
+}
+
+qint64 SimLink::writeData(const char *data, qint64 size)
+{
+    enqueue(m_tx, data, size, &m_stats.txFrames, &m_stats.txLost);
+    return size;
+}
+
+void SimLink::transportReadyRead()
+{
+    QByteArray data = m_transport->readAll();
+
+    enqueue(m_rx, data.constData(), data.size(), &m_stats.rxFrames, &m_stats.rxLost);
+}
+
+/**
+ * Cuts the complete frames out of the stream, bytes in front of a sync byte
+ * are dropped, and queues them or loses them
+ */
+void SimLink::enqueue(Direction &direction, const char *data, qint64 size, quint64 *frames, quint64 *lost)
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    qint64 nowMs = m_clock.elapsed();
+    int pos      = 0;
+
+    direction.input.append(data, size);
+    while (direction.input.size() - pos >= 4) {
+        const quint8 *p = reinterpret_cast<const quint8 *>(direction.input.constData()) + pos;
+        if (p[0] != SYNC_VAL || (p[1] & TYPE_MASK) != TYPE_VER) {
+            ++pos;
+            continue;
+        }
+        int length = qFromLittleEndian<quint16>(p + 2);
+        if (length < MIN_HEADER_LENGTH || length > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+            ++pos;
+            continue;
+        }
+        // Frame plus CRC byte
+        if (direction.input.size() - pos < length + 1) {
+            break;
+        }
+
+        ++*frames;
+        if (m_impairment.lossRate > 0.0 && uniform(m_random) < m_impairment.lossRate) {
+            ++*lost;
+        } else {
+            Frame frame;
+            frame.data = direction.input.mid(pos, length + 1);
+
+            // Serialized at the link rate after the frames before it
+            qint64 sentMs = qMax(nowMs, direction.busyUntilMs);
+            if (m_impairment.bandwidth > 0) {
+                sentMs += (qint64)frame.data.size() * 1000 / m_impairment.bandwidth;
+            }
+            direction.busyUntilMs = sentMs;
+
+            frame.dueMs = sentMs + m_impairment.latencyMs;
+            if (m_impairment.jitterMs > 0) {
+                frame.dueMs += (qint64)(uniform(m_random) * m_impairment.jitterMs);
+            }
+            // A serial link does not reorder
+            frame.dueMs         = qMax(frame.dueMs, direction.lastDueMs);
+            direction.lastDueMs = frame.dueMs;
+
+            direction.queuedBytes += frame.data.size();
+            direction.frames.enqueue(frame);
+        }
+        pos += length + 1;
+    }
+    direction.input.remove(0, pos);
+
+    schedule();
+}
+
+void SimLink::deliver()
+{
+    qint64 nowMs = m_clock.elapsed();
+    int readSize = m_readBuffer.size();
+    QByteArray tx;
+
+    while (!m_tx.frames.isEmpty() && m_tx.frames.head().dueMs <= nowMs) {
+        Frame frame = m_tx.frames.dequeue();
+        tx += frame.data;
+        m_tx.queuedBytes -= frame.data.size();
+    }
+    while (!m_rx.frames.isEmpty() && m_rx.frames.head().dueMs <= nowMs) {
+        Frame frame = m_rx.frames.dequeue();
+        m_readBuffer     += frame.data;
+        m_rx.queuedBytes -= frame.data.size();
+    }
+
+    if (!tx.isEmpty()) {
+        m_transport->write(tx);
+    }
+    schedule();
+    if (m_readBuffer.size() > readSize) {
+        emit readyRead();
+    }
+}
+
+void SimLink::schedule()
+{
+    qint64 dueMs = -1;
+
+    if (!m_tx.frames.isEmpty()) {
+        dueMs = m_tx.frames.head().dueMs;
+    }
+    if (!m_rx.frames.isEmpty() && (dueMs < 0 || m_rx.frames.head().dueMs < dueMs)) {
+        dueMs = m_rx.frames.head().dueMs;
+    }
+    if (dueMs >= 0) {
+        m_timer->start(qMax<qint64>(0, dueMs - m_clock.elapsed()));
+    }
+}
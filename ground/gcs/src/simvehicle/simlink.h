@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ *
+ * @file       simlink.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Telemetry link with configurable latency, bandwidth and loss
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SIMLINK_H
+#define SIMLINK_H
+
+#include <QIODevice>
+#include <QQueue>
+#include <QElapsedTimer>
+
+#include <random>
+
+class QTimer;
+
+struct LinkImpairment {
+    // One way delay of every frame, plus a uniform random 0..jitterMs
+    int    latencyMs;
+    int    jitterMs;
+    // Bytes per second in each direction, 0 for unlimited
+    int    bandwidth;
+    // Probability to lose a frame, 0..1
+    double lossRate;
+};
+
+/**
+ * Sits between UAVTalk and the transport (socket or pty) and impairs both
+ * directions like a radio link would. The streams are cut into UAVTalk frames,
+ * each frame is lost or delivered whole, in order, once it has been
+ * "transmitted" at the link bandwidth and the latency has elapsed.
+ *
+ * bytesToWrite() reports the frames waiting for bandwidth, so UAVTalk drops
+ * objects when the link is saturated, as with a full radio buffer.
+ */
+class SimLink : public QIODevice {
+    Q_OBJECT
+
+public:
+    typedef struct {
+        quint64 txFrames;
+        quint64 txLost;
+        quint64 rxFrames;
+        quint64 rxLost;
+    } Stats;
+
+    SimLink(QIODevice *transport, const LinkImpairment &impairment, quint32 seed, QObject *parent = 0);
+    ~SimLink();
+
+    bool isSequential() const
+    {
+        return true;
+    }
+    qint64 bytesAvailable() const;
+    qint64 bytesToWrite() const;
+
+    Stats getStats() const
+    {
+        return m_stats;
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 size);
+
+private slots:
+    void transportReadyRead();
+    void deliver();
+
+private:
+    struct Frame {
+        qint64 dueMs;
+        QByteArray data;
+    };
+
+    struct Direction {
+        // Bytes not yet cut into frames
+        QByteArray input;
+        QQueue<Frame> frames;
+        qint64 queuedBytes;
+        // End of the transmission of the last frame
+        qint64 busyUntilMs;
+        qint64 lastDueMs;
+    };
+
+    QIODevice *m_transport;
+    LinkImpairment m_impairment;
+    std::mt19937 m_random;
+    QElapsedTimer m_clock;
+    QTimer *m_timer;
+
+    Direction m_tx;
+    Direction m_rx;
+    QByteArray m_readBuffer;
+    Stats m_stats;
+
+    void enqueue(Direction &direction, const char *data, qint64 size, quint64 *frames, quint64 *lost);
+    void schedule();
+};
+
+#endif // SIMLINK_H
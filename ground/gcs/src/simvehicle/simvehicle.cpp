@@ -0,0 +1,505 @@
+/**
+ ******************************************************************************
+ *
+ * @file       simvehicle.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Flight side of the telemetry of one simulated vehicle
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "simvehicle.h"
+#ifdef Q_OS_UNIX
+#include "ptydevice.h"
+#endif
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavdataobject.h"
+#include "uavmetaobject.h"
+#include "uavtalk.h"
+#include "flighttelemetrystats.h"
+#include "gcstelemetrystats.h"
+#include "objectpersistence.h"
+#include "firmwareiapobj.h"
+
+#include <QTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QDebug>
+
+SimVehicle::SimVehicle(const SimVehicleConfig &config) :
+    m_config(config),
+    m_objMngr(0),
+    m_server(0),
+    m_socket(0),
+    m_pty(0),
+    m_link(0),
+    m_uavTalk(0),
+    m_streamTimer(0),
+    m_statsTimer(0),
+    m_linkOpenedMs(0),
+    m_lastConnectMs(-1),
+    m_connections(0),
+    m_saves(0),
+    m_loads(0),
+    m_deletes(0),
+    m_persistenceErrors(0)
+{}
+
+SimVehicle::~SimVehicle()
+{
+    stop();
+}
+
+void SimVehicle::start()
+{
+    m_clock.start();
+
+    m_objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+
+    // The GCS waits for a board type before it reports the connection
+    FirmwareIAPObj *firmwareIAP = FirmwareIAPObj::GetInstance(m_objMngr);
+    FirmwareIAPObj::DataFields firmware = firmwareIAP->getData();
+    firmware.BoardType     = m_config.boardType;
+    firmware.BoardRevision = m_config.boardRevision;
+    firmwareIAP->setData(firmware);
+
+    if (!m_config.persistDir.isEmpty()) {
+        m_persistDir = QDir(m_config.persistDir + "/" + m_config.name);
+        if (!m_persistDir.mkpath(".")) {
+            qWarning() << "SimVehicle" << m_config.name << "- couldn't create" << m_persistDir.absolutePath();
+        }
+    }
+    loadSettings();
+
+    connect(GCSTelemetryStats::GetInstance(m_objMngr), &UAVObject::objectUnpacked, this, &SimVehicle::gcsStatsUnpacked);
+    connect(ObjectPersistence::GetInstance(m_objMngr), &UAVObject::objectUnpacked, this, &SimVehicle::persistenceUnpacked);
+    foreach(QList<UAVMetaObject *> instances, m_objMngr->getMetaObjects()) {
+        foreach(UAVMetaObject * obj, instances) {
+            connect(obj, &UAVObject::objectUnpacked, this, &SimVehicle::metadataUnpacked);
+        }
+    }
+    rebuildSchedule();
+
+    m_streamTimer = new QTimer(this);
+    m_streamTimer->setInterval(STREAM_TICK_MS);
+    connect(m_streamTimer, &QTimer::timeout, this, &SimVehicle::streamPeriodic);
+
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(STATS_PERIOD_MS);
+    connect(m_statsTimer, &QTimer::timeout, this, &SimVehicle::updateFlightStats);
+    m_statsTimer->start();
+
+    if (m_config.port != 0) {
+        m_server = new QTcpServer(this);
+        connect(m_server, &QTcpServer::newConnection, this, &SimVehicle::clientConnected);
+        if (!m_server->listen(QHostAddress::Any, m_config.port)) {
+            qWarning() << "SimVehicle" << m_config.name << "- couldn't listen on port" << m_config.port << ":" << m_server->errorString();
+            return;
+        }
+        qDebug() << "SimVehicle" << m_config.name << "- listening on port" << m_config.port;
+    } else {
+#ifdef Q_OS_UNIX
+        QString errorString;
+        m_pty = new PtyDevice(this);
+        if (!m_pty->open(&errorString)) {
+            qWarning() << "SimVehicle" << m_config.name << "-" << errorString;
+            return;
+        }
+        qDebug() << "SimVehicle" << m_config.name << "- serial port" << m_pty->slaveName();
+        // Always "connected", the GCS opens and closes the other side
+        openLink(m_pty);
+#else
+        qWarning() << "SimVehicle" << m_config.name << "- pseudo terminals are not supported on this platform";
+#endif
+    }
+}
+
+void SimVehicle::stop()
+{
+    if (!m_objMngr) {
+        return;
+    }
+
+    closeLink();
+    delete m_server;
+    m_server = 0;
+#ifdef Q_OS_UNIX
+    delete m_pty;
+    m_pty = 0;
+#endif
+    delete m_streamTimer;
+    m_streamTimer = 0;
+    delete m_statsTimer;
+    m_statsTimer = 0;
+
+    // The objects are owned by the manager
+    delete m_objMngr;
+    m_objMngr = 0;
+}
+
+void SimVehicle::reportStats()
+{
+    if (!m_objMngr) {
+        return;
+    }
+
+    bool connected = FlightTelemetryStats::GetInstance(m_objMngr)->getData().Status == FlightTelemetryStats::STATUS_CONNECTED;
+    QString report = QString("%1: %2").arg(m_config.name).arg(connected ? "connected" : (m_link ? "open" : "waiting"));
+
+    if (m_lastConnectMs >= 0) {
+        report += QString(", connect %1 ms").arg(m_lastConnectMs);
+    }
+    report += QString(", %1 connections, %2 saves %3 loads %4 deletes %5 errors")
+              .arg(m_connections).arg(m_saves).arg(m_loads).arg(m_deletes).arg(m_persistenceErrors);
+    if (m_link) {
+        SimLink::Stats stats = m_link->getStats();
+        report += QString(", tx %1 frames %2 lost, rx %3 frames %4 lost")
+                  .arg(stats.txFrames).arg(stats.txLost).arg(stats.rxFrames).arg(stats.rxLost);
+    }
+    emit statsReport(m_config.name, connected, m_lastConnectMs, m_saves, report);
+}
+
+void SimVehicle::clientConnected()
+{
+    QTcpSocket *socket = m_server->nextPendingConnection();
+
+    if (!socket) {
+        return;
+    }
+    if (m_socket) {
+        qWarning() << "SimVehicle" << m_config.name << "- already connected, refusing" << socket->peerAddress().toString();
+        socket->close();
+        socket->deleteLater();
+        return;
+    }
+    qDebug() << "SimVehicle" << m_config.name << "- GCS connected from" << socket->peerAddress().toString();
+
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(socket, &QTcpSocket::disconnected, this, &SimVehicle::clientDisconnected);
+    m_socket = socket;
+    openLink(socket);
+}
+
+void SimVehicle::clientDisconnected()
+{
+    qDebug() << "SimVehicle" << m_config.name << "- GCS disconnected";
+    closeLink();
+}
+
+void SimVehicle::openLink(QIODevice *transport)
+{
+    m_link    = new SimLink(transport, m_config.impairment, m_config.seed + m_connections, this);
+    m_uavTalk = new UAVTalk(m_link, m_objMngr);
+    connect(m_link, SIGNAL(readyRead()), m_uavTalk, SLOT(processInputStream()));
+    connect(m_link, &QIODevice::readyRead, this, [this]() {
+        m_rxClock.start();
+    });
+
+    ++m_connections;
+    m_linkOpenedMs = m_clock.elapsed();
+    m_rxClock.start();
+    setFlightStatus(FlightTelemetryStats::STATUS_DISCONNECTED);
+    rebuildSchedule();
+    m_streamTimer->start();
+}
+
+void SimVehicle::closeLink()
+{
+    if (m_streamTimer) {
+        m_streamTimer->stop();
+    }
+    delete m_uavTalk;
+    m_uavTalk = 0;
+    delete m_link;
+    m_link = 0;
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->deleteLater();
+        m_socket = 0;
+    }
+    if (m_objMngr) {
+        setFlightStatus(FlightTelemetryStats::STATUS_DISCONNECTED);
+    }
+}
+
+/**
+ * Same state machine as the flight telemetry module
+ */
+void SimVehicle::gcsStatsUnpacked()
+{
+    GCSTelemetryStats::DataFields gcsStats = GCSTelemetryStats::GetInstance(m_objMngr)->getData();
+    FlightTelemetryStats::DataFields flightStats = FlightTelemetryStats::GetInstance(m_objMngr)->getData();
+    quint8 status = flightStats.Status;
+
+    if (flightStats.Status == FlightTelemetryStats::STATUS_DISCONNECTED) {
+        if (gcsStats.Status == GCSTelemetryStats::STATUS_HANDSHAKEREQ) {
+            status = FlightTelemetryStats::STATUS_HANDSHAKEACK;
+        }
+    } else if (flightStats.Status == FlightTelemetryStats::STATUS_HANDSHAKEACK) {
+        if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
+            status = FlightTelemetryStats::STATUS_CONNECTED;
+        } else if (gcsStats.Status == GCSTelemetryStats::STATUS_DISCONNECTED) {
+            status = FlightTelemetryStats::STATUS_DISCONNECTED;
+        }
+    } else if (flightStats.Status == FlightTelemetryStats::STATUS_CONNECTED) {
+        if (gcsStats.Status != GCSTelemetryStats::STATUS_CONNECTED) {
+            status = FlightTelemetryStats::STATUS_DISCONNECTED;
+        }
+    }
+
+    if (status != flightStats.Status) {
+        setFlightStatus(status);
+        if (status == FlightTelemetryStats::STATUS_CONNECTED) {
+            m_lastConnectMs = m_clock.elapsed() - m_linkOpenedMs;
+            qDebug() << "SimVehicle" << m_config.name << "- telemetry connected in" << m_lastConnectMs << "ms";
+        }
+    }
+    // Answer every handshake step, the GCS only moves on when it sees ours
+    if (status != FlightTelemetryStats::STATUS_CONNECTED || status != flightStats.Status) {
+        sendFlightStats();
+    }
+}
+
+void SimVehicle::metadataUnpacked()
+{
+    rebuildSchedule();
+}
+
+void SimVehicle::persistenceUnpacked()
+{
+    ObjectPersistence *persistence = ObjectPersistence::GetInstance(m_objMngr);
+    ObjectPersistence::DataFields data = persistence->getData();
+
+    if (data.Operation != ObjectPersistence::OPERATION_LOAD && data.Operation != ObjectPersistence::OPERATION_SAVE
+        && data.Operation != ObjectPersistence::OPERATION_DELETE && data.Operation != ObjectPersistence::OPERATION_FULLERASE) {
+        return;
+    }
+
+    bool success = true;
+    if (data.Operation == ObjectPersistence::OPERATION_FULLERASE) {
+        m_memoryStore.clear();
+        if (!m_config.persistDir.isEmpty()) {
+            foreach(QString fileName, m_persistDir.entryList(QStringList() << "*.uavo", QDir::Files)) {
+                success &= m_persistDir.remove(fileName);
+            }
+        }
+    } else if (data.Selection == ObjectPersistence::SELECTION_SINGLEOBJECT) {
+        UAVObject *obj = m_objMngr->getObject(data.ObjectID, data.InstanceID);
+        success = obj && persist(data.Operation, obj);
+    } else {
+        foreach(QList<UAVObject *> instances, m_objMngr->getObjects()) {
+            foreach(UAVObject * obj, instances) {
+                if (data.Selection == ObjectPersistence::SELECTION_ALLOBJECTS
+                    || (data.Selection == ObjectPersistence::SELECTION_ALLSETTINGS && obj->isSettingsObject())
+                    || (data.Selection == ObjectPersistence::SELECTION_ALLMETAOBJECTS && obj->isMetaDataObject())) {
+                    // Nothing stored is not an error for a bulk load
+                    if (!persist(data.Operation, obj) && data.Operation != ObjectPersistence::OPERATION_LOAD) {
+                        success = false;
+                    }
+                }
+            }
+        }
+    }
+    if (!success) {
+        ++m_persistenceErrors;
+    }
+
+    data.Operation = success ? ObjectPersistence::OPERATION_COMPLETED : ObjectPersistence::OPERATION_ERROR;
+    persistence->setData(data);
+    if (m_uavTalk) {
+        m_uavTalk->sendObject(persistence, false, false);
+    }
+}
+
+void SimVehicle::streamPeriodic()
+{
+    if (!m_uavTalk) {
+        return;
+    }
+
+    qint64 nowMs = m_clock.elapsed();
+    for (int i = 0; i < m_periodic.size(); ++i) {
+        Periodic &periodic = m_periodic[i];
+        if (nowMs < periodic.nextMs) {
+            continue;
+        }
+        m_uavTalk->sendObject(periodic.obj, false, false);
+        periodic.nextMs += periodic.periodMs;
+        if (periodic.nextMs <= nowMs) {
+            // Late, skip the missed updates instead of sending them in a burst
+            periodic.nextMs = nowMs + periodic.periodMs;
+        }
+    }
+}
+
+/**
+ * Link statistics and connection timeout, once per STATS_PERIOD_MS
+ */
+void SimVehicle::updateFlightStats()
+{
+    FlightTelemetryStats *flightStatsObj = FlightTelemetryStats::GetInstance(m_objMngr);
+    FlightTelemetryStats::DataFields flightStats = flightStatsObj->getData();
+
+    if (m_uavTalk) {
+        UAVTalk::ComStats stats = m_uavTalk->getStats();
+        m_uavTalk->resetStats();
+
+        float seconds = STATS_PERIOD_MS / 1000.0f;
+        flightStats.TxDataRate    = stats.txBytes / seconds;
+        flightStats.TxBytes      += stats.txBytes;
+        flightStats.TxFailures   += stats.txErrors;
+        flightStats.RxDataRate    = stats.rxBytes / seconds;
+        flightStats.RxBytes      += stats.rxBytes;
+        flightStats.RxFailures   += stats.rxErrors;
+        flightStats.RxSyncErrors += stats.rxSyncErrors;
+        flightStats.RxCrcErrors  += stats.rxCrcErrors;
+    }
+    if (flightStats.Status == FlightTelemetryStats::STATUS_CONNECTED && m_rxClock.elapsed() > CONNECTION_TIMEOUT_MS) {
+        qDebug() << "SimVehicle" << m_config.name << "- telemetry timeout";
+        flightStats.Status = FlightTelemetryStats::STATUS_DISCONNECTED;
+    }
+    flightStatsObj->setData(flightStats);
+
+    if (flightStats.Status != FlightTelemetryStats::STATUS_CONNECTED) {
+        sendFlightStats();
+    }
+}
+
+void SimVehicle::setFlightStatus(quint8 status)
+{
+    FlightTelemetryStats *flightStatsObj = FlightTelemetryStats::GetInstance(m_objMngr);
+    FlightTelemetryStats::DataFields flightStats = flightStatsObj->getData();
+
+    flightStats.Status = status;
+    flightStatsObj->setData(flightStats);
+}
+
+void SimVehicle::sendFlightStats()
+{
+    if (m_uavTalk) {
+        m_uavTalk->sendObject(FlightTelemetryStats::GetInstance(m_objMngr), false, false);
+    }
+}
+
+/**
+ * Collects the data objects with a periodic flight telemetry update mode,
+ * called again whenever the GCS changes some metadata
+ */
+void SimVehicle::rebuildSchedule()
+{
+    qint64 nowMs = m_clock.elapsed();
+    QHash<UAVObject *, qint64> nextMs;
+
+    foreach(const Periodic &periodic, m_periodic) {
+        nextMs.insert(periodic.obj, periodic.nextMs);
+    }
+    m_periodic.clear();
+
+    foreach(QList<UAVDataObject *> instances, m_objMngr->getDataObjects()) {
+        foreach(UAVDataObject * obj, instances) {
+            UAVObject::Metadata mdata = obj->getMetadata();
+            if (UAVObject::GetFlightTelemetryUpdateMode(mdata) != UAVObject::UPDATEMODE_PERIODIC
+                || mdata.flightTelemetryUpdatePeriod == 0) {
+                continue;
+            }
+            Periodic periodic;
+            periodic.obj      = obj;
+            periodic.periodMs = mdata.flightTelemetryUpdatePeriod;
+            periodic.nextMs   = nextMs.value(obj, nowMs + periodic.periodMs);
+            m_periodic.append(periodic);
+        }
+    }
+}
+
+/**
+ * Save, load or delete one object instance
+ */
+bool SimVehicle::persist(quint8 operation, UAVObject *obj)
+{
+    QString key = storeKey(obj);
+    bool inMemory = m_config.persistDir.isEmpty();
+
+    if (operation == ObjectPersistence::OPERATION_SAVE) {
+        QByteArray data(obj->getNumBytes(), 0);
+        obj->pack(reinterpret_cast<quint8 *>(data.data()));
+        if (inMemory) {
+            m_memoryStore.insert(key, data);
+        } else {
+            QSaveFile file(m_persistDir.filePath(key));
+            if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+                return false;
+            }
+        }
+        ++m_saves;
+        return true;
+    } else if (operation == ObjectPersistence::OPERATION_LOAD) {
+        QByteArray data;
+        if (inMemory) {
+            data = m_memoryStore.value(key);
+        } else {
+            QFile file(m_persistDir.filePath(key));
+            if (file.open(QIODevice::ReadOnly)) {
+                data = file.readAll();
+            }
+        }
+        // Also catches the files saved with other object definitions
+        if (data.size() != (int)obj->getNumBytes()) {
+            return false;
+        }
+        obj->unpack(reinterpret_cast<const quint8 *>(data.constData()));
+        ++m_loads;
+        // As the flight side does when an object changes, the GCS sees the loaded values
+        if (m_uavTalk) {
+            m_uavTalk->sendObject(obj, false, false);
+        }
+        return true;
+    } else if (operation == ObjectPersistence::OPERATION_DELETE) {
+        bool removed = inMemory ? m_memoryStore.remove(key) > 0 : m_persistDir.remove(key);
+        if (removed) {
+            ++m_deletes;
+        }
+        return removed;
+    }
+    return false;
+}
+
+QString SimVehicle::storeKey(UAVObject *obj) const
+{
+    return QString("%1-%2.uavo").arg(obj->getName()).arg(obj->getInstID());
+}
+
+/**
+ * Restores the saved settings and metadata, as the board does at boot
+ */
+void SimVehicle::loadSettings()
+{
+    foreach(QList<UAVObject *> instances, m_objMngr->getObjects()) {
+        foreach(UAVObject * obj, instances) {
+            if (obj->isSettingsObject() || obj->isMetaDataObject()) {
+                persist(ObjectPersistence::OPERATION_LOAD, obj);
+            }
+        }
+    }
+    if (m_loads > 0) {
+        qDebug() << "SimVehicle" << m_config.name << "- restored" << m_loads << "objects";
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ *
+ * @file       simvehicle.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup SimVehicle Simulated vehicle
+ * @{
+ * @brief Flight side of the telemetry of one simulated vehicle
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SIMVEHICLE_H
+#define SIMVEHICLE_H
+
+#include "simlink.h"
+
+#include <QObject>
+#include <QDir>
+#include <QHash>
+#include <QElapsedTimer>
+
+class QIODevice;
+class QTimer;
+class QTcpServer;
+class QTcpSocket;
+class PtyDevice;
+class UAVObject;
+class UAVObjectManager;
+class UAVTalk;
+
+struct SimVehicleConfig {
+    QString name;
+    int     index;
+    // TCP port to listen on, 0 for a pseudo terminal
+    quint16 port;
+    LinkImpairment impairment;
+    // Settings saved through ObjectPersistence, empty to keep them in memory only
+    QString persistDir;
+    quint8  boardType;
+    quint16 boardRevision;
+    quint32 seed;
+};
+
+/**
+ * Answers a GCS like the flight telemetry module does: handshake through
+ * Flight/GCSTelemetryStats, object requests and acks (UAVTalk does those),
+ * ObjectPersistence operations and the periodic updates of the data objects
+ * following their flight telemetry metadata. One GCS connection at a time.
+ *
+ * Lives in a worker thread, all slots must be invoked through queued connections.
+ */
+class SimVehicle : public QObject {
+    Q_OBJECT
+
+public:
+    SimVehicle(const SimVehicleConfig &config);
+    ~SimVehicle();
+
+    QString name() const
+    {
+        return m_config.name;
+    }
+
+public slots:
+    void start();
+    void stop();
+    void reportStats();
+
+signals:
+    void statsReport(const QString &name, bool connected, qint64 connectMs, quint32 saves, const QString &report);
+
+private slots:
+    void clientConnected();
+    void clientDisconnected();
+    void gcsStatsUnpacked();
+    void metadataUnpacked();
+    void persistenceUnpacked();
+    void streamPeriodic();
+    void updateFlightStats();
+
+private:
+    static const int STREAM_TICK_MS        = 5;
+    static const int STATS_PERIOD_MS       = 1000;
+    static const int CONNECTION_TIMEOUT_MS = 8000;
+
+    struct Periodic {
+        UAVObject *obj;
+        int periodMs;
+        qint64 nextMs;
+    };
+
+    SimVehicleConfig m_config;
+    UAVObjectManager *m_objMngr;
+    QTcpServer *m_server;
+    QTcpSocket *m_socket;
+    PtyDevice *m_pty;
+    SimLink *m_link;
+    UAVTalk *m_uavTalk;
+    QTimer *m_streamTimer;
+    QTimer *m_statsTimer;
+    QElapsedTimer m_clock;
+    QElapsedTimer m_rxClock;
+    QDir m_persistDir;
+    QHash<QString, QByteArray> m_memoryStore;
+    QList<Periodic> m_periodic;
+
+    qint64 m_linkOpenedMs;
+    // From the transport connection to the Connected handshake state
+    qint64 m_lastConnectMs;
+    quint32 m_connections;
+    quint32 m_saves;
+    quint32 m_loads;
+    quint32 m_deletes;
+    quint32 m_persistenceErrors;
+
+    void openLink(QIODevice *transport);
+    void closeLink();
+    void setFlightStatus(quint8 status);
+    void sendFlightStats();
+    void rebuildSchedule();
+
+    bool persist(quint8 operation, UAVObject *obj);
+    QString storeKey(UAVObject *obj) const;
+    void loadSettings();
+};
+
+#endif // SIMVEHICLE_H
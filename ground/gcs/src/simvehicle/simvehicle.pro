@@ -0,0 +1,85 @@
+#
+# Simulated vehicles: the flight side of the telemetry (handshake, object
+# requests, ObjectPersistence and periodic updates) over TCP or pseudo
+# terminals, with configurable latency, bandwidth and frame loss.
+# Used to load test the GCS and the daemon without hardware.
+#
+# Built like the daemon, the object and telemetry sources are compiled in directly.
+#
+
+include(../../gcs.pri)
+
+TEMPLATE = app
+TARGET = $${GCS_APP_TARGET}-simvehicle
+DESTDIR = $$GCS_APP_PATH
+
+CONFIG += console
+CONFIG -= app_bundle
+
+QT = core network qml
+
+# Sources are linked statically into the simulator
+DEFINES += UAVOBJECTS_LIBRARY UAVTALK_LIBRARY QTCREATOR_UTILS_STATIC_LIB
+
+PLUGINS_DIR = $$GCS_SOURCE_TREE/src/plugins
+
+INCLUDEPATH += \
+    $$PLUGINS_DIR \
+    $$PLUGINS_DIR/uavobjects \
+    $$PLUGINS_DIR/uavtalk
+
+HEADERS += \
+    simlink.h \
+    simvehicle.h \
+    simfleet.h \
+    $$PLUGINS_DIR/uavobjects/uavobject.h \
+    $$PLUGINS_DIR/uavobjects/uavmetaobject.h \
+    $$PLUGINS_DIR/uavobjects/uavdataobject.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectfield.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectmanager.h \
+    $$PLUGINS_DIR/uavobjects/uavobjectupdatebus.h \
+    $$PLUGINS_DIR/uavobjects/uavobjecthistory.h \
+    $$PLUGINS_DIR/uavtalk/uavtalk.h
+
+SOURCES += \
+    main.cpp \
+    simlink.cpp \
+    simvehicle.cpp \
+    simfleet.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavmetaobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavdataobject.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectfield.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectmanager.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjectupdatebus.cpp \
+    $$PLUGINS_DIR/uavobjects/uavobjecthistory.cpp \
+    $$PLUGINS_DIR/uavtalk/uavtalk.cpp \
+    $$GCS_SOURCE_TREE/src/libs/utils/crc.cpp
+
+unix {
+    HEADERS += ptydevice.h
+    SOURCES += ptydevice.cpp
+    !macx:LIBS += -lutil
+}
+
+# Generate the UAVObject classes in the simulator build directory
+UAVOBJ_XML_DIR = $${ROOT_DIR}/shared/uavobjectdefinition
+UAVOBJ_ROOT_DIR = $${ROOT_DIR}
+
+win32 {
+    UAVOBJGENERATOR = ../../../uavobjgenerator/uavobjgenerator.exe
+} else {
+    UAVOBJGENERATOR = ../../../uavobjgenerator/uavobjgenerator
+}
+
+include($$PLUGINS_DIR/uavobjects/uavobjectlist.pri)
+include($$PLUGINS_DIR/uavobjects/uavobjgenerator.pri)
+
+INCLUDEPATH += $$OUT_PWD
+
+!win32:!macx {
+    target.path = /bin
+    INSTALLS += target
+    QMAKE_RPATHDIR = $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH))
+    include(../rpath.pri)
+}
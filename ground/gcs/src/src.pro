@@ -6,3 +6,21 @@ SUBDIRS = \
     app \
     plugins \
     share
+
+# Headless daemon, simulated vehicle and gadget benchmark, built with
+# CONFIG+=gcs_tools in GCS_QMAKE_OPTS. Debug builds have them by default like
+# the tests, unless CONFIG+=no_gcs_tools
+CONFIG(debug, debug|release):!no_gcs_tools {
+    CONFIG += gcs_tools
+}
+gcs_tools {
+    SUBDIRS += daemon simvehicle gadgetbench
+}
+
+# Plugin unit tests, built when TEST is set like in gcs.pri
+isEmpty(TEST):CONFIG(debug, debug|release) {
+    TEST = 1
+}
+equals(TEST, 1) {
+    SUBDIRS += tests
+}
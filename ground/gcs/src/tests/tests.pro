@@ -0,0 +1,54 @@
+#
+# Unit tests of the plugins and libraries, built with the GCS when TEST is set (the
+# default for debug builds, see gcs.pri). "make check" in this directory runs them all.
+#
+
+TEMPLATE = subdirs
+
+PLUGINS_DIR = ../plugins
+LIBS_DIR    = ../libs
+
+SUBDIRS = \
+    uavobjectstest_enumtable \
+    uavobjectstest_updatebus \
+    uavobjectstest_history \
+    uavobjectstest_updatesequence \
+    uavtalktest_alloc \
+    uavtalktest_objectcache \
+    uavobjectwidgetutilstest_tuningstream \
+    uavobjectwidgetutilstest_objectreloader \
+    configtest_systemident \
+    uavobjectbrowsertest_uavodescription \
+    flightlogtest_debuglogdownloader \
+    antennatracktest_tracking \
+    setupwizardtest_vehicletemplatecatalog \
+    coreplugintest_animationclock \
+    utilstest_logfile \
+    utilstest_xmlconfig \
+    opmapcontroltest_mapitemindex \
+    opmapcontroltest_projection
+
+uavobjectstest_enumtable.file = $$PLUGINS_DIR/uavobjects/tests/enumtabletest.pro
+uavobjectstest_updatebus.file = $$PLUGINS_DIR/uavobjects/tests/uavobjectupdatebustest.pro
+uavobjectstest_history.file = $$PLUGINS_DIR/uavobjects/tests/uavobjecthistorytest.pro
+uavobjectstest_updatesequence.file = $$PLUGINS_DIR/uavobjects/tests/uavobjectupdatesequencetest.pro
+uavtalktest_alloc.file = $$PLUGINS_DIR/uavtalk/tests/uavtalkalloctest.pro
+uavtalktest_objectcache.file = $$PLUGINS_DIR/uavtalk/tests/objectcachetest.pro
+uavobjectwidgetutilstest_tuningstream.file = $$PLUGINS_DIR/uavobjectwidgetutils/tests/tuningstreamtest.pro
+uavobjectwidgetutilstest_objectreloader.file = $$PLUGINS_DIR/uavobjectwidgetutils/tests/objectreloadertest.pro
+configtest_systemident.file = $$PLUGINS_DIR/config/tests/systemidenttest.pro
+uavobjectbrowsertest_uavodescription.file = $$PLUGINS_DIR/uavobjectbrowser/tests/uavodescriptiontest.pro
+flightlogtest_debuglogdownloader.file = $$PLUGINS_DIR/flightlog/tests/debuglogdownloadertest.pro
+antennatracktest_tracking.file = $$PLUGINS_DIR/antennatrack/tests/trackingtest.pro
+setupwizardtest_vehicletemplatecatalog.file = $$PLUGINS_DIR/setupwizard/tests/vehicletemplatecatalogtest.pro
+coreplugintest_animationclock.file = $$PLUGINS_DIR/coreplugin/tests/animationclocktest.pro
+utilstest_logfile.file = $$LIBS_DIR/utils/tests/logfile/logfiletest.pro
+utilstest_xmlconfig.file = $$LIBS_DIR/utils/tests/xmlconfig/xmlconfigtest.pro
+opmapcontroltest_mapitemindex.file = $$LIBS_DIR/opmapcontrol/tests/mapitemindex/mapitemindextest.pro
+opmapcontroltest_projection.file = $$LIBS_DIR/opmapcontrol/tests/projection/projectiontest.pro
+
+# Needs openpty
+unix {
+    SUBDIRS += uploadertest_ssploopback
+    uploadertest_ssploopback.file = $$PLUGINS_DIR/uploader/tests/ssploopbacktest.pro
+}
@@ -27,11 +27,16 @@
 
 #include "uavobjectgeneratorgcs.h"
 
+#include <QVector>
+
 #define VERBOSE             false
 #define DEPRECATED          true
 
 #define DEFAULT_ENUM_PREFIX "E_"
 
+#define MAX_ENUM_HASH_SEED  0x10000
+#define MAX_ENUM_HASH_SLOTS 0x1000
+
 using namespace std;
 
 void error(QString msg)
@@ -66,6 +71,7 @@ struct Context {
     QString    setters;
     QString    notifications;
     // implementation
+    QString    enumTables;
     QString    fieldsInit;
     QString    fieldsDefault;
     QString    propertiesImpl;
@@ -82,6 +88,8 @@ struct FieldContext {
     QString   ucPropName;
     QString   propType;
     QString   propRefType;
+    // enum
+    bool hasEnumTable;
     // deprecation
     bool hasDeprecatedProperty;
     bool hasDeprecatedGetter;
@@ -198,6 +206,48 @@ QString toEnumStringList(ObjectInfo *object, FieldInfo *field)
 }
 
 
+// Same as UAVObjectField::EnumTable::hash()
+quint32 enumOptionHash(const QString & option, quint32 seed)
+{
+    quint32 hash = 2166136261u ^ seed;
+
+    for (int i = 0; i < option.length(); ++i) {
+        hash ^= option[i].unicode();
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Find the slots of a perfect hash of the options: the smallest table
+ * and seed for which each option hashes to its own slot.
+ */
+bool findEnumHashSlots(const QStringList & options, QVector<qint16> & slotIndexes, quint32 & seed)
+{
+    int numSlots = 2;
+
+    while (numSlots < 2 * options.length()) {
+        numSlots *= 2;
+    }
+    for (; numSlots <= MAX_ENUM_HASH_SLOTS; numSlots *= 2) {
+        for (seed = 0; seed < MAX_ENUM_HASH_SEED; ++seed) {
+            slotIndexes.fill(-1, numSlots);
+            int m;
+            for (m = 0; m < options.length(); ++m) {
+                quint32 slot = enumOptionHash(options[m], seed) & (numSlots - 1);
+                if (slotIndexes[slot] >= 0) {
+                    break;
+                }
+                slotIndexes[slot] = m;
+            }
+            if (m == options.length()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 QString generate(Context &ctxt, const QString &fragment)
 {
     QString str = fragment;
@@ -284,7 +334,10 @@ void generateFieldInit(Context &ctxt, FieldContext &fieldCtxt)
     }
     ctxt.fieldsInit += ";\n";
 
-    if (fieldCtxt.field->type == FIELDTYPE_ENUM) {
+    if (fieldCtxt.field->type == FIELDTYPE_ENUM && fieldCtxt.hasEnumTable) {
+        ctxt.fieldsInit += generate(ctxt, fieldCtxt,
+                                    "    fields.append(new UAVObjectField(\":fieldName\", tr(\":fieldDesc\"), \":fieldUnits\", :fieldNameElemNames, &:fieldNameEnumTable, \":fieldLimitValues\"));\n");
+    } else if (fieldCtxt.field->type == FIELDTYPE_ENUM) {
         ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    QStringList :fieldNameEnumOptions;\n");
         QStringList options = fieldCtxt.field->options;
         ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    :fieldNameEnumOptions");
@@ -301,6 +354,39 @@ void generateFieldInit(Context &ctxt, FieldContext &fieldCtxt)
     }
 }
 
+/*
+ * The options of an enum field and their perfect hash, constant data of the object code.
+ * The field maps option names to values with a single hash and string comparison.
+ */
+void generateEnumTable(Context &ctxt, FieldContext &fieldCtxt)
+{
+    QStringList options = fieldCtxt.field->options;
+    QVector<qint16> slotIndexes;
+    quint32 seed;
+
+    fieldCtxt.hasEnumTable = findEnumHashSlots(options, slotIndexes, seed);
+    if (!fieldCtxt.hasEnumTable) {
+        warning(ctxt.object, "No perfect hash for the options of field \"" + fieldCtxt.fieldName + "\", options are looked up by name.");
+        return;
+    }
+
+    ctxt.enumTables += generate(ctxt, fieldCtxt, "// :fieldName\n");
+    ctxt.enumTables += generate(ctxt, fieldCtxt, "static constexpr const char *:fieldNameOptionNames[] = {");
+    for (int m = 0; m < options.length(); ++m) {
+        ctxt.enumTables += QString(m > 0 ? ", \"%1\"" : " \"%1\"").arg(options[m]);
+    }
+    ctxt.enumTables += " };\n";
+    ctxt.enumTables += generate(ctxt, fieldCtxt, "static constexpr qint16 :fieldNameOptionSlots[] = {");
+    for (int slot = 0; slot < slotIndexes.size(); ++slot) {
+        ctxt.enumTables += QString(slot > 0 ? ", %1" : " %1").arg(slotIndexes[slot]);
+    }
+    ctxt.enumTables += " };\n";
+    ctxt.enumTables += generate(ctxt, fieldCtxt,
+                                "static constexpr UAVObjectField::EnumTable :fieldNameEnumTable = { :fieldNameOptionNames, :enumCount, :fieldNameOptionSlots, %1, %2 };\n\n")
+                       .arg(slotIndexes.size())
+                       .arg(seed);
+}
+
 void generateFieldDefault(Context &ctxt, FieldContext &fieldCtxt)
 {
     if (!fieldCtxt.field->defaultValues.isEmpty()) {
@@ -347,6 +433,9 @@ void generateField(Context &ctxt, FieldContext &fieldCtxt)
         ctxt.fields += generate(ctxt, fieldCtxt, "        :fieldType :fieldName;\n");
     }
     generateFieldInfo(ctxt, fieldCtxt);
+    if (fieldCtxt.field->type == FIELDTYPE_ENUM) {
+        generateEnumTable(ctxt, fieldCtxt);
+    }
     generateFieldInit(ctxt, fieldCtxt);
     generateFieldDefault(ctxt, fieldCtxt);
 }
@@ -369,6 +458,37 @@ void generateEnum(Context &ctxt, FieldContext &fieldCtxt)
 
     ctxt.registerImpl += generate(ctxt, fieldCtxt,
                                   "    qmlRegisterType<:ClassName_:PropName>(\"%1.:ClassName\", 1, 0, \":PropName\");\n").arg("UAVTalk");
+
+    if (!fieldCtxt.hasEnumTable) {
+        return;
+    }
+
+    // option names of the typed values, from the constant tables. The option can be given as a
+    // QString or as a Latin-1 C string, and a raw option index is checked without any string
+    ctxt.getters += generate(ctxt, fieldCtxt, "    static const char *:propNameOption(:propType value);\n");
+    ctxt.getters += generate(ctxt, fieldCtxt, "    static bool :propNameFromOption(const QString &option, :propType *value);\n");
+    ctxt.getters += generate(ctxt, fieldCtxt, "    static bool :propNameFromOption(const char *option, :propType *value);\n");
+    ctxt.getters += generate(ctxt, fieldCtxt, "    static bool :propNameFromIndex(int index, :propType *value);\n");
+
+    ctxt.propertiesImpl += generate(ctxt, fieldCtxt,
+                                    "const char *:ClassName:::propNameOption(:propType value)\n"
+                                    "{\n"
+                                    "   return (quint32)value < :fieldNameEnumTable.numOptions ? :fieldNameEnumTable.options[value] : NULL;\n"
+                                    "}\n"
+                                    "bool :ClassName:::propNameFromOption(const QString &option, :propType *value)\n"
+                                    "{\n"
+                                    "   return :propNameFromIndex(:fieldNameEnumTable.indexOf(option), value);\n"
+                                    "}\n"
+                                    "bool :ClassName:::propNameFromOption(const char *option, :propType *value)\n"
+                                    "{\n"
+                                    "   return :propNameFromIndex(:fieldNameEnumTable.indexOf(option), value);\n"
+                                    "}\n"
+                                    "bool :ClassName:::propNameFromIndex(int index, :propType *value)\n"
+                                    "{\n"
+                                    "   if (index < 0 || (quint32)index >= :fieldNameEnumTable.numOptions) { return false; }\n"
+                                    "   *value = static_cast<:propType>(index);\n"
+                                    "   return true;\n"
+                                    "}\n\n");
 }
 
 void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
@@ -437,6 +557,7 @@ void generateSimpleProperty(Context &ctxt, FieldContext &fieldCtxt)
                                     "   mutex->lock();\n"
                                     "   bool changed = (data_.:fieldName != static_cast<:fieldType>(value));\n"
                                     "   data_.:fieldName = static_cast<:fieldType>(value);\n"
+                                    "   if (changed) { markDataUpdated(); }\n"
                                     "   mutex->unlock();\n"
                                     "   if (changed) { %1 }\n"
                                     "}\n\n").arg(emitters);
@@ -475,6 +596,7 @@ void generateIndexedProperty(Context &ctxt, FieldContext &fieldCtxt)
                                     "   mutex->lock();\n"
                                     "   bool changed = (data_.:fieldName[index] != static_cast<:fieldType>(value));\n"
                                     "   data_.:fieldName[index] = static_cast<:fieldType>(value);\n"
+                                    "   if (changed) { markDataUpdated(); }\n"
                                     "   mutex->unlock();\n"
                                     "   if (changed) { %1 }\n"
                                     "}\n\n").arg(emitters);
@@ -653,7 +775,8 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *object)
             fieldCtxt.propType = enumClassName + "::Enum";
         }
         // reference type
-        fieldCtxt.propRefType = fieldCtxt.propType;
+        fieldCtxt.propRefType  = fieldCtxt.propType;
+        fieldCtxt.hasEnumTable = false;
 
         // deprecation
         fieldCtxt.hasDeprecatedProperty     = (fieldCtxt.fieldName != fieldCtxt.propName) && DEPRECATED;
@@ -681,6 +804,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *object)
     outInclude.replace("$(PROPERTY_SETTERS)", ctxt.setters);
     outInclude.replace("$(PROPERTY_NOTIFICATIONS)", ctxt.notifications);
 
+    outCode.replace("$(ENUMTABLES)", ctxt.enumTables);
     outCode.replace("$(FIELDSINIT)", ctxt.fieldsInit);
     outCode.replace("$(FIELDSDEFAULT)", ctxt.fieldsDefault);
     outCode.replace("$(PROPERTIES_IMPL)", ctxt.propertiesImpl);
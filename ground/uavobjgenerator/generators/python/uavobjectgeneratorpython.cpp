@@ -25,16 +25,22 @@
  */
 
 #include "uavobjectgeneratorpython.h"
+
+#include <algorithm>
+
 using namespace std;
 
 bool UAVObjectGeneratorPython::generate(UAVObjectParser *parser, QString templatepath, QString outputpath)
 {
     // Load template and setup output directory
-    pythonCodePath     = QDir(templatepath + QString("flight/modules/FlightPlan/lib"));
-    pythonOutputPath   = QDir(outputpath);
+    pythonCodePath       = QDir(templatepath + QString("flight/modules/FlightPlan/lib"));
+    // The native decoder is only built into the Python package, its template lives with the generator
+    pythonNativePath     = QDir(templatepath + QString("ground/uavobjgenerator/generators/python"));
+    pythonOutputPath     = QDir(outputpath);
     pythonOutputPath.mkpath(pythonOutputPath.absolutePath());
-    pythonCodeTemplate = readFile(pythonCodePath.absoluteFilePath("uavobject.pyt.template"));
-    if (pythonCodeTemplate.isEmpty()) {
+    pythonCodeTemplate   = readFile(pythonCodePath.absoluteFilePath("uavobject.pyt.template"));
+    pythonNativeTemplate = readFile(pythonNativePath.absoluteFilePath("uavtalknative.cpp.template"));
+    if (pythonCodeTemplate.isEmpty() || pythonNativeTemplate.isEmpty()) {
         std::cerr << "Problem reading python templates" << endl;
         return false;
     }
@@ -45,7 +51,7 @@ bool UAVObjectGeneratorPython::generate(UAVObjectParser *parser, QString templat
         process_object(info);
     }
 
-    return true; // if we come here everything should be fine
+    return process_native(parser); // if we come here everything should be fine
 }
 
 /**
@@ -118,3 +124,50 @@ bool UAVObjectGeneratorPython::process_object(ObjectInfo *info)
 
     return true;
 }
+
+static bool lessObjectId(const ObjectInfo *a, const ObjectInfo *b)
+{
+    return a->id < b->id;
+}
+
+/**
+ * Generate the source of the native decoder, with the field layout of all objects
+ */
+bool UAVObjectGeneratorPython::process_native(UAVObjectParser *parser)
+{
+    QString outCode = pythonNativeTemplate;
+
+    outCode.replace(QString("$(GENERATEDWARNING)"), "This is a autogenerated file!! Do not modify and expect a result.");
+
+    // The decoder looks the objects up by binary search
+    QList<ObjectInfo *> objects = parser->getObjectInfo();
+    std::sort(objects.begin(), objects.end(), lessObjectId);
+
+    QString fieldTables;
+    QString objectTable;
+    foreach(ObjectInfo * info, objects) {
+        // Fields are already in packing order
+        fieldTables.append(QString("static const FieldDesc %1Fields[] = {\n").arg(info->name));
+        int offset = 0;
+        foreach(FieldInfo * field, info->fields) {
+            fieldTables.append(QString("    { \"%1\", %2, %3, %4 },\n")
+                               .arg(field->name).arg(field->type).arg(field->numElements).arg(offset));
+            offset += field->numBytes * field->numElements;
+        }
+        fieldTables.append("};\n\n");
+        objectTable.append(QString("    { 0x%1, \"%2\", %2Fields, %3, %4 },\n")
+                           .arg(info->id, 8, 16, QChar('0')).arg(info->name)
+                           .arg(info->fields.length()).arg(offset));
+    }
+    outCode.replace(QString("$(FIELDTABLES)"), fieldTables);
+    outCode.replace(QString("$(OBJECTTABLE)"), objectTable);
+    outCode.replace(QString("$(NUMOBJECTS)"), QString::number(objects.length()));
+
+    bool res = writeFileIfDifferent(pythonOutputPath.absolutePath() + "/uavtalknative.cpp", outCode);
+    if (!res) {
+        cout << "Error: Could not write Python native decoder" << endl;
+        return false;
+    }
+
+    return true;
+}
@@ -35,9 +35,12 @@ public:
 
 private:
     bool process_object(ObjectInfo *info);
+    bool process_native(UAVObjectParser *parser);
 
     QString pythonCodeTemplate;
+    QString pythonNativeTemplate;
     QDir pythonCodePath;
+    QDir pythonNativePath;
     QDir pythonOutputPath;
 };
 
@@ -0,0 +1,86 @@
+##
+##############################################################################
+#
+# @file       example_decodebench.py
+# @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+# @brief      Compare the native and pure python decoding of a GCS log
+#   
+# @see        The GNU Public License (GPL) Version 3
+#
+#############################################################################/
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+# for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+#
+
+
+
+import logging
+import time
+import sys
+import os
+
+from librepilot.uavtalk import uavtalk
+from librepilot.uavtalk.uavtalk import UavTalk
+from librepilot.uavtalk.objectManager import ObjManager
+
+
+def printUsage():
+    appName = os.path.basename(sys.argv[0])
+    print
+    print "usage:"
+    print "  %s filename " % appName
+    print
+    print "  for example: %s /tmp/OP-2015-04-28_23-16-33.opl" % appName
+    print 
+
+def bench(name, filename, objMan):
+    start = time.time()
+    columns = uavtalk.decodeLog(filename, objMan)
+    seconds = max(time.time() - start, 1e-6)
+    messages = sum(len(column["timestamp"]) for column in columns.values())
+    megabytes = os.path.getsize(filename) / (1024.0 * 1024.0)
+    print "%-7s %8d messages in %7.3f s, %8.1f MB/s, %10.0f messages/s" % \
+          (name, messages, seconds, megabytes / seconds, messages / seconds)
+    return columns
+
+if __name__ == '__main__':
+
+    if len(sys.argv) != 2:
+        print "ERROR: Incorrect number of arguments"
+        printUsage()
+        sys.exit(2)
+
+    script, filename = sys.argv
+    if not os.path.exists(filename):
+        sys.exit('ERROR: Log %s was not found!' % filename)
+
+    logging.basicConfig(level=logging.INFO)
+
+    objMan = ObjManager(UavTalk(None, None))
+    objMan.importDefinitions()
+
+    native = uavtalk._uavtalknative
+    if native is None:
+        print "Native decoder not built, run \"make uavobjects_python_install\""
+    else:
+        nativeColumns = bench("native", filename, objMan)
+
+    uavtalk._uavtalknative = None
+    pythonColumns = bench("python", filename, objMan)
+    uavtalk._uavtalknative = native
+
+    if native is not None and nativeColumns != pythonColumns:
+        print "ERROR: native and python decoding differ"
+        sys.exit(1)
@@ -93,8 +93,12 @@ class ObjManager(object):
         o = Observer(observerObj, observerMethod)
         obj.observers.append(o)
         
-    def objUpdate(self, obj, rxData):
-        obj.deserialize(rxData)
+    def objUpdate(self, obj, rxData, values=None):
+        # values are already decoded by the native decoder
+        if values is not None:
+            obj.setValues(values)
+        else:
+            obj.deserialize(rxData)
         obj.updateCnt += 1
         for observer in obj.observers:
             observer.call(obj)
@@ -181,6 +181,11 @@ class UAVObject(object):
         for field in self.fields:
             p += field.deserialize(data[p:])
 
+    def setValues(self, values):
+        # One value per field, in the order of self.fields
+        for field, value in zip(self.fields, values):
+            field.value = value
+
     def getName(self):
         pass
 
@@ -29,8 +29,18 @@
 import time
 import logging
 import threading
+import struct
+import array
 
 from librepilot.uavtalk.objectManager import TimeoutException
+from librepilot.uavtalk.uavobject import UAVObjectField
+
+# Generated with the objects by "make uavobjects_python", frames and decodes whole
+# buffers instead of one byte at a time. The pure python decoder is used without it.
+try:
+    from librepilot.uavobjects import _uavtalknative
+except ImportError:
+    _uavtalknative = None
 
 SYNC = 0x3C
 VERSION_MASK = 0xFC
@@ -47,6 +57,9 @@ HEADER_LENGTH = 10 # sync(1), type (1), size(2), object ID (4), instance ID(2 )
 MAX_PAYLOAD_LENGTH = 255
 CHECKSUM_LENGTH = 1
 MAX_PACKET_LENGTH = (HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH)
+
+NATIVE_READ_SIZE = 4096
+LOG_HEADER_LENGTH = 12 # timestamp(4), size(8)
     
 
         
@@ -121,7 +134,9 @@ class UavTalkRecThread(threading.Thread):
         #self.uavTalk.serial.open()
         self.stop = False
 
-        if self.uavTalk.logFile is not None:
+        if _uavtalknative is not None:
+            self._runNative()
+        elif self.uavTalk.logFile is not None:
             file = open(self.uavTalk.logFile, "rb")
             while not self.stop:
                 rx = file.read(1)
@@ -140,6 +155,35 @@ class UavTalkRecThread(threading.Thread):
         else:
             print "Nothing to do!"
 
+    def _runNative(self):
+        if self.uavTalk.logFile is not None:
+            file = open(self.uavTalk.logFile, "rb")
+            read = lambda: file.read(NATIVE_READ_SIZE)
+        elif self.uavTalk.serial is not None:
+            serial = self.uavTalk.serial
+            read = lambda: serial.read(max(1, min(serial.inWaiting(), NATIVE_READ_SIZE)))
+        else:
+            print "Nothing to do!"
+            return
+
+        # Start of a message not received completely yet
+        pending = b""
+        while not self.stop:
+            rx = read()
+            if len(rx) == 0:
+                continue
+            data = pending + rx
+            packets, consumed, errors = _uavtalknative.decode(data)
+            pending = data[consumed:]
+            if errors > 0:
+                logging.debug("CRC ERROR")
+            for rxType, objId, instId, values in packets:
+                obj = self.uavTalk.objMan.getObj(objId)
+                if obj is None:
+                    logging.warning("Rec UNKNOWN Obj %x", objId)
+                elif values is not None:
+                    self.uavTalk._onRecevedPacket(obj, rxType, None, values)
+
                 
     def _consumeByte(self, rx):
         self.rxCrc.add(rx)        
@@ -262,7 +306,7 @@ class UavTalk(object):
         self.recThread.stop = True;
         self.recThread.join()
         
-    def _onRecevedPacket(self, obj, rxType, rxData): 
+    def _onRecevedPacket(self, obj, rxType, rxData, values=None):
         # logging.debug("REC Obj %20s type %x cnt %d", obj, rxType, obj.updateCnt+1)
         #        for i in rxData: print hex(i),
         #        print
@@ -271,7 +315,7 @@ class UavTalk(object):
             # logging.debug("Sending ACK for Obj %s", obj)
             self.sendObjectAck(obj)
             
-        self.objMan.objUpdate(obj, rxData)
+        self.objMan.objUpdate(obj, rxData, values)
          
     def sendObjReq(self, obj):
         self._sendpacket(TYPE_OBJ_REQ, obj.objId)
@@ -313,3 +357,85 @@ class UavTalk(object):
         finally:
             self.txLock.release()
         # logging.debug("Released lock " + str(obj_type) + " " + name)
+
+
+def _logColumnName(objMan, obj):
+    if obj.isMetaData():
+        return objMan.getObj(obj.objId - 1).name + "Meta"
+    return obj.name
+
+
+def decodeLog(fileName, objMan=None):
+    """
+    Decode a GCS .opl log at once into columns:
+      {objectName: {"timestamp": array, "instance": array, fieldName: array, ...}}
+    The values are array.array, numElements values per message for array fields,
+    numpy.frombuffer() uses them without copy. Metadata objects are named <Name>Meta.
+    Without the native decoder, objMan provides the object definitions.
+    """
+    data = open(fileName, "rb").read()
+    if _uavtalknative is not None:
+        columns, errors = _uavtalknative.decode_log(data)
+        return columns
+    if objMan is None:
+        raise ValueError("The object definitions are needed without the native decoder")
+
+    # The log records are not aligned on messages, join them into one stream
+    records = []
+    chunks = []
+    size = 0
+    offset = 0
+    while len(data) - offset >= LOG_HEADER_LENGTH:
+        timestamp, length = struct.unpack_from("<Iq", data, offset)
+        if length > len(data) - offset - LOG_HEADER_LENGTH:
+            break
+        records.append((size, timestamp))
+        chunks.append(data[offset + LOG_HEADER_LENGTH:offset + LOG_HEADER_LENGTH + length])
+        size += length
+        offset += LOG_HEADER_LENGTH + length
+    stream = bytearray(b"".join(chunks))
+
+    columns = {}
+    fieldNames = {}
+    record = 0
+    i = 0
+    while i + HEADER_LENGTH + CHECKSUM_LENGTH <= len(stream):
+        if stream[i] != SYNC or (stream[i + 1] & VERSION_MASK) != VERSION:
+            i += 1
+            continue
+        length = stream[i + 2] | (stream[i + 3] << 8)
+        if length < HEADER_LENGTH or length > HEADER_LENGTH + MAX_PAYLOAD_LENGTH:
+            i += 1
+            continue
+        if i + length + CHECKSUM_LENGTH > len(stream):
+            break
+        crc = Crc()
+        crc.addList(stream[i:i + length])
+        if crc.read() != stream[i + length]:
+            i += 1
+            continue
+
+        objId, instId = struct.unpack_from("<IH", bytes(stream[i + 4:i + HEADER_LENGTH]))
+        obj = objMan.getObj(objId)
+        if obj is not None and length > HEADER_LENGTH and obj.getSerialisedSize() == length - HEADER_LENGTH:
+            while record + 1 < len(records) and records[record + 1][0] <= i:
+                record += 1
+            obj.deserialize(list(stream[i + HEADER_LENGTH:i + length]))
+
+            if objId not in fieldNames:
+                names = dict((id(v), n) for n, v in vars(obj).items() if isinstance(v, UAVObjectField))
+                fieldNames[objId] = [names[id(field)] for field in obj.fields]
+                column = {"timestamp": array.array("I"), "instance": array.array("H")}
+                for name, field in zip(fieldNames[objId], obj.fields):
+                    column[name] = array.array(field.fmt[1])
+                columns[_logColumnName(objMan, obj)] = column
+            column = columns[_logColumnName(objMan, obj)]
+            column["timestamp"].append(records[record][1])
+            column["instance"].append(instId)
+            for name, field in zip(fieldNames[objId], obj.fields):
+                if field.numElements == 1:
+                    column[name].append(field.value)
+                else:
+                    column[name].extend(field.value)
+        i += length + CHECKSUM_LENGTH
+    return columns
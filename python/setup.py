@@ -1,9 +1,17 @@
-from distutils.core import setup
+from distutils.core import setup, Extension
 import glob
+import os
+
+# Native decoder, generated with the objects by "make uavobjects_python"
+ext_modules = []
+native_source = os.path.join('librepilot', 'uavobjects', 'uavtalknative.cpp')
+if os.path.exists(native_source):
+    ext_modules.append(Extension('librepilot.uavobjects._uavtalknative', [native_source]))
 
 setup(name='LibrePilot UAVTalk',
       version='1.0',
       description='LibrePilot UAVTalk',
       url='http://www.librepilot.org',
       packages=['librepilot', 'librepilot.uavtalk', 'librepilot.uavobjects'],
+      ext_modules=ext_modules,
      )